@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+#
+# Copyright 2016 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Generate the keyword prefilter tables used by WastLexer::MatchKeyword.
+
+Reads the gperf input file (src/lexer-keywords.txt) and emits, for each
+first and last character, a bitmask of the lengths of the keywords that
+start/end with that character. MatchKeyword uses these to reject most
+non-keywords without running the perfect hash.
+"""
+
+from __future__ import print_function
+
+import argparse
+import sys
+
+
+def ReadKeywords(filename):
+    with open(filename) as f:
+        contents = f.read()
+    keywords = []
+    for line in contents.split('%%\n', 1)[1].splitlines():
+        line = line.strip()
+        if not line or line.startswith('#'):
+            continue
+        keywords.append(line.split(',')[0].strip())
+    return keywords
+
+
+def MakeMasks(keywords, key):
+    masks = [0] * 256
+    for keyword in keywords:
+        assert len(keyword) < 64, keyword
+        masks[ord(key(keyword))] |= 1 << len(keyword)
+    return masks
+
+
+def WriteTable(f, name, masks):
+    f.write('static const uint64_t %s[256] = {\n' % name)
+    for i in range(0, 256, 3):
+        f.write('  %s,\n' % ', '.join('0x%016xull' % m for m in masks[i:i + 3]))
+    f.write('};\n')
+
+
+def main(args):
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-o', '--output', metavar='PATH',
+                        help='output file.')
+    parser.add_argument('file', help='gperf keyword input file.')
+    options = parser.parse_args(args)
+
+    keywords = ReadKeywords(options.file)
+    out_file = open(options.output, 'w') if options.output else sys.stdout
+    out_file.write('/* Generated by gen-keyword-prefilter.py, do not edit! */\n')
+    out_file.write('/* For each first (last) character, a bitmask of the\n')
+    out_file.write('   lengths of the keywords that start (end) with it. */\n')
+    WriteTable(out_file, 'kKeywordFirstCharLengths', MakeMasks(keywords, lambda k: k[0]))
+    WriteTable(out_file, 'kKeywordLastCharLengths', MakeMasks(keywords, lambda k: k[-1]))
+    if options.output:
+        out_file.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
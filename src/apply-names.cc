@@ -28,44 +28,44 @@ namespace wabt {
 
 namespace {
 
-class NameApplier : public ExprVisitor::DelegateNop {
+class NameApplier : public ExprVisitorNopDelegate {
  public:
   NameApplier();
 
   Result VisitModule(Module* module);
 
-  // Implementation of ExprVisitor::DelegateNop.
-  Result BeginBlockExpr(BlockExpr*) override;
-  Result EndBlockExpr(BlockExpr*) override;
-  Result OnBrExpr(BrExpr*) override;
-  Result OnBrIfExpr(BrIfExpr*) override;
-  Result OnBrOnExnExpr(BrOnExnExpr*) override;
-  Result OnBrTableExpr(BrTableExpr*) override;
-  Result OnCallExpr(CallExpr*) override;
-  Result OnRefFuncExpr(RefFuncExpr*) override;
-  Result OnCallIndirectExpr(CallIndirectExpr*) override;
-  Result OnReturnCallExpr(ReturnCallExpr*) override;
-  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr*) override;
-  Result OnGlobalGetExpr(GlobalGetExpr*) override;
-  Result OnGlobalSetExpr(GlobalSetExpr*) override;
-  Result BeginIfExpr(IfExpr*) override;
-  Result EndIfExpr(IfExpr*) override;
-  Result OnLocalGetExpr(LocalGetExpr*) override;
-  Result OnLocalSetExpr(LocalSetExpr*) override;
-  Result OnLocalTeeExpr(LocalTeeExpr*) override;
-  Result BeginLoopExpr(LoopExpr*) override;
-  Result EndLoopExpr(LoopExpr*) override;
-  Result OnDataDropExpr(DataDropExpr*) override;
-  Result OnMemoryInitExpr(MemoryInitExpr*) override;
-  Result OnElemDropExpr(ElemDropExpr*) override;
-  Result OnTableInitExpr(TableInitExpr*) override;
-  Result OnTableGetExpr(TableGetExpr*) override;
-  Result OnTableSetExpr(TableSetExpr*) override;
-  Result OnTableGrowExpr(TableGrowExpr*) override;
-  Result OnTableSizeExpr(TableSizeExpr*) override;
-  Result BeginTryExpr(TryExpr*) override;
-  Result EndTryExpr(TryExpr*) override;
-  Result OnThrowExpr(ThrowExpr*) override;
+  // Expression handlers, called by ExprVisitorT<NameApplier>.
+  Result BeginBlockExpr(BlockExpr*);
+  Result EndBlockExpr(BlockExpr*);
+  Result OnBrExpr(BrExpr*);
+  Result OnBrIfExpr(BrIfExpr*);
+  Result OnBrOnExnExpr(BrOnExnExpr*);
+  Result OnBrTableExpr(BrTableExpr*);
+  Result OnCallExpr(CallExpr*);
+  Result OnRefFuncExpr(RefFuncExpr*);
+  Result OnCallIndirectExpr(CallIndirectExpr*);
+  Result OnReturnCallExpr(ReturnCallExpr*);
+  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr*);
+  Result OnGlobalGetExpr(GlobalGetExpr*);
+  Result OnGlobalSetExpr(GlobalSetExpr*);
+  Result BeginIfExpr(IfExpr*);
+  Result EndIfExpr(IfExpr*);
+  Result OnLocalGetExpr(LocalGetExpr*);
+  Result OnLocalSetExpr(LocalSetExpr*);
+  Result OnLocalTeeExpr(LocalTeeExpr*);
+  Result BeginLoopExpr(LoopExpr*);
+  Result EndLoopExpr(LoopExpr*);
+  Result OnDataDropExpr(DataDropExpr*);
+  Result OnMemoryInitExpr(MemoryInitExpr*);
+  Result OnElemDropExpr(ElemDropExpr*);
+  Result OnTableInitExpr(TableInitExpr*);
+  Result OnTableGetExpr(TableGetExpr*);
+  Result OnTableSetExpr(TableSetExpr*);
+  Result OnTableGrowExpr(TableGrowExpr*);
+  Result OnTableSizeExpr(TableSizeExpr*);
+  Result BeginTryExpr(TryExpr*);
+  Result EndTryExpr(TryExpr*);
+  Result OnThrowExpr(ThrowExpr*);
 
  private:
   void PushLabel(const std::string& label);
@@ -90,15 +90,18 @@ class NameApplier : public ExprVisitor::DelegateNop {
 
   Module* module_ = nullptr;
   Func* current_func_ = nullptr;
-  ExprVisitor visitor_;
-  std::vector<std::string> param_and_local_index_to_name_;
-  std::vector<std::string> labels_;
+  ExprVisitorT<NameApplier> visitor_;
+  // Views into the function's interned binding names; rebuilt per function,
+  // but the vector's capacity is reused and no name is copied.
+  std::vector<string_view> param_and_local_index_to_name_;
+  // Pointers into the IR's block labels, which are stable while visiting.
+  std::vector<const std::string*> labels_;
 };
 
 NameApplier::NameApplier() : visitor_(this) {}
 
 void NameApplier::PushLabel(const std::string& label) {
-  labels_.push_back(label);
+  labels_.push_back(&label);
 }
 
 void NameApplier::PopLabel() {
@@ -108,7 +111,7 @@ void NameApplier::PopLabel() {
 string_view NameApplier::FindLabelByVar(Var* var) {
   if (var->is_name()) {
     for (int i = labels_.size() - 1; i >= 0; --i) {
-      const std::string& label = labels_[i];
+      const std::string& label = *labels_[i];
       if (label == var->name()) {
         return label;
       }
@@ -118,7 +121,7 @@ string_view NameApplier::FindLabelByVar(Var* var) {
     if (var->index() >= labels_.size()) {
       return string_view();
     }
-    return labels_[labels_.size() - 1 - var->index()];
+    return *labels_[labels_.size() - 1 - var->index()];
   }
 }
 
@@ -211,7 +214,7 @@ Result NameApplier::UseNameForParamAndLocalVar(Func* func, Var* var) {
     return Result::Error;
   }
 
-  std::string name = param_and_local_index_to_name_[local_index];
+  string_view name = param_and_local_index_to_name_[local_index];
   if (var->is_name()) {
     assert(name == var->name());
     return Result::Ok;
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Microbenchmarks for the library's hot paths: LEB128 decoding, lexing,
+ * binary reading and writing, and the interpreter loop. Built as the
+ * wabt-bench executable when BUILD_BENCHMARKS is enabled; requires the
+ * google/benchmark submodule in third_party/benchmark. */
+
+#include "benchmark/benchmark.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "src/binary-reader.h"
+#include "src/binary-reader-ir.h"
+#include "src/binary-writer.h"
+#include "src/error.h"
+#include "src/feature.h"
+#include "src/interp/binary-reader-interp.h"
+#include "src/interp/interp.h"
+#include "src/ir.h"
+#include "src/leb128.h"
+#include "src/stream.h"
+#include "src/wast-lexer.h"
+#include "src/wast-parser.h"
+
+using namespace wabt;
+
+namespace {
+
+// How many iterations the canned loop in MakeModuleSource runs per call.
+const int kRunLoopCount = 10000;
+
+// Returns the text of a module with |num_funcs| small arithmetic functions,
+// plus a "run" export whose body is a counted loop. The function bodies are
+// deliberately branchy and local-heavy to resemble compiled code.
+std::string MakeModuleSource(int num_funcs) {
+  std::string result = "(module\n";
+  for (int i = 0; i != num_funcs; ++i) {
+    std::string name = "f" + std::to_string(i);
+    result +=
+        "  (func (export \"" + name + "\") (param i32 i32) (result i32)\n"
+        "    (local i32)\n"
+        "    (local.set 2 (i32.mul (local.get 0) (i32.const 3)))\n"
+        "    (if (result i32) (i32.lt_s (local.get 2) (local.get 1))\n"
+        "      (then (i32.add (local.get 2) (local.get 1)))\n"
+        "      (else (i32.sub (local.get 2) (local.get 1)))))\n";
+  }
+  result +=
+      "  (func (export \"run\") (result i32)\n"
+      "    (local $i i32) (local $sum i32)\n"
+      "    (block $done\n"
+      "      (loop $top\n"
+      "        (br_if $done (i32.ge_u (local.get $i) (i32.const " +
+      std::to_string(kRunLoopCount) +
+      ")))\n"
+      "        (local.set $sum (i32.add (local.get $sum) (local.get $i)))\n"
+      "        (local.set $i (i32.add (local.get $i) (i32.const 1)))\n"
+      "        (br $top)))\n"
+      "    (local.get $sum)))";
+  return result;
+}
+
+std::unique_ptr<Module> ParseModule(const std::string& source) {
+  Errors errors;
+  std::unique_ptr<WastLexer> lexer =
+      WastLexer::CreateBufferLexer("bench.wat", source.data(), source.size());
+  WastParseOptions options((Features()));
+  std::unique_ptr<Module> module;
+  Result result = ParseWatModule(lexer.get(), &module, &errors, &options);
+  assert(Succeeded(result));
+  WABT_USE(result);
+  return module;
+}
+
+std::vector<uint8_t> MakeModuleBinary(int num_funcs) {
+  std::unique_ptr<Module> module = ParseModule(MakeModuleSource(num_funcs));
+  MemoryStream stream;
+  Result result = WriteBinaryModule(&stream, module.get(),
+                                    WriteBinaryOptions());
+  assert(Succeeded(result));
+  WABT_USE(result);
+  return stream.output_buffer().data;
+}
+
+void BM_ReadU32Leb128(benchmark::State& state) {
+  // A buffer of varints covering all encoded lengths.
+  MemoryStream stream;
+  for (uint32_t i = 0; i != 10000; ++i) {
+    WriteU32Leb128(&stream, i * i, "value");
+  }
+  const std::vector<uint8_t>& data = stream.output_buffer().data;
+  const uint8_t* end = data.data() + data.size();
+  while (state.KeepRunning()) {
+    const uint8_t* p = data.data();
+    uint32_t value = 0;
+    while (p < end) {
+      p += ReadU32Leb128(p, end, &value);
+    }
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_ReadU32Leb128);
+
+void BM_LexWat(benchmark::State& state) {
+  std::string source = MakeModuleSource(100);
+  while (state.KeepRunning()) {
+    Errors errors;
+    std::unique_ptr<WastLexer> lexer =
+        WastLexer::CreateBufferLexer("bench.wat", source.data(), source.size());
+    WastParseOptions options((Features()));
+    WastParser parser(lexer.get(), &errors, &options);
+    int num_tokens = 0;
+    while (lexer->GetToken(&parser).token_type() != TokenType::Eof) {
+      ++num_tokens;
+    }
+    benchmark::DoNotOptimize(num_tokens);
+  }
+  state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_LexWat);
+
+void BM_ReadBinaryIr(benchmark::State& state) {
+  std::vector<uint8_t> data = MakeModuleBinary(100);
+  ReadBinaryOptions options;
+  while (state.KeepRunning()) {
+    Errors errors;
+    Module module;
+    Result result = ReadBinaryIr("bench.wasm", data.data(), data.size(),
+                                 options, &errors, &module);
+    assert(Succeeded(result));
+    WABT_USE(result);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_ReadBinaryIr);
+
+void BM_WriteModule(benchmark::State& state) {
+  std::unique_ptr<Module> module = ParseModule(MakeModuleSource(100));
+  while (state.KeepRunning()) {
+    MemoryStream stream;
+    Result result = WriteBinaryModule(&stream, module.get(),
+                                      WriteBinaryOptions());
+    assert(Succeeded(result));
+    WABT_USE(result);
+    benchmark::DoNotOptimize(stream.output_buffer().size());
+  }
+}
+BENCHMARK(BM_WriteModule);
+
+void BM_InterpRun(benchmark::State& state) {
+  std::vector<uint8_t> data = MakeModuleBinary(1);
+  interp::Environment env((Features()));
+  interp::DefinedModule* module = nullptr;
+  Errors errors;
+  Result result = ReadBinaryInterp(&env, data.data(), data.size(),
+                                   ReadBinaryOptions(), &errors, &module);
+  assert(Succeeded(result));
+  WABT_USE(result);
+  interp::Executor executor(&env);
+  interp::ExecResult init_result = executor.Initialize(module);
+  assert(init_result.ok());
+  WABT_USE(init_result);
+  while (state.KeepRunning()) {
+    interp::ExecResult exec_result =
+        executor.RunExportByName(module, "run", interp::TypedValues());
+    assert(exec_result.ok());
+    benchmark::DoNotOptimize(exec_result.values);
+  }
+  state.SetItemsProcessed(state.iterations() * kRunLoopCount);
+}
+BENCHMARK(BM_InterpRun);
+
+}  // end of anonymous namespace
+
+BENCHMARK_MAIN();
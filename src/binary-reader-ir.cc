@@ -16,13 +16,16 @@
 
 #include "src/binary-reader-ir.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <thread>
 #include <vector>
 
+#include "src/binary-reader-impl.h"
 #include "src/binary-reader-nop.h"
 #include "src/cast.h"
 #include "src/common.h"
@@ -43,12 +46,25 @@ struct LabelNode {
 LabelNode::LabelNode(LabelType label_type, ExprList* exprs, Expr* context)
     : label_type(label_type), exprs(exprs), context(context) {}
 
-class BinaryReaderIR : public BinaryReaderNop {
+// final so the delegate-typed reader (see binary-reader-impl.h) dispatches
+// the callbacks without going through the vtable.
+class BinaryReaderIR final : public BinaryReaderNop {
  public:
   BinaryReaderIR(Module* out_module,
                  const char* filename,
                  Errors* errors);
 
+  // Used by ReadBinaryIr's parallel mode: when recording is enabled the
+  // module is read with skip_function_bodies set, and BeginFunctionBody
+  // records where each code entry lives instead of decoding into a Func.
+  struct CodeEntry {
+    Index func_index;
+    Offset offset;
+    Offset end_offset;
+  };
+  void set_record_code_entries(bool record) { record_code_entries_ = record; }
+  const std::vector<CodeEntry>& code_entries() const { return code_entries_; }
+
   bool OnError(const Error&) override;
 
   Result OnTypeCount(Index count) override;
@@ -113,6 +129,7 @@ class BinaryReaderIR : public BinaryReaderNop {
 
   Result OnFunctionBodyCount(Index count) override;
   Result BeginFunctionBody(Index index, Offset size) override;
+  Result OnLocalDeclCount(Index count) override;
   Result OnLocalDecl(Index decl_index, Index count, Type type) override;
 
   Result OnAtomicLoadExpr(Opcode opcode,
@@ -233,7 +250,7 @@ class BinaryReaderIR : public BinaryReaderNop {
                      string_view local_name) override;
 
   Result BeginEventSection(Offset size) override { return Result::Ok; }
-  Result OnEventCount(Index count) override { return Result::Ok; }
+  Result OnEventCount(Index count) override;
   Result OnEventType(Index index, Index sig_index) override;
   Result EndEventSection() override { return Result::Ok; }
 
@@ -268,6 +285,8 @@ class BinaryReaderIR : public BinaryReaderNop {
   std::vector<LabelNode> label_stack_;
   ExprList* current_init_expr_ = nullptr;
   const char* filename_;
+  bool record_code_entries_ = false;
+  std::vector<CodeEntry> code_entries_;
 };
 
 BinaryReaderIR::BinaryReaderIR(Module* out_module,
@@ -596,11 +615,23 @@ Result BinaryReaderIR::OnFunctionBodyCount(Index count) {
 }
 
 Result BinaryReaderIR::BeginFunctionBody(Index index, Offset size) {
+  if (record_code_entries_) {
+    code_entries_.push_back(CodeEntry{index, state->offset,
+                                      state->offset + size});
+    return Result::Ok;
+  }
   current_func_ = module_->funcs[index];
   PushLabel(LabelType::Func, &current_func_->exprs);
   return Result::Ok;
 }
 
+Result BinaryReaderIR::OnLocalDeclCount(Index count) {
+  WABT_TRY
+  current_func_->local_types.reserve(count);
+  WABT_CATCH_BAD_ALLOC
+  return Result::Ok;
+}
+
 Result BinaryReaderIR::OnLocalDecl(Index decl_index, Index count, Type type) {
   current_func_->local_types.AppendDecl(type, count);
   return Result::Ok;
@@ -976,6 +1007,9 @@ Result BinaryReaderIR::OnUnreachableExpr() {
 }
 
 Result BinaryReaderIR::EndFunctionBody(Index index) {
+  if (record_code_entries_) {
+    return Result::Ok;
+  }
   CHECK_RESULT(PopLabel());
   current_func_ = nullptr;
   return Result::Ok;
@@ -1101,6 +1135,9 @@ Result BinaryReaderIR::OnFunctionNamesCount(Index count) {
                count, module_->funcs.size());
     return Result::Error;
   }
+  WABT_TRY
+  module_->func_bindings.reserve(count);
+  WABT_CATCH_BAD_ALLOC
   return Result::Ok;
 }
 
@@ -1140,6 +1177,9 @@ Result BinaryReaderIR::OnLocalNameLocalCount(Index index, Index count) {
                count, num_params_and_locals);
     return Result::Error;
   }
+  WABT_TRY
+  func->bindings.reserve(count);
+  WABT_CATCH_BAD_ALLOC
   return Result::Ok;
 }
 
@@ -1205,6 +1245,13 @@ Result BinaryReaderIR::OnLocalName(Index func_index,
   return Result::Ok;
 }
 
+Result BinaryReaderIR::OnEventCount(Index count) {
+  WABT_TRY
+  module_->events.reserve(module_->num_event_imports + count);
+  WABT_CATCH_BAD_ALLOC
+  return Result::Ok;
+}
+
 Result BinaryReaderIR::OnEventType(Index index, Index sig_index) {
   auto field = MakeUnique<EventModuleField>(GetLocation());
   Event& event = field->event;
@@ -1224,7 +1271,128 @@ Result ReadBinaryIr(const char* filename,
                     Errors* errors,
                     Module* out_module) {
   BinaryReaderIR reader(out_module, filename, errors);
-  return ReadBinary(data, size, &reader, options);
+  // Logging the read from several threads would interleave badly, so only
+  // decode in parallel when it is off.
+  if (options.num_threads <= 1 || options.log_stream) {
+    return ReadBinary(data, size, &reader, options);
+  }
+
+  // First pass: read everything except the contents of the code entries,
+  // recording where each entry lives.
+  ReadBinaryOptions skip_options = options;
+  skip_options.skip_function_bodies = true;
+  reader.set_record_code_entries(true);
+  Result result = ReadBinary(data, size, &reader, skip_options);
+  const std::vector<BinaryReaderIR::CodeEntry>& entries = reader.code_entries();
+  if (Failed(result) || entries.empty()) {
+    return result;
+  }
+
+  // Second pass: decode the recorded entries on worker threads. A worker only
+  // writes to the Funcs of its own contiguous slice of entries and only reads
+  // shared module-level state; its local Errors are merged back in function
+  // order.
+  CodeEntryContext context;
+  context.num_signatures = out_module->func_types.size();
+  context.num_funcs = out_module->funcs.size();
+  context.num_tables = out_module->tables.size();
+
+  size_t num_threads = std::min<size_t>(options.num_threads, entries.size());
+  size_t entries_per_thread = (entries.size() + num_threads - 1) / num_threads;
+  std::vector<Errors> thread_errors(num_threads);
+  std::vector<Result> thread_results(num_threads, Result::Ok);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    size_t begin = i * entries_per_thread;
+    size_t end = std::min(begin + entries_per_thread, entries.size());
+    threads.emplace_back([&, i, begin, end]() {
+      BinaryReaderIR entry_reader(out_module, filename, &thread_errors[i]);
+      for (size_t j = begin; j < end; ++j) {
+        const BinaryReaderIR::CodeEntry& entry = entries[j];
+        if (Failed(ReadBinaryCodeEntry(data, size, entry.offset,
+                                       entry.end_offset, entry.func_index,
+                                       context, &entry_reader, options))) {
+          thread_results[i] = Result::Error;
+          break;
+        }
+      }
+    });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    if (Failed(thread_results[i])) {
+      result = Result::Error;
+    }
+    errors->insert(errors->end(), thread_errors[i].begin(),
+                   thread_errors[i].end());
+  }
+  return result;
+}
+
+Result ReadBinaryIrLazy(const char* filename,
+                        const void* data,
+                        size_t size,
+                        const ReadBinaryOptions& options,
+                        Errors* errors,
+                        Module* out_module,
+                        LazyFuncBodies* out_lazy) {
+  BinaryReaderIR reader(out_module, filename, errors);
+  ReadBinaryOptions skip_options = options;
+  skip_options.skip_function_bodies = true;
+  reader.set_record_code_entries(true);
+  Result result = ReadBinary(data, size, &reader, skip_options);
+  if (Failed(result)) {
+    return result;
+  }
+
+  for (const BinaryReaderIR::CodeEntry& entry : reader.code_entries()) {
+    Func* func = out_module->funcs[entry.func_index];
+    func->lazy_body_offset = entry.offset;
+    func->lazy_body_end = entry.end_offset;
+    func->lazy_body_index = entry.func_index;
+  }
+
+  out_lazy->module_ = out_module;
+  out_lazy->data_ = data;
+  out_lazy->size_ = size;
+  out_lazy->filename_ = filename;
+  out_lazy->options_ = options;
+  out_lazy->context_.num_signatures = out_module->func_types.size();
+  out_lazy->context_.num_funcs = out_module->funcs.size();
+  out_lazy->context_.num_tables = out_module->tables.size();
+  return result;
+}
+
+Result LazyFuncBodies::ReadFuncBody(Func* func, Errors* errors) {
+  if (func->lazy_body_end == 0) {
+    return Result::Ok;
+  }
+  assert(func->lazy_body_index < module_->funcs.size());
+  BinaryReaderIR entry_reader(module_, filename_.c_str(), errors);
+  Result result =
+      ReadBinaryCodeEntry(data_, size_, func->lazy_body_offset,
+                          func->lazy_body_end, func->lazy_body_index, context_,
+                          &entry_reader, options_);
+  // Mark the body decoded even on error, so a failing body isn't re-decoded
+  // (and its errors re-reported) by a later access.
+  func->lazy_body_offset = 0;
+  func->lazy_body_end = 0;
+  return result;
+}
+
+Result LazyFuncBodies::ReadAllFuncBodies(Errors* errors) {
+  Result result = Result::Ok;
+  for (Func* func : module_->funcs) {
+    if (Failed(ReadFuncBody(func, errors))) {
+      result = Result::Error;
+    }
+  }
+  return result;
 }
 
 }  // namespace wabt
@@ -17,13 +17,16 @@
 #ifndef WABT_BINARY_READER_IR_H_
 #define WABT_BINARY_READER_IR_H_
 
+#include <string>
+
+#include "src/binary-reader.h"
 #include "src/common.h"
 #include "src/error.h"
 
 namespace wabt {
 
+struct Func;
 struct Module;
-struct ReadBinaryOptions;
 
 Result ReadBinaryIr(const char* filename,
                     const void* data,
@@ -32,6 +35,48 @@ Result ReadBinaryIr(const char* filename,
                     Errors*,
                     Module* out_module);
 
+// Holds everything needed to decode the function bodies that
+// ReadBinaryIrLazy left undecoded. The module data passed to
+// ReadBinaryIrLazy must stay alive for as long as this is used.
+class LazyFuncBodies {
+ public:
+  LazyFuncBodies() = default;
+
+  // Decodes the body of the given function if it hasn't been decoded yet.
+  Result ReadFuncBody(Func* func, Errors*);
+  // Decodes all function bodies that haven't been decoded yet.
+  Result ReadAllFuncBodies(Errors*);
+
+ private:
+  friend Result ReadBinaryIrLazy(const char*,
+                                 const void*,
+                                 size_t,
+                                 const ReadBinaryOptions&,
+                                 Errors*,
+                                 Module*,
+                                 LazyFuncBodies*);
+
+  Module* module_ = nullptr;
+  const void* data_ = nullptr;
+  size_t size_ = 0;
+  std::string filename_;
+  ReadBinaryOptions options_;
+  CodeEntryContext context_;
+};
+
+// Reads the module like ReadBinaryIr, but leaves function bodies undecoded:
+// each Func records the byte range of its code entry (Func::lazy_body_offset/
+// lazy_body_end) and its ExprList stays empty until the body is read through
+// `out_lazy`. Tools that only inspect headers and names avoid decoding any
+// bodies at all.
+Result ReadBinaryIrLazy(const char* filename,
+                        const void* data,
+                        size_t size,
+                        const ReadBinaryOptions& options,
+                        Errors*,
+                        Module* out_module,
+                        LazyFuncBodies* out_lazy);
+
 }  // namespace wabt
 
 #endif /* WABT_BINARY_READER_IR_H_ */
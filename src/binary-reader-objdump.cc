@@ -27,6 +27,10 @@
 #include "src/filenames.h"
 #include "src/literal.h"
 
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
 namespace wabt {
 
 namespace {
@@ -54,6 +58,7 @@ class BinaryReaderObjdumpBase : public BinaryReaderNop {
   string_view GetEventName(Index index) const;
   string_view GetSymbolName(Index index) const;
   string_view GetSegmentName(Index index) const;
+  string_view MaybeDemangleName(string_view name) const;
   void PrintRelocation(const Reloc& reloc, Offset offset) const;
   Offset GetSectionStart(BinarySection section_code) const {
     return section_starts_[static_cast<size_t>(section_code)];
@@ -125,6 +130,42 @@ Result BinaryReaderObjdumpBase::BeginModule(uint32_t version) {
   return Result::Ok;
 }
 
+// Demangles an Itanium-mangled name, or returns it unchanged (like c++filt)
+// when it doesn't demangle or the compiler provides no demangler.
+static std::string Demangle(const std::string& name) {
+#ifdef __GNUC__
+  int status;
+  char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr,
+                                        &status);
+  if (demangled) {
+    std::string result = demangled;
+    free(demangled);
+    return result;
+  }
+#endif
+  return name;
+}
+
+// Returns the name to print for |name|: the demangled form when --demangle
+// is given, otherwise the name itself. Demangled forms are cached in the
+// shared ObjdumpState, so a name appearing in many sections (imports,
+// exports, symtab, relocs, disassembly) is demangled once per run.
+string_view BinaryReaderObjdumpBase::MaybeDemangleName(
+    string_view name) const {
+  if (!options_->demangle || name.empty()) {
+    return name;
+  }
+  std::string key = name.to_string();
+  auto iter = objdump_state_->demangled_names.find(key);
+  if (iter == objdump_state_->demangled_names.end()) {
+    std::string demangled = Demangle(key);
+    iter = objdump_state_->demangled_names
+               .emplace(std::move(key), std::move(demangled))
+               .first;
+  }
+  return iter->second;
+}
+
 string_view BinaryReaderObjdumpBase::GetFunctionName(Index index) const {
   return objdump_state_->function_names.Get(index);
 }
@@ -209,7 +250,7 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
   }
 
   Result OnFunctionName(Index index, string_view name) override {
-    SetFunctionName(index, name);
+    SetFunctionName(index, MaybeDemangleName(name));
     return Result::Ok;
   }
 
@@ -224,7 +265,8 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                       Index segment,
                       uint32_t offset,
                       uint32_t size) override {
-    objdump_state_->symtab[index] = {SymbolType::Data, name.to_string(), 0};
+    objdump_state_->symtab[index] = {SymbolType::Data,
+                                     MaybeDemangleName(name).to_string(), 0};
     return Result::Ok;
   }
 
@@ -232,6 +274,7 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                           uint32_t flags,
                           string_view name,
                           Index func_index) override {
+    name = MaybeDemangleName(name);
     if (!name.empty()) {
       SetFunctionName(func_index, name);
     }
@@ -244,6 +287,7 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                         uint32_t flags,
                         string_view name,
                         Index global_index) override {
+    name = MaybeDemangleName(name);
     if (!name.empty()) {
       SetGlobalName(global_index, name);
     }
@@ -265,6 +309,7 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                         uint32_t flags,
                         string_view name,
                         Index event_index) override {
+    name = MaybeDemangleName(name);
     if (!name.empty()) {
       SetEventName(event_index, name);
     }
@@ -279,7 +324,8 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                       Index func_index,
                       Index sig_index) override {
     SetFunctionName(func_index,
-                    module_name.to_string() + "." + field_name.to_string());
+                    module_name.to_string() + "." +
+                        MaybeDemangleName(field_name).to_string());
     return Result::Ok;
   }
 
@@ -289,7 +335,8 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                        Index event_index,
                        Index sig_index) override {
     SetEventName(event_index,
-                 module_name.to_string() + "." + field_name.to_string());
+                 module_name.to_string() + "." +
+                     MaybeDemangleName(field_name).to_string());
     return Result::Ok;
   }
 
@@ -300,7 +347,8 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                         Type type,
                         bool mutable_) override {
     SetGlobalName(global_index,
-                  module_name.to_string() + "." + field_name.to_string());
+                  module_name.to_string() + "." +
+                      MaybeDemangleName(field_name).to_string());
     return Result::Ok;
   }
 
@@ -309,9 +357,9 @@ class BinaryReaderObjdumpPrepass : public BinaryReaderObjdumpBase {
                   Index item_index,
                   string_view name) override {
     if (kind == ExternalKind::Func) {
-      SetFunctionName(item_index, name);
+      SetFunctionName(item_index, MaybeDemangleName(name));
     } else if (kind == ExternalKind::Global) {
-      SetGlobalName(item_index, name);
+      SetGlobalName(item_index, MaybeDemangleName(name));
     }
     return Result::Ok;
   }
@@ -892,6 +940,10 @@ class BinaryReaderObjdump : public BinaryReaderObjdumpBase {
   Index elem_index_ = 0;
   Index table_index_ = 0;
   Index next_data_reloc_ = 0;
+  // Per-type counts for the current reloc section (ObjdumpOptions::
+  // reloc_summary); flushed when the section's last entry arrives.
+  Index reloc_type_counts_[kRelocTypeCount] = {};
+  Index relocs_remaining_ = 0;
   bool in_data_section_ = false;
   bool in_elem_section_ = false;
   InitExpr data_init_expr_;
@@ -1120,7 +1172,7 @@ Result BinaryReaderObjdump::OnImportFunc(Index import_index,
   }
   PrintDetails(" <- " PRIstringview "." PRIstringview "\n",
                WABT_PRINTF_STRING_VIEW_ARG(module_name),
-               WABT_PRINTF_STRING_VIEW_ARG(field_name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(field_name)));
   return Result::Ok;
 }
 
@@ -1137,7 +1189,7 @@ Result BinaryReaderObjdump::OnImportTable(Index import_index,
   }
   PrintDetails(" <- " PRIstringview "." PRIstringview "\n",
                WABT_PRINTF_STRING_VIEW_ARG(module_name),
-               WABT_PRINTF_STRING_VIEW_ARG(field_name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(field_name)));
   return Result::Ok;
 }
 
@@ -1153,7 +1205,7 @@ Result BinaryReaderObjdump::OnImportMemory(Index import_index,
   }
   PrintDetails(" <- " PRIstringview "." PRIstringview "\n",
                WABT_PRINTF_STRING_VIEW_ARG(module_name),
-               WABT_PRINTF_STRING_VIEW_ARG(field_name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(field_name)));
   return Result::Ok;
 }
 
@@ -1167,7 +1219,7 @@ Result BinaryReaderObjdump::OnImportGlobal(Index import_index,
                GetTypeName(type), mutable_);
   PrintDetails(" <- " PRIstringview "." PRIstringview "\n",
                WABT_PRINTF_STRING_VIEW_ARG(module_name),
-               WABT_PRINTF_STRING_VIEW_ARG(field_name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(field_name)));
   return Result::Ok;
 }
 
@@ -1184,7 +1236,7 @@ Result BinaryReaderObjdump::OnImportEvent(Index import_index,
   }
   PrintDetails(" <- " PRIstringview "." PRIstringview "\n",
                WABT_PRINTF_STRING_VIEW_ARG(module_name),
-               WABT_PRINTF_STRING_VIEW_ARG(field_name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(field_name)));
   return Result::Ok;
 }
 
@@ -1235,7 +1287,7 @@ Result BinaryReaderObjdump::OnExport(Index index,
   }
 
   PrintDetails(" -> \"" PRIstringview "\"\n",
-               WABT_PRINTF_STRING_VIEW_ARG(name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(name)));
   return Result::Ok;
 }
 
@@ -1443,7 +1495,7 @@ Result BinaryReaderObjdump::OnModuleName(string_view name) {
 
 Result BinaryReaderObjdump::OnFunctionName(Index index, string_view name) {
   PrintDetails(" - func[%" PRIindex "] <" PRIstringview ">\n", index,
-               WABT_PRINTF_STRING_VIEW_ARG(name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(name)));
   return Result::Ok;
 }
 
@@ -1453,7 +1505,8 @@ Result BinaryReaderObjdump::OnLocalName(Index func_index,
   if (!name.empty()) {
     PrintDetails(" - func[%" PRIindex "] local[%" PRIindex "] <" PRIstringview
                  ">\n",
-                 func_index, local_index, WABT_PRINTF_STRING_VIEW_ARG(name));
+                 func_index, local_index,
+                 WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(name)));
   }
   return Result::Ok;
 }
@@ -1547,6 +1600,10 @@ Result BinaryReaderObjdump::OnRelocCount(Index count, Index section_index) {
                section_index,
                WABT_PRINTF_STRING_VIEW_ARG(GetSectionName(section_index)),
                count);
+  if (options_->reloc_summary) {
+    memset(reloc_type_counts_, 0, sizeof(reloc_type_counts_));
+    relocs_remaining_ = count;
+  }
   return Result::Ok;
 }
 
@@ -1554,6 +1611,19 @@ Result BinaryReaderObjdump::OnReloc(RelocType type,
                                     Offset offset,
                                     Index index,
                                     uint32_t addend) {
+  if (options_->reloc_summary) {
+    reloc_type_counts_[static_cast<size_t>(type)]++;
+    if (--relocs_remaining_ == 0) {
+      for (int i = 0; i < kRelocTypeCount; ++i) {
+        if (reloc_type_counts_[i]) {
+          PrintDetails("   - %-18s count=%" PRIindex "\n",
+                       GetRelocTypeName(static_cast<RelocType>(i)),
+                       reloc_type_counts_[i]);
+        }
+      }
+    }
+    return Result::Ok;
+  }
   Offset total_offset = GetSectionStart(reloc_section_) + offset;
   PrintDetails("   - %-18s offset=%#08" PRIoffset "(file=%#08" PRIoffset ") ",
                GetRelocTypeName(type), offset, total_offset);
@@ -1635,7 +1705,7 @@ Result BinaryReaderObjdump::OnDataSymbol(Index index,
                                          uint32_t offset,
                                          uint32_t size) {
   PrintDetails("   - %d: D <" PRIstringview ">", index,
-               WABT_PRINTF_STRING_VIEW_ARG(name));
+               WABT_PRINTF_STRING_VIEW_ARG(MaybeDemangleName(name)));
   if (!(flags & WABT_SYMBOL_FLAG_UNDEFINED))
     PrintDetails(" segment=%" PRIindex " offset=%d size=%d", segment, offset,
                  size);
@@ -1648,6 +1718,8 @@ Result BinaryReaderObjdump::OnFunctionSymbol(Index index,
                                              Index func_index) {
   if (name.empty()) {
     name = GetFunctionName(func_index);
+  } else {
+    name = MaybeDemangleName(name);
   }
   PrintDetails("   - %d: F <" PRIstringview "> func=%" PRIindex, index,
                WABT_PRINTF_STRING_VIEW_ARG(name), func_index);
@@ -1660,6 +1732,8 @@ Result BinaryReaderObjdump::OnGlobalSymbol(Index index,
                                            Index global_index) {
   if (name.empty()) {
     name = GetGlobalName(global_index);
+  } else {
+    name = MaybeDemangleName(name);
   }
   PrintDetails("   - %d: G <" PRIstringview "> global=%" PRIindex, index,
                WABT_PRINTF_STRING_VIEW_ARG(name), global_index);
@@ -1682,6 +1756,8 @@ Result BinaryReaderObjdump::OnEventSymbol(Index index,
                                           Index event_index) {
   if (name.empty()) {
     name = GetEventName(event_index);
+  } else {
+    name = MaybeDemangleName(name);
   }
   PrintDetails("   - [%d] E <" PRIstringview "> event=%" PRIindex, index,
                WABT_PRINTF_STRING_VIEW_ARG(name), event_index);
@@ -1786,6 +1862,12 @@ Result ReadBinaryObjdump(const uint8_t* data,
   const bool kFailOnCustomSectionError = false;
   ReadBinaryOptions read_options(features, options->log_stream, kReadDebugNames,
                                  kStopOnFirstError, kFailOnCustomSectionError);
+  // Only the disassembly pass looks inside function bodies. Every other pass
+  // sees just BeginFunctionBody/EndFunctionBody and skips decoding the
+  // bodies, which are most of a large module, so dumping headers or details
+  // no longer pays for a full decode per pass.
+  read_options.skip_function_bodies =
+      options->mode != ObjdumpMode::Disassemble;
 
   switch (options->mode) {
     case ObjdumpMode::Prepass: {
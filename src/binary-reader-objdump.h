@@ -17,6 +17,7 @@
 #ifndef WABT_BINARY_READER_OBJDUMP_H_
 #define WABT_BINARY_READER_OBJDUMP_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -45,6 +46,8 @@ struct ObjdumpOptions {
   bool disassemble;
   bool debug;
   bool relocs;
+  bool reloc_summary;
+  bool demangle;
   ObjdumpMode mode;
   const char* filename;
   const char* section_name;
@@ -75,6 +78,10 @@ struct ObjdumpState {
   ObjdumpNames event_names;
   ObjdumpNames segment_names;
   std::vector<ObjdumpSymbol> symtab;
+  // Demangled forms of mangled names, filled on demand and shared by all
+  // passes so each distinct name is demangled once no matter how many
+  // sections print it (see ObjdumpOptions::demangle).
+  std::map<std::string, std::string> demangled_names;
 };
 
 Result ReadBinaryObjdump(const uint8_t* data,
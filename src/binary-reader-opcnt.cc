@@ -180,11 +180,74 @@ bool operator>=(const OpcodeInfo& lhs, const OpcodeInfo& rhs) {
   return !(lhs < rhs);
 }
 
+const size_t OpcodeStats::kNumSlots;
+
+OpcodeStats::OpcodeStats()
+    : counts(kNumSlots), pair_counts(kNumSlots * kNumSlots) {}
+
+size_t& OpcodeStats::Count(Opcode opcode) {
+  return counts[opcode.HotIndex()];
+}
+
+size_t& OpcodeStats::PairCount(Opcode first, Opcode second) {
+  return pair_counts[first.HotIndex() * kNumSlots + second.HotIndex()];
+}
+
+void OpcodeStats::Merge(const OpcodeStats& other) {
+  for (size_t slot = 0; slot < kNumSlots; ++slot) {
+    counts[slot] += other.counts[slot];
+  }
+  for (size_t slot = 0; slot < kNumSlots * kNumSlots; ++slot) {
+    pair_counts[slot] += other.pair_counts[slot];
+  }
+  func_counts.insert(func_counts.end(), other.func_counts.begin(),
+                     other.func_counts.end());
+}
+
+void OpcodeStats::WriteBinary(Stream& stream) const {
+  stream.WriteData("OPCNT01", 8, "magic");
+  stream.WriteU32(kNumSlots, "num slots");
+
+  uint32_t num_counts = 0;
+  for (size_t count : counts) {
+    num_counts += count != 0;
+  }
+  stream.WriteU32(num_counts, "num opcode counts");
+  for (size_t slot = 0; slot < kNumSlots; ++slot) {
+    if (counts[slot] != 0) {
+      stream.WriteU32(slot, "slot");
+      stream.WriteU64(counts[slot], "count");
+    }
+  }
+
+  uint32_t num_pairs = 0;
+  for (size_t count : pair_counts) {
+    num_pairs += count != 0;
+  }
+  stream.WriteU32(num_pairs, "num pair counts");
+  for (size_t first = 0; first < kNumSlots; ++first) {
+    for (size_t second = 0; second < kNumSlots; ++second) {
+      size_t count = pair_counts[first * kNumSlots + second];
+      if (count != 0) {
+        stream.WriteU32(first, "first slot");
+        stream.WriteU32(second, "second slot");
+        stream.WriteU64(count, "count");
+      }
+    }
+  }
+
+  stream.WriteU32(func_counts.size(), "num funcs");
+  for (const FuncCount& func_count : func_counts) {
+    stream.WriteU32(func_count.func_index, "func index");
+    stream.WriteU64(func_count.count, "count");
+  }
+}
+
 namespace {
 
 class BinaryReaderOpcnt : public BinaryReaderNop {
  public:
-  explicit BinaryReaderOpcnt(OpcodeInfoCounts* counts);
+  BinaryReaderOpcnt(OpcodeInfoCounts* counts, OpcodeStats* stats);
 
   Result OnOpcode(Opcode opcode) override;
   Result OnOpcodeBare() override;
@@ -200,19 +263,27 @@ class BinaryReaderOpcnt : public BinaryReaderNop {
                        Index default_target_depth) override;
   Result OnEndExpr() override;
   Result OnEndFunc() override;
+  Result BeginFunctionBody(Index index, Offset size) override;
+  Result EndFunctionBody(Index index) override;
 
  private:
   template <typename... Args>
-  Result Emplace(Args&&... args);
+  Result Emplace(Opcode opcode, Args&&... args);
+  void Record(Opcode opcode);
 
   OpcodeInfoCounts* opcode_counts_;
+  OpcodeStats* stats_;
   Opcode current_opcode_;
+  Opcode prev_opcode_ = Opcode::Invalid;
+  bool in_func_ = false;
 };
 
 template <typename... Args>
-Result BinaryReaderOpcnt::Emplace(Args&&... args) {
+Result BinaryReaderOpcnt::Emplace(Opcode opcode, Args&&... args) {
+  Record(opcode);
   auto pair = opcode_counts_->emplace(
-      std::piecewise_construct, std::make_tuple(std::forward<Args>(args)...),
+      std::piecewise_construct,
+      std::make_tuple(opcode, std::forward<Args>(args)...),
       std::make_tuple(0));
 
   auto& count = pair.first->second;
@@ -220,8 +291,26 @@ Result BinaryReaderOpcnt::Emplace(Args&&... args) {
   return Result::Ok;
 }
 
-BinaryReaderOpcnt::BinaryReaderOpcnt(OpcodeInfoCounts* counts)
-    : opcode_counts_(counts) {}
+// Updates the flat-array statistics; pairs are only counted between
+// consecutive opcodes of the same function body, never across functions or
+// within init expressions.
+void BinaryReaderOpcnt::Record(Opcode opcode) {
+  if (!stats_) {
+    return;
+  }
+  stats_->Count(opcode)++;
+  if (in_func_) {
+    if (prev_opcode_ != Opcode::Invalid) {
+      stats_->PairCount(prev_opcode_, opcode)++;
+    }
+    prev_opcode_ = opcode;
+    stats_->func_counts.back().count++;
+  }
+}
+
+BinaryReaderOpcnt::BinaryReaderOpcnt(OpcodeInfoCounts* counts,
+                                     OpcodeStats* stats)
+    : opcode_counts_(counts), stats_(stats) {}
 
 Result BinaryReaderOpcnt::OnOpcode(Opcode opcode) {
   current_opcode_ = opcode;
@@ -277,13 +366,28 @@ Result BinaryReaderOpcnt::OnEndFunc() {
   return Emplace(Opcode::End, OpcodeInfo::Kind::Bare);
 }
 
+Result BinaryReaderOpcnt::BeginFunctionBody(Index index, Offset size) {
+  if (stats_) {
+    stats_->func_counts.push_back({index, 0});
+    prev_opcode_ = Opcode::Invalid;
+    in_func_ = true;
+  }
+  return Result::Ok;
+}
+
+Result BinaryReaderOpcnt::EndFunctionBody(Index index) {
+  in_func_ = false;
+  return Result::Ok;
+}
+
 }  // end anonymous namespace
 
 Result ReadBinaryOpcnt(const void* data,
                        size_t size,
                        const ReadBinaryOptions& options,
-                       OpcodeInfoCounts* counts) {
-  BinaryReaderOpcnt reader(counts);
+                       OpcodeInfoCounts* counts,
+                       OpcodeStats* stats) {
+  BinaryReaderOpcnt reader(counts, stats);
   return ReadBinary(data, size, &reader, options);
 }
 
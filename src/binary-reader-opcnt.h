@@ -83,10 +83,52 @@ bool operator>=(const OpcodeInfo&, const OpcodeInfo&);
 
 typedef std::map<OpcodeInfo, size_t> OpcodeInfoCounts;
 
+// Aggregate opcode statistics, kept in flat arrays indexed by Opcode::Enum
+// (invalid opcodes share the trailing slot, as in Opcode::HotIndex) so that
+// counting is an array increment instead of a map insertion. Pair counts
+// record consecutive opcodes within one function body, to guide
+// superinstruction selection; func counts record how many opcodes each
+// defined function body contains.
+struct OpcodeStats {
+  struct FuncCount {
+    Index func_index;
+    size_t count;
+  };
+
+  OpcodeStats();
+
+  size_t& Count(Opcode opcode);
+  size_t& PairCount(Opcode first, Opcode second);
+
+  // Writes the statistics in a compact binary format (fixed-width
+  // little-endian fields, non-zero entries only) that can be summed across
+  // many modules without re-reading them:
+  //
+  //   "OPCNT01\0"
+  //   u32 num_slots
+  //   u32 n; n * { u32 slot, u64 count }                   opcode counts
+  //   u32 n; n * { u32 first_slot, u32 second_slot, u64 count }  pair counts
+  //   u32 n; n * { u32 func_index, u64 count }             function counts
+  void WriteBinary(Stream&) const;
+
+  // Adds another table's counts into this one. Used to merge tables counted
+  // from separate modules (e.g. per-thread tables in wasm-opcodecnt's
+  // multi-file mode); function counts are concatenated, so the indices stay
+  // relative to their own module.
+  void Merge(const OpcodeStats& other);
+
+  static const size_t kNumSlots = Opcode::Invalid + 1;
+
+  std::vector<size_t> counts;       // kNumSlots entries.
+  std::vector<size_t> pair_counts;  // kNumSlots * kNumSlots; row = first.
+  std::vector<FuncCount> func_counts;
+};
+
 Result ReadBinaryOpcnt(const void* data,
                        size_t size,
                        const ReadBinaryOptions& options,
-                       OpcodeInfoCounts* opcode_counts);
+                       OpcodeInfoCounts* opcode_counts,
+                       OpcodeStats* stats = nullptr);
 
 }  // namespace wabt
 
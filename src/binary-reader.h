@@ -20,6 +20,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <memory>
+#include <vector>
+
 #include "src/binary.h"
 #include "src/common.h"
 #include "src/error.h"
@@ -49,6 +52,24 @@ struct ReadBinaryOptions {
   bool read_debug_names = false;
   bool stop_on_first_error = true;
   bool fail_on_custom_section_error = true;
+  // When true, skip decoding the contents of each code-section entry; the
+  // delegate sees BeginFunctionBody/EndFunctionBody, but no local declaration
+  // or expression callbacks. Used together with ReadBinaryCodeEntry to decode
+  // the entries separately.
+  bool skip_function_bodies = false;
+  // Number of threads ReadBinaryIr uses to decode function bodies; values
+  // <= 1 decode on the calling thread. Ignored by ReadBinary itself.
+  int num_threads = 1;
+  // When true, ReadBinaryInterp makes data segments reference the bytes of
+  // the module image directly instead of copying them out, so instantiation
+  // does a single memcpy per segment straight from the image. The image must
+  // then outlive the Environment. Ignored by other readers.
+  bool reference_data_segments = false;
+  // When true, errors are reported with an empty message: the level and
+  // location are still filled in, but no text is formatted. For consumers
+  // that only count or locate errors (fuzzing, batch validation), where
+  // rendering messages nobody reads is measurable.
+  bool skip_error_messages = false;
 };
 
 class BinaryReaderDelegate {
@@ -60,6 +81,12 @@ class BinaryReaderDelegate {
     const uint8_t* data;
     Offset size;
     Offset offset;
+
+    // True while callbacks are being delivered out of a buffer synthesized
+    // by the reader (e.g. a decompressed "wabt.compressed-data" payload)
+    // that is freed when the section ends. Delegates that would otherwise
+    // keep pointers into |data| past the callback must copy instead.
+    bool data_is_transient = false;
   };
 
   virtual ~BinaryReaderDelegate() {}
@@ -422,6 +449,103 @@ Result ReadBinary(const void* data,
                   BinaryReaderDelegate* reader,
                   const ReadBinaryOptions& options);
 
+// Module-level counts needed to validate the indices that appear in a
+// function body; ReadBinaryCodeEntry doesn't see the sections these counts
+// come from.
+struct CodeEntryContext {
+  Index num_signatures = 0;
+  Index num_funcs = 0;   // Includes imports.
+  Index num_tables = 0;  // Includes imports.
+};
+
+// Reads a single code-section entry (the local declarations followed by the
+// function body). `data`/`size` span the entire module and `offset`/
+// `end_offset` delimit the entry, so callback state and error offsets match
+// what ReadBinary would report. The delegate sees the same callbacks
+// ReadBinary would emit for the entry, from BeginFunctionBody to
+// EndFunctionBody. Entries are independent, so they may be read concurrently
+// by multiple threads, each with its own delegate.
+Result ReadBinaryCodeEntry(const void* data,
+                           size_t size,
+                           Offset offset,
+                           Offset end_offset,
+                           Index func_index,
+                           const CodeEntryContext& context,
+                           BinaryReaderDelegate* reader,
+                           const ReadBinaryOptions& options);
+
+// One section located by ReadBinarySectionDirectory. `offset`/`size` span
+// the section payload (after the id and size fields) within the module.
+struct SectionDirectoryEntry {
+  BinarySection section_type = BinarySection::Invalid;
+  // Name of a custom section, borrowed from the module image; empty for
+  // known sections.
+  string_view name;
+  Offset offset = 0;
+  Offset size = 0;
+};
+
+// Scans only the section headers of a module -- magic, version, each
+// section's id and size, and the name of custom sections -- and appends one
+// entry per section to |directory|. Section payloads are skipped, not
+// decoded, so the scan cost is proportional to the section count; use it to
+// find one section (a custom section by name, say) in a large module and
+// then decode just that one with ReadBinarySectionAt. The delegate is only
+// used for error reporting.
+Result ReadBinarySectionDirectory(const void* data,
+                                  size_t size,
+                                  BinaryReaderDelegate* delegate,
+                                  const ReadBinaryOptions& options,
+                                  std::vector<SectionDirectoryEntry>* out);
+
+// Reads the single section located by |entry| (from a directory built over
+// the same module bytes), emitting the same delegate callbacks ReadBinary
+// would for that section, minus BeginSection. Sections whose contents are
+// self-contained (custom sections in particular) can be read in isolation;
+// sections that are validated against earlier ones (e.g. code against the
+// function section) should be read in module order.
+Result ReadBinarySectionAt(const void* data,
+                           size_t size,
+                           const SectionDirectoryEntry& entry,
+                           BinaryReaderDelegate* delegate,
+                           const ReadBinaryOptions& options);
+
+template <typename Delegate>
+class BinaryReader;
+
+// Incremental counterpart of ReadBinary, for modules that arrive in chunks
+// (over a socket, say). Feed bytes with PushChunk as they arrive; each call
+// decodes every section that has become complete, emitting the same delegate
+// callbacks ReadBinary would, in the same order, so validation and lowering
+// overlap with the transfer instead of waiting for the full module. Call
+// Finish after the last chunk to run the end-of-module checks and emit
+// EndModule.
+//
+// Chunks are appended to an internal buffer (sections must be decoded from
+// contiguous bytes), so peak memory matches ReadBinary's. Once PushChunk or
+// Finish reports an error the reader is dead; further calls return the same
+// error.
+class ChunkedBinaryReader {
+ public:
+  ChunkedBinaryReader(BinaryReaderDelegate* delegate,
+                      const ReadBinaryOptions& options);
+  ~ChunkedBinaryReader();
+
+  Result PushChunk(const void* data, size_t size);
+  Result Finish();
+
+ private:
+  bool NextSectionComplete() const;
+  Result Process(bool finishing);
+
+  ReadBinaryOptions options_;  // The reader borrows it; keep our own copy.
+  std::unique_ptr<BinaryReaderDelegate> logging_delegate_;
+  std::unique_ptr<BinaryReader<BinaryReaderDelegate>> reader_;
+  std::vector<uint8_t> buffer_;
+  bool read_header_ = false;
+  Result result_ = Result::Ok;
+};
+
 size_t ReadU32Leb128(const uint8_t* ptr,
                      const uint8_t* end,
                      uint32_t* out_value);
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/binary-transform.h"
+
+#include <vector>
+
+#include "src/binary.h"
+#include "src/binary-reader-nop.h"
+#include "src/leb128.h"
+#include "src/stream.h"
+
+namespace wabt {
+
+Result TransformBinary(const void* data,
+                       size_t size,
+                       BinaryTransformDelegate* delegate,
+                       const ReadBinaryOptions& options,
+                       Stream* stream) {
+  typedef BinaryTransformDelegate::SectionAction SectionAction;
+
+  BinaryReaderNop nop_delegate;
+  std::vector<SectionDirectoryEntry> directory;
+  CHECK_RESULT(
+      ReadBinarySectionDirectory(data, size, &nop_delegate, options, &directory));
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+  // The directory scan validated the magic and version; copy them through.
+  const size_t kHeaderSize = 8;
+  stream->WriteData(bytes, kHeaderSize, "module header");
+
+  for (const SectionDirectoryEntry& entry : directory) {
+    switch (delegate->OnSection(entry)) {
+      case SectionAction::Passthrough:
+        stream->WriteU8Enum(entry.section_type, "section code");
+        WriteU32Leb128(stream, entry.size, "section size");
+        // One write straight from the module image; the payload is never
+        // decoded or copied out.
+        stream->WriteData(bytes + entry.offset, entry.size, "section data");
+        break;
+
+      case SectionAction::Replace: {
+        // Collect the replacement payload first; its size field precedes it.
+        MemoryStream payload_stream;
+        CHECK_RESULT(delegate->WriteReplacement(entry, bytes + entry.offset,
+                                                &payload_stream));
+        const OutputBuffer& buf = payload_stream.output_buffer();
+        stream->WriteU8Enum(entry.section_type, "section code");
+        WriteU32Leb128(stream, buf.size(), "section size");
+        stream->WriteData(buf.data.data(), buf.size(), "section data");
+        break;
+      }
+
+      case SectionAction::Remove:
+        break;
+    }
+  }
+
+  CHECK_RESULT(delegate->AppendSections(stream));
+  return stream->result();
+}
+
+}  // namespace wabt
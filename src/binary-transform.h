@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_BINARY_TRANSFORM_H_
+#define WABT_BINARY_TRANSFORM_H_
+
+#include "src/binary-reader.h"
+#include "src/common.h"
+
+namespace wabt {
+
+class Stream;
+
+// Drives a section-level rewrite of a module: TransformBinary scans the
+// module's section directory (headers only; payloads are not decoded), then
+// consults the delegate once per section, in module order. Untouched
+// sections are copied to the output stream as one raw span straight from the
+// module image, so a tool that rewrites a single section pays decode cost
+// for that section alone. Delegates that need to inspect a section's
+// contents can decode it on demand with ReadBinarySectionAt.
+class BinaryTransformDelegate {
+ public:
+  enum class SectionAction {
+    Passthrough,  // Copy the section to the output verbatim.
+    Replace,      // Write a replacement payload via WriteReplacement.
+    Remove,       // Drop the section from the output.
+  };
+
+  virtual ~BinaryTransformDelegate() = default;
+
+  // Called once per section. |entry|'s offset/size span the payload within
+  // the module image (for custom sections, the payload includes the name).
+  virtual SectionAction OnSection(const SectionDirectoryEntry& entry) = 0;
+
+  // Called for each section OnSection chose to Replace. Write the new
+  // payload to |stream|; the section id and size fields are emitted by the
+  // transform. For custom sections the payload must include the name.
+  // |payload| points at the old payload within the module image. The
+  // default implementation fails, so delegates that never Replace need not
+  // override it.
+  virtual Result WriteReplacement(const SectionDirectoryEntry& entry,
+                                  const void* payload,
+                                  Stream* stream) {
+    WABT_USE(entry);
+    WABT_USE(payload);
+    WABT_USE(stream);
+    return Result::Error;
+  }
+
+  // Called after the last input section. Append whole new sections here
+  // (id, size and payload); the default appends nothing.
+  virtual Result AppendSections(Stream* stream) {
+    WABT_USE(stream);
+    return Result::Ok;
+  }
+};
+
+// Rewrites the module in |data|/|size| to |stream| as directed by the
+// delegate. Fails without writing anything if the section directory can't be
+// scanned; fails part-written if the delegate fails, so transform into a
+// MemoryStream when the output must be all-or-nothing.
+Result TransformBinary(const void* data,
+                       size_t size,
+                       BinaryTransformDelegate* delegate,
+                       const ReadBinaryOptions& options,
+                       Stream* stream);
+
+}  // namespace wabt
+
+#endif  // WABT_BINARY_TRANSFORM_H_
@@ -16,8 +16,10 @@
 
 #include "src/binary-writer-spec.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
+#include <thread>
 
 #include "config.h"
 
@@ -63,6 +65,7 @@ class BinaryWriterSpec {
                          const ScriptModule& script_module);
   void WriteInvalidModule(const ScriptModule& module, string_view text);
   void WriteCommands();
+  void WriteDeferredModules();
 
   const Script* script_ = nullptr;
   Stream* json_stream_ = nullptr;
@@ -72,6 +75,9 @@ class BinaryWriterSpec {
   const WriteBinaryOptions& options_;
   Result result_ = Result::Ok;
   size_t num_modules_ = 0;
+  // Modules whose serialization was deferred so it can run on a worker
+  // pool after the JSON (which only needs the filenames) is written.
+  std::vector<std::pair<Stream*, const Module*>> deferred_modules_;
 };
 
 BinaryWriterSpec::BinaryWriterSpec(
@@ -298,8 +304,12 @@ void BinaryWriterSpec::WriteActionResultType(const Action& action) {
 }
 
 void BinaryWriterSpec::WriteModule(string_view filename, const Module& module) {
-  result_ |=
-      WriteBinaryModule(module_stream_factory_(filename), &module, options_);
+  Stream* stream = module_stream_factory_(filename);
+  if (options_.num_threads > 1) {
+    deferred_modules_.emplace_back(stream, &module);
+  } else {
+    result_ |= WriteBinaryModule(stream, &module, options_);
+  }
 }
 
 void BinaryWriterSpec::WriteScriptModule(string_view filename,
@@ -535,9 +545,44 @@ void BinaryWriterSpec::WriteCommands() {
   json_stream_->Writef("]}\n");
 }
 
+void BinaryWriterSpec::WriteDeferredModules() {
+  if (deferred_modules_.empty()) {
+    return;
+  }
+
+  // Each module serializes into its own stream, so the entries are
+  // independent; split them across the pool in chunks.
+  size_t num_threads =
+      std::min<size_t>(options_.num_threads, deferred_modules_.size());
+  size_t modules_per_thread =
+      (deferred_modules_.size() + num_threads - 1) / num_threads;
+  std::vector<Result> thread_results(num_threads, Result::Ok);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    size_t begin = i * modules_per_thread;
+    size_t end = std::min(begin + modules_per_thread, deferred_modules_.size());
+    threads.emplace_back([&, i, begin, end]() {
+      for (size_t j = begin; j < end; ++j) {
+        thread_results[i] |= WriteBinaryModule(
+            deferred_modules_[j].first, deferred_modules_[j].second, options_);
+      }
+    });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (Result thread_result : thread_results) {
+    result_ |= thread_result;
+  }
+}
+
 Result BinaryWriterSpec::WriteScript(const Script& script) {
   script_ = &script;
   WriteCommands();
+  WriteDeferredModules();
   return result_;
 }
 
@@ -570,9 +615,15 @@ Result WriteBinarySpecScript(
         return out_module_streams->back().stream.get();
       };
 
+  // Logged writes would interleave across workers; keep them ordered.
+  WriteBinaryOptions adjusted_options = options;
+  if (log_stream) {
+    adjusted_options.num_threads = 1;
+  }
+
   BinaryWriterSpec binary_writer_spec(json_stream, module_stream_factory,
                                       source_filename, module_filename_noext,
-                                      options);
+                                      adjusted_options);
   return binary_writer_spec.WriteScript(*script);
 }
 
@@ -21,12 +21,17 @@
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <unordered_map>
 #include <vector>
 
 #include "config.h"
 
 #include "src/binary.h"
+#include "src/binary-reader.h"
+#include "src/binary-reader-nop.h"
 #include "src/cast.h"
+#include "src/data-compression.h"
 #include "src/ir.h"
 #include "src/leb128.h"
 #include "src/stream.h"
@@ -102,16 +107,112 @@ struct Symbol {
   Index element_index;
 };
 
+size_t CountExprs(const ExprList& exprs) {
+  size_t result = exprs.size();
+  for (const Expr& expr : exprs) {
+    switch (expr.type()) {
+      case ExprType::Block:
+        result += CountExprs(cast<BlockExpr>(&expr)->block.exprs);
+        break;
+
+      case ExprType::Loop:
+        result += CountExprs(cast<LoopExpr>(&expr)->block.exprs);
+        break;
+
+      case ExprType::If: {
+        auto* if_expr = cast<IfExpr>(&expr);
+        result += CountExprs(if_expr->true_.exprs);
+        result += CountExprs(if_expr->false_);
+        break;
+      }
+
+      case ExprType::Try: {
+        auto* try_expr = cast<TryExpr>(&expr);
+        result += CountExprs(try_expr->block.exprs);
+        result += CountExprs(try_expr->catch_);
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+  return result;
+}
+
+// Rough estimate of the size of the final binary, used as a reservation hint
+// for the output stream so it doesn't grow its storage repeatedly. Bytes we
+// know exactly (data segments, names) are counted; everything else is
+// charged a small constant per entity or expression. Overshooting a little
+// is fine, so round up rather than down.
+size_t EstimateModuleSize(const Module& module) {
+  size_t estimate = 32;  // Magic, version, section ids and sizes.
+  for (const FuncType* func_type : module.func_types) {
+    estimate += 4 + func_type->sig.param_types.size() +
+                func_type->sig.result_types.size();
+  }
+  for (const Import* import : module.imports) {
+    estimate +=
+        8 + import->module_name.size() + import->field_name.size();
+  }
+  for (const Func* func : module.funcs) {
+    estimate += 8 + 2 * func->local_types.size();
+    estimate += 4 * CountExprs(func->exprs);
+  }
+  estimate += 8 * (module.tables.size() + module.memories.size() +
+                   module.events.size() + module.starts.size());
+  for (const Global* global : module.globals) {
+    estimate += 8 + 4 * CountExprs(global->init_expr);
+  }
+  for (const Export* export_ : module.exports) {
+    estimate += 4 + export_->name.size();
+  }
+  for (const ElemSegment* segment : module.elem_segments) {
+    estimate += 8 + 4 * segment->elem_exprs.size();
+  }
+  for (const DataSegment* segment : module.data_segments) {
+    estimate += 8 + segment->data.size();
+  }
+  return estimate;
+}
+
+// Discards everything written to it; the streaming writer's measuring pass
+// only needs the offsets.
+class SizeCountingStream : public Stream {
+ public:
+  SizeCountingStream() = default;
+
+ protected:
+  Result WriteDataImpl(size_t, const void*, size_t) override {
+    return Result::Ok;
+  }
+  Result MoveDataImpl(size_t, size_t, size_t) override { return Result::Ok; }
+};
+
 class BinaryWriter {
   WABT_DISALLOW_COPY_AND_ASSIGN(BinaryWriter);
 
  public:
+  // In streaming mode WriteModule runs twice: a Measure pass that discards
+  // its output but records the exact payload size of every size-prefixed
+  // region (section, subsection, function body) in `sizes`, then an Emit
+  // pass that consumes `sizes` and writes each size as an exact LEB128 up
+  // front, so nothing in the output stream is ever patched or moved.
+  enum class StreamingPass { None, Measure, Emit };
+
   BinaryWriter(Stream*,
                const WriteBinaryOptions& options,
-               const Module* module);
+               const Module* module,
+               StreamingPass streaming_pass = StreamingPass::None,
+               std::vector<Offset>* streaming_sizes = nullptr);
 
   Result WriteModule();
 
+  // Writes one code-section entry -- body size LEB followed by locals and
+  // body -- for |func|. Used by the code section loop and by
+  // PatchBinaryFunction.
+  Result WriteCodeEntry(const Func* func);
+
  private:
   void WriteHeader(const char* name, int index);
   Offset WriteU32Leb128Space(Offset leb_size_guess, const char* desc);
@@ -137,6 +238,8 @@ class BinaryWriter {
   void WriteLoadStoreExpr(const Func* func, const Expr* expr, const char* desc);
   void WriteExpr(const Func* func, const Expr* expr);
   void WriteExprList(const Func* func, const ExprList& exprs);
+  ExprList::const_iterator WriteConstRun(ExprList::const_iterator first,
+                                         ExprList::const_iterator end);
   void WriteInitExpr(const ExprList& expr);
   void WriteFuncLocals(const Func* func, const LocalTypes& local_types);
   void WriteFunc(const Func* func);
@@ -144,6 +247,7 @@ class BinaryWriter {
   void WriteMemory(const Memory* memory);
   void WriteGlobalHeader(const Global* global);
   void WriteEventType(const Event* event);
+  void WriteDataSegments();
   void WriteRelocSection(const RelocSection* reloc_section);
   void WriteLinkingSection();
 
@@ -165,6 +269,27 @@ class BinaryWriter {
   size_t last_subsection_offset_ = 0;
   size_t last_subsection_leb_size_guess_ = 0;
   size_t last_subsection_payload_offset_ = 0;
+
+  // Scratch buffer for WriteConstRun; reused so runs don't allocate.
+  std::vector<uint8_t> const_run_buffer_;
+
+  // Encode-once memo for integer constant immediates: opcode byte plus the
+  // signed LEB, keyed by value bits. Generated modules repeat the same
+  // immediates heavily, and re-encoding the LEB per occurrence is a
+  // measurable slice of write time; see WriteConstRun.
+  struct EncodedConst {
+    uint8_t len = 0;               // 0 until first encoded.
+    uint8_t bytes[1 + 10];         // Opcode + at most 10 LEB bytes (s64).
+  };
+  std::unordered_map<uint32_t, EncodedConst> i32_const_memo_;
+  std::unordered_map<uint64_t, EncodedConst> i64_const_memo_;
+
+  StreamingPass streaming_pass_ = StreamingPass::None;
+  std::vector<Offset>* streaming_sizes_ = nullptr;
+  size_t streaming_size_index_ = 0;  // Next size to consume in the Emit pass.
+  // {index into streaming_sizes_, payload start offset} for each
+  // size-prefixed region currently open.
+  std::vector<std::pair<size_t, Offset>> streaming_stack_;
 };
 
 static uint8_t log2_u32(uint32_t x) {
@@ -178,8 +303,16 @@ static uint8_t log2_u32(uint32_t x) {
 
 BinaryWriter::BinaryWriter(Stream* stream,
                            const WriteBinaryOptions& options,
-                           const Module* module)
-    : stream_(stream), options_(options), module_(module) {}
+                           const Module* module,
+                           StreamingPass streaming_pass,
+                           std::vector<Offset>* streaming_sizes)
+    : stream_(stream),
+      options_(options),
+      module_(module),
+      streaming_pass_(streaming_pass),
+      streaming_sizes_(streaming_sizes) {
+  assert((streaming_pass_ == StreamingPass::None) == !streaming_sizes_);
+}
 
 void BinaryWriter::WriteHeader(const char* name, int index) {
   if (stream_->has_log_stream()) {
@@ -194,6 +327,27 @@ void BinaryWriter::WriteHeader(const char* name, int index) {
 /* returns offset of leb128 */
 Offset BinaryWriter::WriteU32Leb128Space(Offset leb_size_guess,
                                          const char* desc) {
+  switch (streaming_pass_) {
+    case StreamingPass::Measure:
+      // The size's LEB128 bytes are accounted for when the region ends and
+      // its size is known; only remember where the payload starts.
+      streaming_stack_.emplace_back(streaming_sizes_->size(),
+                                    stream_->offset());
+      streaming_sizes_->push_back(0);
+      return stream_->offset();
+
+    case StreamingPass::Emit: {
+      Offset size = (*streaming_sizes_)[streaming_size_index_];
+      WriteU32Leb128(stream_, size, desc);
+      streaming_stack_.emplace_back(streaming_size_index_++,
+                                    stream_->offset());
+      return stream_->offset();
+    }
+
+    case StreamingPass::None:
+      break;
+  }
+
   assert(leb_size_guess <= MAX_U32_LEB128_BYTES);
   uint8_t data[MAX_U32_LEB128_BYTES] = {0};
   Offset result = stream_->offset();
@@ -206,6 +360,29 @@ Offset BinaryWriter::WriteU32Leb128Space(Offset leb_size_guess,
 Offset BinaryWriter::WriteFixupU32Leb128Size(Offset offset,
                                              Offset leb_size_guess,
                                              const char* desc) {
+  switch (streaming_pass_) {
+    case StreamingPass::Measure: {
+      size_t size_index = streaming_stack_.back().first;
+      Offset size = stream_->offset() - streaming_stack_.back().second;
+      streaming_stack_.pop_back();
+      (*streaming_sizes_)[size_index] = size;
+      // Advance past the bytes the size's LEB128 takes in the real output,
+      // so enclosing regions measure it too.
+      WriteU32Leb128(stream_, size, desc);
+      return 0;
+    }
+
+    case StreamingPass::Emit: {
+      assert((*streaming_sizes_)[streaming_stack_.back().first] ==
+             stream_->offset() - streaming_stack_.back().second);
+      streaming_stack_.pop_back();
+      return 0;
+    }
+
+    case StreamingPass::None:
+      break;
+  }
+
   if (options_.canonicalize_lebs) {
     Offset size = stream_->offset() - offset - leb_size_guess;
     Offset leb_size = U32Leb128Length(size);
@@ -376,8 +553,8 @@ void BinaryWriter::WriteLoadStoreExpr(const Func* func,
   auto* typed_expr = cast<T>(expr);
   WriteOpcode(stream_, typed_expr->opcode);
   Address align = typed_expr->opcode.GetAlignment(typed_expr->align);
-  stream_->WriteU8(log2_u32(align), "alignment");
-  WriteU32Leb128(stream_, typed_expr->offset, desc);
+  WriteU32Leb128Pair(stream_, log2_u32(align), "alignment",
+                     typed_expr->offset, desc);
 }
 
 void BinaryWriter::WriteExpr(const Func* func, const Expr* expr) {
@@ -431,14 +608,24 @@ void BinaryWriter::WriteExpr(const Func* func, const Expr* expr) {
     case ExprType::BrTable: {
       auto* br_table_expr = cast<BrTableExpr>(expr);
       WriteOpcode(stream_, Opcode::BrTable);
-      WriteU32Leb128(stream_, br_table_expr->targets.size(), "num targets");
-      Index depth;
-      for (const Var& var : br_table_expr->targets) {
-        depth = GetLabelVarDepth(&var);
-        WriteU32Leb128(stream_, depth, "break depth");
+      if (!stream_->has_log_stream()) {
+        // Emit the whole target list through a cursor as one stream write.
+        BulkWriter writer(stream_, "br_table targets");
+        WriteU32Leb128(&writer, br_table_expr->targets.size());
+        for (const Var& var : br_table_expr->targets) {
+          WriteU32Leb128(&writer, GetLabelVarDepth(&var));
+        }
+        WriteU32Leb128(&writer, GetLabelVarDepth(&br_table_expr->default_target));
+      } else {
+        WriteU32Leb128(stream_, br_table_expr->targets.size(), "num targets");
+        Index depth;
+        for (const Var& var : br_table_expr->targets) {
+          depth = GetLabelVarDepth(&var);
+          WriteU32Leb128(stream_, depth, "break depth");
+        }
+        depth = GetLabelVarDepth(&br_table_expr->default_target);
+        WriteU32Leb128(stream_, depth, "break depth for default");
       }
-      depth = GetLabelVarDepth(&br_table_expr->default_target);
-      WriteU32Leb128(stream_, depth, "break depth for default");
       break;
     }
     case ExprType::Call:{
@@ -721,9 +908,82 @@ void BinaryWriter::WriteExpr(const Func* func, const Expr* expr) {
   }
 }
 
+// Emits a run of consecutive const expressions starting at |first| with a
+// single stream append. f32/f64 encode as the opcode byte followed by the
+// raw little-endian value bits, so they're staged byte-for-byte in the
+// scratch buffer; i32/i64 go through the encode-once memo, so a value's
+// signed LEB is computed the first time it appears and copied thereafter.
+// Either way a run pays one stream write instead of an opcode write and a
+// value write (plus a LEB encode) per constant -- data-segment-like
+// sequences (large float arrays, generated lookup tables) are
+// emission-bound on exactly that overhead. Returns the first expression not
+// consumed; consumes nothing when the run doesn't start with a scalar
+// constant.
+ExprList::const_iterator BinaryWriter::WriteConstRun(
+    ExprList::const_iterator first,
+    ExprList::const_iterator end) {
+  const_run_buffer_.clear();
+  ExprList::const_iterator it = first;
+  for (; it != end && it->type() == ExprType::Const; ++it) {
+    const Const& const_ = cast<ConstExpr>(&*it)->const_;
+    size_t pos = const_run_buffer_.size();
+    if (const_.type == Type::F32) {
+      const_run_buffer_.resize(pos + 5);
+      const_run_buffer_[pos] =
+          static_cast<uint8_t>(Opcode(Opcode::F32Const).GetCode());
+      memcpy(&const_run_buffer_[pos + 1], &const_.f32_bits,
+             sizeof(const_.f32_bits));
+    } else if (const_.type == Type::F64) {
+      const_run_buffer_.resize(pos + 9);
+      const_run_buffer_[pos] =
+          static_cast<uint8_t>(Opcode(Opcode::F64Const).GetCode());
+      memcpy(&const_run_buffer_[pos + 1], &const_.f64_bits,
+             sizeof(const_.f64_bits));
+    } else if (const_.type == Type::I32) {
+      EncodedConst& enc = i32_const_memo_[const_.u32];
+      if (enc.len == 0) {
+        enc.bytes[0] = static_cast<uint8_t>(Opcode(Opcode::I32Const).GetCode());
+        enc.len = 1 + WriteS32Leb128Raw(enc.bytes + 1,
+                                        enc.bytes + sizeof(enc.bytes),
+                                        const_.u32);
+      }
+      const_run_buffer_.insert(const_run_buffer_.end(), enc.bytes,
+                               enc.bytes + enc.len);
+    } else if (const_.type == Type::I64) {
+      EncodedConst& enc = i64_const_memo_[const_.u64];
+      if (enc.len == 0) {
+        enc.bytes[0] = static_cast<uint8_t>(Opcode(Opcode::I64Const).GetCode());
+        enc.len = 1 + WriteS64Leb128Raw(enc.bytes + 1,
+                                        enc.bytes + sizeof(enc.bytes),
+                                        const_.u64);
+      }
+      const_run_buffer_.insert(const_run_buffer_.end(), enc.bytes,
+                               enc.bytes + enc.len);
+    } else {
+      break;
+    }
+  }
+  if (it != first) {
+    stream_->WriteData(const_run_buffer_.data(), const_run_buffer_.size(),
+                       "const run");
+  }
+  return it;
+}
+
 void BinaryWriter::WriteExprList(const Func* func, const ExprList& exprs) {
-  for (const Expr& expr : exprs) {
-    WriteExpr(func, &expr);
+  ExprList::const_iterator end = exprs.end();
+  for (ExprList::const_iterator it = exprs.begin(); it != end;) {
+    // Bulk-emit float constant runs, unless the stream is logged; each
+    // constant then keeps its own annotated log lines.
+    if (it->type() == ExprType::Const && !stream_->has_log_stream()) {
+      ExprList::const_iterator next = WriteConstRun(it, end);
+      if (next != it) {
+        it = next;
+        continue;
+      }
+    }
+    WriteExpr(func, &*it);
+    ++it;
   }
 }
 
@@ -740,6 +1000,15 @@ void BinaryWriter::WriteFuncLocals(const Func* func,
   }
 
   Index local_decl_count = local_types.decls().size();
+  if (!stream_->has_log_stream()) {
+    BulkWriter writer(stream_, "local decls");
+    WriteU32Leb128(&writer, local_decl_count);
+    for (auto decl : local_types.decls()) {
+      WriteU32Leb128(&writer, decl.second);
+      WriteS32Leb128(&writer, decl.first);
+    }
+    return;
+  }
   WriteU32Leb128(stream_, local_decl_count, "local decl count");
   for (auto decl : local_types.decls()) {
     WriteU32Leb128(stream_, decl.second, "local type count");
@@ -842,7 +1111,27 @@ void BinaryWriter::WriteLinkingSection() {
   EndSection();
 }
 
+// Writes the data section payload -- segment count followed by each segment.
+// Shared by the standard Data section and the compressed custom section,
+// which compresses exactly these bytes.
+void BinaryWriter::WriteDataSegments() {
+  WriteU32Leb128(stream_, module_->data_segments.size(), "num data segments");
+  for (size_t i = 0; i < module_->data_segments.size(); ++i) {
+    const DataSegment* segment = module_->data_segments[i];
+    WriteHeader("data segment header", i);
+    stream_->WriteU8(segment->flags, "segment flags");
+    if (!segment->is_passive()) {
+      assert(module_->GetMemoryIndex(segment->memory_var) == 0);
+      WriteInitExpr(segment->offset);
+    }
+    WriteU32Leb128(stream_, segment->data.size(), "data segment size");
+    WriteHeader("data segment data", i);
+    stream_->WriteData(segment->data, "data segment data");
+  }
+}
+
 Result BinaryWriter::WriteModule() {
+  stream_->Reserve(EstimateModuleSize(*module_));
   stream_->WriteU32(WABT_BINARY_MAGIC, "WASM_BINARY_MAGIC");
   stream_->WriteU32(WABT_BINARY_VERSION, "WASM_BINARY_VERSION");
 
@@ -853,10 +1142,24 @@ Result BinaryWriter::WriteModule() {
       const FuncType* func_type = module_->func_types[i];
       const FuncSignature* sig = &func_type->sig;
       WriteHeader("type", i);
-      WriteType(stream_, Type::Func);
 
       Index num_params = sig->param_types.size();
       Index num_results = sig->result_types.size();
+      if (!stream_->has_log_stream()) {
+        BulkWriter writer(stream_, "type signature");
+        WriteS32Leb128(&writer, Type::Func);
+        WriteU32Leb128(&writer, num_params);
+        for (size_t j = 0; j < num_params; ++j) {
+          WriteS32Leb128(&writer, sig->param_types[j]);
+        }
+        WriteU32Leb128(&writer, num_results);
+        for (size_t j = 0; j < num_results; ++j) {
+          WriteS32Leb128(&writer, sig->result_types[j]);
+        }
+        continue;
+      }
+
+      WriteType(stream_, Type::Func);
       WriteU32Leb128(stream_, num_params, "num params");
       for (size_t j = 0; j < num_params; ++j) {
         WriteType(stream_, sig->param_types[j]);
@@ -916,12 +1219,24 @@ Result BinaryWriter::WriteModule() {
     BeginKnownSection(BinarySection::Function);
     WriteU32Leb128(stream_, num_funcs, "num functions");
 
-    for (size_t i = 0; i < num_funcs; ++i) {
-      const Func* func = module_->funcs[i + module_->num_func_imports];
-      char desc[100];
-      wabt_snprintf(desc, sizeof(desc), "function %" PRIzd " signature index",
-                    i);
-      WriteU32Leb128(stream_, module_->GetFuncTypeIndex(func->decl), desc);
+    if (stream_->has_log_stream()) {
+      for (size_t i = 0; i < num_funcs; ++i) {
+        const Func* func = module_->funcs[i + module_->num_func_imports];
+        char desc[100];
+        wabt_snprintf(desc, sizeof(desc), "function %" PRIzd " signature index",
+                      i);
+        WriteU32Leb128(stream_, module_->GetFuncTypeIndex(func->decl), desc);
+      }
+    } else {
+      // The section is one long index run; gather it and batch-encode.
+      std::vector<Index> sig_indexes;
+      sig_indexes.reserve(num_funcs);
+      for (size_t i = 0; i < num_funcs; ++i) {
+        const Func* func = module_->funcs[i + module_->num_func_imports];
+        sig_indexes.push_back(module_->GetFuncTypeIndex(func->decl));
+      }
+      WriteU32Leb128Vector(stream_, sig_indexes.data(), sig_indexes.size(),
+                           "function signature indexes");
     }
     EndSection();
   }
@@ -1072,6 +1387,18 @@ Result BinaryWriter::WriteModule() {
           }
           WriteOpcode(stream_, Opcode::End);
         }
+      } else if (!options_.relocatable && !stream_->has_log_stream()) {
+        // Long function-index run; gather and batch-encode. Relocatable
+        // output keeps the per-index path for its fixed-width LEBs and
+        // reloc entries.
+        std::vector<Index> func_indexes;
+        func_indexes.reserve(segment->elem_exprs.size());
+        for (const ElemExpr& elem_expr : segment->elem_exprs) {
+          assert(elem_expr.kind == ElemExprKind::RefFunc);
+          func_indexes.push_back(module_->GetFuncIndex(elem_expr.var));
+        }
+        WriteU32Leb128Vector(stream_, func_indexes.data(), func_indexes.size(),
+                             "elem function indexes");
       } else {
         for (const ElemExpr& elem_expr : segment->elem_exprs) {
           assert(elem_expr.kind == ElemExprKind::RefFunc);
@@ -1096,35 +1423,33 @@ Result BinaryWriter::WriteModule() {
 
     for (size_t i = 0; i < num_funcs; ++i) {
       WriteHeader("function body", i);
-      const Func* func = module_->funcs[i + module_->num_func_imports];
-
-      /* TODO(binji): better guess of the size of the function body section */
-      const Offset leb_size_guess = 1;
-      Offset body_size_offset =
-          WriteU32Leb128Space(leb_size_guess, "func body size (guess)");
-      WriteFunc(func);
-      WriteFixupU32Leb128Size(body_size_offset, leb_size_guess,
-                              "FIXUP func body size");
+      WriteCodeEntry(module_->funcs[i + module_->num_func_imports]);
     }
     EndSection();
   }
 
   if (module_->data_segments.size()) {
-    BeginKnownSection(BinarySection::Data);
-    WriteU32Leb128(stream_, module_->data_segments.size(), "num data segments");
-    for (size_t i = 0; i < module_->data_segments.size(); ++i) {
-      const DataSegment* segment = module_->data_segments[i];
-      WriteHeader("data segment header", i);
-      stream_->WriteU8(segment->flags, "segment flags");
-      if (!segment->is_passive()) {
-        assert(module_->GetMemoryIndex(segment->memory_var) == 0);
-        WriteInitExpr(segment->offset);
-      }
-      WriteU32Leb128(stream_, segment->data.size(), "data segment size");
-      WriteHeader("data segment data", i);
-      stream_->WriteData(segment->data, "data segment data");
+    if (options_.compress_data_segments) {
+      // Render the standard data section payload, then store it compressed
+      // in a custom section that the binary reader decodes transparently.
+      MemoryStream payload_stream;
+      Stream* saved_stream = stream_;
+      stream_ = &payload_stream;
+      WriteDataSegments();
+      stream_ = saved_stream;
+      const OutputBuffer& payload = payload_stream.output_buffer();
+      std::vector<uint8_t> compressed;
+      CompressData(payload.data.data(), payload.size(), &compressed);
+      BeginCustomSection(WABT_BINARY_SECTION_COMPRESSED_DATA);
+      WriteU32Leb128(stream_, payload.size(), "decompressed size");
+      stream_->WriteData(compressed.data(), compressed.size(),
+                         "compressed data segments");
+      EndSection();
+    } else {
+      BeginKnownSection(BinarySection::Data);
+      WriteDataSegments();
+      EndSection();
     }
-    EndSection();
   }
 
   if (options_.write_debug_names) {
@@ -1200,6 +1525,17 @@ Result BinaryWriter::WriteModule() {
 
 }  // end anonymous namespace
 
+Result BinaryWriter::WriteCodeEntry(const Func* func) {
+  /* TODO(binji): better guess of the size of the function body section */
+  const Offset leb_size_guess = 1;
+  Offset body_size_offset =
+      WriteU32Leb128Space(leb_size_guess, "func body size (guess)");
+  WriteFunc(func);
+  WriteFixupU32Leb128Size(body_size_offset, leb_size_guess,
+                          "FIXUP func body size");
+  return stream_->result();
+}
+
 Result WriteBinaryModule(Stream* stream,
                          const Module* module,
                          const WriteBinaryOptions& options) {
@@ -1207,4 +1543,122 @@ Result WriteBinaryModule(Stream* stream,
   return binary_writer.WriteModule();
 }
 
+Result PatchBinaryFunction(Stream* stream,
+                           const void* data,
+                           size_t size,
+                           const Module* module,
+                           Index func_index,
+                           const WriteBinaryOptions& options) {
+  if (func_index < module->num_func_imports ||
+      func_index >= module->funcs.size()) {
+    return Result::Error;
+  }
+
+  // Locate the code section (and refuse binaries whose reloc/linking
+  // sections would be invalidated by moving code bytes).
+  BinaryReaderNop nop_delegate;
+  std::vector<SectionDirectoryEntry> directory;
+  ReadBinaryOptions read_options;
+  read_options.features = options.features;
+  if (Failed(ReadBinarySectionDirectory(data, size, &nop_delegate,
+                                        read_options, &directory))) {
+    return Result::Error;
+  }
+
+  const SectionDirectoryEntry* code_entry = nullptr;
+  Offset code_id_offset = 8;  // After the magic and version.
+  for (const SectionDirectoryEntry& entry : directory) {
+    if (entry.section_type == BinarySection::Custom &&
+        (entry.name == WABT_BINARY_SECTION_LINKING ||
+         entry.name.rfind(WABT_BINARY_SECTION_RELOC ".", 0) == 0)) {
+      return Result::Error;
+    }
+    if (entry.section_type == BinarySection::Code) {
+      code_entry = &entry;
+      break;
+    }
+    code_id_offset = entry.offset + entry.size;
+  }
+  if (!code_entry) {
+    return Result::Error;
+  }
+
+  // Walk the entries to the one being replaced; each is a body size LEB
+  // followed by that many bytes.
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  const uint8_t* payload = bytes + code_entry->offset;
+  const uint8_t* payload_end = payload + code_entry->size;
+  uint32_t num_entries;
+  size_t len = ReadU32Leb128(payload, payload_end, &num_entries);
+  if (len == 0) {
+    return Result::Error;
+  }
+  Index defined_index = func_index - module->num_func_imports;
+  if (defined_index >= num_entries) {
+    return Result::Error;
+  }
+  const uint8_t* p = payload + len;
+  for (Index i = 0; i < defined_index; ++i) {
+    uint32_t body_size;
+    len = ReadU32Leb128(p, payload_end, &body_size);
+    if (len == 0 ||
+        static_cast<size_t>(payload_end - (p + len)) < body_size) {
+      return Result::Error;
+    }
+    p += len + body_size;
+  }
+  uint32_t old_body_size;
+  len = ReadU32Leb128(p, payload_end, &old_body_size);
+  if (len == 0 ||
+      static_cast<size_t>(payload_end - (p + len)) < old_body_size) {
+    return Result::Error;
+  }
+  const uint8_t* old_entry_start = p;
+  const uint8_t* old_entry_end = p + len + old_body_size;
+
+  // Encode the replacement entry on its own, then splice: bytes before the
+  // code section, a re-emitted section header, payload with the entry
+  // swapped, and the rest of the module, all copied through verbatim.
+  MemoryStream entry_stream;
+  BinaryWriter writer(&entry_stream, options, module);
+  CHECK_RESULT(writer.WriteCodeEntry(module->funcs[func_index]));
+  const std::vector<uint8_t>& new_entry = entry_stream.output_buffer().data;
+
+  Offset new_payload_size = code_entry->size -
+                            (old_entry_end - old_entry_start) +
+                            new_entry.size();
+  stream->WriteData(bytes, code_id_offset, "module before code section");
+  stream->WriteU8(static_cast<uint8_t>(BinarySection::Code), "section code");
+  WriteU32Leb128(stream, new_payload_size, "section size");
+  stream->WriteData(payload, old_entry_start - payload,
+                    "code entries before patch");
+  stream->WriteData(new_entry.data(), new_entry.size(), "patched code entry");
+  stream->WriteData(old_entry_end, (bytes + size) - old_entry_end,
+                    "module after patched entry");
+  return stream->result();
+}
+
+Result WriteBinaryModuleStreaming(Stream* stream,
+                                  const Module* module,
+                                  const WriteBinaryOptions& options) {
+  // Relocatable output interleaves symbol/reloc bookkeeping with writing, and
+  // compressed data segments are rendered through a side buffer, so both
+  // still use the buffered writer.
+  if (options.relocatable || options.compress_data_segments) {
+    return WriteBinaryModule(stream, module, options);
+  }
+
+  std::vector<Offset> sizes;
+  {
+    SizeCountingStream counting_stream;
+    BinaryWriter measure_writer(&counting_stream, options, module,
+                                BinaryWriter::StreamingPass::Measure, &sizes);
+    CHECK_RESULT(measure_writer.WriteModule());
+  }
+
+  BinaryWriter emit_writer(stream, options, module,
+                           BinaryWriter::StreamingPass::Emit, &sizes);
+  return emit_writer.WriteModule();
+}
+
 }  // namespace wabt
@@ -42,10 +42,46 @@ struct WriteBinaryOptions {
   bool canonicalize_lebs = true;
   bool relocatable = false;
   bool write_debug_names = false;
+  // Store data segments LZ77-compressed in a "wabt.compressed-data" custom
+  // section instead of the standard Data section. The binary reader decodes
+  // the section transparently, but other toolchains will not see the
+  // segments.
+  bool compress_data_segments = false;
+  // Number of threads WriteBinarySpecScript uses to serialize modules;
+  // values <= 1 serialize on the calling thread. Ignored by
+  // WriteBinaryModule itself.
+  int num_threads = 1;
 };
 
 Result WriteBinaryModule(Stream*, const Module*, const WriteBinaryOptions&);
 
+// Like WriteBinaryModule, but writes in two passes: the first measures every
+// section, subsection and function-body payload, the second writes each size
+// as an exact LEB128 up front. Nothing in the output stream is patched or
+// moved after it is written, so the stream can be an unbuffered output (e.g.
+// a FileStream) and no in-memory copy of the module is kept. Sizes are
+// always written canonically; relocatable output falls back to the buffered
+// writer.
+Result WriteBinaryModuleStreaming(Stream*,
+                                  const Module*,
+                                  const WriteBinaryOptions&);
+
+// Rewrites one code-section entry of an existing binary, for hot-patch flows
+// that change a single function in a large module. |module| supplies the
+// encoding context and the replacement body: the entry for |func_index| (a
+// module-wide function index, counting imports) is re-encoded from
+// module->funcs[func_index], and every other byte of |data| is copied
+// through verbatim with only the code section's size prefix re-emitted.
+// Fails if the binary has no code section, the index doesn't name a defined
+// function present in the binary, or the binary carries reloc/linking
+// sections, whose offsets the splice would invalidate.
+Result PatchBinaryFunction(Stream* stream,
+                           const void* data,
+                           size_t size,
+                           const Module* module,
+                           Index func_index,
+                           const WriteBinaryOptions& options);
+
 void WriteType(Stream* stream, Type type, const char* desc = nullptr);
 
 void WriteStr(Stream* stream,
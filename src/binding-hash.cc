@@ -20,16 +20,86 @@
 #include <vector>
 
 #include "src/ir.h"
+#include "src/make-unique.h"
 
 namespace wabt {
 
-void BindingHash::FindDuplicates(DuplicateCallback callback) const {
-  if (size() > 0) {
-    ValueTypeVector duplicates;
-    CreateDuplicatesVector(&duplicates);
-    SortDuplicatesVectorByLocation(&duplicates);
-    CallCallbacks(duplicates, callback);
+void BindingHash::emplace(string_view name, const Binding& binding) {
+  // Keep the load factor at 1/2 or below.
+  if ((entries_.size() + 1) * 2 > slots_.size()) {
+    Rehash(std::max(kInitialSlots, slots_.size() * 2));
+  }
+  entries_.emplace_back(InternName(name), binding);
+  InsertSlot(entries_.size() - 1);
+}
+
+void BindingHash::reserve(size_t count) {
+  size_t total = entries_.size() + count;
+  entries_.reserve(total);
+  // Keep the load factor at 1/2 or below, as in emplace.
+  if (total * 2 > slots_.size()) {
+    size_t new_slot_count = kInitialSlots;
+    while (new_slot_count < total * 2) {
+      new_slot_count *= 2;
+    }
+    Rehash(new_slot_count);
+  }
+}
+
+void BindingHash::erase(string_view name) {
+  auto iter = std::remove_if(
+      entries_.begin(), entries_.end(),
+      [&name](const value_type& entry) { return entry.first == name; });
+  if (iter != entries_.end()) {
+    entries_.erase(iter, entries_.end());
+    // Removal is rare (mark-point resets in the interpreter), so just rebuild
+    // the slot table rather than keeping tombstones.
+    Rehash(std::max(kInitialSlots, slots_.size()));
+  }
+}
+
+string_view BindingHash::InternName(string_view name) {
+  if (!string_pool_) {
+    owned_string_pool_ = MakeUnique<StringPool>();
+    string_pool_ = owned_string_pool_.get();
+  }
+  return string_pool_->Intern(name);
+}
+
+void BindingHash::InsertSlot(size_t entry_index) {
+  const string_view& name = entries_[entry_index].first;
+  size_t mask = slots_.size() - 1;
+  size_t slot = std::hash<string_view>()(name) & mask;
+  while (slots_[slot] != 0) {
+    if (!has_duplicates_ && entries_[slots_[slot] - 1].first == name) {
+      has_duplicates_ = true;
+    }
+    slot = (slot + 1) & mask;
+  }
+  slots_[slot] = entry_index + 1;
+}
+
+void BindingHash::Rehash(size_t new_slot_count) {
+  slots_.assign(new_slot_count, 0);
+  has_duplicates_ = false;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    InsertSlot(i);
+  }
+}
+
+size_t BindingHash::count(string_view name) const {
+  size_t result = 0;
+  if (!slots_.empty()) {
+    size_t mask = slots_.size() - 1;
+    size_t slot = std::hash<string_view>()(name) & mask;
+    while (slots_[slot] != 0) {
+      if (entries_[slots_[slot] - 1].first == name) {
+        result++;
+      }
+      slot = (slot + 1) & mask;
+    }
   }
+  return result;
 }
 
 Index BindingHash::FindIndex(const Var& var) const {
@@ -39,22 +109,51 @@ Index BindingHash::FindIndex(const Var& var) const {
   return var.index();
 }
 
+Index BindingHash::FindIndex(string_view name) const {
+  if (!slots_.empty()) {
+    size_t mask = slots_.size() - 1;
+    size_t slot = std::hash<string_view>()(name) & mask;
+    while (slots_[slot] != 0) {
+      const value_type& entry = entries_[slots_[slot] - 1];
+      if (entry.first == name) {
+        return entry.second.index;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+  return kInvalidIndex;
+}
+
+std::vector<Index> BindingHash::FindIndexes(string_view name) const {
+  std::vector<Index> result;
+  if (!slots_.empty()) {
+    size_t mask = slots_.size() - 1;
+    size_t slot = std::hash<string_view>()(name) & mask;
+    while (slots_[slot] != 0) {
+      const value_type& entry = entries_[slots_[slot] - 1];
+      if (entry.first == name) {
+        result.push_back(entry.second.index);
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+  return result;
+}
+
+void BindingHash::FindDuplicates(DuplicateCallback callback) const {
+  if (has_duplicates_) {
+    ValueTypeVector duplicates;
+    CreateDuplicatesVector(&duplicates);
+    SortDuplicatesVectorByLocation(&duplicates);
+    CallCallbacks(duplicates, callback);
+  }
+}
+
 void BindingHash::CreateDuplicatesVector(
     ValueTypeVector* out_duplicates) const {
-  // This relies on the fact that in an unordered_multimap, all values with the
-  // same key are adjacent in iteration order.
-  auto first = begin();
-  bool is_first = true;
-  for (auto iter = std::next(first); iter != end(); ++iter) {
-    if (first->first == iter->first) {
-      if (is_first) {
-        out_duplicates->push_back(&*first);
-      }
-      out_duplicates->push_back(&*iter);
-      is_first = false;
-    } else {
-      is_first = true;
-      first = iter;
+  for (const value_type& entry : entries_) {
+    if (count(entry.first) > 1) {
+      out_duplicates->push_back(&entry);
     }
   }
 }
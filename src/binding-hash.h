@@ -18,11 +18,12 @@
 #define WABT_BINDING_HASH_H_
 
 #include <functional>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "src/common.h"
+#include "src/string-pool.h"
 #include "src/string-view.h"
 
 namespace wabt {
@@ -37,34 +38,84 @@ struct Binding {
   Index index;
 };
 
-// This class derives from a C++ container, which is usually not advisable
-// because they don't have virtual destructors. So don't delete a BindingHash
-// object through a pointer to std::unordered_multimap.
-class BindingHash : public std::unordered_multimap<std::string, Binding> {
+// A multimap from names to Bindings, implemented as a flat open-addressing
+// hash table instead of std::unordered_multimap to avoid a node allocation
+// and a std::string copy per entry. Names are interned in a StringPool — by
+// default one owned by the hash, or a shared pool (typically the owning
+// Module's) set with set_string_pool — so each entry stores just a
+// string_view.
+// Duplicate names are allowed: the resolver and validator report them via
+// FindDuplicates, and interpreter host modules rely on same-name exports.
+// FindIndex returns the first-inserted binding for a name.
+class BindingHash {
  public:
+  typedef std::pair<string_view, Binding> value_type;
+  typedef std::vector<value_type>::const_iterator const_iterator;
   typedef std::function<void(const value_type&, const value_type&)>
       DuplicateCallback;
 
+  void emplace(string_view name, const Binding& binding);
+
+  // Pre-sizes the table for |count| further bindings, avoiding repeated
+  // rehashing when a section's entry count is known up front.
+  void reserve(size_t count);
+
+  // Removes all bindings with the given name. The interned copy of the name
+  // is not reclaimed.
+  void erase(string_view name);
+
+  // Interns names in the given pool instead of one owned by this hash, so
+  // the same name used by several tables is stored once. Names that were
+  // emplaced earlier stay in the pool that was in use at the time.
+  void set_string_pool(StringPool* pool) { string_pool_ = pool; }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  size_t count(string_view name) const;
+
+  // Iterates over all bindings, in insertion order.
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
   void FindDuplicates(DuplicateCallback callback) const;
 
   Index FindIndex(const Var&) const;
+  Index FindIndex(string_view name) const;
 
-  Index FindIndex(const std::string& name) const {
-    auto iter = find(name);
-    return iter != end() ? iter->second.index : kInvalidIndex;
-  }
-
-  Index FindIndex(string_view name) const {
-    return FindIndex(name.to_string());
-  }
+  // Returns the indexes of all bindings with the given name, in insertion
+  // order.
+  std::vector<Index> FindIndexes(string_view name) const;
 
  private:
   typedef std::vector<const value_type*> ValueTypeVector;
 
+  static const size_t kInitialSlots = 16;
+
+  string_view InternName(string_view name);
+  void InsertSlot(size_t entry_index);
+  void Rehash(size_t new_slot_count);
+
   void CreateDuplicatesVector(ValueTypeVector* out_duplicates) const;
   void SortDuplicatesVectorByLocation(ValueTypeVector* duplicates) const;
   void CallCallbacks(const ValueTypeVector& duplicates,
                      DuplicateCallback callback) const;
+
+  // All bindings, in insertion order.
+  std::vector<value_type> entries_;
+  // Slot table, linear probing. Each slot holds an entry index + 1; 0 means
+  // empty. Entries are never removed, so there are no tombstones, and equal
+  // names appear in the probe sequence in insertion order.
+  std::vector<size_t> slots_;
+  // Set when a name is inserted that is already bound. Insertion passes every
+  // existing binding of the same name while probing, so this costs nothing to
+  // maintain and lets FindDuplicates skip re-probing every entry in the
+  // common, duplicate-free case.
+  bool has_duplicates_ = false;
+  // Where names are interned. Points at owned_string_pool_ unless a shared
+  // pool was set; owned_string_pool_ is kept alive either way so earlier
+  // entries stay valid.
+  StringPool* string_pool_ = nullptr;
+  std::unique_ptr<StringPool> owned_string_pool_;
 };
 
 }  // namespace wabt
@@ -16,14 +16,18 @@
 
 #include "src/c-writer.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cinttypes>
 #include <map>
 #include <set>
+#include <thread>
 
 #include "src/cast.h"
 #include "src/common.h"
+#include "src/expr-visitor.h"
 #include "src/ir.h"
+#include "src/make-unique.h"
 #include "src/literal.h"
 #include "src/stream.h"
 #include "src/string-view.h"
@@ -121,14 +125,22 @@ int GetShiftMask(Type type) {
 
 class CWriter {
  public:
+  // When num_shards > 1, this writer emits only its shard's slice of the
+  // function definitions: module-level definitions go in shard 0 and symbols
+  // referenced across shards get external instead of static linkage. Every
+  // shard still runs the full naming passes so generated names agree.
   CWriter(Stream* c_stream,
           Stream* h_stream,
           const char* header_name,
-          const WriteCOptions& options)
+          const WriteCOptions& options,
+          Index shard_index = 0,
+          Index num_shards = 1)
       : options_(options),
         c_stream_(c_stream),
         h_stream_(h_stream),
-        header_name_(header_name) {}
+        header_name_(header_name),
+        shard_index_(shard_index),
+        num_shards_(num_shards) {}
 
   Result WriteModule(const Module&);
 
@@ -193,6 +205,17 @@ class CWriter {
 
   std::string GetGlobalName(const std::string&) const;
 
+  bool IsSharded() const { return num_shards_ > 1; }
+  // The shard that emits the one-per-module pieces (initializers, exports);
+  // also true when not sharding at all.
+  bool IsLeadShard() const { return shard_index_ == 0; }
+  // Linkage for symbols referenced by the generated functions: file-static
+  // normally, but visible across translation units when the functions are
+  // sharded over several outputs.
+  const char* InternalSymbolLinkage() const {
+    return IsSharded() ? "" : "static ";
+  }
+
   enum class WriteExportsKind {
     Declarations,
     Definitions,
@@ -214,6 +237,7 @@ class CWriter {
   void Write(TypeEnum);
   void Write(const Var&);
   void Write(const GotoLabel&);
+  bool TryWriteComputedGotoBrTable(const BrTableExpr*);
   void Write(const LabelDecl&);
   void Write(const GlobalVar&);
   void Write(const StackVar&);
@@ -227,6 +251,14 @@ class CWriter {
   void WriteImports();
   void WriteFuncDeclarations();
   void WriteFuncDeclaration(const FuncDeclaration&, const std::string&);
+  bool PopulateStaticTable();
+  const std::vector<Index>& CanonicalFuncTypeIndices() const;
+  Index CanonicalFuncTypeIndex(const Var& type_var) const;
+  void WriteIndirectDispatchSignature(Index func_type_index,
+                                      const std::string& name,
+                                      bool with_param_names);
+  void WriteIndirectDispatchDecls();
+  void WriteIndirectDispatchFuncs();
   void WriteGlobals();
   void WriteGlobal(const Global&, const std::string&);
   void WriteMemories();
@@ -276,6 +308,8 @@ class CWriter {
   Stream* c_stream_ = nullptr;
   Stream* h_stream_ = nullptr;
   std::string header_name_;
+  Index shard_index_ = 0;
+  Index num_shards_ = 1;
   Result result_ = Result::Ok;
   int indent_ = 0;
   bool should_write_indent_next_ = false;
@@ -288,6 +322,16 @@ class CWriter {
   SymbolSet import_syms_;
   TypeVector type_stack_;
   std::vector<Label> label_stack_;
+
+  // Contents of the function table when it is fully known at generation time
+  // (see PopulateStaticTable); nullptr marks an uninitialized slot. Empty
+  // when devirtualization is off or the table can be mutated.
+  std::vector<const Func*> table_slots_;
+  // C names of the per-signature dispatch helpers, keyed by canonical func
+  // type index.
+  std::map<Index, std::string> dispatch_names_;
+  // Lazily built by CanonicalFuncTypeIndices.
+  mutable std::vector<Index> canonical_func_type_indices_;
 };
 
 static const char kImplicitFuncLabel[] = "$Bfunc";
@@ -346,28 +390,42 @@ static const char* s_global_symbols[] = {
     "strstr", "strtok", "strxfrm",
 
     // defined
-    "CALL_INDIRECT", "DEFINE_LOAD", "DEFINE_REINTERPRET", "DEFINE_STORE",
-    "DIVREM_U", "DIV_S", "DIV_U", "f32", "f32_load", "f32_reinterpret_i32",
-    "f32_store", "f64", "f64_load", "f64_reinterpret_i64", "f64_store", "FMAX",
+    "CALL_INDIRECT", "DEFINE_ALIGNED_LOAD",
+    "DEFINE_ALIGNED_STORE", "DEFINE_LOAD", "DEFINE_REINTERPRET", "DEFINE_STORE",
+    "DIVREM_U", "DIV_S", "DIV_U", "f32", "f32_alias", "f32_load",
+    "f32_load_aligned", "f32_reinterpret_i32", "f32_store", "f32_store_aligned",
+    "f64", "f64_alias", "f64_load", "f64_load_aligned", "f64_reinterpret_i64",
+    "f64_store", "f64_store_aligned", "FMAX",
     "FMIN", "FUNC_EPILOGUE", "FUNC_PROLOGUE", "func_types", "I32_CLZ",
-    "I32_CLZ", "I32_DIV_S", "i32_load", "i32_load16_s", "i32_load16_u",
+    "I32_CLZ", "I32_DIV_S", "i32_load", "i32_load_aligned", "i32_load16_s",
+    "i32_load16_s_aligned", "i32_load16_u", "i32_load16_u_aligned",
     "i32_load8_s", "i32_load8_u", "I32_POPCNT", "i32_reinterpret_f32",
-    "I32_REM_S", "I32_ROTL", "I32_ROTR", "i32_store", "i32_store16",
+    "I32_REM_S", "I32_ROTL", "I32_ROTR", "i32_store", "i32_store_aligned",
+    "i32_store16", "i32_store16_aligned",
     "i32_store8", "I32_TRUNC_S_F32", "I32_TRUNC_S_F64", "I32_TRUNC_U_F32",
     "I32_TRUNC_U_F64", "I64_CTZ", "I64_CTZ", "I64_DIV_S", "i64_load",
-    "i64_load16_s", "i64_load16_u", "i64_load32_s", "i64_load32_u",
+    "i64_load_aligned", "i64_load16_s", "i64_load16_s_aligned", "i64_load16_u",
+    "i64_load16_u_aligned", "i64_load32_s", "i64_load32_s_aligned",
+    "i64_load32_u", "i64_load32_u_aligned",
     "i64_load8_s", "i64_load8_u", "I64_POPCNT", "i64_reinterpret_f64",
-    "I64_REM_S", "I64_ROTL", "I64_ROTR", "i64_store", "i64_store16",
-    "i64_store32", "i64_store8", "I64_TRUNC_S_F32", "I64_TRUNC_S_F64",
+    "I64_REM_S", "I64_ROTL", "I64_ROTR", "i64_store", "i64_store_aligned",
+    "i64_store16", "i64_store16_aligned",
+    "i64_store32", "i64_store32_aligned", "i64_store8", "I64_TRUNC_S_F32",
+    "I64_TRUNC_S_F64",
     "I64_TRUNC_U_F32", "I64_TRUNC_U_F64", "init", "init_elem_segment",
     "init_func_types", "init_globals", "init_memory", "init_table", "LIKELY",
-    "MEMCHECK", "REM_S", "REM_U", "ROTL", "ROTR", "s16", "s32", "s64", "s8",
-    "TRAP", "TRUNC_S", "TRUNC_U", "Type", "u16", "u32", "u64", "u8", "UNLIKELY",
+    "MEMCHECK", "REM_S", "REM_U", "ROTL", "ROTR", "s16", "s16_alias", "s32",
+    "s32_alias", "s64", "s8",
+    "TRAP", "TRUNC_S", "TRUNC_U", "Type", "u16", "u16_alias", "u32",
+    "u32_alias", "u64", "u64_alias", "u8", "UNLIKELY",
     "UNREACHABLE", "WASM_RT_ADD_PREFIX", "wasm_rt_allocate_memory",
     "wasm_rt_allocate_table", "wasm_rt_anyfunc_t", "wasm_rt_call_stack_depth",
     "wasm_rt_elem_t", "WASM_RT_F32", "WASM_RT_F64", "wasm_rt_grow_memory",
     "WASM_RT_I32", "WASM_RT_I64", "WASM_RT_INCLUDED_",
-    "WASM_RT_MAX_CALL_STACK_DEPTH", "wasm_rt_memory_t", "WASM_RT_MODULE_PREFIX",
+    "WASM_RT_CHECK_ALIGNMENT",
+    "WASM_RT_MAX_CALL_STACK_DEPTH", "WASM_RT_MEMCHECK_SIGNAL_HANDLER",
+    "WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX", "wasm_rt_memory_t",
+    "WASM_RT_MODULE_PREFIX",
     "WASM_RT_PASTE_", "WASM_RT_PASTE", "wasm_rt_register_func_type",
     "wasm_rt_table_t", "wasm_rt_trap", "WASM_RT_TRAP_CALL_INDIRECT",
     "WASM_RT_TRAP_DIV_BY_ZERO", "WASM_RT_TRAP_EXHAUSTION",
@@ -713,6 +771,53 @@ void CWriter::Write(const GotoLabel& goto_label) {
   }
 }
 
+// Lowers a br_table to a computed goto through a static table of label
+// addresses, which guarantees jump-table codegen where a C switch may become
+// a branch tree. The table entries are bare label addresses, so this only
+// applies when no target carries a branch value that would need copying
+// before the jump; otherwise nothing is written, false is returned, and the
+// caller emits the switch.
+bool CWriter::TryWriteComputedGotoBrTable(const BrTableExpr* expr) {
+  // The type stack still holds the index operand here; target labels see the
+  // stack after it is dropped.
+  size_t stack_size = type_stack_.size() - 1;
+  auto needs_value_copy = [&](const Var& var) {
+    const Label* label = FindLabel(var);
+    return label->HasValue() && stack_size - label->type_stack_size - 1 != 0;
+  };
+  for (const Var& var : expr->targets) {
+    if (needs_value_copy(var)) {
+      return false;
+    }
+  }
+  if (needs_value_copy(expr->default_target)) {
+    return false;
+  }
+
+  auto write_label_address = [&](const Var& var) {
+    if (var.is_name()) {
+      Write("&&", var);
+    } else {
+      Write("&&", Var(kImplicitFuncLabel));
+    }
+  };
+
+  std::string table = DefineName(&local_syms_, "br_table");
+  Write(OpenBrace(), "static void* const ", table.c_str(), "[] = {");
+  for (const Var& var : expr->targets) {
+    write_label_address(var);
+    Write(", ");
+  }
+  write_label_address(expr->default_target);
+  Write("};", Newline());
+  Index num_targets = expr->targets.size();
+  Write("goto *", table.c_str(), "[", StackVar(0), " < ", num_targets, " ? ",
+        StackVar(0), " : ", num_targets, "];", Newline());
+  Write(CloseBrace(), Newline());
+  DropTypes(1);
+  return true;
+}
+
 void CWriter::Write(const LabelDecl& label) {
   if (IsTopLabelUsed())
     Write(label.name, ":;", Newline());
@@ -886,8 +991,14 @@ void CWriter::WriteSourceTop() {
 
 void CWriter::WriteFuncTypes() {
   Write(Newline());
-  Writef("static u32 func_types[%" PRIzd "];", module_->func_types.size());
-  Write(Newline(), Newline());
+  Writef("%su32 func_types[%" PRIzd "];",
+         IsLeadShard() ? InternalSymbolLinkage() : "extern ",
+         module_->func_types.size());
+  Write(Newline());
+  if (!IsLeadShard()) {
+    return;
+  }
+  Write(Newline());
   Write("static void init_func_types(void) {", Newline());
   Index func_type_index = 0;
   for (FuncType* func_type : module_->func_types) {
@@ -975,7 +1086,7 @@ void CWriter::WriteFuncDeclarations() {
   for (const Func* func : module_->funcs) {
     bool is_import = func_index < module_->num_func_imports;
     if (!is_import) {
-      Write("static ");
+      Write(InternalSymbolLinkage());
       WriteFuncDeclaration(func->decl, DefineGlobalScopeName(func->name));
       Write(";", Newline());
     }
@@ -998,6 +1109,197 @@ void CWriter::WriteFuncDeclaration(const FuncDeclaration& decl,
   Write(")");
 }
 
+// Returns true and fills table_slots_ when the function table is fully known
+// at generation time: exactly one non-imported, non-exported table whose
+// element segments have constant offsets. This writer emits no table
+// mutation opcodes and such a table is unreachable from the host, so every
+// call_indirect can be resolved against the slots collected here.
+bool CWriter::PopulateStaticTable() {
+  if (module_->tables.size() != 1 || module_->num_table_imports != 0) {
+    return false;
+  }
+  for (const Export* export_ : module_->exports) {
+    if (export_->kind == ExternalKind::Table) {
+      return false;
+    }
+  }
+
+  const Table* table = module_->tables[0];
+  table_slots_.assign(table->elem_limits.initial, nullptr);
+  for (const ElemSegment* elem_segment : module_->elem_segments) {
+    const Expr* offset_expr = elem_segment->offset.size() == 1
+                                  ? &elem_segment->offset.front()
+                                  : nullptr;
+    if (!offset_expr || offset_expr->type() != ExprType::Const) {
+      // Offset depends on an imported global; not known until runtime.
+      table_slots_.clear();
+      return false;
+    }
+    uint64_t offset = cast<ConstExpr>(offset_expr)->const_.u32;
+    if (offset + elem_segment->elem_exprs.size() > table_slots_.size()) {
+      table_slots_.clear();
+      return false;
+    }
+
+    size_t i = 0;
+    for (const ElemExpr& elem_expr : elem_segment->elem_exprs) {
+      assert(elem_expr.kind == ElemExprKind::RefFunc);
+      table_slots_[offset + i] = module_->GetFunc(elem_expr.var);
+      ++i;
+    }
+  }
+  return true;
+}
+
+// Maps each func type index to the index of the first structurally-equal
+// type, so two identical type entries share one dispatch helper;
+// wasm_rt_register_func_type canonicalizes the runtime ids the same way.
+// Built once instead of scanning the type list's signatures per query.
+const std::vector<Index>& CWriter::CanonicalFuncTypeIndices() const {
+  if (canonical_func_type_indices_.empty()) {
+    std::map<std::pair<TypeVector, TypeVector>, Index> first_index;
+    canonical_func_type_indices_.reserve(module_->func_types.size());
+    for (size_t i = 0; i < module_->func_types.size(); ++i) {
+      const FuncSignature& sig = module_->func_types[i]->sig;
+      auto inserted = first_index.emplace(
+          std::make_pair(sig.param_types, sig.result_types), i);
+      canonical_func_type_indices_.push_back(inserted.first->second);
+    }
+  }
+  return canonical_func_type_indices_;
+}
+
+Index CWriter::CanonicalFuncTypeIndex(const Var& type_var) const {
+  return CanonicalFuncTypeIndices()[module_->GetFuncTypeIndex(type_var)];
+}
+
+// Collects the canonical func type indices used by the module's
+// call_indirect expressions, so only referenced dispatch helpers are
+// emitted.
+class CallIndirectTypeCollector : public ExprVisitor::DelegateNop {
+ public:
+  CallIndirectTypeCollector(const Module* module,
+                            const std::vector<Index>& canonical_indices,
+                            std::set<Index>* out)
+      : module_(module), canonical_indices_(canonical_indices), out_(out) {}
+
+  Result OnCallIndirectExpr(CallIndirectExpr* expr) override {
+    out_->insert(
+        canonical_indices_[module_->GetFuncTypeIndex(expr->decl.type_var)]);
+    return Result::Ok;
+  }
+
+ private:
+  const Module* module_;
+  const std::vector<Index>& canonical_indices_;
+  std::set<Index>* out_;
+};
+
+// Writes the prototype of the dispatch helper for |func_type_index|: the
+// runtime table index first, then the signature's parameters.
+void CWriter::WriteIndirectDispatchSignature(Index func_type_index,
+                                             const std::string& name,
+                                             bool with_param_names) {
+  const FuncSignature& sig = module_->func_types[func_type_index]->sig;
+  Write(ResultType(sig.result_types), " ", name, "(u32");
+  if (with_param_names) {
+    Write(" i");
+  }
+  for (Index i = 0; i < sig.param_types.size(); ++i) {
+    Write(", ", sig.param_types[i]);
+    if (with_param_names) {
+      Write(" p", i);
+    }
+  }
+  Write(")");
+}
+
+void CWriter::WriteIndirectDispatchDecls() {
+  if (!options_.devirtualize_indirect_calls || !PopulateStaticTable()) {
+    return;
+  }
+
+  std::set<Index> used_types;
+  CallIndirectTypeCollector collector(module_, CanonicalFuncTypeIndices(),
+                                      &used_types);
+  ExprVisitor visitor(&collector);
+  for (Func* func : module_->funcs) {
+    visitor.VisitFunc(func);
+  }
+
+  for (const Func* func : table_slots_) {
+    if (!func) {
+      continue;
+    }
+    Index func_type_index = CanonicalFuncTypeIndex(func->decl.type_var);
+    if (used_types.count(func_type_index) != 0 &&
+        dispatch_names_.count(func_type_index) == 0) {
+      dispatch_names_.emplace(
+          func_type_index,
+          DefineName(&global_syms_,
+                     "dispatch_t" + std::to_string(func_type_index)));
+    }
+  }
+  if (dispatch_names_.empty()) {
+    return;
+  }
+
+  Write(Newline());
+  for (const auto& pair : dispatch_names_) {
+    Write(InternalSymbolLinkage());
+    WriteIndirectDispatchSignature(pair.first, pair.second, false);
+    Write(";", Newline());
+  }
+}
+
+// Writes one helper per signature present in the static table: a switch of
+// direct calls over the table index, with the same trap as CALL_INDIRECT for
+// null, out-of-bounds and signature-mismatched slots.
+void CWriter::WriteIndirectDispatchFuncs() {
+  for (const auto& pair : dispatch_names_) {
+    Index func_type_index = pair.first;
+    const FuncSignature& sig = module_->func_types[func_type_index]->sig;
+    Index num_params = sig.param_types.size();
+    bool has_result = !sig.result_types.empty();
+
+    Write(Newline(), InternalSymbolLinkage());
+    WriteIndirectDispatchSignature(func_type_index, pair.second, true);
+    Write(" ", OpenBrace());
+    Write("switch (i) ", OpenBrace());
+    for (size_t slot = 0; slot < table_slots_.size(); ++slot) {
+      const Func* func = table_slots_[slot];
+      if (!func ||
+          CanonicalFuncTypeIndex(func->decl.type_var) != func_type_index) {
+        continue;
+      }
+      Write("case ", static_cast<Index>(slot), ": ");
+      if (has_result) {
+        Write("return ");
+      }
+      Write(ExternalRef(func->name), "(");
+      for (Index i = 0; i < num_params; ++i) {
+        if (i != 0) {
+          Write(", ");
+        }
+        Write("p", i);
+      }
+      Write(");");
+      if (!has_result) {
+        Write(" return;");
+      }
+      Write(Newline());
+    }
+    Write("default: ");
+    if (has_result) {
+      Write("return TRAP(CALL_INDIRECT);", Newline());
+    } else {
+      Write("TRAP(CALL_INDIRECT);", Newline());
+    }
+    Write(CloseBrace(), Newline());
+    Write(CloseBrace(), Newline());
+  }
+}
+
 void CWriter::WriteGlobals() {
   Index global_index = 0;
   if (module_->globals.size() != module_->num_global_imports) {
@@ -1006,7 +1308,7 @@ void CWriter::WriteGlobals() {
     for (const Global* global : module_->globals) {
       bool is_import = global_index < module_->num_global_imports;
       if (!is_import) {
-        Write("static ");
+        Write(IsLeadShard() ? InternalSymbolLinkage() : "extern ");
         WriteGlobal(*global, DefineGlobalScopeName(global->name));
         Write(";", Newline());
       }
@@ -1014,6 +1316,10 @@ void CWriter::WriteGlobals() {
     }
   }
 
+  if (!IsLeadShard()) {
+    return;
+  }
+
   Write(Newline(), "static void init_globals(void) ", OpenBrace());
   global_index = 0;
   for (const Global* global : module_->globals) {
@@ -1044,7 +1350,7 @@ void CWriter::WriteMemories() {
   for (const Memory* memory : module_->memories) {
     bool is_import = memory_index < module_->num_memory_imports;
     if (!is_import) {
-      Write("static ");
+      Write(IsLeadShard() ? InternalSymbolLinkage() : "extern ");
       WriteMemory(DefineGlobalScopeName(memory->name));
       Write(Newline());
     }
@@ -1067,7 +1373,7 @@ void CWriter::WriteTables() {
   for (const Table* table : module_->tables) {
     bool is_import = table_index < module_->num_table_imports;
     if (!is_import) {
-      Write("static ");
+      Write(IsLeadShard() ? InternalSymbolLinkage() : "extern ");
       WriteTable(DefineGlobalScopeName(table->name));
       Write(Newline());
     }
@@ -1256,11 +1562,22 @@ void CWriter::WriteInit() {
 }
 
 void CWriter::WriteFuncs() {
+  // Each shard writes a contiguous slice of the defined functions.
+  Index num_defined = module_->funcs.size() - module_->num_func_imports;
+  Index shard_size = (num_defined + num_shards_ - 1) / num_shards_;
+  Index shard_begin = std::min(shard_index_ * shard_size, num_defined);
+  Index shard_end = std::min(shard_begin + shard_size, num_defined);
+
   Index func_index = 0;
+  Index defined_index = 0;
   for (const Func* func : module_->funcs) {
     bool is_import = func_index < module_->num_func_imports;
-    if (!is_import)
-      Write(Newline(), *func, Newline());
+    if (!is_import) {
+      if (defined_index >= shard_begin && defined_index < shard_end) {
+        Write(Newline(), *func, Newline());
+      }
+      ++defined_index;
+    }
     ++func_index;
   }
 }
@@ -1272,7 +1589,7 @@ void CWriter::Write(const Func& func) {
   local_sym_map_.clear();
   stack_var_sym_map_.clear();
 
-  Write("static ", ResultType(func.decl.sig.result_types), " ",
+  Write(InternalSymbolLinkage(), ResultType(func.decl.sig.result_types), " ",
         GlobalName(func.name), "(");
   WriteParamsAndLocals();
   Write("FUNC_PROLOGUE;", Newline());
@@ -1424,6 +1741,12 @@ void CWriter::Write(const ExprList& exprs) {
 
       case ExprType::BrTable: {
         const auto* bt_expr = cast<BrTableExpr>(&expr);
+        if (options_.computed_goto_br_table &&
+            TryWriteComputedGotoBrTable(bt_expr)) {
+          // Stop processing this ExprList, since the following are
+          // unreachable.
+          return;
+        }
         Write("switch (", StackVar(0), ") ", OpenBrace());
         DropTypes(1);
         Index i = 0;
@@ -1477,13 +1800,25 @@ void CWriter::Write(const ExprList& exprs) {
         assert(decl.has_func_type);
         Index func_type_index = module_->GetFuncTypeIndex(decl.type_var);
 
-        Write("CALL_INDIRECT(", ExternalRef(table->name), ", ");
-        WriteFuncDeclaration(decl, "(*)");
-        Write(", ", func_type_index, ", ", StackVar(0));
-        for (Index i = 0; i < num_params; ++i) {
-          Write(", ", StackVar(num_params - i));
+        auto dispatch_iter =
+            dispatch_names_.find(CanonicalFuncTypeIndex(decl.type_var));
+        if (dispatch_iter != dispatch_names_.end()) {
+          // The table contents are known, so dispatch through a switch of
+          // direct calls instead of the runtime type check.
+          Write(dispatch_iter->second, "(", StackVar(0));
+          for (Index i = 0; i < num_params; ++i) {
+            Write(", ", StackVar(num_params - i));
+          }
+          Write(");", Newline());
+        } else {
+          Write("CALL_INDIRECT(", ExternalRef(table->name), ", ");
+          WriteFuncDeclaration(decl, "(*)");
+          Write(", ", func_type_index, ", ", StackVar(0));
+          for (Index i = 0; i < num_params; ++i) {
+            Write(", ", StackVar(num_params - i));
+          }
+          Write(");", Newline());
         }
-        Write(");", Newline());
         DropTypes(num_params + 1);
         PushTypes(decl.sig.result_types);
         break;
@@ -2072,9 +2407,18 @@ void CWriter::Write(const LoadExpr& expr) {
   assert(module_->memories.size() == 1);
   Memory* memory = module_->memories[0];
 
+  // When the alignment hint promises a naturally aligned access, use the
+  // *_aligned helper; its typed dereference vectorizes where the memcpy in
+  // the generic helper doesn't always. 8-bit accesses can't be misaligned,
+  // so they keep the generic helper.
+  const char* aligned =
+      expr.opcode.GetMemorySize() > 1 && expr.opcode.IsNaturallyAligned(expr.align)
+          ? "_aligned"
+          : "";
+
   Type result_type = expr.opcode.GetResultType();
-  Write(StackVar(0, result_type), " = ", func, "(", ExternalPtr(memory->name),
-        ", (u64)(", StackVar(0));
+  Write(StackVar(0, result_type), " = ", func, aligned, "(",
+        ExternalPtr(memory->name), ", (u64)(", StackVar(0));
   if (expr.offset != 0)
     Write(" + ", expr.offset);
   Write("));", Newline());
@@ -2102,7 +2446,13 @@ void CWriter::Write(const StoreExpr& expr) {
   assert(module_->memories.size() == 1);
   Memory* memory = module_->memories[0];
 
-  Write(func, "(", ExternalPtr(memory->name), ", (u64)(", StackVar(1));
+  // See the LoadExpr overload for when the *_aligned helper applies.
+  const char* aligned =
+      expr.opcode.GetMemorySize() > 1 && expr.opcode.IsNaturallyAligned(expr.align)
+          ? "_aligned"
+          : "";
+
+  Write(func, aligned, "(", ExternalPtr(memory->name), ", (u64)(", StackVar(1));
   if (expr.offset != 0)
     Write(" + ", expr.offset);
   Write("), ", StackVar(0), ");", Newline());
@@ -2293,15 +2643,19 @@ void CWriter::WriteCSource() {
   WriteSourceTop();
   WriteFuncTypes();
   WriteFuncDeclarations();
+  WriteIndirectDispatchDecls();
   WriteGlobals();
   WriteMemories();
   WriteTables();
   WriteFuncs();
-  WriteDataInitializers();
-  WriteElemInitializers();
-  WriteExports(WriteExportsKind::Definitions);
-  WriteInitExports();
-  WriteInit();
+  if (IsLeadShard()) {
+    WriteIndirectDispatchFuncs();
+    WriteDataInitializers();
+    WriteElemInitializers();
+    WriteExports(WriteExportsKind::Definitions);
+    WriteInitExports();
+    WriteInit();
+  }
 }
 
 Result CWriter::WriteModule(const Module& module) {
@@ -2324,4 +2678,41 @@ Result WriteC(Stream* c_stream,
   return c_writer.WriteModule(*module);
 }
 
+Result WriteCSharded(const std::vector<Stream*>& c_streams,
+                     Stream* h_stream,
+                     const char* header_name,
+                     const Module* module,
+                     const WriteCOptions& options) {
+  assert(!c_streams.empty());
+  if (c_streams.size() == 1) {
+    return WriteC(c_streams[0], h_stream, header_name, module, options);
+  }
+
+  Index num_shards = c_streams.size();
+  std::vector<Result> results(num_shards, Result::Ok);
+  std::vector<std::thread> threads;
+  // Every shard runs the header pass for its symbol-naming side effects, but
+  // only the first one's output is kept.
+  std::vector<std::unique_ptr<MemoryStream>> scratch_h_streams(num_shards);
+  for (Index i = 0; i < num_shards; ++i) {
+    Stream* shard_h_stream = h_stream;
+    if (i != 0) {
+      scratch_h_streams[i] = MakeUnique<MemoryStream>();
+      shard_h_stream = scratch_h_streams[i].get();
+    }
+    threads.emplace_back([&, i, shard_h_stream]() {
+      CWriter c_writer(c_streams[i], shard_h_stream, header_name, options, i,
+                       num_shards);
+      results[i] = c_writer.WriteModule(*module);
+    });
+  }
+
+  Result result = Result::Ok;
+  for (Index i = 0; i < num_shards; ++i) {
+    threads[i].join();
+    result |= results[i];
+  }
+  return result;
+}
+
 }  // namespace wabt
@@ -17,6 +17,8 @@
 #ifndef WABT_C_WRITER_H_
 #define WABT_C_WRITER_H_
 
+#include <vector>
+
 #include "src/common.h"
 
 namespace wabt {
@@ -24,7 +26,18 @@ namespace wabt {
 struct Module;
 class Stream;
 
-struct WriteCOptions {};
+struct WriteCOptions {
+  // Lower call_indirect to a switch of direct calls when the function table
+  // is fully known at generation time (no table imports or exports, constant
+  // element offsets), bypassing the CALL_INDIRECT runtime type check.
+  bool devirtualize_indirect_calls = false;
+  // Lower br_table to a GCC/Clang computed goto through a static table of
+  // label addresses instead of a C switch, which compilers may turn into a
+  // branch tree. Requires the labels-as-values extension. Tables whose
+  // targets carry a branch value that must be copied before the jump keep
+  // the switch.
+  bool computed_goto_br_table = false;
+};
 
 Result WriteC(Stream* c_stream,
               Stream* h_stream,
@@ -32,6 +45,18 @@ Result WriteC(Stream* c_stream,
               const Module*,
               const WriteCOptions&);
 
+// Like WriteC, but shards the function definitions across the given C
+// streams, one output file per stream, generating them in parallel with one
+// worker thread per shard. Module-level definitions, initializers and
+// exports go in the first stream; symbols referenced across shards get
+// external instead of static linkage, so each output is an ordinary
+// translation unit that can also be compiled in parallel.
+Result WriteCSharded(const std::vector<Stream*>& c_streams,
+                     Stream* h_stream,
+                     const char* header_name,
+                     const Module*,
+                     const WriteCOptions&);
+
 }  // namespace wabt
 
 #endif /* WABT_C_WRITER_H_ */
@@ -34,6 +34,7 @@
 
 #include "src/make-unique.h"
 #include "src/result.h"
+#include "src/small-vector.h"
 #include "src/string-view.h"
 
 #define WABT_FATAL(...) fprintf(stderr, __VA_ARGS__), exit(1)
@@ -104,10 +105,10 @@ struct v128 {
   uint32_t v[4];
 
   bool operator==(const v128& other) const {
-    return v[0] == other.v[0] &&
-           v[1] == other.v[1] &&
-           v[2] == other.v[2] &&
-           v[3] == other.v[3];
+    // Branchless form; compiles to a single 128-bit compare, which matters in
+    // spectest result checking where the simd suites compare many v128s.
+    return ((v[0] ^ other.v[0]) | (v[1] ^ other.v[1]) | (v[2] ^ other.v[2]) |
+            (v[3] ^ other.v[3])) == 0;
   }
   bool operator!=(const v128& other) const { return !(*this == other); }
 };
@@ -183,14 +184,17 @@ struct Location {
   };
 
   Location() : line(0), first_column(0), last_column(0) {}
-  Location(string_view filename, int line, int first_column, int last_column)
+  Location(const char* filename, int line, int first_column, int last_column)
       : filename(filename),
         line(line),
         first_column(first_column),
         last_column(last_column) {}
   explicit Location(size_t offset) : offset(offset) {}
 
-  string_view filename;
+  // NUL-terminated, owned by the lexer or reader that produced the location
+  // (or null). A Location is stored in every Expr, Error and Token, so it's
+  // kept to a pointer here rather than a string_view.
+  const char* filename = nullptr;
   union {
     // For text files.
     struct {
@@ -222,7 +226,10 @@ enum class Type : int32_t {
   Nullref = 1,      // Not actually specified, but used in testing and type-checking
   Hostref = 2,      // Not actually specified, but used in testing and type-checking
 };
-typedef std::vector<Type> TypeVector;
+// Type vectors are overwhelmingly short (most signatures have at most a few
+// params and results), so keep the first few entries inline and avoid a heap
+// allocation entirely in the common case.
+typedef SmallVector<Type, 4> TypeVector;
 
 // Matches binary format, do not change.
 enum SegmentFlags : uint8_t {
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/data-compression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace wabt {
+
+namespace {
+
+const size_t kMinMatch = 4;
+const size_t kMaxMatch = 0x7f + kMinMatch;
+const size_t kMaxLiteralRun = 0x80;
+const size_t kMaxDistance = 0xffff;
+const uint32_t kHashBits = 14;
+
+// Hashes the 4 bytes at |p| into the match table.
+uint32_t HashPrefix(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+void FlushLiterals(const uint8_t* data,
+                   size_t begin,
+                   size_t end,
+                   std::vector<uint8_t>* out) {
+  while (begin < end) {
+    size_t run = std::min(end - begin, kMaxLiteralRun);
+    out->push_back(static_cast<uint8_t>(run - 1));
+    out->insert(out->end(), data + begin, data + begin + run);
+    begin += run;
+  }
+}
+
+}  // end anonymous namespace
+
+void CompressData(const uint8_t* data,
+                  size_t size,
+                  std::vector<uint8_t>* out) {
+  out->clear();
+  // Entries store position + 1 so that zero-initialized means empty.
+  std::vector<size_t> table(size_t(1) << kHashBits, 0);
+  size_t pos = 0;
+  size_t literal_begin = 0;
+  while (pos + kMinMatch <= size) {
+    uint32_t hash = HashPrefix(data + pos);
+    size_t candidate = table[hash];
+    table[hash] = pos + 1;
+    if (candidate != 0) {
+      size_t match_pos = candidate - 1;
+      size_t distance = pos - match_pos;
+      if (distance <= kMaxDistance &&
+          memcmp(data + match_pos, data + pos, kMinMatch) == 0) {
+        size_t max_length = std::min(kMaxMatch, size - pos);
+        size_t length = kMinMatch;
+        while (length < max_length &&
+               data[match_pos + length] == data[pos + length]) {
+          length++;
+        }
+        FlushLiterals(data, literal_begin, pos, out);
+        out->push_back(static_cast<uint8_t>(0x80 | (length - kMinMatch)));
+        out->push_back(static_cast<uint8_t>(distance));
+        out->push_back(static_cast<uint8_t>(distance >> 8));
+        pos += length;
+        literal_begin = pos;
+        continue;
+      }
+    }
+    pos++;
+  }
+  FlushLiterals(data, literal_begin, size, out);
+}
+
+size_t MaxDecompressedSize(size_t compressed_size) {
+  // The densest control is a 3-byte match emitting kMaxMatch bytes.
+  if (compressed_size > SIZE_MAX / kMaxMatch) {
+    return SIZE_MAX;
+  }
+  return compressed_size * kMaxMatch / 3;
+}
+
+Result DecompressData(const uint8_t* data,
+                      size_t size,
+                      size_t decompressed_size,
+                      std::vector<uint8_t>* out) {
+  out->clear();
+  out->reserve(decompressed_size);
+  size_t pos = 0;
+  while (pos < size) {
+    uint8_t control = data[pos++];
+    if (control < 0x80) {
+      size_t run = size_t(control) + 1;
+      if (run > size - pos || run > decompressed_size - out->size()) {
+        return Result::Error;
+      }
+      out->insert(out->end(), data + pos, data + pos + run);
+      pos += run;
+    } else {
+      size_t length = (control & 0x7f) + kMinMatch;
+      if (size - pos < 2) {
+        return Result::Error;
+      }
+      size_t distance = data[pos] | (data[pos + 1] << 8);
+      pos += 2;
+      if (distance == 0 || distance > out->size() ||
+          length > decompressed_size - out->size()) {
+        return Result::Error;
+      }
+      // Copy byte-by-byte; a match may overlap its own output.
+      size_t from = out->size() - distance;
+      for (size_t i = 0; i < length; ++i) {
+        out->push_back((*out)[from + i]);
+      }
+    }
+  }
+  if (out->size() != decompressed_size) {
+    return Result::Error;
+  }
+  return Result::Ok;
+}
+
+}  // namespace wabt
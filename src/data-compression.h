@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_DATA_COMPRESSION_H_
+#define WABT_DATA_COMPRESSION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "src/common.h"
+
+namespace wabt {
+
+// A small self-contained byte-oriented LZ77 codec, used by the binary writer
+// to store data segments in the "wabt.compressed-data" custom section. The
+// compressed stream is a sequence of blocks, each introduced by a control
+// byte:
+//
+//   0xxxxxxx  literal run; the next (x + 1) bytes are copied to the output.
+//   1xxxxxxx  match of length (x + 4), followed by a 2-byte little-endian
+//             distance (1..65535) back from the current output position.
+//
+// Matches may overlap their own output (distance < length), which encodes
+// runs of a repeated pattern.
+
+// Compresses |size| bytes at |data|, replacing the contents of |out|. Never
+// fails; incompressible input degrades to literal runs with one control byte
+// of overhead per 128 input bytes.
+void CompressData(const uint8_t* data, size_t size, std::vector<uint8_t>* out);
+
+// Decompresses |size| bytes at |data|, replacing the contents of |out|.
+// Returns Result::Error if the stream is malformed or does not decompress to
+// exactly |decompressed_size| bytes.
+Result DecompressData(const uint8_t* data,
+                      size_t size,
+                      size_t decompressed_size,
+                      std::vector<uint8_t>* out);
+
+// Upper bound on what any well-formed |compressed_size|-byte stream can
+// decompress to. Lets callers reject an absurd declared size before handing
+// it to DecompressData, which allocates the full amount up front.
+size_t MaxDecompressedSize(size_t compressed_size);
+
+}  // namespace wabt
+
+#endif /* WABT_DATA_COMPRESSION_H_ */
@@ -49,12 +49,19 @@ enum class NodeType {
   Expr
 };
 
+// Nodes live in the AST's arena (AST::nodes below) and refer to their
+// children by arena index, so restructuring the tree while it is being built
+// (the rotates and inserts in Construct) shuffles 8-byte indices instead of
+// whole nodes and their child vectors. Indices stay valid as the arena grows;
+// nodes are never removed from it.
+typedef size_t NodeIndex;
+
 // The AST we're going to convert the standard IR into.
 struct Node {
   NodeType ntype;
   ExprType etype;  // Only if ntype == Expr.
   const Expr* e;
-  std::vector<Node> children;
+  std::vector<NodeIndex> children;
   // Node specific annotations.
   union {
     LabelType lt;  // br/br_if target.
@@ -90,21 +97,22 @@ struct AST {
     if (f) mc.EndFunc();
   }
 
-  // Create a new node, take nargs existing nodes on the exp stack as children.
+  // Create a new node in the arena, take nargs existing nodes on the exp
+  // stack as children.
   Node& InsertNode(NodeType ntype, ExprType etype, const Expr* e, Index nargs) {
     assert(exp_stack.size() >= nargs);
-    Node n { ntype, etype, e, nullptr };
-    n.children.reserve(nargs);
-    std::move(exp_stack.end() - nargs, exp_stack.end(),
-              std::back_inserter(n.children));
+    nodes.emplace_back(ntype, etype, e, nullptr);
+    Node& n = nodes.back();
+    n.children.assign(exp_stack.end() - nargs, exp_stack.end());
     exp_stack.erase(exp_stack.end() - nargs, exp_stack.end());
-    exp_stack.push_back(std::move(n));
-    return exp_stack.back();
+    exp_stack.push_back(nodes.size() - 1);
+    return n;
   }
 
   template<ExprType T> void PreDecl(const VarExpr<T>& ve) {
-    exp_stack.emplace(exp_stack.begin() + pre_decl_insertion_point++,
-                  NodeType::Decl, ExprType::Nop, nullptr, &ve.var);
+    nodes.emplace_back(NodeType::Decl, ExprType::Nop, nullptr, &ve.var);
+    exp_stack.insert(exp_stack.begin() + pre_decl_insertion_point++,
+                     nodes.size() - 1);
   }
 
   template<ExprType T> void Get(const VarExpr<T>& ve, bool local) {
@@ -315,8 +323,8 @@ struct AST {
     auto end = exp_stack.size();
     assert(end >= start);
     if (return_results && !exp_stack.empty()) {
-      if (exp_stack.back().etype == ExprType::Return) {
-        if (exp_stack.back().children.empty()) {
+      if (nodes[exp_stack.back()].etype == ExprType::Return) {
+        if (nodes[exp_stack.back()].children.empty()) {
           // Return statement at the end of a void function.
           exp_stack.pop_back();
         }
@@ -337,7 +345,10 @@ struct AST {
   }
 
   ModuleContext& mc;
-  std::vector<Node> exp_stack;
+  // All nodes for this function, in creation order; the tree structure is in
+  // the per-node children indices.
+  std::vector<Node> nodes;
+  std::vector<NodeIndex> exp_stack;
   const Func *f;
   size_t pre_decl_insertion_point = 0;
   int value_stack_depth = 0;
@@ -233,10 +233,10 @@ struct Decompiler {
     return "t" + std::to_string(n);
   }
 
-  Value DecompileExpr(const Node &n) {
+  Value DecompileExpr(const AST& ast, const Node& n) {
     std::vector<Value> args;
-    for (auto &c : n.children) {
-      args.push_back(DecompileExpr(c));
+    for (auto ci : n.children) {
+      args.push_back(DecompileExpr(ast, ast.nodes[ci]));
     }
     // First deal with the specialized node types.
     switch (n.ntype) {
@@ -443,7 +443,7 @@ struct Decompiler {
     for (auto g : mc.module.globals) {
       AST ast(mc, nullptr);
       ast.Construct(g->init_expr, 1, false);
-      auto val = DecompileExpr(ast.exp_stack[0]);
+      auto val = DecompileExpr(ast, ast.nodes[ast.exp_stack[0]]);
       assert(ast.exp_stack.size() == 1 && val.v.size() == 1);
       stream.Writef("global %s:%s = %s\n", g->name.c_str(),
                     GetDecompTypeName(g->type), val.v[0].c_str());
@@ -479,7 +479,7 @@ struct Decompiler {
         stream.Writef(" = import;\n\n");
       } else {
         stream.Writef(" {\n");
-        auto val = DecompileExpr(ast.exp_stack[0]);
+        auto val = DecompileExpr(ast, ast.nodes[ast.exp_stack[0]]);
         IndentValue(val, indent_amount, {});
         for (auto& s : val.v) {
           stream.Writef("%s\n", s.c_str());
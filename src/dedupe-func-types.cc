@@ -0,0 +1,151 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/dedupe-func-types.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "src/cast.h"
+#include "src/expr-visitor.h"
+#include "src/ir.h"
+
+namespace wabt {
+
+namespace {
+
+class FuncTypeDeduper : public ExprVisitor::DelegateNop {
+ public:
+  FuncTypeDeduper() : visitor_(this) {}
+
+  Result VisitModule(Module* module);
+
+  // Implementation of ExprVisitor::DelegateNop.
+  Result OnCallIndirectExpr(CallIndirectExpr*) override;
+  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr*) override;
+
+ private:
+  void RemapTypeVar(Var* var);
+
+  ExprVisitor visitor_;
+  // Old type index to new type index; the identity mapping for entries that
+  // survive, and the surviving equivalent for removed duplicates.
+  std::vector<Index> remap_;
+};
+
+void FuncTypeDeduper::RemapTypeVar(Var* var) {
+  // Name vars keep resolving through the rewritten bindings.
+  if (var->is_index() && var->index() < remap_.size()) {
+    var->set_index(remap_[var->index()]);
+  }
+}
+
+Result FuncTypeDeduper::OnCallIndirectExpr(CallIndirectExpr* expr) {
+  if (expr->decl.has_func_type) {
+    RemapTypeVar(&expr->decl.type_var);
+  }
+  return Result::Ok;
+}
+
+Result FuncTypeDeduper::OnReturnCallIndirectExpr(ReturnCallIndirectExpr* expr) {
+  if (expr->decl.has_func_type) {
+    RemapTypeVar(&expr->decl.type_var);
+  }
+  return Result::Ok;
+}
+
+Result FuncTypeDeduper::VisitModule(Module* module) {
+  // Map each signature to the new index of its first entry, keeping one
+  // representative per distinct signature.
+  std::map<std::pair<TypeVector, TypeVector>, Index> canonical;
+  remap_.resize(module->func_types.size());
+  std::vector<bool> keep(module->func_types.size());
+  Index num_kept = 0;
+  bool changed = false;
+  for (size_t i = 0; i < module->func_types.size(); ++i) {
+    const FuncSignature& sig = module->func_types[i]->sig;
+    auto pair = canonical.emplace(
+        std::make_pair(sig.param_types, sig.result_types), num_kept);
+    keep[i] = pair.second;
+    if (pair.second) {
+      remap_[i] = num_kept++;
+    } else {
+      remap_[i] = pair.first->second;
+      changed = true;
+    }
+  }
+  if (!changed) {
+    return Result::Ok;
+  }
+
+  // Rewrite every index var that refers into the type index space.
+  // call_indirect is not a constant expression, so only func bodies need
+  // visiting.
+  for (Func* func : module->funcs) {
+    if (func->decl.has_func_type) {
+      RemapTypeVar(&func->decl.type_var);
+    }
+    CHECK_RESULT(visitor_.VisitFunc(func));
+  }
+  for (Event* event : module->events) {
+    if (event->decl.has_func_type) {
+      RemapTypeVar(&event->decl.type_var);
+    }
+  }
+
+  // Rebind names (including those of removed duplicates) to the new indexes.
+  BindingHash new_bindings;
+  new_bindings.set_string_pool(module->string_pool.get());
+  new_bindings.reserve(module->func_type_bindings.size());
+  for (const auto& entry : module->func_type_bindings) {
+    Binding binding = entry.second;
+    if (binding.index < remap_.size()) {
+      binding.index = remap_[binding.index];
+    }
+    new_bindings.emplace(entry.first, binding);
+  }
+  module->func_type_bindings = std::move(new_bindings);
+
+  // Drop the duplicate fields and renumber the type index space.
+  std::vector<FuncType*> new_func_types;
+  new_func_types.reserve(num_kept);
+  Index type_index = 0;
+  for (auto iter = module->fields.begin(); iter != module->fields.end();) {
+    if (auto* field = dyn_cast<FuncTypeModuleField>(&*iter)) {
+      if (keep[type_index]) {
+        new_func_types.push_back(&field->func_type);
+        ++iter;
+      } else {
+        iter = module->fields.erase(iter);
+      }
+      ++type_index;
+    } else {
+      ++iter;
+    }
+  }
+  module->func_types = std::move(new_func_types);
+  return Result::Ok;
+}
+
+}  // end anonymous namespace
+
+Result DedupeFuncTypes(Module* module) {
+  FuncTypeDeduper deduper;
+  return deduper.VisitModule(module);
+}
+
+}  // namespace wabt
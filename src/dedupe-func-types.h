@@ -0,0 +1,36 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_DEDUPE_FUNC_TYPES_H_
+#define WABT_DEDUPE_FUNC_TYPES_H_
+
+#include "src/common.h"
+
+namespace wabt {
+
+struct Module;
+
+// Removes func type entries whose signature duplicates an earlier entry and
+// rewrites every type use (func and event declarations, call_indirect) to
+// the first entry with the same signature. Generated modules commonly repeat
+// the same signature many times; deduping shrinks the type section and the
+// working set of every later pass. The names of removed entries remain bound
+// to the surviving entry.
+Result DedupeFuncTypes(Module* module);
+
+}  // namespace wabt
+
+#endif /* WABT_DEDUPE_FUNC_TYPES_H_ */
@@ -266,9 +266,8 @@ wabt::Errors* wabt_new_errors(void) {
 
 wabt::OutputBuffer* wabt_format_text_errors(wabt::Errors* errors,
                                             wabt::WastLexer* lexer) {
-  auto line_finder = lexer->MakeLineFinder();
   std::string string_result = FormatErrorsToString(
-      *errors, wabt::Location::Type::Text, line_finder.get());
+      *errors, wabt::Location::Type::Text, lexer->line_finder());
 
   wabt::OutputBuffer* result = new wabt::OutputBuffer();
   std::copy(string_result.begin(), string_result.end(),
@@ -32,8 +32,8 @@ std::string FormatError(const Error& error,
   result += color.MaybeBoldCode();
 
   const Location& loc = error.loc;
-  if (!loc.filename.empty()) {
-    result += loc.filename.to_string();
+  if (loc.filename && *loc.filename) {
+    result += loc.filename;
     result += ":";
   }
 
@@ -56,15 +56,21 @@ std::string FormatError(const Error& error,
     line_finder->GetSourceLine(loc, source_line_max_length, &source_line);
   }
 
-  if (!source_line.line.empty()) {
+  if (!source_line.empty()) {
     result += indent_str;
-    result += source_line.line;
+    if (source_line.has_start_ellipsis) {
+      result += "...";
+    }
+    result.append(source_line.text.data(), source_line.text.size());
+    if (source_line.has_end_ellipsis) {
+      result += "...";
+    }
     result += '\n';
     result += indent_str;
 
     size_t num_spaces = (loc.first_column - 1) - source_line.column_offset;
     size_t num_carets = loc.last_column - loc.first_column;
-    num_carets = std::min(num_carets, source_line.line.size() - num_spaces);
+    num_carets = std::min(num_carets, source_line.size() - num_spaces);
     num_carets = std::max<size_t>(num_carets, 1);
     result.append(num_spaces, ' ');
     result += color.MaybeBoldCode();
@@ -17,17 +17,22 @@
 #ifndef WABT_EXPR_VISITOR_H_
 #define WABT_EXPR_VISITOR_H_
 
+#include "src/cast.h"
 #include "src/common.h"
 #include "src/ir.h"
 
 namespace wabt {
 
-class ExprVisitor {
+// Iterative traversal over an expression tree, parameterized on the delegate
+// type. When Delegate is a concrete class with non-virtual handlers (usually
+// derived from ExprVisitorNopDelegate), every callback is a direct call the
+// compiler can inline; instantiating with ExprVisitorDelegate gives the
+// classic virtual-dispatch visitor, also available under the ExprVisitor
+// alias below.
+template <typename Delegate>
+class ExprVisitorT {
  public:
-  class Delegate;
-  class DelegateNop;
-
-  explicit ExprVisitor(Delegate* delegate);
+  explicit ExprVisitorT(Delegate* delegate);
 
   Result VisitExpr(Expr*);
   Result VisitExprList(ExprList&);
@@ -44,6 +49,10 @@ class ExprVisitor {
     Catch,
   };
 
+  // Deep enough for almost any real function body, so the common case never
+  // reallocates mid-traversal; deeper nesting falls back to vector growth.
+  static const size_t kInitialStackCapacity = 32;
+
   Result HandleDefaultState(Expr*);
   void PushDefault(Expr*);
   void PopDefault();
@@ -60,9 +69,24 @@ class ExprVisitor {
   std::vector<ExprList::iterator> expr_iter_stack_;
 };
 
-class ExprVisitor::Delegate {
+class ExprVisitorDelegate;
+class ExprVisitorDelegateNop;
+
+// The polymorphic visitor: delegates are chosen at runtime through the
+// ExprVisitor::Delegate virtual interface. Passes on a hot path should
+// instantiate ExprVisitorT with their concrete delegate type instead.
+class ExprVisitor : public ExprVisitorT<ExprVisitorDelegate> {
+ public:
+  typedef ExprVisitorDelegate Delegate;
+  typedef ExprVisitorDelegateNop DelegateNop;
+
+  explicit ExprVisitor(Delegate* delegate)
+      : ExprVisitorT<ExprVisitorDelegate>(delegate) {}
+};
+
+class ExprVisitorDelegate {
  public:
-  virtual ~Delegate() {}
+  virtual ~ExprVisitorDelegate() {}
 
   virtual Result OnBinaryExpr(BinaryExpr*) = 0;
   virtual Result BeginBlockExpr(BlockExpr*) = 0;
@@ -129,7 +153,7 @@ class ExprVisitor::Delegate {
   virtual Result OnLoadSplatExpr(LoadSplatExpr*) = 0;
 };
 
-class ExprVisitor::DelegateNop : public ExprVisitor::Delegate {
+class ExprVisitorDelegateNop : public ExprVisitorDelegate {
  public:
   Result OnBinaryExpr(BinaryExpr*) override { return Result::Ok; }
   Result BeginBlockExpr(BlockExpr*) override { return Result::Ok; }
@@ -200,6 +224,477 @@ class ExprVisitor::DelegateNop : public ExprVisitor::Delegate {
   Result OnLoadSplatExpr(LoadSplatExpr*) override { return Result::Ok; }
 };
 
+// Non-virtual counterpart of ExprVisitor::DelegateNop, for delegates used
+// with ExprVisitorT. A derived delegate shadows the handlers it cares about;
+// the rest resolve statically to these empty inline bodies.
+class ExprVisitorNopDelegate {
+ public:
+  Result OnBinaryExpr(BinaryExpr*) { return Result::Ok; }
+  Result BeginBlockExpr(BlockExpr*) { return Result::Ok; }
+  Result EndBlockExpr(BlockExpr*) { return Result::Ok; }
+  Result OnBrExpr(BrExpr*) { return Result::Ok; }
+  Result OnBrIfExpr(BrIfExpr*) { return Result::Ok; }
+  Result OnBrOnExnExpr(BrOnExnExpr*) { return Result::Ok; }
+  Result OnBrTableExpr(BrTableExpr*) { return Result::Ok; }
+  Result OnCallExpr(CallExpr*) { return Result::Ok; }
+  Result OnCallIndirectExpr(CallIndirectExpr*) { return Result::Ok; }
+  Result OnCompareExpr(CompareExpr*) { return Result::Ok; }
+  Result OnConstExpr(ConstExpr*) { return Result::Ok; }
+  Result OnConvertExpr(ConvertExpr*) { return Result::Ok; }
+  Result OnDropExpr(DropExpr*) { return Result::Ok; }
+  Result OnGlobalGetExpr(GlobalGetExpr*) { return Result::Ok; }
+  Result OnGlobalSetExpr(GlobalSetExpr*) { return Result::Ok; }
+  Result BeginIfExpr(IfExpr*) { return Result::Ok; }
+  Result AfterIfTrueExpr(IfExpr*) { return Result::Ok; }
+  Result EndIfExpr(IfExpr*) { return Result::Ok; }
+  Result OnLoadExpr(LoadExpr*) { return Result::Ok; }
+  Result OnLocalGetExpr(LocalGetExpr*) { return Result::Ok; }
+  Result OnLocalSetExpr(LocalSetExpr*) { return Result::Ok; }
+  Result OnLocalTeeExpr(LocalTeeExpr*) { return Result::Ok; }
+  Result BeginLoopExpr(LoopExpr*) { return Result::Ok; }
+  Result EndLoopExpr(LoopExpr*) { return Result::Ok; }
+  Result OnMemoryCopyExpr(MemoryCopyExpr*) { return Result::Ok; }
+  Result OnDataDropExpr(DataDropExpr*) { return Result::Ok; }
+  Result OnMemoryFillExpr(MemoryFillExpr*) { return Result::Ok; }
+  Result OnMemoryGrowExpr(MemoryGrowExpr*) { return Result::Ok; }
+  Result OnMemoryInitExpr(MemoryInitExpr*) { return Result::Ok; }
+  Result OnMemorySizeExpr(MemorySizeExpr*) { return Result::Ok; }
+  Result OnTableCopyExpr(TableCopyExpr*) { return Result::Ok; }
+  Result OnElemDropExpr(ElemDropExpr*) { return Result::Ok; }
+  Result OnTableInitExpr(TableInitExpr*) { return Result::Ok; }
+  Result OnTableGetExpr(TableGetExpr*) { return Result::Ok; }
+  Result OnTableSetExpr(TableSetExpr*) { return Result::Ok; }
+  Result OnTableGrowExpr(TableGrowExpr*) { return Result::Ok; }
+  Result OnTableSizeExpr(TableSizeExpr*) { return Result::Ok; }
+  Result OnRefFuncExpr(RefFuncExpr*) { return Result::Ok; }
+  Result OnRefNullExpr(RefNullExpr*) { return Result::Ok; }
+  Result OnRefIsNullExpr(RefIsNullExpr*) { return Result::Ok; }
+  Result OnNopExpr(NopExpr*) { return Result::Ok; }
+  Result OnReturnExpr(ReturnExpr*) { return Result::Ok; }
+  Result OnReturnCallExpr(ReturnCallExpr*) { return Result::Ok; }
+  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr*) {
+    return Result::Ok;
+  }
+  Result OnSelectExpr(SelectExpr*) { return Result::Ok; }
+  Result OnStoreExpr(StoreExpr*) { return Result::Ok; }
+  Result OnUnaryExpr(UnaryExpr*) { return Result::Ok; }
+  Result OnUnreachableExpr(UnreachableExpr*) { return Result::Ok; }
+  Result BeginTryExpr(TryExpr*) { return Result::Ok; }
+  Result OnCatchExpr(TryExpr*) { return Result::Ok; }
+  Result EndTryExpr(TryExpr*) { return Result::Ok; }
+  Result OnThrowExpr(ThrowExpr*) { return Result::Ok; }
+  Result OnRethrowExpr(RethrowExpr*) { return Result::Ok; }
+  Result OnAtomicWaitExpr(AtomicWaitExpr*) { return Result::Ok; }
+  Result OnAtomicNotifyExpr(AtomicNotifyExpr*) { return Result::Ok; }
+  Result OnAtomicLoadExpr(AtomicLoadExpr*) { return Result::Ok; }
+  Result OnAtomicStoreExpr(AtomicStoreExpr*) { return Result::Ok; }
+  Result OnAtomicRmwExpr(AtomicRmwExpr*) { return Result::Ok; }
+  Result OnAtomicRmwCmpxchgExpr(AtomicRmwCmpxchgExpr*) { return Result::Ok; }
+  Result OnTernaryExpr(TernaryExpr*) { return Result::Ok; }
+  Result OnSimdLaneOpExpr(SimdLaneOpExpr*) { return Result::Ok; }
+  Result OnSimdShuffleOpExpr(SimdShuffleOpExpr*) { return Result::Ok; }
+  Result OnLoadSplatExpr(LoadSplatExpr*) { return Result::Ok; }
+};
+
+template <typename Delegate>
+ExprVisitorT<Delegate>::ExprVisitorT(Delegate* delegate)
+    : delegate_(delegate) {
+  state_stack_.reserve(kInitialStackCapacity);
+  expr_stack_.reserve(kInitialStackCapacity);
+  expr_iter_stack_.reserve(kInitialStackCapacity);
+}
+
+template <typename Delegate>
+Result ExprVisitorT<Delegate>::VisitExpr(Expr* root_expr) {
+  state_stack_.clear();
+  expr_stack_.clear();
+  expr_iter_stack_.clear();
+
+  PushDefault(root_expr);
+
+  while (!state_stack_.empty()) {
+    State state = state_stack_.back();
+    auto* expr = expr_stack_.back();
+
+    switch (state) {
+      case State::Default:
+        PopDefault();
+        CHECK_RESULT(HandleDefaultState(expr));
+        break;
+
+      case State::Block: {
+        auto block_expr = cast<BlockExpr>(expr);
+        auto& iter = expr_iter_stack_.back();
+        if (iter != block_expr->block.exprs.end()) {
+          PushDefault(&*iter++);
+        } else {
+          CHECK_RESULT(delegate_->EndBlockExpr(block_expr));
+          PopExprlist();
+        }
+        break;
+      }
+
+      case State::IfTrue: {
+        auto if_expr = cast<IfExpr>(expr);
+        auto& iter = expr_iter_stack_.back();
+        if (iter != if_expr->true_.exprs.end()) {
+          PushDefault(&*iter++);
+        } else {
+          CHECK_RESULT(delegate_->AfterIfTrueExpr(if_expr));
+          PopExprlist();
+          PushExprlist(State::IfFalse, expr, if_expr->false_);
+        }
+        break;
+      }
+
+      case State::IfFalse: {
+        auto if_expr = cast<IfExpr>(expr);
+        auto& iter = expr_iter_stack_.back();
+        if (iter != if_expr->false_.end()) {
+          PushDefault(&*iter++);
+        } else {
+          CHECK_RESULT(delegate_->EndIfExpr(if_expr));
+          PopExprlist();
+        }
+        break;
+      }
+
+      case State::Loop: {
+        auto loop_expr = cast<LoopExpr>(expr);
+        auto& iter = expr_iter_stack_.back();
+        if (iter != loop_expr->block.exprs.end()) {
+          PushDefault(&*iter++);
+        } else {
+          CHECK_RESULT(delegate_->EndLoopExpr(loop_expr));
+          PopExprlist();
+        }
+        break;
+      }
+
+      case State::Try: {
+        auto try_expr = cast<TryExpr>(expr);
+        auto& iter = expr_iter_stack_.back();
+        if (iter != try_expr->block.exprs.end()) {
+          PushDefault(&*iter++);
+        } else {
+          CHECK_RESULT(delegate_->OnCatchExpr(try_expr));
+          PopExprlist();
+          if (try_expr->catch_.empty()) {
+            CHECK_RESULT(delegate_->EndTryExpr(try_expr));
+          } else {
+            PushExprlist(State::Catch, expr, try_expr->catch_);
+          }
+        }
+        break;
+      }
+
+      case State::Catch: {
+        auto try_expr = cast<TryExpr>(expr);
+        auto& iter = expr_iter_stack_.back();
+        if (iter != try_expr->catch_.end()) {
+          PushDefault(&*iter++);
+        } else {
+          CHECK_RESULT(delegate_->EndTryExpr(try_expr));
+          PopExprlist();
+        }
+        break;
+      }
+    }
+  }
+
+  return Result::Ok;
+}
+
+template <typename Delegate>
+Result ExprVisitorT<Delegate>::VisitExprList(ExprList& exprs) {
+  for (Expr& expr : exprs)
+    CHECK_RESULT(VisitExpr(&expr));
+  return Result::Ok;
+}
+
+template <typename Delegate>
+Result ExprVisitorT<Delegate>::VisitFunc(Func* func) {
+  return VisitExprList(func->exprs);
+}
+
+template <typename Delegate>
+Result ExprVisitorT<Delegate>::HandleDefaultState(Expr* expr) {
+  switch (expr->type()) {
+    case ExprType::AtomicLoad:
+      CHECK_RESULT(delegate_->OnAtomicLoadExpr(cast<AtomicLoadExpr>(expr)));
+      break;
+
+    case ExprType::AtomicStore:
+      CHECK_RESULT(delegate_->OnAtomicStoreExpr(cast<AtomicStoreExpr>(expr)));
+      break;
+
+    case ExprType::AtomicRmw:
+      CHECK_RESULT(delegate_->OnAtomicRmwExpr(cast<AtomicRmwExpr>(expr)));
+      break;
+
+    case ExprType::AtomicRmwCmpxchg:
+      CHECK_RESULT(
+          delegate_->OnAtomicRmwCmpxchgExpr(cast<AtomicRmwCmpxchgExpr>(expr)));
+      break;
+
+    case ExprType::AtomicWait:
+      CHECK_RESULT(delegate_->OnAtomicWaitExpr(cast<AtomicWaitExpr>(expr)));
+      break;
+
+    case ExprType::AtomicNotify:
+      CHECK_RESULT(delegate_->OnAtomicNotifyExpr(cast<AtomicNotifyExpr>(expr)));
+      break;
+
+    case ExprType::Binary:
+      CHECK_RESULT(delegate_->OnBinaryExpr(cast<BinaryExpr>(expr)));
+      break;
+
+    case ExprType::Block: {
+      auto block_expr = cast<BlockExpr>(expr);
+      CHECK_RESULT(delegate_->BeginBlockExpr(block_expr));
+      PushExprlist(State::Block, expr, block_expr->block.exprs);
+      break;
+    }
+
+    case ExprType::Br:
+      CHECK_RESULT(delegate_->OnBrExpr(cast<BrExpr>(expr)));
+      break;
+
+    case ExprType::BrIf:
+      CHECK_RESULT(delegate_->OnBrIfExpr(cast<BrIfExpr>(expr)));
+      break;
+
+    case ExprType::BrOnExn:
+      CHECK_RESULT(delegate_->OnBrOnExnExpr(cast<BrOnExnExpr>(expr)));
+      break;
+
+    case ExprType::BrTable:
+      CHECK_RESULT(delegate_->OnBrTableExpr(cast<BrTableExpr>(expr)));
+      break;
+
+    case ExprType::Call:
+      CHECK_RESULT(delegate_->OnCallExpr(cast<CallExpr>(expr)));
+      break;
+
+    case ExprType::CallIndirect:
+      CHECK_RESULT(delegate_->OnCallIndirectExpr(cast<CallIndirectExpr>(expr)));
+      break;
+
+    case ExprType::Compare:
+      CHECK_RESULT(delegate_->OnCompareExpr(cast<CompareExpr>(expr)));
+      break;
+
+    case ExprType::Const:
+      CHECK_RESULT(delegate_->OnConstExpr(cast<ConstExpr>(expr)));
+      break;
+
+    case ExprType::Convert:
+      CHECK_RESULT(delegate_->OnConvertExpr(cast<ConvertExpr>(expr)));
+      break;
+
+    case ExprType::Drop:
+      CHECK_RESULT(delegate_->OnDropExpr(cast<DropExpr>(expr)));
+      break;
+
+    case ExprType::GlobalGet:
+      CHECK_RESULT(delegate_->OnGlobalGetExpr(cast<GlobalGetExpr>(expr)));
+      break;
+
+    case ExprType::GlobalSet:
+      CHECK_RESULT(delegate_->OnGlobalSetExpr(cast<GlobalSetExpr>(expr)));
+      break;
+
+    case ExprType::If: {
+      auto if_expr = cast<IfExpr>(expr);
+      CHECK_RESULT(delegate_->BeginIfExpr(if_expr));
+      PushExprlist(State::IfTrue, expr, if_expr->true_.exprs);
+      break;
+    }
+
+    case ExprType::Load:
+      CHECK_RESULT(delegate_->OnLoadExpr(cast<LoadExpr>(expr)));
+      break;
+
+    case ExprType::LoadSplat:
+      CHECK_RESULT(delegate_->OnLoadSplatExpr(cast<LoadSplatExpr>(expr)));
+      break;
+
+    case ExprType::LocalGet:
+      CHECK_RESULT(delegate_->OnLocalGetExpr(cast<LocalGetExpr>(expr)));
+      break;
+
+    case ExprType::LocalSet:
+      CHECK_RESULT(delegate_->OnLocalSetExpr(cast<LocalSetExpr>(expr)));
+      break;
+
+    case ExprType::LocalTee:
+      CHECK_RESULT(delegate_->OnLocalTeeExpr(cast<LocalTeeExpr>(expr)));
+      break;
+
+    case ExprType::Loop: {
+      auto loop_expr = cast<LoopExpr>(expr);
+      CHECK_RESULT(delegate_->BeginLoopExpr(loop_expr));
+      PushExprlist(State::Loop, expr, loop_expr->block.exprs);
+      break;
+    }
+
+    case ExprType::MemoryCopy:
+      CHECK_RESULT(delegate_->OnMemoryCopyExpr(cast<MemoryCopyExpr>(expr)));
+      break;
+
+    case ExprType::DataDrop:
+      CHECK_RESULT(delegate_->OnDataDropExpr(cast<DataDropExpr>(expr)));
+      break;
+
+    case ExprType::MemoryFill:
+      CHECK_RESULT(delegate_->OnMemoryFillExpr(cast<MemoryFillExpr>(expr)));
+      break;
+
+    case ExprType::MemoryGrow:
+      CHECK_RESULT(delegate_->OnMemoryGrowExpr(cast<MemoryGrowExpr>(expr)));
+      break;
+
+    case ExprType::MemoryInit:
+      CHECK_RESULT(delegate_->OnMemoryInitExpr(cast<MemoryInitExpr>(expr)));
+      break;
+
+    case ExprType::MemorySize:
+      CHECK_RESULT(delegate_->OnMemorySizeExpr(cast<MemorySizeExpr>(expr)));
+      break;
+
+    case ExprType::TableCopy:
+      CHECK_RESULT(delegate_->OnTableCopyExpr(cast<TableCopyExpr>(expr)));
+      break;
+
+    case ExprType::ElemDrop:
+      CHECK_RESULT(delegate_->OnElemDropExpr(cast<ElemDropExpr>(expr)));
+      break;
+
+    case ExprType::TableInit:
+      CHECK_RESULT(delegate_->OnTableInitExpr(cast<TableInitExpr>(expr)));
+      break;
+
+    case ExprType::TableGet:
+      CHECK_RESULT(delegate_->OnTableGetExpr(cast<TableGetExpr>(expr)));
+      break;
+
+    case ExprType::TableSet:
+      CHECK_RESULT(delegate_->OnTableSetExpr(cast<TableSetExpr>(expr)));
+      break;
+
+    case ExprType::TableGrow:
+      CHECK_RESULT(delegate_->OnTableGrowExpr(cast<TableGrowExpr>(expr)));
+      break;
+
+    case ExprType::TableSize:
+      CHECK_RESULT(delegate_->OnTableSizeExpr(cast<TableSizeExpr>(expr)));
+      break;
+
+    case ExprType::RefFunc:
+      CHECK_RESULT(delegate_->OnRefFuncExpr(cast<RefFuncExpr>(expr)));
+      break;
+
+    case ExprType::RefNull:
+      CHECK_RESULT(delegate_->OnRefNullExpr(cast<RefNullExpr>(expr)));
+      break;
+
+    case ExprType::RefIsNull:
+      CHECK_RESULT(delegate_->OnRefIsNullExpr(cast<RefIsNullExpr>(expr)));
+      break;
+
+    case ExprType::Nop:
+      CHECK_RESULT(delegate_->OnNopExpr(cast<NopExpr>(expr)));
+      break;
+
+    case ExprType::Rethrow:
+      CHECK_RESULT(delegate_->OnRethrowExpr(cast<RethrowExpr>(expr)));
+      break;
+
+    case ExprType::Return:
+      CHECK_RESULT(delegate_->OnReturnExpr(cast<ReturnExpr>(expr)));
+      break;
+
+    case ExprType::ReturnCall:
+      CHECK_RESULT(delegate_->OnReturnCallExpr(cast<ReturnCallExpr>(expr)));
+      break;
+
+    case ExprType::ReturnCallIndirect:
+      CHECK_RESULT(delegate_->OnReturnCallIndirectExpr(
+          cast<ReturnCallIndirectExpr>(expr)));
+      break;
+
+    case ExprType::Select:
+      CHECK_RESULT(delegate_->OnSelectExpr(cast<SelectExpr>(expr)));
+      break;
+
+    case ExprType::Store:
+      CHECK_RESULT(delegate_->OnStoreExpr(cast<StoreExpr>(expr)));
+      break;
+
+    case ExprType::Throw:
+      CHECK_RESULT(delegate_->OnThrowExpr(cast<ThrowExpr>(expr)));
+      break;
+
+    case ExprType::Try: {
+      auto try_expr = cast<TryExpr>(expr);
+      CHECK_RESULT(delegate_->BeginTryExpr(try_expr));
+      PushExprlist(State::Try, expr, try_expr->block.exprs);
+      break;
+    }
+
+    case ExprType::Unary:
+      CHECK_RESULT(delegate_->OnUnaryExpr(cast<UnaryExpr>(expr)));
+      break;
+
+    case ExprType::Ternary:
+      CHECK_RESULT(delegate_->OnTernaryExpr(cast<TernaryExpr>(expr)));
+      break;
+
+    case ExprType::SimdLaneOp:
+      CHECK_RESULT(delegate_->OnSimdLaneOpExpr(cast<SimdLaneOpExpr>(expr)));
+      break;
+
+    case ExprType::SimdShuffleOp:
+      CHECK_RESULT(
+          delegate_->OnSimdShuffleOpExpr(cast<SimdShuffleOpExpr>(expr)));
+      break;
+
+    case ExprType::Unreachable:
+      CHECK_RESULT(delegate_->OnUnreachableExpr(cast<UnreachableExpr>(expr)));
+      break;
+  }
+
+  return Result::Ok;
+}
+
+template <typename Delegate>
+void ExprVisitorT<Delegate>::PushDefault(Expr* expr) {
+  state_stack_.emplace_back(State::Default);
+  expr_stack_.emplace_back(expr);
+}
+
+template <typename Delegate>
+void ExprVisitorT<Delegate>::PopDefault() {
+  state_stack_.pop_back();
+  expr_stack_.pop_back();
+}
+
+template <typename Delegate>
+void ExprVisitorT<Delegate>::PushExprlist(State state,
+                                          Expr* expr,
+                                          ExprList& expr_list) {
+  state_stack_.emplace_back(state);
+  expr_stack_.emplace_back(expr);
+  expr_iter_stack_.emplace_back(expr_list.begin());
+}
+
+template <typename Delegate>
+void ExprVisitorT<Delegate>::PopExprlist() {
+  state_stack_.pop_back();
+  expr_stack_.pop_back();
+  expr_iter_stack_.pop_back();
+}
+
 }  // namespace wabt
 
 #endif  // WABT_EXPR_VISITOR_H_
@@ -99,6 +99,11 @@ class NameGenerator : public ExprVisitor::DelegateNop {
   ExprVisitor visitor_;
   Index label_count_ = 0;
 
+  // Scratch reused across symbols by GenerateAndBindLocalNames so generating
+  // millions of local names doesn't allocate per name.
+  std::string name_buffer_;
+  std::vector<bool> named_indexes_;
+
   Index num_func_imports_ = 0;
   Index num_table_imports_ = 0;
   Index num_memory_imports_ = 0;
@@ -111,6 +116,20 @@ class NameGenerator : public ExprVisitor::DelegateNop {
 NameGenerator::NameGenerator(NameOpts opts)
   : visitor_(this), opts_(opts) {}
 
+// Appends the decimal form of |value| to |str|. Done by hand because
+// std::to_string's temporary string shows up in profiles when every local in
+// a large module gets a generated name.
+static void AppendIndex(std::string* str, Index value) {
+  char buffer[10];  // Index is 32 bits: at most 10 digits.
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+  str->append(p, end - p);
+}
+
 // static
 bool NameGenerator::HasName(const std::string& str) {
   return !str.empty();
@@ -137,11 +156,12 @@ void NameGenerator::GenerateName(const char* prefix,
       }
       *str += IndexToAlphaName(index);
     } else {
-      *str += std::to_string(index);
+      AppendIndex(str, index);
     }
   }
   if (disambiguator != 0) {
-    *str += '_' + std::to_string(disambiguator);
+    *str += '_';
+    AppendIndex(str, disambiguator);
   }
 }
 
@@ -162,7 +182,7 @@ void NameGenerator::GenerateAndBindName(BindingHash* bindings,
   unsigned disambiguator = 0;
   while (true) {
     GenerateName(prefix, index, disambiguator, str);
-    if (bindings->find(*str) == bindings->end()) {
+    if (bindings->count(*str) == 0) {
       bindings->emplace(*str, Binding(index));
       break;
     }
@@ -188,7 +208,7 @@ void NameGenerator::MaybeUseAndBindName(BindingHash* bindings,
     unsigned disambiguator = 0;
     while (true) {
       GenerateName(name, kInvalidIndex, disambiguator, str);
-      if (bindings->find(*str) == bindings->end()) {
+      if (bindings->count(*str) == 0) {
         bindings->emplace(*str, Binding(index));
         break;
       }
@@ -199,19 +219,31 @@ void NameGenerator::MaybeUseAndBindName(BindingHash* bindings,
 }
 
 void NameGenerator::GenerateAndBindLocalNames(Func* func) {
-  std::vector<std::string> index_to_name;
-  MakeTypeBindingReverseMapping(func->GetNumParamsAndLocals(), func->bindings,
-                                &index_to_name);
-  for (size_t i = 0; i < index_to_name.size(); ++i) {
-    const std::string& old_name = index_to_name[i];
-    if (!old_name.empty()) {
+  Index num_names = func->GetNumParamsAndLocals();
+  if (num_names == 0) {
+    return;
+  }
+
+  // Only occupancy matters here, not the names themselves; marking the named
+  // indexes in a reused bitmap avoids materializing a std::string per local
+  // the way MakeTypeBindingReverseMapping would.
+  named_indexes_.assign(num_names, false);
+  for (const auto& pair : func->bindings) {
+    assert(pair.second.index < num_names);
+    named_indexes_[pair.second.index] = true;
+  }
+
+  Index num_params = func->GetNumParams();
+  for (Index i = 0; i < num_names; ++i) {
+    if (named_indexes_[i]) {
       continue;
     }
 
-    const char* prefix = i < func->GetNumParams() ? "p" : "l";
-    std::string new_name;
-    GenerateAndBindName(&func->bindings, prefix, i, &new_name);
-    index_to_name[i] = new_name;
+    // Generated local names live only in the binding hash, which interns its
+    // own copy into the module's string pool on emplace, so one scratch
+    // string serves every local.
+    const char* prefix = i < num_params ? "p" : "l";
+    GenerateAndBindName(&func->bindings, prefix, i, &name_buffer_);
   }
 }
 
@@ -16,6 +16,9 @@
 
 #include "src/hash-util.h"
 
+#include <cstdint>
+#include <cstring>
+
 #include "config.h"
 
 namespace wabt {
@@ -35,4 +38,35 @@ hash_code HashCombine(hash_code seed, hash_code y) {
   return seed;
 }
 
+// MurmurHash64A (public domain, by Austin Appleby), with unaligned-safe
+// loads. Truncated to hash_code on 32-bit hosts.
+hash_code HashBytes(const void* data, std::size_t size) {
+  constexpr uint64_t mul = 0xc6a4a7935bd1e995ull;
+  constexpr int shift = 47;
+  uint64_t hash = 0x5bd1e995ull ^ (size * mul);
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  const uint8_t* end = p + (size & ~static_cast<std::size_t>(7));
+  while (p != end) {
+    uint64_t k;
+    memcpy(&k, p, sizeof(k));
+    p += sizeof(k);
+    k *= mul;
+    k ^= k >> shift;
+    k *= mul;
+    hash ^= k;
+    hash *= mul;
+  }
+  std::size_t tail = size & 7;
+  if (tail != 0) {
+    uint64_t k = 0;
+    memcpy(&k, p, tail);
+    hash ^= k;
+    hash *= mul;
+  }
+  hash ^= hash >> shift;
+  hash *= mul;
+  hash ^= hash >> shift;
+  return static_cast<hash_code>(hash);
+}
+
 }  // namespace wabt
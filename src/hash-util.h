@@ -37,6 +37,11 @@ inline hash_code HashCombine(const T& first, const U&... rest) {
   return HashCombine(HashCombine(rest...), std::hash<T>()(first));
 }
 
+// Hashes an arbitrary byte buffer, mixing eight bytes per round, so it is
+// suitable for large inputs (e.g. content-addressing whole module binaries)
+// where combining a per-byte std::hash would dominate.
+hash_code HashBytes(const void* data, std::size_t size);
+
 template <typename It>
 inline hash_code HashRange(It first, It last) {
   hash_code result = 0;
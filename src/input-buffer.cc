@@ -0,0 +1,127 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/input-buffer.h"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WABT_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WABT_HAS_MMAP 0
+#endif
+
+namespace wabt {
+
+InputBuffer::InputBuffer(InputBuffer&& other) {
+  *this = std::move(other);
+}
+
+InputBuffer& InputBuffer::operator=(InputBuffer&& other) {
+  if (this != &other) {
+    Release();
+    owned_ = std::move(other.owned_);
+    map_base_ = other.map_base_;
+    size_ = other.size_;
+    map_size_ = other.map_size_;
+    other.map_base_ = nullptr;
+    other.size_ = 0;
+    other.map_size_ = 0;
+  }
+  return *this;
+}
+
+InputBuffer::~InputBuffer() {
+  Release();
+}
+
+void InputBuffer::Release() {
+#if WABT_HAS_MMAP
+  if (map_base_) {
+    munmap(map_base_, map_size_);
+  }
+#endif
+  map_base_ = nullptr;
+  size_ = 0;
+  map_size_ = 0;
+  owned_.clear();
+}
+
+Result InputBuffer::ReadFile(string_view filename, LoadPolicy policy) {
+  Release();
+#if WABT_HAS_MMAP
+  std::string filename_str = filename.to_string();
+  int fd = open(filename_str.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) == 0 && (statbuf.st_mode & S_IFREG) &&
+        statbuf.st_size > 0) {
+      size_t size = statbuf.st_size;
+      void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base != MAP_FAILED) {
+        close(fd);
+        map_base_ = base;
+        size_ = size;
+        map_size_ = size;
+        switch (policy) {
+          case LoadPolicy::Default:
+            break;
+          case LoadPolicy::Sequential:
+            madvise(base, size, MADV_SEQUENTIAL);
+            break;
+          case LoadPolicy::WillNeed:
+            madvise(base, size, MADV_WILLNEED);
+            break;
+        }
+        return Result::Ok;
+      }
+    }
+    close(fd);
+  }
+#endif
+  // The fallback read touches every page itself, so |policy| has nothing
+  // left to hint.
+  return wabt::ReadFile(filename, &owned_);
+}
+
+void InputBuffer::Prefault(size_t offset, size_t size) const {
+#if WABT_HAS_MMAP
+  if (!map_base_ || offset >= size_) {
+    return;
+  }
+  size_t end = offset + size < size_ ? offset + size : size_;
+  const uint8_t* p = static_cast<const uint8_t*>(map_base_);
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  madvise(const_cast<uint8_t*>(p + (offset & ~(page_size - 1))), end - offset,
+          MADV_WILLNEED);
+  // madvise is asynchronous best-effort; reading one byte per page
+  // guarantees the faults happen here.
+  volatile uint8_t sink = 0;
+  for (size_t i = offset; i < end; i += page_size) {
+    sink ^= p[i];
+  }
+  WABT_USE(sink);
+#else
+  WABT_USE(offset);
+  WABT_USE(size);
+#endif
+}
+
+}  // namespace wabt
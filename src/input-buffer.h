@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INPUT_BUFFER_H_
+#define WABT_INPUT_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "src/common.h"
+#include "src/string-view.h"
+
+namespace wabt {
+
+// Holds the contents of an input file. On hosts with mmap the file is
+// memory-mapped read-only, so tools that only scan their input (wasm2wat,
+// wasm-objdump, wasm-validate, ...) avoid copying it into an allocated
+// buffer. When mapping isn't available or fails, the file is read into an
+// owned vector with ReadFile as before.
+class InputBuffer {
+ public:
+  // How the caller expects to touch the contents. Purely advisory: policies
+  // are forwarded to the kernel (madvise) for mapped contents on hosts that
+  // have it, and are ignored otherwise or on failure.
+  enum class LoadPolicy {
+    Default,     // No hint.
+    Sequential,  // One front-to-back decode pass; read ahead aggressively.
+    WillNeed,    // All of the file soon (e.g. several passes); prefetch it.
+  };
+
+  WABT_DISALLOW_COPY_AND_ASSIGN(InputBuffer);
+  InputBuffer() = default;
+  InputBuffer(InputBuffer&&);
+  InputBuffer& operator=(InputBuffer&&);
+  ~InputBuffer();
+
+  // Reads (or maps) the given file, releasing any previous contents.
+  Result ReadFile(string_view filename,
+                  LoadPolicy policy = LoadPolicy::Default);
+
+  // Touches every page of contents in [offset, offset + size), clamped to
+  // the buffer, so the major faults are taken here in one sequential sweep
+  // rather than scattered through later decoding. Useful before an
+  // offset-jumping pass over a known region, e.g. lowering the code section
+  // from a section directory.
+  void Prefault(size_t offset, size_t size) const;
+
+  const uint8_t* data() const {
+    return map_base_ ? static_cast<const uint8_t*>(map_base_) : owned_.data();
+  }
+  size_t size() const { return map_base_ ? size_ : owned_.size(); }
+
+ private:
+  void Release();
+
+  std::vector<uint8_t> owned_;
+  void* map_base_ = nullptr;  // non-null when the contents are mmap'd
+  size_t size_ = 0;           // file size when mapped
+  size_t map_size_ = 0;       // mapped length (page-rounded, may be > size_)
+};
+
+}  // namespace wabt
+
+#endif /* WABT_INPUT_BUFFER_H_ */
@@ -16,12 +16,19 @@
 
 #include "src/interp/binary-reader-interp.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "src/binary-reader-impl.h"
 #include "src/binary-reader-nop.h"
 #include "src/cast.h"
 #include "src/feature.h"
@@ -50,13 +57,16 @@ struct Label {
 Label::Label(IstreamOffset offset, IstreamOffset fixup_offset)
     : offset(offset), fixup_offset(fixup_offset) {}
 
-class BinaryReaderInterp : public BinaryReaderNop {
+// final so the delegate-typed reader (see binary-reader-impl.h) dispatches
+// the callbacks without going through the vtable.
+class BinaryReaderInterp final : public BinaryReaderNop {
  public:
   BinaryReaderInterp(Environment* env,
                      DefinedModule* module,
                      std::unique_ptr<OutputBuffer> istream,
                      Errors* errors,
-                     const Features& features);
+                     const Features& features,
+                     bool reference_data_segments);
 
   wabt::Result ReadBinary(DefinedModule* out_module);
 
@@ -236,6 +246,13 @@ class BinaryReaderInterp : public BinaryReaderNop {
   void PushLabel(IstreamOffset offset, IstreamOffset fixup_offset);
   void PopLabel();
 
+  /* see max_operand_depth_ below. */
+  void SampleOperandDepth() {
+    if (typechecker_.type_stack_size() > max_operand_depth_) {
+      max_operand_depth_ = typechecker_.type_stack_size();
+    }
+  }
+
   void PrintError(const char* format, ...);
 
   Index TranslateSigIndexToEnv(Index sig_index);
@@ -263,11 +280,15 @@ class BinaryReaderInterp : public BinaryReaderNop {
                           IstreamOffset size);
   wabt::Result EmitData(const void* data, IstreamOffset size);
   wabt::Result EmitOpcode(Opcode opcode);
+  wabt::Result EmitSubOpcode(Opcode opcode);
   wabt::Result EmitI8(uint8_t value);
   wabt::Result EmitI32(uint32_t value);
   wabt::Result EmitI64(uint64_t value);
   wabt::Result EmitV128(v128 value);
   wabt::Result EmitI32At(IstreamOffset offset, uint32_t value);
+  void DeferI32At(IstreamOffset offset, uint32_t value);
+  void ApplyDeferredPatches();
+  wabt::Result EmitCallIndirectCache();
   wabt::Result EmitDropKeep(uint32_t drop, uint32_t keep);
   wabt::Result AppendFixup(IstreamOffsetVectorVector* fixups_vector,
                            Index index);
@@ -317,6 +338,8 @@ class BinaryReaderInterp : public BinaryReaderNop {
                                Export** out_export);
 
   Features features_;
+  // See ReadBinaryOptions::reference_data_segments.
+  bool reference_data_segments_ = false;
   Errors* errors_ = nullptr;
   Environment* env_ = nullptr;
   DefinedModule* module_ = nullptr;
@@ -325,8 +348,37 @@ class BinaryReaderInterp : public BinaryReaderNop {
   std::vector<Label> label_stack_;
   IstreamOffsetVectorVector func_fixups_;
   IstreamOffsetVectorVector depth_fixups_;
+  /* resolved fixups, batched here instead of being patched into the istream
+   * one WriteDataAt at a time; ApplyDeferredPatches sorts them by offset and
+   * applies them in a single sequential pass when the istream is released. */
+  struct IstreamPatch {
+    IstreamOffset offset;
+    uint32_t value;
+  };
+  std::vector<IstreamPatch> deferred_patches_;
+  /* peak operand-stack depth of the function being lowered, sampled from the
+   * typechecker before each instruction and patched into the function's
+   * entry InterpStackCheck in EndFunctionBody. */
+  size_t max_operand_depth_ = 0;
+  IstreamOffset stack_check_fixup_ = kInvalidIstreamOffset;
   MemoryStream istream_;
   IstreamOffset istream_offset_ = 0;
+  /* peephole state for fusing local.get/local.get/binop sequences into
+   * InterpLocalBinop; see OnLocalGetExpr and OnBinaryExpr. */
+  IstreamOffset peephole_local_get_offset_[2] = {0, 0};
+  Index peephole_local_get_index_[2] = {0, 0};
+  int peephole_local_get_count_ = 0;
+  /* peephole state for fusing local.get/const/binop into
+   * InterpLocalConstBinop, and for fusing a following local.set into the
+   * *Set form of either fused binop; see OnI32ConstExpr, OnBinaryExpr and
+   * OnLocalSetExpr. */
+  IstreamOffset peephole_const_offset_ = 0; /* offset of the local.get */
+  Index peephole_const_local_index_ = 0;
+  uint64_t peephole_const_value_ = 0;
+  bool peephole_local_const_pending_ = false;
+  IstreamOffset peephole_binop_offset_ = 0; /* offset of the fused binop */
+  Opcode::Enum peephole_binop_set_opcode_ = Opcode::Invalid;
+  bool peephole_binop_pending_ = false;
   /* mappings from module index space to env index space; this won't just be a
    * translation, because imported values will be resolved as well */
   IndexVector sig_index_mapping_;
@@ -340,6 +392,12 @@ class BinaryReaderInterp : public BinaryReaderNop {
   Index num_global_imports_ = 0;
 
   // Values cached so they can be shared between callbacks.
+  //
+  // Init expressions (i32.const/global.get chains and the like) are folded
+  // here at read time: globals store their folded value directly and active
+  // segments record a precomputed destination, so instantiation does plain
+  // copies without running the interpreter (see
+  // Executor::InitializeSegments).
   TypedValue init_expr_value_;
   IstreamOffset table_offset_ = 0;
   uint8_t segment_flags_ = 0;
@@ -353,8 +411,10 @@ BinaryReaderInterp::BinaryReaderInterp(Environment* env,
                                        DefinedModule* module,
                                        std::unique_ptr<OutputBuffer> istream,
                                        Errors* errors,
-                                       const Features& features)
+                                       const Features& features,
+                                       bool reference_data_segments)
     : features_(features),
+      reference_data_segments_(reference_data_segments),
       errors_(errors),
       env_(env),
       module_(module),
@@ -365,6 +425,7 @@ BinaryReaderInterp::BinaryReaderInterp(Environment* env,
 }
 
 std::unique_ptr<OutputBuffer> BinaryReaderInterp::ReleaseOutputBuffer() {
+  ApplyDeferredPatches();
   return istream_.ReleaseOutputBuffer();
 }
 
@@ -472,6 +533,24 @@ wabt::Result BinaryReaderInterp::EmitData(const void* data,
 }
 
 wabt::Result BinaryReaderInterp::EmitOpcode(Opcode opcode) {
+  /* any emitted instruction ends a pending peephole sequence; the peephole
+   * handlers re-record their state after emitting. */
+  peephole_local_get_count_ = 0;
+  peephole_local_const_pending_ = false;
+  peephole_binop_pending_ = false;
+  /* a peephole fusion may have rewound the istream over already-recorded
+   * instructions; their boundaries go with them. */
+  std::vector<IstreamOffset>& offsets = module_->instr_offsets;
+  while (!offsets.empty() && offsets.back() >= istream_offset_) {
+    offsets.pop_back();
+  }
+  offsets.push_back(istream_offset_);
+  return EmitI32(static_cast<uint32_t>(opcode));
+}
+
+wabt::Result BinaryReaderInterp::EmitSubOpcode(Opcode opcode) {
+  /* the sub-opcode immediate of a fused instruction: not an instruction
+   * start, so no boundary is recorded. */
   return EmitI32(static_cast<uint32_t>(opcode));
 }
 
@@ -496,6 +575,41 @@ wabt::Result BinaryReaderInterp::EmitI32At(IstreamOffset offset,
   return EmitDataAt(offset, &value, sizeof(value));
 }
 
+/* Records a resolved fixup instead of patching it immediately. Only valid
+ * for slots the reader never rewinds over or re-reads (branch targets and
+ * function offsets); immediate rewrites like the peephole fuser must keep
+ * using EmitI32At. */
+void BinaryReaderInterp::DeferI32At(IstreamOffset offset, uint32_t value) {
+  deferred_patches_.push_back(IstreamPatch{offset, value});
+}
+
+void BinaryReaderInterp::ApplyDeferredPatches() {
+  if (deferred_patches_.empty()) {
+    return;
+  }
+  std::sort(deferred_patches_.begin(), deferred_patches_.end(),
+            [](const IstreamPatch& lhs, const IstreamPatch& rhs) {
+              return lhs.offset < rhs.offset;
+            });
+  OutputBuffer& buf = istream_.output_buffer();
+  for (const IstreamPatch& patch : deferred_patches_) {
+    assert(patch.offset + sizeof(patch.value) <= buf.size());
+    memcpy(buf.data.data() + patch.offset, &patch.value, sizeof(patch.value));
+  }
+  deferred_patches_.clear();
+}
+
+// Emits an empty inline cache for a call_indirect site: the env func index
+// this site last called (kInvalidIndex when empty) and that function's
+// istream offset. Patched by Thread::Run, cleared by
+// Environment::ResetToMarkPoint.
+wabt::Result BinaryReaderInterp::EmitCallIndirectCache() {
+  env_->AppendCallIndirectCacheSite(GetIstreamOffset());
+  CHECK_RESULT(EmitI32(kInvalidIndex));
+  CHECK_RESULT(EmitI32(0));
+  return wabt::Result::Ok;
+}
+
 wabt::Result BinaryReaderInterp::EmitDropKeep(uint32_t drop, uint32_t keep) {
   assert(drop != UINT32_MAX);
   assert(keep != UINT32_MAX);
@@ -581,8 +695,15 @@ wabt::Result BinaryReaderInterp::GetReturnCallDropKeepCount(
 wabt::Result BinaryReaderInterp::EmitBr(Index depth,
                                         Index drop_count,
                                         Index keep_count) {
-  CHECK_RESULT(EmitDropKeep(drop_count, keep_count));
-  CHECK_RESULT(EmitOpcode(Opcode::Br));
+  if (drop_count > 0) {
+    /* fuse the drop/keep into the branch so taken branches cost one dispatch
+     * and one bulk slot move instead of a separate InterpDropKeep. */
+    CHECK_RESULT(EmitOpcode(Opcode::InterpBrDropKeep));
+    CHECK_RESULT(EmitI32(drop_count));
+    CHECK_RESULT(EmitI32(keep_count));
+  } else {
+    CHECK_RESULT(EmitOpcode(Opcode::Br));
+  }
   CHECK_RESULT(EmitBrOffset(depth, GetLabel(depth)->offset));
   return wabt::Result::Ok;
 }
@@ -597,6 +718,10 @@ wabt::Result BinaryReaderInterp::EmitBrTableOffset(Index depth) {
 }
 
 wabt::Result BinaryReaderInterp::FixupTopLabel() {
+  /* as in PushLabel, the current offset becomes a branch target. */
+  peephole_local_get_count_ = 0;
+  peephole_local_const_pending_ = false;
+  peephole_binop_pending_ = false;
   IstreamOffset offset = GetIstreamOffset();
   Index top = label_stack_.size() - 1;
   if (top >= depth_fixups_.size()) {
@@ -606,7 +731,7 @@ wabt::Result BinaryReaderInterp::FixupTopLabel() {
 
   IstreamOffsetVector& fixups = depth_fixups_[top];
   for (IstreamOffset fixup : fixups)
-    CHECK_RESULT(EmitI32At(fixup, offset));
+    DeferI32At(fixup, offset);
   fixups.clear();
   return wabt::Result::Ok;
 }
@@ -912,7 +1037,8 @@ wabt::Result BinaryReaderInterp::OnMemory(Index index,
     return wabt::Result::Error;
   }
 
-  env_->EmplaceBackMemory(*page_limits);
+  env_->EmplaceBackMemory(*page_limits, env_->use_guard_pages(),
+                          env_->memory_policy());
   module_->memory_index = env_->GetMemoryCount() - 1;
   return wabt::Result::Ok;
 }
@@ -1091,6 +1217,10 @@ wabt::Result BinaryReaderInterp::OnElemSegmentElemExprCount(Index index,
   elem_segment_ = env_->EmplaceBackElemSegment();
   if (segment_flags_ & SegPassive) {
     elem_segment_info_ = nullptr;
+    // Reserve up front so large function tables (segments with 100k+
+    // entries are common in linked modules) don't pay for repeated
+    // reallocation while the elements are appended one at a time below.
+    elem_segment_->elems.reserve(count);
   } else {
     // An active segment still is present in the segment index space, but
     // cannot be used with `table.init` (it's as if it has already been
@@ -1101,6 +1231,7 @@ wabt::Result BinaryReaderInterp::OnElemSegmentElemExprCount(Index index,
     Table* table = GetTableByModuleIndex(segment_table_index_);
     module_->active_elem_segments_.emplace_back(table, table_offset_);
     elem_segment_info_ = &module_->active_elem_segments_.back();
+    elem_segment_info_->src.reserve(count);
   }
   return wabt::Result::Ok;
 }
@@ -1155,10 +1286,16 @@ wabt::Result BinaryReaderInterp::OnDataSegmentData(Index index,
                                                    const void* src_data,
                                                    Address size) {
   DataSegment* segment = env_->EmplaceBackDataSegment();
+  // Segment bytes delivered out of a transient buffer (a decompressed data
+  // section) don't outlive the read, so they must be copied even when the
+  // caller asked for borrowed segments.
+  bool borrow_data = reference_data_segments_ && !state->data_is_transient;
   if (segment_flags_ & SegPassive) {
-    segment->data.resize(size);
-    if (size > 0) {
-      memcpy(segment->data.data(), src_data, size);
+    if (borrow_data) {
+      segment->data.borrow(static_cast<const char*>(src_data), size);
+    } else if (size > 0) {
+      segment->data.assign(static_cast<const char*>(src_data),
+                           static_cast<const char*>(src_data) + size);
     }
   } else {
     if (init_expr_value_.type != Type::I32) {
@@ -1179,9 +1316,11 @@ wabt::Result BinaryReaderInterp::OnDataSegmentData(Index index,
     Address address = init_expr_value_.value.i32;
     module_->active_data_segments_.emplace_back(memory, address);
     auto& segment = module_->active_data_segments_.back();
-    if (size > 0) {
-      segment.data.resize(size);
-      memcpy(segment.data.data(), src_data, size);
+    if (borrow_data) {
+      segment.data.borrow(static_cast<const char*>(src_data), size);
+    } else if (size > 0) {
+      segment.data.assign(static_cast<const char*>(src_data),
+                          static_cast<const char*>(src_data) + size);
     }
   }
   return wabt::Result::Ok;
@@ -1189,6 +1328,11 @@ wabt::Result BinaryReaderInterp::OnDataSegmentData(Index index,
 
 void BinaryReaderInterp::PushLabel(IstreamOffset offset,
                                    IstreamOffset fixup_offset) {
+  /* a branch may target the current offset, so it must not be rewritten by
+   * the peephole. */
+  peephole_local_get_count_ = 0;
+  peephole_local_const_pending_ = false;
+  peephole_binop_pending_ = false;
   label_stack_.emplace_back(offset, fixup_offset);
 }
 
@@ -1210,6 +1354,15 @@ wabt::Result BinaryReaderInterp::BeginFunctionBody(Index index, Offset size) {
   func->local_decl_count = 0;
   func->local_count = 0;
 
+  // Reserve the entry stack check; the depth immediate is patched in
+  // EndFunctionBody once the function's peak stack depth is known. Checking
+  // the peak once here is what lets Thread::Push skip the per-push overflow
+  // check.
+  CHECK_RESULT(EmitOpcode(Opcode::InterpStackCheck));
+  stack_check_fixup_ = GetIstreamOffset();
+  CHECK_RESULT(EmitI32(0));
+  max_operand_depth_ = 0;
+
   current_func_ = func;
   depth_fixups_.clear();
   label_stack_.clear();
@@ -1218,7 +1371,7 @@ wabt::Result BinaryReaderInterp::BeginFunctionBody(Index index, Offset size) {
   Index defined_index = TranslateModuleFuncIndexToDefined(index);
   IstreamOffsetVector& fixups = func_fixups_[defined_index];
   for (IstreamOffset fixup : fixups)
-    CHECK_RESULT(EmitI32At(fixup, func->offset));
+    DeferI32At(fixup, func->offset);
 
   /* append param types */
   for (Type param_type : sig->param_types)
@@ -1232,12 +1385,19 @@ wabt::Result BinaryReaderInterp::BeginFunctionBody(Index index, Offset size) {
 }
 
 wabt::Result BinaryReaderInterp::EndFunctionBody(Index index) {
+  SampleOperandDepth();
   FixupTopLabel();
   Index drop_count, keep_count;
   CHECK_RESULT(GetReturnDropKeepCount(&drop_count, &keep_count));
   CHECK_RESULT(typechecker_.EndFunction());
   CHECK_RESULT(EmitDropKeep(drop_count, keep_count));
   CHECK_RESULT(EmitOpcode(Opcode::Return));
+  current_func_->istream_end = GetIstreamOffset();
+  // Patch the entry stack check with the frame's peak growth: the locals
+  // InterpAlloca commits plus the deepest operand stack the body reaches.
+  CHECK_RESULT(EmitI32At(
+      stack_check_fixup_,
+      static_cast<uint32_t>(current_func_->local_count + max_operand_depth_)));
   PopLabel();
   current_func_ = nullptr;
   return wabt::Result::Ok;
@@ -1305,6 +1465,7 @@ wabt::Result BinaryReaderInterp::OnOpcode(Opcode opcode) {
     PrintError("Unexpected instruction after end of function");
     return wabt::Result::Error;
   }
+  SampleOperandDepth();
   return wabt::Result::Ok;
 }
 
@@ -1398,6 +1559,44 @@ wabt::Result BinaryReaderInterp::OnAtomicRmwCmpxchgExpr(Opcode opcode,
 
 wabt::Result BinaryReaderInterp::OnBinaryExpr(wabt::Opcode opcode) {
   CHECK_RESULT(typechecker_.OnBinary(opcode));
+  if (peephole_local_get_count_ == 2 && IsFusableLocalBinop(opcode)) {
+    /* rewrite local.get x; local.get y; binop as a single InterpLocalBinop
+     * that reads both operands directly from their stack slots. The second
+     * slot index was computed with the first operand already pushed, so it
+     * shifts down by one. Both instructions are 2 words, as is the fused
+     * form with its sub-opcode, so the istream just shrinks by the binop. */
+    IstreamOffset fused_offset = peephole_local_get_offset_[0];
+    Index lhs_index = peephole_local_get_index_[0];
+    Index rhs_index = peephole_local_get_index_[1] - 1;
+    istream_offset_ = fused_offset;
+    CHECK_RESULT(EmitOpcode(Opcode::InterpLocalBinop));
+    CHECK_RESULT(EmitSubOpcode(opcode));
+    CHECK_RESULT(EmitI32(lhs_index));
+    CHECK_RESULT(EmitI32(rhs_index));
+    /* a following local.set may fuse further (see OnLocalSetExpr). */
+    peephole_binop_offset_ = fused_offset;
+    peephole_binop_set_opcode_ = Opcode::InterpLocalBinopSet;
+    peephole_binop_pending_ = true;
+    return wabt::Result::Ok;
+  }
+  if (peephole_local_const_pending_ && IsFusableLocalBinop(opcode)) {
+    /* rewrite local.get x; const k; binop as a single InterpLocalConstBinop.
+     * The constant is stored zero-extended to 64 bits, so the fused form is
+     * never longer than the three instructions it replaces. */
+    IstreamOffset fused_offset = peephole_const_offset_;
+    Index lhs_index = peephole_const_local_index_;
+    uint64_t value = peephole_const_value_;
+    istream_offset_ = fused_offset;
+    CHECK_RESULT(EmitOpcode(Opcode::InterpLocalConstBinop));
+    CHECK_RESULT(EmitSubOpcode(opcode));
+    CHECK_RESULT(EmitI32(lhs_index));
+    CHECK_RESULT(EmitI64(value));
+    /* a following local.set may fuse further (see OnLocalSetExpr). */
+    peephole_binop_offset_ = fused_offset;
+    peephole_binop_set_opcode_ = Opcode::InterpLocalConstBinopSet;
+    peephole_binop_pending_ = true;
+    return wabt::Result::Ok;
+  }
   CHECK_RESULT(EmitOpcode(opcode));
   return wabt::Result::Ok;
 }
@@ -1478,20 +1677,44 @@ wabt::Result BinaryReaderInterp::OnBrTableExpr(Index num_targets,
                                                Index* target_depths,
                                                Index default_target_depth) {
   CHECK_RESULT(typechecker_.BeginBrTable());
-  CHECK_RESULT(EmitOpcode(Opcode::BrTable));
+
+  /* When no target adjusts the value stack -- the classic switch shape, and
+   * the common one for big tables -- the per-target drop and keep counts are
+   * all zero, so entries can be bare 4-byte offsets instead of 12-byte
+   * (offset, drop, keep) tuples. A 4000-entry table then reads a third of
+   * the memory per branch. Targets with invalid depths fall through to the
+   * full form so the loop below reports them. */
+  bool compact = true;
+  for (Index i = 0; compact && i <= num_targets; ++i) {
+    Index depth = i != num_targets ? target_depths[i] : default_target_depth;
+    Index drop_count, keep_count;
+    if (depth >= label_stack_.size() ||
+        Failed(GetBrDropKeepCount(depth, &drop_count, &keep_count)) ||
+        drop_count != 0 || keep_count != 0) {
+      compact = false;
+    }
+  }
+
+  CHECK_RESULT(EmitOpcode(compact ? Opcode::InterpBrTableCompact
+                                  : Opcode::BrTable));
   CHECK_RESULT(EmitI32(num_targets));
   IstreamOffset fixup_table_offset = GetIstreamOffset();
   CHECK_RESULT(EmitI32(kInvalidIstreamOffset));
   /* not necessary for the interp, but it makes it easier to disassemble.
    * This opcode specifies how many bytes of data follow. */
   CHECK_RESULT(EmitOpcode(Opcode::InterpData));
-  CHECK_RESULT(EmitI32((num_targets + 1) * WABT_TABLE_ENTRY_SIZE));
+  CHECK_RESULT(EmitI32((num_targets + 1) *
+                       (compact ? sizeof(uint32_t) : WABT_TABLE_ENTRY_SIZE)));
   CHECK_RESULT(EmitI32At(fixup_table_offset, GetIstreamOffset()));
 
   for (Index i = 0; i <= num_targets; ++i) {
     Index depth = i != num_targets ? target_depths[i] : default_target_depth;
     CHECK_RESULT(typechecker_.OnBrTableTarget(depth));
-    CHECK_RESULT(EmitBrTableOffset(depth));
+    if (compact) {
+      CHECK_RESULT(EmitBrOffset(depth, GetLabel(depth)->offset));
+    } else {
+      CHECK_RESULT(EmitBrTableOffset(depth));
+    }
   }
 
   CHECK_RESULT(typechecker_.EndBrTable());
@@ -1509,6 +1732,8 @@ wabt::Result BinaryReaderInterp::OnCallExpr(Index func_index) {
   } else {
     CHECK_RESULT(EmitOpcode(Opcode::Call));
     CHECK_RESULT(EmitFuncOffset(cast<DefinedFunc>(func), func_index));
+    /* the env func index lets the call handler find the callee's JIT state */
+    CHECK_RESULT(EmitI32(TranslateFuncIndexToEnv(func_index)));
   }
 
   return wabt::Result::Ok;
@@ -1527,6 +1752,7 @@ wabt::Result BinaryReaderInterp::OnCallIndirectExpr(Index sig_index,
   CHECK_RESULT(EmitOpcode(Opcode::CallIndirect));
   CHECK_RESULT(EmitI32(TranslateTableIndexToEnv(table_index)));
   CHECK_RESULT(EmitI32(TranslateSigIndexToEnv(sig_index)));
+  CHECK_RESULT(EmitCallIndirectCache());
   return wabt::Result::Ok;
 }
 
@@ -1548,6 +1774,7 @@ wabt::Result BinaryReaderInterp::OnReturnCallExpr(Index func_index) {
   } else {
     CHECK_RESULT(EmitOpcode(Opcode::ReturnCall));
     CHECK_RESULT(EmitFuncOffset(cast<DefinedFunc>(func), func_index));
+    CHECK_RESULT(EmitI32(TranslateFuncIndexToEnv(func_index)));
   }
 
   return wabt::Result::Ok;
@@ -1573,6 +1800,7 @@ wabt::Result BinaryReaderInterp::OnReturnCallIndirectExpr(Index sig_index,
   CHECK_RESULT(EmitOpcode(Opcode::ReturnCallIndirect));
   CHECK_RESULT(EmitI32(TranslateTableIndexToEnv(table_index)));
   CHECK_RESULT(EmitI32(TranslateSigIndexToEnv(sig_index)));
+  CHECK_RESULT(EmitCallIndirectCache());
   return wabt::Result::Ok;
 }
 
@@ -1592,15 +1820,44 @@ wabt::Result BinaryReaderInterp::OnDropExpr() {
 
 wabt::Result BinaryReaderInterp::OnI32ConstExpr(uint32_t value) {
   CHECK_RESULT(typechecker_.OnConst(Type::I32));
+  int peephole_count = peephole_local_get_count_;
+  IstreamOffset local_get_offset = peephole_local_get_offset_[1];
+  Index local_get_index = peephole_local_get_index_[1];
+  if (peephole_count == 1) {
+    local_get_offset = peephole_local_get_offset_[0];
+    local_get_index = peephole_local_get_index_[0];
+  }
   CHECK_RESULT(EmitOpcode(Opcode::I32Const));
   CHECK_RESULT(EmitI32(value));
+  /* remember a local.get;const pair so a following binop can be fused into an
+   * InterpLocalConstBinop (see OnBinaryExpr). */
+  if (peephole_count > 0) {
+    peephole_const_offset_ = local_get_offset;
+    peephole_const_local_index_ = local_get_index;
+    peephole_const_value_ = value;
+    peephole_local_const_pending_ = true;
+  }
   return wabt::Result::Ok;
 }
 
 wabt::Result BinaryReaderInterp::OnI64ConstExpr(uint64_t value) {
   CHECK_RESULT(typechecker_.OnConst(Type::I64));
+  int peephole_count = peephole_local_get_count_;
+  IstreamOffset local_get_offset = peephole_local_get_offset_[1];
+  Index local_get_index = peephole_local_get_index_[1];
+  if (peephole_count == 1) {
+    local_get_offset = peephole_local_get_offset_[0];
+    local_get_index = peephole_local_get_index_[0];
+  }
   CHECK_RESULT(EmitOpcode(Opcode::I64Const));
   CHECK_RESULT(EmitI64(value));
+  /* as in OnI32ConstExpr. */
+  if (peephole_count > 0) {
+    peephole_const_offset_ = local_get_offset;
+    peephole_const_local_index_ = local_get_index;
+    peephole_const_value_ = value;
+    peephole_local_const_pending_ = true;
+  }
   return wabt::Result::Ok;
 }
 
@@ -1661,15 +1918,41 @@ wabt::Result BinaryReaderInterp::OnLocalGetExpr(Index local_index) {
   // old stack size.
   Index translated_local_index = TranslateLocalIndex(local_index);
   CHECK_RESULT(typechecker_.OnLocalGet(type));
+  int peephole_count = peephole_local_get_count_;
+  IstreamOffset opcode_offset = GetIstreamOffset();
   CHECK_RESULT(EmitOpcode(Opcode::LocalGet));
   CHECK_RESULT(EmitI32(translated_local_index));
+  /* remember the last two consecutive local.gets so a following binop can be
+   * fused into an InterpLocalBinop (see OnBinaryExpr). */
+  if (peephole_count == 2) {
+    peephole_local_get_offset_[0] = peephole_local_get_offset_[1];
+    peephole_local_get_index_[0] = peephole_local_get_index_[1];
+    peephole_count = 1;
+  }
+  peephole_local_get_offset_[peephole_count] = opcode_offset;
+  peephole_local_get_index_[peephole_count] = translated_local_index;
+  peephole_local_get_count_ = peephole_count + 1;
   return wabt::Result::Ok;
 }
 
 wabt::Result BinaryReaderInterp::OnLocalSetExpr(Index local_index) {
   CHECK_RESULT(CheckLocal(local_index));
   Type type = GetLocalTypeByIndex(current_func_, local_index);
+  bool fuse_binop = peephole_binop_pending_;
+  IstreamOffset binop_offset = peephole_binop_offset_;
+  Opcode::Enum set_opcode = peephole_binop_set_opcode_;
   CHECK_RESULT(typechecker_.OnLocalSet(type));
+  if (fuse_binop) {
+    /* turn the preceding fused binop into its *Set form, which writes the
+     * result directly to the local instead of pushing it: the opcode word is
+     * rewritten in place and the destination slot index is appended. */
+    CHECK_RESULT(EmitI32At(binop_offset, static_cast<uint32_t>(set_opcode)));
+    CHECK_RESULT(EmitI32(TranslateLocalIndex(local_index)));
+    peephole_local_get_count_ = 0;
+    peephole_local_const_pending_ = false;
+    peephole_binop_pending_ = false;
+    return wabt::Result::Ok;
+  }
   CHECK_RESULT(EmitOpcode(Opcode::LocalSet));
   CHECK_RESULT(EmitI32(TranslateLocalIndex(local_index)));
   return wabt::Result::Ok;
@@ -1887,7 +2170,8 @@ wabt::Result ReadBinaryInterp(Environment* env,
   DefinedModule* module = new DefinedModule(env);
 
   BinaryReaderInterp reader(env, module, std::move(istream), errors,
-                            options.features);
+                            options.features,
+                            options.reference_data_segments);
   env->EmplaceBackModule(module);
 
   wabt::Result result = ReadBinary(data, size, &reader, options);
@@ -1904,4 +2188,147 @@ wabt::Result ReadBinaryInterp(Environment* env,
   return result;
 }
 
+namespace {
+
+// Collects the module names a binary imports from while ReadBinary
+// structurally checks it; see ReadBinaryInterpGraph's scan phase.
+class DependencyScanner : public BinaryReaderNop {
+ public:
+  bool OnError(const Error& error) override {
+    errors.push_back(error);
+    return true;
+  }
+
+  wabt::Result OnImport(Index index,
+                        ExternalKind kind,
+                        string_view module_name,
+                        string_view field_name) override {
+    dependencies.insert(module_name.to_string());
+    return wabt::Result::Ok;
+  }
+
+  std::set<std::string> dependencies;
+  Errors errors;
+};
+
+}  // end anonymous namespace
+
+wabt::Result ReadBinaryInterpGraph(Environment* env,
+                                   const std::vector<InterpModuleBinary>& modules,
+                                   const ReadBinaryOptions& options,
+                                   Errors* errors,
+                                   std::vector<DefinedModule*>* out_modules) {
+  size_t count = modules.size();
+
+  std::map<string_view, size_t> entry_indexes;
+  for (size_t i = 0; i < count; ++i) {
+    if (!entry_indexes.emplace(string_view(modules[i].name), i).second) {
+      errors->emplace_back(
+          ErrorLevel::Error, Location(kInvalidOffset),
+          "duplicate module name \"" + modules[i].name + "\"");
+      return wabt::Result::Error;
+    }
+  }
+
+  // Scan phase: decode every binary with function bodies skipped, collecting
+  // the module names it imports and rejecting malformed binaries before
+  // anything is appended to the environment. The scans are independent, so
+  // they run sliced across a worker pool, as in ReadBinaryIr; they are never
+  // logged (the read phase below logs, and scan logs would interleave).
+  ReadBinaryOptions scan_options = options;
+  scan_options.skip_function_bodies = true;
+  scan_options.log_stream = nullptr;
+  std::vector<DependencyScanner> scanners(count);
+  std::vector<wabt::Result> scan_results(count, wabt::Result::Ok);
+
+  size_t num_threads =
+      std::min<size_t>(std::max(options.num_threads, 1), count);
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      scan_results[i] = ReadBinary(modules[i].data, modules[i].size,
+                                   &scanners[i], scan_options);
+    }
+  } else {
+    size_t entries_per_thread = (count + num_threads - 1) / num_threads;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+      size_t begin = t * entries_per_thread;
+      size_t end = std::min(begin + entries_per_thread, count);
+      threads.emplace_back([&, begin, end]() {
+        for (size_t i = begin; i < end; ++i) {
+          scan_results[i] = ReadBinary(modules[i].data, modules[i].size,
+                                       &scanners[i], scan_options);
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  wabt::Result result = wabt::Result::Ok;
+  for (size_t i = 0; i < count; ++i) {
+    errors->insert(errors->end(), scanners[i].errors.begin(),
+                   scanners[i].errors.end());
+    if (Failed(scan_results[i])) {
+      result = wabt::Result::Error;
+    }
+  }
+  if (Failed(result)) {
+    return result;
+  }
+
+  // Topological sort (Kahn), stable in entry order among ready modules.
+  // Only dependencies on other entries become edges; anything else must
+  // resolve through the environment when the importer is read.
+  std::vector<std::vector<size_t>> dependents(count);
+  std::vector<size_t> num_pending(count, 0);
+  for (size_t i = 0; i < count; ++i) {
+    for (const std::string& dep : scanners[i].dependencies) {
+      auto iter = entry_indexes.find(string_view(dep));
+      if (iter != entry_indexes.end()) {
+        dependents[iter->second].push_back(i);
+        num_pending[i]++;
+      }
+    }
+  }
+  std::vector<size_t> order;
+  order.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (num_pending[i] == 0) {
+      order.push_back(i);
+    }
+  }
+  for (size_t head = 0; head < order.size(); ++head) {
+    for (size_t dependent : dependents[order[head]]) {
+      if (--num_pending[dependent] == 0) {
+        order.push_back(dependent);
+      }
+    }
+  }
+  if (order.size() != count) {
+    std::string message = "import cycle among modules:";
+    for (size_t i = 0; i < count; ++i) {
+      if (num_pending[i] != 0) {
+        message += " \"" + modules[i].name + "\"";
+      }
+    }
+    errors->emplace_back(ErrorLevel::Error, Location(kInvalidOffset), message);
+    return wabt::Result::Error;
+  }
+
+  // Read phase, in dependency order. Each module is registered as soon as
+  // it has been read, so its dependents' imports resolve.
+  out_modules->assign(count, nullptr);
+  for (size_t i : order) {
+    DefinedModule* module = nullptr;
+    CHECK_RESULT(ReadBinaryInterp(env, modules[i].data, modules[i].size,
+                                  options, errors, &module));
+    (*out_modules)[i] = module;
+    env->EmplaceRegisteredModuleBinding(modules[i].name,
+                                        Binding(env->GetLastModuleIndex()));
+  }
+  return wabt::Result::Ok;
+}
+
 }  // namespace wabt
@@ -17,6 +17,9 @@
 #ifndef WABT_BINARY_READER_INTERP_H_
 #define WABT_BINARY_READER_INTERP_H_
 
+#include <string>
+#include <vector>
+
 #include "src/common.h"
 #include "src/error.h"
 
@@ -38,6 +41,38 @@ Result ReadBinaryInterp(interp::Environment* env,
                         Errors*,
                         interp::DefinedModule** out_module);
 
+// One module of a linked set for ReadBinaryInterpGraph. |name| is the name
+// the other entries import it by; the module is registered under it once it
+// has been read. The bytes must stay alive for the whole call.
+struct InterpModuleBinary {
+  std::string name;
+  const void* data;
+  size_t size;
+};
+
+// Reads a set of modules that import from each other, in dependency order
+// rather than list order, so the caller doesn't have to sequence them by
+// hand. The import graph is discovered up front: every binary is scanned
+// for the module names it imports (the scans are independent, so they run
+// on options.num_threads workers with function bodies skipped), the
+// entries are topologically sorted, and each module is then read with
+// ReadBinaryInterp and registered under its entry name so its dependents
+// resolve it. Imported names not among the entries must already be
+// registered in |env| (or be satisfied by Environment::on_unknown_module).
+//
+// Fails without touching |env| on a malformed binary, a duplicate entry
+// name, or an import cycle; a failure while lowering leaves the modules
+// already lowered in place, exactly as equivalent serial ReadBinaryInterp
+// calls would. |out_modules| is filled in entry order. Lowering itself
+// stays on the calling thread: all modules share one istream addressed by
+// absolute offsets, so lowered code can't be produced on a worker and
+// relocated afterwards.
+Result ReadBinaryInterpGraph(interp::Environment* env,
+                             const std::vector<InterpModuleBinary>& modules,
+                             const ReadBinaryOptions& options,
+                             Errors* errors,
+                             std::vector<interp::DefinedModule*>* out_modules);
+
 }  // namespace wabt
 
 #endif /* WABT_BINARY_READER_INTERP_H_ */
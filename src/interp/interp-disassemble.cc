@@ -36,6 +36,10 @@ void Environment::Disassemble(Stream* stream,
   const uint8_t* istream = istream_->data.data();
   const uint8_t* pc = &istream[from];
 
+  // True when the last branch-table opcode was the compact form, so the
+  // InterpData that follows it is decoded as bare offsets.
+  bool compact_table = false;
+
   while (static_cast<IstreamOffset>(pc - istream) < to) {
     stream->Writef("%4" PRIzd "| ", pc - istream);
 
@@ -55,11 +59,15 @@ void Environment::Disassemble(Stream* stream,
         stream->Writef("%s @%u, %%[-1]\n", opcode.GetName(), ReadU32(&pc));
         break;
 
-      case Opcode::BrTable: {
+      case Opcode::BrTable:
+      case Opcode::InterpBrTableCompact: {
         const Index num_targets = ReadU32(&pc);
         const IstreamOffset table_offset = ReadU32(&pc);
         stream->Writef("%s %%[-1], $#%" PRIindex ", table:$%u\n",
                        opcode.GetName(), num_targets, table_offset);
+        /* the InterpData that follows holds bare offsets, not (offset, drop,
+         * keep) tuples. */
+        compact_table = opcode == Opcode::InterpBrTableCompact;
         break;
       }
 
@@ -106,15 +114,19 @@ void Environment::Disassemble(Stream* stream,
         break;
 
       case Opcode::Call:
-      case Opcode::ReturnCall:
-        stream->Writef("%s @%u\n", opcode.GetName(), ReadU32(&pc));
+      case Opcode::ReturnCall: {
+        IstreamOffset offset = ReadU32(&pc);
+        stream->Writef("%s @%u, $%u\n", opcode.GetName(), offset,
+                       ReadU32(&pc));
         break;
+      }
 
       case Opcode::CallIndirect:
       case Opcode::ReturnCallIndirect: {
         const Index table_index = ReadU32(&pc);
         stream->Writef("%s $%" PRIindex ":%u, %%[-1]\n", opcode.GetName(),
                        table_index, ReadU32(&pc));
+        pc += 2 * sizeof(uint32_t);  // Skip the inline cache.
         break;
       }
 
@@ -552,12 +564,70 @@ void Environment::Disassemble(Stream* stream,
         break;
       }
 
+      case Opcode::InterpBrDropKeep: {
+        const uint32_t drop = ReadU32(&pc);
+        const uint32_t keep = ReadU32(&pc);
+        stream->Writef("%s $%u $%u @%u\n", opcode.GetName(), drop, keep,
+                       ReadU32(&pc));
+        break;
+      }
+
+      case Opcode::InterpLocalBinop: {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32(&pc)));
+        const uint32_t lhs = ReadU32(&pc);
+        const uint32_t rhs = ReadU32(&pc);
+        stream->Writef("%s %s %%[-%u] %%[-%u]\n", opcode.GetName(),
+                       binop.GetName(), lhs, rhs);
+        break;
+      }
+
+      case Opcode::InterpLocalBinopSet: {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32(&pc)));
+        const uint32_t lhs = ReadU32(&pc);
+        const uint32_t rhs = ReadU32(&pc);
+        const uint32_t dst = ReadU32(&pc);
+        stream->Writef("%s %s %%[-%u] %%[-%u] -> %%[-%u]\n", opcode.GetName(),
+                       binop.GetName(), lhs, rhs, dst);
+        break;
+      }
+
+      case Opcode::InterpLocalConstBinop: {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32(&pc)));
+        const uint32_t lhs = ReadU32(&pc);
+        const uint64_t imm = ReadU64(&pc);
+        stream->Writef("%s %s %%[-%u] %" PRIu64 "\n", opcode.GetName(),
+                       binop.GetName(), lhs, imm);
+        break;
+      }
+
+      case Opcode::InterpLocalConstBinopSet: {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32(&pc)));
+        const uint32_t lhs = ReadU32(&pc);
+        const uint64_t imm = ReadU64(&pc);
+        const uint32_t dst = ReadU32(&pc);
+        stream->Writef("%s %s %%[-%u] %" PRIu64 " -> %%[-%u]\n",
+                       opcode.GetName(), binop.GetName(), lhs, imm, dst);
+        break;
+      }
+
+      case Opcode::InterpStackCheck:
+        stream->Writef("%s $%u\n", opcode.GetName(), ReadU32(&pc));
+        break;
+
       case Opcode::InterpData: {
         const uint32_t num_bytes = ReadU32(&pc);
         stream->Writef("%s $%u\n", opcode.GetName(), num_bytes);
         /* for now, the only reason this is emitted is for br_table, so display
          * it as a list of table entries */
-        if (num_bytes % WABT_TABLE_ENTRY_SIZE == 0) {
+        if (compact_table && num_bytes % sizeof(uint32_t) == 0) {
+          Index num_entries = num_bytes / sizeof(uint32_t);
+          for (Index i = 0; i < num_entries; ++i) {
+            stream->Writef("%4" PRIzd "| ", pc - istream);
+            stream->Writef("  entry %" PRIindex ": offset: %u\n", i,
+                           ReadU32At(pc));
+            pc += sizeof(uint32_t);
+          }
+        } else if (num_bytes % WABT_TABLE_ENTRY_SIZE == 0) {
           Index num_entries = num_bytes / WABT_TABLE_ENTRY_SIZE;
           for (Index i = 0; i < num_entries; ++i) {
             stream->Writef("%4" PRIzd "| ", pc - istream);
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/interp/interp-image-cache.h"
+
+#include <cstring>
+
+#include "src/binary-reader.h"
+#include "src/interp/binary-reader-interp.h"
+
+namespace wabt {
+namespace interp {
+
+ModuleImageCache::ModuleImageCache(const Features& features)
+    : features_(features) {}
+
+std::unique_ptr<Environment> ModuleImageCache::Instantiate(
+    const void* data,
+    size_t size,
+    const ReadBinaryOptions& options,
+    Errors* errors) {
+  hash_code hash = HashBytes(data, size);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto range = images_.equal_range(hash);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    const Image& image = iter->second;
+    if (image.binary.size() == size &&
+        memcmp(image.binary.data(), data, size) == 0) {
+      return image.env->Fork();
+    }
+  }
+
+  std::unique_ptr<Environment> env(new Environment(features_));
+  if (on_create_environment) {
+    on_create_environment(env.get());
+  }
+  DefinedModule* module = nullptr;
+  if (Failed(
+          ReadBinaryInterp(env.get(), data, size, options, errors, &module))) {
+    return std::unique_ptr<Environment>();
+  }
+
+  Image image;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  image.binary.assign(bytes, bytes + size);
+  image.env = std::move(env);
+  auto iter = images_.emplace(hash, std::move(image));
+  // The master stays pristine — segments and start functions only ever run
+  // on forks — so every instance starts from the same image.
+  return iter->second.env->Fork();
+}
+
+size_t ModuleImageCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return images_.size();
+}
+
+}  // namespace interp
+}  // namespace wabt
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_IMAGE_CACHE_H_
+#define WABT_INTERP_IMAGE_CACHE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/common.h"
+#include "src/error.h"
+#include "src/feature.h"
+#include "src/hash-util.h"
+#include "src/interp/interp.h"
+
+namespace wabt {
+
+struct ReadBinaryOptions;
+
+namespace interp {
+
+// A content-addressed cache of lowered module images, for processes that
+// instantiate many byte-identical modules. Binaries are keyed by a hash of
+// their bytes (with a full byte compare on each hit, so colliding binaries
+// are never shared); the first instantiation lowers a binary into a private
+// master Environment, and every instantiation returns a Fork of that master,
+// so all instances of the same bytes share one istream and one set of
+// lowered functions — and, where the host supports it, their initial memory
+// pages (see Environment::Fork). Second-and-later instantiations of the same
+// bytes skip reading the binary entirely.
+//
+// The cache may be shared by multiple threads; forks are created under a
+// lock and are independent of each other afterwards.
+class ModuleImageCache {
+ public:
+  explicit ModuleImageCache(const Features& features);
+
+  // Runs on each freshly created master environment before its binary is
+  // read, e.g. to append the host modules the binary imports from. Masters
+  // are never initialized or executed, so the callback must not run code.
+  std::function<void(Environment*)> on_create_environment;
+
+  // Returns a private fork of the image for |data|, lowering and caching the
+  // binary first if these bytes haven't been seen. The fork's last module is
+  // the lowered module; it has not been initialized (no segments or start
+  // function have run — pass it to Executor::Initialize). Returns nullptr on
+  // failure, with errors appended to |errors|.
+  std::unique_ptr<Environment> Instantiate(const void* data,
+                                           size_t size,
+                                           const ReadBinaryOptions& options,
+                                           Errors* errors);
+
+  // Number of distinct binaries lowered so far.
+  size_t size() const;
+
+ private:
+  struct Image {
+    std::vector<uint8_t> binary;  // Keeps colliding binaries apart.
+    std::unique_ptr<Environment> env;
+  };
+
+  Features features_;
+  mutable std::mutex mutex_;
+  std::multimap<hash_code, Image> images_;
+};
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif /* WABT_INTERP_IMAGE_CACHE_H_ */
@@ -81,6 +81,60 @@ inline Opcode ReadOpcode(const uint8_t** pc) {
   return Opcode(static_cast<Opcode::Enum>(value));
 }
 
+// Whether |opcode| may be encoded as the sub-opcode of an InterpLocalBinop
+// instruction, which reads both operands directly from value stack slots
+// instead of popping them. Only non-trapping integer binops qualify;
+// Thread::RunLocalBinop must handle every opcode accepted here.
+inline bool IsFusableLocalBinop(Opcode opcode) {
+  switch (opcode) {
+    case Opcode::I32Add:
+    case Opcode::I32Sub:
+    case Opcode::I32Mul:
+    case Opcode::I32And:
+    case Opcode::I32Or:
+    case Opcode::I32Xor:
+    case Opcode::I32Shl:
+    case Opcode::I32ShrU:
+    case Opcode::I32ShrS:
+    case Opcode::I32Rotl:
+    case Opcode::I32Rotr:
+    case Opcode::I32Eq:
+    case Opcode::I32Ne:
+    case Opcode::I32LtS:
+    case Opcode::I32LtU:
+    case Opcode::I32LeS:
+    case Opcode::I32LeU:
+    case Opcode::I32GtS:
+    case Opcode::I32GtU:
+    case Opcode::I32GeS:
+    case Opcode::I32GeU:
+    case Opcode::I64Add:
+    case Opcode::I64Sub:
+    case Opcode::I64Mul:
+    case Opcode::I64And:
+    case Opcode::I64Or:
+    case Opcode::I64Xor:
+    case Opcode::I64Shl:
+    case Opcode::I64ShrU:
+    case Opcode::I64ShrS:
+    case Opcode::I64Rotl:
+    case Opcode::I64Rotr:
+    case Opcode::I64Eq:
+    case Opcode::I64Ne:
+    case Opcode::I64LtS:
+    case Opcode::I64LtU:
+    case Opcode::I64LeS:
+    case Opcode::I64LeU:
+    case Opcode::I64GtS:
+    case Opcode::I64GtU:
+    case Opcode::I64GeS:
+    case Opcode::I64GeU:
+      return true;
+    default:
+      return false;
+  }
+}
+
 inline void ReadTableEntryAt(const uint8_t* pc,
                              IstreamOffset* out_offset,
                              uint32_t* out_drop,
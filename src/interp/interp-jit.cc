@@ -0,0 +1,681 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/interp/interp-jit.h"
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define WABT_JIT_BACKEND 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define WABT_JIT_BACKEND 0
+#endif
+
+namespace wabt {
+namespace interp {
+
+JitFunc::~JitFunc() {
+#if WABT_JIT_BACKEND
+  if (entry_) {
+    munmap(reinterpret_cast<void*>(entry_), code_size_);
+  }
+#endif
+}
+
+#if WABT_JIT_BACKEND
+
+namespace {
+
+// Emits x86-64 machine code following the System V ABI. Register use in the
+// generated code:
+//
+//   rdi  incoming stack top (argument 1); free after the prologue
+//   rsi  value stack end, for the headroom check (argument 2)
+//   rdx  out-pointer for the final stack top (argument 3)
+//   r10  current stack top; a wasm slot |d| deep is at [r10 - 16*d]
+//   rax, rcx, xmm0, xmm1  scratch
+//
+// The wasm operand stack lives in the interpreter's value stack, one
+// 16-byte Value per slot, exactly as Thread::Run lays it out. The generated
+// code never calls anything, so no frame or callee-saved registers are
+// needed.
+class CodeGen {
+ public:
+  size_t pos() const { return out_.size(); }
+  const std::vector<uint8_t>& bytes() const { return out_; }
+
+  void U8(uint8_t b) { out_.push_back(b); }
+  void U32(uint32_t v) { Append(&v, sizeof(v)); }
+  void U64(uint64_t v) { Append(&v, sizeof(v)); }
+
+  void PatchU32(size_t pos, uint32_t v) { memcpy(&out_[pos], &v, sizeof(v)); }
+
+  // [r10 + disp] operand for instruction register field |reg|.
+  void ModR10(uint8_t reg, int32_t disp) {
+    if (disp >= -128 && disp <= 127) {
+      U8(0x40 | ((reg & 7) << 3) | 2);
+      U8(static_cast<uint8_t>(disp));
+    } else {
+      U8(0x80 | ((reg & 7) << 3) | 2);
+      U32(static_cast<uint32_t>(disp));
+    }
+  }
+
+  void Rex(bool w64) { U8(w64 ? 0x49 : 0x41); }  // REX.B for the r10 base.
+
+  void MovEaxLoad(int32_t disp, bool w64) {
+    Rex(w64);
+    U8(0x8b);
+    ModR10(0, disp);
+  }
+  void MovEcxLoad(int32_t disp, bool w64) {
+    Rex(w64);
+    U8(0x8b);
+    ModR10(1, disp);
+  }
+  void MovEaxStore(int32_t disp, bool w64) {
+    Rex(w64);
+    U8(0x89);
+    ModR10(0, disp);
+  }
+  // ALU forms "op eax, [r10+disp]"; |opc| is the r32,r/m32 opcode byte
+  // (add 0x03, sub 0x2b, and 0x23, or 0x0b, xor 0x33, cmp 0x3b).
+  void AluEaxRm(uint8_t opc, int32_t disp, bool w64) {
+    Rex(w64);
+    U8(opc);
+    ModR10(0, disp);
+  }
+  void ImulEaxRm(int32_t disp, bool w64) {
+    Rex(w64);
+    U8(0x0f);
+    U8(0xaf);
+    ModR10(0, disp);
+  }
+  void AluEaxEcx(uint8_t opc, bool w64) {
+    if (w64) {
+      U8(0x48);
+    }
+    U8(opc);
+    U8(0xc1);
+  }
+  void ImulEaxEcx(bool w64) {
+    if (w64) {
+      U8(0x48);
+    }
+    U8(0x0f);
+    U8(0xaf);
+    U8(0xc1);
+  }
+  // Shift/rotate eax by cl; |ext| is the /n extension (rol 0, ror 1, shl 4,
+  // shr 5, sar 7).
+  void ShiftEaxCl(uint8_t ext, bool w64) {
+    if (w64) {
+      U8(0x48);
+    }
+    U8(0xd3);
+    U8(0xc0 | (ext << 3));
+  }
+  void TestEaxEax(bool w64) {
+    if (w64) {
+      U8(0x48);
+    }
+    U8(0x85);
+    U8(0xc0);
+  }
+  // setcc al; movzx eax, al. |cc| is the condition code nibble.
+  void SetccEax(uint8_t cc) {
+    U8(0x0f);
+    U8(0x90 | cc);
+    U8(0xc0);
+    U8(0x0f);
+    U8(0xb6);
+    U8(0xc0);
+  }
+  void MovEcxImm32(uint32_t v) {
+    U8(0xb9);
+    U32(v);
+  }
+  void MovRcxImm64(uint64_t v) {
+    U8(0x48);
+    U8(0xb9);
+    U64(v);
+  }
+  void MovR10MemImm32(int32_t disp, uint32_t v) {
+    U8(0x41);
+    U8(0xc7);
+    ModR10(0, disp);
+    U32(v);
+  }
+  void MovupsLoad(uint8_t xmm, int32_t disp) {
+    U8(0x41);
+    U8(0x0f);
+    U8(0x10);
+    ModR10(xmm, disp);
+  }
+  void MovupsStore(uint8_t xmm, int32_t disp) {
+    U8(0x41);
+    U8(0x0f);
+    U8(0x11);
+    ModR10(xmm, disp);
+  }
+  void AddR10(int32_t imm) {
+    if (imm == 0) {
+      return;
+    }
+    if (imm >= -128 && imm <= 127) {
+      U8(0x49);
+      U8(0x83);
+      U8(0xc2);
+      U8(static_cast<uint8_t>(imm));
+    } else {
+      U8(0x49);
+      U8(0x81);
+      U8(0xc2);
+      U32(static_cast<uint32_t>(imm));
+    }
+  }
+  void SubR10(int32_t imm) { AddR10(-imm); }
+
+  // mov [rdx], r10; the result top is reported on both exit paths.
+  void StoreTopOut() {
+    U8(0x4c);
+    U8(0x89);
+    U8(0x12);
+  }
+
+ private:
+  void Append(const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    out_.insert(out_.end(), p, p + size);
+  }
+
+  std::vector<uint8_t> out_;
+};
+
+// ALU opcode byte, shift extension, or condition code for one wasm operator;
+// kind tells which applies. Mirrors the subset RunLocalBinop executes.
+struct BinopInfo {
+  enum Kind { None, Alu, Mul, Shift, Cmp } kind;
+  uint8_t op;
+  bool w64;
+};
+
+BinopInfo GetBinopInfo(Opcode opcode) {
+  switch (opcode) {
+    case Opcode::I32Add: return {BinopInfo::Alu, 0x03, false};
+    case Opcode::I32Sub: return {BinopInfo::Alu, 0x2b, false};
+    case Opcode::I32And: return {BinopInfo::Alu, 0x23, false};
+    case Opcode::I32Or: return {BinopInfo::Alu, 0x0b, false};
+    case Opcode::I32Xor: return {BinopInfo::Alu, 0x33, false};
+    case Opcode::I32Mul: return {BinopInfo::Mul, 0, false};
+    case Opcode::I32Shl: return {BinopInfo::Shift, 4, false};
+    case Opcode::I32ShrU: return {BinopInfo::Shift, 5, false};
+    case Opcode::I32ShrS: return {BinopInfo::Shift, 7, false};
+    case Opcode::I32Rotl: return {BinopInfo::Shift, 0, false};
+    case Opcode::I32Rotr: return {BinopInfo::Shift, 1, false};
+    case Opcode::I32Eq: return {BinopInfo::Cmp, 0x4, false};
+    case Opcode::I32Ne: return {BinopInfo::Cmp, 0x5, false};
+    case Opcode::I32LtS: return {BinopInfo::Cmp, 0xc, false};
+    case Opcode::I32LtU: return {BinopInfo::Cmp, 0x2, false};
+    case Opcode::I32GtS: return {BinopInfo::Cmp, 0xf, false};
+    case Opcode::I32GtU: return {BinopInfo::Cmp, 0x7, false};
+    case Opcode::I32LeS: return {BinopInfo::Cmp, 0xe, false};
+    case Opcode::I32LeU: return {BinopInfo::Cmp, 0x6, false};
+    case Opcode::I32GeS: return {BinopInfo::Cmp, 0xd, false};
+    case Opcode::I32GeU: return {BinopInfo::Cmp, 0x3, false};
+    case Opcode::I64Add: return {BinopInfo::Alu, 0x03, true};
+    case Opcode::I64Sub: return {BinopInfo::Alu, 0x2b, true};
+    case Opcode::I64And: return {BinopInfo::Alu, 0x23, true};
+    case Opcode::I64Or: return {BinopInfo::Alu, 0x0b, true};
+    case Opcode::I64Xor: return {BinopInfo::Alu, 0x33, true};
+    case Opcode::I64Mul: return {BinopInfo::Mul, 0, true};
+    case Opcode::I64Shl: return {BinopInfo::Shift, 4, true};
+    case Opcode::I64ShrU: return {BinopInfo::Shift, 5, true};
+    case Opcode::I64ShrS: return {BinopInfo::Shift, 7, true};
+    case Opcode::I64Rotl: return {BinopInfo::Shift, 0, true};
+    case Opcode::I64Rotr: return {BinopInfo::Shift, 1, true};
+    case Opcode::I64Eq: return {BinopInfo::Cmp, 0x4, true};
+    case Opcode::I64Ne: return {BinopInfo::Cmp, 0x5, true};
+    case Opcode::I64LtS: return {BinopInfo::Cmp, 0xc, true};
+    case Opcode::I64LtU: return {BinopInfo::Cmp, 0x2, true};
+    case Opcode::I64GtS: return {BinopInfo::Cmp, 0xf, true};
+    case Opcode::I64GtU: return {BinopInfo::Cmp, 0x7, true};
+    case Opcode::I64LeS: return {BinopInfo::Cmp, 0xe, true};
+    case Opcode::I64LeU: return {BinopInfo::Cmp, 0x6, true};
+    case Opcode::I64GeS: return {BinopInfo::Cmp, 0xd, true};
+    case Opcode::I64GeU: return {BinopInfo::Cmp, 0x3, true};
+    default: return {BinopInfo::None, 0, false};
+  }
+}
+
+const int kValueSize = static_cast<int>(sizeof(Value));
+
+uint32_t ReadU32(const uint8_t* istream, IstreamOffset* pc) {
+  uint32_t value;
+  memcpy(&value, istream + *pc, sizeof(value));
+  *pc += sizeof(value);
+  return value;
+}
+
+uint64_t ReadU64(const uint8_t* istream, IstreamOffset* pc) {
+  uint64_t value;
+  memcpy(&value, istream + *pc, sizeof(value));
+  *pc += sizeof(value);
+  return value;
+}
+
+// Copies |keep| slots (0..2) down over |drop| slots and retires the dropped
+// ones, the native equivalent of Thread::DropKeep.
+void EmitDropKeep(CodeGen* gen, uint32_t drop, uint32_t keep) {
+  for (uint32_t i = keep; i > 0; --i) {
+    gen->MovupsLoad(keep - i, -static_cast<int32_t>(i) * kValueSize);
+    gen->MovupsStore(keep - i, -static_cast<int32_t>(drop + i) * kValueSize);
+  }
+  gen->SubR10(drop * kValueSize);
+}
+
+}  // end anonymous namespace
+
+// static
+std::unique_ptr<JitFunc> JitFunc::Compile(Environment* env,
+                                          const DefinedFunc* func) {
+  if (func->offset == kInvalidIstreamOffset ||
+      func->istream_end == kInvalidIstreamOffset ||
+      func->istream_end <= func->offset) {
+    return nullptr;
+  }
+
+  const uint8_t* istream = env->istream().data.data();
+  CodeGen gen;
+  // Native offset of every istream instruction start, for branch targets.
+  std::map<IstreamOffset, size_t> native_offset;
+  // rel32 patches; a target of kInvalidIstreamOffset means the trap stub.
+  struct Fixup {
+    size_t pos;
+    IstreamOffset target;
+  };
+  std::vector<Fixup> fixups;
+
+  // Prologue: mov r10, rdi, then the single headroom check described below.
+  gen.U8(0x49);
+  gen.U8(0x89);
+  gen.U8(0xfa);
+  // lea rax, [r10 + headroom]; cmp rax, rsi; ja trap. The headroom immediate
+  // is patched once the instruction count is known.
+  gen.U8(0x49);
+  gen.U8(0x8d);
+  gen.U8(0x82);
+  size_t headroom_pos = gen.pos();
+  gen.U32(0);
+  gen.U8(0x48);
+  gen.U8(0x39);
+  gen.U8(0xf0);
+  gen.U8(0x0f);
+  gen.U8(0x87);
+  fixups.push_back({gen.pos(), kInvalidIstreamOffset});
+  gen.U32(0);
+
+  uint32_t num_instructions = 0;
+  uint32_t peak_depth = 0;
+  bool has_peak_depth = false;
+  IstreamOffset pc = func->offset;
+  while (pc < func->istream_end) {
+    native_offset[pc] = gen.pos();
+    num_instructions++;
+    Opcode opcode(static_cast<Opcode::Enum>(ReadU32(istream, &pc)));
+    switch (opcode) {
+      case Opcode::Nop:
+        break;
+
+      case Opcode::InterpStackCheck:
+        // The lowered function's exact peak value stack depth; used for the
+        // prologue headroom check, so no code is emitted here.
+        peak_depth = ReadU32(istream, &pc);
+        has_peak_depth = true;
+        break;
+
+      case Opcode::InterpAlloca: {
+        uint32_t count = ReadU32(istream, &pc);
+        if (count > 0) {
+          // mov rdi, r10; xor eax, eax; mov ecx, 2*count; rep stosq;
+          // mov r10, rdi. Headroom was already checked in the prologue.
+          gen.U8(0x4c);
+          gen.U8(0x89);
+          gen.U8(0xd7);
+          gen.U8(0x31);
+          gen.U8(0xc0);
+          gen.MovEcxImm32(count * (kValueSize / 8));
+          gen.U8(0xf3);
+          gen.U8(0x48);
+          gen.U8(0xab);
+          gen.U8(0x49);
+          gen.U8(0x89);
+          gen.U8(0xfa);
+        }
+        break;
+      }
+
+      case Opcode::I32Const:
+        gen.MovR10MemImm32(0, ReadU32(istream, &pc));
+        gen.AddR10(kValueSize);
+        break;
+
+      case Opcode::I64Const: {
+        uint64_t value = ReadU64(istream, &pc);
+        // movabs rax, imm64; mov [r10], rax.
+        gen.U8(0x48);
+        gen.U8(0xb8);
+        gen.U64(value);
+        gen.MovEaxStore(0, true);
+        gen.AddR10(kValueSize);
+        break;
+      }
+
+      case Opcode::LocalGet: {
+        int32_t depth = ReadU32(istream, &pc);
+        gen.MovupsLoad(0, -depth * kValueSize);
+        gen.MovupsStore(0, 0);
+        gen.AddR10(kValueSize);
+        break;
+      }
+
+      case Opcode::LocalSet: {
+        int32_t depth = ReadU32(istream, &pc);
+        gen.SubR10(kValueSize);
+        gen.MovupsLoad(0, 0);
+        gen.MovupsStore(0, -depth * kValueSize);
+        break;
+      }
+
+      case Opcode::LocalTee: {
+        int32_t depth = ReadU32(istream, &pc);
+        gen.MovupsLoad(0, -kValueSize);
+        gen.MovupsStore(0, -depth * kValueSize);
+        break;
+      }
+
+      case Opcode::Drop:
+        gen.SubR10(kValueSize);
+        break;
+
+      case Opcode::InterpDropKeep: {
+        uint32_t drop = ReadU32(istream, &pc);
+        uint32_t keep = ReadU32(istream, &pc);
+        if (keep > 2) {
+          return nullptr;
+        }
+        EmitDropKeep(&gen, drop, keep);
+        break;
+      }
+
+      case Opcode::Select: {
+        // Pop the condition; if it is zero, the false value overwrites the
+        // true value. Either way one operand slot is retired.
+        gen.SubR10(kValueSize);
+        gen.MovEaxLoad(0, false);
+        gen.TestEaxEax(false);
+        gen.U8(0x0f);  // jnz past the copy
+        gen.U8(0x85);
+        size_t patch = gen.pos();
+        gen.U32(0);
+        gen.MovupsLoad(0, -kValueSize);
+        gen.MovupsStore(0, -2 * kValueSize);
+        gen.PatchU32(patch, gen.pos() - (patch + 4));
+        gen.SubR10(kValueSize);
+        break;
+      }
+
+      case Opcode::Br:
+        gen.U8(0xe9);
+        fixups.push_back({gen.pos(), ReadU32(istream, &pc)});
+        gen.U32(0);
+        break;
+
+      case Opcode::InterpBrUnless: {
+        IstreamOffset target = ReadU32(istream, &pc);
+        gen.SubR10(kValueSize);
+        gen.MovEaxLoad(0, false);
+        gen.TestEaxEax(false);
+        gen.U8(0x0f);  // jz target
+        gen.U8(0x84);
+        fixups.push_back({gen.pos(), target});
+        gen.U32(0);
+        break;
+      }
+
+      case Opcode::InterpBrDropKeep: {
+        uint32_t drop = ReadU32(istream, &pc);
+        uint32_t keep = ReadU32(istream, &pc);
+        IstreamOffset target = ReadU32(istream, &pc);
+        if (keep > 2) {
+          return nullptr;
+        }
+        EmitDropKeep(&gen, drop, keep);
+        gen.U8(0xe9);
+        fixups.push_back({gen.pos(), target});
+        gen.U32(0);
+        break;
+      }
+
+      case Opcode::Return:
+        gen.StoreTopOut();
+        gen.U8(0x31);  // xor eax, eax
+        gen.U8(0xc0);
+        gen.U8(0xc3);  // ret
+        break;
+
+      case Opcode::I32Eqz:
+      case Opcode::I64Eqz:
+        gen.MovEaxLoad(-kValueSize, opcode == Opcode::I64Eqz);
+        gen.TestEaxEax(opcode == Opcode::I64Eqz);
+        gen.SetccEax(0x4);
+        gen.MovEaxStore(-kValueSize, false);
+        break;
+
+      case Opcode::InterpLocalBinop:
+      case Opcode::InterpLocalBinopSet: {
+        BinopInfo info =
+            GetBinopInfo(static_cast<Opcode::Enum>(ReadU32(istream, &pc)));
+        int32_t lhs = ReadU32(istream, &pc);
+        int32_t rhs = ReadU32(istream, &pc);
+        if (info.kind == BinopInfo::None) {
+          return nullptr;
+        }
+        if (info.kind == BinopInfo::Shift) {
+          gen.MovEcxLoad(-rhs * kValueSize, info.w64);
+        }
+        gen.MovEaxLoad(-lhs * kValueSize, info.w64);
+        bool result64 = info.w64;
+        switch (info.kind) {
+          case BinopInfo::Alu:
+            gen.AluEaxRm(info.op, -rhs * kValueSize, info.w64);
+            break;
+          case BinopInfo::Mul:
+            gen.ImulEaxRm(-rhs * kValueSize, info.w64);
+            break;
+          case BinopInfo::Shift:
+            gen.ShiftEaxCl(info.op, info.w64);
+            break;
+          case BinopInfo::Cmp:
+            gen.AluEaxRm(0x3b, -rhs * kValueSize, info.w64);
+            gen.SetccEax(info.op);
+            result64 = false;
+            break;
+          case BinopInfo::None:
+            break;
+        }
+        if (opcode == Opcode::InterpLocalBinopSet) {
+          int32_t dst = ReadU32(istream, &pc);
+          gen.MovEaxStore(-dst * kValueSize, result64);
+        } else {
+          gen.MovEaxStore(0, result64);
+          gen.AddR10(kValueSize);
+        }
+        break;
+      }
+
+      case Opcode::InterpLocalConstBinop:
+      case Opcode::InterpLocalConstBinopSet: {
+        BinopInfo info =
+            GetBinopInfo(static_cast<Opcode::Enum>(ReadU32(istream, &pc)));
+        int32_t lhs = ReadU32(istream, &pc);
+        uint64_t imm = ReadU64(istream, &pc);
+        if (info.kind == BinopInfo::None) {
+          return nullptr;
+        }
+        if (info.w64) {
+          gen.MovRcxImm64(imm);
+        } else {
+          gen.MovEcxImm32(static_cast<uint32_t>(imm));
+        }
+        gen.MovEaxLoad(-lhs * kValueSize, info.w64);
+        bool result64 = info.w64;
+        switch (info.kind) {
+          case BinopInfo::Alu:
+            gen.AluEaxEcx(info.op, info.w64);
+            break;
+          case BinopInfo::Mul:
+            gen.ImulEaxEcx(info.w64);
+            break;
+          case BinopInfo::Shift:
+            gen.ShiftEaxCl(info.op, info.w64);
+            break;
+          case BinopInfo::Cmp:
+            gen.AluEaxEcx(0x3b, info.w64);
+            gen.SetccEax(info.op);
+            result64 = false;
+            break;
+          case BinopInfo::None:
+            break;
+        }
+        if (opcode == Opcode::InterpLocalConstBinopSet) {
+          int32_t dst = ReadU32(istream, &pc);
+          gen.MovEaxStore(-dst * kValueSize, result64);
+        } else {
+          gen.MovEaxStore(0, result64);
+          gen.AddR10(kValueSize);
+        }
+        break;
+      }
+
+      default: {
+        // Plain stack binops; anything else is out of the subset.
+        BinopInfo info = GetBinopInfo(opcode);
+        if (info.kind == BinopInfo::None) {
+          return nullptr;
+        }
+        if (info.kind == BinopInfo::Shift) {
+          gen.MovEcxLoad(-kValueSize, info.w64);
+        }
+        gen.MovEaxLoad(-2 * kValueSize, info.w64);
+        bool result64 = info.w64;
+        switch (info.kind) {
+          case BinopInfo::Alu:
+            gen.AluEaxRm(info.op, -kValueSize, info.w64);
+            break;
+          case BinopInfo::Mul:
+            gen.ImulEaxRm(-kValueSize, info.w64);
+            break;
+          case BinopInfo::Shift:
+            gen.ShiftEaxCl(info.op, info.w64);
+            break;
+          case BinopInfo::Cmp:
+            gen.AluEaxRm(0x3b, -kValueSize, info.w64);
+            gen.SetccEax(info.op);
+            result64 = false;
+            break;
+          case BinopInfo::None:
+            break;
+        }
+        gen.MovEaxStore(-2 * kValueSize, result64);
+        gen.SubR10(kValueSize);
+        break;
+      }
+    }
+  }
+  if (pc != func->istream_end) {
+    return nullptr;
+  }
+
+  // Trap stub shared by the headroom check.
+  size_t trap_pos = gen.pos();
+  gen.StoreTopOut();
+  gen.U8(0xb8);  // mov eax, kValueStackExhausted
+  gen.U32(kValueStackExhausted);
+  gen.U8(0xc3);
+
+  // The prologue's single headroom check replaces the interpreter's per-push
+  // check. The lowered code starts with a stack_check carrying the function's
+  // exact peak depth; fall back to the conservative bound — every instruction
+  // pushes at most one slot — if it wasn't seen.
+  gen.PatchU32(headroom_pos,
+               (has_peak_depth ? peak_depth
+                               : func->local_count + num_instructions) *
+                   kValueSize);
+
+  std::vector<uint8_t> code = gen.bytes();
+  for (const Fixup& fixup : fixups) {
+    size_t target;
+    if (fixup.target == kInvalidIstreamOffset) {
+      target = trap_pos;
+    } else {
+      auto iter = native_offset.find(fixup.target);
+      if (iter == native_offset.end()) {
+        return nullptr;
+      }
+      target = iter->second;
+    }
+    uint32_t rel = static_cast<uint32_t>(target - (fixup.pos + 4));
+    memcpy(&code[fixup.pos], &rel, sizeof(rel));
+  }
+
+  size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t alloc_size = (code.size() + page_size - 1) & ~(page_size - 1);
+  void* mem = mmap(nullptr, alloc_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+  memcpy(mem, code.data(), code.size());
+  if (mprotect(mem, alloc_size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(mem, alloc_size);
+    return nullptr;
+  }
+
+  std::unique_ptr<JitFunc> result(new JitFunc());
+  result->entry_ = reinterpret_cast<Entry>(mem);
+  result->code_size_ = alloc_size;
+  return result;
+}
+
+#else  // !WABT_JIT_BACKEND
+
+// static
+std::unique_ptr<JitFunc> JitFunc::Compile(Environment* env,
+                                          const DefinedFunc* func) {
+  WABT_USE(env);
+  WABT_USE(func);
+  return nullptr;
+}
+
+#endif  // WABT_JIT_BACKEND
+
+}  // namespace interp
+}  // namespace wabt
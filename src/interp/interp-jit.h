@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_JIT_H_
+#define WABT_INTERP_JIT_H_
+
+#include <memory>
+
+#include "src/interp/interp.h"
+
+namespace wabt {
+namespace interp {
+
+// A baseline native tier for hot interpreter functions (x86-64 only).
+//
+// JitFunc::Compile translates the istream body of one DefinedFunc into
+// machine code that operates directly on the interpreter's value stack, so
+// jitted and interpreted frames interleave freely and no deoptimization is
+// ever needed. Only bodies made entirely of a simple subset are translated:
+// i32/i64 constants, locals, ALU/shift/compare operators (including the
+// fused local_binop forms), drops, branches, select, and return. A body
+// containing anything else -- calls, memory access, floats, globals -- is
+// left to the interpreter, which also means every translated function is a
+// leaf and the generated code never needs a native call frame.
+//
+// Thread::Run counts direct calls per DefinedFunc and invokes Compile once
+// the configured threshold is crossed (see Thread::Options::jit_threshold).
+//
+// Stack safety: instead of the interpreter's per-push check, the generated
+// prologue checks once that headroom for the body's worst case is available,
+// so a translated function may report value stack exhaustion slightly before
+// the interpreter would have.
+class JitFunc {
+ public:
+  // Result codes returned by the generated code.
+  enum : uint32_t {
+    kOk = 0,
+    kValueStackExhausted = 1,
+  };
+
+  // |stack_top| points at the first free value slot; the function's params
+  // are directly below it, exactly as at an interpreted function entry.
+  // |*out_top| receives the final stack top (the results' end) and is written
+  // on the trap path as well.
+  typedef uint32_t (*Entry)(Value* stack_top,
+                            Value* stack_end,
+                            Value** out_top);
+
+  JitFunc(const JitFunc&) = delete;
+  JitFunc& operator=(const JitFunc&) = delete;
+  ~JitFunc();
+
+  Entry entry() const { return entry_; }
+
+  // Translates |func|'s body. Returns nullptr when the body uses an opcode
+  // outside the supported subset or the host has no backend; the caller is
+  // expected to remember the failure and keep interpreting.
+  static std::unique_ptr<JitFunc> Compile(Environment* env,
+                                          const DefinedFunc* func);
+
+ private:
+  JitFunc() = default;
+
+  Entry entry_ = nullptr;
+  size_t code_size_ = 0;
+};
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif  // WABT_INTERP_JIT_H_
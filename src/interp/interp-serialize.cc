@@ -0,0 +1,485 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/interp/interp-serialize.h"
+
+#include <cstring>
+
+#include "src/cast.h"
+#include "src/stream.h"
+
+namespace wabt {
+namespace interp {
+
+namespace {
+
+static const uint32_t kCacheMagic = 0x43494257;  // "WBIC"
+
+// Bump this whenever the istream encoding (opcode.def), the structs
+// serialized below, or the layout of the cache itself changes.
+static const uint32_t kCacheVersion = 5;
+
+void WriteString(Stream* stream, string_view s) {
+  stream->WriteU32(s.size(), "string length");
+  stream->WriteData(s.data(), s.size(), "string");
+}
+
+void WriteTypeVector(Stream* stream, const TypeVector& types) {
+  stream->WriteU32(types.size(), "type count");
+  for (Type type : types) {
+    stream->WriteU32(static_cast<uint32_t>(type), "type");
+  }
+}
+
+void WriteLimits(Stream* stream, const Limits& limits) {
+  stream->WriteU64(limits.initial, "limits initial");
+  stream->WriteU64(limits.max, "limits max");
+  stream->WriteU8(limits.has_max, "limits has_max");
+  stream->WriteU8(limits.is_shared, "limits is_shared");
+}
+
+void WriteRefVector(Stream* stream, const std::vector<Ref>& refs) {
+  stream->WriteU32(refs.size(), "ref count");
+  for (const Ref& ref : refs) {
+    stream->WriteU32(static_cast<uint32_t>(ref.kind), "ref kind");
+    stream->WriteU32(ref.index, "ref index");
+  }
+}
+
+void WriteCacheTypedValue(Stream* stream, const TypedValue& tv) {
+  stream->WriteU32(static_cast<uint32_t>(tv.type), "value type");
+  stream->WriteData(&tv.value, sizeof(tv.value), "value");
+}
+
+// A bounds-checked reader over the cache buffer. Reads past the end set a
+// sticky failure flag and return zero values, so callers only have to check
+// ok() at natural boundaries. Counts are validated against the bytes left in
+// the buffer so a corrupt file can't request absurd allocations.
+class CacheReader {
+ public:
+  CacheReader(const void* data, size_t size)
+      : data_(static_cast<const uint8_t*>(data)), size_(size) {}
+
+  bool ok() const { return ok_; }
+  bool done() const { return ok_ && offset_ == size_; }
+
+  const uint8_t* ReadRaw(size_t count) {
+    if (!ok_ || size_ - offset_ < count) {
+      ok_ = false;
+      return nullptr;
+    }
+    const uint8_t* result = data_ + offset_;
+    offset_ += count;
+    return result;
+  }
+
+  uint8_t ReadU8() {
+    const uint8_t* p = ReadRaw(1);
+    return p ? *p : 0;
+  }
+
+  uint32_t ReadU32() {
+    uint32_t result = 0;
+    if (const uint8_t* p = ReadRaw(sizeof(result))) {
+      memcpy(&result, p, sizeof(result));
+    }
+    return result;
+  }
+
+  uint64_t ReadU64() {
+    uint64_t result = 0;
+    if (const uint8_t* p = ReadRaw(sizeof(result))) {
+      memcpy(&result, p, sizeof(result));
+    }
+    return result;
+  }
+
+  // Reads an element count whose elements occupy at least |min_elt_size|
+  // bytes each in the buffer.
+  uint32_t ReadCount(size_t min_elt_size) {
+    uint32_t count = ReadU32();
+    if (ok_ && count > (size_ - offset_) / min_elt_size) {
+      ok_ = false;
+      return 0;
+    }
+    return count;
+  }
+
+  std::string ReadString() {
+    uint32_t length = ReadCount(1);
+    const uint8_t* p = ReadRaw(length);
+    return p ? std::string(reinterpret_cast<const char*>(p), length)
+             : std::string();
+  }
+
+  TypeVector ReadTypeVector() {
+    uint32_t count = ReadCount(sizeof(uint32_t));
+    TypeVector result;
+    result.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      result.push_back(static_cast<Type>(static_cast<int32_t>(ReadU32())));
+    }
+    return result;
+  }
+
+  Limits ReadLimits() {
+    Limits limits;
+    limits.initial = ReadU64();
+    limits.max = ReadU64();
+    limits.has_max = ReadU8() != 0;
+    limits.is_shared = ReadU8() != 0;
+    return limits;
+  }
+
+  std::vector<Ref> ReadRefVector() {
+    uint32_t count = ReadCount(2 * sizeof(uint32_t));
+    std::vector<Ref> result;
+    result.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      Ref ref;
+      ref.kind = static_cast<RefType>(ReadU32());
+      ref.index = ReadU32();
+      result.push_back(ref);
+    }
+    return result;
+  }
+
+  TypedValue ReadTypedValue() {
+    TypedValue tv;
+    tv.type = static_cast<Type>(static_cast<int32_t>(ReadU32()));
+    if (const uint8_t* p = ReadRaw(sizeof(tv.value))) {
+      memcpy(&tv.value, p, sizeof(tv.value));
+    }
+    return tv;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+  bool ok_ = true;
+};
+
+}  // end anonymous namespace
+
+wabt::Result WriteModuleCache(Environment* env,
+                              const Environment::MarkPoint& mark,
+                              const DefinedModule* module,
+                              Stream* stream) {
+  stream->WriteU32(kCacheMagic, "cache magic");
+  stream->WriteU32(kCacheVersion, "cache version");
+  stream->WriteU32(sizeof(Value), "sizeof(Value)");
+
+  // The state of the environment the cache was lowered against. The istream
+  // encodes absolute indices into these index spaces, so the cache can only
+  // be replayed into an environment with identical counts.
+  stream->WriteU64(mark.modules_size, "base module count");
+  stream->WriteU64(mark.sigs_size, "base signature count");
+  stream->WriteU64(mark.funcs_size, "base function count");
+  stream->WriteU64(mark.memories_size, "base memory count");
+  stream->WriteU64(mark.tables_size, "base table count");
+  stream->WriteU64(mark.globals_size, "base global count");
+  stream->WriteU64(mark.data_segments_size, "base data segment count");
+  stream->WriteU64(mark.elem_segments_size, "base elem segment count");
+  stream->WriteU64(mark.istream_size, "base istream size");
+  stream->WriteU64(mark.call_indirect_cache_sites_size,
+                   "base call_indirect cache site count");
+
+  // Signatures.
+  stream->WriteU32(env->GetFuncSignatureCount() - mark.sigs_size,
+                   "signature count");
+  for (Index i = mark.sigs_size; i < env->GetFuncSignatureCount(); ++i) {
+    const FuncSignature* sig = env->GetFuncSignature(i);
+    WriteTypeVector(stream, sig->param_types);
+    WriteTypeVector(stream, sig->result_types);
+  }
+
+  // Functions. Host functions hold callbacks and can't be serialized; a
+  // module can only append those through on_unknown_func_export, in which
+  // case it isn't cacheable.
+  stream->WriteU32(env->GetFuncCount() - mark.funcs_size, "function count");
+  for (Index i = mark.funcs_size; i < env->GetFuncCount(); ++i) {
+    const Func* func = env->GetFunc(i);
+    if (func->is_host) {
+      return wabt::Result::Error;
+    }
+    const DefinedFunc* defined = cast<DefinedFunc>(func);
+    stream->WriteU32(defined->sig_index, "function signature index");
+    stream->WriteU32(defined->offset, "function istream offset");
+    stream->WriteU32(defined->istream_end, "function istream end");
+    stream->WriteU32(defined->local_decl_count, "function local decl count");
+    stream->WriteU32(defined->local_count, "function local count");
+    WriteTypeVector(stream, defined->param_and_local_types);
+  }
+
+  // Memories and tables are written as their declarations only; their
+  // contents are still in their zero-initialized pre-Initialize state.
+  stream->WriteU32(env->GetMemoryCount() - mark.memories_size, "memory count");
+  for (Index i = mark.memories_size; i < env->GetMemoryCount(); ++i) {
+    WriteLimits(stream, env->GetMemory(i)->page_limits);
+  }
+
+  stream->WriteU32(env->GetTableCount() - mark.tables_size, "table count");
+  for (Index i = mark.tables_size; i < env->GetTableCount(); ++i) {
+    const Table* table = env->GetTable(i);
+    stream->WriteU32(static_cast<uint32_t>(table->elem_type),
+                     "table elem type");
+    WriteLimits(stream, table->limits);
+  }
+
+  // Globals, with the initial values their init expressions produced.
+  stream->WriteU32(env->GetGlobalCount() - mark.globals_size, "global count");
+  for (Index i = mark.globals_size; i < env->GetGlobalCount(); ++i) {
+    const Global* global = env->GetGlobal(i);
+    stream->WriteU32(static_cast<uint32_t>(global->type), "global type");
+    stream->WriteU8(global->mutable_, "global mutability");
+    WriteCacheTypedValue(stream, global->typed_value);
+  }
+
+  // Passive data and elem segments.
+  stream->WriteU32(env->GetDataSegmentCount() - mark.data_segments_size,
+                   "data segment count");
+  for (Index i = mark.data_segments_size; i < env->GetDataSegmentCount();
+       ++i) {
+    const DataSegment* segment = env->GetDataSegment(i);
+    stream->WriteU32(segment->data.size(), "data segment size");
+    stream->WriteData(segment->data.data(), segment->data.size(),
+                      "data segment");
+  }
+
+  stream->WriteU32(env->GetElemSegmentCount() - mark.elem_segments_size,
+                   "elem segment count");
+  for (Index i = mark.elem_segments_size; i < env->GetElemSegmentCount();
+       ++i) {
+    WriteRefVector(stream, env->GetElemSegment(i)->elems);
+  }
+
+  // The module's slice of the istream, plus the call_indirect inline cache
+  // sites in it (still empty; ResetToMarkPoint needs to know about them).
+  const std::vector<uint8_t>& istream = env->istream().data;
+  stream->WriteU32(istream.size() - mark.istream_size, "istream size");
+  stream->WriteData(istream.data() + mark.istream_size,
+                    istream.size() - mark.istream_size, "istream");
+
+  const std::vector<IstreamOffset>& cache_sites =
+      env->call_indirect_cache_sites();
+  stream->WriteU32(cache_sites.size() - mark.call_indirect_cache_sites_size,
+                   "call_indirect cache site count");
+  for (size_t i = mark.call_indirect_cache_sites_size; i < cache_sites.size();
+       ++i) {
+    stream->WriteU32(cache_sites[i], "call_indirect cache site");
+  }
+
+  // Module metadata.
+  WriteString(stream, module->name);
+  stream->WriteU32(module->exports.size(), "export count");
+  for (const Export& export_ : module->exports) {
+    WriteString(stream, export_.name);
+    stream->WriteU32(static_cast<uint32_t>(export_.kind), "export kind");
+    stream->WriteU32(export_.index, "export index");
+  }
+  stream->WriteU32(module->memory_index, "module memory index");
+  stream->WriteU32(module->start_func_index, "module start function");
+  stream->WriteU32(module->istream_start, "module istream start");
+  stream->WriteU32(module->istream_end, "module istream end");
+  stream->WriteU32(module->instr_offsets.size(), "instr boundary count");
+  for (IstreamOffset offset : module->instr_offsets) {
+    stream->WriteU32(offset, "instr boundary");
+  }
+
+  stream->WriteU32(module->active_elem_segments_.size(),
+                   "active elem segment count");
+  for (const ElemSegmentInfo& info : module->active_elem_segments_) {
+    stream->WriteU32(info.table - env->GetTable(0), "elem segment table");
+    stream->WriteU32(info.dst, "elem segment offset");
+    WriteRefVector(stream, info.src);
+  }
+
+  stream->WriteU32(module->active_data_segments_.size(),
+                   "active data segment count");
+  for (const DataSegmentInfo& info : module->active_data_segments_) {
+    stream->WriteU32(info.memory - env->GetMemory(0), "data segment memory");
+    stream->WriteU32(info.dst, "data segment offset");
+    stream->WriteU32(info.data.size(), "data segment size");
+    stream->WriteData(info.data.data(), info.data.size(), "data segment");
+  }
+
+  return stream->result();
+}
+
+wabt::Result ReadModuleCache(Environment* env,
+                             const void* data,
+                             size_t size,
+                             DefinedModule** out_module) {
+  *out_module = nullptr;
+
+  CacheReader reader(data, size);
+  if (reader.ReadU32() != kCacheMagic ||
+      reader.ReadU32() != kCacheVersion ||
+      reader.ReadU32() != sizeof(Value)) {
+    return wabt::Result::Error;
+  }
+
+  Environment::MarkPoint mark = env->Mark();
+  if (reader.ReadU64() != mark.modules_size ||
+      reader.ReadU64() != mark.sigs_size ||
+      reader.ReadU64() != mark.funcs_size ||
+      reader.ReadU64() != mark.memories_size ||
+      reader.ReadU64() != mark.tables_size ||
+      reader.ReadU64() != mark.globals_size ||
+      reader.ReadU64() != mark.data_segments_size ||
+      reader.ReadU64() != mark.elem_segments_size ||
+      reader.ReadU64() != mark.istream_size ||
+      reader.ReadU64() != mark.call_indirect_cache_sites_size ||
+      !reader.ok()) {
+    return wabt::Result::Error;
+  }
+
+  // Everything below appends to the environment, mirroring what
+  // ReadBinaryInterp would have done; unwind to the mark point on failure.
+  DefinedModule* module = new DefinedModule(env);
+  env->EmplaceBackModule(module);
+
+  uint32_t num_sigs = reader.ReadCount(2 * sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_sigs; ++i) {
+    TypeVector param_types = reader.ReadTypeVector();
+    TypeVector result_types = reader.ReadTypeVector();
+    env->EmplaceBackFuncSignature(std::move(param_types),
+                                  std::move(result_types));
+  }
+
+  uint32_t num_funcs = reader.ReadCount(5 * sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_funcs; ++i) {
+    Index sig_index = reader.ReadU32();
+    if (sig_index >= env->GetFuncSignatureCount()) {
+      env->ResetToMarkPoint(mark);
+      return wabt::Result::Error;
+    }
+    DefinedFunc* func =
+        cast<DefinedFunc>(env->EmplaceBackFunc(new DefinedFunc(sig_index)));
+    func->offset = reader.ReadU32();
+    func->istream_end = reader.ReadU32();
+    func->local_decl_count = reader.ReadU32();
+    func->local_count = reader.ReadU32();
+    func->param_and_local_types = reader.ReadTypeVector();
+  }
+
+  uint32_t num_memories = reader.ReadCount(2 * sizeof(uint64_t) + 2);
+  for (uint32_t i = 0; i < num_memories; ++i) {
+    env->EmplaceBackMemory(reader.ReadLimits(), env->use_guard_pages());
+  }
+
+  uint32_t num_tables = reader.ReadCount(sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_tables; ++i) {
+    Type elem_type = static_cast<Type>(static_cast<int32_t>(reader.ReadU32()));
+    env->EmplaceBackTable(elem_type, reader.ReadLimits());
+  }
+
+  uint32_t num_globals = reader.ReadCount(2 * sizeof(uint32_t) + 1);
+  for (uint32_t i = 0; i < num_globals; ++i) {
+    Global* global = env->EmplaceBackGlobal();
+    global->type = static_cast<Type>(static_cast<int32_t>(reader.ReadU32()));
+    global->mutable_ = reader.ReadU8() != 0;
+    global->typed_value = reader.ReadTypedValue();
+  }
+
+  uint32_t num_data_segments = reader.ReadCount(sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_data_segments; ++i) {
+    DataSegment* segment = env->EmplaceBackDataSegment();
+    uint32_t data_size = reader.ReadCount(1);
+    if (const uint8_t* p = reader.ReadRaw(data_size)) {
+      segment->data.assign(reinterpret_cast<const char*>(p),
+                           reinterpret_cast<const char*>(p) + data_size);
+    }
+  }
+
+  uint32_t num_elem_segments = reader.ReadCount(sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_elem_segments; ++i) {
+    env->EmplaceBackElemSegment()->elems = reader.ReadRefVector();
+  }
+
+  uint32_t istream_size = reader.ReadCount(1);
+  if (const uint8_t* p = reader.ReadRaw(istream_size)) {
+    std::unique_ptr<OutputBuffer> istream = env->ReleaseIstream();
+    istream->data.insert(istream->data.end(), p, p + istream_size);
+    env->SetIstream(std::move(istream));
+  }
+
+  uint32_t num_cache_sites = reader.ReadCount(sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_cache_sites; ++i) {
+    env->AppendCallIndirectCacheSite(reader.ReadU32());
+  }
+
+  module->name = reader.ReadString();
+  uint32_t num_exports = reader.ReadCount(3 * sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_exports; ++i) {
+    std::string name = reader.ReadString();
+    ExternalKind kind = static_cast<ExternalKind>(reader.ReadU32());
+    Index item_index = reader.ReadU32();
+    module->AppendExport(kind, item_index, name);
+  }
+  module->memory_index = reader.ReadU32();
+  module->start_func_index = reader.ReadU32();
+  module->istream_start = reader.ReadU32();
+  module->istream_end = reader.ReadU32();
+
+  uint32_t num_instr_offsets = reader.ReadCount(sizeof(uint32_t));
+  module->instr_offsets.reserve(num_instr_offsets);
+  for (uint32_t i = 0; i < num_instr_offsets; ++i) {
+    module->instr_offsets.push_back(reader.ReadU32());
+  }
+
+  uint32_t num_active_elem_segments = reader.ReadCount(3 * sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_active_elem_segments; ++i) {
+    Index table_index = reader.ReadU32();
+    if (table_index >= env->GetTableCount()) {
+      env->ResetToMarkPoint(mark);
+      return wabt::Result::Error;
+    }
+    module->active_elem_segments_.emplace_back(env->GetTable(table_index),
+                                               reader.ReadU32());
+    module->active_elem_segments_.back().src = reader.ReadRefVector();
+  }
+
+  uint32_t num_active_data_segments = reader.ReadCount(3 * sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_active_data_segments; ++i) {
+    Index memory_index = reader.ReadU32();
+    if (memory_index >= env->GetMemoryCount()) {
+      env->ResetToMarkPoint(mark);
+      return wabt::Result::Error;
+    }
+    module->active_data_segments_.emplace_back(env->GetMemory(memory_index),
+                                               reader.ReadU32());
+    uint32_t data_size = reader.ReadCount(1);
+    if (const uint8_t* p = reader.ReadRaw(data_size)) {
+      module->active_data_segments_.back().data.assign(
+          reinterpret_cast<const char*>(p),
+          reinterpret_cast<const char*>(p) + data_size);
+    }
+  }
+
+  if (!reader.done() || module->istream_start != mark.istream_size ||
+      module->istream_end != env->istream().size()) {
+    env->ResetToMarkPoint(mark);
+    return wabt::Result::Error;
+  }
+
+  *out_module = module;
+  return wabt::Result::Ok;
+}
+
+}  // namespace interp
+}  // namespace wabt
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_INTERP_SERIALIZE_H_
+#define WABT_INTERP_SERIALIZE_H_
+
+#include "src/common.h"
+#include "src/interp/interp.h"
+
+namespace wabt {
+
+class Stream;
+
+namespace interp {
+
+// Serialization of a lowered module, so the work ReadBinaryInterp does can be
+// cached on disk and replayed into a fresh Environment without re-reading the
+// wasm binary. The format is versioned but host-local: it stores raw istream
+// bytes and in-memory value representations, so a cache written by one wabt
+// build or architecture is rejected (not misread) by another.
+
+// Writes everything ReadBinaryInterp appended to |env| for |module| to
+// |stream|: signatures, functions, tables, memories, globals, segments, the
+// module's slice of the istream, and the module metadata itself. |mark| must
+// have been taken immediately before ReadBinaryInterp, and the module must
+// not have been initialized yet (memories, tables and globals are written in
+// their pre-Initialize state). Fails if the module caused host objects to be
+// created; those can't be serialized.
+wabt::Result WriteModuleCache(Environment* env,
+                              const Environment::MarkPoint& mark,
+                              const DefinedModule* module,
+                              Stream* stream);
+
+// Replays a cache produced by WriteModuleCache into |env|, as if
+// ReadBinaryInterp had just run. The cache records the counts of all the
+// environment's index spaces at write time; reading fails (and leaves |env|
+// unchanged) unless |env| matches them, since the cached istream refers to
+// objects by absolute index.
+wabt::Result ReadModuleCache(Environment* env,
+                             const void* data,
+                             size_t size,
+                             DefinedModule** out_module);
+
+}  // namespace interp
+}  // namespace wabt
+
+#endif /* WABT_INTERP_SERIALIZE_H_ */
@@ -49,7 +49,8 @@ void Thread::Trace(Stream* stream) {
                      Top().i32);
       break;
 
-    case Opcode::BrTable: {
+    case Opcode::BrTable:
+    case Opcode::InterpBrTableCompact: {
       const Index num_targets = ReadU32At(pc);
       const IstreamOffset table_offset = ReadU32At(pc + 4);
       const uint32_t key = Top().i32;
@@ -103,7 +104,8 @@ void Thread::Trace(Stream* stream) {
 
     case Opcode::Call:
     case Opcode::ReturnCall:
-      stream->Writef("%s @%u\n", opcode.GetName(), ReadU32At(pc));
+      stream->Writef("%s @%u, $%u\n", opcode.GetName(), ReadU32At(pc),
+                     ReadU32At(pc + 4));
       break;
 
     case Opcode::CallIndirect:
@@ -476,6 +478,44 @@ void Thread::Trace(Stream* stream) {
                      ReadU32At(pc + 4));
       break;
 
+    case Opcode::InterpBrDropKeep:
+      stream->Writef("%s $%u $%u @%u\n", opcode.GetName(), ReadU32At(pc),
+                     ReadU32At(pc + 4), ReadU32At(pc + 8));
+      break;
+
+    case Opcode::InterpLocalBinop: {
+      Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+      stream->Writef("%s %s $%u $%u\n", opcode.GetName(), binop.GetName(),
+                     ReadU32At(pc + 4), ReadU32At(pc + 8));
+      break;
+    }
+
+    case Opcode::InterpLocalBinopSet: {
+      Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+      stream->Writef("%s %s $%u $%u $%u\n", opcode.GetName(), binop.GetName(),
+                     ReadU32At(pc + 4), ReadU32At(pc + 8), ReadU32At(pc + 12));
+      break;
+    }
+
+    case Opcode::InterpLocalConstBinop: {
+      Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+      stream->Writef("%s %s $%u %" PRIu64 "\n", opcode.GetName(),
+                     binop.GetName(), ReadU32At(pc + 4), ReadU64At(pc + 8));
+      break;
+    }
+
+    case Opcode::InterpLocalConstBinopSet: {
+      Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+      stream->Writef("%s %s $%u %" PRIu64 " $%u\n", opcode.GetName(),
+                     binop.GetName(), ReadU32At(pc + 4), ReadU64At(pc + 8),
+                     ReadU32At(pc + 16));
+      break;
+    }
+
+    case Opcode::InterpStackCheck:
+      stream->Writef("%s $%u\n", opcode.GetName(), ReadU32At(pc));
+      break;
+
     case Opcode::V128Const: {
       stream->Writef("%s i32x4 0x%08x 0x%08x 0x%08x 0x%08x\n", opcode.GetName(),
                      ReadU32At(pc), ReadU32At(pc + 4), ReadU32At(pc + 8),
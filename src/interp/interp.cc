@@ -17,14 +17,30 @@
 #include "src/interp/interp.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <limits>
+#include <mutex>
 #include <type_traits>
 #include <vector>
 
+#if WABT_HAS_GUARD_PAGES
+#include <csetjmp>
+#include <csignal>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
 #include "src/interp/interp-internal.h"
+#include "src/interp/interp-jit.h"
 
 #include "src/cast.h"
 #include "src/stream.h"
@@ -46,12 +62,406 @@ namespace interp {
 // Differs from CHECK_RESULT since it can return different traps, not just
 // Error. Also uses __VA_ARGS__ so templates can be passed without surrounding
 // parentheses.
-#define CHECK_TRAP(...)            \
-  do {                             \
-    Result result = (__VA_ARGS__); \
-    if (!result.ok()) {            \
-      return result;               \
-    }                              \
+#if WABT_HAS_GUARD_PAGES
+
+namespace {
+
+// Size of the reservation for a guard-page-backed memory: 4 GiB for any
+// 32-bit address plus 4 GiB for any 32-bit offset, plus one page so the
+// widest access starting at the last valid byte still lands in the
+// reservation.
+const uint64_t kGuardReserveSize = 0x200000000ull + WABT_PAGE_SIZE;
+
+const int kMaxGuardedMemories = 64;
+
+// Bases of all live guard-page reservations. Read from the fault handler, so
+// entries are atomics rather than a locked container.
+std::atomic<char*> s_guarded_bases[kMaxGuardedMemories];
+std::atomic<int> s_num_guarded_memories(0);
+std::once_flag s_guard_handler_once;
+
+// Jump target for turning a guard-page fault back into a trap; armed by
+// Thread::Run while it executes with guarded memories present.
+thread_local sigjmp_buf* s_guard_jmp_buf = nullptr;
+
+void GuardFaultHandler(int sig, siginfo_t* info, void*) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(info->si_addr);
+  if (s_guard_jmp_buf) {
+    for (int i = 0; i < kMaxGuardedMemories; ++i) {
+      char* base = s_guarded_bases[i].load(std::memory_order_relaxed);
+      if (base && addr >= reinterpret_cast<uintptr_t>(base) &&
+          addr < reinterpret_cast<uintptr_t>(base) + kGuardReserveSize) {
+        siglongjmp(*s_guard_jmp_buf, 1);
+      }
+    }
+  }
+  // Not a guarded wasm memory access; restore the default disposition and
+  // return so the fault re-raises and crashes normally.
+  signal(sig, SIG_DFL);
+}
+
+void InstallGuardFaultHandler() {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = GuardFaultHandler;
+  sa.sa_flags = SA_SIGINFO;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGSEGV, &sa, nullptr);
+#ifdef __APPLE__
+  sigaction(SIGBUS, &sa, nullptr);
+#endif
+}
+
+bool AnyGuardedMemories() {
+  return s_num_guarded_memories.load(std::memory_order_relaxed) > 0;
+}
+
+// Saves and restores the per-thread fault jump target so nested Run calls
+// (e.g. through host functions) unwind correctly.
+class GuardTrapScope {
+ public:
+  GuardTrapScope() : prev_(s_guard_jmp_buf) {}
+  ~GuardTrapScope() { s_guard_jmp_buf = prev_; }
+  void Arm() { s_guard_jmp_buf = &jmp_buf_; }
+
+  sigjmp_buf jmp_buf_;
+
+ private:
+  sigjmp_buf* prev_;
+};
+
+}  // end anonymous namespace
+
+bool Memory::AllocateGuarded(size_t initial_size, int fd) {
+  void* base = mmap(nullptr, kGuardReserveSize, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+  if (initial_size > 0) {
+    if (fd >= 0) {
+      // Map the snapshot file privately over the committed prefix; writes
+      // copy pages on demand and never reach the file.
+      if (mmap(base, initial_size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, kGuardReserveSize);
+        return false;
+      }
+    } else if (mprotect(base, initial_size, PROT_READ | PROT_WRITE) != 0) {
+      munmap(base, kGuardReserveSize);
+      return false;
+    }
+  }
+  char* cbase = static_cast<char*>(base);
+  for (int i = 0; i < kMaxGuardedMemories; ++i) {
+    char* expected = nullptr;
+    if (s_guarded_bases[i].compare_exchange_strong(expected, cbase)) {
+      std::call_once(s_guard_handler_once, InstallGuardFaultHandler);
+      s_num_guarded_memories.fetch_add(1, std::memory_order_relaxed);
+      guard_base_ = cbase;
+      guarded_size_ = initial_size;
+      return true;
+    }
+  }
+  // Too many live guarded memories; fall back to vector storage.
+  munmap(base, kGuardReserveSize);
+  return false;
+}
+
+void Memory::FreeGuarded() {
+  if (!guard_base_) {
+    return;
+  }
+  for (int i = 0; i < kMaxGuardedMemories; ++i) {
+    char* expected = guard_base_;
+    if (s_guarded_bases[i].compare_exchange_strong(expected, nullptr)) {
+      break;
+    }
+  }
+  s_num_guarded_memories.fetch_sub(1, std::memory_order_relaxed);
+  munmap(guard_base_, kGuardReserveSize);
+  guard_base_ = nullptr;
+  guarded_size_ = 0;
+}
+
+void* ReserveLazyStackPages(size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  // MAP_NORESERVE keeps the kernel from charging the whole reservation
+  // against overcommit limits; pages are committed (zeroed) on first touch.
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return base == MAP_FAILED ? nullptr : base;
+}
+
+void ReleaseLazyStackPages(void* data, size_t size) {
+  if (data) {
+    munmap(data, size);
+  }
+}
+
+#else
+
+bool Memory::AllocateGuarded(size_t, int) {
+  return false;
+}
+
+void Memory::FreeGuarded() {}
+
+void* ReserveLazyStackPages(size_t) {
+  return nullptr;
+}
+
+void ReleaseLazyStackPages(void*, size_t) {}
+
+#endif /* WABT_HAS_GUARD_PAGES */
+
+#if WABT_HAS_GUARD_PAGES && defined(__linux__)
+
+namespace {
+
+// Writes a snapshot of the memory's current contents into an anonymous
+// memfd, so forks and snapshot restores can map it MAP_PRIVATE and share
+// unmodified pages.
+int MakeMemorySnapshotFd(const Memory& memory) {
+  int fd = memfd_create("wabt-memory-snapshot", MFD_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  const char* p = memory.data_begin();
+  size_t remaining = memory.data_size();
+  while (remaining > 0) {
+    ssize_t written = write(fd, p, remaining);
+    if (written <= 0) {
+      close(fd);
+      return -1;
+    }
+    p += written;
+    remaining -= written;
+  }
+  return fd;
+}
+
+}  // end anonymous namespace
+
+#endif /* WABT_HAS_GUARD_PAGES && defined(__linux__) */
+
+void Memory::ForkFrom(const Memory& other) {
+  FreeGuarded();
+  page_limits = other.page_limits;
+  policy_ = other.policy_;
+#if WABT_HAS_GUARD_PAGES && defined(__linux__)
+  // Only guard-page-backed memories have an mmap region to map the snapshot
+  // into; plain vector-backed memories are deep-copied below.
+  if (other.has_guard_pages()) {
+    int fd = MakeMemorySnapshotFd(other);
+    if (fd >= 0) {
+      bool ok = AllocateGuarded(other.data_size(), fd);
+      close(fd);
+      if (ok) {
+        data.clear();
+        ApplyAllocationPolicy();
+        return;
+      }
+    }
+  }
+#endif
+  data.assign(other.data_begin(), other.data_begin() + other.data_size());
+  ApplyAllocationPolicy();
+}
+
+void MemorySnapshot::Close() {
+#if WABT_HAS_GUARD_PAGES && defined(__linux__)
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+#endif
+}
+
+MemorySnapshot::MemorySnapshot(MemorySnapshot&& other) {
+  *this = std::move(other);
+}
+
+MemorySnapshot& MemorySnapshot::operator=(MemorySnapshot&& other) {
+  if (this != &other) {
+    Close();
+    page_limits_ = other.page_limits_;
+    size_ = other.size_;
+    fd_ = other.fd_;
+    copy_ = std::move(other.copy_);
+    other.fd_ = -1;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+MemorySnapshot::~MemorySnapshot() {
+  Close();
+}
+
+void Memory::DropGuardedTail(size_t new_size) {
+#if WABT_HAS_GUARD_PAGES
+  if (guarded_size_ > new_size) {
+    mmap(guard_base_ + new_size, guarded_size_ - new_size, PROT_NONE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+  }
+  guarded_size_ = new_size;
+#endif
+}
+
+MemorySnapshot Memory::TakeSnapshot() const {
+  MemorySnapshot snapshot;
+  snapshot.page_limits_ = page_limits;
+  snapshot.size_ = data_size();
+#if WABT_HAS_GUARD_PAGES && defined(__linux__)
+  if (has_guard_pages()) {
+    snapshot.fd_ = MakeMemorySnapshotFd(*this);
+    if (snapshot.fd_ >= 0) {
+      return snapshot;
+    }
+  }
+#endif
+  snapshot.copy_.assign(data_begin(), data_begin() + data_size());
+  return snapshot;
+}
+
+void Memory::RestoreSnapshot(const MemorySnapshot& snapshot) {
+  page_limits = snapshot.page_limits_;
+#if WABT_HAS_GUARD_PAGES && defined(__linux__)
+  if (snapshot.fd_ >= 0) {
+    // Remap the snapshot over the committed prefix. This drops the private
+    // copies of exactly the pages written since the snapshot and shares the
+    // rest with it again, so the cost of a restore is proportional to the
+    // pages dirtied, not to the memory size.
+    if (has_guard_pages() &&
+        mmap(guard_base_, snapshot.size_, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED, snapshot.fd_, 0) != MAP_FAILED) {
+      DropGuardedTail(snapshot.size_);
+      return;
+    }
+    // The remap failed (or the storage changed under us); read the contents
+    // back out of the memfd instead.
+    if (!has_guard_pages()) {
+      data.resize(snapshot.size_);
+    }
+    char* dst = data_begin();
+    size_t remaining = snapshot.size_;
+    off_t offset = 0;
+    while (remaining > 0) {
+      ssize_t bytes = pread(snapshot.fd_, dst, remaining, offset);
+      if (bytes <= 0) {
+        break;
+      }
+      dst += bytes;
+      offset += bytes;
+      remaining -= bytes;
+    }
+    if (has_guard_pages()) {
+      DropGuardedTail(snapshot.size_);
+    }
+    return;
+  }
+#endif
+  if (guard_base_) {
+    memcpy(guard_base_, snapshot.copy_.data(), snapshot.size_);
+    DropGuardedTail(snapshot.size_);
+  } else {
+    data.assign(snapshot.copy_.begin(), snapshot.copy_.end());
+  }
+}
+
+Memory& Memory::operator=(Memory&& other) {
+  if (this != &other) {
+    FreeGuarded();
+    page_limits = other.page_limits;
+    data = std::move(other.data);
+    policy_ = other.policy_;
+    guard_base_ = other.guard_base_;
+    guarded_size_ = other.guarded_size_;
+    other.guard_base_ = nullptr;
+    other.guarded_size_ = 0;
+  }
+  return *this;
+}
+
+Memory::~Memory() {
+  FreeGuarded();
+}
+
+void Memory::ApplyAllocationPolicy() {
+#if WABT_HAS_GUARD_PAGES && defined(__linux__)
+  if (!policy_.use_huge_pages && policy_.numa_node < 0) {
+    return;
+  }
+  // Guard-page memories hint the entire reservation, so pages the memory
+  // later grows into inherit the policy; vector storage hints the
+  // page-aligned span it currently occupies and is re-hinted when a resize
+  // moves it.
+  char* begin;
+  size_t size;
+  if (guard_base_) {
+    begin = guard_base_;
+    size = kGuardReserveSize;
+  } else {
+    uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(data.data());
+    uintptr_t aligned = (start + page_size - 1) & ~(page_size - 1);
+    uintptr_t end = start + data.size();
+    if (aligned >= end) {
+      return;
+    }
+    begin = reinterpret_cast<char*>(aligned);
+    size = end - aligned;
+  }
+#ifdef MADV_HUGEPAGE
+  if (policy_.use_huge_pages) {
+    madvise(begin, size, MADV_HUGEPAGE);
+  }
+#endif
+#ifdef SYS_mbind
+  if (policy_.numa_node >= 0 && policy_.numa_node < 64) {
+    // Raw syscall so wabt doesn't grow a libnuma dependency; the constants
+    // are part of the kernel ABI (linux/mempolicy.h): MPOL_BIND = 2,
+    // MPOL_MF_MOVE = (1 << 1).
+    unsigned long nodemask = 1ul << policy_.numa_node;
+    syscall(SYS_mbind, begin, size, 2, &nodemask, sizeof(nodemask) * 8,
+            1u << 1);
+  }
+#endif
+#endif /* WABT_HAS_GUARD_PAGES && defined(__linux__) */
+}
+
+bool Memory::Resize(size_t new_size) {
+  if (!guard_base_) {
+    size_t old_capacity = data.capacity();
+    data.resize(new_size);
+    if (data.capacity() != old_capacity) {
+      ApplyAllocationPolicy();
+    }
+    return true;
+  }
+#if WABT_HAS_GUARD_PAGES
+  if (new_size > guarded_size_ &&
+      mprotect(guard_base_ + guarded_size_, new_size - guarded_size_,
+               PROT_READ | PROT_WRITE) != 0) {
+    return false;
+  }
+#endif
+  guarded_size_ = new_size;
+  return true;
+}
+
+// Trap propagation between interpreter helpers moves only the ResultType
+// enum; detailed messages are stashed on the Thread by TrapMsg and attached
+// at the Executor boundary, so the no-trap path here is a register compare.
+#define CHECK_TRAP(...)                             \
+  do {                                              \
+    ResultType result__ = (__VA_ARGS__);            \
+    if (WABT_UNLIKELY(result__ != ResultType::Ok)) { \
+      return result__;                              \
+    }                                               \
   } while (0)
 
 std::string RefTypeToString(RefType t) {
@@ -166,14 +576,37 @@ void WriteCall(Stream* stream,
 }
 
 Environment::Environment(const Features& features)
-    : features_(features), istream_(new OutputBuffer()) {}
+    : features_(features),
+      sigs_(new std::vector<FuncSignature>()),
+      istream_(new OutputBuffer()) {}
+
+// Encodes a signature's shape as a flat byte string, used as the key when
+// canonicalizing signatures. The param count prefix makes the encoding
+// unambiguous.
+static std::string SigShapeKey(const FuncSignature& sig) {
+  std::string key;
+  key.reserve(sizeof(Index) +
+              (sig.param_types.size() + sig.result_types.size()) *
+                  sizeof(Type));
+  Index param_count = sig.param_types.size();
+  key.append(reinterpret_cast<const char*>(&param_count),
+             sizeof(param_count));
+  key.append(reinterpret_cast<const char*>(sig.param_types.data()),
+             sig.param_types.size() * sizeof(Type));
+  key.append(reinterpret_cast<const char*>(sig.result_types.data()),
+             sig.result_types.size() * sizeof(Type));
+  return key;
+}
+
+void Environment::CanonicalizeNewSignature() {
+  Index index = sigs_->size() - 1;
+  FuncSignature* sig = &(*sigs_)[index];
+  auto pair = sig_canonical_map_.emplace(SigShapeKey(*sig), index);
+  sig->canonical_index = pair.first->second;
+}
 
 Index Environment::FindModuleIndex(string_view name) const {
-  auto iter = module_bindings_.find(name.to_string());
-  if (iter == module_bindings_.end()) {
-    return kInvalidIndex;
-  }
-  return iter->second.index;
+  return module_bindings_.FindIndex(name);
 }
 
 Module* Environment::FindModule(string_view name) {
@@ -181,12 +614,32 @@ Module* Environment::FindModule(string_view name) {
   return index == kInvalidIndex ? nullptr : modules_[index].get();
 }
 
+ExportHandle Environment::ResolveExport(Index module_index, string_view name) {
+  ExportHandle handle;
+  Module* module = GetModule(module_index);
+  Export* export_ = module->GetExport(name);
+  if (export_) {
+    handle.module_index = module_index;
+    handle.export_index = export_ - module->exports.data();
+  }
+  return handle;
+}
+
+ExportHandle Environment::ResolveExport(string_view module_name,
+                                        string_view name) {
+  Index module_index = FindModuleIndex(module_name);
+  if (module_index == kInvalidIndex) {
+    return ExportHandle();
+  }
+  return ResolveExport(module_index, name);
+}
+
 Module* Environment::FindRegisteredModule(string_view name) {
   bool retry = false;
   while (true) {
-    auto iter = registered_module_bindings_.find(name.to_string());
-    if (iter != registered_module_bindings_.end()) {
-      return modules_[iter->second.index].get();
+    Index index = registered_module_bindings_.FindIndex(name);
+    if (index != kInvalidIndex) {
+      return modules_[index].get();
     }
 
     if (retry) {
@@ -205,16 +658,160 @@ Module* Environment::FindRegisteredModule(string_view name) {
   return nullptr;
 }
 
-Thread::Options::Options(uint32_t value_stack_size, uint32_t call_stack_size)
-    : value_stack_size(value_stack_size), call_stack_size(call_stack_size) {}
+// Sampling period for the profiler's pc histogram; prime, so the samples
+// don't stay in lockstep with loop bodies.
+static const uint32_t kProfilePcSampleInterval = 997;
+
+// Fuel units between reads of the wall-clock deadline (see
+// Thread::Options::wall_clock_limit_ms). This bounds how far past its
+// deadline a thread can run — tens of microseconds of work — while keeping
+// the clock read far off the hot path.
+static const int64_t kDeadlineCheckFuelInterval = 64 * 1024;
+
+Thread::Options::Options(uint32_t value_stack_size,
+                         uint32_t call_stack_size,
+                         bool enable_profiling)
+    : value_stack_size(value_stack_size),
+      call_stack_size(call_stack_size),
+      enable_profiling(enable_profiling) {}
+
+// Out of line so JitFunc is complete where the unique_ptr member is
+// constructed and destroyed.
+DefinedFunc::DefinedFunc(Index sig_index)
+    : Func(sig_index, false),
+      offset(kInvalidIstreamOffset),
+      istream_end(kInvalidIstreamOffset),
+      local_decl_count(0),
+      local_count(0) {}
+
+DefinedFunc::~DefinedFunc() {}
 
 Thread::Thread(Environment* env, const Options& options)
     : env_(env),
       value_stack_(options.value_stack_size),
-      call_stack_(options.call_stack_size) {}
+      call_stack_(options.call_stack_size),
+      jit_threshold_(options.jit_threshold),
+      relaxed_nans_(options.relaxed_nans),
+      profiling_(options.enable_profiling) {
+  if (profiling_) {
+    profile_opcode_counts_.resize(static_cast<uint32_t>(Opcode::Invalid) + 1);
+    profile_pc_countdown_ = kProfilePcSampleInterval;
+  }
+  if (options.fuel_quota != 0) {
+    fuel_remaining_ = options.fuel_quota;
+  }
+  if (options.memory_grow_quota != 0) {
+    grow_bytes_remaining_ = options.memory_grow_quota;
+  }
+  if (options.wall_clock_limit_ms != 0) {
+    has_deadline_ = true;
+    deadline_ = std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(options.wall_clock_limit_ms);
+    deadline_fuel_countdown_ = kDeadlineCheckFuelInterval;
+  }
+}
+
+void Thread::ProfileSample(Opcode opcode, IstreamOffset offset) {
+  profile_opcode_counts_[static_cast<uint32_t>(Opcode::Enum(opcode))]++;
+  if (--profile_pc_countdown_ == 0) {
+    profile_pc_countdown_ = kProfilePcSampleInterval;
+    profile_pc_counts_[offset]++;
+  }
+}
+
+uint64_t Thread::ProfileInstructionCount() const {
+  uint64_t total = 0;
+  for (uint64_t count : profile_opcode_counts_) {
+    total += count;
+  }
+  return total;
+}
+
+void Thread::DumpProfile(Stream* stream) {
+  if (!profiling_) {
+    return;
+  }
+
+  uint64_t total = 0;
+  std::vector<std::pair<uint64_t, uint32_t>> opcodes;
+  for (uint32_t i = 0; i < profile_opcode_counts_.size(); ++i) {
+    uint64_t count = profile_opcode_counts_[i];
+    if (count > 0) {
+      total += count;
+      opcodes.emplace_back(count, i);
+    }
+  }
+  std::sort(opcodes.begin(), opcodes.end(),
+            std::greater<std::pair<uint64_t, uint32_t>>());
+
+  stream->Writef("instructions executed: %" PRIu64 "\n", total);
+  for (const auto& pair : opcodes) {
+    stream->Writef("%12" PRIu64 " (%5.2f%%) %s\n", pair.first,
+                   total ? 100.0 * pair.first / total : 0.0,
+                   Opcode(Opcode::Enum(pair.second)).GetName());
+  }
+
+  if (profile_pc_counts_.empty()) {
+    return;
+  }
+
+  // Attribute the sampled pcs to functions. A DefinedFunc only records its
+  // entry offset, so a pc belongs to the function with the greatest entry at
+  // or below it.
+  std::vector<std::pair<IstreamOffset, Index>> starts;
+  for (Index i = 0; i < env_->GetFuncCount(); ++i) {
+    if (auto* defined = dyn_cast<DefinedFunc>(env_->GetFunc(i))) {
+      if (defined->offset != kInvalidIstreamOffset) {
+        starts.emplace_back(defined->offset, i);
+      }
+    }
+  }
+  std::sort(starts.begin(), starts.end());
+
+  uint64_t total_samples = 0;
+  std::map<Index, uint64_t> func_samples;
+  for (const auto& pair : profile_pc_counts_) {
+    auto iter = std::upper_bound(starts.begin(), starts.end(),
+                                 std::make_pair(pair.first, kInvalidIndex));
+    if (iter == starts.begin()) {
+      // Sampled before the first function, e.g. in an init expression.
+      continue;
+    }
+    --iter;
+    func_samples[iter->second] += pair.second;
+    total_samples += pair.second;
+  }
+
+  // Prefer an export name for a function; fall back to its index.
+  std::map<Index, std::string> func_names;
+  for (Index m = 0; m < env_->GetModuleCount(); ++m) {
+    for (const Export& export_ : env_->GetModule(m)->exports) {
+      if (export_.kind == ExternalKind::Func) {
+        func_names.emplace(export_.index, export_.name.to_string());
+      }
+    }
+  }
 
-FuncSignature::FuncSignature(std::vector<Type> param_types,
-                             std::vector<Type> result_types)
+  std::vector<std::pair<uint64_t, Index>> hot;
+  for (const auto& pair : func_samples) {
+    hot.emplace_back(pair.second, pair.first);
+  }
+  std::sort(hot.begin(), hot.end(),
+            std::greater<std::pair<uint64_t, Index>>());
+
+  stream->Writef("hot functions (%" PRIu64 " pc samples):\n", total_samples);
+  for (const auto& pair : hot) {
+    auto name_iter = func_names.find(pair.second);
+    std::string name = name_iter != func_names.end()
+                           ? name_iter->second
+                           : StringPrintf("func[%u]", pair.second);
+    stream->Writef("%12" PRIu64 " (%5.2f%%) %s\n", pair.first,
+                   100.0 * pair.first / total_samples, name.c_str());
+  }
+}
+
+FuncSignature::FuncSignature(TypeVector param_types,
+                             TypeVector result_types)
     : param_types(param_types), result_types(result_types) {}
 
 FuncSignature::FuncSignature(Index param_count,
@@ -227,21 +824,23 @@ FuncSignature::FuncSignature(Index param_count,
 Module::Module(Environment* env, bool is_host)
     : memory_index(kInvalidIndex),
       is_host(is_host),
-      env(env) {}
+      env(env) {
+  export_bindings.set_string_pool(&export_name_pool);
+}
 
 Module::Module(Environment* env, string_view name, bool is_host)
     : name(name.to_string()),
       memory_index(kInvalidIndex),
       is_host(is_host),
-      env(env) {}
+      env(env) {
+  export_bindings.set_string_pool(&export_name_pool);
+}
 
 Export* Module::GetFuncExport(Environment* env,
                               string_view name,
                               Index sig_index) {
-  auto range = export_bindings.equal_range(name.to_string());
-  for (auto iter = range.first; iter != range.second; ++iter) {
-    const Binding& binding = iter->second;
-    Export* export_ = &exports[binding.index];
+  for (Index binding_index : export_bindings.FindIndexes(name)) {
+    Export* export_ = &exports[binding_index];
     if (export_->kind == ExternalKind::Func) {
       const Func* func = env->GetFunc(export_->index);
       if (env->FuncSignaturesAreEqual(sig_index, func->sig_index)) {
@@ -276,9 +875,11 @@ Export* Module::GetExport(string_view name) {
 Index Module::AppendExport(ExternalKind kind,
                            Index item_index,
                            string_view name) {
-  exports.emplace_back(name, kind, item_index);
-  Export* export_ = &exports.back();
-  export_bindings.emplace(export_->name, Binding(exports.size() - 1));
+  // Intern the name first so the Export and the binding share one copy
+  // (export_bindings uses the same pool and gets a hit).
+  string_view interned = export_name_pool.Intern(name);
+  exports.emplace_back(interned, kind, item_index);
+  export_bindings.emplace(interned, Binding(exports.size() - 1));
   return exports.size() - 1;
 }
 
@@ -288,6 +889,29 @@ DefinedModule::DefinedModule(Environment* env)
       istream_start(kInvalidIstreamOffset),
       istream_end(kInvalidIstreamOffset) {}
 
+IstreamOffset DefinedModule::GetInstrOffset(IstreamOffset offset) const {
+  if (instr_offsets.empty() || offset < instr_offsets.front() ||
+      offset >= istream_end) {
+    return kInvalidIstreamOffset;
+  }
+  auto iter =
+      std::upper_bound(instr_offsets.begin(), instr_offsets.end(), offset);
+  return *(iter - 1);
+}
+
+IstreamOffset DefinedModule::GetPrecedingInstrOffset(
+    IstreamOffset offset) const {
+  if (instr_offsets.empty() || offset >= istream_end) {
+    return kInvalidIstreamOffset;
+  }
+  auto iter =
+      std::upper_bound(instr_offsets.begin(), instr_offsets.end(), offset);
+  if (iter - instr_offsets.begin() < 2) {
+    return kInvalidIstreamOffset;
+  }
+  return *(iter - 2);
+}
+
 HostModule::HostModule(Environment* env, string_view name)
     : Module(env, name, true) {}
 
@@ -302,7 +926,8 @@ std::pair<HostFunc*, Index> HostModule::AppendFuncExport(
     string_view name,
     const FuncSignature& sig,
     HostFunc::Callback callback) {
-  // TODO(binji): dedupe signature?
+  // A duplicate signature still compares equal by canonical index, so the
+  // extra slot only costs a little memory.
   env->EmplaceBackFuncSignature(sig);
   Index sig_index = env->GetFuncSignatureCount() - 1;
   return AppendFuncExport(name, sig_index, callback);
@@ -319,6 +944,53 @@ std::pair<HostFunc*, Index> HostModule::AppendFuncExport(
   return {host_func, export_index};
 }
 
+std::pair<HostFunc*, Index> HostModule::AppendFuncExport(
+    string_view name,
+    const FuncSignature& sig,
+    HostFunc::RawCallback callback) {
+  env->EmplaceBackFuncSignature(sig);
+  Index sig_index = env->GetFuncSignatureCount() - 1;
+  return AppendFuncExport(name, sig_index, callback);
+}
+
+std::pair<HostFunc*, Index> HostModule::AppendFuncExport(
+    string_view name,
+    Index sig_index,
+    HostFunc::RawCallback callback) {
+  auto* host_func = new HostFunc(this->name, name, sig_index, callback);
+  env->EmplaceBackFunc(host_func);
+  Index func_env_index = env->GetFuncCount() - 1;
+  Index export_index = AppendExport(ExternalKind::Func, func_env_index, name);
+  return {host_func, export_index};
+}
+
+std::pair<HostFunc*, Index> HostModule::AppendFuncExport(
+    string_view name,
+    const FuncSignature& sig,
+    HostFunc::BatchCallback callback,
+    Index batch_size) {
+  env->EmplaceBackFuncSignature(sig);
+  Index sig_index = env->GetFuncSignatureCount() - 1;
+  return AppendFuncExport(name, sig_index, callback, batch_size);
+}
+
+std::pair<HostFunc*, Index> HostModule::AppendFuncExport(
+    string_view name,
+    Index sig_index,
+    HostFunc::BatchCallback callback,
+    Index batch_size) {
+  // A batched call returns to the caller before the callback runs, so there
+  // is nowhere for results to come from.
+  assert(env->GetFuncSignature(sig_index)->result_types.empty());
+  assert(batch_size > 0);
+  auto* host_func =
+      new HostFunc(this->name, name, sig_index, callback, batch_size);
+  env->EmplaceBackFunc(host_func);
+  Index func_env_index = env->GetFuncCount() - 1;
+  Index export_index = AppendExport(ExternalKind::Func, func_env_index, name);
+  return {host_func, export_index};
+}
+
 std::pair<Table*, Index> HostModule::AppendTableExport(string_view name,
                                                        Type elem_type,
                                                        const Limits& limits) {
@@ -330,7 +1002,8 @@ std::pair<Table*, Index> HostModule::AppendTableExport(string_view name,
 
 std::pair<Memory*, Index> HostModule::AppendMemoryExport(string_view name,
                                                          const Limits& limits) {
-  Memory* memory = env->EmplaceBackMemory(limits);
+  Memory* memory = env->EmplaceBackMemory(limits, env->use_guard_pages(),
+                                          env->memory_policy());
   Index memory_env_index = env->GetMemoryCount() - 1;
   Index export_index =
       AppendExport(ExternalKind::Memory, memory_env_index, name);
@@ -386,7 +1059,7 @@ std::pair<Global*, Index> HostModule::AppendGlobalExport(string_view name,
 Environment::MarkPoint Environment::Mark() {
   MarkPoint mark;
   mark.modules_size = modules_.size();
-  mark.sigs_size = sigs_.size();
+  mark.sigs_size = sigs_->size();
   mark.funcs_size = funcs_.size();
   mark.memories_size = memories_.size();
   mark.tables_size = tables_.size();
@@ -394,10 +1067,31 @@ Environment::MarkPoint Environment::Mark() {
   mark.data_segments_size = data_segments_.size();
   mark.elem_segments_size = elem_segments_.size();
   mark.istream_size = istream_->data.size();
+  mark.call_indirect_cache_sites_size = call_indirect_cache_sites_.size();
   return mark;
 }
 
+std::unique_ptr<OutputBuffer> Environment::ReleaseIstream() {
+  std::unique_ptr<OutputBuffer> result;
+  if (istream_.use_count() == 1) {
+    result.reset(new OutputBuffer(std::move(*istream_)));
+  } else {
+    // Shared with a fork; copy so appends don't affect it.
+    result.reset(new OutputBuffer(*istream_));
+  }
+  istream_.reset();
+  istream_shared_ = false;
+  return result;
+}
+
 void Environment::ResetToMarkPoint(const MarkPoint& mark) {
+  // A fork may still be executing from the shared istream; detach our copy
+  // before truncating it and clearing the inline caches below.
+  if (istream_.use_count() != 1) {
+    istream_.reset(new OutputBuffer(*istream_));
+    istream_shared_ = false;
+  }
+
   // Destroy entries in the binding hash.
   for (size_t i = mark.modules_size; i < modules_.size(); ++i) {
     std::string name = modules_[i]->name;
@@ -408,17 +1102,29 @@ void Environment::ResetToMarkPoint(const MarkPoint& mark) {
 
   // registered_module_bindings_ maps from an arbitrary name to a module index,
   // so we have to iterate through the entire table to find entries to remove.
-  auto iter = registered_module_bindings_.begin();
-  while (iter != registered_module_bindings_.end()) {
-    if (iter->second.index >= mark.modules_size) {
-      iter = registered_module_bindings_.erase(iter);
-    } else {
-      ++iter;
+  std::vector<std::string> registered_names_to_erase;
+  for (const auto& pair : registered_module_bindings_) {
+    if (pair.second.index >= mark.modules_size) {
+      registered_names_to_erase.push_back(pair.first.to_string());
     }
   }
+  for (const std::string& name : registered_names_to_erase) {
+    registered_module_bindings_.erase(name);
+  }
 
   modules_.erase(modules_.begin() + mark.modules_size, modules_.end());
-  sigs_.erase(sigs_.begin() + mark.sigs_size, sigs_.end());
+  DetachSigsIfShared();
+  sigs_->erase(sigs_->begin() + mark.sigs_size, sigs_->end());
+  // Canonical entries for shapes first seen after the mark point to erased
+  // signatures; drop them so later registrations re-canonicalize.
+  for (auto iter = sig_canonical_map_.begin();
+       iter != sig_canonical_map_.end();) {
+    if (iter->second >= mark.sigs_size) {
+      iter = sig_canonical_map_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
   funcs_.erase(funcs_.begin() + mark.funcs_size, funcs_.end());
   memories_.erase(memories_.begin() + mark.memories_size, memories_.end());
   tables_.erase(tables_.begin() + mark.tables_size, tables_.end());
@@ -428,6 +1134,151 @@ void Environment::ResetToMarkPoint(const MarkPoint& mark) {
   elem_segments_.erase(elem_segments_.begin() + mark.elem_segments_size,
                        elem_segments_.end());
   istream_->data.resize(mark.istream_size);
+
+  // Clear the surviving call_indirect inline caches; they may refer to func
+  // indices that were just erased and will be reused by later modules.
+  call_indirect_cache_sites_.resize(mark.call_indirect_cache_sites_size);
+  for (IstreamOffset offset : call_indirect_cache_sites_) {
+    const uint32_t empty_cache[2] = {kInvalidIndex, 0};
+    memcpy(istream_->data.data() + offset, empty_cache, sizeof(empty_cache));
+  }
+}
+
+Environment::Snapshot Environment::TakeSnapshot() {
+  Snapshot snapshot;
+  snapshot.mark = Mark();
+  snapshot.memories.reserve(memories_.size());
+  for (const Memory& memory : memories_) {
+    snapshot.memories.push_back(memory.TakeSnapshot());
+  }
+  snapshot.table_entries.reserve(tables_.size());
+  for (const Table& table : tables_) {
+    snapshot.table_entries.push_back(table.entries);
+  }
+  snapshot.globals = globals_;
+  snapshot.data_segments_dropped.reserve(data_segments_.size());
+  for (const DataSegment& segment : data_segments_) {
+    snapshot.data_segments_dropped.push_back(segment.dropped);
+  }
+  snapshot.elem_segments_dropped.reserve(elem_segments_.size());
+  for (const ElemSegment& segment : elem_segments_) {
+    snapshot.elem_segments_dropped.push_back(segment.dropped);
+  }
+  return snapshot;
+}
+
+void Environment::RestoreSnapshot(const Snapshot& snapshot) {
+  ResetToMarkPoint(snapshot.mark);
+  assert(memories_.size() == snapshot.memories.size());
+  assert(tables_.size() == snapshot.table_entries.size());
+  assert(globals_.size() == snapshot.globals.size());
+  for (size_t i = 0; i < snapshot.memories.size(); ++i) {
+    memories_[i].RestoreSnapshot(snapshot.memories[i]);
+  }
+  for (size_t i = 0; i < snapshot.table_entries.size(); ++i) {
+    tables_[i].entries = snapshot.table_entries[i];
+  }
+  globals_ = snapshot.globals;
+  for (size_t i = 0; i < snapshot.data_segments_dropped.size(); ++i) {
+    data_segments_[i].dropped = snapshot.data_segments_dropped[i];
+  }
+  for (size_t i = 0; i < snapshot.elem_segments_dropped.size(); ++i) {
+    elem_segments_[i].dropped = snapshot.elem_segments_dropped[i];
+  }
+}
+
+std::unique_ptr<Environment> Environment::Fork() {
+  std::unique_ptr<Environment> fork(new Environment(features_));
+  // Immutable lowering artifacts: share. The signature table detaches on
+  // append (see DetachSigsIfShared), so later module loads on either side
+  // don't mutate it under the other.
+  fork->modules_ = modules_;
+  fork->funcs_ = funcs_;
+  fork->sigs_ = sigs_;
+  fork->istream_ = istream_;
+  istream_shared_ = fork->istream_shared_ = true;
+  // Mutable but small: copy.
+  fork->sig_canonical_map_ = sig_canonical_map_;
+  fork->tables_ = tables_;
+  fork->globals_ = globals_;
+  fork->data_segments_ = data_segments_;
+  fork->elem_segments_ = elem_segments_;
+  fork->host_objects_ = host_objects_;
+  fork->host_ref_free_head_ = host_ref_free_head_;
+  fork->host_ref_epoch_ = host_ref_epoch_;
+  fork->call_indirect_cache_sites_ = call_indirect_cache_sites_;
+  // BindingHashes intern their names, so they're rebuilt rather than copied.
+  for (const auto& pair : module_bindings_) {
+    fork->module_bindings_.emplace(pair.first, pair.second);
+  }
+  for (const auto& pair : registered_module_bindings_) {
+    fork->registered_module_bindings_.emplace(pair.first, pair.second);
+  }
+  fork->use_guard_pages_ = use_guard_pages_;
+  fork->memory_policy_ = memory_policy_;
+  // Memories: copy-on-write where possible.
+  fork->memories_.resize(memories_.size());
+  for (size_t i = 0; i < memories_.size(); ++i) {
+    fork->memories_[i].ForkFrom(memories_[i]);
+  }
+  return fork;
+}
+
+Ref Environment::NewHostRef() {
+  Index index;
+  if (host_ref_free_head_ != kInvalidIndex) {
+    index = host_ref_free_head_;
+    host_ref_free_head_ = host_objects_[index].next_free;
+  } else {
+    host_objects_.emplace_back();
+    index = host_objects_.size() - 1;
+  }
+  HostObject* object = &host_objects_[index];
+  object->epoch = host_ref_epoch_;
+  object->next_free = kInvalidIndex;
+  object->in_use = true;
+  return Ref{RefType::Host, index};
+}
+
+void Environment::KeepHostRefAlive(Ref ref) {
+  assert(ref.kind == RefType::Host && ref.index < host_objects_.size() &&
+         host_objects_[ref.index].in_use);
+  host_objects_[ref.index].epoch = host_ref_epoch_;
+}
+
+Index Environment::ReclaimHostRefs(uint64_t min_epoch) {
+  // Stamp every slot the wasm side can still reach. Tables and globals are
+  // the only places a reference survives between calls; values on a
+  // suspended thread's stack are the embedder's responsibility (reclaim at
+  // quiescent points).
+  auto stamp = [&](const Ref& ref) {
+    if (ref.kind == RefType::Host && ref.index < host_objects_.size() &&
+        host_objects_[ref.index].in_use) {
+      host_objects_[ref.index].epoch = host_ref_epoch_;
+    }
+  };
+  for (const Table& table : tables_) {
+    for (const Ref& ref : table.entries) {
+      stamp(ref);
+    }
+  }
+  for (const Global& global : globals_) {
+    if (global.type == Type::Hostref || global.type == Type::Anyref) {
+      stamp(global.typed_value.value.ref);
+    }
+  }
+
+  Index num_freed = 0;
+  for (Index i = 0; i < host_objects_.size(); ++i) {
+    HostObject* object = &host_objects_[i];
+    if (object->in_use && object->epoch < min_epoch) {
+      object->in_use = false;
+      object->next_free = host_ref_free_head_;
+      host_ref_free_head_ = i;
+      ++num_freed;
+    }
+  }
+  return num_freed;
 }
 
 HostModule* Environment::AppendHostModule(string_view name) {
@@ -513,13 +1364,26 @@ struct FloatTraits<float> {
   static const uint32_t kSignMask = 0x80000000U;
 
   static bool IsNan(uint32_t bits) {
-    return (bits > kInf && bits < kNegZero) || (bits > kNegInf);
+    // The magnitude bits of every nan, and only of a nan, exceed the
+    // infinity pattern; one masked compare, no branch.
+    return (bits & ~kSignMask) > kInf;
   }
 
   static bool IsZero(uint32_t bits) { return bits == 0 || bits == kNegZero; }
 
+  // Maps the bit pattern to an integer whose signed order matches the float
+  // order: negative values get their magnitude bits flipped, so -0.0 orders
+  // below +0.0 and nans order beyond the infinities. Lets min/max compare
+  // and select without branching; see FloatMin.
+  static int32_t OrderedKey(uint32_t bits) {
+    return static_cast<int32_t>(
+        bits ^ (static_cast<uint32_t>(static_cast<int32_t>(bits) >> 31) >> 1));
+  }
+
   static bool IsCanonicalNan(uint32_t bits) {
-    return bits == kQuietNan || bits == kQuietNegNan;
+    // kQuietNegNan is kQuietNan with the sign bit set, so masking the sign
+    // bit off checks both in one branchless compare.
+    return (bits & ~kSignMask) == kQuietNan;
   }
 
   static bool IsArithmeticNan(uint32_t bits) {
@@ -602,13 +1466,23 @@ struct FloatTraits<double> {
   static const uint64_t kSignMask = 0x8000000000000000ULL;
 
   static bool IsNan(uint64_t bits) {
-    return (bits > kInf && bits < kNegZero) || (bits > kNegInf);
+    // As in FloatTraits<float>: nan magnitude bits exceed the infinity
+    // pattern.
+    return (bits & ~kSignMask) > kInf;
   }
 
   static bool IsZero(uint64_t bits) { return bits == 0 || bits == kNegZero; }
 
+  // See FloatTraits<float>::OrderedKey.
+  static int64_t OrderedKey(uint64_t bits) {
+    return static_cast<int64_t>(
+        bits ^ (static_cast<uint64_t>(static_cast<int64_t>(bits) >> 63) >> 1));
+  }
+
   static bool IsCanonicalNan(uint64_t bits) {
-    return bits == kQuietNan || bits == kQuietNegNan;
+    // As in FloatTraits<float>, mask off the sign bit to accept both the
+    // positive and negative canonical nan without branching.
+    return (bits & ~kSignMask) == kQuietNan;
   }
 
   static bool IsArithmeticNan(uint64_t bits) {
@@ -799,19 +1673,69 @@ ValueTypeRep<double> CanonicalizeNan<double>(ValueTypeRep<double> rep) {
     }                          \
   } while (0)
 
+// TrapMsg (Thread and Executor each have one) is cold and out of line, so
+// the formatting code and its arguments stay off the no-trap path.
 #define TRAP_MSG(type, ...) \
-  return Result(ResultType::Trap##type, StringPrintf(__VA_ARGS__))
+  return TrapMsg(ResultType::Trap##type, __VA_ARGS__)
+
+// Dispatch macros for the instruction loop in Thread::Run. When the compiler
+// supports taking the address of a label (GCC and Clang), each opcode handler
+// jumps directly to the next handler through a per-opcode dispatch table
+// instead of bouncing through a central switch. This gives each handler its
+// own dispatch branch, which predicts much better on instruction-dense code.
+// Otherwise, WABT_OP/WABT_NEXT expand to an ordinary case/break and the
+// surrounding switch is used.
+#if HAVE_COMPUTED_GOTO
+
+#define WABT_USE_COMPUTED_GOTO 1
+#define WABT_OP(name) op_##name:
+#define WABT_NEXT()                                                       \
+  do {                                                                    \
+    if (WABT_UNLIKELY(single_step_)) {                                    \
+      goto exit_loop;                                                     \
+    }                                                                     \
+    opcode = ReadOpcode(&pc);                                             \
+    assert(!opcode.IsInvalid());                                          \
+    WABT_PROFILE_SAMPLE();                                                \
+    goto* s_dispatch_table[static_cast<uint32_t>(Opcode::Enum(opcode))];  \
+  } while (0)
+
+#else
+
+#define WABT_USE_COMPUTED_GOTO 0
+#define WABT_OP(name) case Opcode::name:
+#define WABT_NEXT() break
+
+#endif
 
-#define CHECK_STACK() \
-  TRAP_IF(value_stack_top_ >= value_stack_.size(), ValueStackExhausted)
+// Expanded inside Thread::Run, where |opcode|, |pc| and |istream| are in
+// scope; costs a predicted branch per instruction when profiling is off.
+#define WABT_PROFILE_SAMPLE()                                   \
+  do {                                                          \
+    if (WABT_UNLIKELY(profiling_)) {                            \
+      ProfileSample(opcode, static_cast<IstreamOffset>(pc - istream)); \
+    }                                                           \
+  } while (0)
 
 #define PUSH_NEG_1_AND_BREAK_IF(cond) \
   if (WABT_UNLIKELY(cond)) {          \
     CHECK_TRAP(Push<int32_t>(-1));    \
-    break;                            \
+    WABT_NEXT();                      \
   }
 
-#define GOTO(offset) pc = &istream[offset]
+// Every taken branch and call transfers control through GOTO, so consuming
+// fuel here meters exactly the control-flow edges (loop back-edges, calls,
+// forward jumps) that can make execution unbounded; straight-line code
+// between them runs without a per-instruction counter (see Thread::Run).
+// The pc is updated before exiting, so a resumed Run continues at the
+// branch target.
+#define GOTO(offset)                  \
+  do {                                \
+    pc = &istream[offset];            \
+    if (WABT_UNLIKELY(--fuel == 0)) { \
+      goto exit_loop;                 \
+    }                                 \
+  } while (0)
 
 Memory* Thread::ReadMemory(const uint8_t** pc) {
   Index memory_index = ReadU32(pc);
@@ -823,30 +1747,69 @@ Table* Thread::ReadTable(const uint8_t** pc) {
   return &env_->tables_[table_index];
 }
 
+// Fill in the call_indirect inline cache that immediately precedes |pc|; see
+// the CallIndirect handler in Run.
+void Thread::CacheIndirectCall(const uint8_t* pc,
+                               Index func_index,
+                               IstreamOffset offset) {
+  if (env_->istream_shared_) {
+    // The istream may be shared with forked environments running on other
+    // threads; don't write into it.
+    return;
+  }
+  uint8_t* cache = env_->istream_->data.data() + (pc - GetIstream()) -
+                   2 * sizeof(uint32_t);
+  memcpy(cache, &func_index, sizeof(uint32_t));
+  memcpy(cache + sizeof(uint32_t), &offset, sizeof(uint32_t));
+}
+
 template <typename MemType>
-Result Thread::GetAccessAddress(const uint8_t** pc, void** out_address) {
-  Memory* memory = ReadMemory(pc);
-  uint64_t addr = static_cast<uint64_t>(Pop<uint32_t>()) + ReadU32(pc);
-  if (addr + sizeof(MemType) > memory->data.size()) {
+ResultType Thread::GetAccessAddress(const uint8_t** pc, void** out_address) {
+  return GetAccessAddressAt<MemType>(pc, Pop<uint32_t>(), out_address);
+}
+
+// Like GetAccessAddress, but takes the base address as an argument instead of
+// popping it, for handlers that leave the operand's stack slot in place.
+template <typename MemType>
+ResultType Thread::GetAccessAddressAt(const uint8_t** pc,
+                                  uint32_t base,
+                                  void** out_address) {
+  // Both immediates are fetched with fixed-offset unaligned loads and |*pc|
+  // advances once, so the second load doesn't wait on the first pc update.
+  Memory* memory = &env_->memories_[ReadU32At(*pc)];
+  uint64_t addr = static_cast<uint64_t>(base) + ReadU32At(*pc + sizeof(uint32_t));
+  *pc += 2 * sizeof(uint32_t);
+#if WABT_HAS_GUARD_PAGES
+  if (WABT_LIKELY(memory->has_guard_pages())) {
+    // Any 32-bit address plus 32-bit offset lands inside the reservation; an
+    // out-of-bounds access faults on a guard page and is turned back into a
+    // trap by GuardFaultHandler.
+    *out_address = memory->data_begin() + addr;
+    return ResultType::Ok;
+  }
+#endif
+  if (addr + sizeof(MemType) > memory->data_size()) {
     TRAP_MSG(MemoryAccessOutOfBounds,
              "access at %" PRIu64 "+%" PRIzd " >= max value %" PRIzd, addr,
-             sizeof(MemType), memory->data.size());
+             sizeof(MemType), memory->data_size());
   }
-  *out_address = memory->data.data() + static_cast<IstreamOffset>(addr);
+  *out_address = memory->data_begin() + static_cast<IstreamOffset>(addr);
   return ResultType::Ok;
 }
 
 template <typename MemType>
-Result Thread::GetAtomicAccessAddress(const uint8_t** pc, void** out_address) {
-  Memory* memory = ReadMemory(pc);
-  uint64_t addr = static_cast<uint64_t>(Pop<uint32_t>()) + ReadU32(pc);
-  if (addr + sizeof(MemType) > memory->data.size()) {
+ResultType Thread::GetAtomicAccessAddress(const uint8_t** pc, void** out_address) {
+  Memory* memory = &env_->memories_[ReadU32At(*pc)];
+  uint64_t addr =
+      static_cast<uint64_t>(Pop<uint32_t>()) + ReadU32At(*pc + sizeof(uint32_t));
+  *pc += 2 * sizeof(uint32_t);
+  if (addr + sizeof(MemType) > memory->data_size()) {
     TRAP_MSG(MemoryAccessOutOfBounds,
              "atomic access at %" PRIu64 "+%" PRIzd " >= max value %" PRIzd,
-             addr, sizeof(MemType), memory->data.size());
+             addr, sizeof(MemType), memory->data_size());
   }
   TRAP_IF((addr & (sizeof(MemType) - 1)) != 0, AtomicMemoryAccessUnaligned);
-  *out_address = memory->data.data() + static_cast<IstreamOffset>(addr);
+  *out_address = memory->data_begin() + static_cast<IstreamOffset>(addr);
   return ResultType::Ok;
 }
 
@@ -874,10 +1837,29 @@ void Thread::Reset() {
   pc_ = 0;
   value_stack_top_ = 0;
   call_stack_top_ = 0;
-}
-
-Result Thread::Push(Value value) {
-  CHECK_STACK();
+  trap_message_.clear();
+}
+
+ResultType Thread::TrapMsg(ResultType type, const char* format, ...) {
+  va_list args;
+  va_list args_copy;
+  va_start(args, format);
+  va_copy(args_copy, args);
+  size_t len = wabt_vsnprintf(nullptr, 0, format, args) + 1;  // For \0.
+  va_end(args);
+  trap_message_.resize(len);
+  wabt_vsnprintf(&trap_message_[0], len, format, args_copy);
+  va_end(args_copy);
+  trap_message_.resize(len - 1);
+  return type;
+}
+
+// Unchecked: the stack_check instruction at each function's entry reserves
+// room for the function's peak operand depth, so pushes from lowered code can
+// never overflow. Pushes from outside the interpreter loop must first check
+// HasValueStackRoom. The ResultType return is kept so the many CHECK_TRAP
+// call sites fold to nothing.
+ResultType Thread::Push(Value value) {
   value_stack_[value_stack_top_++] = value;
   return ResultType::Ok;
 }
@@ -892,7 +1874,7 @@ Value Thread::ValueAt(Index at) const {
 }
 
 template <typename T>
-Result Thread::Push(T value) {
+ResultType Thread::Push(T value) {
   return PushRep<T>(ToRep(value));
 }
 
@@ -902,7 +1884,7 @@ T Thread::Pop() {
 }
 
 template <typename T>
-Result Thread::PushRep(ValueTypeRep<T> value) {
+ResultType Thread::PushRep(ValueTypeRep<T> value) {
   return Push(MakeValue<T>(value));
 }
 
@@ -912,20 +1894,31 @@ ValueTypeRep<T> Thread::PopRep() {
 }
 
 void Thread::DropKeep(uint32_t drop_count, uint32_t keep_count) {
-  // Copy backward to avoid clobbering when the regions overlap.
-  for (uint32_t i = keep_count; i > 0; --i) {
-    Pick(drop_count + i) = Pick(i);
-  }
+  // The kept slots slide down over the dropped ones, so the ranges may
+  // overlap; memmove handles that in one bulk move.
+  Value* stack_top = value_stack_.data() + value_stack_top_;
+  memmove(stack_top - drop_count - keep_count, stack_top - keep_count,
+          keep_count * sizeof(Value));
   value_stack_top_ -= drop_count;
 }
 
-Result Thread::PushCall(const uint8_t* pc) {
+ResultType Thread::RunJitFunc(DefinedFunc* func) {
+  Value* top = value_stack_.data() + value_stack_top_;
+  Value* end = value_stack_.data() + value_stack_.size();
+  Value* new_top = top;
+  uint32_t jit_result = func->jit_func->entry()(top, end, &new_top);
+  value_stack_top_ = new_top - value_stack_.data();
+  TRAP_IF(jit_result != JitFunc::kOk, ValueStackExhausted);
+  return ResultType::Ok;
+}
+
+ResultType Thread::PushCall(const uint8_t* pc) {
   TRAP_IF(call_stack_top_ >= call_stack_.size(), CallStackExhausted);
-  call_stack_[call_stack_top_++] = pc - GetIstream();
+  call_stack_[call_stack_top_++] = pc;
   return ResultType::Ok;
 }
 
-IstreamOffset Thread::PopCall() {
+const uint8_t* Thread::PopCall() {
   return call_stack_[--call_stack_top_];
 }
 
@@ -939,80 +1932,265 @@ void StoreToMemory(void* dst, T value) {
   memcpy(dst, &value, sizeof(T));
 }
 
+// Atomic accesses to linear memory, so threads of the same Environment (or
+// of forks sharing a memory) can run wasm atomics from different OS threads.
+// Alignment is already checked by GetAtomicAccessAddress, so the compiler
+// builtins are lock-free for every size used here.
+#if defined(_MSC_VER)
+
+// MSVC has no __atomic builtins; serialize atomic accesses with one mutex.
+// Correct across threads, just not lock-free.
+static std::mutex s_atomic_memory_mutex;
+
+template <typename T>
+T AtomicLoadMemory(void* addr) {
+  std::lock_guard<std::mutex> lock(s_atomic_memory_mutex);
+  T value;
+  LoadFromMemory<T>(&value, addr);
+  return value;
+}
+
+template <typename T>
+void AtomicStoreMemory(void* addr, T value) {
+  std::lock_guard<std::mutex> lock(s_atomic_memory_mutex);
+  StoreToMemory<T>(addr, value);
+}
+
+template <typename T, typename F>
+T AtomicRmwMemory(void* addr, F&& func) {
+  std::lock_guard<std::mutex> lock(s_atomic_memory_mutex);
+  T old;
+  LoadFromMemory<T>(&old, addr);
+  StoreToMemory<T>(addr, func(old));
+  return old;
+}
+
+template <typename T>
+T AtomicCmpxchgMemory(void* addr, T expect, T replace) {
+  std::lock_guard<std::mutex> lock(s_atomic_memory_mutex);
+  T read;
+  LoadFromMemory<T>(&read, addr);
+  if (read == expect) {
+    StoreToMemory<T>(addr, replace);
+  }
+  return read;
+}
+
+#else
+
+template <typename T>
+T AtomicLoadMemory(void* addr) {
+  T value;
+  __atomic_load(static_cast<T*>(addr), &value, __ATOMIC_SEQ_CST);
+  return value;
+}
+
+template <typename T>
+void AtomicStoreMemory(void* addr, T value) {
+  __atomic_store(static_cast<T*>(addr), &value, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename F>
+T AtomicRmwMemory(void* addr, F&& func) {
+  // There's no generic fetch-op builtin, so run the op in a CAS loop; on
+  // failure the builtin refreshes |old| with the current value.
+  T* p = static_cast<T*>(addr);
+  T old = AtomicLoadMemory<T>(addr);
+  for (;;) {
+    T desired = func(old);
+    if (__atomic_compare_exchange(p, &old, &desired, false, __ATOMIC_SEQ_CST,
+                                  __ATOMIC_SEQ_CST)) {
+      return old;
+    }
+  }
+}
+
+template <typename T>
+T AtomicCmpxchgMemory(void* addr, T expect, T replace) {
+  __atomic_compare_exchange(static_cast<T*>(addr), &expect, &replace, false,
+                            __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return expect;
+}
+
+#endif
+
+// Bucketed futex table backing atomic.wait/atomic.notify. A waiter blocks on
+// its address bucket's condition variable; the expected-value check happens
+// under the bucket lock, which notifiers also hold, so a notify between the
+// check and the sleep can't be lost. Process-wide since a shared memory can
+// be reached from several Environments.
+class FutexTable {
+ public:
+  static FutexTable& Get() {
+    static FutexTable s_table;
+    return s_table;
+  }
+
+  // Returns 0 ("ok") when notified, 1 ("not-equal") when the memory doesn't
+  // hold |expected|, or 2 ("timed-out") when |timeout_ns| elapses first;
+  // a negative timeout waits forever.
+  template <typename T>
+  uint32_t Wait(void* addr, T expected, int64_t timeout_ns) {
+    Bucket& bucket = GetBucket(addr);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (AtomicLoadMemory<T>(addr) != expected) {
+      return 1;
+    }
+    Waiter waiter;
+    waiter.addr = addr;
+    bucket.waiters.push_back(&waiter);
+    if (timeout_ns < 0) {
+      while (!waiter.notified) {
+        bucket.cond.wait(lock);
+      }
+    } else {
+      auto deadline = std::chrono::steady_clock::now() +
+                      std::chrono::nanoseconds(timeout_ns);
+      while (!waiter.notified) {
+        if (bucket.cond.wait_until(lock, deadline) ==
+            std::cv_status::timeout) {
+          break;
+        }
+      }
+    }
+    bucket.waiters.erase(
+        std::find(bucket.waiters.begin(), bucket.waiters.end(), &waiter));
+    return waiter.notified ? 0 : 2;
+  }
+
+  // Marks up to |count| waiters on |addr| as notified, in wait order, and
+  // returns how many were woken.
+  uint32_t Notify(void* addr, uint32_t count) {
+    Bucket& bucket = GetBucket(addr);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    uint32_t woken = 0;
+    for (Waiter* waiter : bucket.waiters) {
+      if (woken == count) {
+        break;
+      }
+      if (waiter->addr == addr && !waiter->notified) {
+        waiter->notified = true;
+        ++woken;
+      }
+    }
+    if (woken > 0) {
+      bucket.cond.notify_all();
+    }
+    return woken;
+  }
+
+ private:
+  struct Waiter {
+    void* addr = nullptr;
+    bool notified = false;
+  };
+
+  struct Bucket {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<Waiter*> waiters;  // In wait order, for FIFO wakeup.
+  };
+
+  static const size_t kBuckets = 64;
+
+  Bucket& GetBucket(void* addr) {
+    return buckets_[(reinterpret_cast<uintptr_t>(addr) >> 2) % kBuckets];
+  }
+
+  Bucket buckets_[kBuckets];
+};
+
 template <typename MemType, typename ResultValueType>
-Result Thread::Load(const uint8_t** pc) {
+ResultType Thread::Load(const uint8_t** pc) {
   typedef typename ExtendMemType<ResultValueType, MemType>::type ExtendedType;
   static_assert(std::is_floating_point<MemType>::value ==
                     std::is_floating_point<ExtendedType>::value,
                 "Extended type should be float iff MemType is float");
 
-  void* src;
-  CHECK_TRAP(GetAccessAddress<MemType>(pc, &src));
+  // A load pops its address and pushes its result, so the stack depth is
+  // unchanged; write the result into the address's slot instead of going
+  // through the bounds-checked Push.
+  Value& slot = Top();
+  void* src = nullptr;
+  CHECK_TRAP(GetAccessAddressAt<MemType>(pc, GetValue<uint32_t>(slot), &src));
   MemType value;
   LoadFromMemory<MemType>(&value, src);
-  return Push<ResultValueType>(static_cast<ExtendedType>(value));
+  slot = MakeValue<ResultValueType>(
+      ToRep(static_cast<ExtendedType>(value)));
+  return ResultType::Ok;
 }
 
 template <typename MemType, typename ResultValueType>
-Result Thread::Store(const uint8_t** pc) {
+ResultType Thread::Store(const uint8_t** pc) {
   typedef typename WrapMemType<ResultValueType, MemType>::type WrappedType;
   WrappedType value = PopRep<ResultValueType>();
-  void* dst;
+  void* dst = nullptr;
   CHECK_TRAP(GetAccessAddress<MemType>(pc, &dst));
   StoreToMemory<WrappedType>(dst, value);
   return ResultType::Ok;
 }
 
 template <typename MemType, typename ResultValueType>
-Result Thread::AtomicLoad(const uint8_t** pc) {
+ResultType Thread::AtomicLoad(const uint8_t** pc) {
   typedef typename ExtendMemType<ResultValueType, MemType>::type ExtendedType;
   static_assert(!std::is_floating_point<MemType>::value,
                 "AtomicLoad type can't be float");
-  void* src;
+  void* src = nullptr;
   CHECK_TRAP(GetAtomicAccessAddress<MemType>(pc, &src));
-  MemType value;
-  LoadFromMemory<MemType>(&value, src);
+  MemType value = AtomicLoadMemory<MemType>(src);
   return Push<ResultValueType>(static_cast<ExtendedType>(value));
 }
 
 template <typename MemType, typename ResultValueType>
-Result Thread::AtomicStore(const uint8_t** pc) {
+ResultType Thread::AtomicStore(const uint8_t** pc) {
   typedef typename WrapMemType<ResultValueType, MemType>::type WrappedType;
   WrappedType value = PopRep<ResultValueType>();
-  void* dst;
+  void* dst = nullptr;
   CHECK_TRAP(GetAtomicAccessAddress<MemType>(pc, &dst));
-  StoreToMemory<WrappedType>(dst, value);
+  AtomicStoreMemory<WrappedType>(dst, value);
   return ResultType::Ok;
 }
 
 template <typename MemType, typename ResultValueType>
-Result Thread::AtomicRmw(BinopFunc<ResultValueType, ResultValueType> func,
+ResultType Thread::AtomicRmw(BinopFunc<ResultValueType, ResultValueType> func,
                          const uint8_t** pc) {
   typedef typename ExtendMemType<ResultValueType, MemType>::type ExtendedType;
   MemType rhs = PopRep<ResultValueType>();
-  void* addr;
+  void* addr = nullptr;
   CHECK_TRAP(GetAtomicAccessAddress<MemType>(pc, &addr));
-  MemType read;
-  LoadFromMemory<MemType>(&read, addr);
-  StoreToMemory<MemType>(addr, func(read, rhs));
+  MemType read = AtomicRmwMemory<MemType>(addr, [&](MemType old) {
+    return static_cast<MemType>(func(old, rhs));
+  });
   return Push<ResultValueType>(static_cast<ExtendedType>(read));
 }
 
 template <typename MemType, typename ResultValueType>
-Result Thread::AtomicRmwCmpxchg(const uint8_t** pc) {
+ResultType Thread::AtomicRmwCmpxchg(const uint8_t** pc) {
   typedef typename ExtendMemType<ResultValueType, MemType>::type ExtendedType;
   MemType replace = PopRep<ResultValueType>();
   MemType expect = PopRep<ResultValueType>();
-  void* addr;
+  void* addr = nullptr;
   CHECK_TRAP(GetAtomicAccessAddress<MemType>(pc, &addr));
-  MemType read;
-  LoadFromMemory<MemType>(&read, addr);
-  if (read == expect) {
-    StoreToMemory<MemType>(addr, replace);
-  }
+  MemType read = AtomicCmpxchgMemory<MemType>(addr, expect, replace);
   return Push<ResultValueType>(static_cast<ExtendedType>(read));
 }
 
+template <typename MemType>
+ResultType Thread::AtomicWait(const uint8_t** pc) {
+  int64_t timeout_ns = Pop<uint64_t>();
+  MemType expected = Pop<MemType>();
+  void* addr = nullptr;
+  CHECK_TRAP(GetAtomicAccessAddress<MemType>(pc, &addr));
+  return Push<uint32_t>(FutexTable::Get().Wait(addr, expected, timeout_ns));
+}
+
+ResultType Thread::AtomicNotify(const uint8_t** pc) {
+  uint32_t count = Pop<uint32_t>();
+  void* addr = nullptr;
+  CHECK_TRAP(GetAtomicAccessAddress<uint32_t>(pc, &addr));
+  return Push<uint32_t>(FutexTable::Get().Notify(addr, count));
+}
+
 bool ClampToBounds(uint32_t start, uint32_t* length, uint32_t max) {
   if (start > max) {
     *length = 0;
@@ -1026,10 +2204,10 @@ bool ClampToBounds(uint32_t start, uint32_t* length, uint32_t max) {
   return true;
 }
 
-Result Thread::MemoryInit(const uint8_t** pc) {
+ResultType Thread::MemoryInit(const uint8_t** pc) {
   Memory* memory = ReadMemory(pc);
   DataSegment* segment = ReadDataSegment(pc);
-  uint32_t memory_size = memory->data.size();
+  uint32_t memory_size = memory->data_size();
   uint32_t segment_size = segment->data.size();
   uint32_t size = Pop<uint32_t>();
   uint32_t src = Pop<uint32_t>();
@@ -1041,21 +2219,21 @@ Result Thread::MemoryInit(const uint8_t** pc) {
     if (!ok) {
       TRAP_MSG(MemoryAccessOutOfBounds, "memory.init out of bounds");
     }
-    memcpy(memory->data.data() + dst, segment->data.data() + src, size);
+    memcpy(memory->data_begin() + dst, segment->data.data() + src, size);
   }
   return ResultType::Ok;
 }
 
-Result Thread::DataDrop(const uint8_t** pc) {
+ResultType Thread::DataDrop(const uint8_t** pc) {
   DataSegment* segment = ReadDataSegment(pc);
   TRAP_IF(segment->dropped, DataSegmentDropped);
   segment->dropped = true;
   return ResultType::Ok;
 }
 
-Result Thread::MemoryCopy(const uint8_t** pc) {
+ResultType Thread::MemoryCopy(const uint8_t** pc) {
   Memory* memory = ReadMemory(pc);
-  uint32_t memory_size = memory->data.size();
+  uint32_t memory_size = memory->data_size();
   uint32_t size = Pop<uint32_t>();
   uint32_t src = Pop<uint32_t>();
   uint32_t dst = Pop<uint32_t>();
@@ -1065,15 +2243,16 @@ Result Thread::MemoryCopy(const uint8_t** pc) {
     if (!ok) {
       TRAP_MSG(MemoryAccessOutOfBounds, "memory.copy out of bound");
     }
-    char* data = memory->data.data();
+    // The spec allows the ranges to overlap, so this must be memmove.
+    char* data = memory->data_begin();
     memmove(data + dst, data + src, size);
   }
   return ResultType::Ok;
 }
 
-Result Thread::MemoryFill(const uint8_t** pc) {
+ResultType Thread::MemoryFill(const uint8_t** pc) {
   Memory* memory = ReadMemory(pc);
-  uint32_t memory_size = memory->data.size();
+  uint32_t memory_size = memory->data_size();
   uint32_t size = Pop<uint32_t>();
   uint8_t value = static_cast<uint8_t>(Pop<uint32_t>());
   uint32_t dst = Pop<uint32_t>();
@@ -1082,12 +2261,12 @@ Result Thread::MemoryFill(const uint8_t** pc) {
     if (!ok) {
       TRAP_MSG(MemoryAccessOutOfBounds, "memory.fill out of bounds");
     }
-    memset(memory->data.data() + dst, value, size);
+    memset(memory->data_begin() + dst, value, size);
   }
   return ResultType::Ok;
 }
 
-Result Thread::TableInit(const uint8_t** pc) {
+ResultType Thread::TableInit(const uint8_t** pc) {
   Table* table = ReadTable(pc);
   ElemSegment* segment = ReadElemSegment(pc);
   uint32_t segment_size = segment->elems.size();
@@ -1107,7 +2286,7 @@ Result Thread::TableInit(const uint8_t** pc) {
   return ResultType::Ok;
 }
 
-Result Thread::TableSet(const uint8_t** pc) {
+ResultType Thread::TableSet(const uint8_t** pc) {
   Table* table = ReadTable(pc);
   Ref ref = Pop<Ref>();
   uint32_t index = Pop<uint32_t>();
@@ -1119,7 +2298,7 @@ Result Thread::TableSet(const uint8_t** pc) {
   return ResultType::Ok;
 }
 
-Result Thread::TableGet(const uint8_t** pc) {
+ResultType Thread::TableGet(const uint8_t** pc) {
   Table* table = ReadTable(pc);
   uint32_t index = Pop<uint32_t>();
   if (index >= table->size()) {
@@ -1130,14 +2309,14 @@ Result Thread::TableGet(const uint8_t** pc) {
   return Push(ref);
 }
 
-Result Thread::ElemDrop(const uint8_t** pc) {
+ResultType Thread::ElemDrop(const uint8_t** pc) {
   ElemSegment* segment = ReadElemSegment(pc);
   TRAP_IF(segment->dropped, ElemSegmentDropped);
   segment->dropped = true;
   return ResultType::Ok;
 }
 
-Result Thread::TableCopy(const uint8_t** pc) {
+ResultType Thread::TableCopy(const uint8_t** pc) {
   Table* src_table = ReadTable(pc);
   Table* dst_table = ReadTable(pc);
   assert(src_table == dst_table);
@@ -1146,10 +2325,11 @@ Result Thread::TableCopy(const uint8_t** pc) {
   uint32_t dst = Pop<uint32_t>();
   if (size > 0) {
     bool ok = ClampToBounds(dst, &size, dst_table->size());
-    ok &= ClampToBounds(src, &size, dst_table->size());
+    ok &= ClampToBounds(src, &size, src_table->size());
     if (!ok) {
       TRAP_MSG(TableAccessOutOfBounds, "table.copy out of bounds");
     }
+    // The spec allows the ranges to overlap, so this must be memmove.
     Ref* data_src = src_table->entries.data();
     Ref* data_dst = dst_table->entries.data();
     memmove(data_dst + dst, data_src + src, size * sizeof(Ref));
@@ -1157,21 +2337,21 @@ Result Thread::TableCopy(const uint8_t** pc) {
   return ResultType::Ok;
 }
 
-Result Thread::RefFunc(const uint8_t** pc) {
+ResultType Thread::RefFunc(const uint8_t** pc) {
   uint32_t index = ReadU32(pc);
   assert(index < env_->GetFuncCount());
   return Push(Ref{RefType::Func, index});
 }
 
 template <typename R, typename T>
-Result Thread::Unop(UnopFunc<R, T> func) {
+ResultType Thread::Unop(UnopFunc<R, T> func) {
   auto value = PopRep<T>();
   return PushRep<R>(func(value));
 }
 
 // {i8, i16, 132, i64}{16, 8, 4, 2}.(neg)
 template <typename T, typename L, typename R, typename P>
-Result Thread::SimdUnop(UnopFunc<R, P> func) {
+ResultType Thread::SimdUnop(UnopFunc<R, P> func) {
   auto value = PopRep<T>();
 
   // Calculate how many Lanes according to input lane data type.
@@ -1193,7 +2373,7 @@ Result Thread::SimdUnop(UnopFunc<R, P> func) {
 }
 
 template <typename R, typename T>
-Result Thread::UnopTrap(UnopTrapFunc<R, T> func) {
+ResultType Thread::UnopTrap(UnopTrapFunc<R, T> func) {
   auto value = PopRep<T>();
   ValueTypeRep<R> result_value;
   CHECK_TRAP(func(value, &result_value));
@@ -1201,15 +2381,20 @@ Result Thread::UnopTrap(UnopTrapFunc<R, T> func) {
 }
 
 template <typename R, typename T>
-Result Thread::Binop(BinopFunc<R, T> func) {
+ResultType Thread::Binop(BinopFunc<R, T> func) {
   auto rhs_rep = PopRep<T>();
   auto lhs_rep = PopRep<T>();
   return PushRep<R>(func(lhs_rep, rhs_rep));
 }
 
+template <typename R, typename T>
+ResultType Thread::LocalBinop(BinopFunc<R, T> func, Value lhs, Value rhs) {
+  return PushRep<R>(func(GetValue<T>(lhs), GetValue<T>(rhs)));
+}
+
 // {i8, i16, 132, i64}{16, 8, 4, 2}.(add/sub/mul)
 template <typename T, typename L, typename R, typename P>
-Result Thread::SimdBinop(BinopFunc<R, P> func) {
+ResultType Thread::SimdBinop(BinopFunc<R, P> func) {
   auto rhs_rep = PopRep<T>();
   auto lhs_rep = PopRep<T>();
 
@@ -1235,7 +2420,7 @@ Result Thread::SimdBinop(BinopFunc<R, P> func) {
 
 // {i8, i16, 132, i64, f32, f64}{16, 8, 4, 2}.(eq/ne/lt/le/gt/ge)
 template <typename T, typename L, typename R, typename P>
-Result Thread::SimdRelBinop(BinopFunc<R, P> func) {
+ResultType Thread::SimdRelBinop(BinopFunc<R, P> func) {
   auto rhs_rep = PopRep<T>();
   auto lhs_rep = PopRep<T>();
 
@@ -1261,8 +2446,156 @@ Result Thread::SimdRelBinop(BinopFunc<R, P> func) {
   return PushRep<T>(Bitcast<T>(simd_data_ret));
 }
 
+// Native v128 arithmetic. GCC and clang can express a 16-byte vector directly
+// with __attribute__((vector_size(16))); arithmetic on such a type lowers to
+// a single SIMD instruction on targets where 128-bit vectors are baseline
+// (SSE2 on x86-64, NEON on aarch64) with an automatic scalar fallback
+// elsewhere, so no runtime CPU dispatch is needed. Only opcodes whose lane
+// semantics match the hardware exactly are routed through here; everything
+// else (saturating ops, shifts, min/max, ...) stays on the lane loops above.
+#if defined(__GNUC__) || defined(__clang__)
+#define WABT_HAS_SIMD_VECTOR_EXT 1
+
+typedef uint8_t u8x16 __attribute__((vector_size(16)));
+typedef uint16_t u16x8 __attribute__((vector_size(16)));
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+typedef uint64_t u64x2 __attribute__((vector_size(16)));
+typedef float f32x4 __attribute__((vector_size(16)));
+typedef double f64x2 __attribute__((vector_size(16)));
+
+template <typename V, typename S>
+V VecSplat(S value) {
+  V result;
+  for (size_t i = 0; i < sizeof(V) / sizeof(S); ++i) {
+    result[i] = value;
+  }
+  return result;
+}
+
+// Replaces every NaN lane with the canonical quiet NaN, matching what
+// CanonicalizeNan does per lane in the scalar float helpers. The NaN mask is
+// built with a lane-wise self-comparison (true lanes compare to all-ones) and
+// blended on the integer lanes.
+f32x4 CanonicalizeNanLanes(f32x4 value) {
+  u32x4 mask = Bitcast<u32x4>(value != value);
+  u32x4 bits = Bitcast<u32x4>(value);
+  bits = (bits & ~mask) | (VecSplat<u32x4>(FloatTraits<float>::kQuietNan) &
+                           mask);
+  return Bitcast<f32x4>(bits);
+}
+
+f64x2 CanonicalizeNanLanes(f64x2 value) {
+  u64x2 mask = Bitcast<u64x2>(value != value);
+  u64x2 bits = Bitcast<u64x2>(value);
+  bits = (bits & ~mask) | (VecSplat<u64x2>(FloatTraits<double>::kQuietNan) &
+                           mask);
+  return Bitcast<f64x2>(bits);
+}
+
+// Integer lanes wrap on overflow, exactly like the scalar Add/Sub/Mul
+// helpers operating on the unsigned lane representation.
+template <typename V>
+struct VecAdd {
+  V operator()(V lhs, V rhs) const { return lhs + rhs; }
+};
+
+template <typename V>
+struct VecSub {
+  V operator()(V lhs, V rhs) const { return lhs - rhs; }
+};
+
+template <typename V>
+struct VecMul {
+  V operator()(V lhs, V rhs) const { return lhs * rhs; }
+};
+
+template <typename V>
+struct VecNeg {
+  V operator()(V value) const { return V{} - value; }
+};
+
+template <typename V>
+struct VecAnd {
+  V operator()(V lhs, V rhs) const { return lhs & rhs; }
+};
+
+template <typename V>
+struct VecOr {
+  V operator()(V lhs, V rhs) const { return lhs | rhs; }
+};
+
+template <typename V>
+struct VecXor {
+  V operator()(V lhs, V rhs) const { return lhs ^ rhs; }
+};
+
+template <typename V>
+struct VecNot {
+  V operator()(V value) const { return ~value; }
+};
+
+// Float lanes follow IEEE arithmetic, which the scalar helpers also rely on;
+// only the NaN lanes need canonicalizing afterwards.
+template <typename V>
+struct VecFloatAdd {
+  V operator()(V lhs, V rhs) const { return CanonicalizeNanLanes(lhs + rhs); }
+};
+
+template <typename V>
+struct VecFloatSub {
+  V operator()(V lhs, V rhs) const { return CanonicalizeNanLanes(lhs - rhs); }
+};
+
+template <typename V>
+struct VecFloatMul {
+  V operator()(V lhs, V rhs) const { return CanonicalizeNanLanes(lhs * rhs); }
+};
+
+template <typename V>
+struct VecFloatDiv {
+  V operator()(V lhs, V rhs) const { return CanonicalizeNanLanes(lhs / rhs); }
+};
+
+// Float negate is a pure sign-bit flip (see the scalar FloatNeg), so it is
+// done on the integer lanes and never canonicalizes.
+struct VecFloatNegF32 {
+  u32x4 operator()(u32x4 value) const {
+    return value ^ VecSplat<u32x4>(FloatTraits<float>::kSignMask);
+  }
+};
+
+struct VecFloatNegF64 {
+  u64x2 operator()(u64x2 value) const {
+    return value ^ VecSplat<u64x2>(FloatTraits<double>::kSignMask);
+  }
+};
+
+template <typename V, typename Op>
+ResultType Thread::SimdNativeUnop(Op op) {
+  auto value = PopRep<v128>();
+  return PushRep<v128>(Bitcast<v128>(op(Bitcast<V>(value))));
+}
+
+template <typename V, typename Op>
+ResultType Thread::SimdNativeBinop(Op op) {
+  auto rhs_rep = PopRep<v128>();
+  auto lhs_rep = PopRep<v128>();
+  return PushRep<v128>(Bitcast<v128>(op(Bitcast<V>(lhs_rep),
+                                        Bitcast<V>(rhs_rep))));
+}
+
+// Route a v128 opcode to the native kernel, or to the scalar lane loop when
+// vector extensions are unavailable. The fallback arguments mirror the
+// existing SimdUnop/SimdBinop call sites exactly.
+#define SIMD_NATIVE_UNOP(vec, op, lane, func) SimdNativeUnop<vec>(op())
+#define SIMD_NATIVE_BINOP(vec, op, lane, func) SimdNativeBinop<vec>(op())
+#else
+#define SIMD_NATIVE_UNOP(vec, op, lane, func) SimdUnop<v128, lane>(func)
+#define SIMD_NATIVE_BINOP(vec, op, lane, func) SimdBinop<v128, lane>(func)
+#endif
+
 template <typename R, typename T>
-Result Thread::BinopTrap(BinopTrapFunc<R, T> func) {
+ResultType Thread::BinopTrap(BinopTrapFunc<R, T> func) {
   auto rhs_rep = PopRep<T>();
   auto lhs_rep = PopRep<T>();
   ValueTypeRep<R> result_value;
@@ -1351,7 +2684,7 @@ bool IsNormalDivRemS(T lhs, T rhs) {
 
 // i{32,64}.div_s
 template <typename T>
-Result IntDivS(ValueTypeRep<T> lhs_rep,
+ResultType IntDivS(ValueTypeRep<T> lhs_rep,
                ValueTypeRep<T> rhs_rep,
                ValueTypeRep<T>* out_result) {
   auto lhs = FromRep<T>(lhs_rep);
@@ -1364,7 +2697,7 @@ Result IntDivS(ValueTypeRep<T> lhs_rep,
 
 // i{32,64}.rem_s
 template <typename T>
-Result IntRemS(ValueTypeRep<T> lhs_rep,
+ResultType IntRemS(ValueTypeRep<T> lhs_rep,
                ValueTypeRep<T> rhs_rep,
                ValueTypeRep<T>* out_result) {
   auto lhs = FromRep<T>(lhs_rep);
@@ -1380,7 +2713,7 @@ Result IntRemS(ValueTypeRep<T> lhs_rep,
 
 // i{32,64}.div_u
 template <typename T>
-Result IntDivU(ValueTypeRep<T> lhs_rep,
+ResultType IntDivU(ValueTypeRep<T> lhs_rep,
                ValueTypeRep<T> rhs_rep,
                ValueTypeRep<T>* out_result) {
   auto lhs = FromRep<T>(lhs_rep);
@@ -1392,7 +2725,7 @@ Result IntDivU(ValueTypeRep<T> lhs_rep,
 
 // i{32,64}.rem_u
 template <typename T>
-Result IntRemU(ValueTypeRep<T> lhs_rep,
+ResultType IntRemU(ValueTypeRep<T> lhs_rep,
                ValueTypeRep<T> rhs_rep,
                ValueTypeRep<T>* out_result) {
   auto lhs = FromRep<T>(lhs_rep);
@@ -1531,10 +2864,13 @@ ValueTypeRep<T> FloatTrunc(ValueTypeRep<T> v_rep) {
   return CanonicalizeNan<T>(ToRep(std::trunc(FromRep<T>(v_rep))));
 }
 
-// f{32,64}.nearest
-template <typename T>
+// f{32,64}.nearest. The kCanonicalizeNans = false instance backs the
+// relaxed-nan thread option (see Thread::Options) and returns whatever nan
+// the hardware produced.
+template <typename T, bool kCanonicalizeNans = true>
 ValueTypeRep<T> FloatNearest(ValueTypeRep<T> v_rep) {
-  return CanonicalizeNan<T>(ToRep(std::nearbyint(FromRep<T>(v_rep))));
+  ValueTypeRep<T> result = ToRep(std::nearbyint(FromRep<T>(v_rep)));
+  return kCanonicalizeNans ? CanonicalizeNan<T>(result) : result;
 }
 
 // f{32,64}.sqrt
@@ -1543,40 +2879,43 @@ ValueTypeRep<T> FloatSqrt(ValueTypeRep<T> v_rep) {
   return CanonicalizeNan<T>(ToRep(std::sqrt(FromRep<T>(v_rep))));
 }
 
-// f{32,64}.min
-template <typename T>
+// f{32,64}.min. Compares via FloatTraits::OrderedKey, which folds the
+// min(0.0, -0.0) == -0.0 case into the ordering, so the whole operation is a
+// key compare plus selects that the compiler lowers to branch-free code
+// (cmov/csel) — the per-operand nan branches mispredicted constantly on
+// nan-propagating workloads. With kCanonicalizeNans = false (the relaxed-nan
+// thread option), a nan operand still wins over any number — the key order
+// alone would let a positive nan lose to its neighbour — but comes back
+// unquieted instead of as the canonical nan.
+template <typename T, bool kCanonicalizeNans = true>
 ValueTypeRep<T> FloatMin(ValueTypeRep<T> lhs_rep, ValueTypeRep<T> rhs_rep) {
   typedef FloatTraits<T> Traits;
-
-  if (WABT_UNLIKELY(Traits::IsNan(lhs_rep) || Traits::IsNan(rhs_rep))) {
-    return Traits::kQuietNan;
-  } else if (WABT_UNLIKELY(Traits::IsZero(lhs_rep) &&
-                           Traits::IsZero(rhs_rep))) {
-    // min(0.0, -0.0) == -0.0, but std::min won't produce the correct result.
-    // We can instead compare using the unsigned integer representation, but
-    // just max instead (since the sign bit makes the value larger).
-    return std::max(lhs_rep, rhs_rep);
-  } else {
-    return ToRep(std::min(FromRep<T>(lhs_rep), FromRep<T>(rhs_rep)));
+  ValueTypeRep<T> min_rep =
+      Traits::OrderedKey(lhs_rep) < Traits::OrderedKey(rhs_rep) ? lhs_rep
+                                                                : rhs_rep;
+  if (kCanonicalizeNans) {
+    bool has_nan = Traits::IsNan(lhs_rep) | Traits::IsNan(rhs_rep);
+    return has_nan ? Traits::kQuietNan : min_rep;
   }
+  bool lhs_nan = Traits::IsNan(lhs_rep);
+  bool rhs_nan = Traits::IsNan(rhs_rep);
+  return lhs_nan ? lhs_rep : rhs_nan ? rhs_rep : min_rep;
 }
 
-// f{32,64}.max
-template <typename T>
+// f{32,64}.max; see FloatMin.
+template <typename T, bool kCanonicalizeNans = true>
 ValueTypeRep<T> FloatMax(ValueTypeRep<T> lhs_rep, ValueTypeRep<T> rhs_rep) {
   typedef FloatTraits<T> Traits;
-
-  if (WABT_UNLIKELY(Traits::IsNan(lhs_rep) || Traits::IsNan(rhs_rep))) {
-    return Traits::kQuietNan;
-  } else if (WABT_UNLIKELY(Traits::IsZero(lhs_rep) &&
-                           Traits::IsZero(rhs_rep))) {
-    // min(0.0, -0.0) == -0.0, but std::min won't produce the correct result.
-    // We can instead compare using the unsigned integer representation, but
-    // just max instead (since the sign bit makes the value larger).
-    return std::min(lhs_rep, rhs_rep);
-  } else {
-    return ToRep(std::max(FromRep<T>(lhs_rep), FromRep<T>(rhs_rep)));
+  ValueTypeRep<T> max_rep =
+      Traits::OrderedKey(lhs_rep) > Traits::OrderedKey(rhs_rep) ? lhs_rep
+                                                                : rhs_rep;
+  if (kCanonicalizeNans) {
+    bool has_nan = Traits::IsNan(lhs_rep) | Traits::IsNan(rhs_rep);
+    return has_nan ? Traits::kQuietNan : max_rep;
   }
+  bool lhs_nan = Traits::IsNan(lhs_rep);
+  bool rhs_nan = Traits::IsNan(rhs_rep);
+  return lhs_nan ? lhs_rep : rhs_nan ? rhs_rep : max_rep;
 }
 
 // f{32,64}.copysign
@@ -1638,7 +2977,7 @@ ValueTypeRep<double> SimdConvert<double, uint64_t>(
 
 // i{32,64}.trunc_{s,u}/f{32,64}
 template <typename R, typename T>
-Result IntTrunc(ValueTypeRep<T> v_rep, ValueTypeRep<R>* out_result) {
+ResultType IntTrunc(ValueTypeRep<T> v_rep, ValueTypeRep<R>* out_result) {
   TRAP_IF(FloatTraits<T>::IsNan(v_rep), InvalidConversionToInteger);
   TRAP_UNLESS((IsConversionInRange<R, T>(v_rep)), IntegerOverflow);
   *out_result = ToRep(static_cast<R>(FromRep<T>(v_rep)));
@@ -1742,14 +3081,71 @@ bool Environment::FuncSignaturesAreEqual(Index sig_index_0,
   if (sig_index_0 == sig_index_1) {
     return true;
   }
-  const FuncSignature* sig_0 = &sigs_[sig_index_0];
-  const FuncSignature* sig_1 = &sigs_[sig_index_1];
-  return sig_0->param_types == sig_1->param_types &&
-         sig_0->result_types == sig_1->result_types;
+  return (*sigs_)[sig_index_0].canonical_index ==
+         (*sigs_)[sig_index_1].canonical_index;
+}
+
+// Delivers and empties |func|'s queued calls; see HostFunc::BatchCallback.
+static Result FlushHostCallBatch(HostFunc* func, const FuncSignature* sig) {
+  if (func->num_batched_calls == 0) {
+    return Result(ResultType::Ok);
+  }
+  Result result = func->batch_callback(func, sig, func->batch_buffer.data(),
+                                       func->num_batched_calls);
+  func->batch_buffer.clear();
+  func->num_batched_calls = 0;
+  return result;
+}
+
+Result Environment::FlushHostCallBatches() {
+  Result result(ResultType::Ok);
+  for (auto& func : funcs_) {
+    if (func->is_host) {
+      HostFunc* host_func = cast<HostFunc>(func.get());
+      if (host_func->num_batched_calls != 0) {
+        Result flush_result = FlushHostCallBatch(
+            host_func, GetFuncSignature(host_func->sig_index));
+        if (result.ok()) {
+          result = flush_result;
+        }
+      }
+    }
+  }
+  return result;
 }
 
-Result Thread::CallHost(HostFunc* func) {
-  FuncSignature* sig = &env_->sigs_[func->sig_index];
+ResultType Thread::CallHost(HostFunc* func) {
+  FuncSignature* sig = &(*env_->sigs_)[func->sig_index];
+
+  if (func->raw_callback) {
+    size_t num_params = sig->param_types.size();
+    size_t num_results = sig->result_types.size();
+    if (num_results > num_params) {
+      TRAP_IF(!HasValueStackRoom(num_results - num_params),
+              ValueStackExhausted);
+    }
+    // The callback reads its arguments from, and writes its results over,
+    // the caller's operand slots in place; nothing is copied.
+    Value* base = value_stack_.data() + (value_stack_top_ - num_params);
+    Result call_result = func->raw_callback(func, sig, base);
+    TRAP_UNLESS(call_result.ok(), HostTrapped);
+    value_stack_top_ = value_stack_top_ - num_params + num_results;
+    return ResultType::Ok;
+  }
+
+  if (func->batch_callback) {
+    size_t num_params = sig->param_types.size();
+    size_t old_size = func->batch_buffer.size();
+    func->batch_buffer.resize(old_size + num_params);
+    for (size_t i = num_params; i > 0; --i) {
+      func->batch_buffer[old_size + i - 1] = Pop();
+    }
+    if (++func->num_batched_calls >= func->batch_size) {
+      Result flush_result = FlushHostCallBatch(func, sig);
+      TRAP_UNLESS(flush_result.ok(), HostTrapped);
+    }
+    return ResultType::Ok;
+  }
 
   size_t num_params = sig->param_types.size();
   size_t num_results = sig->result_types.size();
@@ -1772,6 +3168,9 @@ Result Thread::CallHost(HostFunc* func) {
              "expected %" PRIzd " results but got %" PRIzd, num_results,
              results.size());
   }
+  // Host results aren't covered by any lowered function's stack_check, so
+  // check for room explicitly.
+  TRAP_IF(!HasValueStackRoom(num_results), ValueStackExhausted);
   for (size_t i = 0; i < num_results; ++i) {
     if (TypeChecker::CheckType(results[i].type, sig->result_types[i]) !=
         wabt::Result::Ok) {
@@ -1783,38 +3182,189 @@ Result Thread::CallHost(HostFunc* func) {
   return ResultType::Ok;
 }
 
-Result Thread::Run(int num_instructions) {
-  Result result = ResultType::Ok;
+// Rebuilds the Value for the constant operand of an InterpLocalConstBinop
+// instruction; the immediate is stored zero-extended to 64 bits in the
+// istream.
+static Value MakeLocalConstOperand(Opcode binop, uint64_t imm) {
+  Value value;
+  if (binop.GetParamType1() == Type::I64) {
+    value.i64 = imm;
+  } else {
+    value.i32 = static_cast<uint32_t>(imm);
+  }
+  return value;
+}
+
+// Executes the sub-opcode of an InterpLocalBinop instruction. The operands
+// have already been read from their value stack slots; only the result is
+// pushed. This must handle exactly the opcodes accepted by
+// IsFusableLocalBinop.
+ResultType Thread::RunLocalBinop(Opcode opcode, Value lhs, Value rhs) {
+#define LOCAL_BINOP(op, func, type) \
+  case Opcode::op:                  \
+    return LocalBinop(func<type>, lhs, rhs)
+
+  switch (opcode) {
+    LOCAL_BINOP(I32Add, Add, uint32_t);
+    LOCAL_BINOP(I32Sub, Sub, uint32_t);
+    LOCAL_BINOP(I32Mul, Mul, uint32_t);
+    LOCAL_BINOP(I32And, IntAnd, uint32_t);
+    LOCAL_BINOP(I32Or, IntOr, uint32_t);
+    LOCAL_BINOP(I32Xor, IntXor, uint32_t);
+    LOCAL_BINOP(I32Shl, IntShl, uint32_t);
+    LOCAL_BINOP(I32ShrU, IntShr, uint32_t);
+    LOCAL_BINOP(I32ShrS, IntShr, int32_t);
+    LOCAL_BINOP(I32Rotl, IntRotl, uint32_t);
+    LOCAL_BINOP(I32Rotr, IntRotr, uint32_t);
+    LOCAL_BINOP(I32Eq, Eq, uint32_t);
+    LOCAL_BINOP(I32Ne, Ne, uint32_t);
+    LOCAL_BINOP(I32LtS, Lt, int32_t);
+    LOCAL_BINOP(I32LtU, Lt, uint32_t);
+    LOCAL_BINOP(I32LeS, Le, int32_t);
+    LOCAL_BINOP(I32LeU, Le, uint32_t);
+    LOCAL_BINOP(I32GtS, Gt, int32_t);
+    LOCAL_BINOP(I32GtU, Gt, uint32_t);
+    LOCAL_BINOP(I32GeS, Ge, int32_t);
+    LOCAL_BINOP(I32GeU, Ge, uint32_t);
+    LOCAL_BINOP(I64Add, Add, uint64_t);
+    LOCAL_BINOP(I64Sub, Sub, uint64_t);
+    LOCAL_BINOP(I64Mul, Mul, uint64_t);
+    LOCAL_BINOP(I64And, IntAnd, uint64_t);
+    LOCAL_BINOP(I64Or, IntOr, uint64_t);
+    LOCAL_BINOP(I64Xor, IntXor, uint64_t);
+    LOCAL_BINOP(I64Shl, IntShl, uint64_t);
+    LOCAL_BINOP(I64ShrU, IntShr, uint64_t);
+    LOCAL_BINOP(I64ShrS, IntShr, int64_t);
+    LOCAL_BINOP(I64Rotl, IntRotl, uint64_t);
+    LOCAL_BINOP(I64Rotr, IntRotr, uint64_t);
+    LOCAL_BINOP(I64Eq, Eq, uint64_t);
+    LOCAL_BINOP(I64Ne, Ne, uint64_t);
+    LOCAL_BINOP(I64LtS, Lt, int64_t);
+    LOCAL_BINOP(I64LtU, Lt, uint64_t);
+    LOCAL_BINOP(I64LeS, Le, int64_t);
+    LOCAL_BINOP(I64LeU, Le, uint64_t);
+    LOCAL_BINOP(I64GtS, Gt, int64_t);
+    LOCAL_BINOP(I64GtU, Gt, uint64_t);
+    LOCAL_BINOP(I64GeS, Ge, int64_t);
+    LOCAL_BINOP(I64GeU, Ge, uint64_t);
+
+    default:
+      WABT_UNREACHABLE;
+  }
+
+#undef LOCAL_BINOP
+}
+
+ResultType Thread::Run(int fuel) {
+  ResultType result = ResultType::Ok;
+
+#if WABT_HAS_GUARD_PAGES
+  GuardTrapScope guard_trap_scope;
+  if (AnyGuardedMemories()) {
+    // Save the signal mask (second argument 1): siglongjmp out of the fault
+    // handler must restore it, or SIGSEGV stays blocked afterwards and the
+    // next guard-page fault kills the process instead of trapping.
+    if (sigsetjmp(guard_trap_scope.jmp_buf_, 1)) {
+      TRAP(MemoryAccessOutOfBounds);
+    }
+    guard_trap_scope.Arm();
+  }
+#endif
 
   const uint8_t* istream = GetIstream();
+
+  // Return addresses saved by a suspended call are raw pointers into the
+  // istream of the slice that pushed them; if a module load between slices
+  // reallocated the istream, move them onto the new base before any of
+  // them is popped. See the call_stack_ declaration.
+  if (WABT_UNLIKELY(istream != istream_base_)) {
+    for (uint32_t i = 0; i < call_stack_top_; ++i) {
+      call_stack_[i] = istream + (call_stack_[i] - istream_base_);
+    }
+    istream_base_ = istream;
+  }
+
   const uint8_t* pc = &istream[pc_];
-  for (int i = 0; i < num_instructions; ++i) {
+
+  // Quota checks run once per Run slice, not per instruction. The wall-clock
+  // deadline is charged the whole slice's fuel up front and the clock read
+  // only when the epoch counter runs dry; the fuel quota clamps |fuel| so a
+  // slice can't overdraw the budget, and the consumed fuel is settled at
+  // exit_loop. See Options.
+  if (WABT_UNLIKELY(has_deadline_)) {
+    deadline_fuel_countdown_ -= fuel;
+    if (deadline_fuel_countdown_ <= 0) {
+      deadline_fuel_countdown_ = kDeadlineCheckFuelInterval;
+      if (std::chrono::steady_clock::now() >= deadline_) {
+        TRAP(WallClockLimitExceeded);
+      }
+    }
+  }
+  if (WABT_UNLIKELY(fuel_remaining_ != UINT64_MAX)) {
+    if (fuel_remaining_ == 0) {
+      TRAP(FuelQuotaExceeded);
+    }
+    if (fuel > 0 && static_cast<uint64_t>(fuel) > fuel_remaining_) {
+      fuel = static_cast<int>(fuel_remaining_);
+    }
+  }
+  const int entry_fuel = fuel;
+
+#if WABT_USE_COMPUTED_GOTO
+  // One entry per Opcode::Enum value, in enum order; the final entry handles
+  // Opcode::Invalid.
+  static const void* s_dispatch_table[] = {
+#define WABT_OPCODE(rtype, type1, type2, type3, mem_size, prefix, code, Name, \
+                    text, decomp)                                             \
+  &&op_##Name,
+#include "src/opcode.def"
+#undef WABT_OPCODE
+      &&op_Invalid,
+  };
+  Opcode opcode;
+  if (fuel <= 0) {
+    goto exit_loop;
+  }
+  opcode = ReadOpcode(&pc);
+  assert(!opcode.IsInvalid());
+  WABT_PROFILE_SAMPLE();
+  goto* s_dispatch_table[static_cast<uint32_t>(Opcode::Enum(opcode))];
+#else
+  if (fuel <= 0) {
+    goto exit_loop;
+  }
+  while (true) {
     Opcode opcode = ReadOpcode(&pc);
     assert(!opcode.IsInvalid());
+    WABT_PROFILE_SAMPLE();
     switch (opcode) {
-      case Opcode::Select: {
+#endif
+      WABT_OP(Select) {
         uint32_t cond = Pop<uint32_t>();
         Value false_ = Pop();
         Value true_ = Pop();
         CHECK_TRAP(Push(cond ? true_ : false_));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::Br:
+      WABT_OP(Br)
         GOTO(ReadU32(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::BrIf: {
+      WABT_OP(BrIf) {
         IstreamOffset new_pc = ReadU32(&pc);
         if (Pop<uint32_t>()) {
           GOTO(new_pc);
         }
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::BrTable: {
-        Index num_targets = ReadU32(&pc);
-        IstreamOffset table_offset = ReadU32(&pc);
+      WABT_OP(BrTable) {
+        // Handlers with several immediates read each one at its fixed offset
+        // and bump pc once, as in GetAccessAddressAt.
+        Index num_targets = ReadU32At(pc);
+        IstreamOffset table_offset = ReadU32At(pc + sizeof(uint32_t));
+        pc += 2 * sizeof(uint32_t);
         uint32_t key = Pop<uint32_t>();
         IstreamOffset key_offset =
             (key >= num_targets ? num_targets : key) * WABT_TABLE_ENTRY_SIZE;
@@ -1825,116 +3375,200 @@ Result Thread::Run(int num_instructions) {
         ReadTableEntryAt(entry, &new_pc, &drop_count, &keep_count);
         DropKeep(drop_count, keep_count);
         GOTO(new_pc);
-        break;
+        WABT_NEXT();
+      }
+
+      WABT_OP(InterpBrTableCompact) {
+        // Emitted instead of BrTable when every target's drop and keep
+        // counts are zero; entries are bare 4-byte offsets.
+        Index num_targets = ReadU32At(pc);
+        IstreamOffset table_offset = ReadU32At(pc + sizeof(uint32_t));
+        pc += 2 * sizeof(uint32_t);
+        uint32_t key = Pop<uint32_t>();
+        IstreamOffset key_offset =
+            (key >= num_targets ? num_targets : key) * sizeof(uint32_t);
+        IstreamOffset new_pc = ReadU32At(istream + table_offset + key_offset);
+        GOTO(new_pc);
+        WABT_NEXT();
       }
 
-      case Opcode::Return:
+      WABT_OP(Return)
         if (call_stack_top_ == 0) {
           result = ResultType::Returned;
           goto exit_loop;
         }
-        GOTO(PopCall());
-        break;
+        pc = PopCall();
+        WABT_NEXT();
 
-      case Opcode::Unreachable:
+      WABT_OP(Unreachable)
         TRAP(Unreachable);
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Const:
+      WABT_OP(I32Const)
         CHECK_TRAP(Push<uint32_t>(ReadU32(&pc)));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Const:
+      WABT_OP(I64Const)
         CHECK_TRAP(Push<uint64_t>(ReadU64(&pc)));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Const:
+      WABT_OP(F32Const)
         CHECK_TRAP(PushRep<float>(ReadU32(&pc)));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Const:
+      WABT_OP(F64Const)
         CHECK_TRAP(PushRep<double>(ReadU64(&pc)));
-        break;
+        WABT_NEXT();
 
-      case Opcode::GlobalGet: {
+      WABT_OP(GlobalGet) {
         Index index = ReadU32(&pc);
         assert(index < env_->globals_.size());
         CHECK_TRAP(Push(env_->globals_[index].typed_value.value));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::GlobalSet: {
+      WABT_OP(GlobalSet) {
         Index index = ReadU32(&pc);
         assert(index < env_->globals_.size());
         env_->globals_[index].typed_value = {env_->globals_[index].type, Pop()};
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::LocalGet: {
+      WABT_OP(LocalGet) {
         Value value = Pick(ReadU32(&pc));
         CHECK_TRAP(Push(value));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::LocalSet: {
+      WABT_OP(LocalSet) {
         Value value = Pop();
         Pick(ReadU32(&pc)) = value;
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::LocalTee:
+      WABT_OP(LocalTee)
         Pick(ReadU32(&pc)) = Top();
-        break;
-
-      case Opcode::Call: {
-        IstreamOffset offset = ReadU32(&pc);
+        WABT_NEXT();
+
+      WABT_OP(Call) {
+        IstreamOffset offset = ReadU32At(pc);
+        Index func_index = ReadU32At(pc + sizeof(uint32_t));
+        pc += 2 * sizeof(uint32_t);
+        // The callee's first instructions are usually cold in L1 (bodies are
+        // lowered in module order, not call order); start pulling them in
+        // while the call-stack bookkeeping below runs.
+        WABT_PREFETCH(&istream[offset]);
+        if (WABT_UNLIKELY(jit_threshold_ != 0)) {
+          DefinedFunc* func =
+              cast<DefinedFunc>(env_->funcs_[func_index].get());
+          if (func->jit_ready.load(std::memory_order_acquire)) {
+            CHECK_TRAP(RunJitFunc(func));
+            WABT_NEXT();
+          }
+          // Funcs are shared with forked environments on other threads, so
+          // the exchange claims compilation for exactly one thread and the
+          // code is published only once fully built.
+          if (func->jit_call_count.fetch_add(1, std::memory_order_relaxed) +
+                      1 >=
+                  jit_threshold_ &&
+              !func->jit_tried.exchange(true, std::memory_order_relaxed)) {
+            func->jit_func = JitFunc::Compile(env_, func);
+            if (func->jit_func) {
+              func->jit_ready.store(true, std::memory_order_release);
+              CHECK_TRAP(RunJitFunc(func));
+              WABT_NEXT();
+            }
+          }
+        }
         CHECK_TRAP(PushCall(pc));
         GOTO(offset);
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::CallIndirect: {
-        Table* table = ReadTable(&pc);
-        Index sig_index = ReadU32(&pc);
+      WABT_OP(CallIndirect) {
+        Table* table = &env_->tables_[ReadU32At(pc)];
+        Index sig_index = ReadU32At(pc + sizeof(uint32_t));
+        Index cached_func_index = ReadU32At(pc + 2 * sizeof(uint32_t));
+        IstreamOffset cached_offset = ReadU32At(pc + 3 * sizeof(uint32_t));
+        pc += 4 * sizeof(uint32_t);
+        // Prefetch the cached target before the table lookup resolves; on a
+        // cache miss this fetches at worst one useless line.
+        WABT_PREFETCH(&istream[cached_offset]);
         Index entry_index = Pop<uint32_t>();
         TRAP_IF(entry_index >= table->size(), UndefinedTableIndex);
         Ref ref = table->entries[entry_index];
         TRAP_IF(ref.kind == RefType::Null, UninitializedTableElement);
         assert(ref.kind == RefType::Func && ref.index != kInvalidIndex);
+        if (ref.index == cached_func_index) {
+          // Inline cache hit: this site last called the same function, so the
+          // signature check already passed and the target offset is known.
+          CHECK_TRAP(PushCall(pc));
+          GOTO(cached_offset);
+          WABT_NEXT();
+        }
         Func* func = env_->GetFunc(ref.index);
         TRAP_UNLESS(env_->FuncSignaturesAreEqual(func->sig_index, sig_index),
                     IndirectCallSignatureMismatch);
         if (func->is_host) {
           CHECK_TRAP(CallHost(cast<HostFunc>(func)));
         } else {
+          DefinedFunc* defined_func = cast<DefinedFunc>(func);
+          CacheIndirectCall(pc, ref.index, defined_func->offset);
           CHECK_TRAP(PushCall(pc));
-          GOTO(cast<DefinedFunc>(func)->offset);
+          GOTO(defined_func->offset);
         }
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::InterpCallHost: {
+      WABT_OP(InterpCallHost) {
         Index func_index = ReadU32(&pc);
         CHECK_TRAP(CallHost(cast<HostFunc>(env_->funcs_[func_index].get())));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::ReturnCall: {
-        IstreamOffset offset = ReadU32(&pc);
+      WABT_OP(ReturnCall) {
+        IstreamOffset offset = ReadU32At(pc);
+        Index func_index = ReadU32At(pc + sizeof(uint32_t));
+        pc += 2 * sizeof(uint32_t);
+        WABT_PREFETCH(&istream[offset]);
+        if (WABT_UNLIKELY(jit_threshold_ != 0)) {
+          DefinedFunc* func =
+              cast<DefinedFunc>(env_->funcs_[func_index].get());
+          if (func->jit_ready.load(std::memory_order_acquire)) {
+            // The caller's frame was already torn down by the preceding
+            // drop/keep, so a jitted tail callee finishes like Return.
+            CHECK_TRAP(RunJitFunc(func));
+            if (call_stack_top_ == 0) {
+              result = ResultType::Returned;
+              goto exit_loop;
+            }
+            pc = PopCall();
+            WABT_NEXT();
+          }
+        }
         GOTO(offset);
 
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::ReturnCallIndirect:{
-        Table* table = ReadTable(&pc);
-        Index sig_index = ReadU32(&pc);
+      WABT_OP(ReturnCallIndirect){
+        Table* table = &env_->tables_[ReadU32At(pc)];
+        Index sig_index = ReadU32At(pc + sizeof(uint32_t));
+        Index cached_func_index = ReadU32At(pc + 2 * sizeof(uint32_t));
+        IstreamOffset cached_offset = ReadU32At(pc + 3 * sizeof(uint32_t));
+        pc += 4 * sizeof(uint32_t);
+        WABT_PREFETCH(&istream[cached_offset]);
         Index entry_index = Pop<uint32_t>();
         TRAP_IF(entry_index >= table->size(), UndefinedTableIndex);
         Ref ref = table->entries[entry_index];
         assert(ref.kind == RefType::Func);
         TRAP_IF(ref.kind == RefType::Null, UninitializedTableElement);
         assert(ref.kind == RefType::Func && ref.index != kInvalidIndex);
+        if (ref.index == cached_func_index) {
+          // Inline cache hit; see the CallIndirect handler above.
+          GOTO(cached_offset);
+          WABT_NEXT();
+        }
         Func* func = env_->GetFunc(ref.index);
         TRAP_UNLESS(env_->FuncSignaturesAreEqual(func->sig_index, sig_index),
                     IndirectCallSignatureMismatch);
@@ -1944,183 +3578,185 @@ Result Thread::Run(int num_instructions) {
             result = ResultType::Returned;
             goto exit_loop;
           }
-          GOTO(PopCall());
+          pc = PopCall();
         } else {
-          GOTO(cast<DefinedFunc>(func)->offset);
+          DefinedFunc* defined_func = cast<DefinedFunc>(func);
+          CacheIndirectCall(pc, ref.index, defined_func->offset);
+          GOTO(defined_func->offset);
         }
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32Load8S:
+      WABT_OP(I32Load8S)
         CHECK_TRAP(Load<int8_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Load8U:
+      WABT_OP(I32Load8U)
         CHECK_TRAP(Load<uint8_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Load16S:
+      WABT_OP(I32Load16S)
         CHECK_TRAP(Load<int16_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Load16U:
+      WABT_OP(I32Load16U)
         CHECK_TRAP(Load<uint16_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load8S:
+      WABT_OP(I64Load8S)
         CHECK_TRAP(Load<int8_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load8U:
+      WABT_OP(I64Load8U)
         CHECK_TRAP(Load<uint8_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load16S:
+      WABT_OP(I64Load16S)
         CHECK_TRAP(Load<int16_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load16U:
+      WABT_OP(I64Load16U)
         CHECK_TRAP(Load<uint16_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load32S:
+      WABT_OP(I64Load32S)
         CHECK_TRAP(Load<int32_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load32U:
+      WABT_OP(I64Load32U)
         CHECK_TRAP(Load<uint32_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Load:
+      WABT_OP(I32Load)
         CHECK_TRAP(Load<uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Load:
+      WABT_OP(I64Load)
         CHECK_TRAP(Load<uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Load:
+      WABT_OP(F32Load)
         CHECK_TRAP(Load<float>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Load:
+      WABT_OP(F64Load)
         CHECK_TRAP(Load<double>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Store8:
+      WABT_OP(I32Store8)
         CHECK_TRAP(Store<uint8_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Store16:
+      WABT_OP(I32Store16)
         CHECK_TRAP(Store<uint16_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Store8:
+      WABT_OP(I64Store8)
         CHECK_TRAP(Store<uint8_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Store16:
+      WABT_OP(I64Store16)
         CHECK_TRAP(Store<uint16_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Store32:
+      WABT_OP(I64Store32)
         CHECK_TRAP(Store<uint32_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Store:
+      WABT_OP(I32Store)
         CHECK_TRAP(Store<uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Store:
+      WABT_OP(I64Store)
         CHECK_TRAP(Store<uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Store:
+      WABT_OP(F32Store)
         CHECK_TRAP(Store<float>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Store:
+      WABT_OP(F64Store)
         CHECK_TRAP(Store<double>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicLoad8U:
+      WABT_OP(I32AtomicLoad8U)
         CHECK_TRAP(AtomicLoad<uint8_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicLoad16U:
+      WABT_OP(I32AtomicLoad16U)
         CHECK_TRAP(AtomicLoad<uint16_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicLoad8U:
+      WABT_OP(I64AtomicLoad8U)
         CHECK_TRAP(AtomicLoad<uint8_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicLoad16U:
+      WABT_OP(I64AtomicLoad16U)
         CHECK_TRAP(AtomicLoad<uint16_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicLoad32U:
+      WABT_OP(I64AtomicLoad32U)
         CHECK_TRAP(AtomicLoad<uint32_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicLoad:
+      WABT_OP(I32AtomicLoad)
         CHECK_TRAP(AtomicLoad<uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicLoad:
+      WABT_OP(I64AtomicLoad)
         CHECK_TRAP(AtomicLoad<uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicStore8:
+      WABT_OP(I32AtomicStore8)
         CHECK_TRAP(AtomicStore<uint8_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicStore16:
+      WABT_OP(I32AtomicStore16)
         CHECK_TRAP(AtomicStore<uint16_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicStore8:
+      WABT_OP(I64AtomicStore8)
         CHECK_TRAP(AtomicStore<uint8_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicStore16:
+      WABT_OP(I64AtomicStore16)
         CHECK_TRAP(AtomicStore<uint16_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicStore32:
+      WABT_OP(I64AtomicStore32)
         CHECK_TRAP(AtomicStore<uint32_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicStore:
+      WABT_OP(I32AtomicStore)
         CHECK_TRAP(AtomicStore<uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicStore:
+      WABT_OP(I64AtomicStore)
         CHECK_TRAP(AtomicStore<uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
 #define ATOMIC_RMW(rmwop, func)                                     \
-  case Opcode::I32AtomicRmw##rmwop:                                 \
+  WABT_OP(I32AtomicRmw##rmwop)                                      \
     CHECK_TRAP(AtomicRmw<uint32_t, uint32_t>(func<uint32_t>, &pc)); \
-    break;                                                          \
-  case Opcode::I64AtomicRmw##rmwop:                                 \
+    WABT_NEXT();                                                    \
+  WABT_OP(I64AtomicRmw##rmwop)                                      \
     CHECK_TRAP(AtomicRmw<uint64_t, uint64_t>(func<uint64_t>, &pc)); \
-    break;                                                          \
-  case Opcode::I32AtomicRmw8##rmwop##U:                             \
+    WABT_NEXT();                                                    \
+  WABT_OP(I32AtomicRmw8##rmwop##U)                                  \
     CHECK_TRAP(AtomicRmw<uint8_t, uint32_t>(func<uint32_t>, &pc));  \
-    break;                                                          \
-  case Opcode::I32AtomicRmw16##rmwop##U:                            \
+    WABT_NEXT();                                                    \
+  WABT_OP(I32AtomicRmw16##rmwop##U)                                 \
     CHECK_TRAP(AtomicRmw<uint16_t, uint32_t>(func<uint32_t>, &pc)); \
-    break;                                                          \
-  case Opcode::I64AtomicRmw8##rmwop##U:                             \
+    WABT_NEXT();                                                    \
+  WABT_OP(I64AtomicRmw8##rmwop##U)                                  \
     CHECK_TRAP(AtomicRmw<uint8_t, uint64_t>(func<uint64_t>, &pc));  \
-    break;                                                          \
-  case Opcode::I64AtomicRmw16##rmwop##U:                            \
+    WABT_NEXT();                                                    \
+  WABT_OP(I64AtomicRmw16##rmwop##U)                                 \
     CHECK_TRAP(AtomicRmw<uint16_t, uint64_t>(func<uint64_t>, &pc)); \
-    break;                                                          \
-  case Opcode::I64AtomicRmw32##rmwop##U:                            \
+    WABT_NEXT();                                                    \
+  WABT_OP(I64AtomicRmw32##rmwop##U)                                 \
     CHECK_TRAP(AtomicRmw<uint32_t, uint64_t>(func<uint64_t>, &pc)); \
-    break /* no semicolon */
+    WABT_NEXT() /* no semicolon */
 
         ATOMIC_RMW(Add, Add);
         ATOMIC_RMW(Sub, Sub);
@@ -2131,39 +3767,39 @@ Result Thread::Run(int num_instructions) {
 
 #undef ATOMIC_RMW
 
-      case Opcode::I32AtomicRmwCmpxchg:
+      WABT_OP(I32AtomicRmwCmpxchg)
         CHECK_TRAP(AtomicRmwCmpxchg<uint32_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicRmwCmpxchg:
+      WABT_OP(I64AtomicRmwCmpxchg)
         CHECK_TRAP(AtomicRmwCmpxchg<uint64_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicRmw8CmpxchgU:
+      WABT_OP(I32AtomicRmw8CmpxchgU)
         CHECK_TRAP(AtomicRmwCmpxchg<uint8_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32AtomicRmw16CmpxchgU:
+      WABT_OP(I32AtomicRmw16CmpxchgU)
         CHECK_TRAP(AtomicRmwCmpxchg<uint16_t, uint32_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicRmw8CmpxchgU:
+      WABT_OP(I64AtomicRmw8CmpxchgU)
         CHECK_TRAP(AtomicRmwCmpxchg<uint8_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicRmw16CmpxchgU:
+      WABT_OP(I64AtomicRmw16CmpxchgU)
         CHECK_TRAP(AtomicRmwCmpxchg<uint16_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64AtomicRmw32CmpxchgU:
+      WABT_OP(I64AtomicRmw32CmpxchgU)
         CHECK_TRAP(AtomicRmwCmpxchg<uint32_t, uint64_t>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::MemorySize:
+      WABT_OP(MemorySize)
         CHECK_TRAP(Push<uint32_t>(ReadMemory(&pc)->page_limits.initial));
-        break;
+        WABT_NEXT();
 
-      case Opcode::MemoryGrow: {
+      WABT_OP(MemoryGrow) {
         Memory* memory = ReadMemory(&pc);
         uint32_t old_page_size = memory->page_limits.initial;
         uint32_t grow_pages = Pop<uint32_t>();
@@ -2171,480 +3807,512 @@ Result Thread::Run(int num_instructions) {
         uint32_t max_page_size = memory->page_limits.has_max
                                      ? memory->page_limits.max
                                      : WABT_MAX_PAGES;
+        uint64_t grow_bytes = static_cast<uint64_t>(grow_pages) * WABT_PAGE_SIZE;
         PUSH_NEG_1_AND_BREAK_IF(new_page_size > max_page_size);
         PUSH_NEG_1_AND_BREAK_IF(
             static_cast<uint64_t>(new_page_size) * WABT_PAGE_SIZE > UINT32_MAX);
-        memory->data.resize(new_page_size * WABT_PAGE_SIZE);
+        // The grow-byte quota fails the same way as growing past the
+        // memory's maximum, so guest code sees an ordinary -1.
+        PUSH_NEG_1_AND_BREAK_IF(grow_bytes > grow_bytes_remaining_);
+        PUSH_NEG_1_AND_BREAK_IF(
+            !memory->Resize(new_page_size * WABT_PAGE_SIZE));
+        if (WABT_UNLIKELY(grow_bytes_remaining_ != UINT64_MAX)) {
+          grow_bytes_remaining_ -= grow_bytes;
+        }
         memory->page_limits.initial = new_page_size;
         CHECK_TRAP(Push<uint32_t>(old_page_size));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32Add:
+      WABT_OP(I32Add)
         CHECK_TRAP(Binop(Add<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Sub:
+      WABT_OP(I32Sub)
         CHECK_TRAP(Binop(Sub<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Mul:
+      WABT_OP(I32Mul)
         CHECK_TRAP(Binop(Mul<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32DivS:
+      WABT_OP(I32DivS)
         CHECK_TRAP(BinopTrap(IntDivS<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32DivU:
+      WABT_OP(I32DivU)
         CHECK_TRAP(BinopTrap(IntDivU<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32RemS:
+      WABT_OP(I32RemS)
         CHECK_TRAP(BinopTrap(IntRemS<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32RemU:
+      WABT_OP(I32RemU)
         CHECK_TRAP(BinopTrap(IntRemU<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32And:
+      WABT_OP(I32And)
         CHECK_TRAP(Binop(IntAnd<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Or:
+      WABT_OP(I32Or)
         CHECK_TRAP(Binop(IntOr<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Xor:
+      WABT_OP(I32Xor)
         CHECK_TRAP(Binop(IntXor<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Shl:
+      WABT_OP(I32Shl)
         CHECK_TRAP(Binop(IntShl<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32ShrU:
+      WABT_OP(I32ShrU)
         CHECK_TRAP(Binop(IntShr<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32ShrS:
+      WABT_OP(I32ShrS)
         CHECK_TRAP(Binop(IntShr<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Eq:
+      WABT_OP(I32Eq)
         CHECK_TRAP(Binop(Eq<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Ne:
+      WABT_OP(I32Ne)
         CHECK_TRAP(Binop(Ne<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32LtS:
+      WABT_OP(I32LtS)
         CHECK_TRAP(Binop(Lt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32LeS:
+      WABT_OP(I32LeS)
         CHECK_TRAP(Binop(Le<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32LtU:
+      WABT_OP(I32LtU)
         CHECK_TRAP(Binop(Lt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32LeU:
+      WABT_OP(I32LeU)
         CHECK_TRAP(Binop(Le<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32GtS:
+      WABT_OP(I32GtS)
         CHECK_TRAP(Binop(Gt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32GeS:
+      WABT_OP(I32GeS)
         CHECK_TRAP(Binop(Ge<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32GtU:
+      WABT_OP(I32GtU)
         CHECK_TRAP(Binop(Gt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32GeU:
+      WABT_OP(I32GeU)
         CHECK_TRAP(Binop(Ge<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Clz:
+      WABT_OP(I32Clz)
         CHECK_TRAP(Push<uint32_t>(Clz(Pop<uint32_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Ctz:
+      WABT_OP(I32Ctz)
         CHECK_TRAP(Push<uint32_t>(Ctz(Pop<uint32_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Popcnt:
+      WABT_OP(I32Popcnt)
         CHECK_TRAP(Push<uint32_t>(Popcount(Pop<uint32_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Eqz:
+      WABT_OP(I32Eqz)
         CHECK_TRAP(Unop(IntEqz<uint32_t, uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Add:
+      WABT_OP(I64Add)
         CHECK_TRAP(Binop(Add<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Sub:
+      WABT_OP(I64Sub)
         CHECK_TRAP(Binop(Sub<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Mul:
+      WABT_OP(I64Mul)
         CHECK_TRAP(Binop(Mul<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64DivS:
+      WABT_OP(I64DivS)
         CHECK_TRAP(BinopTrap(IntDivS<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64DivU:
+      WABT_OP(I64DivU)
         CHECK_TRAP(BinopTrap(IntDivU<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64RemS:
+      WABT_OP(I64RemS)
         CHECK_TRAP(BinopTrap(IntRemS<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64RemU:
+      WABT_OP(I64RemU)
         CHECK_TRAP(BinopTrap(IntRemU<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64And:
+      WABT_OP(I64And)
         CHECK_TRAP(Binop(IntAnd<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Or:
+      WABT_OP(I64Or)
         CHECK_TRAP(Binop(IntOr<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Xor:
+      WABT_OP(I64Xor)
         CHECK_TRAP(Binop(IntXor<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Shl:
+      WABT_OP(I64Shl)
         CHECK_TRAP(Binop(IntShl<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64ShrU:
+      WABT_OP(I64ShrU)
         CHECK_TRAP(Binop(IntShr<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64ShrS:
+      WABT_OP(I64ShrS)
         CHECK_TRAP(Binop(IntShr<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Eq:
+      WABT_OP(I64Eq)
         CHECK_TRAP(Binop(Eq<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Ne:
+      WABT_OP(I64Ne)
         CHECK_TRAP(Binop(Ne<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64LtS:
+      WABT_OP(I64LtS)
         CHECK_TRAP(Binop(Lt<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64LeS:
+      WABT_OP(I64LeS)
         CHECK_TRAP(Binop(Le<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64LtU:
+      WABT_OP(I64LtU)
         CHECK_TRAP(Binop(Lt<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64LeU:
+      WABT_OP(I64LeU)
         CHECK_TRAP(Binop(Le<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64GtS:
+      WABT_OP(I64GtS)
         CHECK_TRAP(Binop(Gt<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64GeS:
+      WABT_OP(I64GeS)
         CHECK_TRAP(Binop(Ge<int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64GtU:
+      WABT_OP(I64GtU)
         CHECK_TRAP(Binop(Gt<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64GeU:
+      WABT_OP(I64GeU)
         CHECK_TRAP(Binop(Ge<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Clz:
+      WABT_OP(I64Clz)
         CHECK_TRAP(Push<uint64_t>(Clz(Pop<uint64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Ctz:
+      WABT_OP(I64Ctz)
         CHECK_TRAP(Push<uint64_t>(Ctz(Pop<uint64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Popcnt:
+      WABT_OP(I64Popcnt)
         CHECK_TRAP(Push<uint64_t>(Popcount(Pop<uint64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Add:
+      WABT_OP(F32Add)
         CHECK_TRAP(Binop(Add<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Sub:
+      WABT_OP(F32Sub)
         CHECK_TRAP(Binop(Sub<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Mul:
+      WABT_OP(F32Mul)
         CHECK_TRAP(Binop(Mul<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Div:
+      WABT_OP(F32Div)
         CHECK_TRAP(Binop(FloatDiv<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Min:
-        CHECK_TRAP(Binop(FloatMin<float>));
-        break;
+      WABT_OP(F32Min)
+        if (WABT_UNLIKELY(relaxed_nans_)) {
+          CHECK_TRAP(Binop(FloatMin<float, false>));
+        } else {
+          CHECK_TRAP(Binop(FloatMin<float>));
+        }
+        WABT_NEXT();
 
-      case Opcode::F32Max:
-        CHECK_TRAP(Binop(FloatMax<float>));
-        break;
+      WABT_OP(F32Max)
+        if (WABT_UNLIKELY(relaxed_nans_)) {
+          CHECK_TRAP(Binop(FloatMax<float, false>));
+        } else {
+          CHECK_TRAP(Binop(FloatMax<float>));
+        }
+        WABT_NEXT();
 
-      case Opcode::F32Abs:
+      WABT_OP(F32Abs)
         CHECK_TRAP(Unop(FloatAbs<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Neg:
+      WABT_OP(F32Neg)
         CHECK_TRAP(Unop(FloatNeg<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Copysign:
+      WABT_OP(F32Copysign)
         CHECK_TRAP(Binop(FloatCopySign<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Ceil:
+      WABT_OP(F32Ceil)
         CHECK_TRAP(Unop(FloatCeil<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Floor:
+      WABT_OP(F32Floor)
         CHECK_TRAP(Unop(FloatFloor<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Trunc:
+      WABT_OP(F32Trunc)
         CHECK_TRAP(Unop(FloatTrunc<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Nearest:
-        CHECK_TRAP(Unop(FloatNearest<float>));
-        break;
+      WABT_OP(F32Nearest)
+        if (WABT_UNLIKELY(relaxed_nans_)) {
+          CHECK_TRAP(Unop(FloatNearest<float, false>));
+        } else {
+          CHECK_TRAP(Unop(FloatNearest<float>));
+        }
+        WABT_NEXT();
 
-      case Opcode::F32Sqrt:
+      WABT_OP(F32Sqrt)
         CHECK_TRAP(Unop(FloatSqrt<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Eq:
+      WABT_OP(F32Eq)
         CHECK_TRAP(Binop(Eq<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Ne:
+      WABT_OP(F32Ne)
         CHECK_TRAP(Binop(Ne<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Lt:
+      WABT_OP(F32Lt)
         CHECK_TRAP(Binop(Lt<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Le:
+      WABT_OP(F32Le)
         CHECK_TRAP(Binop(Le<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Gt:
+      WABT_OP(F32Gt)
         CHECK_TRAP(Binop(Gt<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32Ge:
+      WABT_OP(F32Ge)
         CHECK_TRAP(Binop(Ge<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Add:
+      WABT_OP(F64Add)
         CHECK_TRAP(Binop(Add<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Sub:
+      WABT_OP(F64Sub)
         CHECK_TRAP(Binop(Sub<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Mul:
+      WABT_OP(F64Mul)
         CHECK_TRAP(Binop(Mul<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Div:
+      WABT_OP(F64Div)
         CHECK_TRAP(Binop(FloatDiv<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Min:
-        CHECK_TRAP(Binop(FloatMin<double>));
-        break;
+      WABT_OP(F64Min)
+        if (WABT_UNLIKELY(relaxed_nans_)) {
+          CHECK_TRAP(Binop(FloatMin<double, false>));
+        } else {
+          CHECK_TRAP(Binop(FloatMin<double>));
+        }
+        WABT_NEXT();
 
-      case Opcode::F64Max:
-        CHECK_TRAP(Binop(FloatMax<double>));
-        break;
+      WABT_OP(F64Max)
+        if (WABT_UNLIKELY(relaxed_nans_)) {
+          CHECK_TRAP(Binop(FloatMax<double, false>));
+        } else {
+          CHECK_TRAP(Binop(FloatMax<double>));
+        }
+        WABT_NEXT();
 
-      case Opcode::F64Abs:
+      WABT_OP(F64Abs)
         CHECK_TRAP(Unop(FloatAbs<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Neg:
+      WABT_OP(F64Neg)
         CHECK_TRAP(Unop(FloatNeg<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Copysign:
+      WABT_OP(F64Copysign)
         CHECK_TRAP(Binop(FloatCopySign<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Ceil:
+      WABT_OP(F64Ceil)
         CHECK_TRAP(Unop(FloatCeil<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Floor:
+      WABT_OP(F64Floor)
         CHECK_TRAP(Unop(FloatFloor<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Trunc:
+      WABT_OP(F64Trunc)
         CHECK_TRAP(Unop(FloatTrunc<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Nearest:
-        CHECK_TRAP(Unop(FloatNearest<double>));
-        break;
+      WABT_OP(F64Nearest)
+        if (WABT_UNLIKELY(relaxed_nans_)) {
+          CHECK_TRAP(Unop(FloatNearest<double, false>));
+        } else {
+          CHECK_TRAP(Unop(FloatNearest<double>));
+        }
+        WABT_NEXT();
 
-      case Opcode::F64Sqrt:
+      WABT_OP(F64Sqrt)
         CHECK_TRAP(Unop(FloatSqrt<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Eq:
+      WABT_OP(F64Eq)
         CHECK_TRAP(Binop(Eq<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Ne:
+      WABT_OP(F64Ne)
         CHECK_TRAP(Binop(Ne<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Lt:
+      WABT_OP(F64Lt)
         CHECK_TRAP(Binop(Lt<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Le:
+      WABT_OP(F64Le)
         CHECK_TRAP(Binop(Le<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Gt:
+      WABT_OP(F64Gt)
         CHECK_TRAP(Binop(Gt<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64Ge:
+      WABT_OP(F64Ge)
         CHECK_TRAP(Binop(Ge<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncF32S:
+      WABT_OP(I32TruncF32S)
         CHECK_TRAP(UnopTrap(IntTrunc<int32_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncSatF32S:
+      WABT_OP(I32TruncSatF32S)
         CHECK_TRAP(Unop(IntTruncSat<int32_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncF64S:
+      WABT_OP(I32TruncF64S)
         CHECK_TRAP(UnopTrap(IntTrunc<int32_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncSatF64S:
+      WABT_OP(I32TruncSatF64S)
         CHECK_TRAP(Unop(IntTruncSat<int32_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncF32U:
+      WABT_OP(I32TruncF32U)
         CHECK_TRAP(UnopTrap(IntTrunc<uint32_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncSatF32U:
+      WABT_OP(I32TruncSatF32U)
         CHECK_TRAP(Unop(IntTruncSat<uint32_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncF64U:
+      WABT_OP(I32TruncF64U)
         CHECK_TRAP(UnopTrap(IntTrunc<uint32_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32TruncSatF64U:
+      WABT_OP(I32TruncSatF64U)
         CHECK_TRAP(Unop(IntTruncSat<uint32_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32WrapI64:
+      WABT_OP(I32WrapI64)
         CHECK_TRAP(Push<uint32_t>(Pop<uint64_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncF32S:
+      WABT_OP(I64TruncF32S)
         CHECK_TRAP(UnopTrap(IntTrunc<int64_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncSatF32S:
+      WABT_OP(I64TruncSatF32S)
         CHECK_TRAP(Unop(IntTruncSat<int64_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncF64S:
+      WABT_OP(I64TruncF64S)
         CHECK_TRAP(UnopTrap(IntTrunc<int64_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncSatF64S:
+      WABT_OP(I64TruncSatF64S)
         CHECK_TRAP(Unop(IntTruncSat<int64_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncF32U:
+      WABT_OP(I64TruncF32U)
         CHECK_TRAP(UnopTrap(IntTrunc<uint64_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncSatF32U:
+      WABT_OP(I64TruncSatF32U)
         CHECK_TRAP(Unop(IntTruncSat<uint64_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncF64U:
+      WABT_OP(I64TruncF64U)
         CHECK_TRAP(UnopTrap(IntTrunc<uint64_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64TruncSatF64U:
+      WABT_OP(I64TruncSatF64U)
         CHECK_TRAP(Unop(IntTruncSat<uint64_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64ExtendI32S:
+      WABT_OP(I64ExtendI32S)
         CHECK_TRAP(Push<uint64_t>(Pop<int32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64ExtendI32U:
+      WABT_OP(I64ExtendI32U)
         CHECK_TRAP(Push<uint64_t>(Pop<uint32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32ConvertI32S:
+      WABT_OP(F32ConvertI32S)
         CHECK_TRAP(Push<float>(Pop<int32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32ConvertI32U:
+      WABT_OP(F32ConvertI32U)
         CHECK_TRAP(Push<float>(Pop<uint32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32ConvertI64S:
+      WABT_OP(F32ConvertI64S)
         CHECK_TRAP(Push<float>(wabt_convert_int64_to_float(Pop<int64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32ConvertI64U:
+      WABT_OP(F32ConvertI64U)
         CHECK_TRAP(Push<float>(wabt_convert_uint64_to_float(Pop<uint64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32DemoteF64: {
+      WABT_OP(F32DemoteF64) {
         typedef FloatTraits<float> F32Traits;
 
         uint64_t value = PopRep<double>();
@@ -2661,298 +4329,370 @@ Result Thread::Run(int num_instructions) {
           uint32_t sign = (value >> 32) & F32Traits::kSignMask;
           CHECK_TRAP(PushRep<float>(sign | F32Traits::kInf));
         }
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F32ReinterpretI32:
+      WABT_OP(F32ReinterpretI32)
         CHECK_TRAP(PushRep<float>(Pop<uint32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64ConvertI32S:
+      WABT_OP(F64ConvertI32S)
         CHECK_TRAP(Push<double>(Pop<int32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64ConvertI32U:
+      WABT_OP(F64ConvertI32U)
         CHECK_TRAP(Push<double>(Pop<uint32_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64ConvertI64S:
+      WABT_OP(F64ConvertI64S)
         CHECK_TRAP(Push<double>(wabt_convert_int64_to_double(Pop<int64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64ConvertI64U:
+      WABT_OP(F64ConvertI64U)
         CHECK_TRAP(
             Push<double>(wabt_convert_uint64_to_double(Pop<uint64_t>())));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64PromoteF32: {
+      WABT_OP(F64PromoteF32) {
         uint32_t value = PopRep<float>();
         if (WABT_UNLIKELY(FloatTraits<float>::IsNan(value))) {
           CHECK_TRAP(PushRep<double>(FloatTraits<double>::kQuietNan));
         } else {
           CHECK_TRAP(Push<double>(Bitcast<float>(value)));
         }
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F64ReinterpretI64:
+      WABT_OP(F64ReinterpretI64)
         CHECK_TRAP(PushRep<double>(Pop<uint64_t>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32ReinterpretF32:
+      WABT_OP(I32ReinterpretF32)
         CHECK_TRAP(Push<uint32_t>(PopRep<float>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64ReinterpretF64:
+      WABT_OP(I64ReinterpretF64)
         CHECK_TRAP(Push<uint64_t>(PopRep<double>()));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Rotr:
+      WABT_OP(I32Rotr)
         CHECK_TRAP(Binop(IntRotr<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Rotl:
+      WABT_OP(I32Rotl)
         CHECK_TRAP(Binop(IntRotl<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Rotr:
+      WABT_OP(I64Rotr)
         CHECK_TRAP(Binop(IntRotr<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Rotl:
+      WABT_OP(I64Rotl)
         CHECK_TRAP(Binop(IntRotl<uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Eqz:
+      WABT_OP(I64Eqz)
         CHECK_TRAP(Unop(IntEqz<uint32_t, uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Extend8S:
+      WABT_OP(I32Extend8S)
         CHECK_TRAP(Unop(IntExtendS<uint32_t, int8_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32Extend16S:
+      WABT_OP(I32Extend16S)
         CHECK_TRAP(Unop(IntExtendS<uint32_t, int16_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Extend8S:
+      WABT_OP(I64Extend8S)
         CHECK_TRAP(Unop(IntExtendS<uint64_t, int8_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Extend16S:
+      WABT_OP(I64Extend16S)
         CHECK_TRAP(Unop(IntExtendS<uint64_t, int16_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64Extend32S:
+      WABT_OP(I64Extend32S)
         CHECK_TRAP(Unop(IntExtendS<uint64_t, int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::InterpAlloca: {
+      WABT_OP(InterpAlloca) {
         uint32_t old_value_stack_top = value_stack_top_;
         size_t count = ReadU32(&pc);
         value_stack_top_ += count;
-        CHECK_STACK();
         memset(&value_stack_[old_value_stack_top], 0, count * sizeof(Value));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::InterpBrUnless: {
+      WABT_OP(InterpBrUnless) {
         IstreamOffset new_pc = ReadU32(&pc);
         if (!Pop<uint32_t>()) {
           GOTO(new_pc);
         }
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::Drop:
+      WABT_OP(Drop)
         (void)Pop();
-        break;
+        WABT_NEXT();
 
-      case Opcode::InterpDropKeep: {
-        uint32_t drop_count = ReadU32(&pc);
-        uint32_t keep_count = ReadU32(&pc);
+      WABT_OP(InterpDropKeep) {
+        uint32_t drop_count = ReadU32At(pc);
+        uint32_t keep_count = ReadU32At(pc + sizeof(uint32_t));
+        pc += 2 * sizeof(uint32_t);
         DropKeep(drop_count, keep_count);
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::Nop:
-        break;
+      WABT_OP(InterpBrDropKeep) {
+        uint32_t drop_count = ReadU32At(pc);
+        uint32_t keep_count = ReadU32At(pc + sizeof(uint32_t));
+        IstreamOffset new_pc = ReadU32At(pc + 2 * sizeof(uint32_t));
+        pc += 3 * sizeof(uint32_t);
+        DropKeep(drop_count, keep_count);
+        GOTO(new_pc);
+        WABT_NEXT();
+      }
 
-      case Opcode::I32AtomicWait:
-      case Opcode::I64AtomicWait:
-      case Opcode::AtomicNotify:
-        // TODO(binji): Implement.
-        TRAP(Unreachable);
-        break;
+      WABT_OP(InterpStackCheck) {
+        // Emitted at each function's entry with the function's peak value
+        // stack depth (locals plus operands); checking the whole frame here
+        // once is what lets Push be an unchecked store.
+        uint32_t depth = ReadU32(&pc);
+        TRAP_IF(value_stack_top_ + depth > value_stack_.size(),
+                ValueStackExhausted);
+        WABT_NEXT();
+      }
 
-      case Opcode::V128Const: {
+      WABT_OP(InterpLocalBinop) {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+        Value lhs = Pick(ReadU32At(pc + sizeof(uint32_t)));
+        Value rhs = Pick(ReadU32At(pc + 2 * sizeof(uint32_t)));
+        pc += 3 * sizeof(uint32_t);
+        CHECK_TRAP(RunLocalBinop(binop, lhs, rhs));
+        WABT_NEXT();
+      }
+
+      WABT_OP(InterpLocalBinopSet) {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+        Value lhs = Pick(ReadU32At(pc + sizeof(uint32_t)));
+        Value rhs = Pick(ReadU32At(pc + 2 * sizeof(uint32_t)));
+        // The destination depth counts from the stack top after the result is
+        // popped, so Pick must wait for the Pop; the index itself doesn't.
+        uint32_t dst = ReadU32At(pc + 3 * sizeof(uint32_t));
+        pc += 4 * sizeof(uint32_t);
+        CHECK_TRAP(RunLocalBinop(binop, lhs, rhs));
+        Value value = Pop();
+        Pick(dst) = value;
+        WABT_NEXT();
+      }
+
+      WABT_OP(InterpLocalConstBinop) {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+        Value lhs = Pick(ReadU32At(pc + sizeof(uint32_t)));
+        Value rhs = MakeLocalConstOperand(
+            binop, ReadU64At(pc + 2 * sizeof(uint32_t)));
+        pc += 2 * sizeof(uint32_t) + sizeof(uint64_t);
+        CHECK_TRAP(RunLocalBinop(binop, lhs, rhs));
+        WABT_NEXT();
+      }
+
+      WABT_OP(InterpLocalConstBinopSet) {
+        Opcode binop(static_cast<Opcode::Enum>(ReadU32At(pc)));
+        Value lhs = Pick(ReadU32At(pc + sizeof(uint32_t)));
+        Value rhs = MakeLocalConstOperand(
+            binop, ReadU64At(pc + 2 * sizeof(uint32_t)));
+        uint32_t dst =
+            ReadU32At(pc + 2 * sizeof(uint32_t) + sizeof(uint64_t));
+        pc += 3 * sizeof(uint32_t) + sizeof(uint64_t);
+        CHECK_TRAP(RunLocalBinop(binop, lhs, rhs));
+        Value value = Pop();
+        Pick(dst) = value;
+        WABT_NEXT();
+      }
+
+      WABT_OP(Nop)
+        WABT_NEXT();
+
+      WABT_OP(I32AtomicWait)
+        CHECK_TRAP(AtomicWait<uint32_t>(&pc));
+        WABT_NEXT();
+
+      WABT_OP(I64AtomicWait)
+        CHECK_TRAP(AtomicWait<uint64_t>(&pc));
+        WABT_NEXT();
+
+      WABT_OP(AtomicNotify)
+        CHECK_TRAP(AtomicNotify(&pc));
+        WABT_NEXT();
+
+      WABT_OP(V128Const) {
         CHECK_TRAP(PushRep<v128>(ReadV128(&pc)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::V128Load:
+      WABT_OP(V128Load)
         CHECK_TRAP(Load<v128>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::V128Store:
+      WABT_OP(V128Store)
         CHECK_TRAP(Store<v128>(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16Splat: {
+      WABT_OP(I8X16Splat) {
         uint8_t lane_data = Pop<uint32_t>();
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint8_t>(lane_data)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8Splat: {
+      WABT_OP(I16X8Splat) {
         uint16_t lane_data = Pop<uint32_t>();
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint16_t>(lane_data)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4Splat: {
+      WABT_OP(I32X4Splat) {
         uint32_t lane_data = Pop<uint32_t>();
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint32_t>(lane_data)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2Splat: {
+      WABT_OP(I64X2Splat) {
         uint64_t lane_data = Pop<uint64_t>();
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint64_t>(lane_data)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F32X4Splat: {
+      WABT_OP(F32X4Splat) {
         float lane_data = Pop<float>();
         CHECK_TRAP(Push<v128>(SimdSplat<v128, float>(lane_data)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F64X2Splat: {
+      WABT_OP(F64X2Splat) {
         double lane_data = Pop<double>();
         CHECK_TRAP(Push<v128>(SimdSplat<v128, double>(lane_data)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16ExtractLaneS: {
+      WABT_OP(I8X16ExtractLaneS) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<int32_t>(
             SimdExtractLane<int32_t, v128, int8_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16ExtractLaneU: {
+      WABT_OP(I8X16ExtractLaneU) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<int32_t>(
             SimdExtractLane<int32_t, v128, uint8_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8ExtractLaneS: {
+      WABT_OP(I16X8ExtractLaneS) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<int32_t>(
             SimdExtractLane<int32_t, v128, int16_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8ExtractLaneU: {
+      WABT_OP(I16X8ExtractLaneU) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<int32_t>(
             SimdExtractLane<int32_t, v128, uint16_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4ExtractLane: {
+      WABT_OP(I32X4ExtractLane) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<int32_t>(
             SimdExtractLane<int32_t, v128, int32_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2ExtractLane: {
+      WABT_OP(I64X2ExtractLane) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<int64_t>(
             SimdExtractLane<int64_t, v128, int64_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F32X4ExtractLane: {
+      WABT_OP(F32X4ExtractLane) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<float>(
             SimdExtractLane<int32_t, v128, int32_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F64X2ExtractLane: {
+      WABT_OP(F64X2ExtractLane) {
         v128 lane_val = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(PushRep<double>(
             SimdExtractLane<int64_t, v128, int64_t>(lane_val, lane_idx)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16ReplaceLane: {
+      WABT_OP(I8X16ReplaceLane) {
         int8_t lane_val = static_cast<int8_t>(Pop<int32_t>());
         v128 value = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(Push<v128>(
             SimdReplaceLane<v128, v128, int8_t>(value, lane_idx, lane_val)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8ReplaceLane: {
+      WABT_OP(I16X8ReplaceLane) {
         int16_t lane_val = static_cast<int16_t>(Pop<int32_t>());
         v128 value = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(Push<v128>(
             SimdReplaceLane<v128, v128, int16_t>(value, lane_idx, lane_val)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4ReplaceLane: {
+      WABT_OP(I32X4ReplaceLane) {
         int32_t lane_val = Pop<int32_t>();
         v128 value = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(Push<v128>(
             SimdReplaceLane<v128, v128, int32_t>(value, lane_idx, lane_val)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2ReplaceLane: {
+      WABT_OP(I64X2ReplaceLane) {
         int64_t lane_val = Pop<int64_t>();
         v128 value = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(Push<v128>(
             SimdReplaceLane<v128, v128, int64_t>(value, lane_idx, lane_val)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F32X4ReplaceLane: {
+      WABT_OP(F32X4ReplaceLane) {
         float lane_val = Pop<float>();
         v128 value = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(Push<v128>(
             SimdReplaceLane<v128, v128, float>(value, lane_idx, lane_val)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::F64X2ReplaceLane: {
+      WABT_OP(F64X2ReplaceLane) {
         double lane_val = Pop<double>();
         v128 value = static_cast<v128>(Pop<v128>());
         uint32_t lane_idx = ReadU8(&pc);
         CHECK_TRAP(Push<v128>(
             SimdReplaceLane<v128, v128, double>(value, lane_idx, lane_val)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::V8X16Swizzle: {
+      WABT_OP(V8X16Swizzle) {
         const int32_t lanes = 16;
         // Define SIMD data array for SIMD add by lanes.
         int8_t simd_data_ret[lanes];
@@ -2973,10 +4713,10 @@ Result Thread::Run(int num_instructions) {
         }
 
         CHECK_TRAP(PushRep<v128>(Bitcast<v128>(simd_data_ret)));
-        break;
+        WABT_NEXT();
       }
 
-    case Opcode::V8X16Shuffle: {
+    WABT_OP(V8X16Shuffle) {
         const int32_t lanes = 16;
         // Define SIMD data array for SIMD add by lanes.
         int8_t simd_data_ret[lanes];
@@ -3001,242 +4741,261 @@ Result Thread::Run(int num_instructions) {
         }
 
         CHECK_TRAP(PushRep<v128>(Bitcast<v128>(simd_data_ret)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16LoadSplat: {
+      WABT_OP(I8X16LoadSplat) {
           CHECK_TRAP(Load<uint8_t, uint32_t>(&pc));
           uint8_t lane_data = Pop<uint32_t>();
           CHECK_TRAP(Push<v128>(SimdSplat<v128, uint8_t>(lane_data)));
-          break;
+          WABT_NEXT();
       }
 
-      case Opcode::I16X8LoadSplat: {
+      WABT_OP(I16X8LoadSplat) {
           CHECK_TRAP(Load<uint16_t, uint32_t>(&pc));
           uint16_t lane_data = Pop<uint32_t>();
           CHECK_TRAP(Push<v128>(SimdSplat<v128, uint16_t>(lane_data)));
-          break;
+          WABT_NEXT();
       }
 
-      case Opcode::I32X4LoadSplat: {
+      WABT_OP(I32X4LoadSplat) {
           CHECK_TRAP(Load<uint32_t, uint32_t>(&pc));
           uint32_t lane_data = Pop<uint32_t>();
           CHECK_TRAP(Push<v128>(SimdSplat<v128, uint32_t>(lane_data)));
-          break;
+          WABT_NEXT();
       }
 
-      case Opcode::I64X2LoadSplat: {
+      WABT_OP(I64X2LoadSplat) {
           CHECK_TRAP(Load<uint64_t, uint64_t>(&pc));
           uint64_t lane_data = Pop<uint64_t>();
           CHECK_TRAP(Push<v128>(SimdSplat<v128, uint64_t>(lane_data)));
-          break;
+          WABT_NEXT();
       }
 
-      case Opcode::I8X16Add:
-        CHECK_TRAP(SimdBinop<v128, uint8_t>(Add<uint32_t>));
-        break;
-
-      case Opcode::I16X8Add:
-        CHECK_TRAP(SimdBinop<v128, uint16_t>(Add<uint32_t>));
-        break;
-
-      case Opcode::I32X4Add:
-        CHECK_TRAP(SimdBinop<v128, uint32_t>(Add<uint32_t>));
-        break;
-
-      case Opcode::I64X2Add:
-        CHECK_TRAP(SimdBinop<v128, uint64_t>(Add<uint64_t>));
-        break;
-
-      case Opcode::I8X16Sub:
-        CHECK_TRAP(SimdBinop<v128, uint8_t>(Sub<uint32_t>));
-        break;
-
-      case Opcode::I16X8Sub:
-        CHECK_TRAP(SimdBinop<v128, uint16_t>(Sub<uint32_t>));
-        break;
-
-      case Opcode::I32X4Sub:
-        CHECK_TRAP(SimdBinop<v128, uint32_t>(Sub<uint32_t>));
-        break;
-
-      case Opcode::I64X2Sub:
-        CHECK_TRAP(SimdBinop<v128, uint64_t>(Sub<uint64_t>));
-        break;
-
-      case Opcode::I8X16Mul:
-        CHECK_TRAP(SimdBinop<v128, uint8_t>(Mul<uint32_t>));
-        break;
-
-      case Opcode::I16X8Mul:
-        CHECK_TRAP(SimdBinop<v128, uint16_t>(Mul<uint32_t>));
-        break;
-
-      case Opcode::I32X4Mul:
-        CHECK_TRAP(SimdBinop<v128, uint32_t>(Mul<uint32_t>));
-        break;
-
-      case Opcode::I8X16Neg:
-        CHECK_TRAP(SimdUnop<v128, int8_t>(IntNeg<int32_t>));
-        break;
-
-      case Opcode::I16X8Neg:
-        CHECK_TRAP(SimdUnop<v128, int16_t>(IntNeg<int32_t>));
-        break;
-
-      case Opcode::I32X4Neg:
-        CHECK_TRAP(SimdUnop<v128, int32_t>(IntNeg<int32_t>));
-        break;
-
-      case Opcode::I64X2Neg:
-        CHECK_TRAP(SimdUnop<v128, int64_t>(IntNeg<int64_t>));
-        break;
-
-      case Opcode::I8X16AddSaturateS:
+      WABT_OP(I8X16Add)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u8x16, VecAdd<u8x16>, uint8_t,
+                                     Add<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I16X8Add)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u16x8, VecAdd<u16x8>, uint16_t,
+                                     Add<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I32X4Add)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u32x4, VecAdd<u32x4>, uint32_t,
+                                     Add<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I64X2Add)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u64x2, VecAdd<u64x2>, uint64_t,
+                                     Add<uint64_t>));
+        WABT_NEXT();
+
+      WABT_OP(I8X16Sub)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u8x16, VecSub<u8x16>, uint8_t,
+                                     Sub<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I16X8Sub)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u16x8, VecSub<u16x8>, uint16_t,
+                                     Sub<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I32X4Sub)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u32x4, VecSub<u32x4>, uint32_t,
+                                     Sub<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I64X2Sub)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u64x2, VecSub<u64x2>, uint64_t,
+                                     Sub<uint64_t>));
+        WABT_NEXT();
+
+      WABT_OP(I8X16Mul)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u8x16, VecMul<u8x16>, uint8_t,
+                                     Mul<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I16X8Mul)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u16x8, VecMul<u16x8>, uint16_t,
+                                     Mul<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I32X4Mul)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u32x4, VecMul<u32x4>, uint32_t,
+                                     Mul<uint32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I8X16Neg)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u8x16, VecNeg<u8x16>, int8_t,
+                                    IntNeg<int32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I16X8Neg)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u16x8, VecNeg<u16x8>, int16_t,
+                                    IntNeg<int32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I32X4Neg)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u32x4, VecNeg<u32x4>, int32_t,
+                                    IntNeg<int32_t>));
+        WABT_NEXT();
+
+      WABT_OP(I64X2Neg)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u64x2, VecNeg<u64x2>, int64_t,
+                                    IntNeg<int64_t>));
+        WABT_NEXT();
+
+      WABT_OP(I8X16AddSaturateS)
         CHECK_TRAP(SimdBinop<v128, int8_t>(AddSaturate<int32_t, int8_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16AddSaturateU:
+      WABT_OP(I8X16AddSaturateU)
         CHECK_TRAP(SimdBinop<v128, uint8_t>(AddSaturate<uint32_t, uint8_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8AddSaturateS:
+      WABT_OP(I16X8AddSaturateS)
         CHECK_TRAP(SimdBinop<v128, int16_t>(AddSaturate<int32_t, int16_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8AddSaturateU:
+      WABT_OP(I16X8AddSaturateU)
         CHECK_TRAP(SimdBinop<v128, uint16_t>(AddSaturate<uint32_t, uint16_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16SubSaturateS:
+      WABT_OP(I8X16SubSaturateS)
         CHECK_TRAP(SimdBinop<v128, int8_t>(SubSaturate<int32_t, int8_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16SubSaturateU:
+      WABT_OP(I8X16SubSaturateU)
         CHECK_TRAP(SimdBinop<v128, uint8_t>(SubSaturate<int32_t, uint8_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8SubSaturateS:
+      WABT_OP(I16X8SubSaturateS)
         CHECK_TRAP(SimdBinop<v128, int16_t>(SubSaturate<int32_t, int16_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8SubSaturateU:
+      WABT_OP(I16X8SubSaturateU)
         CHECK_TRAP(SimdBinop<v128, uint16_t>(SubSaturate<int32_t, uint16_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16Shl: {
+      WABT_OP(I8X16Shl) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 8;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint8_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint8_t>(IntShl<uint32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8Shl: {
+      WABT_OP(I16X8Shl) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 16;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint16_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint16_t>(IntShl<uint32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4Shl: {
+      WABT_OP(I32X4Shl) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 32;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint32_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint32_t>(IntShl<uint32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2Shl: {
+      WABT_OP(I64X2Shl) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 64;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint64_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint64_t>(IntShl<uint64_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16ShrS: {
+      WABT_OP(I8X16ShrS) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 8;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint8_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, int8_t>(IntShr<int32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16ShrU: {
+      WABT_OP(I8X16ShrU) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 8;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint8_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint8_t>(IntShr<uint32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8ShrS: {
+      WABT_OP(I16X8ShrS) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 16;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint16_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, int16_t>(IntShr<int32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8ShrU: {
+      WABT_OP(I16X8ShrU) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 16;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint16_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint16_t>(IntShr<uint32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4ShrS: {
+      WABT_OP(I32X4ShrS) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 32;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint32_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, int32_t>(IntShr<int32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4ShrU: {
+      WABT_OP(I32X4ShrU) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 32;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint32_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint32_t>(IntShr<uint32_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2ShrS: {
+      WABT_OP(I64X2ShrS) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 64;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint64_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, int64_t>(IntShr<int64_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2ShrU: {
+      WABT_OP(I64X2ShrU) {
         uint32_t shift_count = Pop<uint32_t>();
         shift_count = shift_count % 64;
         CHECK_TRAP(Push<v128>(SimdSplat<v128, uint64_t>(shift_count)));
         CHECK_TRAP(SimdBinop<v128, uint64_t>(IntShr<uint64_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::V128And:
-        CHECK_TRAP(SimdBinop<v128, uint64_t>(IntAnd<uint64_t>));
-        break;
+      WABT_OP(V128And)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u64x2, VecAnd<u64x2>, uint64_t,
+                                     IntAnd<uint64_t>));
+        WABT_NEXT();
 
-      case Opcode::V128Or:
-        CHECK_TRAP(SimdBinop<v128, uint64_t>(IntOr<uint64_t>));
-        break;
+      WABT_OP(V128Or)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u64x2, VecOr<u64x2>, uint64_t,
+                                     IntOr<uint64_t>));
+        WABT_NEXT();
 
-      case Opcode::V128Xor:
-        CHECK_TRAP(SimdBinop<v128, uint64_t>(IntXor<uint64_t>));
-        break;
+      WABT_OP(V128Xor)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(u64x2, VecXor<u64x2>, uint64_t,
+                                     IntXor<uint64_t>));
+        WABT_NEXT();
 
-      case Opcode::V128Not:
-        CHECK_TRAP(SimdUnop<v128, uint64_t>(IntNot<uint64_t>));
-        break;
+      WABT_OP(V128Not)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u64x2, VecNot<u64x2>, uint64_t,
+                                    IntNot<uint64_t>));
+        WABT_NEXT();
 
-      case Opcode::V128BitSelect: {
+      WABT_OP(V128BitSelect) {
         // Follow Wasm Simd spec to compute V128BitSelect:
         // v128.or(v128.and(v1, c), v128.and(v2, v128.not(c)))
         v128 c_mask = PopRep<v128>();
@@ -3253,406 +5012,434 @@ Result Thread::Run(int num_instructions) {
         CHECK_TRAP(SimdBinop<v128, uint64_t>(IntAnd<uint64_t>));
         // 3. v128.or( 1 , 2)
         CHECK_TRAP(SimdBinop<v128, uint64_t>(IntOr<uint64_t>));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16AnyTrue: {
+      WABT_OP(I8X16AnyTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint8_t>(value, 1)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8AnyTrue: {
+      WABT_OP(I16X8AnyTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint16_t>(value, 1)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4AnyTrue: {
+      WABT_OP(I32X4AnyTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint32_t>(value, 1)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2AnyTrue: {
+      WABT_OP(I64X2AnyTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint64_t>(value, 1)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16AllTrue: {
+      WABT_OP(I8X16AllTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint8_t>(value, 16)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I16X8AllTrue: {
+      WABT_OP(I16X8AllTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint16_t>(value, 8)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I32X4AllTrue: {
+      WABT_OP(I32X4AllTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint32_t>(value, 4)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I64X2AllTrue: {
+      WABT_OP(I64X2AllTrue) {
         v128 value = PopRep<v128>();
         CHECK_TRAP(Push<int32_t>(SimdIsLaneTrue<v128, uint64_t>(value, 2)));
-        break;
+        WABT_NEXT();
       }
 
-      case Opcode::I8X16Eq:
+      WABT_OP(I8X16Eq)
         CHECK_TRAP(SimdRelBinop<v128, int8_t>(Eq<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8Eq:
+      WABT_OP(I16X8Eq)
         CHECK_TRAP(SimdRelBinop<v128, int16_t>(Eq<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4Eq:
+      WABT_OP(I32X4Eq)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Eq<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Eq:
+      WABT_OP(F32X4Eq)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Eq<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Eq:
+      WABT_OP(F64X2Eq)
         CHECK_TRAP(SimdRelBinop<v128, int64_t>(Eq<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16Ne:
+      WABT_OP(I8X16Ne)
         CHECK_TRAP(SimdRelBinop<v128, int8_t>(Ne<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8Ne:
+      WABT_OP(I16X8Ne)
         CHECK_TRAP(SimdRelBinop<v128, int16_t>(Ne<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4Ne:
+      WABT_OP(I32X4Ne)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Ne<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Ne:
+      WABT_OP(F32X4Ne)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Ne<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Ne:
+      WABT_OP(F64X2Ne)
         CHECK_TRAP(SimdRelBinop<v128, int64_t>(Ne<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16LtS:
+      WABT_OP(I8X16LtS)
         CHECK_TRAP(SimdRelBinop<v128, int8_t>(Lt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16LtU:
+      WABT_OP(I8X16LtU)
         CHECK_TRAP(SimdRelBinop<v128, uint8_t>(Lt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8LtS:
+      WABT_OP(I16X8LtS)
         CHECK_TRAP(SimdRelBinop<v128, int16_t>(Lt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8LtU:
+      WABT_OP(I16X8LtU)
         CHECK_TRAP(SimdRelBinop<v128, uint16_t>(Lt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4LtS:
+      WABT_OP(I32X4LtS)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Lt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4LtU:
+      WABT_OP(I32X4LtU)
         CHECK_TRAP(SimdRelBinop<v128, uint32_t>(Lt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Lt:
+      WABT_OP(F32X4Lt)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Lt<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Lt:
+      WABT_OP(F64X2Lt)
         CHECK_TRAP(SimdRelBinop<v128, int64_t>(Lt<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16LeS:
+      WABT_OP(I8X16LeS)
         CHECK_TRAP(SimdRelBinop<v128, int8_t>(Le<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16LeU:
+      WABT_OP(I8X16LeU)
         CHECK_TRAP(SimdRelBinop<v128, uint8_t>(Le<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8LeS:
+      WABT_OP(I16X8LeS)
         CHECK_TRAP(SimdRelBinop<v128, int16_t>(Le<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8LeU:
+      WABT_OP(I16X8LeU)
         CHECK_TRAP(SimdRelBinop<v128, uint16_t>(Le<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4LeS:
+      WABT_OP(I32X4LeS)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Le<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4LeU:
+      WABT_OP(I32X4LeU)
         CHECK_TRAP(SimdRelBinop<v128, uint32_t>(Le<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Le:
+      WABT_OP(F32X4Le)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Le<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Le:
+      WABT_OP(F64X2Le)
         CHECK_TRAP(SimdRelBinop<v128, int64_t>(Le<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16GtS:
+      WABT_OP(I8X16GtS)
         CHECK_TRAP(SimdRelBinop<v128, int8_t>(Gt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16GtU:
+      WABT_OP(I8X16GtU)
         CHECK_TRAP(SimdRelBinop<v128, uint8_t>(Gt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8GtS:
+      WABT_OP(I16X8GtS)
         CHECK_TRAP(SimdRelBinop<v128, int16_t>(Gt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8GtU:
+      WABT_OP(I16X8GtU)
         CHECK_TRAP(SimdRelBinop<v128, uint16_t>(Gt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4GtS:
+      WABT_OP(I32X4GtS)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Gt<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4GtU:
+      WABT_OP(I32X4GtU)
         CHECK_TRAP(SimdRelBinop<v128, uint32_t>(Gt<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Gt:
+      WABT_OP(F32X4Gt)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Gt<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Gt:
+      WABT_OP(F64X2Gt)
         CHECK_TRAP(SimdRelBinop<v128, int64_t>(Gt<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16GeS:
+      WABT_OP(I8X16GeS)
         CHECK_TRAP(SimdRelBinop<v128, int8_t>(Ge<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I8X16GeU:
+      WABT_OP(I8X16GeU)
         CHECK_TRAP(SimdRelBinop<v128, uint8_t>(Ge<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8GeS:
+      WABT_OP(I16X8GeS)
         CHECK_TRAP(SimdRelBinop<v128, int16_t>(Ge<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I16X8GeU:
+      WABT_OP(I16X8GeU)
         CHECK_TRAP(SimdRelBinop<v128, uint16_t>(Ge<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4GeS:
+      WABT_OP(I32X4GeS)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Ge<int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4GeU:
+      WABT_OP(I32X4GeU)
         CHECK_TRAP(SimdRelBinop<v128, uint32_t>(Ge<uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Ge:
+      WABT_OP(F32X4Ge)
         CHECK_TRAP(SimdRelBinop<v128, int32_t>(Ge<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Ge:
+      WABT_OP(F64X2Ge)
         CHECK_TRAP(SimdRelBinop<v128, int64_t>(Ge<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Neg:
-        CHECK_TRAP(SimdUnop<v128, int32_t>(FloatNeg<float>));
-        break;
+      WABT_OP(F32X4Neg)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u32x4, VecFloatNegF32, int32_t,
+                                    FloatNeg<float>));
+        WABT_NEXT();
 
-      case Opcode::F64X2Neg:
-        CHECK_TRAP(SimdUnop<v128, int64_t>(FloatNeg<double>));
-        break;
+      WABT_OP(F64X2Neg)
+        CHECK_TRAP(SIMD_NATIVE_UNOP(u64x2, VecFloatNegF64, int64_t,
+                                    FloatNeg<double>));
+        WABT_NEXT();
 
-      case Opcode::F32X4Abs:
+      WABT_OP(F32X4Abs)
         CHECK_TRAP(SimdUnop<v128, int32_t>(FloatAbs<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Abs:
+      WABT_OP(F64X2Abs)
         CHECK_TRAP(SimdUnop<v128, int64_t>(FloatAbs<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Min:
+      WABT_OP(F32X4Min)
         CHECK_TRAP(SimdBinop<v128, int32_t>(FloatMin<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Min:
+      WABT_OP(F64X2Min)
         CHECK_TRAP(SimdBinop<v128, int64_t>(FloatMin<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4Max:
+      WABT_OP(F32X4Max)
         CHECK_TRAP(SimdBinop<v128, int32_t>(FloatMax<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Max:
+      WABT_OP(F64X2Max)
         CHECK_TRAP(SimdBinop<v128, int64_t>(FloatMax<double>));
-        break;
-
-      case Opcode::F32X4Add:
-        CHECK_TRAP(SimdBinop<v128, int32_t>(Add<float>));
-        break;
-
-      case Opcode::F64X2Add:
-        CHECK_TRAP(SimdBinop<v128, int64_t>(Add<double>));
-        break;
-
-      case Opcode::F32X4Sub:
-        CHECK_TRAP(SimdBinop<v128, int32_t>(Sub<float>));
-        break;
-
-      case Opcode::F64X2Sub:
-        CHECK_TRAP(SimdBinop<v128, int64_t>(Sub<double>));
-        break;
-
-      case Opcode::F32X4Div:
-        CHECK_TRAP(SimdBinop<v128, int32_t>(FloatDiv<float>));
-        break;
-
-      case Opcode::F64X2Div:
-        CHECK_TRAP(SimdBinop<v128, int64_t>(FloatDiv<double>));
-        break;
-
-      case Opcode::F32X4Mul:
-        CHECK_TRAP(SimdBinop<v128, int32_t>(Mul<float>));
-        break;
-
-      case Opcode::F64X2Mul:
-        CHECK_TRAP(SimdBinop<v128, int64_t>(Mul<double>));
-        break;
-
-      case Opcode::F32X4Sqrt:
+        WABT_NEXT();
+
+      WABT_OP(F32X4Add)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f32x4, VecFloatAdd<f32x4>, int32_t,
+                                     Add<float>));
+        WABT_NEXT();
+
+      WABT_OP(F64X2Add)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f64x2, VecFloatAdd<f64x2>, int64_t,
+                                     Add<double>));
+        WABT_NEXT();
+
+      WABT_OP(F32X4Sub)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f32x4, VecFloatSub<f32x4>, int32_t,
+                                     Sub<float>));
+        WABT_NEXT();
+
+      WABT_OP(F64X2Sub)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f64x2, VecFloatSub<f64x2>, int64_t,
+                                     Sub<double>));
+        WABT_NEXT();
+
+      WABT_OP(F32X4Div)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f32x4, VecFloatDiv<f32x4>, int32_t,
+                                     FloatDiv<float>));
+        WABT_NEXT();
+
+      WABT_OP(F64X2Div)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f64x2, VecFloatDiv<f64x2>, int64_t,
+                                     FloatDiv<double>));
+        WABT_NEXT();
+
+      WABT_OP(F32X4Mul)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f32x4, VecFloatMul<f32x4>, int32_t,
+                                     Mul<float>));
+        WABT_NEXT();
+
+      WABT_OP(F64X2Mul)
+        CHECK_TRAP(SIMD_NATIVE_BINOP(f64x2, VecFloatMul<f64x2>, int64_t,
+                                     Mul<double>));
+        WABT_NEXT();
+
+      WABT_OP(F32X4Sqrt)
         CHECK_TRAP(SimdUnop<v128, int32_t>(FloatSqrt<float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2Sqrt:
+      WABT_OP(F64X2Sqrt)
         CHECK_TRAP(SimdUnop<v128, int64_t>(FloatSqrt<double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4ConvertI32X4S:
+      WABT_OP(F32X4ConvertI32X4S)
         CHECK_TRAP(SimdUnop<v128, int32_t>(SimdConvert<float, int32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F32X4ConvertI32X4U:
+      WABT_OP(F32X4ConvertI32X4U)
         CHECK_TRAP(SimdUnop<v128, uint32_t>(SimdConvert<float, uint32_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2ConvertI64X2S:
+      WABT_OP(F64X2ConvertI64X2S)
         CHECK_TRAP(SimdUnop<v128, int64_t>(SimdConvert<double, int64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::F64X2ConvertI64X2U:
+      WABT_OP(F64X2ConvertI64X2U)
         CHECK_TRAP(SimdUnop<v128, uint64_t>(SimdConvert<double, uint64_t>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4TruncSatF32X4S:
+      WABT_OP(I32X4TruncSatF32X4S)
         CHECK_TRAP(SimdUnop<v128, int32_t>(IntTruncSat<int32_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I32X4TruncSatF32X4U:
+      WABT_OP(I32X4TruncSatF32X4U)
         CHECK_TRAP(SimdUnop<v128, uint32_t>(IntTruncSat<uint32_t, float>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64X2TruncSatF64X2S:
+      WABT_OP(I64X2TruncSatF64X2S)
         CHECK_TRAP(SimdUnop<v128, int64_t>(IntTruncSat<int64_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::I64X2TruncSatF64X2U:
+      WABT_OP(I64X2TruncSatF64X2U)
         CHECK_TRAP(SimdUnop<v128, uint64_t>(IntTruncSat<uint64_t, double>));
-        break;
+        WABT_NEXT();
 
-      case Opcode::RefIsNull:
+      WABT_OP(RefIsNull)
         CHECK_TRAP(Unop(RefIsNull));
-        break;
+        WABT_NEXT();
 
-      case Opcode::TableGet:
+      WABT_OP(TableGet)
         CHECK_TRAP(TableGet(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::TableSet:
+      WABT_OP(TableSet)
         CHECK_TRAP(TableSet(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::RefFunc:
+      WABT_OP(RefFunc)
         CHECK_TRAP(RefFunc(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::RefNull:
+      WABT_OP(RefNull)
         CHECK_TRAP(Push(Ref{RefType::Null, kInvalidIndex}));
-        break;
+        WABT_NEXT();
 
-      case Opcode::TableGrow:
-      case Opcode::TableSize:
+      WABT_OP(TableGrow)
+      WABT_OP(TableSize)
         WABT_UNREACHABLE;
-        break;
+        WABT_NEXT();
 
-      case Opcode::MemoryInit:
+      WABT_OP(MemoryInit)
         CHECK_TRAP(MemoryInit(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::DataDrop:
+      WABT_OP(DataDrop)
         CHECK_TRAP(DataDrop(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::MemoryCopy:
+      WABT_OP(MemoryCopy)
         CHECK_TRAP(MemoryCopy(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::MemoryFill:
+      WABT_OP(MemoryFill)
         CHECK_TRAP(MemoryFill(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::TableInit:
+      WABT_OP(TableInit)
         CHECK_TRAP(TableInit(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::ElemDrop:
+      WABT_OP(ElemDrop)
         CHECK_TRAP(ElemDrop(&pc));
-        break;
+        WABT_NEXT();
 
-      case Opcode::TableCopy:
+      WABT_OP(TableCopy)
         CHECK_TRAP(TableCopy(&pc));
-        break;
+        WABT_NEXT();
 
       // The following opcodes are either never generated or should never be
       // executed.
-      case Opcode::Block:
-      case Opcode::BrOnExn:
-      case Opcode::Catch:
-      case Opcode::Else:
-      case Opcode::End:
-      case Opcode::If:
-      case Opcode::InterpData:
-      case Opcode::Invalid:
-      case Opcode::Loop:
-      case Opcode::Rethrow:
-      case Opcode::Throw:
-      case Opcode::Try:
+      WABT_OP(Block)
+      WABT_OP(BrOnExn)
+      WABT_OP(Catch)
+      WABT_OP(Else)
+      WABT_OP(End)
+      WABT_OP(If)
+      WABT_OP(InterpData)
+      WABT_OP(Invalid)
+      WABT_OP(Loop)
+      WABT_OP(Rethrow)
+      WABT_OP(Throw)
+      WABT_OP(Try)
         WABT_UNREACHABLE;
-        break;
+        WABT_NEXT();
+#if !WABT_USE_COMPUTED_GOTO
+    }
+    if (WABT_UNLIKELY(single_step_)) {
+      break;
     }
   }
+#endif
 
 exit_loop:
+  // Settle the fuel this slice consumed against the quota. Traps return
+  // directly without passing here; their partial slice goes unbilled, which
+  // only ever under-counts.
+  if (WABT_UNLIKELY(fuel_remaining_ != UINT64_MAX)) {
+    fuel_remaining_ -= entry_fuel - fuel;
+  }
   pc_ = pc - istream;
   return result;
 }
 
+ResultType Thread::Step() {
+  single_step_ = true;
+  ResultType result = Run(1);
+  single_step_ = false;
+  return result;
+}
+
 Executor::Executor(Environment* env,
                    Stream* trace_stream,
                    const Thread::Options& options)
@@ -3667,7 +5454,7 @@ ExecResult Executor::RunFunction(Index func_index, const TypedValues& args) {
   exec_result.result = PushArgs(sig, args);
   if (exec_result.ok()) {
     exec_result.result =
-        func->is_host ? thread_.CallHost(cast<HostFunc>(func))
+        func->is_host ? MakeResult(thread_.CallHost(cast<HostFunc>(func)))
                       : RunDefinedFunction(cast<DefinedFunc>(func)->offset);
     if (exec_result.ok()) {
       CopyResults(sig, &exec_result.values);
@@ -3677,6 +5464,67 @@ ExecResult Executor::RunFunction(Index func_index, const TypedValues& args) {
   return exec_result;
 }
 
+Result Executor::BeginFunction(Index func_index,
+                               const TypedValues& args,
+                               CompletionCallback callback) {
+  assert(!running_);
+  Func* func = env_->GetFunc(func_index);
+  const FuncSignature* sig = env_->GetFuncSignature(func->sig_index);
+  thread_.Reset();
+  Result result = PushArgs(sig, args);
+  if (!result.ok()) {
+    return result;
+  }
+
+  // Host functions have no istream to meter; run them to completion here.
+  if (func->is_host) {
+    ExecResult exec_result;
+    exec_result.result = MakeResult(thread_.CallHost(cast<HostFunc>(func)));
+    if (exec_result.ok()) {
+      CopyResults(sig, &exec_result.values);
+    }
+    callback(std::move(exec_result));
+    return ResultType::Ok;
+  }
+  thread_.set_pc(cast<DefinedFunc>(func)->offset);
+  running_ = true;
+  running_sig_index_ = func->sig_index;
+  on_complete_ = std::move(callback);
+  return ResultType::Ok;
+}
+
+bool Executor::Resume(int fuel) {
+  assert(running_);
+  ResultType result = ResultType::Ok;
+  if (trace_stream_) {
+    // Single-step under tracing, as in RunDefinedFunction.
+    while (result == ResultType::Ok && fuel-- > 0) {
+      thread_.Trace(trace_stream_);
+      result = thread_.Step();
+    }
+  } else {
+    result = thread_.Run(fuel);
+  }
+  if (result == ResultType::Ok) {
+    // Out of fuel; the call is still suspended.
+    return true;
+  }
+
+  const FuncSignature* sig = env_->GetFuncSignature(running_sig_index_);
+  running_ = false;
+  running_sig_index_ = kInvalidIndex;
+  ExecResult exec_result;
+  exec_result.result = result == ResultType::Returned ? Result(ResultType::Ok)
+                                                      : MakeResult(result);
+  if (exec_result.ok()) {
+    CopyResults(sig, &exec_result.values);
+  }
+  CompletionCallback callback = std::move(on_complete_);
+  on_complete_ = nullptr;
+  callback(std::move(exec_result));
+  return false;
+}
+
 ExecResult Executor::Initialize(DefinedModule* module) {
   ExecResult exec_result;
   exec_result.result = InitializeSegments(module);
@@ -3701,6 +5549,19 @@ ExecResult Executor::RunStartFunction(DefinedModule* module) {
   return exec_result;
 }
 
+Result Executor::TrapMsg(ResultType type, const char* format, ...) {
+  va_list args;
+  va_list args_copy;
+  va_start(args, format);
+  va_copy(args_copy, args);
+  size_t len = wabt_vsnprintf(nullptr, 0, format, args) + 1;  // For \0.
+  va_end(args);
+  std::vector<char> buffer(len);
+  wabt_vsnprintf(buffer.data(), len, format, args_copy);
+  va_end(args_copy);
+  return Result(type, buffer.data());
+}
+
 Result Executor::InitializeSegments(DefinedModule* module) {
   // The MVP requires that all segments are bounds-checked before being copied
   // into the table or memory. The bulk memory proposal changes this behavior;
@@ -3731,14 +5592,14 @@ Result Executor::InitializeSegments(DefinedModule* module) {
     }
 
     for (const DataSegmentInfo& info : module->active_data_segments_) {
-      uint32_t memory_size = info.memory->data.size();
+      uint32_t memory_size = info.memory->data_size();
       uint32_t segment_size = info.data.size();
       uint32_t copy_size = segment_size;
       bool ok = ClampToBounds(info.dst, &copy_size, memory_size);
 
       if (pass == Init && copy_size > 0) {
         std::copy(info.data.begin(), info.data.begin() + copy_size,
-                  info.memory->data.begin() + info.dst);
+                  info.memory->data_begin() + info.dst);
       }
 
       if (!ok) {
@@ -3764,6 +5625,11 @@ ExecResult Executor::RunExport(const Export* export_, const TypedValues& args) {
   return RunFunction(export_->index, args);
 }
 
+ExecResult Executor::RunExport(const ExportHandle& handle,
+                               const TypedValues& args) {
+  return RunExport(env_->GetExport(handle), args);
+}
+
 ExecResult Executor::RunExportByName(Module* module,
                                      string_view name,
                                      const TypedValues& args) {
@@ -3778,22 +5644,21 @@ ExecResult Executor::RunExportByName(Module* module,
 }
 
 Result Executor::RunDefinedFunction(IstreamOffset function_offset) {
-  Result result = ResultType::Ok;
+  ResultType result = ResultType::Ok;
   thread_.set_pc(function_offset);
   if (trace_stream_) {
-    const int kNumInstructions = 1;
-    while (result.ok()) {
+    while (result == ResultType::Ok) {
       thread_.Trace(trace_stream_);
-      result = thread_.Run(kNumInstructions);
+      result = thread_.Step();
     }
   } else {
-    const int kNumInstructions = 1000;
-    while (result.ok()) {
-      result = thread_.Run(kNumInstructions);
+    const int kFuel = 1000;
+    while (result == ResultType::Ok) {
+      result = thread_.Run(kFuel);
     }
   }
-  if (result.type != ResultType::Returned) {
-    return result;
+  if (result != ResultType::Returned) {
+    return MakeResult(result);
   }
   // Use OK instead of RETURNED for consistency.
   return ResultType::Ok;
@@ -3804,20 +5669,53 @@ Result Executor::PushArgs(const FuncSignature* sig, const TypedValues& args) {
     return ResultType::ArgumentTypeMismatch;
   }
 
+  // Arguments are pushed before any function's stack_check runs, so check
+  // for room explicitly.
+  if (!thread_.HasValueStackRoom(args.size())) {
+    return ResultType::TrapValueStackExhausted;
+  }
+
   for (size_t i = 0; i < sig->param_types.size(); ++i) {
     if (TypeChecker::CheckType(args[i].type, sig->param_types[i]) !=
         wabt::Result::Ok) {
       return ResultType::ArgumentTypeMismatch;
     }
 
-    Result result = thread_.Push(args[i].value);
-    if (!result.ok()) {
+    ResultType result = thread_.Push(args[i].value);
+    if (result != ResultType::Ok) {
       return result;
     }
   }
   return ResultType::Ok;
 }
 
+ExecutorPool::ExecutorPool(Environment* env,
+                           Stream* trace_stream,
+                           const Thread::Options& options)
+    : env_(env), trace_stream_(trace_stream), options_(options) {}
+
+ExecutorPool::Handle ExecutorPool::Acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_.empty()) {
+    executors_.emplace_back(new Executor(env_, trace_stream_, options_));
+    free_.push_back(executors_.back().get());
+  }
+  Executor* executor = free_.back();
+  free_.pop_back();
+  return Handle(this, executor);
+}
+
+void ExecutorPool::Release(Executor* executor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_.push_back(executor);
+}
+
+ExecutorPool::Handle::~Handle() {
+  if (pool_) {
+    pool_->Release(executor_);
+  }
+}
+
 void Executor::CopyResults(const FuncSignature* sig, TypedValues* out_results) {
   size_t expected_results = sig->result_types.size();
   assert(expected_results == thread_.NumValues());
@@ -19,9 +19,13 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -72,6 +76,10 @@ namespace interp {
   V(TrapElemSegmentDropped, "element segment dropped")                      \
   /* table access is out of bounds */                                       \
   V(TrapTableAccessOutOfBounds, "out of bounds table access")               \
+  /* the thread consumed its Thread::Options::fuel_quota */                 \
+  V(TrapFuelQuotaExceeded, "fuel quota exceeded")                           \
+  /* the thread ran past its Thread::Options::wall_clock_limit_ms */        \
+  V(TrapWallClockLimitExceeded, "wall-clock limit exceeded")                \
   /* we attempted to call a function with the an argument list that doesn't \
    * match the function signature */                                        \
   V(ArgumentTypeMismatch, "argument type mismatch")                         \
@@ -107,6 +115,12 @@ struct FuncSignature {
 
   TypeVector param_types;
   TypeVector result_types;
+  // Index of the first signature registered in the environment with the same
+  // shape, assigned at registration (see
+  // Environment::EmplaceBackFuncSignature). Two signatures are equal iff
+  // their canonical indexes are equal, so the call_indirect signature check
+  // is a single integer compare.
+  Index canonical_index = kInvalidIndex;
 };
 
 enum class RefType {
@@ -132,19 +146,214 @@ struct Table {
   std::vector<Ref> entries;
 };
 
+// Guard-page-backed linear memory is only available on 64-bit POSIX hosts.
+#if (defined(__linux__) || defined(__APPLE__)) && SIZEOF_SIZE_T == 8
+#define WABT_HAS_GUARD_PAGES 1
+#else
+#define WABT_HAS_GUARD_PAGES 0
+#endif
+
+// A point-in-time copy of a Memory's contents, taken with
+// Memory::TakeSnapshot. On Linux the copy of a guard-page-backed memory
+// lives in an anonymous memfd and restoring remaps it over the memory in
+// one syscall, which discards the private copies of exactly the pages
+// written since the snapshot and shares the rest with it again; elsewhere
+// the contents are held and restored as a flat copy.
+class MemorySnapshot {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(MemorySnapshot);
+  MemorySnapshot() = default;
+  MemorySnapshot(MemorySnapshot&&);
+  MemorySnapshot& operator=(MemorySnapshot&&);
+  ~MemorySnapshot();
+
+ private:
+  friend struct Memory;
+
+  void Close();
+
+  Limits page_limits_;
+  size_t size_ = 0;
+  int fd_ = -1;             // memfd holding the contents, or -1.
+  std::vector<char> copy_;  // The contents when fd_ < 0.
+};
+
+// Placement hints for a Memory's data pages; see
+// Environment::set_memory_policy. Both hints are best-effort: hosts that
+// can't honor them silently fall back to default placement.
+struct MemoryAllocationPolicy {
+  // Ask the kernel to back the data region with huge pages
+  // (madvise(MADV_HUGEPAGE) on Linux), cutting TLB misses on large heaps.
+  bool use_huge_pages = false;
+  // Bind the data pages to this NUMA node instead of whichever node first
+  // touches them; -1 leaves placement to the kernel.
+  int numa_node = -1;
+};
+
 struct Memory {
   Memory() = default;
-  explicit Memory(const Limits& limits)
-      : page_limits(limits), data(limits.initial * WABT_PAGE_SIZE) {}
+  explicit Memory(
+      const Limits& limits,
+      bool use_guard_pages = false,
+      const MemoryAllocationPolicy& policy = MemoryAllocationPolicy())
+      : page_limits(limits), policy_(policy) {
+#if WABT_HAS_GUARD_PAGES
+    if (use_guard_pages && AllocateGuarded(limits.initial * WABT_PAGE_SIZE)) {
+      ApplyAllocationPolicy();
+      return;
+    }
+#endif
+    data.resize(limits.initial * WABT_PAGE_SIZE);
+    ApplyAllocationPolicy();
+  }
+  Memory(Memory&& other) { *this = std::move(other); }
+  Memory& operator=(Memory&& other);
+  ~Memory();
+
+  // Whether this memory was reserved as a large mmap region with inaccessible
+  // guard pages after the committed prefix. When true, any 32-bit
+  // address+offset access lands inside the reservation, so loads and stores
+  // don't need an explicit bounds check; out-of-bounds accesses fault and are
+  // turned into traps by the interpreter's fault handler.
+  bool has_guard_pages() const { return guard_base_ != nullptr; }
+  char* data_begin() { return guard_base_ ? guard_base_ : data.data(); }
+  const char* data_begin() const {
+    return guard_base_ ? guard_base_ : data.data();
+  }
+  size_t data_size() const { return guard_base_ ? guarded_size_ : data.size(); }
+
+  // Grows the accessible region to |new_size| bytes. Returns false if the
+  // pages can't be committed.
+  bool Resize(size_t new_size);
+
+  // Replaces this memory's contents with a copy of |other|'s, sharing pages
+  // copy-on-write with a snapshot of |other| when the host supports it
+  // (Linux, guard-page-backed memories); falls back to a deep copy. Used by
+  // Environment::Fork.
+  void ForkFrom(const Memory& other);
+
+  // Captures the current contents for a later RestoreSnapshot; see
+  // MemorySnapshot.
+  MemorySnapshot TakeSnapshot() const;
+
+  // Restores the contents (and committed size) saved by TakeSnapshot. The
+  // snapshot must have been taken from this memory.
+  void RestoreSnapshot(const MemorySnapshot&);
 
   Limits page_limits;
+  // Storage when guard pages aren't used; empty when has_guard_pages().
   std::vector<char> data;
+
+ private:
+  // Reserves the guard region and commits |initial_size| bytes. When |fd| is
+  // non-negative, the committed prefix is a private (copy-on-write) mapping
+  // of the file instead of zeroed pages.
+  bool AllocateGuarded(size_t initial_size, int fd = -1);
+  void FreeGuarded();
+
+  // Applies policy_ to the current data region. Called after the region is
+  // (re)allocated; guard-page memories hint the whole reservation once so
+  // pages they later grow into inherit the policy.
+  void ApplyAllocationPolicy();
+
+  // Shrinks the committed prefix back to |new_size| bytes, releasing and
+  // re-protecting any pages the memory grew into past that point.
+  void DropGuardedTail(size_t new_size);
+
+  MemoryAllocationPolicy policy_;
+  char* guard_base_ = nullptr;   // start of the mmap reservation, or null
+  size_t guarded_size_ = 0;      // size of the committed, accessible prefix
+};
+
+// Reserves |size| bytes of zeroed memory whose physical pages are committed
+// by the kernel on first touch, or returns null when the host can't (same
+// hosts as WABT_HAS_GUARD_PAGES); releases such a reservation again.
+void* ReserveLazyStackPages(size_t size);
+void ReleaseLazyStackPages(void* data, size_t size);
+
+// Fixed-capacity backing store for a thread's value and call stacks. The
+// full capacity is reserved as address space when the thread is created, but
+// physical pages are only committed as entries are first touched, so a
+// thread's resident memory tracks the stack depth it actually reaches
+// instead of Thread::Options. Falls back to eagerly allocated storage on
+// hosts without lazy reservations.
+template <typename T>
+class LazyStack {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(LazyStack);
+  explicit LazyStack(size_t size) : size_(size) {
+    data_ = static_cast<T*>(ReserveLazyStackPages(size * sizeof(T)));
+    if (!data_) {
+      fallback_.resize(size);
+      data_ = fallback_.data();
+    }
+  }
+  ~LazyStack() {
+    if (fallback_.empty()) {
+      ReleaseLazyStackPages(data_, size_ * sizeof(T));
+    }
+  }
+
+  T* data() { return data_; }
+  size_t size() const { return size_; }
+  T& operator[](size_t at) { return data_[at]; }
+  const T& operator[](size_t at) const { return data_[at]; }
+
+ private:
+  T* data_;
+  size_t size_;
+  std::vector<T> fallback_;
+};
+
+// Bytes of a data segment. Normally owns a copy of the bytes; when the module
+// was read with ReadBinaryOptions::reference_data_segments it borrows them
+// from the caller's module image instead, which must then outlive the
+// Environment. Copying an owned segment copies the bytes; copying a borrowed
+// one copies the reference (forked environments share the image).
+class SegmentData {
+ public:
+  SegmentData() = default;
+  SegmentData(SegmentData&&) = default;
+  SegmentData& operator=(SegmentData&&) = default;
+  SegmentData(const SegmentData& other) { *this = other; }
+  SegmentData& operator=(const SegmentData& other) {
+    owned_ = other.owned_;
+    size_ = other.size_;
+    data_ = other.is_borrowed() ? other.data_ : owned_.data();
+    return *this;
+  }
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+  const char* begin() const { return data_; }
+  const char* end() const { return data_ + size_; }
+
+  // Copies the bytes in [begin, end).
+  void assign(const char* begin, const char* end) {
+    owned_.assign(begin, end);
+    data_ = owned_.data();
+    size_ = owned_.size();
+  }
+
+  // References [data, data + size) without copying.
+  void borrow(const char* data, size_t size) {
+    owned_.clear();
+    data_ = data;
+    size_ = size;
+  }
+
+ private:
+  bool is_borrowed() const { return owned_.empty() && data_ != nullptr; }
+
+  std::vector<char> owned_;
+  const char* data_ = nullptr;
+  size_t size_ = 0;
 };
 
 struct DataSegment {
   DataSegment() = default;
 
-  std::vector<char> data;
+  SegmentData data;
   bool dropped = false;
 };
 
@@ -170,11 +379,22 @@ struct DataSegmentInfo {
 
   Memory* memory;
   Address dst;
-  std::vector<char> data;
+  SegmentData data;
 };
 
 // Opaque handle to a host object.
-struct HostObject {};
+// A slot backing a RefType::Host reference; see Environment::NewHostRef.
+// Slots are reused through a free list, so a long-lived environment's
+// host_objects_ table stays bounded by the peak number of live references
+// rather than growing with every reference ever created.
+struct HostObject {
+  // The host-ref epoch the slot was allocated or last marked alive in; see
+  // Environment::ReclaimHostRefs.
+  uint64_t epoch = 0;
+  // Next slot in the free list when not in use.
+  Index next_free = kInvalidIndex;
+  bool in_use = false;
+};
 
 // ValueTypeRep converts from one type to its representation on the
 // stack. For example, float -> uint32_t. See Value below.
@@ -193,6 +413,14 @@ template <> struct ValueTypeRepT<v128> { typedef v128 type; };
 template <typename T>
 using ValueTypeRep = typename ValueTypeRepT<T>::type;
 
+// One value stack slot. Every value occupies one slot regardless of type, so
+// the v128 member fixes the slot width at 16 bytes even for i32-heavy code.
+// Packing the stack (8-byte slots with v128 spanning two, or spilled to side
+// storage) was considered and rejected: uniform slots are what let every
+// drop/keep, local index, and branch immediate in the istream count plain
+// slots, and the baseline JIT generates code against the same layout.
+// Revisit only with a lowering pass that tracks per-value slot widths
+// end-to-end.
 union Value {
   uint32_t i32;
   uint64_t i64;
@@ -202,6 +430,10 @@ union Value {
   Ref ref;
 };
 
+static_assert(sizeof(Value) == 16,
+              "istream slot immediates and the baseline JIT assume 16-byte "
+              "value slots");
+
 struct TypedValue {
   TypedValue() {}
   explicit TypedValue(Type type) : type(type) {}
@@ -289,19 +521,34 @@ struct Func {
   bool is_host;
 };
 
+class JitFunc;
+
 struct DefinedFunc : Func {
-  DefinedFunc(Index sig_index)
-      : Func(sig_index, false),
-        offset(kInvalidIstreamOffset),
-        local_decl_count(0),
-        local_count(0) {}
+  // Out of line (with the destructor) so JitFunc can stay incomplete here.
+  explicit DefinedFunc(Index sig_index);
+  ~DefinedFunc();
 
   static bool classof(const Func* func) { return !func->is_host; }
 
   IstreamOffset offset;
+  // One past the function's final Return, set at lowering time. Bounds the
+  // body scan in JitFunc::Compile.
+  IstreamOffset istream_end;
   Index local_decl_count;
   Index local_count;
-  std::vector<Type> param_and_local_types;
+  TypeVector param_and_local_types;
+
+  // Baseline JIT state: direct calls observed so far, and the translated
+  // body once Thread::Options::jit_threshold is crossed. |jit_tried| stops
+  // unsupported bodies from being rescanned on every call. DefinedFuncs are
+  // shared between forked environments (see Environment::Fork), possibly on
+  // other OS threads, so the count is a relaxed atomic, compilation is
+  // claimed with an exchange on |jit_tried|, and the finished code is
+  // published through |jit_ready| with release/acquire ordering.
+  std::atomic<uint32_t> jit_call_count{0};
+  std::atomic<bool> jit_tried{false};
+  std::atomic<bool> jit_ready{false};
+  std::unique_ptr<JitFunc> jit_func;
 };
 
 struct HostFunc : Func {
@@ -310,6 +557,30 @@ struct HostFunc : Func {
                                         const TypedValues& args,
                                         TypedValues& results)>;
 
+  // Raw-ABI callback. |args_and_results| points directly at the call's
+  // arguments on the calling thread's value stack, first argument first,
+  // untagged; the callback overwrites them with its results, first result
+  // first, and the interpreter adjusts the stack top. Nothing is copied and
+  // no TypedValues vectors are built, so this is the cheapest way across the
+  // host boundary. The values written are not type-checked against the
+  // signature; writing the wrong types corrupts the caller's stack the same
+  // way a miscompiled wasm function would.
+  using RawCallback = std::function<Result(const HostFunc*,
+                                           const FuncSignature*,
+                                           Value* args_and_results)>;
+
+  // Batched callback. Calls are queued instead of crossing the host boundary
+  // one at a time; the callback runs once per |batch_size| queued calls and
+  // on Environment::FlushHostCallBatches, receiving the queued arguments
+  // packed contiguously, one signature's worth of untagged Values per call.
+  // Only signatures without results can be batched, since execution
+  // continues before the callback observes the call — intended for
+  // logging-style imports where the host just records the arguments.
+  using BatchCallback = std::function<Result(const HostFunc*,
+                                             const FuncSignature*,
+                                             const Value* args,
+                                             Index num_calls)>;
+
   HostFunc(string_view module_name,
            string_view field_name,
            Index sig_index,
@@ -319,22 +590,68 @@ struct HostFunc : Func {
         field_name(field_name.to_string()),
         callback(callback) {}
 
+  HostFunc(string_view module_name,
+           string_view field_name,
+           Index sig_index,
+           RawCallback callback)
+      : Func(sig_index, true),
+        module_name(module_name.to_string()),
+        field_name(field_name.to_string()),
+        raw_callback(callback) {}
+
+  HostFunc(string_view module_name,
+           string_view field_name,
+           Index sig_index,
+           BatchCallback callback,
+           Index batch_size)
+      : Func(sig_index, true),
+        module_name(module_name.to_string()),
+        field_name(field_name.to_string()),
+        batch_callback(callback),
+        batch_size(batch_size) {}
+
   static bool classof(const Func* func) { return func->is_host; }
 
   std::string module_name;
   std::string field_name;
+  // Exactly one of these is set.
   Callback callback;
+  RawCallback raw_callback;
+  BatchCallback batch_callback;
+
+  // Batching state; see BatchCallback. |batch_buffer| holds the queued
+  // calls' arguments back to back.
+  Index batch_size = 0;
+  Index num_batched_calls = 0;
+  std::vector<Value> batch_buffer;
 };
 
+// |name| is interned in the owning module's export_name_pool (see
+// Module::AppendExport), so an entry is three words instead of carrying its
+// own std::string, and all of a module's export-name bytes sit together in
+// the pool's chunks. Linking is lookup-iteration bound; the compact entries
+// halve the cache lines it touches per export.
 struct Export {
   Export(string_view name, ExternalKind kind, Index index)
-      : name(name.to_string()), kind(kind), index(index) {}
+      : name(name), kind(kind), index(index) {}
 
-  std::string name;
+  string_view name;
   ExternalKind kind;
   Index index;
 };
 
+// A pre-resolved reference to a module export. Environment::ResolveExport
+// pays the name hash once; calling through the handle afterwards is two
+// index lookups. Handles stay valid across further module instantiations
+// (indexes are stable even when the export table grows) but not across an
+// environment reset that removes the module.
+struct ExportHandle {
+  Index module_index = kInvalidIndex;
+  Index export_index = kInvalidIndex;
+
+  bool ok() const { return module_index != kInvalidIndex; }
+};
+
 class Environment;
 
 struct Module {
@@ -355,6 +672,9 @@ struct Module {
   std::string name;
   std::vector<Export> exports;
   BindingHash export_bindings;
+  // Backing store for the exports' names, shared with export_bindings so
+  // each name's bytes are stored once; see Export.
+  StringPool export_name_pool;
   Index memory_index; /* kInvalidIndex if not defined */
   bool is_host;
 
@@ -374,6 +694,21 @@ struct DefinedModule : Module {
   IstreamOffset istream_start;
   IstreamOffset istream_end;
 
+  // Offsets of every instruction start in this module's istream slice,
+  // ascending, recorded during lowering. Lets debugger-style callers find
+  // instruction boundaries — and so disassemble an arbitrary window or step
+  // backwards — in O(log n) instead of decoding forward from istream_start.
+  std::vector<IstreamOffset> instr_offsets;
+
+  // Returns the start offset of the instruction containing |offset|, or
+  // kInvalidIstreamOffset when |offset| is outside this module's istream.
+  IstreamOffset GetInstrOffset(IstreamOffset offset) const;
+
+  // Returns the start offset of the instruction before the one containing
+  // |offset|, or kInvalidIstreamOffset when there is none (for backwards
+  // stepping).
+  IstreamOffset GetPrecedingInstrOffset(IstreamOffset offset) const;
+
   // Changes to linear memory and tables should not apply if a validation error
   // occurs; these vectors cache the changes that must be applied after we know
   // that there are no validation errors.
@@ -397,6 +732,21 @@ struct HostModule : Module {
   std::pair<HostFunc*, Index> AppendFuncExport(string_view name,
                                                Index sig_index,
                                                HostFunc::Callback);
+  std::pair<HostFunc*, Index> AppendFuncExport(string_view name,
+                                               const FuncSignature&,
+                                               HostFunc::RawCallback);
+  std::pair<HostFunc*, Index> AppendFuncExport(string_view name,
+                                               Index sig_index,
+                                               HostFunc::RawCallback);
+  // The signature must have no results; see HostFunc::BatchCallback.
+  std::pair<HostFunc*, Index> AppendFuncExport(string_view name,
+                                               const FuncSignature&,
+                                               HostFunc::BatchCallback,
+                                               Index batch_size);
+  std::pair<HostFunc*, Index> AppendFuncExport(string_view name,
+                                               Index sig_index,
+                                               HostFunc::BatchCallback,
+                                               Index batch_size);
   std::pair<Table*, Index> AppendTableExport(string_view name,
                                              Type elem_type,
                                              const Limits&);
@@ -439,6 +789,24 @@ class Environment {
     size_t data_segments_size = 0;
     size_t elem_segments_size = 0;
     size_t istream_size = 0;
+    size_t call_indirect_cache_sites_size = 0;
+  };
+
+  // A point-in-time snapshot of the environment's mutable execution state,
+  // for resetting between executions without re-instantiating the loaded
+  // modules. The embedded MarkPoint truncates anything appended after the
+  // snapshot; the rest restores what truncation can't undo: memory contents
+  // (sharing pages untouched since the snapshot, see Memory::TakeSnapshot),
+  // table entries, global values, and segment dropped flags. Lowered code,
+  // signatures, and module metadata aren't saved — they don't change during
+  // execution.
+  struct Snapshot {
+    MarkPoint mark;
+    std::vector<MemorySnapshot> memories;
+    std::vector<std::vector<Ref>> table_entries;
+    std::vector<Global> globals;
+    std::vector<bool> data_segments_dropped;
+    std::vector<bool> elem_segments_dropped;
   };
 
   explicit Environment(const Features& features);
@@ -447,9 +815,12 @@ class Environment {
   void SetIstream(std::unique_ptr<OutputBuffer> istream) {
     istream_ = std::move(istream);
   }
-  std::unique_ptr<OutputBuffer> ReleaseIstream() { return std::move(istream_); }
+  // Takes sole ownership of the istream, copying it first if it is shared
+  // with forked environments (see Fork), so the caller can append to it
+  // without affecting the forks.
+  std::unique_ptr<OutputBuffer> ReleaseIstream();
 
-  Index GetFuncSignatureCount() const { return sigs_.size(); }
+  Index GetFuncSignatureCount() const { return sigs_->size(); }
   Index GetFuncCount() const { return funcs_.size(); }
   Index GetGlobalCount() const { return globals_.size(); }
   Index GetMemoryCount() const { return memories_.size(); }
@@ -464,7 +835,7 @@ class Environment {
   }
   Index FindModuleIndex(string_view name) const;
 
-  FuncSignature* GetFuncSignature(Index index) { return &sigs_[index]; }
+  FuncSignature* GetFuncSignature(Index index) { return &(*sigs_)[index]; }
   Func* GetFunc(Index index) {
     assert(index < funcs_.size());
     return funcs_[index].get();
@@ -500,10 +871,21 @@ class Environment {
   Module* FindModule(string_view name);
   Module* FindRegisteredModule(string_view name);
 
+  // Resolves an export to a handle for repeated calls; see ExportHandle.
+  // Returns a handle whose ok() is false if the module or export is unknown.
+  ExportHandle ResolveExport(Index module_index, string_view name);
+  ExportHandle ResolveExport(string_view module_name, string_view name);
+  Export* GetExport(const ExportHandle& handle) {
+    assert(handle.ok());
+    return &GetModule(handle.module_index)->exports[handle.export_index];
+  }
+
   template <typename... Args>
   FuncSignature* EmplaceBackFuncSignature(Args&&... args) {
-    sigs_.emplace_back(std::forward<Args>(args)...);
-    return &sigs_.back();
+    DetachSigsIfShared();
+    sigs_->emplace_back(std::forward<Args>(args)...);
+    CanonicalizeNewSignature();
+    return &sigs_->back();
   }
 
   template <typename... Args>
@@ -554,6 +936,45 @@ class Environment {
     return &host_objects_.back();
   }
 
+  // Hands out a RefType::Host reference backed by a slot in the host object
+  // table, reusing a freed slot when one is available (see HostObject). The
+  // slot is stamped with the current host-ref epoch.
+  Ref NewHostRef();
+
+  // Re-stamps |ref|'s slot with the current epoch so a later
+  // ReclaimHostRefs keeps it. |ref| must be a live RefType::Host reference.
+  void KeepHostRefAlive(Ref ref);
+
+  // Epoch-based, GC-less reclamation of host-ref slots. The embedder
+  // advances the epoch at quiescent points and periodically frees every slot
+  // not stamped since a cutoff, e.g. reclaim with
+  // |host_ref_epoch() - 1| after each advance to free slots untouched for a
+  // full epoch. References still reachable from this environment's tables or
+  // globals are stamped live automatically first, so only references the
+  // wasm side has dropped and the host stopped stamping are reclaimed.
+  // References held only on the host side must be kept with
+  // KeepHostRefAlive. Returns the number of slots freed.
+  void AdvanceHostRefEpoch() { ++host_ref_epoch_; }
+  uint64_t host_ref_epoch() const { return host_ref_epoch_; }
+  Index ReclaimHostRefs(uint64_t min_epoch);
+
+  // Runs every batched host function's callback over its queued calls (see
+  // HostFunc::BatchCallback) and empties the queues. Call once execution
+  // reaches a point where the batched side effects must have happened; a
+  // partial batch is otherwise delivered only when its batch fills up.
+  Result FlushHostCallBatches();
+
+  // Records the istream offset of a call_indirect inline cache, so the cache
+  // can be invalidated by ResetToMarkPoint (func indices past the mark point
+  // may be reused by later modules).
+  void AppendCallIndirectCacheSite(IstreamOffset offset) {
+    call_indirect_cache_sites_.push_back(offset);
+  }
+
+  const std::vector<IstreamOffset>& call_indirect_cache_sites() const {
+    return call_indirect_cache_sites_;
+  }
+
   template <typename... Args>
   void EmplaceModuleBinding(Args&&... args) {
     module_bindings_.emplace(std::forward<Args>(args)...);
@@ -571,9 +992,42 @@ class Environment {
   MarkPoint Mark();
   void ResetToMarkPoint(const MarkPoint&);
 
+  Snapshot TakeSnapshot();
+  void RestoreSnapshot(const Snapshot&);
+
+  // Returns an isolated copy of this environment for running another instance
+  // of its modules. Immutable lowering artifacts — the istream, functions,
+  // the signature table, and module metadata — are shared rather than
+  // copied, and memories share pages copy-on-write where the host supports
+  // it (see Memory::ForkFrom); tables and globals are copied. The fork sees
+  // the environment as it is now; neither side observes the other's later
+  // execution. Host modules' unknown-export callbacks keep appending to the
+  // original environment, so fork after all modules are loaded and resolved.
+  //
+  // Forks may run concurrently on different OS threads, one Thread/Executor
+  // per fork: the shared state is either never written after the fork (any
+  // side that needs to append detaches its copy first) or, for the baseline
+  // JIT state on shared functions, published lock-free (see DefinedFunc).
+  std::unique_ptr<Environment> Fork();
+
   void Disassemble(Stream* stream, IstreamOffset from, IstreamOffset to);
   void DisassembleModule(Stream* stream, Module*);
 
+  // When enabled, memories created in this environment are reserved as large
+  // mmap regions with guard pages (see Memory::has_guard_pages). Has no
+  // effect on hosts without guard-page support.
+  void set_use_guard_pages(bool use) { use_guard_pages_ = use; }
+  bool use_guard_pages() const { return use_guard_pages_; }
+
+  // Placement hints (huge pages, NUMA binding) applied to memories created
+  // in this environment; see MemoryAllocationPolicy.
+  void set_memory_policy(const MemoryAllocationPolicy& policy) {
+    memory_policy_ = policy;
+  }
+  const MemoryAllocationPolicy& memory_policy() const {
+    return memory_policy_;
+  }
+
   // Called when a module name isn't found in registered_module_bindings_. If
   // you want to provide a module with this name, call AppendHostModule() with
   // this name and return true.
@@ -584,18 +1038,46 @@ class Environment {
  private:
   friend class Thread;
 
-  std::vector<std::unique_ptr<Module>> modules_;
-  std::vector<FuncSignature> sigs_;
-  std::vector<std::unique_ptr<Func>> funcs_;
+  // Assigns FuncSignature::canonical_index to the signature just appended to
+  // sigs_.
+  void CanonicalizeNewSignature();
+
+  // Replaces sigs_ with a private copy if it is shared with a fork, so the
+  // caller can append to it without the fork (possibly mid-execution on
+  // another thread) observing the mutation.
+  void DetachSigsIfShared() {
+    if (sigs_.use_count() != 1) {
+      sigs_.reset(new std::vector<FuncSignature>(*sigs_));
+    }
+  }
+
+  // Modules, functions, and the signature table are shared_ptrs so Fork can
+  // share them; they're immutable once their module has been read.
+  std::vector<std::shared_ptr<Module>> modules_;
+  std::shared_ptr<std::vector<FuncSignature>> sigs_;
+  std::vector<std::shared_ptr<Func>> funcs_;
   std::vector<Memory> memories_;
   std::vector<Table> tables_;
   std::vector<Global> globals_;
   std::vector<DataSegment> data_segments_;
   std::vector<ElemSegment> elem_segments_;
   std::vector<HostObject> host_objects_;
-  std::unique_ptr<OutputBuffer> istream_;
+  // Head of the free list threaded through HostObject::next_free, and the
+  // current epoch for stamping; see NewHostRef/ReclaimHostRefs.
+  Index host_ref_free_head_ = kInvalidIndex;
+  uint64_t host_ref_epoch_ = 0;
+  std::shared_ptr<OutputBuffer> istream_;
+  // Signature shape (see SigShapeKey in interp.cc) -> index of the first
+  // signature registered with that shape.
+  std::unordered_map<std::string, Index> sig_canonical_map_;
+  std::vector<IstreamOffset> call_indirect_cache_sites_;
   BindingHash module_bindings_;
   BindingHash registered_module_bindings_;
+  bool use_guard_pages_ = false;
+  MemoryAllocationPolicy memory_policy_;
+  // True when istream_ may be shared with a forked environment; suppresses
+  // runtime writes into the istream (call_indirect inline caching).
+  bool istream_shared_ = false;
 };
 
 class Thread {
@@ -605,10 +1087,41 @@ class Thread {
     static const uint32_t kDefaultCallStackSize = 64 * 1024;
 
     explicit Options(uint32_t value_stack_size = kDefaultValueStackSize,
-                     uint32_t call_stack_size = kDefaultCallStackSize);
+                     uint32_t call_stack_size = kDefaultCallStackSize,
+                     bool enable_profiling = false);
 
     uint32_t value_stack_size;
     uint32_t call_stack_size;
+    // Collect per-opcode execution counts and a sampled pc histogram while
+    // running; see Thread::DumpProfile. Much cheaper than tracing: the
+    // interpreter loop only pays for a counter increment per instruction.
+    bool enable_profiling;
+    // Translate a function to native code (see interp-jit.h) once it has
+    // been seen at this many direct call sites. 0 disables the JIT tier;
+    // platforms without a backend always keep interpreting.
+    uint32_t jit_threshold = 0;
+    // Skip quieting nan results of f{32,64} min/max/nearest to the canonical
+    // nan; a nan operand propagates with whatever payload the hardware
+    // produced. Not spec-exact — only for embedders that never inspect nan
+    // bits and want the canonicalization off the float hot path.
+    bool relaxed_nans = false;
+    // In-process quotas, so many untrusted instances can share one process
+    // instead of paying a fork apiece for isolation. Each is 0 (unlimited)
+    // by default and is metered over the thread's lifetime, across Reset.
+    //
+    // Caps the total fuel the thread may consume (fuel meters taken
+    // branches and calls, see Run); exhaustion traps with
+    // TrapFuelQuotaExceeded.
+    uint64_t fuel_quota = 0;
+    // Caps the total bytes memory.grow may add. A grow past the quota fails
+    // with -1, exactly as if it grew past the memory's declared maximum, so
+    // guest code sees a spec-shaped failure rather than a trap.
+    uint64_t memory_grow_quota = 0;
+    // Wall-clock budget in milliseconds, measured from construction. The
+    // clock is read at most once per kDeadlineCheckFuelInterval fuel units
+    // (see interp.cc), so the steady-state cost is a counter per Run slice;
+    // expiry traps with TrapWallClockLimitExceeded.
+    uint32_t wall_clock_limit_ms = 0;
   };
 
   explicit Thread(Environment*, const Options& = Options());
@@ -620,23 +1133,64 @@ class Thread {
 
   void Reset();
   Index NumValues() const { return value_stack_top_; }
-  Result Push(Value) WABT_WARN_UNUSED;
+  // True if |count| more values fit on the value stack. Lowered code is
+  // covered by the stack_check instruction at each function's entry; callers
+  // that push from outside the interpreter loop (host function results,
+  // Executor arguments) must check explicitly before pushing.
+  bool HasValueStackRoom(Index count) const {
+    return value_stack_top_ + count <= value_stack_.size();
+  }
+  ResultType Push(Value) WABT_WARN_UNUSED;
   Value Pop();
   Value ValueAt(Index at) const;
 
   void Trace(Stream*);
-  Result Run(int num_instructions = 1);
 
-  Result CallHost(HostFunc*);
+  // Runs until the call stack unwinds, a trap is raised, or |fuel| runs out.
+  // Fuel is consumed at taken branches and calls — the control-flow edges
+  // that can make execution unbounded — rather than per instruction, so
+  // straight-line code runs without a counter and a unit of fuel covers at
+  // most one branchless stretch of a function body.
+  ResultType Run(int fuel = 1);
+
+  // Executes exactly one instruction; used when tracing.
+  ResultType Step();
+
+  // Returns (and clears) the message stashed by the last detailed trap, empty
+  // for traps without one. Trap propagation inside the thread moves only the
+  // ResultType enum; the message text lives here until the caller wraps the
+  // final code into a Result (see Executor::MakeResult).
+  std::string TakeTrapMessage() {
+    std::string message;
+    std::swap(message, trap_message_);
+    return message;
+  }
+
+  // Writes the opcode counts and hot-function histogram collected while
+  // running; no-op unless Options::enable_profiling was set.
+  void DumpProfile(Stream*);
+
+  // Total instructions executed since construction; 0 unless
+  // Options::enable_profiling was set.
+  uint64_t ProfileInstructionCount() const;
+
+  ResultType CallHost(HostFunc*);
 
  private:
   const uint8_t* GetIstream() const { return env_->istream_->data.data(); }
 
+  void CacheIndirectCall(const uint8_t* pc, Index func_index,
+                         IstreamOffset offset);
+
   Memory* ReadMemory(const uint8_t** pc);
   template <typename MemType>
-  Result GetAccessAddress(const uint8_t** pc, void** out_address);
+  ResultType GetAccessAddress(const uint8_t** pc, void** out_address);
+  template <typename MemType>
+  ResultType GetAccessAddressAt(const uint8_t** pc,
+                            uint32_t base,
+                            void** out_address);
   template <typename MemType>
-  Result GetAtomicAccessAddress(const uint8_t** pc, void** out_address);
+  ResultType GetAtomicAccessAddress(const uint8_t** pc, void** out_address);
 
   Table* ReadTable(const uint8_t** pc);
 
@@ -650,7 +1204,7 @@ class Thread {
   // ValueTypeRep (uint32_t) and push that. Similarly, Pop<float> will pop the
   // value and convert to float.
   template <typename T>
-  Result Push(T) WABT_WARN_UNUSED;
+  ResultType Push(T) WABT_WARN_UNUSED;
   template <typename T>
   T Pop();
 
@@ -658,70 +1212,149 @@ class Thread {
   // uint32_t argument which is the integer representation of that float value.
   // Similarly, PopRep<float> will not convert the value to a float.
   template <typename T>
-  Result PushRep(ValueTypeRep<T>) WABT_WARN_UNUSED;
+  ResultType PushRep(ValueTypeRep<T>) WABT_WARN_UNUSED;
   template <typename T>
   ValueTypeRep<T> PopRep();
 
   void DropKeep(uint32_t drop_count, uint32_t keep_count);
 
-  Result PushCall(const uint8_t* pc) WABT_WARN_UNUSED;
-  IstreamOffset PopCall();
+  ResultType PushCall(const uint8_t* pc) WABT_WARN_UNUSED;
+  const uint8_t* PopCall();
 
   template <typename R, typename T> using UnopFunc      = R(T);
-  template <typename R, typename T> using UnopTrapFunc  = Result(T, R*);
+  template <typename R, typename T> using UnopTrapFunc  = ResultType(T, R*);
   template <typename R, typename T> using BinopFunc     = R(T, T);
-  template <typename R, typename T> using BinopTrapFunc = Result(T, T, R*);
-
-  template <typename MemType, typename ResultType = MemType>
-  Result Load(const uint8_t** pc) WABT_WARN_UNUSED;
-  template <typename MemType, typename ResultType = MemType>
-  Result Store(const uint8_t** pc) WABT_WARN_UNUSED;
-  template <typename MemType, typename ResultType = MemType>
-  Result AtomicLoad(const uint8_t** pc) WABT_WARN_UNUSED;
-  template <typename MemType, typename ResultType = MemType>
-  Result AtomicStore(const uint8_t** pc) WABT_WARN_UNUSED;
-  template <typename MemType, typename ResultType = MemType>
-  Result AtomicRmw(BinopFunc<ResultType, ResultType>,
+  template <typename R, typename T> using BinopTrapFunc = ResultType(T, T, R*);
+
+  template <typename MemType, typename ResultValueType = MemType>
+  ResultType Load(const uint8_t** pc) WABT_WARN_UNUSED;
+  template <typename MemType, typename ResultValueType = MemType>
+  ResultType Store(const uint8_t** pc) WABT_WARN_UNUSED;
+  template <typename MemType, typename ResultValueType = MemType>
+  ResultType AtomicLoad(const uint8_t** pc) WABT_WARN_UNUSED;
+  template <typename MemType, typename ResultValueType = MemType>
+  ResultType AtomicStore(const uint8_t** pc) WABT_WARN_UNUSED;
+  template <typename MemType, typename ResultValueType = MemType>
+  ResultType AtomicRmw(BinopFunc<ResultValueType, ResultValueType>,
                    const uint8_t** pc) WABT_WARN_UNUSED;
-  template <typename MemType, typename ResultType = MemType>
-  Result AtomicRmwCmpxchg(const uint8_t** pc) WABT_WARN_UNUSED;
-
-  Result MemoryInit(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result DataDrop(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result MemoryCopy(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result MemoryFill(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result TableInit(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result TableGet(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result TableSet(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result ElemDrop(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result TableCopy(const uint8_t** pc) WABT_WARN_UNUSED;
-  Result RefFunc(const uint8_t** pc) WABT_WARN_UNUSED;
+  template <typename MemType, typename ResultValueType = MemType>
+  ResultType AtomicRmwCmpxchg(const uint8_t** pc) WABT_WARN_UNUSED;
+  template <typename MemType>
+  ResultType AtomicWait(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType AtomicNotify(const uint8_t** pc) WABT_WARN_UNUSED;
+
+  ResultType MemoryInit(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType DataDrop(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType MemoryCopy(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType MemoryFill(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType TableInit(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType TableGet(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType TableSet(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType ElemDrop(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType TableCopy(const uint8_t** pc) WABT_WARN_UNUSED;
+  ResultType RefFunc(const uint8_t** pc) WABT_WARN_UNUSED;
 
   template <typename R, typename T = R>
-  Result Unop(UnopFunc<R, T> func) WABT_WARN_UNUSED;
+  ResultType Unop(UnopFunc<R, T> func) WABT_WARN_UNUSED;
   template <typename R, typename T = R>
-  Result UnopTrap(UnopTrapFunc<R, T> func) WABT_WARN_UNUSED;
+  ResultType UnopTrap(UnopTrapFunc<R, T> func) WABT_WARN_UNUSED;
 
   template <typename T, typename L, typename R, typename P = R>
-  Result SimdUnop(UnopFunc<R, P> func) WABT_WARN_UNUSED;
+  ResultType SimdUnop(UnopFunc<R, P> func) WABT_WARN_UNUSED;
 
   template <typename R, typename T = R>
-  Result Binop(BinopFunc<R, T> func) WABT_WARN_UNUSED;
+  ResultType Binop(BinopFunc<R, T> func) WABT_WARN_UNUSED;
+  template <typename R, typename T = R>
+  ResultType BinopTrap(BinopTrapFunc<R, T> func) WABT_WARN_UNUSED;
+
+  // Like Binop, but the operands are read from value stack slots instead of
+  // being popped; used by the InterpLocalBinop fused instruction.
   template <typename R, typename T = R>
-  Result BinopTrap(BinopTrapFunc<R, T> func) WABT_WARN_UNUSED;
+  ResultType LocalBinop(BinopFunc<R, T> func, Value lhs, Value rhs)
+      WABT_WARN_UNUSED;
+  ResultType RunLocalBinop(Opcode opcode, Value lhs, Value rhs) WABT_WARN_UNUSED;
 
   template <typename T, typename L, typename R, typename P = R>
-  Result SimdBinop(BinopFunc<R, P> func) WABT_WARN_UNUSED;
+  ResultType SimdBinop(BinopFunc<R, P> func) WABT_WARN_UNUSED;
 
   template <typename T, typename L, typename R, typename P = R>
-  Result SimdRelBinop(BinopFunc<R, P> func) WABT_WARN_UNUSED;
+  ResultType SimdRelBinop(BinopFunc<R, P> func) WABT_WARN_UNUSED;
+
+  // Like SimdUnop/SimdBinop, but the operation is applied to all lanes at
+  // once using the compiler's native vector types instead of a scalar lane
+  // loop. V is one of the 16-byte vector typedefs in interp.cc and Op a
+  // stateless functor over it. Only compiled in when the vector extensions
+  // are available; callers fall back to the lane-loop helpers otherwise.
+  template <typename V, typename Op>
+  ResultType SimdNativeUnop(Op op) WABT_WARN_UNUSED;
+  template <typename V, typename Op>
+  ResultType SimdNativeBinop(Op op) WABT_WARN_UNUSED;
+
+  // Formats and stashes a detailed trap message, then returns |type|. Cold
+  // and out of line so the formatting code stays out of the interpreter's
+  // hot path (see the TRAP_MSG macro in interp.cc).
+  ResultType TrapMsg(ResultType type, const char* format, ...)
+      WABT_PRINTF_FORMAT(3, 4) WABT_COLD;
+
+  // Records one executed instruction for the profiler. Only called when
+  // profiling_ is set, so the dispatch loop pays a predicted branch at most.
+  void ProfileSample(Opcode opcode, IstreamOffset offset);
+
+  // Runs |func|'s translated body in place of an interpreted call. The
+  // native code works on the same value stack, so on return the results sit
+  // exactly where the interpreter would have left them.
+  ResultType RunJitFunc(DefinedFunc* func) WABT_WARN_UNUSED;
 
   Environment* env_ = nullptr;
-  std::vector<Value> value_stack_;
-  std::vector<IstreamOffset> call_stack_;
+  LazyStack<Value> value_stack_;
+  // Return addresses as raw istream pointers, saving a base+offset round trip
+  // on every call and return. Only entries below call_stack_top_ are live.
+  // The istream may be reallocated between Run slices -- loading another
+  // module while a call is suspended (Executor::BeginFunction/Resume) grows
+  // it -- so Run rebases the live entries when the base has moved since the
+  // previous slice. It must not move during a slice: host functions must
+  // not load modules into the Environment. Offsets stored in the istream
+  // itself stay relative so it remains position-independent for
+  // serialization and sharing.
+  LazyStack<const uint8_t*> call_stack_;
+  // Istream base the live call_stack_ entries point into; Run compares it
+  // against the current base and rebases them if it has moved.
+  const uint8_t* istream_base_ = nullptr;
   uint32_t value_stack_top_ = 0;
   uint32_t call_stack_top_ = 0;
   IstreamOffset pc_ = 0;
+  // Message for the last trap that carries details (an out-of-bounds address
+  // and the like); see TakeTrapMessage.
+  std::string trap_message_;
+  // Copied from Options::jit_threshold; 0 keeps the Call handler free of any
+  // JIT bookkeeping.
+  uint32_t jit_threshold_ = 0;
+
+  // When set (only by Step), Run exits after a single instruction instead of
+  // running until fuel is consumed at a branch or call.
+  bool single_step_ = false;
+
+  // Copied from Options::relaxed_nans; selects the non-canonicalizing
+  // instances of the float min/max/nearest helpers.
+  bool relaxed_nans_ = false;
+
+  // Quota state (see Options). The remaining-budget counters use UINT64_MAX
+  // as the unlimited sentinel so the common no-quota case is a single
+  // never-taken compare at each check site.
+  uint64_t fuel_remaining_ = UINT64_MAX;
+  uint64_t grow_bytes_remaining_ = UINT64_MAX;
+  bool has_deadline_ = false;
+  std::chrono::steady_clock::time_point deadline_;
+  // Fuel units left until the next deadline_ clock read; see Run.
+  int64_t deadline_fuel_countdown_ = 0;
+
+  // Profiling state; empty unless Options::enable_profiling was set.
+  // Opcode counts are exact; the pc histogram is subsampled (see
+  // kProfilePcSampleInterval in interp.cc) to keep the map off the hot path.
+  bool profiling_ = false;
+  std::vector<uint64_t> profile_opcode_counts_;
+  std::map<IstreamOffset, uint64_t> profile_pc_counts_;
+  uint32_t profile_pc_countdown_ = 0;
 };
 
 struct ExecResult {
@@ -735,6 +1368,11 @@ struct ExecResult {
   TypedValues values;
 };
 
+template <typename... A>
+class TypedThunkBase;
+template <typename Sig>
+class TypedThunk;
+
 class Executor {
  public:
   explicit Executor(Environment*,
@@ -744,20 +1382,319 @@ class Executor {
   ExecResult RunFunction(Index func_index, const TypedValues& args);
   ExecResult Initialize(DefinedModule* module);
   ExecResult RunExport(const Export*, const TypedValues& args);
+  ExecResult RunExport(const ExportHandle&, const TypedValues& args);
   ExecResult RunExportByName(Module* module,
                              string_view name,
                              const TypedValues& args);
 
+  // Resolves |module|'s export |name| against the C function type |Sig|
+  // (e.g. int32_t(int32_t, int32_t)) and binds |*out| to it; see TypedThunk.
+  // Fails with UnknownExport, ExportKindMismatch or ArgumentTypeMismatch
+  // when there is no such function or its wasm signature doesn't match.
+  template <typename Sig>
+  Result MakeTypedThunk(Module* module, string_view name, TypedThunk<Sig>* out);
+
+  // Suspendable execution. BeginFunction pushes the arguments and arms the
+  // thread without running any instructions; each Resume call then runs
+  // until |fuel| is exhausted (fuel is consumed at taken branches and calls,
+  // see Thread::Run), so an embedder can multiplex many instances on one OS
+  // thread by rotating between their Executors. When the call
+  // finishes -- normally or with a trap -- |callback| receives the final
+  // ExecResult before Resume returns false. The Executor must not be reused
+  // for another call while a suspended one is in flight.
+  using CompletionCallback = std::function<void(ExecResult)>;
+  Result BeginFunction(Index func_index,
+                       const TypedValues& args,
+                       CompletionCallback callback);
+  // Returns true while the call still has work left, false once the
+  // completion callback has fired.
+  bool Resume(int fuel);
+  bool IsRunning() const { return running_; }
+
+  // Writes the profile collected by the interpreter thread; no-op unless
+  // Thread::Options::enable_profiling was set.
+  void DumpProfile(Stream* stream) { thread_.DumpProfile(stream); }
+
+  // See Thread::ProfileInstructionCount.
+  uint64_t ProfileInstructionCount() const {
+    return thread_.ProfileInstructionCount();
+  }
+
  private:
+  template <typename... A>
+  friend class TypedThunkBase;
+
   ExecResult RunStartFunction(DefinedModule* module);
   Result InitializeSegments(DefinedModule* module);
   Result RunDefinedFunction(IstreamOffset function_offset);
   Result PushArgs(const FuncSignature*, const TypedValues& args);
   void CopyResults(const FuncSignature*, TypedValues* out_results);
 
+  // Wraps a raw thread result code into a Result, attaching the trap message
+  // the thread stashed for it, if any.
+  Result MakeResult(ResultType type) {
+    return type == ResultType::Ok ? Result(type)
+                                  : Result(type, thread_.TakeTrapMessage());
+  }
+
+  // Counterpart of Thread::TrapMsg for traps raised by the Executor itself.
+  Result TrapMsg(ResultType type, const char* format, ...)
+      WABT_PRINTF_FORMAT(3, 4) WABT_COLD;
+
   Environment* env_ = nullptr;
   Stream* trace_stream_ = nullptr;
   Thread thread_;
+
+  // State of a suspended BeginFunction/Resume call. The signature is kept
+  // as an index, not a pointer: loading a module while the call is
+  // suspended may grow the Environment's signature table and move it.
+  bool running_ = false;
+  Index running_sig_index_ = kInvalidIndex;
+  CompletionCallback on_complete_;
+};
+
+// Maps the C types a TypedThunk is instantiated with onto wasm value types
+// and value stack slots.
+template <typename T>
+struct ThunkValueTraits;
+
+template <>
+struct ThunkValueTraits<int32_t> {
+  static const Type kType = Type::I32;
+  static void Set(Value* value, int32_t x) {
+    value->i32 = static_cast<uint32_t>(x);
+  }
+  static int32_t Get(const Value& value) {
+    return static_cast<int32_t>(value.i32);
+  }
+};
+
+template <>
+struct ThunkValueTraits<uint32_t> {
+  static const Type kType = Type::I32;
+  static void Set(Value* value, uint32_t x) { value->i32 = x; }
+  static uint32_t Get(const Value& value) { return value.i32; }
+};
+
+template <>
+struct ThunkValueTraits<int64_t> {
+  static const Type kType = Type::I64;
+  static void Set(Value* value, int64_t x) {
+    value->i64 = static_cast<uint64_t>(x);
+  }
+  static int64_t Get(const Value& value) {
+    return static_cast<int64_t>(value.i64);
+  }
+};
+
+template <>
+struct ThunkValueTraits<uint64_t> {
+  static const Type kType = Type::I64;
+  static void Set(Value* value, uint64_t x) { value->i64 = x; }
+  static uint64_t Get(const Value& value) { return value.i64; }
+};
+
+template <>
+struct ThunkValueTraits<float> {
+  static const Type kType = Type::F32;
+  static void Set(Value* value, float x) {
+    memcpy(&value->f32_bits, &x, sizeof(x));
+  }
+  static float Get(const Value& value) {
+    float x;
+    memcpy(&x, &value.f32_bits, sizeof(x));
+    return x;
+  }
+};
+
+template <>
+struct ThunkValueTraits<double> {
+  static const Type kType = Type::F64;
+  static void Set(Value* value, double x) {
+    memcpy(&value->f64_bits, &x, sizeof(x));
+  }
+  static double Get(const Value& value) {
+    double x;
+    memcpy(&x, &value.f64_bits, sizeof(x));
+    return x;
+  }
+};
+
+// Shared machinery of the TypedThunk specializations: export resolution and
+// signature checking at bind time, raw argument pushing and the interpreter
+// run per call. Use TypedThunk, not this.
+template <typename... A>
+class TypedThunkBase {
+ public:
+  bool is_bound() const { return func_ != nullptr; }
+
+ protected:
+  TypedThunkBase() = default;
+
+  Result Bind(Executor* executor,
+              Module* module,
+              string_view name,
+              bool (*results_match)(const TypeVector&)) {
+    Export* export_ = module->GetExport(name);
+    if (!export_) {
+      return ResultType::UnknownExport;
+    }
+    if (export_->kind != ExternalKind::Func) {
+      return ResultType::ExportKindMismatch;
+    }
+    Func* func = executor->env_->GetFunc(export_->index);
+    FuncSignature* sig = executor->env_->GetFuncSignature(func->sig_index);
+    if (sig->param_types.size() != sizeof...(A) ||
+        !results_match(sig->result_types)) {
+      return ResultType::ArgumentTypeMismatch;
+    }
+    // Leading Void sentinel so the array isn't zero-sized for ()-parameter
+    // signatures.
+    const Type param_types[] = {Type::Void, ThunkValueTraits<A>::kType...};
+    for (size_t i = 0; i < sig->param_types.size(); ++i) {
+      if (sig->param_types[i] != param_types[i + 1]) {
+        return ResultType::ArgumentTypeMismatch;
+      }
+    }
+    executor_ = executor;
+    func_ = func;
+    return ResultType::Ok;
+  }
+
+  Result Invoke(A... args) {
+    Thread* thread = &executor_->thread_;
+    thread->Reset();
+    // Arguments are pushed before any function's stack_check runs, so check
+    // for room explicitly; the pushes themselves are then unchecked stores.
+    if (!thread->HasValueStackRoom(sizeof...(A))) {
+      return ResultType::TrapValueStackExhausted;
+    }
+    ResultType push_result = PushAll(thread, args...);
+    if (push_result != ResultType::Ok) {
+      return push_result;
+    }
+    return func_->is_host
+               ? executor_->MakeResult(
+                     thread->CallHost(static_cast<HostFunc*>(func_)))
+               : executor_->RunDefinedFunction(
+                     static_cast<DefinedFunc*>(func_)->offset);
+  }
+
+  Thread* thread() { return &executor_->thread_; }
+
+ private:
+  static ResultType PushAll(Thread*) { return ResultType::Ok; }
+  template <typename T, typename... Rest>
+  static ResultType PushAll(Thread* thread, T arg, Rest... rest) {
+    Value value;
+    ThunkValueTraits<T>::Set(&value, arg);
+    ResultType result = thread->Push(value);
+    return result != ResultType::Ok ? result : PushAll(thread, rest...);
+  }
+
+  Executor* executor_ = nullptr;
+  Func* func_ = nullptr;
+};
+
+// Typed, pre-resolved call thunk for one exported function, created with
+// Executor::MakeTypedThunk. The export and its wasm signature are resolved
+// and checked against the C signature once, at bind time; each Call then
+// writes the raw arguments straight into the interpreter's value stack and
+// reads the result back out of it, with no TypedValues vector and no
+// per-call type checking. The thunk borrows the Executor, so it must not
+// outlive it, and calls through it use the Executor's thread (one call at a
+// time, like RunExport).
+template <typename Sig>
+class TypedThunk;
+
+template <typename R, typename... A>
+class TypedThunk<R(A...)> : public TypedThunkBase<A...> {
+ public:
+  // Runs the function; on success writes its result to |*out|.
+  Result Call(R* out, A... args) {
+    Result result = this->Invoke(args...);
+    if (result.ok()) {
+      *out = ThunkValueTraits<R>::Get(this->thread()->ValueAt(0));
+    }
+    return result;
+  }
+
+ private:
+  friend class Executor;
+  static bool ResultsMatch(const TypeVector& results) {
+    return results.size() == 1 && results[0] == ThunkValueTraits<R>::kType;
+  }
+};
+
+template <typename... A>
+class TypedThunk<void(A...)> : public TypedThunkBase<A...> {
+ public:
+  Result Call(A... args) { return this->Invoke(args...); }
+
+ private:
+  friend class Executor;
+  static bool ResultsMatch(const TypeVector& results) {
+    return results.empty();
+  }
+};
+
+template <typename Sig>
+Result Executor::MakeTypedThunk(Module* module,
+                                string_view name,
+                                TypedThunk<Sig>* out) {
+  return out->Bind(this, module, name, &TypedThunk<Sig>::ResultsMatch);
+}
+
+// Reuses Executors — and with them the Thread's value and call stacks, which
+// are the expensive part of constructing one — across executions. An Executor
+// already reuses its stacks from one RunExport call to the next; the pool
+// extends that to embedders that want one executor per in-flight execution
+// instead of one per Environment.
+class ExecutorPool {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(ExecutorPool);
+  explicit ExecutorPool(Environment*,
+                        Stream* trace_stream = nullptr,
+                        const Thread::Options& options = Thread::Options());
+
+  // Movable RAII handle to a pooled Executor; returns it to the pool when
+  // destroyed.
+  class Handle {
+   public:
+    WABT_DISALLOW_COPY_AND_ASSIGN(Handle);
+    Handle(Handle&& other) : pool_(other.pool_), executor_(other.executor_) {
+      other.pool_ = nullptr;
+      other.executor_ = nullptr;
+    }
+    ~Handle();
+
+    Executor* operator->() { return executor_; }
+    Executor& operator*() { return *executor_; }
+
+   private:
+    friend class ExecutorPool;
+    Handle(ExecutorPool* pool, Executor* executor)
+        : pool_(pool), executor_(executor) {}
+
+    ExecutorPool* pool_ = nullptr;
+    Executor* executor_ = nullptr;
+  };
+
+  // Returns a free Executor, constructing a new one only when all pooled
+  // executors are in use. Acquire and release are safe to call from multiple
+  // threads; whether the executions themselves may run concurrently is up to
+  // the embedder, as they share the Environment.
+  Handle Acquire();
+
+ private:
+  void Release(Executor*);
+
+  Environment* env_;
+  Stream* trace_stream_;
+  Thread::Options options_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Executor>> executors_;
+  std::vector<Executor*> free_;
 };
 
 bool IsCanonicalNan(uint32_t f32_bits);
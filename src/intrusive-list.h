@@ -34,6 +34,12 @@
 // * Asserts instead of exceptions
 // * Some functions are not implemented (merge, remove, remove_if, reverse,
 //   unique, sort, non-member comparison operators)
+//
+// Guarantees, like std::list: size() is O(1) (the count is cached), and
+// insert/erase/extract/splice never invalidate iterators or references to
+// other elements -- a spliced element's iterator follows it into its new
+// list. Any number of threads may traverse lists concurrently as long as no
+// thread mutates them; there is no internal synchronization.
 
 namespace wabt {
 
@@ -124,6 +130,11 @@ class intrusive_list {
   void swap(intrusive_list&);
   void clear() noexcept;
 
+  // Splicing relinks the moved chain in one step (O(1) when the element
+  // count is known: the whole-list forms use the source's cached size, and
+  // the counted range form trusts |count|, which must equal
+  // std::distance(first, last)). When source and destination are the same
+  // list, |pos| must not be inside [first, last).
   void splice(iterator pos, intrusive_list& node);
   void splice(iterator pos, intrusive_list&& node);
   void splice(iterator pos, intrusive_list& node, iterator it);
@@ -131,6 +142,17 @@ class intrusive_list {
               intrusive_list& node,
               iterator first,
               iterator last);
+  void splice(iterator pos,
+              intrusive_list& node,
+              iterator first,
+              iterator last,
+              size_type count);
+
+  // Removes [first, last) and returns it as its own list, relinking the
+  // chain in one step; the counted form is O(1) under the same |count|
+  // contract as the counted splice.
+  intrusive_list extract_list(iterator first, iterator last);
+  intrusive_list extract_list(iterator first, iterator last, size_type count);
 
  private:
   T* first_ = nullptr;
@@ -604,12 +626,12 @@ inline void intrusive_list<T>::clear() noexcept {
 
 template <typename T>
 inline void intrusive_list<T>::splice(iterator pos, intrusive_list& other) {
-  splice(pos, other, other.begin(), other.end());
+  splice(pos, other, other.begin(), other.end(), other.size());
 }
 
 template <typename T>
 inline void intrusive_list<T>::splice(iterator pos, intrusive_list&& other) {
-  splice(pos, other, other.begin(), other.end());
+  splice(pos, other, other.begin(), other.end(), other.size());
 }
 
 template <typename T>
@@ -624,8 +646,68 @@ inline void intrusive_list<T>::splice(iterator pos,
                                       intrusive_list& other,
                                       iterator first,
                                       iterator last) {
-  while (first != last)
-    insert(pos, other.extract(first++));
+  splice(pos, other, first, last,
+         static_cast<size_type>(std::distance(first, last)));
+}
+
+template <typename T>
+inline void intrusive_list<T>::splice(iterator pos,
+                                      intrusive_list& other,
+                                      iterator first,
+                                      iterator last,
+                                      size_type count) {
+  assert(count == static_cast<size_type>(std::distance(first, last)));
+  if (count == 0) {
+    return;
+  }
+  T* head = &*first;
+  T* tail = last == other.end() ? other.last_ : last->prev_;
+
+  // Unlink [head, tail] from other.
+  if (head->prev_) {
+    head->prev_->next_ = tail->next_;
+  } else {
+    other.first_ = tail->next_;
+  }
+  if (tail->next_) {
+    tail->next_->prev_ = head->prev_;
+  } else {
+    other.last_ = head->prev_;
+  }
+  other.size_ -= count;
+
+  // Link the chain before pos.
+  T* next = pos == end() ? nullptr : &*pos;
+  T* prev = next ? next->prev_ : last_;
+  head->prev_ = prev;
+  tail->next_ = next;
+  if (prev) {
+    prev->next_ = head;
+  } else {
+    first_ = head;
+  }
+  if (next) {
+    next->prev_ = tail;
+  } else {
+    last_ = tail;
+  }
+  size_ += count;
+}
+
+template <typename T>
+inline intrusive_list<T> intrusive_list<T>::extract_list(iterator first,
+                                                         iterator last) {
+  return extract_list(first, last,
+                      static_cast<size_type>(std::distance(first, last)));
+}
+
+template <typename T>
+inline intrusive_list<T> intrusive_list<T>::extract_list(iterator first,
+                                                         iterator last,
+                                                         size_type count) {
+  intrusive_list result;
+  result.splice(result.end(), *this, first, last, count);
+  return result;
 }
 
 }  // namespace wabt
@@ -42,11 +42,9 @@ using namespace wabt;
 
 const Label* ModuleContext::GetLabel(const Var& var) const {
   if (var.is_name()) {
-    for (Index i = GetLabelStackSize(); i > 0; --i) {
-      auto label = &label_stack_[i - 1];
-      if (label->name == var.name()) {
-        return label;
-      }
+    auto iter = label_positions_.find(var.name());
+    if (iter != label_positions_.end()) {
+      return &label_stack_[iter->second.back()];
     }
   } else if (var.index() < GetLabelStackSize()) {
     auto label = &label_stack_[GetLabelStackSize() - var.index() - 1];
@@ -76,16 +74,28 @@ Index ModuleContext::GetFuncResultCount(const Var& var) const {
 }
 
 void ModuleContext::BeginBlock(LabelType label_type, const Block& block) {
+  if (!block.label.empty()) {
+    label_positions_[block.label].push_back(label_stack_.size());
+  }
   label_stack_.emplace_back(label_type, block.label, block.decl.sig.param_types,
                             block.decl.sig.result_types);
 }
 
 void ModuleContext::EndBlock() {
+  const std::string& name = label_stack_.back().name;
+  if (!name.empty()) {
+    auto iter = label_positions_.find(name);
+    iter->second.pop_back();
+    if (iter->second.empty()) {
+      label_positions_.erase(iter);
+    }
+  }
   label_stack_.pop_back();
 }
 
 void ModuleContext::BeginFunc(const Func& func) {
   label_stack_.clear();
+  label_positions_.clear();
   label_stack_.emplace_back(LabelType::Func, std::string(), TypeVector(),
                             func.decl.sig.result_types);
   current_func_ = &func;
@@ -95,20 +105,93 @@ void ModuleContext::EndFunc() {
   current_func_ = nullptr;
 }
 
+namespace {
+
+// Precomputed arities for every ExprType whose operand and result counts
+// don't depend on context; |dynamic| marks the ones that do (labels, callee
+// signatures, block types, the current function) and are resolved by the
+// switch in GetExprArity. Entries are in ExprType declaration order; the
+// static_assert below catches a table that falls out of sync. const and
+// trivially initialized, so the table lives in read-only storage.
+struct ExprArity {
+  uint8_t nargs;
+  uint8_t nreturns;
+  bool unreachable;
+  bool dynamic;
+};
+
+const ExprArity kExprArities[] = {
+    {1, 1, false, false},  // AtomicLoad
+    {2, 1, false, false},  // AtomicRmw
+    {3, 1, false, false},  // AtomicRmwCmpxchg
+    {2, 0, false, false},  // AtomicStore
+    {2, 1, false, false},  // AtomicNotify
+    {3, 1, false, false},  // AtomicWait
+    {2, 1, false, false},  // Binary
+    {0, 0, false, true},   // Block
+    {0, 0, false, true},   // Br
+    {0, 0, false, true},   // BrIf
+    {1, 1, false, false},  // BrOnExn
+    {0, 0, false, true},   // BrTable
+    {0, 0, false, true},   // Call
+    {0, 0, false, true},   // CallIndirect
+    {2, 1, false, false},  // Compare
+    {0, 1, false, false},  // Const
+    {1, 1, false, false},  // Convert
+    {1, 0, false, false},  // Drop
+    {0, 1, false, false},  // GlobalGet
+    {1, 0, false, false},  // GlobalSet
+    {0, 0, false, true},   // If
+    {1, 1, false, false},  // Load
+    {0, 1, false, false},  // LocalGet
+    {1, 0, false, false},  // LocalSet
+    {1, 1, false, false},  // LocalTee
+    {0, 0, false, true},   // Loop
+    {3, 0, false, false},  // MemoryCopy
+    {0, 0, false, false},  // DataDrop
+    {3, 0, false, false},  // MemoryFill
+    {1, 1, false, false},  // MemoryGrow
+    {3, 0, false, false},  // MemoryInit
+    {0, 1, false, false},  // MemorySize
+    {0, 0, false, false},  // Nop
+    {1, 1, false, false},  // RefIsNull
+    {0, 1, false, false},  // RefFunc
+    {0, 1, false, false},  // RefNull
+    {0, 0, true, false},   // Rethrow
+    {0, 0, false, true},   // Return
+    {0, 0, false, true},   // ReturnCall
+    {0, 0, false, true},   // ReturnCallIndirect
+    {3, 1, false, false},  // Select
+    {0, 0, false, true},   // SimdLaneOp
+    {2, 1, false, false},  // SimdShuffleOp
+    {0, 0, false, true},   // LoadSplat
+    {2, 0, false, false},  // Store
+    {3, 0, false, false},  // TableCopy
+    {0, 0, false, false},  // ElemDrop
+    {3, 0, false, false},  // TableInit
+    {1, 1, false, false},  // TableGet
+    {2, 1, false, false},  // TableGrow
+    {0, 1, false, false},  // TableSize
+    {2, 0, false, false},  // TableSet
+    {3, 1, false, false},  // Ternary
+    {0, 0, false, true},   // Throw
+    {0, 0, false, true},   // Try
+    {1, 1, false, false},  // Unary
+    {0, 1, true, false},   // Unreachable
+};
+
+WABT_STATIC_ASSERT(WABT_ARRAY_SIZE(kExprArities) ==
+                   static_cast<size_t>(ExprType::Last) + 1);
+
+}  // end of anonymous namespace
+
 ModuleContext::Arities ModuleContext::GetExprArity(const Expr& expr) const {
-  switch (expr.type()) {
-    case ExprType::AtomicNotify:
-    case ExprType::AtomicRmw:
-    case ExprType::Binary:
-    case ExprType::Compare:
-    case ExprType::TableGrow:
-      return { 2, 1 };
-
-    case ExprType::AtomicStore:
-    case ExprType::Store:
-    case ExprType::TableSet:
-      return { 2, 0 };
+  const ExprArity& arity = kExprArities[static_cast<size_t>(expr.type())];
+  if (WABT_LIKELY(!arity.dynamic)) {
+    return { arity.nargs, arity.nreturns, arity.unreachable };
+  }
 
+  switch (expr.type()) {
     case ExprType::Block:
       return { 0, cast<BlockExpr>(&expr)->block.decl.sig.GetNumResults() };
 
@@ -120,21 +203,22 @@ ModuleContext::Arities ModuleContext::GetExprArity(const Expr& expr) const {
       return { arity + 1, arity };
     }
 
-    case ExprType::BrOnExn:
-      return { 1, 1 };
-
     case ExprType::BrTable:
       return { GetLabelArity(cast<BrTableExpr>(&expr)->default_target) + 1, 1,
                true };
 
     case ExprType::Call: {
-      const Var& var = cast<CallExpr>(&expr)->var;
-      return { GetFuncParamCount(var), GetFuncResultCount(var) };
+      // Resolve the callee once rather than via GetFuncParamCount /
+      // GetFuncResultCount, which would each repeat the binding lookup.
+      const Func* func = module.GetFunc(cast<CallExpr>(&expr)->var);
+      return { func ? func->GetNumParams() : 0,
+               func ? func->GetNumResults() : 0 };
     }
 
     case ExprType::ReturnCall: {
-      const Var& var = cast<ReturnCallExpr>(&expr)->var;
-      return { GetFuncParamCount(var), GetFuncResultCount(var), true };
+      const Func* func = module.GetFunc(cast<ReturnCallExpr>(&expr)->var);
+      return { func ? func->GetNumParams() : 0,
+               func ? func->GetNumResults() : 0, true };
     }
 
     case ExprType::CallIndirect: {
@@ -149,66 +233,17 @@ ModuleContext::Arities ModuleContext::GetExprArity(const Expr& expr) const {
                rci_expr->decl.GetNumResults(), true };
     }
 
-    case ExprType::Const:
-    case ExprType::GlobalGet:
-    case ExprType::LocalGet:
-    case ExprType::MemorySize:
-    case ExprType::TableSize:
-    case ExprType::RefNull:
-    case ExprType::RefFunc:
-      return { 0, 1 };
-
-    case ExprType::Unreachable:
-      return { 0, 1, true };
-
-    case ExprType::DataDrop:
-    case ExprType::ElemDrop:
-      return { 0, 0 };
-
-    case ExprType::MemoryInit:
-    case ExprType::TableInit:
-    case ExprType::MemoryFill:
-    case ExprType::MemoryCopy:
-    case ExprType::TableCopy:
-      return { 3, 0 };
-
-    case ExprType::AtomicLoad:
-    case ExprType::Convert:
-    case ExprType::Load:
-    case ExprType::LocalTee:
-    case ExprType::MemoryGrow:
-    case ExprType::Unary:
-    case ExprType::TableGet:
-    case ExprType::RefIsNull:
-      return { 1, 1 };
-
-    case ExprType::Drop:
-    case ExprType::GlobalSet:
-    case ExprType::LocalSet:
-      return { 1, 0 };
-
     case ExprType::If:
       return { 1, cast<IfExpr>(&expr)->true_.decl.sig.GetNumResults() };
 
     case ExprType::Loop:
       return { 0, cast<LoopExpr>(&expr)->block.decl.sig.GetNumResults() };
 
-    case ExprType::Nop:
-      return { 0, 0 };
-
     case ExprType::Return:
       return
         { static_cast<Index>(current_func_->decl.sig.result_types.size()), 1,
           true };
 
-    case ExprType::Rethrow:
-      return { 0, 0, true };
-
-    case ExprType::AtomicRmwCmpxchg:
-    case ExprType::AtomicWait:
-    case ExprType::Select:
-      return { 3, 1 };
-
     case ExprType::Throw: {
       auto throw_ = cast<ThrowExpr>(&expr);
       Index operand_count = 0;
@@ -222,9 +257,6 @@ ModuleContext::Arities ModuleContext::GetExprArity(const Expr& expr) const {
       return { 0, cast<TryExpr>(&expr)->block.decl.sig.GetNumResults() };
       break;
 
-    case ExprType::Ternary:
-      return { 3, 1 };
-
     case ExprType::SimdLaneOp: {
       const Opcode opcode = cast<SimdLaneOpExpr>(&expr)->opcode;
       switch (opcode) {
@@ -254,9 +286,6 @@ ModuleContext::Arities ModuleContext::GetExprArity(const Expr& expr) const {
       }
     }
 
-    case ExprType::SimdShuffleOp:
-      return { 2, 1 };
-
     default:
       fprintf(stderr, "bad expr type: %s\n", GetExprTypeName(expr));
       assert(0);
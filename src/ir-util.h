@@ -17,6 +17,8 @@
 #ifndef WABT_IR_UTIL_H_
 #define WABT_IR_UTIL_H_
 
+#include <unordered_map>
+
 #include "src/common.h"
 #include "src/ir.h"
 
@@ -69,6 +71,11 @@ struct ModuleContext {
  private:
   const Func* current_func_ = nullptr;
   std::vector<Label> label_stack_;
+  // Positions in label_stack_ of each named label, innermost last, so
+  // GetLabel with a name var doesn't scan the stack for every branch the
+  // writers visit (quadratic on deeply nested code). Index vars already
+  // index the stack directly.
+  std::unordered_map<std::string, std::vector<Index>> label_positions_;
 };
 
 }  // namespace wabt
@@ -16,11 +16,99 @@
 
 #include "src/ir.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <numeric>
 
 #include "src/cast.h"
+#include "src/make-unique.h"
+
+namespace {
+
+// Pool allocator backing Expr::operator new/delete. Nodes are carved from
+// 64 KiB chunks with a bump pointer and recycled through per-size free lists;
+// oversized nodes fall through to the normal heap. The pool is thread-local
+// so no locking is needed on the parse/read hot path.
+class ExprPool {
+ public:
+  ~ExprPool() {
+    // If any node is still live when the owning thread exits (e.g. an Expr
+    // that was handed off to another thread), the chunks must stay valid, so
+    // they are deliberately leaked in that case.
+    if (outstanding_ == 0) {
+      for (char* chunk : chunks_) {
+        delete[] chunk;
+      }
+    }
+  }
+
+  void* Alloc(size_t size) {
+    size_t bucket = Bucket(size);
+    if (bucket >= kNumBuckets) {
+      return ::operator new(size);
+    }
+    ++outstanding_;
+    void*& head = free_lists_[bucket];
+    if (head) {
+      void* p = head;
+      head = *static_cast<void**>(p);
+      return p;
+    }
+    size_t alloc_size = (bucket + 1) * kGranularity;
+    if (chunk_remaining_ < alloc_size) {
+      chunks_.push_back(new char[kChunkSize]);
+      chunk_ptr_ = chunks_.back();
+      chunk_remaining_ = kChunkSize;
+    }
+    void* p = chunk_ptr_;
+    chunk_ptr_ += alloc_size;
+    chunk_remaining_ -= alloc_size;
+    return p;
+  }
+
+  void Free(void* p, size_t size) {
+    size_t bucket = Bucket(size);
+    if (bucket >= kNumBuckets) {
+      ::operator delete(p);
+      return;
+    }
+    --outstanding_;
+    *static_cast<void**>(p) = free_lists_[bucket];
+    free_lists_[bucket] = p;
+  }
+
+ private:
+  static const size_t kGranularity = 16;
+  static const size_t kNumBuckets = 16;  // sizes up to 256 bytes
+  static const size_t kChunkSize = 64 * 1024;
+
+  static size_t Bucket(size_t size) { return (size - 1) / kGranularity; }
+
+  std::vector<char*> chunks_;
+  char* chunk_ptr_ = nullptr;
+  size_t chunk_remaining_ = 0;
+  void* free_lists_[kNumBuckets] = {nullptr};
+  // Pooled allocations minus pooled frees on this thread; may go negative on
+  // a thread that frees nodes allocated elsewhere.
+  intptr_t outstanding_ = 0;
+};
+
+thread_local ExprPool s_expr_pool;
+
+}  // end anonymous namespace
+
+namespace wabt {
+
+void* Expr::operator new(size_t size) {
+  return s_expr_pool.Alloc(size);
+}
+
+void Expr::operator delete(void* p, size_t size) {
+  s_expr_pool.Free(p, size);
+}
+
+}  // namespace wabt
 
 namespace {
 
@@ -102,12 +190,37 @@ bool FuncSignature::operator==(const FuncSignature& rhs) const {
   return param_types == rhs.param_types && result_types == rhs.result_types;
 }
 
+Module::Module() : string_pool(MakeUnique<StringPool>()) {
+  event_bindings.set_string_pool(string_pool.get());
+  func_bindings.set_string_pool(string_pool.get());
+  global_bindings.set_string_pool(string_pool.get());
+  export_bindings.set_string_pool(string_pool.get());
+  func_type_bindings.set_string_pool(string_pool.get());
+  table_bindings.set_string_pool(string_pool.get());
+  memory_bindings.set_string_pool(string_pool.get());
+  data_segment_bindings.set_string_pool(string_pool.get());
+  elem_segment_bindings.set_string_pool(string_pool.get());
+}
+
 const Export* Module::GetExport(string_view name) const {
-  Index index = export_bindings.FindIndex(name);
-  if (index >= exports.size()) {
+  if (sorted_exports_.size() != exports.size()) {
+    sorted_exports_.clear();
+    sorted_exports_.reserve(exports.size());
+    for (size_t i = 0; i < exports.size(); ++i) {
+      sorted_exports_.emplace_back(exports[i]->name, i);
+    }
+    std::sort(sorted_exports_.begin(), sorted_exports_.end());
+  }
+
+  auto iter = std::lower_bound(
+      sorted_exports_.begin(), sorted_exports_.end(), name,
+      [](const std::pair<string_view, Index>& entry, string_view name) {
+        return entry.first < name;
+      });
+  if (iter == sorted_exports_.end() || iter->first != name) {
     return nullptr;
   }
-  return exports[index];
+  return exports[iter->second];
 }
 
 Index Module::GetFuncIndex(const Var& var) const {
@@ -372,6 +485,7 @@ void Module::AppendField(std::unique_ptr<ExportModuleField> field) {
 
 void Module::AppendField(std::unique_ptr<FuncModuleField> field) {
   Func& func = field->func;
+  func.bindings.set_string_pool(string_pool.get());
   if (!func.name.empty()) {
     func_bindings.emplace(func.name, Binding(field->loc, funcs.size()));
   }
@@ -568,6 +682,19 @@ void MakeTypeBindingReverseMapping(
     std::vector<std::string>* out_reverse_mapping) {
   out_reverse_mapping->clear();
   out_reverse_mapping->resize(num_types);
+  for (const auto& pair : bindings) {
+    assert(static_cast<size_t>(pair.second.index) <
+           out_reverse_mapping->size());
+    (*out_reverse_mapping)[pair.second.index] = pair.first.to_string();
+  }
+}
+
+void MakeTypeBindingReverseMapping(
+    size_t num_types,
+    const BindingHash& bindings,
+    std::vector<string_view>* out_reverse_mapping) {
+  out_reverse_mapping->clear();
+  out_reverse_mapping->resize(num_types);
   for (const auto& pair : bindings) {
     assert(static_cast<size_t>(pair.second.index) <
            out_reverse_mapping->size());
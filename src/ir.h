@@ -23,6 +23,7 @@
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "src/binding-hash.h"
@@ -244,6 +245,12 @@ class Expr : public intrusive_list_base<Expr> {
   Expr() = delete;
   virtual ~Expr() = default;
 
+  // Exprs are allocated in large numbers while building the IR and mostly
+  // freed together when the Module is destroyed, so they come from a
+  // size-bucketed thread-local pool instead of the general-purpose heap.
+  void* operator new(size_t size);
+  void operator delete(void* p, size_t size);
+
   ExprType type() const { return type_; }
 
   Location loc;
@@ -314,8 +321,8 @@ class SimdShuffleOpExpr : public ExprMixin<ExprType::SimdShuffleOp> {
 template <ExprType TypeEnum>
 class VarExpr : public ExprMixin<TypeEnum> {
  public:
-  VarExpr(const Var& var, const Location& loc = Location())
-      : ExprMixin<TypeEnum>(loc), var(var) {}
+  VarExpr(Var var, const Location& loc = Location())
+      : ExprMixin<TypeEnum>(loc), var(std::move(var)) {}
 
   Var var;
 };
@@ -342,12 +349,12 @@ typedef VarExpr<ExprType::TableSize> TableSizeExpr;
 
 class TableInitExpr : public ExprMixin<ExprType::TableInit> {
  public:
-  TableInitExpr(const Var& segment_index,
-                const Var& table_index,
+  TableInitExpr(Var segment_index,
+                Var table_index,
                 const Location& loc = Location())
       : ExprMixin<ExprType::TableInit>(loc),
-        segment_index(segment_index),
-        table_index(table_index) {}
+        segment_index(std::move(segment_index)),
+        table_index(std::move(table_index)) {}
 
   Var segment_index;
   Var table_index;
@@ -355,10 +362,10 @@ class TableInitExpr : public ExprMixin<ExprType::TableInit> {
 
 class TableCopyExpr : public ExprMixin<ExprType::TableCopy> {
  public:
-  TableCopyExpr(const Var& dst,
-                const Var& src,
-                const Location& loc = Location())
-      : ExprMixin<ExprType::TableCopy>(loc), dst_table(dst), src_table(src) {}
+  TableCopyExpr(Var dst, Var src, const Location& loc = Location())
+      : ExprMixin<ExprType::TableCopy>(loc),
+        dst_table(std::move(dst)),
+        src_table(std::move(src)) {}
 
   Var dst_table;
   Var src_table;
@@ -500,6 +507,8 @@ class LocalTypes {
     }
   }
 
+  void reserve(Index count) { decls_.reserve(count); }
+
   Index size() const;
   Type operator[](Index) const;
 
@@ -555,6 +564,14 @@ struct Func {
   LocalTypes local_types;
   BindingHash bindings;
   ExprList exprs;
+  // Set when the module is read with ReadBinaryIrLazy: the byte range of the
+  // function's code entry within the module, and the function's index (so
+  // decoding the body doesn't have to search the module's function list).
+  // The offsets are 0 once the body has been decoded (and for imported
+  // functions and text-format functions).
+  Offset lazy_body_offset = 0;
+  Offset lazy_body_end = 0;
+  Index lazy_body_index = 0;
 };
 
 struct Global {
@@ -582,7 +599,8 @@ enum class ElemExprKind {
 
 struct ElemExpr {
   ElemExpr() : kind(ElemExprKind::RefNull) {}
-  explicit ElemExpr(Var var) : kind(ElemExprKind::RefFunc), var(var) {}
+  explicit ElemExpr(Var var)
+      : kind(ElemExprKind::RefFunc), var(std::move(var)) {}
 
   ElemExprKind kind;
   Var var;  // Only used when kind == RefFunc.
@@ -835,12 +853,14 @@ class EventModuleField : public ModuleFieldMixin<ModuleFieldType::Event> {
 class StartModuleField : public ModuleFieldMixin<ModuleFieldType::Start> {
  public:
   explicit StartModuleField(Var start = Var(), const Location& loc = Location())
-      : ModuleFieldMixin<ModuleFieldType::Start>(loc), start(start) {}
+      : ModuleFieldMixin<ModuleFieldType::Start>(loc), start(std::move(start)) {}
 
   Var start;
 };
 
 struct Module {
+  Module();
+
   Index GetFuncTypeIndex(const Var&) const;
   Index GetFuncTypeIndex(const FuncDeclaration&) const;
   Index GetFuncTypeIndex(const FuncSignature&) const;
@@ -912,6 +932,12 @@ struct Module {
   std::vector<DataSegment*> data_segments;
   std::vector<Var*> starts;
 
+  // Interned storage shared by all the binding hashes below (including each
+  // Func's local bindings), so a name used by several tables is stored once.
+  // Held by unique_ptr so its address stays stable when the Module is moved;
+  // the binding hashes keep raw pointers into it.
+  std::unique_ptr<StringPool> string_pool;
+
   BindingHash event_bindings;
   BindingHash func_bindings;
   BindingHash global_bindings;
@@ -921,6 +947,14 @@ struct Module {
   BindingHash memory_bindings;
   BindingHash data_segment_bindings;
   BindingHash elem_segment_bindings;
+
+ private:
+  // Sorted (name, index) view of exports, built lazily by GetExport and
+  // rebuilt if an export was appended since; binary search over this is
+  // cheaper than the bindings multimap once the module is read-mostly, and
+  // export_bindings stays authoritative for duplicate detection during
+  // construction.
+  mutable std::vector<std::pair<string_view, Index>> sorted_exports_;
 };
 
 enum class ScriptModuleType {
@@ -1085,8 +1119,8 @@ typedef ActionCommandBase<CommandType::AssertReturnArithmeticNan>
 
 class RegisterCommand : public CommandMixin<CommandType::Register> {
  public:
-  RegisterCommand(string_view module_name, const Var& var)
-      : module_name(module_name), var(var) {}
+  RegisterCommand(string_view module_name, Var var)
+      : module_name(module_name), var(std::move(var)) {}
 
   std::string module_name;
   Var var;
@@ -1150,6 +1184,15 @@ void MakeTypeBindingReverseMapping(
     const BindingHash& bindings,
     std::vector<std::string>* out_reverse_mapping);
 
+// As above, but fills views of the hash's interned names instead of copying
+// each one. The views stay valid as long as the hash (and its string pool)
+// does; passes that only read the mapping while visiting should prefer this
+// overload.
+void MakeTypeBindingReverseMapping(
+    size_t num_types,
+    const BindingHash& bindings,
+    std::vector<string_view>* out_reverse_mapping);
+
 }  // namespace wabt
 
 #endif /* WABT_IR_H_ */
@@ -18,6 +18,8 @@
 
 #include <type_traits>
 
+#include "config.h"
+
 #include "src/stream.h"
 
 #define MAX_U32_LEB128_BYTES 5
@@ -58,12 +60,90 @@ Offset WriteFixedU32Leb128At(Stream* stream,
 }
 
 void WriteU32Leb128(Stream* stream, uint32_t value, const char* desc) {
+  // Most index and size fields in real modules fit in one byte; give that
+  // case a predictable early branch past the per-byte loop.
+  if (WABT_LIKELY(value < 0x80)) {
+    uint8_t byte = static_cast<uint8_t>(value);
+    stream->WriteData(&byte, 1, desc);
+    return;
+  }
   uint8_t data[MAX_U32_LEB128_BYTES];
   Offset length = 0;
   LEB128_LOOP_UNTIL(value == 0);
   stream->WriteData(data, length, desc);
 }
 
+void WriteU32Leb128(BulkWriter* writer, uint32_t value) {
+  uint8_t* data = writer->Reserve(MAX_U32_LEB128_BYTES);
+  writer->Advance(WriteU32Leb128Raw(data, data + MAX_U32_LEB128_BYTES, value));
+}
+
+void WriteS32Leb128(BulkWriter* writer, uint32_t value_bits) {
+  int32_t value = Bitcast<int32_t>(value_bits);
+  uint8_t* data = writer->Reserve(MAX_U32_LEB128_BYTES);
+  Offset length = 0;
+  if (value < 0) {
+    LEB128_LOOP_UNTIL(value == -1 && (byte & 0x40));
+  } else {
+    LEB128_LOOP_UNTIL(value == 0 && !(byte & 0x40));
+  }
+  writer->Advance(length);
+}
+
+void WriteU32Leb128Vector(Stream* stream,
+                          const uint32_t* values,
+                          size_t count,
+                          const char* desc) {
+  if (stream->has_log_stream()) {
+    for (size_t i = 0; i < count; ++i) {
+      WriteU32Leb128(stream, values[i], desc);
+    }
+    return;
+  }
+  BulkWriter writer(stream, desc);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    uint8_t* data = writer.Reserve(8 * MAX_U32_LEB128_BYTES);
+    uint32_t all_bits = 0;
+    for (size_t j = 0; j != 8; ++j) {
+      all_bits |= values[i + j];
+    }
+    if (WABT_LIKELY(all_bits < 0x80)) {
+      for (size_t j = 0; j != 8; ++j) {
+        data[j] = static_cast<uint8_t>(values[i + j]);
+      }
+      writer.Advance(8);
+    } else {
+      size_t length = 0;
+      for (size_t j = 0; j != 8; ++j) {
+        length += WriteU32Leb128Raw(data + length,
+                                    data + 8 * MAX_U32_LEB128_BYTES,
+                                    values[i + j]);
+      }
+      writer.Advance(length);
+    }
+  }
+  for (; i < count; ++i) {
+    WriteU32Leb128(&writer, values[i]);
+  }
+}
+
+void WriteU32Leb128Pair(Stream* stream,
+                        uint32_t first,
+                        const char* first_desc,
+                        uint32_t second,
+                        const char* second_desc) {
+  if (WABT_LIKELY(first < 0x80 && second < 0x80) &&
+      !stream->has_log_stream()) {
+    uint8_t data[2] = {static_cast<uint8_t>(first),
+                       static_cast<uint8_t>(second)};
+    stream->WriteData(data, 2, first_desc);
+    return;
+  }
+  WriteU32Leb128(stream, first, first_desc);
+  WriteU32Leb128(stream, second, second_desc);
+}
+
 void WriteFixedU32Leb128(Stream* stream, uint32_t value, const char* desc) {
   uint8_t data[MAX_U32_LEB128_BYTES];
   Offset length =
@@ -84,6 +164,10 @@ Offset WriteU32Leb128At(Stream* stream,
 }
 
 Offset WriteU32Leb128Raw(uint8_t* dest, uint8_t* dest_end, uint32_t value) {
+  if (WABT_LIKELY(value < 0x80) && dest < dest_end) {
+    *dest = static_cast<uint8_t>(value);
+    return 1;
+  }
   uint8_t data[MAX_U32_LEB128_BYTES];
   Offset length = 0;
   LEB128_LOOP_UNTIL(value == 0);
@@ -94,6 +178,38 @@ Offset WriteU32Leb128Raw(uint8_t* dest, uint8_t* dest_end, uint32_t value) {
   return length;
 }
 
+Offset WriteS32Leb128Raw(uint8_t* dest, uint8_t* dest_end, uint32_t value_bits) {
+  int32_t value = Bitcast<int32_t>(value_bits);
+  uint8_t data[MAX_U32_LEB128_BYTES];
+  Offset length = 0;
+  if (value < 0) {
+    LEB128_LOOP_UNTIL(value == -1 && (byte & 0x40));
+  } else {
+    LEB128_LOOP_UNTIL(value == 0 && !(byte & 0x40));
+  }
+  if (static_cast<Offset>(dest_end - dest) < length) {
+    return 0;
+  }
+  memcpy(dest, data, length);
+  return length;
+}
+
+Offset WriteS64Leb128Raw(uint8_t* dest, uint8_t* dest_end, uint64_t value_bits) {
+  int64_t value = Bitcast<int64_t>(value_bits);
+  uint8_t data[MAX_U64_LEB128_BYTES];
+  Offset length = 0;
+  if (value < 0) {
+    LEB128_LOOP_UNTIL(value == -1 && (byte & 0x40));
+  } else {
+    LEB128_LOOP_UNTIL(value == 0 && !(byte & 0x40));
+  }
+  if (static_cast<Offset>(dest_end - dest) < length) {
+    return 0;
+  }
+  memcpy(dest, data, length);
+  return length;
+}
+
 Offset WriteFixedU32Leb128Raw(uint8_t* data, uint8_t* end, uint32_t value) {
   if (end - data < MAX_U32_LEB128_BYTES) {
     return 0;
@@ -158,9 +274,75 @@ void WriteS64Leb128(Stream* stream, uint64_t value, const char* desc) {
   (static_cast<type>((value) << SHIFT_AMOUNT(type, sign_bit)) >> \
    SHIFT_AMOUNT(type, sign_bit))
 
+namespace {
+
+// Reassembles 8 bytes in little-endian order; on little-endian hosts the
+// compiler turns this into a single unaligned 64-bit load.
+inline uint64_t LoadLittleEndian64(const uint8_t* p) {
+  return static_cast<uint64_t>(p[0]) | (static_cast<uint64_t>(p[1]) << 8) |
+         (static_cast<uint64_t>(p[2]) << 16) |
+         (static_cast<uint64_t>(p[3]) << 24) |
+         (static_cast<uint64_t>(p[4]) << 32) |
+         (static_cast<uint64_t>(p[5]) << 40) |
+         (static_cast<uint64_t>(p[6]) << 48) |
+         (static_cast<uint64_t>(p[7]) << 56);
+}
+
+// Packs the low 7 bits of each byte of `w` into the low 56 bits of the
+// result; the equivalent of pext(w, 0x7f7f7f7f7f7f7f7f), but without
+// requiring BMI2.
+inline uint64_t ExtractLeb128Payload(uint64_t w) {
+  w &= 0x7f7f7f7f7f7f7f7fULL;
+  w = (w & 0x007f007f007f007fULL) | ((w & 0x7f007f007f007f00ULL) >> 1);
+  w = (w & 0x00003fff00003fffULL) | ((w & 0x3fff00003fff0000ULL) >> 2);
+  w = (w & 0x000000000fffffffULL) | ((w & 0x0fffffff00000000ULL) >> 4);
+  return w;
+}
+
+// Returns the length of the LEB128 value starting in `w`, given the
+// positions of the bytes with the continuation bit clear, or 0 if the value
+// continues past the 8 loaded bytes.
+inline size_t Leb128Length(uint64_t w) {
+  uint64_t terminators = ~w & 0x8080808080808080ULL;
+  if (terminators == 0) {
+    return 0;
+  }
+  return static_cast<size_t>(Ctz(terminators)) / 8 + 1;
+}
+
+// Keeps only the low `length` bytes of `w`.
+inline uint64_t MaskLeb128Bytes(uint64_t w, size_t length) {
+  return w & (~0ULL >> (64 - 8 * length));
+}
+
+}  // end anonymous namespace
+
 size_t ReadU32Leb128(const uint8_t* p,
                      const uint8_t* end,
                      uint32_t* out_value) {
+  if (end - p >= 8) {
+    uint64_t w = LoadLittleEndian64(p);
+    // One-byte values are the overwhelmingly common case.
+    if ((w & 0x80) == 0) {
+      *out_value = static_cast<uint32_t>(w & 0x7f);
+      return 1;
+    }
+    size_t length = Leb128Length(w);
+    if (length == 0 || length > 5) {
+      // Unterminated within 5 bytes.
+      *out_value = 0;
+      return 0;
+    }
+    uint64_t payload = ExtractLeb128Payload(MaskLeb128Bytes(w, length));
+    // The top bits set represent values > 32 bits.
+    if (payload >> 32) {
+      return 0;
+    }
+    *out_value = static_cast<uint32_t>(payload);
+    return length;
+  }
+
+  // Too close to the end of the buffer to load 8 bytes; decode byte by byte.
   if (p < end && (p[0] & 0x80) == 0) {
     *out_value = LEB128_1(uint32_t);
     return 1;
@@ -190,6 +372,31 @@ size_t ReadU32Leb128(const uint8_t* p,
 size_t ReadS32Leb128(const uint8_t* p,
                      const uint8_t* end,
                      uint32_t* out_value) {
+  if (end - p >= 8) {
+    uint64_t w = LoadLittleEndian64(p);
+    if ((w & 0x80) == 0) {
+      uint32_t result = static_cast<uint32_t>(w & 0x7f);
+      *out_value = SIGN_EXTEND(int32_t, result, 6);
+      return 1;
+    }
+    size_t length = Leb128Length(w);
+    if (length == 0 || length > 5) {
+      return 0;
+    }
+    uint64_t payload = ExtractLeb128Payload(MaskLeb128Bytes(w, length));
+    // Sign-extend from the top payload bit. A 5-byte value has 35 payload
+    // bits, so the result only fits in an int32_t when the extra bits are a
+    // sign-extension of bit 31 (the check the byte-by-byte path below makes
+    // on the last byte).
+    int64_t result = SIGN_EXTEND(int64_t, payload, 7 * length - 1);
+    int32_t truncated = static_cast<int32_t>(result);
+    if (result != truncated) {
+      return 0;
+    }
+    *out_value = static_cast<uint32_t>(truncated);
+    return length;
+  }
+
   if (p < end && (p[0] & 0x80) == 0) {
     uint32_t result = LEB128_1(uint32_t);
     *out_value = SIGN_EXTEND(int32_t, result, 6);
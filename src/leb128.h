@@ -23,14 +23,38 @@
 
 namespace wabt {
 
+class BulkWriter;
 class Stream;
 
 // Returns the length of the leb128.
 Offset U32Leb128Length(uint32_t value);
 
 void WriteU32Leb128(Stream* stream, uint32_t value, const char* desc);
+
+// Writes two values, each as a u32 LEB128, in a single stream write when
+// both encode to one byte — the common case for a load/store's (alignment,
+// offset) memarg pair. Falls back to two writes when the stream is logged,
+// so each value keeps its own annotated log line.
+void WriteU32Leb128Pair(Stream* stream,
+                        uint32_t first,
+                        const char* first_desc,
+                        uint32_t second,
+                        const char* second_desc);
+
 void WriteS32Leb128(Stream* stream, uint32_t value, const char* desc);
 void WriteS64Leb128(Stream* stream, uint64_t value, const char* desc);
+
+// Encodes |count| values as u32 LEB128s with one stream write per batch
+// instead of one per value. Blocks of eight are tested for the all-single-
+// byte case with one OR fold — true for nearly every index in real modules —
+// and then narrowed with a store loop the compiler vectorizes; mixed blocks
+// fall back to per-value encoding. Intended for long index runs (function
+// section, element segments). Falls back to per-value writes when the
+// stream is logged, so each index keeps its own annotated log line.
+void WriteU32Leb128Vector(Stream* stream,
+                          const uint32_t* values,
+                          size_t count,
+                          const char* desc);
 void WriteFixedU32Leb128(Stream* stream, uint32_t value, const char* desc);
 
 Offset WriteU32Leb128At(Stream* stream,
@@ -44,8 +68,17 @@ Offset WriteFixedU32Leb128At(Stream* stream,
                              const char* desc);
 
 Offset WriteU32Leb128Raw(uint8_t* data, uint8_t* end, uint32_t value);
+Offset WriteS32Leb128Raw(uint8_t* data, uint8_t* end, uint32_t value);
+Offset WriteS64Leb128Raw(uint8_t* data, uint8_t* end, uint64_t value);
 Offset WriteFixedU32Leb128Raw(uint8_t* data, uint8_t* end, uint32_t value);
 
+// Variants that encode into a BulkWriter's cursor instead of writing to the
+// stream directly, for inner loops that batch many fields into one stream
+// write. These carry no description; use the Stream overloads when the
+// output is logged.
+void WriteU32Leb128(BulkWriter* writer, uint32_t value);
+void WriteS32Leb128(BulkWriter* writer, uint32_t value);
+
 // Convenience functions for writing enums as LEB128s.
 template <typename T>
 void WriteU32Leb128(Stream* stream, T value, const char* desc) {
@@ -57,6 +90,16 @@ void WriteS32Leb128(Stream* stream, T value, const char* desc) {
   WriteS32Leb128(stream, static_cast<uint32_t>(value), desc);
 }
 
+template <typename T>
+void WriteU32Leb128(BulkWriter* writer, T value) {
+  WriteU32Leb128(writer, static_cast<uint32_t>(value));
+}
+
+template <typename T>
+void WriteS32Leb128(BulkWriter* writer, T value) {
+  WriteS32Leb128(writer, static_cast<uint32_t>(value));
+}
+
 // Returns the length of the leb128.
 size_t ReadU32Leb128(const uint8_t* p, const uint8_t* end, uint32_t* out_value);
 size_t ReadS32Leb128(const uint8_t* p, const uint8_t* end, uint32_t* out_value);
@@ -17,6 +17,7 @@
 #include "src/lexer-source-line-finder.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "src/lexer-source.h"
 
@@ -24,11 +25,7 @@ namespace wabt {
 
 LexerSourceLineFinder::LexerSourceLineFinder(
     std::unique_ptr<LexerSource> source)
-    : source_(std::move(source)),
-      next_line_start_(0),
-      last_cr_(false),
-      eof_(false) {
-  source_->Seek(0);
+    : source_(std::move(source)), next_line_start_(0), eof_(false) {
   // Line 0 should not be used; but it makes indexing simpler.
   line_ranges_.emplace_back(0, 0);
 }
@@ -42,26 +39,23 @@ Result LexerSourceLineFinder::GetSourceLine(const Location& loc,
 
   OffsetRange clamped =
       ClampSourceLineOffsets(original, column_range, max_line_length);
-  bool has_start_ellipsis = original.start != clamped.start;
-  bool has_end_ellipsis = original.end != clamped.end;
-
+  out_source_line->has_start_ellipsis = original.start != clamped.start;
+  out_source_line->has_end_ellipsis = original.end != clamped.end;
   out_source_line->column_offset = clamped.start - original.start;
 
-  if (has_start_ellipsis) {
-    out_source_line->line += "...";
+  // The ellipses replace the clamped line's outermost characters, so the
+  // displayed width stays within max_line_length.
+  if (out_source_line->has_start_ellipsis) {
     clamped.start += 3;
   }
-  if (has_end_ellipsis) {
+  if (out_source_line->has_end_ellipsis) {
     clamped.end -= 3;
   }
 
-  std::vector<char> read_line;
-  CHECK_RESULT(source_->ReadRange(clamped, &read_line));
-  out_source_line->line.append(read_line.begin(), read_line.end());
-
-  if (has_end_ellipsis) {
-    out_source_line->line += "...";
-  }
+  // Point into the source directly rather than copying the bytes out; the
+  // view stays valid as long as this finder (and its source) does.
+  const char* data = static_cast<const char*>(source_->data());
+  out_source_line->text = string_view(data + clamped.start, clamped.size());
 
   return Result::Ok;
 }
@@ -82,35 +76,30 @@ Result LexerSourceLineFinder::GetLineOffsets(int find_line,
     return Result::Ok;
   }
 
-  const size_t kBufferSize = 1 << 16;
-  std::vector<char> buffer(kBufferSize);
-
   assert(!line_ranges_.empty());
-  Offset buffer_file_offset = 0;
+  // Extend the newline index up to the requested line. The source is all in
+  // memory, so scan it directly rather than copying it through a read buffer;
+  // the scan resumes where the last one stopped, so each byte is visited at
+  // most once no matter how many lines are looked up.
+  const char* data = static_cast<const char*>(source_->data());
+  const Offset size = source_->size();
   while (!IsLineCached(find_line) && !eof_) {
-    CHECK_RESULT(source_->Tell(&buffer_file_offset));
-    size_t read_size = source_->Fill(buffer.data(), buffer.size());
-    if (read_size < buffer.size()) {
+    const char* newline = static_cast<const char*>(
+        memchr(data + next_line_start_, '\n', size - next_line_start_));
+    if (!newline) {
       eof_ = true;
+      // Add the final line, which may be an empty range.
+      line_ranges_.emplace_back(next_line_start_, size);
+      break;
     }
 
-    for (auto iter = buffer.begin(), end = iter + read_size; iter < end;
-         ++iter) {
-      if (*iter == '\n') {
-        // Don't include \n or \r in the line range.
-        Offset line_offset =
-            buffer_file_offset + (iter - buffer.begin()) - last_cr_;
-        line_ranges_.emplace_back(next_line_start_, line_offset);
-        next_line_start_ = line_offset + last_cr_ + 1;
-      }
-      last_cr_ = *iter == '\r';
-    }
-
-    if (eof_) {
-      // Add the final line as an empty range.
-      Offset end = buffer_file_offset + read_size;
-      line_ranges_.emplace_back(next_line_start_, end);
+    // Don't include \n or \r in the line range.
+    Offset line_end = newline - data;
+    if (line_end > next_line_start_ && data[line_end - 1] == '\r') {
+      line_end--;
     }
+    line_ranges_.emplace_back(next_line_start_, line_end);
+    next_line_start_ = (newline - data) + 1;
   }
 
   if (IsLineCached(find_line)) {
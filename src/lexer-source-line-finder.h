@@ -18,20 +18,33 @@
 #define WABT_LEXER_SOURCE_LINE_FINDER_H_
 
 #include <memory>
-#include <string>
 #include <vector>
 
 #include "src/common.h"
 #include "src/lexer-source.h"
 #include "src/range.h"
+#include "src/string-view.h"
 
 namespace wabt {
 
 class LexerSourceLineFinder {
  public:
   struct SourceLine {
-    std::string line;
-    int column_offset;
+    // The displayed portion of the line, borrowed from the finder's source
+    // rather than copied, so it is valid only as long as the finder.
+    // Truncation ellipses are not materialized; the flags record that the
+    // line was clamped and the printer renders "..." around |text|.
+    string_view text;
+    bool has_start_ellipsis = false;
+    bool has_end_ellipsis = false;
+    int column_offset = 0;
+
+    // Size as displayed, including the ellipses.
+    size_t size() const {
+      return text.size() + (has_start_ellipsis ? 3 : 0) +
+             (has_end_ellipsis ? 3 : 0);
+    }
+    bool empty() const { return size() == 0; }
   };
 
   explicit LexerSourceLineFinder(std::unique_ptr<LexerSource>);
@@ -50,9 +63,10 @@ class LexerSourceLineFinder {
   OffsetRange GetCachedLine(int line) const;
 
   std::unique_ptr<LexerSource> source_;
+  // Offsets of every line seen so far, indexed by line number; extended on
+  // demand by GetLineOffsets and shared by every lookup against this finder.
   std::vector<OffsetRange> line_ranges_;
   Offset next_line_start_;
-  bool last_cr_;  // Last read character was a '\r' (carriage return).
   bool eof_;
 };
 
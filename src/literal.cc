@@ -44,6 +44,16 @@ struct FloatTraitsBase<float> {
   static constexpr int kMaxHexBufferSize = WABT_MAX_FLOAT_HEX;
 
   static float Strto(const char* s, char** endptr) { return strtof(s, endptr); }
+
+  // See TryParseDecimalFast: the largest significand and power of ten that
+  // are exactly representable, so one multiply or divide rounds correctly.
+  static constexpr uint64_t kMaxExactSignificand = uint64_t(1) << 24;
+  static constexpr int kMaxExactPow10 = 10;
+  static float ExactPow10(int exp) {
+    static const float kPow10[kMaxExactPow10 + 1] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    return kPow10[exp];
+  }
 };
 
 template <>
@@ -57,6 +67,15 @@ struct FloatTraitsBase<double> {
   static double Strto(const char* s, char** endptr) {
     return strtod(s, endptr);
   }
+
+  static constexpr uint64_t kMaxExactSignificand = uint64_t(1) << 53;
+  static constexpr int kMaxExactPow10 = 22;
+  static double ExactPow10(int exp) {
+    static const double kPow10[kMaxExactPow10 + 1] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    return kPow10[exp];
+  }
 };
 
 template <typename T>
@@ -98,6 +117,9 @@ class FloatParser {
                                      int shift,
                                      bool seen_trailing_non_zero);
 
+  static bool TryParseDecimalFast(const char* s,
+                                  const char* end,
+                                  Uint* out_bits);
   static Result ParseFloat(const char* s, const char* end, Uint* out_bits);
   static Result ParseNan(const char* s, const char* end, Uint* out_bits);
   static Result ParseHex(const char* s, const char* end, Uint* out_bits);
@@ -131,10 +153,100 @@ bool FloatParser<T>::StringStartsWith(const char* start,
 }
 
 // static
+// Fast path for decimal float literals, in the style of fast_float's first
+// tier (Clinger's theorem): when the significand fits exactly in the target
+// type and the decimal exponent is small enough that the power of ten is also
+// exact, a single IEEE multiply or divide of two exact values is correctly
+// rounded. That covers the bulk of human- and tool-written constants without
+// the strto* call (and the underscore-stripping copy it requires). Returns
+// false for anything it can't prove correct — too many digits, a large
+// exponent, or a hex literal — and the caller falls back to strto*.
+template <typename T>
+bool FloatParser<T>::TryParseDecimalFast(const char* s,
+                                         const char* end,
+                                         Uint* out_bits) {
+  bool is_neg = false;
+  if (s < end && (*s == '-' || *s == '+')) {
+    is_neg = *s == '-';
+    s++;
+  }
+
+  uint64_t significand = 0;
+  int frac_digits = 0;
+  bool seen_dot = false;
+  for (; s < end; ++s) {
+    char c = *s;
+    if (c == '_') {
+      continue;
+    } else if (c == '.') {
+      seen_dot = true;
+    } else if (c >= '0' && c <= '9') {
+      significand = significand * 10 + (c - '0');
+      if (significand > Traits::kMaxExactSignificand) {
+        return false;
+      }
+      if (seen_dot) {
+        ++frac_digits;
+      }
+    } else {
+      break;
+    }
+  }
+
+  int exp = 0;
+  if (s < end) {
+    if (*s != 'e' && *s != 'E') {
+      return false;
+    }
+    ++s;
+    bool exp_neg = false;
+    if (s < end && (*s == '-' || *s == '+')) {
+      exp_neg = *s == '-';
+      ++s;
+    }
+    for (; s < end; ++s) {
+      if (*s == '_') {
+        continue;
+      }
+      if (*s < '0' || *s > '9') {
+        return false;
+      }
+      exp = exp * 10 + (*s - '0');
+      if (exp > 1000) {
+        // Far outside the exact range below, even after the dot adjustment.
+        return false;
+      }
+    }
+    if (exp_neg) {
+      exp = -exp;
+    }
+  }
+  exp -= frac_digits;
+
+  Float value;
+  if (significand == 0) {
+    value = 0;
+  } else if (exp < -Traits::kMaxExactPow10 || exp > Traits::kMaxExactPow10) {
+    return false;
+  } else {
+    value = static_cast<Float>(significand);
+    value = exp >= 0 ? value * Traits::ExactPow10(exp)
+                     : value / Traits::ExactPow10(-exp);
+  }
+  if (is_neg) {
+    value = -value;
+  }
+  memcpy(out_bits, &value, sizeof(value));
+  return true;
+}
+
 template <typename T>
 Result FloatParser<T>::ParseFloat(const char* s,
                                   const char* end,
                                   Uint* out_bits) {
+  if (TryParseDecimalFast(s, end, out_bits)) {
+    return Result::Ok;
+  }
   // Here is the normal behavior for strtof/strtod:
   //
   // input     | errno  |   output   |
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/memory-stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "config.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace wabt {
+
+static MemoryStatsSink s_memory_stats_sink;
+
+// The counting flag is read on every allocation, so it is kept separate from
+// the std::function; a relaxed load is all the disabled path pays.
+static std::atomic<bool> s_counting{false};
+static std::atomic<size_t> s_num_allocs{0};
+static std::atomic<size_t> s_allocated_bytes{0};
+static std::atomic<size_t> s_live_bytes{0};
+static std::atomic<size_t> s_peak_live_bytes{0};
+
+static void CountAlloc(size_t size) {
+  s_num_allocs.fetch_add(1, std::memory_order_relaxed);
+  s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  size_t live = s_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peak = s_peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !s_peak_live_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+static void CountFree(size_t size) {
+  // Saturate rather than wrap: blocks allocated before counting was enabled
+  // are freed with sizes that were never added.
+  size_t cur = s_live_bytes.load(std::memory_order_relaxed);
+  size_t dec;
+  do {
+    dec = size < cur ? size : cur;
+  } while (!s_live_bytes.compare_exchange_weak(cur, cur - dec,
+                                               std::memory_order_relaxed));
+}
+
+static size_t GetPeakRssBytes() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+  }
+#endif
+  return 0;
+}
+
+void SetMemoryStatsSink(MemoryStatsSink sink) {
+  s_memory_stats_sink = std::move(sink);
+  s_counting.store(static_cast<bool>(s_memory_stats_sink),
+                   std::memory_order_relaxed);
+}
+
+MemoryStatsSink MakeStreamMemoryStatsSink(Stream* stream) {
+  return [stream](const char* phase, const MemoryPhaseStats& stats) {
+    stream->Writef("%-12s %10" PRIzd " allocs %10" PRIzd " KiB alloc %10" PRIzd
+                   " KiB live peak %10" PRIzd " KiB rss peak\n",
+                   phase, stats.num_allocs, stats.allocated_bytes / 1024,
+                   stats.peak_live_bytes / 1024, stats.peak_rss_bytes / 1024);
+  };
+}
+
+MemoryPhase::MemoryPhase(const char* name) : name_(name) {
+  if (s_memory_stats_sink) {
+    start_allocs_ = s_num_allocs.load(std::memory_order_relaxed);
+    start_allocated_bytes_ = s_allocated_bytes.load(std::memory_order_relaxed);
+    // Restart the live peak so it covers just this phase. Phases in the
+    // tools don't overlap; concurrent phases share one running peak.
+    s_peak_live_bytes.store(s_live_bytes.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+  }
+}
+
+MemoryPhase::~MemoryPhase() {
+  if (!s_memory_stats_sink) {
+    return;
+  }
+  MemoryPhaseStats stats;
+  stats.num_allocs =
+      s_num_allocs.load(std::memory_order_relaxed) - start_allocs_;
+  stats.allocated_bytes =
+      s_allocated_bytes.load(std::memory_order_relaxed) -
+      start_allocated_bytes_;
+  stats.peak_live_bytes = s_peak_live_bytes.load(std::memory_order_relaxed);
+  stats.peak_rss_bytes = GetPeakRssBytes();
+  s_memory_stats_sink(name_, stats);
+}
+
+}  // namespace wabt
+
+// Replacement global allocation functions. They live in this translation
+// unit, so the replacement only happens in binaries that reference the
+// memory-stats interface; other users of the library are untouched. The
+// requested size is stashed ahead of the block (padded to keep malloc's
+// 16-byte alignment) so the matching delete can credit it back.
+namespace {
+
+const size_t kHeaderSize = 16;
+
+void* AllocWithHeader(size_t size) {
+  void* base = malloc(kHeaderSize + size);
+  if (!base) {
+    return nullptr;
+  }
+  *static_cast<size_t*>(base) = size;
+  if (wabt::s_counting.load(std::memory_order_relaxed)) {
+    wabt::CountAlloc(size);
+  }
+  return static_cast<char*>(base) + kHeaderSize;
+}
+
+void FreeWithHeader(void* p) {
+  if (!p) {
+    return;
+  }
+  void* base = static_cast<char*>(p) - kHeaderSize;
+  if (wabt::s_counting.load(std::memory_order_relaxed)) {
+    wabt::CountFree(*static_cast<size_t*>(base));
+  }
+  free(base);
+}
+
+}  // end anonymous namespace
+
+void* operator new(size_t size) {
+  void* p = AllocWithHeader(size);
+  if (!p) {
+#if WITH_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return AllocWithHeader(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return AllocWithHeader(size);
+}
+
+void operator delete(void* p) noexcept {
+  FreeWithHeader(p);
+}
+
+void operator delete[](void* p) noexcept {
+  FreeWithHeader(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  FreeWithHeader(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  FreeWithHeader(p);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_MEMORY_STATS_H_
+#define WABT_MEMORY_STATS_H_
+
+#include <cstddef>
+#include <functional>
+
+#include "src/common.h"
+#include "src/stream.h"
+
+namespace wabt {
+
+// Per-phase allocator statistics behind the tools' --mem-stats flag,
+// companion to the timing phases in timing.h. Counting hooks live in the
+// global operator new/delete (the entry point every MakeUnique, container
+// and string allocation funnels through); with no sink installed they cost
+// one relaxed atomic load per allocation.
+struct MemoryPhaseStats {
+  // Number of allocations and bytes requested during the phase.
+  size_t num_allocs = 0;
+  size_t allocated_bytes = 0;
+  // Highest number of live heap bytes observed during the phase.
+  size_t peak_live_bytes = 0;
+  // Process peak RSS when the phase ended; 0 where not supported.
+  size_t peak_rss_bytes = 0;
+};
+
+typedef std::function<void(const char* phase, const MemoryPhaseStats&)>
+    MemoryStatsSink;
+
+// Installs the sink that receives finished phases and enables the counting
+// hooks; nullptr turns counting off again.
+void SetMemoryStatsSink(MemoryStatsSink sink);
+
+// Returns a sink writing one line per finished phase to |stream|, which must
+// outlive the sink.
+MemoryStatsSink MakeStreamMemoryStatsSink(Stream* stream);
+
+// Reports the allocations made while it is alive, like TimedPhase. Cheap
+// no-op when no sink is installed, so the markers can stay in the tools
+// unconditionally.
+class MemoryPhase {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(MemoryPhase);
+  explicit MemoryPhase(const char* name);
+  ~MemoryPhase();
+
+ private:
+  const char* name_;
+  size_t start_allocs_ = 0;
+  size_t start_allocated_bytes_ = 0;
+};
+
+}  // namespace wabt
+
+#endif  // WABT_MEMORY_STATS_H_
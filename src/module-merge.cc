@@ -0,0 +1,518 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/module-merge.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "src/cast.h"
+#include "src/expr-visitor.h"
+#include "src/ir.h"
+
+namespace wabt {
+
+namespace {
+
+// Flat rewrite tables, one per index space: entry i holds the post-merge
+// index of the item whose pre-merge index was i.
+struct IndexRemapping {
+  std::vector<Index> func_types;
+  std::vector<Index> funcs;
+  std::vector<Index> tables;
+  std::vector<Index> memories;
+  std::vector<Index> globals;
+  std::vector<Index> events;
+  std::vector<Index> elem_segments;
+  std::vector<Index> data_segments;
+};
+
+// Builds the rewrite tables for an index space whose merged order is
+// [module imports, other imports, module definitions, other definitions].
+void BuildShiftedRemapping(Index module_count,
+                           Index module_import_count,
+                           Index other_count,
+                           Index other_import_count,
+                           std::vector<Index>* module_table,
+                           std::vector<Index>* other_table) {
+  module_table->resize(module_count);
+  for (Index i = 0; i < module_count; ++i) {
+    (*module_table)[i] = i < module_import_count ? i : i + other_import_count;
+  }
+  other_table->resize(other_count);
+  for (Index i = 0; i < other_count; ++i) {
+    (*other_table)[i] =
+        i < other_import_count ? module_import_count + i : module_count + i;
+  }
+}
+
+void BuildIdentityRemapping(Index count, std::vector<Index>* table) {
+  table->resize(count);
+  for (Index i = 0; i < count; ++i) {
+    (*table)[i] = i;
+  }
+}
+
+void BuildAppendedRemapping(Index module_count,
+                            Index other_count,
+                            std::vector<Index>* table) {
+  table->resize(other_count);
+  for (Index i = 0; i < other_count; ++i) {
+    (*table)[i] = module_count + i;
+  }
+}
+
+// Rewrites every index-space Var in a module into an index Var with its
+// post-merge index. Label and local Vars are function-local and are left
+// alone.
+class VarRemapper : public ExprVisitorNopDelegate {
+ public:
+  VarRemapper(Module* module, const IndexRemapping& remapping)
+      : module_(module), remapping_(remapping), visitor_(this) {}
+
+  Result VisitModule();
+
+  // Expression handlers, called by ExprVisitorT<VarRemapper>.
+  Result BeginBlockExpr(BlockExpr* expr) {
+    return RemapDeclaration(&expr->block.decl);
+  }
+  Result BeginLoopExpr(LoopExpr* expr) {
+    return RemapDeclaration(&expr->block.decl);
+  }
+  Result BeginIfExpr(IfExpr* expr) {
+    return RemapDeclaration(&expr->true_.decl);
+  }
+  Result BeginTryExpr(TryExpr* expr) {
+    return RemapDeclaration(&expr->block.decl);
+  }
+  Result OnBrOnExnExpr(BrOnExnExpr* expr) {
+    return RemapEventVar(&expr->event_var);
+  }
+  Result OnCallExpr(CallExpr* expr) { return RemapFuncVar(&expr->var); }
+  Result OnRefFuncExpr(RefFuncExpr* expr) { return RemapFuncVar(&expr->var); }
+  Result OnReturnCallExpr(ReturnCallExpr* expr) {
+    return RemapFuncVar(&expr->var);
+  }
+  Result OnCallIndirectExpr(CallIndirectExpr* expr) {
+    CHECK_RESULT(RemapDeclaration(&expr->decl));
+    return RemapTableVar(&expr->table);
+  }
+  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr* expr) {
+    CHECK_RESULT(RemapDeclaration(&expr->decl));
+    return RemapTableVar(&expr->table);
+  }
+  Result OnGlobalGetExpr(GlobalGetExpr* expr) {
+    return RemapGlobalVar(&expr->var);
+  }
+  Result OnGlobalSetExpr(GlobalSetExpr* expr) {
+    return RemapGlobalVar(&expr->var);
+  }
+  Result OnDataDropExpr(DataDropExpr* expr) {
+    return RemapDataSegmentVar(&expr->var);
+  }
+  Result OnMemoryInitExpr(MemoryInitExpr* expr) {
+    return RemapDataSegmentVar(&expr->var);
+  }
+  Result OnElemDropExpr(ElemDropExpr* expr) {
+    return RemapElemSegmentVar(&expr->var);
+  }
+  Result OnTableInitExpr(TableInitExpr* expr) {
+    CHECK_RESULT(RemapElemSegmentVar(&expr->segment_index));
+    return RemapTableVar(&expr->table_index);
+  }
+  Result OnTableGetExpr(TableGetExpr* expr) { return RemapTableVar(&expr->var); }
+  Result OnTableSetExpr(TableSetExpr* expr) { return RemapTableVar(&expr->var); }
+  Result OnTableGrowExpr(TableGrowExpr* expr) {
+    return RemapTableVar(&expr->var);
+  }
+  Result OnTableSizeExpr(TableSizeExpr* expr) {
+    return RemapTableVar(&expr->var);
+  }
+  Result OnTableCopyExpr(TableCopyExpr* expr) {
+    CHECK_RESULT(RemapTableVar(&expr->dst_table));
+    return RemapTableVar(&expr->src_table);
+  }
+  Result OnThrowExpr(ThrowExpr* expr) { return RemapEventVar(&expr->var); }
+
+ private:
+  Result Remap(const std::vector<Index>& table, Index old_index, Var* var);
+  Result RemapFuncTypeVar(Var* var) {
+    return Remap(remapping_.func_types, module_->GetFuncTypeIndex(*var), var);
+  }
+  Result RemapFuncVar(Var* var) {
+    return Remap(remapping_.funcs, module_->GetFuncIndex(*var), var);
+  }
+  Result RemapTableVar(Var* var) {
+    return Remap(remapping_.tables, module_->GetTableIndex(*var), var);
+  }
+  Result RemapMemoryVar(Var* var) {
+    return Remap(remapping_.memories, module_->GetMemoryIndex(*var), var);
+  }
+  Result RemapGlobalVar(Var* var) {
+    return Remap(remapping_.globals, module_->GetGlobalIndex(*var), var);
+  }
+  Result RemapEventVar(Var* var) {
+    return Remap(remapping_.events, module_->GetEventIndex(*var), var);
+  }
+  Result RemapElemSegmentVar(Var* var) {
+    return Remap(remapping_.elem_segments, module_->GetElemSegmentIndex(*var),
+                 var);
+  }
+  Result RemapDataSegmentVar(Var* var) {
+    return Remap(remapping_.data_segments, module_->GetDataSegmentIndex(*var),
+                 var);
+  }
+  Result RemapDeclaration(FuncDeclaration* decl);
+  Result RemapExport(Export* export_);
+
+  Module* module_;
+  const IndexRemapping& remapping_;
+  ExprVisitorT<VarRemapper> visitor_;
+};
+
+Result VarRemapper::Remap(const std::vector<Index>& table,
+                          Index old_index,
+                          Var* var) {
+  if (old_index >= table.size()) {
+    return Result::Error;
+  }
+  var->set_index(table[old_index]);
+  return Result::Ok;
+}
+
+Result VarRemapper::RemapDeclaration(FuncDeclaration* decl) {
+  if (decl->has_func_type) {
+    CHECK_RESULT(RemapFuncTypeVar(&decl->type_var));
+  }
+  return Result::Ok;
+}
+
+Result VarRemapper::RemapExport(Export* export_) {
+  switch (export_->kind) {
+    case ExternalKind::Func:
+      return RemapFuncVar(&export_->var);
+    case ExternalKind::Table:
+      return RemapTableVar(&export_->var);
+    case ExternalKind::Memory:
+      return RemapMemoryVar(&export_->var);
+    case ExternalKind::Global:
+      return RemapGlobalVar(&export_->var);
+    case ExternalKind::Event:
+      return RemapEventVar(&export_->var);
+  }
+  WABT_UNREACHABLE;
+}
+
+Result VarRemapper::VisitModule() {
+  // Walking the fields visits each Func, Global, etc. exactly once; the
+  // module's pointer vectors alias the same objects.
+  for (ModuleField& field : module_->fields) {
+    switch (field.type()) {
+      case ModuleFieldType::Func: {
+        Func& func = cast<FuncModuleField>(&field)->func;
+        CHECK_RESULT(RemapDeclaration(&func.decl));
+        CHECK_RESULT(visitor_.VisitFunc(&func));
+        break;
+      }
+
+      case ModuleFieldType::Global:
+        CHECK_RESULT(visitor_.VisitExprList(
+            cast<GlobalModuleField>(&field)->global.init_expr));
+        break;
+
+      case ModuleFieldType::Import: {
+        Import* import = cast<ImportModuleField>(&field)->import.get();
+        if (auto* func_import = dyn_cast<FuncImport>(import)) {
+          CHECK_RESULT(RemapDeclaration(&func_import->func.decl));
+        } else if (auto* event_import = dyn_cast<EventImport>(import)) {
+          CHECK_RESULT(RemapDeclaration(&event_import->event.decl));
+        }
+        break;
+      }
+
+      case ModuleFieldType::Export:
+        CHECK_RESULT(RemapExport(&cast<ExportModuleField>(&field)->export_));
+        break;
+
+      case ModuleFieldType::Event:
+        CHECK_RESULT(
+            RemapDeclaration(&cast<EventModuleField>(&field)->event.decl));
+        break;
+
+      case ModuleFieldType::ElemSegment: {
+        ElemSegment& segment = cast<ElemSegmentModuleField>(&field)->elem_segment;
+        CHECK_RESULT(RemapTableVar(&segment.table_var));
+        CHECK_RESULT(visitor_.VisitExprList(segment.offset));
+        for (ElemExpr& elem_expr : segment.elem_exprs) {
+          if (elem_expr.kind == ElemExprKind::RefFunc) {
+            CHECK_RESULT(RemapFuncVar(&elem_expr.var));
+          }
+        }
+        break;
+      }
+
+      case ModuleFieldType::DataSegment: {
+        DataSegment& segment = cast<DataSegmentModuleField>(&field)->data_segment;
+        CHECK_RESULT(RemapMemoryVar(&segment.memory_var));
+        CHECK_RESULT(visitor_.VisitExprList(segment.offset));
+        break;
+      }
+
+      case ModuleFieldType::Start:
+        CHECK_RESULT(RemapFuncVar(&cast<StartModuleField>(&field)->start));
+        break;
+
+      case ModuleFieldType::FuncType:
+      case ModuleFieldType::Table:
+      case ModuleFieldType::Memory:
+        break;
+    }
+  }
+  return Result::Ok;
+}
+
+// Rebuilds |bindings| so its names are interned in |pool|; used for the
+// local bindings of functions moved out of |other|, whose names would
+// otherwise dangle when |other|'s string pool is destroyed.
+void ReinternBindings(BindingHash* bindings, StringPool* pool) {
+  BindingHash result;
+  result.set_string_pool(pool);
+  result.reserve(bindings->size());
+  for (const auto& pair : *bindings) {
+    result.emplace(pair.first, pair.second);
+  }
+  *bindings = std::move(result);
+}
+
+// Merges |other_bindings| into |module_bindings|, remapping each side's
+// indexes through its rewrite table and re-interning names in |pool|. When
+// |other_items| is given, an item of |other| whose binding name is already
+// bound loses its name instead of creating a duplicate binding.
+template <typename T>
+void MergeBindingHashes(BindingHash* module_bindings,
+                        const std::vector<Index>& module_table,
+                        const BindingHash& other_bindings,
+                        const std::vector<Index>& other_table,
+                        const std::vector<T*>* other_items,
+                        StringPool* pool) {
+  BindingHash merged;
+  merged.set_string_pool(pool);
+  merged.reserve(module_bindings->size() + other_bindings.size());
+  for (const auto& pair : *module_bindings) {
+    merged.emplace(pair.first,
+                   Binding(pair.second.loc, module_table[pair.second.index]));
+  }
+  for (const auto& pair : other_bindings) {
+    if (other_items && merged.count(pair.first) != 0) {
+      (*other_items)[pair.second.index]->name.clear();
+      continue;
+    }
+    merged.emplace(pair.first,
+                   Binding(pair.second.loc, other_table[pair.second.index]));
+  }
+  *module_bindings = std::move(merged);
+}
+
+bool IsDefinitionField(const ModuleField& field) {
+  switch (field.type()) {
+    case ModuleFieldType::Func:
+    case ModuleFieldType::Table:
+    case ModuleFieldType::Memory:
+    case ModuleFieldType::Global:
+    case ModuleFieldType::Event:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Inserts |other|'s imports into |items| after |import_count| existing
+// imports and appends its definitions, matching the field order the merge
+// produces.
+template <typename T>
+void MergeItemVectors(std::vector<T*>* items,
+                      Index import_count,
+                      const std::vector<T*>& other_items,
+                      Index other_import_count) {
+  items->insert(items->begin() + import_count, other_items.begin(),
+                other_items.begin() + other_import_count);
+  items->insert(items->end(), other_items.begin() + other_import_count,
+                other_items.end());
+}
+
+}  // end anonymous namespace
+
+Result MergeModules(Module* module, Module* other) {
+  IndexRemapping module_remapping;
+  IndexRemapping other_remapping;
+
+  // Type space: reuse an existing type with a matching signature instead of
+  // appending a duplicate; surviving types keep their relative order.
+  std::vector<bool> other_type_kept(other->func_types.size());
+  {
+    Index next_index = module->func_types.size();
+    other_remapping.func_types.reserve(other->func_types.size());
+    for (size_t i = 0; i < other->func_types.size(); ++i) {
+      Index existing = module->GetFuncTypeIndex(other->func_types[i]->sig);
+      other_type_kept[i] = existing == kInvalidIndex;
+      other_remapping.func_types.push_back(
+          other_type_kept[i] ? next_index++ : existing);
+    }
+  }
+  BuildIdentityRemapping(module->func_types.size(),
+                         &module_remapping.func_types);
+
+  BuildShiftedRemapping(module->funcs.size(), module->num_func_imports,
+                        other->funcs.size(), other->num_func_imports,
+                        &module_remapping.funcs, &other_remapping.funcs);
+  BuildShiftedRemapping(module->tables.size(), module->num_table_imports,
+                        other->tables.size(), other->num_table_imports,
+                        &module_remapping.tables, &other_remapping.tables);
+  BuildShiftedRemapping(module->memories.size(), module->num_memory_imports,
+                        other->memories.size(), other->num_memory_imports,
+                        &module_remapping.memories, &other_remapping.memories);
+  BuildShiftedRemapping(module->globals.size(), module->num_global_imports,
+                        other->globals.size(), other->num_global_imports,
+                        &module_remapping.globals, &other_remapping.globals);
+  BuildShiftedRemapping(module->events.size(), module->num_event_imports,
+                        other->events.size(), other->num_event_imports,
+                        &module_remapping.events, &other_remapping.events);
+  BuildIdentityRemapping(module->elem_segments.size(),
+                         &module_remapping.elem_segments);
+  BuildAppendedRemapping(module->elem_segments.size(),
+                         other->elem_segments.size(),
+                         &other_remapping.elem_segments);
+  BuildIdentityRemapping(module->data_segments.size(),
+                         &module_remapping.data_segments);
+  BuildAppendedRemapping(module->data_segments.size(),
+                         other->data_segments.size(),
+                         &other_remapping.data_segments);
+
+  // Rewrite all Var references to their post-merge indexes. Each remapper
+  // resolves names through its own module's bindings, so this must happen
+  // before the bindings are merged.
+  CHECK_RESULT(VarRemapper(other, other_remapping).VisitModule());
+  CHECK_RESULT(VarRemapper(module, module_remapping).VisitModule());
+
+  StringPool* pool = module->string_pool.get();
+  for (Func* func : other->funcs) {
+    ReinternBindings(&func->bindings, pool);
+  }
+
+  MergeBindingHashes(&module->func_type_bindings, module_remapping.func_types,
+                     other->func_type_bindings, other_remapping.func_types,
+                     &other->func_types, pool);
+  MergeBindingHashes(&module->func_bindings, module_remapping.funcs,
+                     other->func_bindings, other_remapping.funcs,
+                     &other->funcs, pool);
+  MergeBindingHashes(&module->table_bindings, module_remapping.tables,
+                     other->table_bindings, other_remapping.tables,
+                     &other->tables, pool);
+  MergeBindingHashes(&module->memory_bindings, module_remapping.memories,
+                     other->memory_bindings, other_remapping.memories,
+                     &other->memories, pool);
+  MergeBindingHashes(&module->global_bindings, module_remapping.globals,
+                     other->global_bindings, other_remapping.globals,
+                     &other->globals, pool);
+  MergeBindingHashes(&module->event_bindings, module_remapping.events,
+                     other->event_bindings, other_remapping.events,
+                     &other->events, pool);
+  MergeBindingHashes(&module->elem_segment_bindings,
+                     module_remapping.elem_segments,
+                     other->elem_segment_bindings,
+                     other_remapping.elem_segments, &other->elem_segments,
+                     pool);
+  MergeBindingHashes(&module->data_segment_bindings,
+                     module_remapping.data_segments,
+                     other->data_segment_bindings,
+                     other_remapping.data_segments, &other->data_segments,
+                     pool);
+
+  // Export names are external interface, not debug names; keep duplicates so
+  // the validator reports the clash.
+  std::vector<Index> module_export_table;
+  std::vector<Index> other_export_table;
+  BuildIdentityRemapping(module->exports.size(), &module_export_table);
+  BuildAppendedRemapping(module->exports.size(), other->exports.size(),
+                         &other_export_table);
+  MergeBindingHashes<Export>(&module->export_bindings, module_export_table,
+                             other->export_bindings, other_export_table,
+                             nullptr, pool);
+
+  // Move |other|'s import fields out, and drop the func type fields whose
+  // signature is being shared.
+  ModuleFieldList other_import_fields;
+  Index type_field_index = 0;
+  for (auto it = other->fields.begin(); it != other->fields.end();) {
+    auto next = std::next(it);
+    if (it->type() == ModuleFieldType::Import) {
+      other_import_fields.splice(other_import_fields.end(), other->fields, it);
+    } else if (it->type() == ModuleFieldType::FuncType &&
+               !other_type_kept[type_field_index++]) {
+      other->fields.erase(it);
+    }
+    it = next;
+  }
+
+  // Imports must precede all definitions, both in the binary index spaces
+  // and in the text format; insert them before |module|'s first definition
+  // field, and append everything else.
+  module->fields.splice(std::find_if(module->fields.begin(),
+                                     module->fields.end(), IsDefinitionField),
+                        other_import_fields);
+  module->fields.splice(module->fields.end(), other->fields);
+
+  MergeItemVectors(&module->funcs, module->num_func_imports, other->funcs,
+                   other->num_func_imports);
+  MergeItemVectors(&module->tables, module->num_table_imports, other->tables,
+                   other->num_table_imports);
+  MergeItemVectors(&module->memories, module->num_memory_imports,
+                   other->memories, other->num_memory_imports);
+  MergeItemVectors(&module->globals, module->num_global_imports,
+                   other->globals, other->num_global_imports);
+  MergeItemVectors(&module->events, module->num_event_imports, other->events,
+                   other->num_event_imports);
+  for (size_t i = 0; i < other->func_types.size(); ++i) {
+    if (other_type_kept[i]) {
+      module->func_types.push_back(other->func_types[i]);
+    }
+  }
+  module->imports.insert(module->imports.end(), other->imports.begin(),
+                         other->imports.end());
+  module->exports.insert(module->exports.end(), other->exports.begin(),
+                         other->exports.end());
+  module->elem_segments.insert(module->elem_segments.end(),
+                               other->elem_segments.begin(),
+                               other->elem_segments.end());
+  module->data_segments.insert(module->data_segments.end(),
+                               other->data_segments.begin(),
+                               other->data_segments.end());
+  module->starts.insert(module->starts.end(), other->starts.begin(),
+                        other->starts.end());
+
+  module->num_func_imports += other->num_func_imports;
+  module->num_table_imports += other->num_table_imports;
+  module->num_memory_imports += other->num_memory_imports;
+  module->num_global_imports += other->num_global_imports;
+  module->num_event_imports += other->num_event_imports;
+
+  // Everything was moved out of |other|; reset it so its stale vectors and
+  // bindings can't be used by mistake.
+  *other = Module();
+  return Result::Ok;
+}
+
+}  // namespace wabt
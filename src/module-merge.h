@@ -0,0 +1,44 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_MODULE_MERGE_H_
+#define WABT_MODULE_MERGE_H_
+
+#include "src/common.h"
+
+namespace wabt {
+
+struct Module;
+
+// Appends the contents of |other| to |module|, rewriting every Var reference
+// in both modules through flat old-index -> new-index tables so the merged
+// index spaces stay consistent: |other|'s imports are inserted after
+// |module|'s imports (and before any definition, as the text format
+// requires), definitions are appended, and func types with a signature that
+// already exists in |module| are shared instead of duplicated.
+//
+// All Var references are rewritten to index form; run ApplyNames afterward to
+// restore names for text output. Names are re-interned in |module|'s string
+// pool, and a binding name used by both modules is dropped from |other|'s
+// item (except export names, which are kept so the validator can report the
+// clash). |other| is left empty. Neither module needs to be valid, but every
+// Var must resolve in its own module; returns an error otherwise, and
+// |module| may have been partially rewritten.
+Result MergeModules(Module* module, Module* other);
+
+}  // namespace wabt
+
+#endif /* WABT_MODULE_MERGE_H_ */
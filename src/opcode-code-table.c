@@ -31,11 +31,15 @@ typedef enum WabtOpcodeEnum {
 
 WABT_STATIC_ASSERT(Invalid <= WABT_OPCODE_CODE_TABLE_SIZE);
 
-/* The array index calculated below must match the one in Opcode::FromCode. */
-uint32_t WabtOpcodeCodeTable[WABT_OPCODE_CODE_TABLE_SIZE] = {
+/* The array index calculated below must match the one in Opcode::FromCode.
+ * Entries are biased by one so that zero always means "no opcode with this
+ * encoding": enum value 0 is a real opcode, and without the bias decode
+ * would need a special case for it. const so the table is emitted into
+ * read-only storage and shared between processes. */
+const uint32_t WabtOpcodeCodeTable[WABT_OPCODE_CODE_TABLE_SIZE] = {
 #define WABT_OPCODE(rtype, type1, type2, type3, mem_size, prefix, code, Name, \
                     text, decomp)                                             \
-  [(prefix << 8) + code] = Name,
+  [(prefix << 8) + code] = Name + 1,
 #include "opcode.def"
 #undef WABT_OPCODE
 };
@@ -29,7 +29,7 @@ extern "C" {
 /* This structure is defined in C because C++ doesn't (yet) allow you to use
  * designated array initializers, i.e. [10] = {foo}.
  */
-extern uint32_t WabtOpcodeCodeTable[WABT_OPCODE_CODE_TABLE_SIZE];
+extern const uint32_t WabtOpcodeCodeTable[WABT_OPCODE_CODE_TABLE_SIZE];
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -21,7 +21,7 @@
 namespace wabt {
 
 // static
-Opcode::Info Opcode::infos_[] = {
+const Opcode::Info Opcode::infos_[] = {
 #define WABT_OPCODE(rtype, type1, type2, type3, mem_size, prefix, code, Name, \
                     text, decomp)                                             \
   {text, decomp, Type::rtype, Type::type1,                                    \
@@ -33,9 +33,23 @@ Opcode::Info Opcode::infos_[] = {
   {"<invalid>", "", Type::Void, Type::Void, Type::Void, Type::Void, 0, 0, 0, 0},
 };
 
+// static
+const Opcode::HotInfo Opcode::hot_infos_[] = {
+#define WABT_OPCODE(rtype, type1, type2, type3, mem_size, prefix, code, Name, \
+                    text, decomp)                                             \
+  {static_cast<int8_t>(Type::rtype), static_cast<int8_t>(Type::type1),        \
+   static_cast<int8_t>(Type::type2), static_cast<int8_t>(Type::type3),        \
+   mem_size, prefix, code},
+#include "src/opcode.def"
+#undef WABT_OPCODE
+
+  {static_cast<int8_t>(Type::Void), static_cast<int8_t>(Type::Void),
+   static_cast<int8_t>(Type::Void), static_cast<int8_t>(Type::Void), 0, 0, 0},
+};
+
 #define WABT_OPCODE(rtype, type1, type2, type3, mem_size, prefix, code, Name, \
                     text, decomp)                                                     \
-  /* static */ Opcode Opcode::Name##_Opcode(Opcode::Name);
+  /* static */ const Opcode Opcode::Name##_Opcode(Opcode::Name);
 #include "src/opcode.def"
 #undef WABT_OPCODE
 
@@ -330,6 +344,11 @@ bool Opcode::IsEnabled(const Features& features) const {
     case Opcode::InterpCallHost:
     case Opcode::InterpData:
     case Opcode::InterpDropKeep:
+    case Opcode::InterpLocalBinop:
+    case Opcode::InterpLocalBinopSet:
+    case Opcode::InterpLocalConstBinop:
+    case Opcode::InterpLocalConstBinopSet:
+    case Opcode::InterpBrDropKeep:
       return false;
 
     default:
@@ -337,6 +356,15 @@ bool Opcode::IsEnabled(const Features& features) const {
   }
 }
 
+EnabledOpcodes::EnabledOpcodes(const Features& features) {
+  for (uint32_t i = 0; i < Opcode::Invalid; ++i) {
+    enabled_[i] = Opcode(static_cast<Opcode::Enum>(i)).IsEnabled(features);
+  }
+  // Codes that don't decode to a known opcode share the sentinel slot; they
+  // are diagnosed as unknown opcodes elsewhere, not as disabled features.
+  enabled_[Opcode::Invalid] = true;
+}
+
 uint32_t Opcode::GetSimdLaneCount() const {
   switch (enum_) {
     case Opcode::I8X16ExtractLaneS:
@@ -41,16 +41,17 @@ struct Opcode {
     Invalid,
   };
 
-// Static opcode objects.
+// Static opcode objects. Constant-initialized into read-only storage: no
+// startup initializers, and the pages are shared between processes.
 #define WABT_OPCODE(rtype, type1, type2, type3, mem_size, prefix, code, Name, \
                     text, decomp)                                             \
-  static Opcode Name##_Opcode;
+  static const Opcode Name##_Opcode;
 #include "src/opcode.def"
 #undef WABT_OPCODE
 
   Opcode() = default;  // Provided so Opcode can be member of a union.
-  Opcode(Enum e) : enum_(e) {}
-  operator Enum() const { return enum_; }
+  constexpr Opcode(Enum e) : enum_(e) {}
+  constexpr operator Enum() const { return enum_; }
 
   static Opcode FromCode(uint32_t);
   static Opcode FromCode(uint8_t prefix, uint32_t code);
@@ -62,11 +63,37 @@ struct Opcode {
   const char* GetDecomp() const {
     return *GetInfo().decomp ? GetInfo().decomp : GetInfo().name;
   }
-  Type GetResultType() const { return GetInfo().result_type; }
-  Type GetParamType1() const { return GetInfo().param1_type; }
-  Type GetParamType2() const { return GetInfo().param2_type; }
-  Type GetParamType3() const { return GetInfo().param3_type; }
-  Address GetMemorySize() const { return GetInfo().memory_size; }
+  Type GetResultType() const {
+    return static_cast<Type>(hot_infos_[HotIndex()].result_type);
+  }
+  Type GetParamType1() const {
+    return static_cast<Type>(hot_infos_[HotIndex()].param1_type);
+  }
+  Type GetParamType2() const {
+    return static_cast<Type>(hot_infos_[HotIndex()].param2_type);
+  }
+  Type GetParamType3() const {
+    return static_cast<Type>(hot_infos_[HotIndex()].param3_type);
+  }
+  Address GetMemorySize() const { return hot_infos_[HotIndex()].memory_size; }
+
+  // Packs the fixed signature's parameter types into one word for the type
+  // checker's fast path: one low-8-bit type byte per parameter, with the
+  // last parameter (top of stack) in the low byte. All type bytes come from
+  // the same HotInfo entry, so with a constant |param_count| this is a
+  // single table lookup.
+  uint32_t GetPackedParamTypes(int param_count) const {
+    const HotInfo& info = hot_infos_[HotIndex()];
+    const int8_t params[3] = {info.param1_type, info.param2_type,
+                              info.param3_type};
+    uint32_t packed = 0;
+    for (int i = 0; i < param_count; ++i) {
+      packed |= static_cast<uint32_t>(
+                    static_cast<uint8_t>(params[param_count - 1 - i]))
+                << (8 * i);
+    }
+    return packed;
+  }
 
   // Get the byte sequence for this opcode, including prefix.
   std::vector<uint8_t> GetBytes() const;
@@ -89,6 +116,10 @@ struct Opcode {
   bool IsEnabled(const Features& features) const;
   bool IsInvalid() const { return enum_ >= Invalid; }
 
+  // Invalid opcodes share the trailing sentinel entry, which has void types
+  // and no memory size; their decoded prefix/code still go through GetInfo.
+  size_t HotIndex() const { return enum_ < Invalid ? enum_ : Invalid; }
+
  private:
   static const uint32_t kMathPrefix = 0xfc;
   static const uint32_t kThreadsPrefix = 0xfe;
@@ -107,13 +138,11 @@ struct Opcode {
     uint32_t prefix_code;  // See PrefixCode below. Used for fast lookup.
   };
 
-  static uint32_t PrefixCode(uint8_t prefix, uint32_t code) {
-    // For now, 8 bits is enough for all codes.
-    if (code >= 0x100) {
-      // Clamp to 0xff, since we know that it is an invalid code.
-      code = 0xff;
-    }
-    return (prefix << 8) | code;
+  // constexpr so the info tables built from it are constant-initialized.
+  static constexpr uint32_t PrefixCode(uint8_t prefix, uint32_t code) {
+    // For now, 8 bits is enough for all codes. Codes >= 0x100 are clamped
+    // to 0xff, since we know they are invalid.
+    return (prefix << 8) | (code >= 0x100 ? 0xff : code);
   }
 
   // The Opcode struct only stores an enumeration (Opcode::Enum) of all valid
@@ -142,12 +171,47 @@ struct Opcode {
     *out_code = prefix_code & 0xff;
   }
 
+  // The signature and memory-size queries above are made per instruction by
+  // the type checker and the binary reader, where copying the full Info (two
+  // pointers plus the cold prefix/code fields) per query is measurable. The
+  // hot fields are kept in this packed parallel table instead: 8 bytes per
+  // opcode, so 8 opcodes share a cache line. Type values all fit in int8_t
+  // and no memory access is wider than 16 bytes.
+  struct HotInfo {
+    int8_t result_type;
+    int8_t param1_type;
+    int8_t param2_type;
+    int8_t param3_type;
+    uint8_t memory_size;
+    uint8_t prefix;
+    uint16_t code;
+  };
+  WABT_STATIC_ASSERT(sizeof(HotInfo) == 8);
+
   Info GetInfo() const;
-  static Info infos_[];
+  // Both tables are constant-initialized and const, so they live in .rodata.
+  static const Info infos_[];
+  static const HotInfo hot_infos_[];
 
   Enum enum_;
 };
 
+// Precomputed Opcode::IsEnabled() results for one fixed feature set.
+// IsEnabled() is a large switch over the opcode enum plus feature-flag
+// loads; decoders that check every instruction against the enabled
+// features (see ERROR_UNLESS_OPCODE_ENABLED in binary-reader.cc) can
+// build one of these up front and pay a single table load per
+// instruction instead.
+class EnabledOpcodes {
+ public:
+  explicit EnabledOpcodes(const Features& features);
+
+  bool IsEnabled(Opcode opcode) const { return enabled_[opcode.HotIndex()]; }
+
+ private:
+  bool enabled_[Opcode::Invalid + 1];
+};
+
 // static
 inline Opcode Opcode::FromCode(uint32_t code) {
   return FromCode(0, code);
@@ -155,18 +219,14 @@ inline Opcode Opcode::FromCode(uint32_t code) {
 
 // static
 inline Opcode Opcode::FromCode(uint8_t prefix, uint32_t code) {
+  // PrefixCode clamps the code byte, so prefix_code always indexes within the
+  // table. Entries are biased by one with 0 meaning "no opcode with this
+  // encoding" (see opcode-code-table.c), so decode is a single load and a
+  // select between the unbiased value and the encoded invalid opcode.
   uint32_t prefix_code = PrefixCode(prefix, code);
-
-  if (WABT_LIKELY(prefix_code < WABT_ARRAY_SIZE(WabtOpcodeCodeTable))) {
-    uint32_t value = WabtOpcodeCodeTable[prefix_code];
-    // The default value in the table is 0. That's a valid value, but only if
-    // the code is 0 (for nop).
-    if (WABT_LIKELY(value != 0 || code == 0)) {
-      return Opcode(static_cast<Enum>(value));
-    }
-  }
-
-  return Opcode(EncodeInvalidOpcode(prefix_code));
+  uint32_t value = WabtOpcodeCodeTable[prefix_code];
+  return Opcode(value != 0 ? static_cast<Enum>(value - 1)
+                           : EncodeInvalidOpcode(prefix_code));
 }
 
 
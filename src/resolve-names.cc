@@ -102,7 +102,8 @@ class NameResolver : public ExprVisitor::DelegateNop {
   Module* current_module_ = nullptr;
   Func* current_func_ = nullptr;
   ExprVisitor visitor_;
-  std::vector<std::string> labels_;
+  // Pointers into the IR's block labels, which are stable while visiting.
+  std::vector<const std::string*> labels_;
   Result result_ = Result::Ok;
 };
 
@@ -122,7 +123,7 @@ void WABT_PRINTF_FORMAT(3, 4) NameResolver::PrintError(const Location* loc,
 }
 
 void NameResolver::PushLabel(const std::string& label) {
-  labels_.push_back(label);
+  labels_.push_back(&label);
 }
 
 void NameResolver::PopLabel() {
@@ -144,13 +145,14 @@ void NameResolver::PrintDuplicateBindingsError(const BindingHash::value_type& a,
   const Location& a_loc = a.second.loc;
   const Location& b_loc = b.second.loc;
   const Location& loc = a_loc.line > b_loc.line ? a_loc : b_loc;
-  PrintError(&loc, "redefinition of %s \"%s\"", desc, a.first.c_str());
+  PrintError(&loc, "redefinition of %s \"" PRIstringview "\"", desc,
+             WABT_PRINTF_STRING_VIEW_ARG(a.first));
 }
 
 void NameResolver::ResolveLabelVar(Var* var) {
   if (var->is_name()) {
     for (int i = labels_.size() - 1; i >= 0; --i) {
-      const std::string& label = labels_[i];
+      const std::string& label = *labels_[i];
       if (label == var->name()) {
         var->set_index(labels_.size() - i - 1);
         return;
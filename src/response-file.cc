@@ -0,0 +1,63 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/response-file.h"
+
+#include <cstdint>
+
+#include "src/common.h"
+
+namespace wabt {
+
+std::vector<BatchEntry> ReadResponseFile(
+    const char* filename,
+    std::string (*default_outfile)(string_view infile)) {
+  std::vector<uint8_t> file_data;
+  if (Failed(ReadFile(filename, &file_data))) {
+    WABT_FATAL("unable to read response file: %s\n", filename);
+  }
+
+  std::vector<BatchEntry> entries;
+  string_view text(reinterpret_cast<const char*>(file_data.data()),
+                   file_data.size());
+  while (!text.empty()) {
+    size_t eol = text.find_first_of('\n');
+    std::string line = text.substr(0, eol).to_string();
+    text.remove_prefix(eol == string_view::npos ? text.size() : eol + 1);
+
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
+    }
+    size_t end = line.find_first_of(" \t\r", start);
+    BatchEntry entry;
+    entry.infile = line.substr(start, end - start);
+    if (end != std::string::npos) {
+      start = line.find_first_not_of(" \t\r", end);
+      if (start != std::string::npos) {
+        end = line.find_first_of(" \t\r", start);
+        entry.outfile = line.substr(start, end - start);
+      }
+    }
+    if (entry.outfile.empty()) {
+      entry.outfile = default_outfile(entry.infile);
+    }
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+}  // namespace wabt
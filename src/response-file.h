@@ -0,0 +1,44 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_RESPONSE_FILE_H_
+#define WABT_RESPONSE_FILE_H_
+
+#include <string>
+#include <vector>
+
+#include "src/string-view.h"
+
+namespace wabt {
+
+// One "input [output]" line of a response file.
+struct BatchEntry {
+  std::string infile;
+  std::string outfile;
+};
+
+// Reads a batch response file, as consumed by the tools' --batch modes: one
+// input filename per line, optionally followed by an output filename.
+// Filenames may not contain spaces; the line is whitespace-split into the
+// two. '#' starts a comment line. Entries without an output filename get
+// |default_outfile|(infile). Fatal if the file can't be read.
+std::vector<BatchEntry> ReadResponseFile(
+    const char* filename,
+    std::string (*default_outfile)(string_view infile));
+
+}  // namespace wabt
+
+#endif /* WABT_RESPONSE_FILE_H_ */
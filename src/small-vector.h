@@ -0,0 +1,384 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_SMALL_VECTOR_H_
+#define WABT_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace wabt {
+
+// A vector with inline storage for its first kInlineCapacity elements, so
+// short vectors make no heap allocation at all; longer ones spill to the
+// heap like std::vector. Used for type vectors (function signatures, block
+// types, type-checker label signatures), which are almost always a handful
+// of entries but are created by the millions during validation and interp
+// lowering. The API is the subset of std::vector the code base uses;
+// iterators are plain pointers and are invalidated by any growth.
+template <typename T, size_t kInlineCapacity>
+class SmallVector {
+ public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  SmallVector() : data_(inline_data()), size_(0), capacity_(kInlineCapacity) {}
+
+  explicit SmallVector(size_type count) : SmallVector() {
+    resize(count);
+  }
+
+  SmallVector(size_type count, const T& value) : SmallVector() {
+    assign(count, value);
+  }
+
+  template <typename InputIt,
+            typename = typename std::iterator_traits<InputIt>::value_type>
+  SmallVector(InputIt first, InputIt last) : SmallVector() {
+    assign(first, last);
+  }
+
+  SmallVector(std::initializer_list<T> init)
+      : SmallVector(init.begin(), init.end()) {}
+
+  SmallVector(const SmallVector& other)
+      : SmallVector(other.begin(), other.end()) {}
+
+  SmallVector(SmallVector&& other) : SmallVector() {
+    MoveFrom(&other);
+  }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) {
+    if (this != &other) {
+      clear();
+      if (!is_inline()) {
+        Deallocate(data_);
+        data_ = inline_data();
+        capacity_ = kInlineCapacity;
+      }
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(std::initializer_list<T> init) {
+    assign(init.begin(), init.end());
+    return *this;
+  }
+
+  ~SmallVector() {
+    clear();
+    if (!is_inline()) {
+      Deallocate(data_);
+    }
+  }
+
+  iterator begin() { return data_; }
+  const_iterator begin() const { return data_; }
+  const_iterator cbegin() const { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator end() const { return data_ + size_; }
+  const_iterator cend() const { return data_ + size_; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  size_type size() const { return size_; }
+  size_type capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  reference operator[](size_type index) {
+    assert(index < size_);
+    return data_[index];
+  }
+  const_reference operator[](size_type index) const {
+    assert(index < size_);
+    return data_[index];
+  }
+
+  reference at(size_type index) { return (*this)[index]; }
+  const_reference at(size_type index) const { return (*this)[index]; }
+
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return (*this)[0]; }
+  reference back() { return (*this)[size_ - 1]; }
+  const_reference back() const { return (*this)[size_ - 1]; }
+
+  void reserve(size_type new_capacity) {
+    if (new_capacity > capacity_) {
+      Grow(new_capacity);
+    }
+  }
+
+  void resize(size_type new_size) {
+    if (new_size < size_) {
+      Destroy(data_ + new_size, data_ + size_);
+    } else {
+      CheckCount(new_size);
+      reserve(new_size);
+      for (size_type i = size_; i < new_size; ++i) {
+        new (data_ + i) T();
+      }
+    }
+    size_ = new_size;
+  }
+
+  void resize(size_type new_size, const T& value) {
+    if (new_size < size_) {
+      Destroy(data_ + new_size, data_ + size_);
+    } else {
+      CheckCount(new_size);
+      reserve(new_size);
+      for (size_type i = size_; i < new_size; ++i) {
+        new (data_ + i) T(value);
+      }
+    }
+    size_ = new_size;
+  }
+
+  void clear() {
+    Destroy(data_, data_ + size_);
+    size_ = 0;
+  }
+
+// Some GCC releases can't see that elements copied out of the inline
+// storage were placement-new'd there and report -Wmaybe-uninitialized
+// against the construct site below.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+  void push_back(const T& value) {
+    if (size_ == capacity_) {
+      Grow(capacity_ * 2);
+    }
+    new (data_ + size_) T(value);
+    ++size_;
+  }
+
+  void push_back(T&& value) {
+    if (size_ == capacity_) {
+      Grow(capacity_ * 2);
+    }
+    new (data_ + size_) T(std::move(value));
+    ++size_;
+  }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    if (size_ == capacity_) {
+      Grow(capacity_ * 2);
+    }
+    new (data_ + size_) T(std::forward<Args>(args)...);
+    ++size_;
+  }
+
+  void pop_back() {
+    assert(size_ > 0);
+    data_[--size_].~T();
+  }
+
+  void assign(size_type count, const T& value) {
+    clear();
+    reserve(count);
+    for (size_type i = 0; i < count; ++i) {
+      new (data_ + i) T(value);
+    }
+    size_ = count;
+  }
+
+  template <typename InputIt,
+            typename = typename std::iterator_traits<InputIt>::value_type>
+  void assign(InputIt first, InputIt last) {
+    clear();
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  // Inserting a reference to an element of this vector is not supported;
+  // the value may be read after it was moved by the shift.
+  iterator insert(const_iterator pos, const T& value) {
+    return insert(pos, &value, &value + 1);
+  }
+
+  template <typename InputIt,
+            typename = typename std::iterator_traits<InputIt>::value_type>
+  iterator insert(const_iterator pos, InputIt first, InputIt last) {
+    size_type index = pos - data_;
+    size_type count = std::distance(first, last);
+    assert(index <= size_);
+    if (count == 0) {
+      // Nothing to insert; bail before the shift loop degenerates into
+      // self-move-assigning the whole tail.
+      return data_ + index;
+    }
+    reserve(size_ + count);
+    // Shift the tail up, constructing into the uninitialized slots.
+    for (size_type i = size_; i > index; --i) {
+      if (i + count - 1 >= size_) {
+        new (data_ + i + count - 1) T(std::move(data_[i - 1]));
+        data_[i - 1].~T();
+      } else {
+        data_[i + count - 1] = std::move(data_[i - 1]);
+      }
+    }
+    for (size_type i = index; first != last; ++first, ++i) {
+      if (i >= size_) {
+        new (data_ + i) T(*first);
+      } else {
+        data_[i] = *first;
+      }
+    }
+    size_ += count;
+    return data_ + index;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    size_type index = first - data_;
+    size_type count = last - first;
+    assert(index + count <= size_);
+    std::move(data_ + index + count, data_ + size_, data_ + index);
+    Destroy(data_ + size_ - count, data_ + size_);
+    size_ -= count;
+    return data_ + index;
+  }
+
+  friend bool operator==(const SmallVector& lhs, const SmallVector& rhs) {
+    return lhs.size_ == rhs.size_ &&
+           std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+
+  friend bool operator!=(const SmallVector& lhs, const SmallVector& rhs) {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator<(const SmallVector& lhs, const SmallVector& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
+                                        rhs.end());
+  }
+
+ private:
+  T* inline_data() { return reinterpret_cast<T*>(inline_storage_); }
+  bool is_inline() const {
+    return data_ == reinterpret_cast<const T*>(inline_storage_);
+  }
+
+  // Refuses counts whose byte size can't be represented, before any
+  // arithmetic overflows. Besides correctness, the explicit bound keeps
+  // newer GCCs from warning that the allocation or construction-loop size
+  // is unbounded (-Walloc-size-larger-than=, -Wstringop-overflow=) in
+  // WERROR builds. abort() rather than throw: wabt builds without
+  // exceptions.
+  static void CheckCount(size_type count) {
+    if (count > static_cast<size_type>(PTRDIFF_MAX) / sizeof(T)) {
+      abort();
+    }
+  }
+
+  static T* Allocate(size_type count) {
+    CheckCount(count);
+    return static_cast<T*>(::operator new(count * sizeof(T)));
+  }
+  static void Deallocate(T* data) { ::operator delete(data); }
+
+  static void Destroy(T* first, T* last) {
+    for (; first != last; ++first) {
+      first->~T();
+    }
+  }
+
+  void Grow(size_type new_capacity) {
+    new_capacity = std::max(new_capacity, capacity_ * 2);
+    T* new_data = Allocate(new_capacity);
+    for (size_type i = 0; i < size_; ++i) {
+      new (new_data + i) T(std::move(data_[i]));
+      data_[i].~T();
+    }
+    if (!is_inline()) {
+      Deallocate(data_);
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  // Steals |other|'s heap buffer, or moves its elements into our inline
+  // storage; either way |other| is left empty. Expects *this to be empty
+  // and using inline storage.
+  void MoveFrom(SmallVector* other) {
+    assert(size_ == 0 && is_inline());
+    if (other->is_inline()) {
+      for (size_type i = 0; i < other->size_; ++i) {
+        new (data_ + i) T(std::move(other->data_[i]));
+        other->data_[i].~T();
+      }
+      size_ = other->size_;
+      other->size_ = 0;
+    } else {
+      data_ = other->data_;
+      size_ = other->size_;
+      capacity_ = other->capacity_;
+      other->data_ = other->inline_data();
+      other->size_ = 0;
+      other->capacity_ = kInlineCapacity;
+    }
+  }
+
+  T* data_;
+  size_type size_;
+  size_type capacity_;
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type
+      inline_storage_[kInlineCapacity];
+};
+
+}  // namespace wabt
+
+#endif  // WABT_SMALL_VECTOR_H_
@@ -19,6 +19,17 @@
 #include <cassert>
 #include <cctype>
 #include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WABT_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WABT_HAS_MMAP 0
+#endif
 
 #define DUMP_OCTETS_PER_LINE 16
 #define DUMP_OCTETS_PER_GROUP 2
@@ -58,6 +69,15 @@ void Stream::WriteData(const void* src,
   offset_ += size;
 }
 
+void Stream::WriteDataBatched(const DataSpan* spans,
+                              size_t count,
+                              const char* desc,
+                              PrintChars print_chars) {
+  for (size_t i = 0; i < count; ++i) {
+    WriteData(spans[i].data, spans[i].size, desc, print_chars);
+  }
+}
+
 void Stream::MoveData(size_t dst_offset, size_t src_offset, size_t size) {
   if (Failed(result_)) {
     return;
@@ -81,8 +101,13 @@ void Stream::WriteMemoryDump(const void* start,
                              PrintChars print_chars,
                              const char* prefix,
                              const char* desc) {
+  static const char s_hexdigits[] = "0123456789abcdef";
   const uint8_t* p = static_cast<const uint8_t*>(start);
   const uint8_t* end = p + size;
+  // Hex column, one space per group, then the optional character column.
+  char line_buf[DUMP_OCTETS_PER_LINE * 2 +
+                DUMP_OCTETS_PER_LINE / DUMP_OCTETS_PER_GROUP + 1 +
+                DUMP_OCTETS_PER_LINE];
   while (p < end) {
     const uint8_t* line = p;
     const uint8_t* line_end = p + DUMP_OCTETS_PER_LINE;
@@ -91,24 +116,29 @@ void Stream::WriteMemoryDump(const void* start,
     }
     Writef("%07" PRIzx ": ", reinterpret_cast<intptr_t>(p) -
                                  reinterpret_cast<intptr_t>(start) + offset);
+    // Format the whole line into line_buf and write it with one call; going
+    // through Writef per byte dominates the cost of dumping large sections.
+    char* out = line_buf;
     while (p < line_end) {
       for (int i = 0; i < DUMP_OCTETS_PER_GROUP; ++i, ++p) {
         if (p < end) {
-          Writef("%02x", *p);
+          *out++ = s_hexdigits[*p >> 4];
+          *out++ = s_hexdigits[*p & 0xf];
         } else {
-          WriteChar(' ');
-          WriteChar(' ');
+          *out++ = ' ';
+          *out++ = ' ';
         }
       }
-      WriteChar(' ');
+      *out++ = ' ';
     }
 
     if (print_chars == PrintChars::Yes) {
-      WriteChar(' ');
+      *out++ = ' ';
       p = line;
       for (int i = 0; i < DUMP_OCTETS_PER_LINE && p < end; ++i, ++p)
-        WriteChar(isprint(*p) ? *p : '.');
+        *out++ = isprint(*p) ? *p : '.';
     }
+    WriteData(line_buf, out - line_buf);
 
     /* if there are multiple lines, only print the desc on the last one */
     if (p >= end && desc) {
@@ -195,21 +225,203 @@ Result MemoryStream::MoveDataImpl(size_t dst_offset,
   return Result::Ok;
 }
 
-FileStream::FileStream(string_view filename, Stream* log_stream)
-    : Stream(log_stream), file_(nullptr), offset_(0), should_close_(false) {
+// Initial file/mapping capacity; grown by doubling, so a 500 MB module pays
+// about nine remaps on the way up.
+static const size_t kMmapStreamInitialCapacity = 1024 * 1024;
+
+MmapStream::MmapStream(string_view filename, Stream* log_stream)
+    : Stream(log_stream), filename_(filename.to_string()) {
+#if WABT_HAS_MMAP
+  fd_ = open(filename_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd_ == -1) {
+    // Fall back to buffering; Finish's WriteToFile reports the open failure
+    // with the usual message if the file still can't be created.
+    use_fallback_ = true;
+  }
+#else
+  use_fallback_ = true;
+#endif
+}
+
+MmapStream::~MmapStream() {
+  ReleaseMapping();
+#if WABT_HAS_MMAP
+  if (fd_ != -1) {
+    close(fd_);
+  }
+#endif
+}
+
+void MmapStream::ReleaseMapping() {
+#if WABT_HAS_MMAP
+  if (base_) {
+    munmap(base_, map_size_);
+  }
+#endif
+  base_ = nullptr;
+  map_size_ = 0;
+}
+
+// Copies whatever has been written so far into the owned buffer and carries
+// on there; the mapped bytes are still addressable at this point, so nothing
+// is lost.
+void MmapStream::SwitchToFallback() {
+#if WABT_HAS_MMAP
+  assert(!use_fallback_);
+  fallback_.data.resize(size_);
+  if (size_ > 0) {
+    memcpy(fallback_.data.data(), base_, size_);
+  }
+  ReleaseMapping();
+  close(fd_);
+  fd_ = -1;
+  use_fallback_ = true;
+#endif
+}
+
+void MmapStream::EnsureCapacity(size_t needed) {
+#if WABT_HAS_MMAP
+  if (needed <= map_size_) {
+    return;
+  }
+  size_t new_size =
+      map_size_ ? map_size_ : kMmapStreamInitialCapacity;
+  while (new_size < needed) {
+    new_size *= 2;
+  }
+  if (ftruncate(fd_, new_size) != 0) {
+    SwitchToFallback();
+    return;
+  }
+  // Map the grown file before unmapping the old view, so the bytes written
+  // so far stay addressable if the new mapping fails.
+  void* new_base =
+      mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (new_base == MAP_FAILED) {
+    SwitchToFallback();
+    return;
+  }
+  ReleaseMapping();
+  base_ = static_cast<uint8_t*>(new_base);
+  map_size_ = new_size;
+#endif
+}
+
+void MmapStream::Reserve(size_t size) {
+  if (use_fallback_) {
+    fallback_.data.reserve(size);
+  } else {
+    EnsureCapacity(size);
+  }
+}
+
+Result MmapStream::WriteDataImpl(size_t dst_offset,
+                                 const void* src,
+                                 size_t size) {
+  if (size == 0) {
+    return Result::Ok;
+  }
+  size_t end = dst_offset + size;
+  if (!use_fallback_) {
+    EnsureCapacity(end);
+  }
+  if (use_fallback_) {
+    if (end > fallback_.data.size()) {
+      fallback_.data.resize(end);
+    }
+    memcpy(&fallback_.data[dst_offset], src, size);
+  } else {
+    memcpy(base_ + dst_offset, src, size);
+  }
+  if (end > size_) {
+    size_ = end;
+  }
+  return Result::Ok;
+}
+
+Result MmapStream::MoveDataImpl(size_t dst_offset,
+                                size_t src_offset,
+                                size_t size) {
+  if (size == 0) {
+    return Result::Ok;
+  }
+  size_t src_end = src_offset + size;
+  size_t dst_end = dst_offset + size;
+  size_t end = src_end > dst_end ? src_end : dst_end;
+  if (!use_fallback_) {
+    EnsureCapacity(end);
+  }
+  if (use_fallback_) {
+    if (end > fallback_.data.size()) {
+      fallback_.data.resize(end);
+    }
+    memmove(&fallback_.data[dst_offset], &fallback_.data[src_offset], size);
+  } else {
+    memmove(base_ + dst_offset, base_ + src_offset, size);
+  }
+  if (end > size_) {
+    size_ = end;
+  }
+  return Result::Ok;
+}
+
+Result MmapStream::Finish() {
+  if (use_fallback_) {
+    Result write_result = fallback_.WriteToFile(filename_);
+    fallback_.clear();
+    return Failed(result()) ? Result(Result::Error) : write_result;
+  }
+  Result finish_result = Result::Ok;
+#if WABT_HAS_MMAP
+  ReleaseMapping();
+  if (fd_ != -1) {
+    // Trim the doubling slack back to the bytes actually written.
+    if (ftruncate(fd_, size_) != 0) {
+      ERROR("ftruncate %s to %" PRIzd " bytes failed, errno=%d\n",
+            filename_.c_str(), size_, errno);
+      finish_result = Result::Error;
+    }
+    close(fd_);
+    fd_ = -1;
+  }
+#endif
+  return Failed(result()) ? Result(Result::Error) : finish_result;
+}
+
+FileStream::FileStream(string_view filename,
+                       Stream* log_stream,
+                       size_t buffer_size)
+    : Stream(log_stream),
+      file_(nullptr),
+      offset_(0),
+      should_close_(false),
+      buffer_size_(buffer_size),
+      buffer_used_(0) {
   std::string filename_str = filename.to_string();
   file_ = fopen(filename_str.c_str(), "wb");
 
   // TODO(binji): this is pretty cheesy, should come up with a better API.
   if (file_) {
     should_close_ = true;
+    if (buffer_size_ > 0) {
+      buffer_.reset(new char[buffer_size_]);
+    }
   } else {
     ERROR("fopen name=\"%s\" failed, errno=%d\n", filename_str.c_str(), errno);
   }
 }
 
-FileStream::FileStream(FILE* file, Stream* log_stream)
-    : Stream(log_stream), file_(file), offset_(0), should_close_(false) {}
+FileStream::FileStream(FILE* file, Stream* log_stream, size_t buffer_size)
+    : Stream(log_stream),
+      file_(file),
+      offset_(0),
+      should_close_(false),
+      buffer_size_(buffer_size),
+      buffer_used_(0) {
+  if (file_ && buffer_size_ > 0) {
+    buffer_.reset(new char[buffer_size_]);
+  }
+}
 
 FileStream::FileStream(FileStream&& other) {
   *this = std::move(other);
@@ -219,13 +431,21 @@ FileStream& FileStream::operator=(FileStream&& other) {
   file_ = other.file_;
   offset_ = other.offset_;
   should_close_ = other.should_close_;
+  buffer_ = std::move(other.buffer_);
+  buffer_size_ = other.buffer_size_;
+  buffer_used_ = other.buffer_used_;
   other.file_ = nullptr;
   other.offset_ = 0;
   other.should_close_ = false;
+  other.buffer_size_ = 0;
+  other.buffer_used_ = 0;
   return *this;
 }
 
 FileStream::~FileStream() {
+  if (file_) {
+    FlushBuffer();
+  }
   // We don't want to close existing files (stdout/sterr, for example).
   if (should_close_) {
     fclose(file_);
@@ -233,7 +453,23 @@ FileStream::~FileStream() {
 }
 
 void FileStream::Flush() {
-  if (file_) fflush(file_);
+  if (file_) {
+    FlushBuffer();
+    fflush(file_);
+  }
+}
+
+Result FileStream::FlushBuffer() {
+  if (buffer_used_ == 0) {
+    return Result::Ok;
+  }
+  size_t size = buffer_used_;
+  buffer_used_ = 0;
+  if (fwrite(buffer_.get(), size, 1, file_) != 1) {
+    ERROR("fwrite size=%" PRIzd " failed, errno=%d\n", size, errno);
+    return Result::Error;
+  }
+  return Result::Ok;
 }
 
 Result FileStream::WriteDataImpl(size_t at, const void* data, size_t size) {
@@ -243,16 +479,33 @@ Result FileStream::WriteDataImpl(size_t at, const void* data, size_t size) {
   if (size == 0) {
     return Result::Ok;
   }
+  // offset_ is the logical offset, i.e. the FILE position plus buffer_used_.
   if (at != offset_) {
+    if (Failed(FlushBuffer())) {
+      return Result::Error;
+    }
     if (fseek(file_, at, SEEK_SET) != 0) {
       ERROR("fseek offset=%" PRIzd " failed, errno=%d\n", size, errno);
       return Result::Error;
     }
     offset_ = at;
   }
-  if (fwrite(data, size, 1, file_) != 1) {
-    ERROR("fwrite size=%" PRIzd " failed, errno=%d\n", size, errno);
-    return Result::Error;
+  // Write through for unbuffered streams and writes that wouldn't benefit
+  // from being coalesced.
+  if (size >= buffer_size_) {
+    if (Failed(FlushBuffer())) {
+      return Result::Error;
+    }
+    if (fwrite(data, size, 1, file_) != 1) {
+      ERROR("fwrite size=%" PRIzd " failed, errno=%d\n", size, errno);
+      return Result::Error;
+    }
+  } else {
+    if (buffer_used_ + size > buffer_size_ && Failed(FlushBuffer())) {
+      return Result::Error;
+    }
+    memcpy(buffer_.get() + buffer_used_, data, size);
+    buffer_used_ += size;
   }
   offset_ += size;
   return Result::Ok;
@@ -75,6 +75,18 @@ class Stream {
                    const char* desc = nullptr,
                    PrintChars = PrintChars::No);
 
+  // A (pointer, size) pair for WriteDataBatched; the same shape as an iovec.
+  struct DataSpan {
+    const void* data;
+    size_t size;
+  };
+
+  // Writes all spans sequentially, as if by calling WriteData on each.
+  void WriteDataBatched(const DataSpan* spans,
+                        size_t count,
+                        const char* desc = nullptr,
+                        PrintChars = PrintChars::No);
+
   void MoveData(size_t dst_offset, size_t src_offset, size_t size);
 
   void WABT_PRINTF_FORMAT(2, 3) Writef(const char* format, ...);
@@ -127,6 +139,11 @@ class Stream {
 
   virtual void Flush() {}
 
+  // Hint that at least size bytes will be written to the stream; streams
+  // backed by growable storage can reserve it up front to avoid repeated
+  // reallocation. No-op by default.
+  virtual void Reserve(size_t size) { WABT_USE(size); }
+
  protected:
   virtual Result WriteDataImpl(size_t offset,
                                const void* data,
@@ -147,6 +164,72 @@ class Stream {
   Stream* log_stream_;
 };
 
+// Accumulates a run of small writes in a local buffer with plain pointer
+// arithmetic and hands them to the stream as one WriteData on commit, so the
+// stream's per-call offset and log accounting runs once per run instead of
+// once per field. Intended for hot encoder inner loops; since the committed
+// run is logged as a single blob, callers should fall back to the plain
+// Write* calls when the stream has a log stream attached, so each field
+// keeps its own annotated log line (cf. WriteU32Leb128Pair).
+class BulkWriter {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(BulkWriter);
+
+  static const size_t kBufferSize = 512;
+
+  explicit BulkWriter(Stream* stream, const char* desc = nullptr)
+      : stream_(stream), desc_(desc), cur_(buffer_) {}
+  ~BulkWriter() { Commit(); }
+
+  // Returns a span of at least |size| writable bytes at the cursor,
+  // committing the buffered bytes first if it is too full. Call Advance with
+  // the number of bytes actually written. |size| must be at most kBufferSize.
+  uint8_t* Reserve(size_t size) {
+    assert(size <= kBufferSize);
+    if (WABT_UNLIKELY(static_cast<size_t>(buffer_ + kBufferSize - cur_) <
+                      size)) {
+      Commit();
+    }
+    return cur_;
+  }
+
+  void Advance(size_t size) {
+    assert(static_cast<size_t>(buffer_ + kBufferSize - cur_) >= size);
+    cur_ += size;
+  }
+
+  void WriteU8(uint8_t value) {
+    *Reserve(1) = value;
+    Advance(1);
+  }
+
+  void WriteData(const void* src, size_t size) {
+    if (WABT_UNLIKELY(size > kBufferSize)) {
+      // Too big to buffer; flush what came before it so order is preserved.
+      Commit();
+      stream_->WriteData(src, size, desc_);
+      return;
+    }
+    memcpy(Reserve(size), src, size);
+    Advance(size);
+  }
+
+  // Writes everything accumulated since the last commit as a single
+  // stream write.
+  void Commit() {
+    if (cur_ != buffer_) {
+      stream_->WriteData(buffer_, cur_ - buffer_, desc_);
+      cur_ = buffer_;
+    }
+  }
+
+ private:
+  Stream* stream_;
+  const char* desc_;
+  uint8_t* cur_;
+  uint8_t buffer_[kBufferSize];
+};
+
 struct OutputBuffer {
   Result WriteToFile(string_view filename) const;
 
@@ -172,6 +255,8 @@ class MemoryStream : public Stream {
     return buf_->WriteToFile(filename);
   }
 
+  void Reserve(size_t size) override { buf_->data.reserve(size); }
+
  protected:
   Result WriteDataImpl(size_t offset, const void* data, size_t size) override;
   Result MoveDataImpl(size_t dst_offset,
@@ -182,11 +267,70 @@ class MemoryStream : public Stream {
   std::unique_ptr<OutputBuffer> buf_;
 };
 
+// Output stream backed by a writable mapping of the output file itself: the
+// file is grown with ftruncate and mapped, so written bytes land directly in
+// the page cache and the OS can write them back behind the writer. Unlike
+// staging a module in a MemoryStream and copying it out with WriteToFile,
+// the output is never held twice — for very large modules that halves peak
+// memory. Supports the same random-access writes and moves as MemoryStream
+// (the binary writer patches section sizes in place). On hosts without mmap,
+// or when mapping the file fails, writes fall back to an owned buffer that
+// Finish() copies out, so callers need no platform checks.
+//
+// Call Finish() when done: it truncates the file to the bytes written and
+// closes it. A stream destroyed without Finish() releases its resources but
+// leaves the file at its page-rounded intermediate size.
+class MmapStream : public Stream {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(MmapStream);
+  explicit MmapStream(string_view filename, Stream* log_stream = nullptr);
+  ~MmapStream();
+
+  size_t size() const { return size_; }
+
+  Result Finish();
+
+  void Reserve(size_t size) override;
+
+ protected:
+  Result WriteDataImpl(size_t offset, const void* data, size_t size) override;
+  Result MoveDataImpl(size_t dst_offset,
+                      size_t src_offset,
+                      size_t size) override;
+
+ private:
+  // Grows the file and the mapping until at least |needed| bytes are
+  // addressable. Switches to the fallback buffer if remapping fails.
+  void EnsureCapacity(size_t needed);
+  void SwitchToFallback();
+  void ReleaseMapping();
+
+  std::string filename_;
+  int fd_ = -1;
+  uint8_t* base_ = nullptr;  // non-null when the file is mapped
+  size_t map_size_ = 0;      // mapped (and ftruncated) capacity
+  size_t size_ = 0;          // high-water mark of bytes written
+  bool use_fallback_ = false;
+  OutputBuffer fallback_;
+};
+
 class FileStream : public Stream {
  public:
   WABT_DISALLOW_COPY_AND_ASSIGN(FileStream);
-  explicit FileStream(string_view filename, Stream* log_stream = nullptr);
-  explicit FileStream(FILE*, Stream* log_stream = nullptr);
+
+  static const size_t kDefaultBufferSize = 64 * 1024;
+
+  // Writes are coalesced in an internal buffer of the given size, which is
+  // flushed when it fills, on Flush(), and on destruction. A buffer_size of
+  // 0 writes through to the FILE on every call; streams wrapping an existing
+  // FILE (e.g. stdout) default to that so their output stays ordered with
+  // respect to anything else writing to the same FILE.
+  explicit FileStream(string_view filename,
+                      Stream* log_stream = nullptr,
+                      size_t buffer_size = kDefaultBufferSize);
+  explicit FileStream(FILE*,
+                      Stream* log_stream = nullptr,
+                      size_t buffer_size = 0);
   FileStream(FileStream&&);
   FileStream& operator=(FileStream&&);
   ~FileStream();
@@ -205,9 +349,14 @@ class FileStream : public Stream {
                       size_t size) override;
 
  private:
+  Result FlushBuffer();
+
   FILE* file_;
   size_t offset_;
   bool should_close_;
+  std::unique_ptr<char[]> buffer_;
+  size_t buffer_size_;
+  size_t buffer_used_;
 };
 
 }  // namespace wabt
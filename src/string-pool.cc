@@ -0,0 +1,72 @@
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/string-pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace wabt {
+
+string_view StringPool::Intern(string_view str) {
+  // Keep the load factor at 1/2 or below.
+  if ((views_.size() + 1) * 2 > slots_.size()) {
+    Rehash(std::max(kInitialSlots, slots_.size() * 2));
+  }
+  size_t mask = slots_.size() - 1;
+  size_t slot = std::hash<string_view>()(str) & mask;
+  while (slots_[slot] != 0) {
+    string_view interned = views_[slots_[slot] - 1];
+    if (interned == str) {
+      return interned;
+    }
+    slot = (slot + 1) & mask;
+  }
+  views_.push_back(Copy(str));
+  slots_[slot] = views_.size();
+  return views_.back();
+}
+
+string_view StringPool::Copy(string_view str) {
+  size_t size = str.size();
+  if (chunks_.empty() || chunk_used_ + size > kChunkSize) {
+    chunks_.emplace_back(new char[std::max(kChunkSize, size)]);
+    chunk_used_ = 0;
+  }
+  char* copy = chunks_.back().get() + chunk_used_;
+  memcpy(copy, str.data(), size);
+  chunk_used_ += size;
+  return string_view(copy, size);
+}
+
+void StringPool::InsertSlot(size_t view_index) {
+  size_t mask = slots_.size() - 1;
+  size_t slot = std::hash<string_view>()(views_[view_index]) & mask;
+  while (slots_[slot] != 0) {
+    slot = (slot + 1) & mask;
+  }
+  slots_[slot] = view_index + 1;
+}
+
+void StringPool::Rehash(size_t new_slot_count) {
+  slots_.assign(new_slot_count, 0);
+  for (size_t i = 0; i < views_.size(); ++i) {
+    InsertSlot(i);
+  }
+}
+
+}  // namespace wabt
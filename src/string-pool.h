@@ -0,0 +1,53 @@
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_STRING_POOL_H_
+#define WABT_STRING_POOL_H_
+
+#include <memory>
+#include <vector>
+
+#include "src/string-view.h"
+
+namespace wabt {
+
+// Interns strings into chunked storage. Equal strings share a single copy,
+// and the returned string_views stay valid until the pool is destroyed; the
+// chunks are never resized or reallocated, so growing the pool doesn't
+// invalidate views that were handed out earlier.
+class StringPool {
+ public:
+  string_view Intern(string_view str);
+
+ private:
+  static const size_t kInitialSlots = 16;
+  static const size_t kChunkSize = 4096;
+
+  string_view Copy(string_view str);
+  void InsertSlot(size_t view_index);
+  void Rehash(size_t new_slot_count);
+
+  // All interned strings. Open addressing with linear probing, as in
+  // BindingHash: each slot holds a view index + 1; 0 means empty.
+  std::vector<string_view> views_;
+  std::vector<size_t> slots_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  size_t chunk_used_ = 0;  // Bytes used in the last chunk.
+};
+
+}  // namespace wabt
+
+#endif /* WABT_STRING_POOL_H_ */
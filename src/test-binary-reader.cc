@@ -73,3 +73,162 @@ TEST(BinaryReader, DisabledOpcodes) {
         << "Got error message: " << message;
   }
 }
+
+TEST(BinaryReader, SkipErrorMessages) {
+  ReadBinaryOptions options;
+  options.skip_error_messages = true;
+
+  // Truncated magic number.
+  uint8_t data[] = {0x00, 0x61, 0x73};
+
+  BinaryReaderError reader;
+  Result result = ReadBinary(data, sizeof(data), &reader, options);
+  EXPECT_EQ(Result::Error, result);
+
+  // The error is still reported with its level and location, but no message
+  // text is rendered.
+  EXPECT_EQ(ErrorLevel::Error, reader.first_error.error_level);
+  EXPECT_TRUE(reader.first_error.message.empty());
+}
+
+namespace {
+
+struct BinaryReaderCustomSection : BinaryReaderNop {
+  Result BeginCustomSection(Offset size, string_view section_name) override {
+    name = section_name.to_string();
+    return Result::Ok;
+  }
+
+  std::string name;
+};
+
+}  // End of anonymous namespace
+
+TEST(BinaryReader, SectionDirectory) {
+  ReadBinaryOptions options;
+
+  uint8_t data[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,  // magic + version
+      0x01, 0x04, 0x01, 0x60, 0x00, 0x00,  // type section: 1 type, (func)
+      0x00, 0x0a,                          // custom section, 10 bytes
+      0x08, 'm', 'a', 'n', 'i', 'f', 'e', 's', 't',  // name "manifest"
+      0x2a,                                          // 1 payload byte
+      0x03, 0x02, 0x01, 0x00,  // func section: 1 func, type 0
+      0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b,  // code section: 1 empty func
+  };
+
+  BinaryReaderError reader;
+  std::vector<SectionDirectoryEntry> directory;
+  ASSERT_EQ(Result::Ok, ReadBinarySectionDirectory(data, sizeof(data), &reader,
+                                                   options, &directory));
+
+  ASSERT_EQ(4u, directory.size());
+  EXPECT_EQ(BinarySection::Type, directory[0].section_type);
+  EXPECT_EQ(BinarySection::Custom, directory[1].section_type);
+  EXPECT_EQ("manifest", directory[1].name.to_string());
+  EXPECT_EQ(10u, directory[1].size);
+  EXPECT_EQ(BinarySection::Function, directory[2].section_type);
+  EXPECT_EQ(BinarySection::Code, directory[3].section_type);
+
+  // Decode just the custom section, without touching the others.
+  BinaryReaderCustomSection custom;
+  ASSERT_EQ(Result::Ok, ReadBinarySectionAt(data, sizeof(data), directory[1],
+                                            &custom, options));
+  EXPECT_EQ("manifest", custom.name);
+}
+
+namespace {
+
+// Records the interesting callbacks so a chunked read can be compared
+// against a whole-module read.
+struct BinaryReaderRecord : BinaryReaderNop {
+  bool OnError(const Error&) override { return true; }
+  Result BeginModule(uint32_t version) override {
+    events.push_back("BeginModule");
+    return Result::Ok;
+  }
+  Result BeginSection(Index section_index,
+                      BinarySection section_type,
+                      Offset size) override {
+    events.push_back(std::string("BeginSection ") +
+                     GetSectionName(section_type));
+    return Result::Ok;
+  }
+  Result BeginFunctionBody(Index index, Offset size) override {
+    events.push_back("BeginFunctionBody");
+    return Result::Ok;
+  }
+  Result EndModule() override {
+    events.push_back("EndModule");
+    return Result::Ok;
+  }
+
+  std::vector<std::string> events;
+};
+
+}  // End of anonymous namespace
+
+TEST(BinaryReader, ChunkedMatchesWholeModule) {
+  ReadBinaryOptions options;
+
+  uint8_t data[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,  // magic + version
+      0x01, 0x04, 0x01, 0x60, 0x00, 0x00,  // type section: 1 type, (func)
+      0x03, 0x02, 0x01, 0x00,              // func section: 1 func, type 0
+      0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b,  // code section: 1 empty func
+  };
+
+  BinaryReaderRecord whole;
+  ASSERT_EQ(Result::Ok, ReadBinary(data, sizeof(data), &whole, options));
+
+  // Push the module one byte at a time; every chunk boundary splits either a
+  // section header or a payload.
+  BinaryReaderRecord chunked;
+  ChunkedBinaryReader reader(&chunked, options);
+  for (size_t i = 0; i < sizeof(data); ++i) {
+    ASSERT_EQ(Result::Ok, reader.PushChunk(&data[i], 1));
+  }
+  ASSERT_EQ(Result::Ok, reader.Finish());
+
+  EXPECT_EQ(whole.events, chunked.events);
+}
+
+TEST(BinaryReader, ChunkedDecodesSectionsAsTheyArrive) {
+  ReadBinaryOptions options;
+
+  uint8_t data[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,  // magic + version
+      0x01, 0x04, 0x01, 0x60, 0x00, 0x00,  // type section: 1 type, (func)
+      0x03, 0x02, 0x01, 0x00,              // func section: 1 func, type 0
+      0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b,  // code section: 1 empty func
+  };
+
+  // Everything up to and including the function section, plus the code
+  // section's header; the code payload hasn't arrived yet.
+  BinaryReaderRecord record;
+  ChunkedBinaryReader reader(&record, options);
+  ASSERT_EQ(Result::Ok, reader.PushChunk(data, 20));
+  EXPECT_EQ(3u, record.events.size());  // BeginModule + two sections.
+
+  ASSERT_EQ(Result::Ok, reader.PushChunk(data + 20, sizeof(data) - 20));
+  ASSERT_EQ(Result::Ok, reader.Finish());
+  EXPECT_EQ("EndModule", record.events.back());
+}
+
+TEST(BinaryReader, ChunkedTruncatedModule) {
+  ReadBinaryOptions options;
+
+  uint8_t data[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,  // magic + version
+      0x01, 0x04, 0x01, 0x60,                          // truncated type section
+  };
+
+  BinaryReaderError record;
+  ChunkedBinaryReader reader(&record, options);
+  // The type section never completes, so nothing past the header is decoded
+  // until Finish reports the truncation.
+  ASSERT_EQ(Result::Ok, reader.PushChunk(data, sizeof(data)));
+  EXPECT_EQ(Result::Error, reader.Finish());
+  EXPECT_EQ(0u, record.first_error.message.find("invalid section size"))
+      << "Got error message: " << record.first_error.message;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "src/binary-transform.h"
+#include "src/stream.h"
+
+using namespace wabt;
+
+namespace {
+
+const uint8_t kModule[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,  // magic + version
+    0x01, 0x04, 0x01, 0x60, 0x00, 0x00,  // type section: 1 type, (func)
+    0x00, 0x0a,                          // custom section, 10 bytes
+    0x08, 'm', 'a', 'n', 'i', 'f', 'e', 's', 't',  // name "manifest"
+    0x2a,                                          // 1 payload byte
+    0x03, 0x02, 0x01, 0x00,  // func section: 1 func, type 0
+    0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b,  // code section: 1 empty func
+};
+
+struct ManifestRewriter : BinaryTransformDelegate {
+  SectionAction OnSection(const SectionDirectoryEntry& entry) override {
+    sections_seen++;
+    if (entry.section_type == BinarySection::Custom &&
+        entry.name == "manifest") {
+      return SectionAction::Replace;
+    }
+    return SectionAction::Passthrough;
+  }
+
+  Result WriteReplacement(const SectionDirectoryEntry& entry,
+                          const void* payload,
+                          Stream* stream) override {
+    // The old payload starts with the section name.
+    EXPECT_EQ(0x08, static_cast<const uint8_t*>(payload)[0]);
+    const uint8_t new_payload[] = {0x08, 'm', 'a', 'n', 'i', 'f',
+                                   'e',  's', 't', 0x17, 0x2b};
+    stream->WriteData(new_payload, sizeof(new_payload));
+    return Result::Ok;
+  }
+
+  int sections_seen = 0;
+};
+
+struct SectionDropper : BinaryTransformDelegate {
+  SectionAction OnSection(const SectionDirectoryEntry& entry) override {
+    return entry.section_type == BinarySection::Custom
+               ? SectionAction::Remove
+               : SectionAction::Passthrough;
+  }
+
+  Result AppendSections(Stream* stream) override {
+    const uint8_t trailer[] = {0x00, 0x05, 0x03, 'n', 'e', 'w', 0x2c};
+    stream->WriteData(trailer, sizeof(trailer));
+    return Result::Ok;
+  }
+};
+
+}  // End of anonymous namespace
+
+TEST(BinaryTransform, ReplaceSection) {
+  ManifestRewriter rewriter;
+  MemoryStream stream;
+  ReadBinaryOptions options;
+  ASSERT_EQ(Result::Ok, TransformBinary(kModule, sizeof(kModule), &rewriter,
+                                        options, &stream));
+  EXPECT_EQ(4, rewriter.sections_seen);
+
+  // One byte longer than the input: the custom section payload grew from
+  // 10 to 11 bytes and everything else passed through verbatim.
+  const std::vector<uint8_t>& out = stream.output_buffer().data;
+  ASSERT_EQ(sizeof(kModule) + 1, out.size());
+  EXPECT_EQ(0, memcmp(out.data(), kModule, 14));  // header + type section
+  EXPECT_EQ(0x0b, out[15]);                       // new custom section size
+  EXPECT_EQ(0x17, out[25]);                       // new payload bytes
+  EXPECT_EQ(0x2b, out[26]);
+  // Function and code sections passed through after the replacement.
+  EXPECT_EQ(0, memcmp(out.data() + 27, kModule + 26, 10));
+}
+
+TEST(BinaryTransform, RemoveAndAppend) {
+  SectionDropper dropper;
+  MemoryStream stream;
+  ReadBinaryOptions options;
+  ASSERT_EQ(Result::Ok, TransformBinary(kModule, sizeof(kModule), &dropper,
+                                        options, &stream));
+
+  const std::vector<uint8_t>& out = stream.output_buffer().data;
+  // Input minus the 12-byte custom section, plus the 7-byte trailer.
+  ASSERT_EQ(sizeof(kModule) - 12 + 7, out.size());
+  EXPECT_EQ(0, memcmp(out.data(), kModule, 14));  // header + type section
+  EXPECT_EQ(0x03, out[14]);                       // func section follows
+  EXPECT_EQ('w', out[out.size() - 2]);            // appended trailer
+  EXPECT_EQ(0x2c, out[out.size() - 1]);
+}
+
+TEST(BinaryTransform, BadModule) {
+  SectionDropper dropper;
+  MemoryStream stream;
+  ReadBinaryOptions options;
+  const uint8_t garbage[] = {0x01, 0x02, 0x03, 0x04};
+  ASSERT_EQ(Result::Error, TransformBinary(garbage, sizeof(garbage), &dropper,
+                                           options, &stream));
+  EXPECT_EQ(0u, stream.output_buffer().size());
+}
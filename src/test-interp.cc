@@ -25,6 +25,7 @@
 #include "src/binary-reader.h"
 #include "src/cast.h"
 #include "src/interp/binary-reader-interp.h"
+#include "src/interp/interp-image-cache.h"
 #include "src/interp/interp.h"
 #include "src/make-unique.h"
 
@@ -282,3 +283,353 @@ TEST_F(HostMemoryTest, Rot13) {
 
   ASSERT_EQ("Hello, WebAssembly!", string_data);
 }
+
+namespace {
+
+class SuspendableTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    env_ = MakeUnique<interp::Environment>(s_features);
+    executor_ = MakeUnique<interp::Executor>(env_.get());
+  }
+
+  Result LoadModule(const std::vector<uint8_t>& data) {
+    Errors errors;
+    ReadBinaryOptions options;
+    return ReadBinaryInterp(env_.get(), data.data(), data.size(), options,
+                            &errors, &module_);
+  }
+
+  std::unique_ptr<interp::Environment> env_;
+  interp::DefinedModule* module_ = nullptr;
+  std::unique_ptr<interp::Executor> executor_;
+};
+
+}  // end of anonymous namespace
+
+TEST_F(SuspendableTest, ResumeWithFuel) {
+  // (func (export "busy") (result i32)
+  //   (local $i i32)
+  //   (block $exit
+  //     (loop $top
+  //       (br_if $exit (i32.eq (local.get $i) (i32.const 1000)))
+  //       (local.set $i (i32.add (local.get $i) (i32.const 1)))
+  //       (br $top)))
+  //   (local.get $i))
+  std::vector<uint8_t> data = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60,
+      0x00, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x08, 0x01, 0x04, 0x62,
+      0x75, 0x73, 0x79, 0x00, 0x00, 0x0a, 0x1f, 0x01, 0x1d, 0x01, 0x01, 0x7f,
+      0x02, 0x40, 0x03, 0x40, 0x20, 0x00, 0x41, 0xe8, 0x07, 0x46, 0x0d, 0x01,
+      0x20, 0x00, 0x41, 0x01, 0x6a, 0x21, 0x00, 0x0c, 0x00, 0x0b, 0x0b, 0x20,
+      0x00, 0x0b,
+  };
+
+  ASSERT_EQ(Result::Ok, LoadModule(data));
+
+  bool completed = false;
+  interp::ExecResult exec_result;
+  ASSERT_EQ(interp::ResultType::Ok,
+            executor_
+                ->BeginFunction(module_->GetExport("busy")->index, {},
+                                [&](interp::ExecResult result) {
+                                  completed = true;
+                                  exec_result = std::move(result);
+                                })
+                .type);
+  ASSERT_TRUE(executor_->IsRunning());
+
+  // The loop needs thousands of instructions, so a small fuel quantum must
+  // suspend at least once before the completion callback fires.
+  int resumptions = 0;
+  while (executor_->Resume(100)) {
+    ++resumptions;
+    ASSERT_FALSE(completed);
+  }
+
+  ASSERT_GT(resumptions, 0);
+  ASSERT_TRUE(completed);
+  ASSERT_FALSE(executor_->IsRunning());
+  ASSERT_TRUE(exec_result.ok());
+  ASSERT_EQ(1u, exec_result.values.size());
+  ASSERT_EQ(1000u, exec_result.values[0].get_i32());
+}
+
+TEST_F(SuspendableTest, ResolveExportHandle) {
+  // Same module as ResumeWithFuel; see the comment there.
+  std::vector<uint8_t> data = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60,
+      0x00, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x08, 0x01, 0x04, 0x62,
+      0x75, 0x73, 0x79, 0x00, 0x00, 0x0a, 0x1f, 0x01, 0x1d, 0x01, 0x01, 0x7f,
+      0x02, 0x40, 0x03, 0x40, 0x20, 0x00, 0x41, 0xe8, 0x07, 0x46, 0x0d, 0x01,
+      0x20, 0x00, 0x41, 0x01, 0x6a, 0x21, 0x00, 0x0c, 0x00, 0x0b, 0x0b, 0x20,
+      0x00, 0x0b,
+  };
+
+  ASSERT_EQ(Result::Ok, LoadModule(data));
+
+  interp::ExportHandle handle =
+      env_->ResolveExport(env_->GetLastModuleIndex(), "busy");
+  ASSERT_TRUE(handle.ok());
+  ASSERT_FALSE(env_->ResolveExport(env_->GetLastModuleIndex(), "nope").ok());
+
+  // The handle can be used for repeated calls without re-hashing the name.
+  for (int i = 0; i < 2; ++i) {
+    interp::ExecResult exec_result = executor_->RunExport(handle, {});
+    ASSERT_TRUE(exec_result.ok());
+    ASSERT_EQ(1u, exec_result.values.size());
+    ASSERT_EQ(1000u, exec_result.values[0].get_i32());
+  }
+}
+
+TEST(HostCallTest, RawCallback) {
+  // (import "host" "add" (func $add (param i32 i32) (result i32)))
+  // (func (export "run") (result i32)
+  //   (call $add (i32.const 30) (i32.const 12)))
+  std::vector<uint8_t> data = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0b, 0x02, 0x60,
+      0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x02, 0x0c, 0x01,
+      0x04, 0x68, 0x6f, 0x73, 0x74, 0x03, 0x61, 0x64, 0x64, 0x00, 0x00, 0x03,
+      0x02, 0x01, 0x01, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x01,
+      0x0a, 0x0a, 0x01, 0x08, 0x00, 0x41, 0x1e, 0x41, 0x0c, 0x10, 0x00, 0x0b,
+  };
+
+  interp::Environment env(s_features);
+  interp::HostModule* host_module = env.AppendHostModule("host");
+  host_module->AppendFuncExport(
+      "add", {{Type::I32, Type::I32}, {Type::I32}},
+      [](const interp::HostFunc*, const interp::FuncSignature*,
+         interp::Value* args_and_results) -> interp::Result {
+        // Arguments are read from, and the result written over, the
+        // caller's stack slots in place.
+        args_and_results[0].i32 = args_and_results[0].i32 +
+                                  args_and_results[1].i32;
+        return interp::ResultType::Ok;
+      });
+
+  Errors errors;
+  interp::DefinedModule* module = nullptr;
+  ReadBinaryOptions options;
+  ASSERT_EQ(Result::Ok, ReadBinaryInterp(&env, data.data(), data.size(),
+                                         options, &errors, &module));
+  interp::Executor executor(&env);
+  interp::ExecResult exec_result = executor.RunExportByName(module, "run", {});
+  ASSERT_TRUE(exec_result.ok());
+  ASSERT_EQ(1u, exec_result.values.size());
+  ASSERT_EQ(42u, exec_result.values[0].get_i32());
+}
+
+TEST(HostCallTest, BatchCallback) {
+  // (import "host" "log" (func $log (param i32)))
+  // (func (export "run")
+  //   (call $log (i32.const 1)) (call $log (i32.const 2))
+  //   (call $log (i32.const 3)) (call $log (i32.const 4)))
+  std::vector<uint8_t> data = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x02, 0x60,
+      0x01, 0x7f, 0x00, 0x60, 0x00, 0x00, 0x02, 0x0c, 0x01, 0x04, 0x68, 0x6f,
+      0x73, 0x74, 0x03, 0x6c, 0x6f, 0x67, 0x00, 0x00, 0x03, 0x02, 0x01, 0x01,
+      0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x01, 0x0a, 0x14, 0x01,
+      0x12, 0x00, 0x41, 0x01, 0x10, 0x00, 0x41, 0x02, 0x10, 0x00, 0x41, 0x03,
+      0x10, 0x00, 0x41, 0x04, 0x10, 0x00, 0x0b,
+  };
+
+  std::vector<uint32_t> logged;
+  int num_deliveries = 0;
+
+  interp::Environment env(s_features);
+  interp::HostModule* host_module = env.AppendHostModule("host");
+  host_module->AppendFuncExport(
+      "log", {{Type::I32}, {}},
+      [&](const interp::HostFunc*, const interp::FuncSignature*,
+          const interp::Value* args, Index num_calls) -> interp::Result {
+        ++num_deliveries;
+        for (Index i = 0; i < num_calls; ++i) {
+          logged.push_back(args[i].i32);
+        }
+        return interp::ResultType::Ok;
+      },
+      3);
+
+  Errors errors;
+  interp::DefinedModule* module = nullptr;
+  ReadBinaryOptions options;
+  ASSERT_EQ(Result::Ok, ReadBinaryInterp(&env, data.data(), data.size(),
+                                         options, &errors, &module));
+  interp::Executor executor(&env);
+  ASSERT_TRUE(executor.RunExportByName(module, "run", {}).ok());
+
+  // The first three calls filled a batch; the fourth is still queued.
+  ASSERT_EQ(1, num_deliveries);
+  ASSERT_EQ(std::vector<uint32_t>({1, 2, 3}), logged);
+
+  ASSERT_TRUE(env.FlushHostCallBatches().ok());
+  ASSERT_EQ(2, num_deliveries);
+  ASSERT_EQ(std::vector<uint32_t>({1, 2, 3, 4}), logged);
+
+  // Flushing empty queues is a no-op.
+  ASSERT_TRUE(env.FlushHostCallBatches().ok());
+  ASSERT_EQ(2, num_deliveries);
+}
+
+TEST(HostRefTest, ReclaimsAndReusesSlots) {
+  interp::Environment env(s_features);
+  interp::Table* table = env.EmplaceBackTable(Type::Anyref, Limits(2));
+
+  interp::Ref a = env.NewHostRef();
+  interp::Ref b = env.NewHostRef();
+  interp::Ref c = env.NewHostRef();
+  ASSERT_EQ(3u, env.GetHostCount());
+
+  // |a| is reachable from a table, |b| is stamped by the host, |c| is
+  // dropped; after an epoch passes only |c| is reclaimed.
+  table->entries[0] = a;
+  env.AdvanceHostRefEpoch();
+  env.KeepHostRefAlive(b);
+  ASSERT_EQ(1u, env.ReclaimHostRefs(env.host_ref_epoch()));
+
+  // The freed slot is reused instead of growing the table.
+  interp::Ref d = env.NewHostRef();
+  ASSERT_EQ(c.index, d.index);
+  ASSERT_EQ(3u, env.GetHostCount());
+
+  // Reclaiming again frees nothing: |a| is re-stamped from the table and
+  // |b| and |d| carry the current epoch.
+  ASSERT_EQ(0u, env.ReclaimHostRefs(env.host_ref_epoch()));
+
+  // Once the table entry is cleared and the host stops stamping, another
+  // epoch reclaims everything.
+  table->entries[0] = {interp::RefType::Null, kInvalidIndex};
+  env.AdvanceHostRefEpoch();
+  ASSERT_EQ(3u, env.ReclaimHostRefs(env.host_ref_epoch()));
+}
+
+TEST(EnvironmentSnapshotTest, RestoresMemoryTablesAndGlobals) {
+  interp::Environment env(s_features);
+  interp::Memory* memory = env.EmplaceBackMemory(Limits(1));
+  interp::Table* table = env.EmplaceBackTable(Type::Funcref, Limits(2));
+  Type i32 = Type::I32;
+  interp::Global* global = env.EmplaceBackGlobal(i32, true);
+  global->typed_value.value.i32 = 1;
+  memory->data_begin()[0] = 10;
+
+  interp::Environment::Snapshot snapshot = env.TakeSnapshot();
+
+  memory->data_begin()[0] = 20;
+  table->entries[0] = {interp::RefType::Func, 0};
+  global->typed_value.value.i32 = 2;
+
+  env.RestoreSnapshot(snapshot);
+
+  EXPECT_EQ(10, memory->data_begin()[0]);
+  EXPECT_EQ(interp::RefType::Null, table->entries[0].kind);
+  EXPECT_EQ(1u, global->typed_value.value.i32);
+
+  // A snapshot can be restored more than once.
+  memory->data_begin()[0] = 30;
+  env.RestoreSnapshot(snapshot);
+  EXPECT_EQ(10, memory->data_begin()[0]);
+}
+
+TEST(EnvironmentSnapshotTest, RestoresGuardedMemoryAndGrowth) {
+  interp::Environment env(s_features);
+  env.set_use_guard_pages(true);
+  interp::Memory* memory = env.EmplaceBackMemory(Limits(1, 4), true);
+  memory->data_begin()[100] = 42;
+
+  interp::Environment::Snapshot snapshot = env.TakeSnapshot();
+
+  memory->data_begin()[100] = 43;
+  ASSERT_TRUE(memory->Resize(2 * WABT_PAGE_SIZE));
+  memory->data_begin()[WABT_PAGE_SIZE] = 1;
+
+  env.RestoreSnapshot(snapshot);
+
+  EXPECT_EQ(1u * WABT_PAGE_SIZE, memory->data_size());
+  EXPECT_EQ(42, memory->data_begin()[100]);
+}
+
+TEST(ModuleImageCacheTest, SharesByteIdenticalBinaries) {
+  // Same module as SuspendableTest::ResumeWithFuel; exports "busy", which
+  // counts a local up to 1000 and returns it.
+  std::vector<uint8_t> data = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60,
+      0x00, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x08, 0x01, 0x04, 0x62,
+      0x75, 0x73, 0x79, 0x00, 0x00, 0x0a, 0x1f, 0x01, 0x1d, 0x01, 0x01, 0x7f,
+      0x02, 0x40, 0x03, 0x40, 0x20, 0x00, 0x41, 0xe8, 0x07, 0x46, 0x0d, 0x01,
+      0x20, 0x00, 0x41, 0x01, 0x6a, 0x21, 0x00, 0x0c, 0x00, 0x0b, 0x0b, 0x20,
+      0x00, 0x0b,
+  };
+
+  interp::ModuleImageCache cache(s_features);
+  ReadBinaryOptions options;
+  Errors errors;
+
+  std::unique_ptr<interp::Environment> first =
+      cache.Instantiate(data.data(), data.size(), options, &errors);
+  ASSERT_TRUE(first != nullptr);
+  std::unique_ptr<interp::Environment> second =
+      cache.Instantiate(data.data(), data.size(), options, &errors);
+  ASSERT_TRUE(second != nullptr);
+  // Byte-identical binaries share one image.
+  EXPECT_EQ(1u, cache.size());
+
+  for (interp::Environment* env : {first.get(), second.get()}) {
+    auto* module = cast<interp::DefinedModule>(env->GetLastModule());
+    interp::Executor executor(env);
+    ASSERT_TRUE(executor.Initialize(module).ok());
+    interp::ExecResult exec_result =
+        executor.RunExportByName(module, "busy", {});
+    ASSERT_TRUE(exec_result.ok());
+    ASSERT_EQ(1000u, exec_result.values[0].get_i32());
+  }
+
+  // A binary with different bytes gets its own image.
+  std::vector<uint8_t> other = data;
+  other[44] = 0x03;  // i32.const 1000 -> i32.const 488
+  ASSERT_TRUE(cache.Instantiate(other.data(), other.size(), options,
+                                &errors) != nullptr);
+  EXPECT_EQ(2u, cache.size());
+}
+
+TEST(TypedThunkTest, CallAndSignatureChecks) {
+  // (func (export "add") (param i32 i32) (result i32)
+  //   (i32.add (local.get 0) (local.get 1)))
+  std::vector<uint8_t> data = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01,
+      0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07,
+      0x07, 0x01, 0x03, 0x61, 0x64, 0x64, 0x00, 0x00, 0x0a, 0x09, 0x01,
+      0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x6a, 0x0b,
+  };
+
+  interp::Environment env(s_features);
+  Errors errors;
+  interp::DefinedModule* module = nullptr;
+  ReadBinaryOptions options;
+  ASSERT_EQ(Result::Ok, ReadBinaryInterp(&env, data.data(), data.size(),
+                                         options, &errors, &module));
+  interp::Executor executor(&env);
+  ASSERT_TRUE(executor.Initialize(module).ok());
+
+  interp::TypedThunk<int32_t(int32_t, int32_t)> add;
+  ASSERT_FALSE(add.is_bound());
+  ASSERT_TRUE(executor.MakeTypedThunk(module, "add", &add).ok());
+  ASSERT_TRUE(add.is_bound());
+
+  int32_t result = 0;
+  ASSERT_TRUE(add.Call(&result, 30, 12).ok());
+  EXPECT_EQ(42, result);
+  // A bound thunk is reusable.
+  ASSERT_TRUE(add.Call(&result, -1, 2).ok());
+  EXPECT_EQ(1, result);
+
+  // Mismatched arity, result type, and unknown exports fail at bind time.
+  interp::TypedThunk<int32_t(int32_t)> bad_arity;
+  EXPECT_EQ(interp::ResultType::ArgumentTypeMismatch,
+            executor.MakeTypedThunk(module, "add", &bad_arity).type);
+  interp::TypedThunk<double(int32_t, int32_t)> bad_result;
+  EXPECT_EQ(interp::ResultType::ArgumentTypeMismatch,
+            executor.MakeTypedThunk(module, "add", &bad_result).type);
+  interp::TypedThunk<void()> unknown;
+  EXPECT_EQ(interp::ResultType::UnknownExport,
+            executor.MakeTypedThunk(module, "nope", &unknown).type);
+}
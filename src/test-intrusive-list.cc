@@ -561,6 +561,43 @@ TEST_F(IntrusiveListTest, splice_node) {
   AssertListEq(list4, {});
 }
 
+TEST_F(IntrusiveListTest, splice_range_counted) {
+  TestObjectList list1 = NewList({1, 2, 3});
+
+  // Splice at beginning.
+  TestObjectList list2 = NewList({100, 200, 300});
+  list1.splice(list1.begin(), list2, list2.begin(), std::prev(list2.end()), 2);
+  AssertListEq(list1, {100, 200, 1, 2, 3});
+  AssertListEq(list2, {300});
+
+  // Splice at end.
+  TestObjectList list3 = NewList({500, 600, 700});
+  list1.splice(list1.end(), list3, std::next(list3.begin()), list3.end(), 2);
+  AssertListEq(list1, {100, 200, 1, 2, 3, 600, 700});
+  AssertListEq(list3, {500});
+
+  // Splice an empty range.
+  list1.splice(list1.begin(), list3, list3.begin(), list3.begin(), 0);
+  AssertListEq(list1, {100, 200, 1, 2, 3, 600, 700});
+  AssertListEq(list3, {500});
+}
+
+TEST_F(IntrusiveListTest, extract_list) {
+  TestObjectList list1 = NewList({1, 2, 3, 4, 5});
+
+  // Extract from the middle.
+  TestObjectList list2 =
+      list1.extract_list(std::next(list1.begin()), std::prev(list1.end()));
+  AssertListEq(list1, {1, 5});
+  AssertListEq(list2, {2, 3, 4});
+
+  // Extract everything, with an explicit count.
+  TestObjectList list3 =
+      list1.extract_list(list1.begin(), list1.end(), list1.size());
+  AssertListEq(list1, {});
+  AssertListEq(list3, {1, 5});
+}
+
 TEST_F(IntrusiveListTest, splice_range) {
   TestObjectList list1 = NewList({1, 2, 3});
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+#include "src/leb128.h"
+#include "src/stream.h"
+
+using namespace wabt;
+
+namespace {
+
+// The word-at-a-time fast path needs 8 readable bytes, so check every value
+// both with plenty of buffer after it and with the buffer ending right at the
+// value's last byte (which uses the byte-by-byte path).
+void assert_reads_u32(uint32_t value, size_t expected_length) {
+  MemoryStream stream;
+  WriteU32Leb128(&stream, value, "u32");
+  const OutputBuffer& buffer = stream.output_buffer();
+  ASSERT_EQ(expected_length, buffer.size());
+
+  std::vector<uint8_t> padded(buffer.data);
+  padded.resize(buffer.size() + 8);
+
+  uint32_t out;
+  ASSERT_EQ(expected_length,
+            ReadU32Leb128(padded.data(), padded.data() + padded.size(), &out));
+  ASSERT_EQ(value, out);
+  ASSERT_EQ(expected_length,
+            ReadU32Leb128(padded.data(), padded.data() + expected_length,
+                          &out));
+  ASSERT_EQ(value, out);
+}
+
+void assert_reads_s32(int32_t value, size_t expected_length) {
+  MemoryStream stream;
+  WriteS32Leb128(&stream, value, "s32");
+  const OutputBuffer& buffer = stream.output_buffer();
+  ASSERT_EQ(expected_length, buffer.size());
+
+  std::vector<uint8_t> padded(buffer.data);
+  padded.resize(buffer.size() + 8);
+
+  uint32_t out;
+  ASSERT_EQ(expected_length,
+            ReadS32Leb128(padded.data(), padded.data() + padded.size(), &out));
+  ASSERT_EQ(value, static_cast<int32_t>(out));
+  ASSERT_EQ(expected_length,
+            ReadS32Leb128(padded.data(), padded.data() + expected_length,
+                          &out));
+  ASSERT_EQ(value, static_cast<int32_t>(out));
+}
+
+void assert_read_u32_fails(const std::vector<uint8_t>& bytes) {
+  std::vector<uint8_t> padded(bytes);
+  padded.resize(bytes.size() + 8);
+  uint32_t out;
+  ASSERT_EQ(0u, ReadU32Leb128(padded.data(), padded.data() + padded.size(),
+                              &out));
+  ASSERT_EQ(0u,
+            ReadU32Leb128(padded.data(), padded.data() + bytes.size(), &out));
+}
+
+void assert_read_s32_fails(const std::vector<uint8_t>& bytes) {
+  std::vector<uint8_t> padded(bytes);
+  padded.resize(bytes.size() + 8);
+  uint32_t out;
+  ASSERT_EQ(0u, ReadS32Leb128(padded.data(), padded.data() + padded.size(),
+                              &out));
+  ASSERT_EQ(0u,
+            ReadS32Leb128(padded.data(), padded.data() + bytes.size(), &out));
+}
+
+}  // end anonymous namespace
+
+TEST(ReadU32Leb128, RoundTrip) {
+  assert_reads_u32(0, 1);
+  assert_reads_u32(1, 1);
+  assert_reads_u32(0x7f, 1);
+  assert_reads_u32(0x80, 2);
+  assert_reads_u32(0x3fff, 2);
+  assert_reads_u32(0x4000, 3);
+  assert_reads_u32(0x1fffff, 3);
+  assert_reads_u32(0x200000, 4);
+  assert_reads_u32(0xfffffff, 4);
+  assert_reads_u32(0x10000000, 5);
+  assert_reads_u32(0xffffffff, 5);
+}
+
+TEST(ReadU32Leb128, Overlong) {
+  // Overlong encodings are allowed, as long as the value fits.
+  uint32_t out;
+  std::vector<uint8_t> bytes = {0x80, 0x80, 0x80, 0x80, 0x00, 0, 0, 0};
+  ASSERT_EQ(5u, ReadU32Leb128(bytes.data(), bytes.data() + bytes.size(),
+                              &out));
+  ASSERT_EQ(0u, out);
+}
+
+TEST(ReadU32Leb128, Errors) {
+  // Bits above 32 set in the last byte.
+  assert_read_u32_fails({0xff, 0xff, 0xff, 0xff, 0x1f});
+  // Unterminated after 5 bytes.
+  assert_read_u32_fails({0xff, 0xff, 0xff, 0xff, 0xff, 0x00});
+  // No terminator at all.
+  assert_read_u32_fails({0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+}
+
+TEST(ReadS32Leb128, RoundTrip) {
+  assert_reads_s32(0, 1);
+  assert_reads_s32(1, 1);
+  assert_reads_s32(63, 1);
+  assert_reads_s32(-64, 1);
+  assert_reads_s32(64, 2);
+  assert_reads_s32(-65, 2);
+  assert_reads_s32(8191, 2);
+  assert_reads_s32(-8192, 2);
+  assert_reads_s32(0xfffff, 3);
+  assert_reads_s32(-0x100000, 3);
+  assert_reads_s32(0x7ffffff, 4);
+  assert_reads_s32(-0x8000000, 4);
+  assert_reads_s32(0x7fffffff, 5);
+  assert_reads_s32(-0x7fffffff - 1, 5);
+}
+
+TEST(ReadS32Leb128, Errors) {
+  // Last byte's padding bits must be a sign-extension of the sign bit.
+  assert_read_s32_fails({0xff, 0xff, 0xff, 0xff, 0x1f});
+  assert_read_s32_fails({0x80, 0x80, 0x80, 0x80, 0x70});
+  // Unterminated after 5 bytes.
+  assert_read_s32_fails({0xff, 0xff, 0xff, 0xff, 0xff, 0x00});
+  assert_read_s32_fails({0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+}
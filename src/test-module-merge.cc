@@ -0,0 +1,103 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include "src/cast.h"
+#include "src/ir.h"
+#include "src/module-merge.h"
+#include "src/wast-lexer.h"
+#include "src/wast-parser.h"
+
+using namespace wabt;
+
+namespace {
+
+std::unique_ptr<Module> ParseModule(std::string text) {
+  auto lexer = WastLexer::CreateBufferLexer("test", text.c_str(), text.size());
+  Errors errors;
+  std::unique_ptr<Module> module;
+  Features features;
+  WastParseOptions options(features);
+  Result result = ParseWatModule(lexer.get(), &module, &errors, &options);
+  EXPECT_EQ(Result::Ok, result);
+  return module;
+}
+
+}  // end of anonymous namespace
+
+TEST(ModuleMerge, AppendsAndRemapsIndexes) {
+  auto module = ParseModule(
+      "(module"
+      "  (import \"env\" \"f\" (func $imp (param i32)))"
+      "  (global $g i32 (i32.const 1))"
+      "  (func $a (call $imp (global.get $g))))");
+  auto other = ParseModule(
+      "(module"
+      "  (import \"env\" \"g\" (global $gimp i32))"
+      "  (global $g i32 (i32.const 2))"
+      "  (func $b (drop (global.get $gimp)) (drop (global.get $g)))"
+      "  (export \"b\" (func $b)))");
+
+  ASSERT_EQ(Result::Ok, MergeModules(module.get(), other.get()));
+
+  // Index spaces: [module imports, other imports, module defs, other defs].
+  ASSERT_EQ(3u, module->funcs.size());
+  ASSERT_EQ(1u, module->num_func_imports);
+  ASSERT_EQ(3u, module->globals.size());
+  ASSERT_EQ(1u, module->num_global_imports);
+
+  // $a's global.get now refers to $g at its shifted index.
+  const Func* func_a = module->funcs[1];
+  const Var& a_global = cast<GlobalGetExpr>(&func_a->exprs.front())->var;
+  ASSERT_TRUE(a_global.is_index());
+  ASSERT_EQ(1u, a_global.index());
+
+  // The export was carried over and follows $b to its new index.
+  const Export* export_b = module->GetExport("b");
+  ASSERT_TRUE(export_b);
+  ASSERT_TRUE(export_b->var.is_index());
+  ASSERT_EQ(2u, module->GetFuncIndex(export_b->var));
+
+  // |other| is consumed.
+  ASSERT_EQ(0u, other->funcs.size());
+  ASSERT_TRUE(other->fields.empty());
+}
+
+TEST(ModuleMerge, SharesFuncTypesAndDropsDuplicateNames) {
+  auto module = ParseModule(
+      "(module"
+      "  (type $t (func (param i32) (result i32)))"
+      "  (func $f (type $t) (local.get 0)))");
+  auto other = ParseModule(
+      "(module"
+      "  (type $same (func (param i32) (result i32)))"
+      "  (type $new (func (param f64)))"
+      "  (func $f (type $same) (local.get 0)))");
+
+  ASSERT_EQ(Result::Ok, MergeModules(module.get(), other.get()));
+
+  // $same has the same signature as $t, so only $new was appended.
+  ASSERT_EQ(2u, module->func_types.size());
+  const Func* other_f = module->funcs[1];
+  ASSERT_EQ(0u, module->GetFuncTypeIndex(other_f->decl.type_var));
+
+  // The second $f loses its name instead of shadowing the first.
+  ASSERT_TRUE(other_f->name.empty());
+  ASSERT_EQ(0u, module->GetFuncIndex(Var("$f")));
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <utility>
+
+#include "src/small-vector.h"
+
+using namespace wabt;
+
+namespace {
+
+typedef SmallVector<int, 4> IntVector;
+
+// std::string exercises non-trivial construction/destruction and move.
+typedef SmallVector<std::string, 2> StringVector;
+
+}  // end of anonymous namespace
+
+TEST(SmallVectorTest, DefaultEmpty) {
+  IntVector v;
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(0u, v.size());
+  EXPECT_EQ(4u, v.capacity());
+  EXPECT_EQ(v.begin(), v.end());
+}
+
+TEST(SmallVectorTest, PushBackWithinInlineCapacity) {
+  IntVector v;
+  const int* inline_data = v.data();
+  for (int i = 0; i < 4; ++i) {
+    v.push_back(i * 10);
+  }
+  EXPECT_EQ(4u, v.size());
+  // No growth, so no reallocation.
+  EXPECT_EQ(inline_data, v.data());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(i * 10, v[i]);
+  }
+}
+
+TEST(SmallVectorTest, GrowsPastInlineCapacity) {
+  IntVector v;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_EQ(100u, v.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, v[i]);
+  }
+}
+
+TEST(SmallVectorTest, InitializerList) {
+  IntVector v = {1, 2, 3};
+  EXPECT_EQ(3u, v.size());
+  EXPECT_EQ(1, v.front());
+  EXPECT_EQ(3, v.back());
+}
+
+TEST(SmallVectorTest, RangeConstructor) {
+  const int data[] = {5, 6, 7, 8, 9, 10};
+  IntVector v(data, data + 6);
+  EXPECT_EQ(6u, v.size());
+  EXPECT_EQ(5, v[0]);
+  EXPECT_EQ(10, v[5]);
+}
+
+TEST(SmallVectorTest, CountConstructor) {
+  IntVector v(10);
+  EXPECT_EQ(10u, v.size());
+  for (size_t i = 0; i < v.size(); ++i) {
+    EXPECT_EQ(0, v[i]);
+  }
+}
+
+TEST(SmallVectorTest, CopyInlineAndHeap) {
+  IntVector small = {1, 2};
+  IntVector small_copy(small);
+  EXPECT_EQ(small, small_copy);
+  // The copy must own its own storage.
+  EXPECT_NE(small.data(), small_copy.data());
+
+  IntVector big = {1, 2, 3, 4, 5, 6, 7, 8};
+  IntVector big_copy(big);
+  EXPECT_EQ(big, big_copy);
+  EXPECT_NE(big.data(), big_copy.data());
+}
+
+TEST(SmallVectorTest, MoveStealsHeapBuffer) {
+  IntVector v = {1, 2, 3, 4, 5, 6, 7, 8};
+  const int* heap_data = v.data();
+  IntVector moved(std::move(v));
+  EXPECT_EQ(heap_data, moved.data());
+  EXPECT_EQ(8u, moved.size());
+  EXPECT_TRUE(v.empty());
+}
+
+TEST(SmallVectorTest, MoveInlineElements) {
+  StringVector v;
+  v.push_back("hello");
+  StringVector moved(std::move(v));
+  EXPECT_EQ(1u, moved.size());
+  EXPECT_EQ("hello", moved[0]);
+  EXPECT_TRUE(v.empty());
+}
+
+TEST(SmallVectorTest, CopyAssignment) {
+  IntVector a = {1, 2, 3, 4, 5};
+  IntVector b;
+  b = a;
+  EXPECT_EQ(a, b);
+  b = IntVector{9};
+  EXPECT_EQ(1u, b.size());
+  EXPECT_EQ(9, b[0]);
+}
+
+TEST(SmallVectorTest, Comparisons) {
+  IntVector a = {1, 2, 3};
+  IntVector b = {1, 2, 3};
+  IntVector c = {1, 2, 4};
+  IntVector d = {1, 2};
+  EXPECT_TRUE(a == b);
+  EXPECT_TRUE(a != c);
+  EXPECT_TRUE(a < c);
+  EXPECT_TRUE(d < a);
+  EXPECT_FALSE(a < b);
+}
+
+TEST(SmallVectorTest, Resize) {
+  IntVector v = {1, 2, 3};
+  v.resize(6);
+  EXPECT_EQ(6u, v.size());
+  EXPECT_EQ(3, v[2]);
+  EXPECT_EQ(0, v[5]);
+  v.resize(2);
+  EXPECT_EQ(2u, v.size());
+  EXPECT_EQ(2, v.back());
+  v.resize(4, 7);
+  EXPECT_EQ(7, v[2]);
+  EXPECT_EQ(7, v[3]);
+}
+
+TEST(SmallVectorTest, Assign) {
+  IntVector v = {1, 2, 3, 4, 5, 6};
+  v.assign(3, 42);
+  EXPECT_EQ(3u, v.size());
+  EXPECT_EQ(42, v[0]);
+  EXPECT_EQ(42, v[2]);
+
+  const int data[] = {8, 9};
+  v.assign(data, data + 2);
+  EXPECT_EQ(2u, v.size());
+  EXPECT_EQ(8, v[0]);
+  EXPECT_EQ(9, v[1]);
+}
+
+TEST(SmallVectorTest, InsertAndErase) {
+  IntVector v = {1, 2, 4, 5};
+  IntVector::iterator iter = v.insert(v.begin() + 2, 3);
+  EXPECT_EQ(3, *iter);
+  EXPECT_EQ((IntVector{1, 2, 3, 4, 5}), v);
+
+  const int more[] = {6, 7};
+  v.insert(v.end(), more, more + 2);
+  EXPECT_EQ((IntVector{1, 2, 3, 4, 5, 6, 7}), v);
+
+  iter = v.erase(v.begin() + 1);
+  EXPECT_EQ(3, *iter);
+  EXPECT_EQ((IntVector{1, 3, 4, 5, 6, 7}), v);
+
+  iter = v.erase(v.begin() + 1, v.begin() + 4);
+  EXPECT_EQ(6, *iter);
+  EXPECT_EQ((IntVector{1, 6, 7}), v);
+}
+
+TEST(SmallVectorTest, InsertEmptyRange) {
+  // An empty range must leave the tail untouched (the shift loop would
+  // otherwise self-move-assign every element after the insertion point).
+  StringVector v = {"a", "b", "c"};
+  std::string* none = nullptr;
+  StringVector::iterator iter = v.insert(v.begin() + 1, none, none);
+  EXPECT_EQ(v.begin() + 1, iter);
+  EXPECT_EQ((StringVector{"a", "b", "c"}), v);
+}
+
+TEST(SmallVectorTest, PopBack) {
+  IntVector v = {1, 2, 3};
+  v.pop_back();
+  EXPECT_EQ(2u, v.size());
+  EXPECT_EQ(2, v.back());
+}
+
+TEST(SmallVectorTest, ClearKeepsStorageUsable) {
+  IntVector v = {1, 2, 3, 4, 5, 6, 7, 8};
+  v.clear();
+  EXPECT_TRUE(v.empty());
+  v.push_back(1);
+  EXPECT_EQ(1u, v.size());
+  EXPECT_EQ(1, v[0]);
+}
+
+TEST(SmallVectorTest, NonTrivialElements) {
+  StringVector v;
+  for (int i = 0; i < 10; ++i) {
+    v.push_back(std::string(100, 'a' + i));
+  }
+  EXPECT_EQ(10u, v.size());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(std::string(100, 'a' + i), v[i]);
+  }
+  StringVector copy = v;
+  v.clear();
+  EXPECT_EQ(10u, copy.size());
+  EXPECT_EQ(std::string(100, 'a'), copy.front());
+}
+
+TEST(SmallVectorTest, ReserveDoesNotChangeContents) {
+  IntVector v = {1, 2, 3};
+  v.reserve(100);
+  EXPECT_GE(v.capacity(), 100u);
+  EXPECT_EQ((IntVector{1, 2, 3}), v);
+}
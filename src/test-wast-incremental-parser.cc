@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/wast-incremental-parser.h"
+
+using namespace wabt;
+
+namespace {
+
+const char kTwoFuncs[] =
+    "(module\n"
+    "  (func $a (result i32) (i32.const 1))\n"
+    "  (func $b (result i32) (i32.const 2))\n"
+    ")\n";
+
+}  // end of anonymous namespace
+
+TEST(WastIncrementalParser, EditOneForm) {
+  Features features;
+  WastParseOptions options(features);
+  WastIncrementalParser parser("test", &options);
+
+  Errors errors;
+  ASSERT_EQ(Result::Ok, parser.SetText(kTwoFuncs, &errors));
+  ASSERT_TRUE(errors.empty());
+
+  // Replace the "2" in $b; only that form is re-parsed.
+  size_t offset = parser.text().find("const 2") + 6;
+  Errors edit_errors;
+  ASSERT_EQ(Result::Ok, parser.ApplyEdit(offset, 1, "42", &edit_errors));
+  ASSERT_TRUE(edit_errors.empty());
+
+  const Module* module = parser.module(&edit_errors);
+  ASSERT_TRUE(module);
+  ASSERT_EQ(2u, module->funcs.size());
+}
+
+TEST(WastIncrementalParser, ErrorLocationIsWholeFile) {
+  Features features;
+  WastParseOptions options(features);
+  WastIncrementalParser parser("test", &options);
+
+  Errors errors;
+  ASSERT_EQ(Result::Ok, parser.SetText(kTwoFuncs, &errors));
+
+  // Break $a on line 2; the error must be reported there even though only
+  // that form is re-parsed.
+  size_t offset = parser.text().find("(result i32)");
+  Errors edit_errors;
+  ASSERT_EQ(Result::Error,
+            parser.ApplyEdit(offset, 0, "(result ", &edit_errors));
+  ASSERT_EQ(1u, edit_errors.size());
+  ASSERT_EQ(2, edit_errors[0].loc.line);
+
+  // Reverting the edit makes the module parse again.
+  Errors fix_errors;
+  ASSERT_EQ(Result::Ok, parser.ApplyEdit(offset, 8, "", &fix_errors));
+  ASSERT_TRUE(parser.module(&fix_errors));
+}
+
+TEST(WastIncrementalParser, UnbalancedFallsBackToFullParse) {
+  Features features;
+  WastParseOptions options(features);
+  WastIncrementalParser parser("test", &options);
+
+  Errors errors;
+  ASSERT_EQ(Result::Ok, parser.SetText("(module (func))", &errors));
+
+  // Deleting a ')' leaves the text unbalanced.
+  Errors edit_errors;
+  ASSERT_EQ(Result::Error, parser.ApplyEdit(14, 1, "", &edit_errors));
+  ASSERT_FALSE(edit_errors.empty());
+
+  Errors fix_errors;
+  ASSERT_EQ(Result::Ok, parser.ApplyEdit(14, 0, ")", &fix_errors));
+  ASSERT_TRUE(parser.module(&fix_errors));
+}
+
+TEST(WastIncrementalParser, BareModuleFields) {
+  Features features;
+  WastParseOptions options(features);
+  WastIncrementalParser parser("test", &options);
+
+  Errors errors;
+  ASSERT_EQ(Result::Ok,
+            parser.SetText("(func $f (result i32) (i32.const 7))\n"
+                           "(global $g i32 (i32.const 0))\n",
+                           &errors));
+
+  size_t offset = parser.text().find("7");
+  Errors edit_errors;
+  ASSERT_EQ(Result::Ok, parser.ApplyEdit(offset, 1, "8", &edit_errors));
+  ASSERT_TRUE(edit_errors.empty());
+
+  const Module* module = parser.module(&edit_errors);
+  ASSERT_TRUE(module);
+  ASSERT_EQ(1u, module->funcs.size());
+  ASSERT_EQ(1u, module->globals.size());
+}
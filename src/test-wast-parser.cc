@@ -85,3 +85,31 @@ TEST(WastParser, LongTokenSpace) {
   ASSERT_STREQ(R"(unexpected token notmodule, expected EOF.)",
                errors[1].message.c_str());
 }
+
+TEST(WastParser, ResetReusesParser) {
+  Features features;
+  WastParseOptions options(features);
+  Errors errors;
+
+  std::string first = "(module (func))";
+  auto lexer =
+      WastLexer::CreateBufferLexer("first", first.c_str(), first.size());
+  WastParser parser(lexer.get(), &errors, &options);
+
+  std::unique_ptr<Module> module;
+  ASSERT_EQ(Result::Ok, parser.ParseModule(&module));
+  ASSERT_EQ(1u, module->funcs.size());
+
+  // The same parser, re-aimed at another file, must not see any lookahead
+  // buffered from the first one.
+  std::string second = "(module (func) (func))";
+  auto second_lexer =
+      WastLexer::CreateBufferLexer("second", second.c_str(), second.size());
+  Errors second_errors;
+  parser.Reset(second_lexer.get(), &second_errors);
+
+  std::unique_ptr<Module> second_module;
+  ASSERT_EQ(Result::Ok, parser.ParseModule(&second_module));
+  ASSERT_EQ(2u, second_module->funcs.size());
+  ASSERT_TRUE(second_errors.empty());
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/timing.h"
+
+namespace wabt {
+
+static TimingSink s_timing_sink;
+
+void SetTimingSink(TimingSink sink) {
+  s_timing_sink = std::move(sink);
+}
+
+TimingSink MakeStreamTimingSink(Stream* stream) {
+  return [stream](const char* phase, double milliseconds) {
+    stream->Writef("%-12s %10.3f ms\n", phase, milliseconds);
+  };
+}
+
+TimedPhase::TimedPhase(const char* name) : name_(name) {
+  if (s_timing_sink) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+TimedPhase::~TimedPhase() {
+  if (!s_timing_sink) {
+    return;
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start_;
+  s_timing_sink(name_, elapsed.count());
+}
+
+}  // namespace wabt
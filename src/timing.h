@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_TIMING_H_
+#define WABT_TIMING_H_
+
+#include <chrono>
+#include <functional>
+
+#include "src/common.h"
+#include "src/stream.h"
+
+namespace wabt {
+
+// Coarse phase timing behind the tools' --timing flag. A phase is timed by
+// keeping a TimedPhase alive for its duration; when it ends, the installed
+// sink receives the phase name and elapsed time. With no sink installed (the
+// default), a TimedPhase is a cheap no-op, so the phase markers can stay in
+// the tools unconditionally.
+typedef std::function<void(const char* phase, double milliseconds)> TimingSink;
+
+// Installs the sink that receives finished phases; nullptr turns timing off.
+void SetTimingSink(TimingSink sink);
+
+// Returns a sink writing one "<phase> <time> ms" line per finished phase to
+// |stream|, which must outlive the sink.
+TimingSink MakeStreamTimingSink(Stream* stream);
+
+class TimedPhase {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(TimedPhase);
+  explicit TimedPhase(const char* name);
+  ~TimedPhase();
+
+ private:
+  const char* name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace wabt
+
+#endif  // WABT_TIMING_H_
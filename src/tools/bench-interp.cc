@@ -0,0 +1,400 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Interpreter latency regression gate: runs a fixed set of microkernels
+// (recursive calls, a load/store copy loop, br_table dispatch, simd matmul)
+// under Executor and reports instructions/sec with a 95% confidence
+// interval. The instruction count per kernel run is measured exactly once
+// with a profiling thread, then the timed samples run unprofiled, so the
+// reported rate is for the production dispatch loop. --json emits the
+// results machine-readably for A/B comparison across interpreter versions.
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/binary-reader.h"
+#include "src/binary-writer.h"
+#include "src/error-formatter.h"
+#include "src/feature.h"
+#include "src/interp/binary-reader-interp.h"
+#include "src/interp/interp.h"
+#include "src/ir.h"
+#include "src/option-parser.h"
+#include "src/resolve-names.h"
+#include "src/stream.h"
+#include "src/wast-lexer.h"
+#include "src/wast-parser.h"
+
+using namespace wabt;
+
+static int s_samples = 20;
+static int s_warmup_runs = 3;
+static std::string s_json_filename;
+static std::string s_kernel_filter;
+
+static const char s_description[] =
+R"(  Benchmark the interpreter on a fixed set of microkernels and report
+  instructions/sec with 95% confidence intervals.
+
+examples:
+  # Run every kernel and print a summary table
+  $ bench-interp
+
+  # 50 samples of just the fib kernel, results as JSON for A/B diffing
+  $ bench-interp --samples=50 --kernel=fib --json=results.json
+)";
+
+static void ParseOptions(int argc, char** argv) {
+  OptionParser parser("bench-interp", s_description);
+
+  parser.AddOption('s', "samples", "COUNT", "Timed runs per kernel (default 20)",
+                   [](const char* argument) { s_samples = atoi(argument); });
+  parser.AddOption('w', "warmup", "COUNT", "Untimed runs per kernel (default 3)",
+                   [](const char* argument) { s_warmup_runs = atoi(argument); });
+  parser.AddOption('j', "json", "FILENAME",
+                   "Also write the results as JSON to the given file",
+                   [](const char* argument) { s_json_filename = argument; });
+  parser.AddOption('k', "kernel", "NAME", "Run only the named kernel",
+                   [](const char* argument) { s_kernel_filter = argument; });
+  parser.Parse(argc, argv);
+}
+
+// Recursive call chains; stresses PushCall/stack_check and the Call handler.
+static std::string FibSource() {
+  return R"((module
+  (func $fib (param $n i32) (result i32)
+    (if (result i32) (i32.lt_s (local.get $n) (i32.const 2))
+      (then (local.get $n))
+      (else (i32.add
+        (call $fib (i32.sub (local.get $n) (i32.const 1)))
+        (call $fib (i32.sub (local.get $n) (i32.const 2)))))))
+  (func (export "run") (result i32)
+    (call $fib (i32.const 26)))))";
+}
+
+// Word-at-a-time copy loop; stresses the load/store bounds checks.
+static std::string MemcpySource() {
+  return R"((module
+  (memory 1)
+  (func (export "run") (result i32)
+    (local $rep i32) (local $i i32)
+    (block $init_done
+      (loop $init
+        (br_if $init_done (i32.ge_u (local.get $i) (i32.const 8192)))
+        (i32.store8 (local.get $i) (local.get $i))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $init)))
+    (block $done
+      (loop $outer
+        (br_if $done (i32.ge_u (local.get $rep) (i32.const 64)))
+        (local.set $i (i32.const 0))
+        (block $copy_done
+          (loop $copy
+            (br_if $copy_done (i32.ge_u (local.get $i) (i32.const 8192)))
+            (i32.store (i32.add (i32.const 16384) (local.get $i))
+                       (i32.load (local.get $i)))
+            (local.set $i (i32.add (local.get $i) (i32.const 4)))
+            (br $copy)))
+        (local.set $rep (i32.add (local.get $rep) (i32.const 1)))
+        (br $outer)))
+    (i32.load (i32.const 16384)))))";
+}
+
+// Dense br_table dispatch; stresses the table branch and its depth decode.
+static std::string BrTableSource() {
+  return R"((module
+  (func (export "run") (result i32)
+    (local $i i32) (local $acc i32)
+    (block $done
+      (loop $top
+        (br_if $done (i32.ge_u (local.get $i) (i32.const 200000)))
+        (block $next
+          (block $b3
+            (block $b2
+              (block $b1
+                (block $b0
+                  (br_table $b0 $b1 $b2 $b3
+                    (i32.and (local.get $i) (i32.const 3))))
+                (local.set $acc (i32.add (local.get $acc) (i32.const 1)))
+                (br $next))
+              (local.set $acc (i32.add (local.get $acc) (i32.const 5)))
+              (br $next))
+            (local.set $acc (i32.xor (local.get $acc) (local.get $i)))
+            (br $next))
+          (local.set $acc (i32.sub (local.get $acc) (i32.const 2))))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $top)))
+    (local.get $acc))))";
+}
+
+// 4x4 column-major f32 matmul, fully unrolled with v128 ops; stresses the
+// simd lane helpers. C[col j] = sum over k of A[col k] * splat(B[k][j]).
+static std::string SimdMatmulSource() {
+  std::string body;
+  for (int j = 0; j != 4; ++j) {
+    std::string sums[2];
+    for (int half = 0; half != 2; ++half) {
+      std::string products[2];
+      for (int i = 0; i != 2; ++i) {
+        int k = half * 2 + i;
+        products[i] = "(f32x4.mul (v128.load (i32.const " +
+                      std::to_string(k * 16) +
+                      ")) (f32x4.splat (f32.load (i32.const " +
+                      std::to_string(64 + j * 16 + k * 4) + "))))";
+      }
+      sums[half] = "(f32x4.add " + products[0] + " " + products[1] + ")";
+    }
+    body += "        (v128.store (i32.const " + std::to_string(128 + j * 16) +
+            ") (f32x4.add " + sums[0] + " " + sums[1] + "))\n";
+  }
+  return R"((module
+  (memory 1)
+  (func (export "run") (result i32)
+    (local $rep i32) (local $i i32)
+    (block $init_done
+      (loop $init
+        (br_if $init_done (i32.ge_u (local.get $i) (i32.const 32)))
+        (f32.store (i32.mul (local.get $i) (i32.const 4))
+                   (f32.convert_i32_s (i32.and (local.get $i) (i32.const 7))))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $init)))
+    (block $done
+      (loop $top
+        (br_if $done (i32.ge_u (local.get $rep) (i32.const 20000)))
+)" + body + R"(        (local.set $rep (i32.add (local.get $rep) (i32.const 1)))
+        (br $top)))
+    (i32.trunc_f32_s (f32.load (i32.const 128))))))";
+}
+
+struct Kernel {
+  const char* name;
+  std::string source;
+};
+
+struct BenchResult {
+  const char* name;
+  uint64_t instructions;
+  int samples;
+  double mean_ns;
+  double stddev_ns;
+  double ci95_ns;
+  double instructions_per_sec;
+};
+
+static Result CompileKernel(const Kernel& kernel,
+                            const Features& features,
+                            std::vector<uint8_t>* out_binary) {
+  Errors errors;
+  std::unique_ptr<WastLexer> lexer = WastLexer::CreateBufferLexer(
+      kernel.name, kernel.source.data(), kernel.source.size());
+  WastParseOptions parse_options(features);
+  std::unique_ptr<Module> module;
+  Result result = ParseWatModule(lexer.get(), &module, &errors, &parse_options);
+  if (Succeeded(result)) {
+    result = ResolveNamesModule(module.get(), &errors);
+  }
+  if (Succeeded(result)) {
+    MemoryStream stream;
+    result = WriteBinaryModule(&stream, module.get(), WriteBinaryOptions());
+    *out_binary = stream.output_buffer().data;
+  }
+  FormatErrorsToFile(errors, Location::Type::Text);
+  return result;
+}
+
+// Instantiates the kernel in a fresh environment and runs its "run" export
+// once. With |options.enable_profiling| the executor counts instructions.
+static Result RunOnce(const std::vector<uint8_t>& binary,
+                      const Features& features,
+                      const interp::Thread::Options& options,
+                      interp::Executor** out_executor,
+                      interp::DefinedModule** out_module,
+                      interp::Environment* env) {
+  Errors errors;
+  interp::DefinedModule* module = nullptr;
+  ReadBinaryOptions read_options;
+  read_options.features = features;
+  Result result = ReadBinaryInterp(env, binary.data(), binary.size(),
+                                   read_options, &errors, &module);
+  FormatErrorsToFile(errors, Location::Type::Binary);
+  if (Failed(result)) {
+    return result;
+  }
+  std::unique_ptr<interp::Executor> executor(
+      new interp::Executor(env, nullptr, options));
+  if (!executor->Initialize(module).ok()) {
+    return Result::Error;
+  }
+  interp::ExecResult exec_result =
+      executor->RunExportByName(module, "run", interp::TypedValues());
+  if (!exec_result.ok()) {
+    return Result::Error;
+  }
+  *out_executor = executor.release();
+  *out_module = module;
+  return Result::Ok;
+}
+
+static Result BenchKernel(const Kernel& kernel,
+                          const Features& features,
+                          BenchResult* out) {
+  std::vector<uint8_t> binary;
+  if (Failed(CompileKernel(kernel, features, &binary))) {
+    fprintf(stderr, "%s: compilation failed\n", kernel.name);
+    return Result::Error;
+  }
+
+  // Exact instruction count from one profiled run.
+  uint64_t instructions;
+  {
+    interp::Environment env(features);
+    interp::Thread::Options options;
+    options.enable_profiling = true;
+    interp::Executor* executor;
+    interp::DefinedModule* module;
+    if (Failed(RunOnce(binary, features, options, &executor, &module, &env))) {
+      fprintf(stderr, "%s: profiled run failed\n", kernel.name);
+      return Result::Error;
+    }
+    instructions = executor->ProfileInstructionCount();
+    delete executor;
+  }
+
+  // Timed samples on an unprofiled executor, reusing the instance so the
+  // samples measure the dispatch loop, not instantiation.
+  interp::Environment env(features);
+  interp::Executor* executor;
+  interp::DefinedModule* module;
+  if (Failed(RunOnce(binary, features, interp::Thread::Options(), &executor,
+                     &module, &env))) {
+    fprintf(stderr, "%s: warmup run failed\n", kernel.name);
+    return Result::Error;
+  }
+  std::unique_ptr<interp::Executor> owned(executor);
+  for (int i = 1; i < s_warmup_runs; ++i) {
+    executor->RunExportByName(module, "run", interp::TypedValues());
+  }
+
+  std::vector<double> sample_ns(s_samples);
+  for (int i = 0; i < s_samples; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    interp::ExecResult exec_result =
+        executor->RunExportByName(module, "run", interp::TypedValues());
+    auto stop = std::chrono::steady_clock::now();
+    if (!exec_result.ok()) {
+      fprintf(stderr, "%s: timed run failed\n", kernel.name);
+      return Result::Error;
+    }
+    sample_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       stop - start)
+                       .count();
+  }
+
+  double sum = 0;
+  for (double ns : sample_ns) {
+    sum += ns;
+  }
+  double mean = sum / s_samples;
+  double variance = 0;
+  for (double ns : sample_ns) {
+    variance += (ns - mean) * (ns - mean);
+  }
+  variance = s_samples > 1 ? variance / (s_samples - 1) : 0;
+  double stddev = std::sqrt(variance);
+
+  out->name = kernel.name;
+  out->instructions = instructions;
+  out->samples = s_samples;
+  out->mean_ns = mean;
+  out->stddev_ns = stddev;
+  // Normal approximation; fine at the default 20 samples and above.
+  out->ci95_ns = 1.96 * stddev / std::sqrt(static_cast<double>(s_samples));
+  out->instructions_per_sec = instructions / (mean * 1e-9);
+  return Result::Ok;
+}
+
+static void WriteJson(const char* filename,
+                      const std::vector<BenchResult>& results) {
+  FILE* file = fopen(filename, "w");
+  if (!file) {
+    fprintf(stderr, "unable to open %s for writing\n", filename);
+    return;
+  }
+  fprintf(file, "{\n  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& r = results[i];
+    fprintf(file,
+            "    {\"name\": \"%s\", \"instructions\": %" PRIu64
+            ", \"samples\": %d, \"mean_ns\": %.1f, \"stddev_ns\": %.1f, "
+            "\"ci95_ns\": %.1f, \"instructions_per_sec\": %.1f}%s\n",
+            r.name, r.instructions, r.samples, r.mean_ns, r.stddev_ns,
+            r.ci95_ns, r.instructions_per_sec,
+            i + 1 != results.size() ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  fclose(file);
+}
+
+int ProgramMain(int argc, char** argv) {
+  ParseOptions(argc, argv);
+
+  Features features;
+  features.EnableAll();
+
+  const Kernel kernels[] = {
+      {"fib", FibSource()},
+      {"memcpy", MemcpySource()},
+      {"br_table", BrTableSource()},
+      {"simd_matmul", SimdMatmulSource()},
+  };
+
+  std::vector<BenchResult> results;
+  bool matched = false;
+  for (const Kernel& kernel : kernels) {
+    if (!s_kernel_filter.empty() && s_kernel_filter != kernel.name) {
+      continue;
+    }
+    matched = true;
+    BenchResult result;
+    if (Failed(BenchKernel(kernel, features, &result))) {
+      return 1;
+    }
+    results.push_back(result);
+    printf("%-12s %10" PRIu64 " instrs  %8.3f ms +/- %.3f ms  %7.1f M instrs/s\n",
+           result.name, result.instructions, result.mean_ns * 1e-6,
+           result.ci95_ns * 1e-6, result.instructions_per_sec * 1e-6);
+  }
+  if (!matched) {
+    fprintf(stderr, "unknown kernel: %s\n", s_kernel_filter.c_str());
+    return 1;
+  }
+
+  if (!s_json_filename.empty()) {
+    WriteJson(s_json_filename.c_str(), results);
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  WABT_TRY
+  return ProgramMain(argc, argv);
+  WABT_CATCH_BAD_ALLOC_AND_EXIT
+}
@@ -19,8 +19,10 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "src/binary-reader.h"
@@ -46,6 +48,7 @@ static const char* s_infile;
 static Thread::Options s_thread_options;
 static Stream* s_trace_stream;
 static Features s_features;
+static int s_num_threads = 1;
 
 static std::unique_ptr<FileStream> s_log_stream;
 static std::unique_ptr<FileStream> s_stdout_stream;
@@ -85,6 +88,15 @@ static void ParseOptions(int argc, char** argv) {
                    });
   parser.AddOption('t', "trace", "Trace execution",
                    []() { s_trace_stream = s_stdout_stream.get(); });
+  parser.AddOption('j', "jobs", "N",
+                   "Run independent assertions on N threads (0 means one "
+                   "thread per processor)",
+                   [](const std::string& argument) {
+                     s_num_threads = atoi(argument.c_str());
+                     if (s_num_threads == 0) {
+                       s_num_threads = std::thread::hardware_concurrency();
+                     }
+                   });
 
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) { s_infile = argument; });
@@ -206,7 +218,7 @@ class JSONParser {
  public:
   JSONParser() {}
 
-  wabt::Result ReadFile(string_view spec_json_filename);
+  wabt::Result ReadFile(const char* spec_json_filename);
   wabt::Result ParseScript(Script* out_script);
 
  private:
@@ -248,7 +260,7 @@ class JSONParser {
 #define PARSE_KEY_STRING_VALUE(key, value) \
   CHECK_RESULT(ParseKeyStringValue(key, value))
 
-wabt::Result JSONParser::ReadFile(string_view spec_json_filename) {
+wabt::Result JSONParser::ReadFile(const char* spec_json_filename) {
   loc_.filename = spec_json_filename;
   loc_.line = 1;
   loc_.first_column = 1;
@@ -258,7 +270,7 @@ wabt::Result JSONParser::ReadFile(string_view spec_json_filename) {
 
 void JSONParser::PrintError(const char* format, ...) {
   WABT_SNPRINTF_ALLOCA(buffer, length, format);
-  fprintf(stderr, "%s:%d:%d: %s\n", loc_.filename.to_string().c_str(),
+  fprintf(stderr, "%s:%d:%d: %s\n", loc_.filename,
           loc_.line, loc_.first_column, buffer);
 }
 
@@ -816,9 +828,111 @@ wabt::Result JSONParser::ParseScript(Script* out_script) {
   return wabt::Result::Ok;
 }
 
+// Returns the action a command runs, or nullptr for commands without one.
+static const Action* GetCommandAction(const Command* command) {
+  switch (command->type) {
+    case CommandType::Action:
+      return &cast<ActionCommand>(command)->action;
+    case CommandType::AssertReturn:
+      return &cast<AssertReturnCommand>(command)->action;
+    case CommandType::AssertReturnFunc:
+      return &cast<AssertReturnFuncCommand>(command)->action;
+    case CommandType::AssertReturnCanonicalNan:
+      return &cast<AssertReturnCanonicalNanCommand>(command)->action;
+    case CommandType::AssertReturnArithmeticNan:
+      return &cast<AssertReturnArithmeticNanCommand>(command)->action;
+    case CommandType::AssertTrap:
+      return &cast<AssertTrapCommand>(command)->action;
+    case CommandType::AssertExhaustion:
+      return &cast<AssertExhaustionCommand>(command)->action;
+    default:
+      return nullptr;
+  }
+}
+
+// A module instance pinned for the rest of the script (registered, escaped,
+// or left behind by an assert the environment can't cleanly undo).
+static const size_t kCommandIndexPinned = ~size_t(0);
+
+// For each ModuleCommand, the index of the last command that can reference
+// its instance: actions name a module explicitly, or implicitly target the
+// most recently instantiated one. A registered module can be imported by any
+// later module, so it stays referenced for the rest of the script. Everything
+// is known from the parsed script, so this is one cheap pass over the
+// commands; OnModuleCommand uses the result to evict instances no later
+// command can reach.
+static std::map<const Command*, size_t> ComputeModuleLastUses(
+    const Script& script) {
+  std::map<const Command*, size_t> last_uses;
+  std::map<std::string, const Command*> modules_by_name;
+  const Command* current_module = nullptr;
+
+  for (size_t i = 0; i < script.commands.size(); ++i) {
+    const Command* command = script.commands[i].get();
+    switch (command->type) {
+      case CommandType::Module: {
+        auto* module_command = cast<ModuleCommand>(command);
+        current_module = command;
+        last_uses[command] = i;
+        if (!module_command->name.empty()) {
+          modules_by_name[module_command->name] = command;
+        }
+        break;
+      }
+
+      case CommandType::Register: {
+        // The registered instance becomes importable by name for the rest of
+        // the script; pin it.
+        auto* register_command = cast<RegisterCommand>(command);
+        const Command* target;
+        if (!register_command->name.empty()) {
+          auto iter = modules_by_name.find(register_command->name);
+          target = iter != modules_by_name.end() ? iter->second : nullptr;
+        } else {
+          target = current_module;
+        }
+        if (target) {
+          last_uses[target] = kCommandIndexPinned;
+        }
+        break;
+      }
+
+      case CommandType::AssertUnlinkable:
+        // Clobbers the "last module" the runner tracks; actions after this
+        // point implicitly target the unlinkable module, not current_module.
+        current_module = nullptr;
+        break;
+
+      default: {
+        if (const Action* action = GetCommandAction(command)) {
+          const Command* target;
+          if (!action->module_name.empty()) {
+            auto iter = modules_by_name.find(action->module_name);
+            target = iter != modules_by_name.end() ? iter->second : nullptr;
+          } else {
+            target = current_module;
+          }
+          if (target && last_uses[target] != kCommandIndexPinned) {
+            last_uses[target] = i;
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  return last_uses;
+}
+
 class CommandRunner {
  public:
-  CommandRunner();
+  // When num_shards > 1, the runner replays every state-changing command
+  // (module, register, action, ...) to build up its Environment, but only
+  // runs, reports and tallies the independent assertions whose sequence
+  // number falls in its shard. Shard 0 additionally reports and tallies the
+  // state-changing commands, so summing the counts of one runner per shard
+  // covers the whole script exactly once.
+  explicit CommandRunner(int shard_index = 0, int num_shards = 1);
 
   wabt::Result Run(const Script& script);
 
@@ -847,8 +961,13 @@ class CommandRunner {
   wabt::Result OnAssertTrapCommand(const AssertTrapCommand*);
   wabt::Result OnAssertExhaustionCommand(const AssertExhaustionCommand*);
 
+  bool OwnsNextAssertion();
+  void SetQuiet(bool quiet);
   void TallyCommand(wabt::Result);
 
+  void EvictDeadModules();
+  bool ModuleEscaped(const Environment::MarkPoint& mark) const;
+
   wabt::Result ReadInvalidTextModule(string_view module_filename,
                                      Environment* env,
                                      const std::string& header);
@@ -866,16 +985,55 @@ class CommandRunner {
   Environment env_;
   Executor executor_;
   DefinedModule* last_module_ = nullptr;
+  int shard_index_;
+  int num_shards_;
+  int assertion_index_ = 0;
+  bool quiet_ = false;
   int passed_ = 0;
   int total_ = 0;
 
   std::string source_filename_;
+
+  // Instances still loaded in env_, in instantiation order; |mark| is the
+  // environment state from just before each was appended, so a dead suffix
+  // can be dropped with one ResetToMarkPoint. Keeps peak memory bounded on
+  // the largest generated scripts.
+  struct LoadedModule {
+    Environment::MarkPoint mark;
+    size_t last_use;
+  };
+  std::vector<LoadedModule> loaded_modules_;
+  std::map<const Command*, size_t> module_last_uses_;
+  size_t command_index_ = 0;
 };
 
+// Commands that change the state of the runner's Environment (or depend on
+// ordering relative to such commands). Every shard has to replay these;
+// everything else is an independent assertion that only its owning shard runs.
+static bool IsStateCommand(CommandType type) {
+  switch (type) {
+    case CommandType::Module:
+    case CommandType::Action:
+    case CommandType::Register:
+    case CommandType::AssertUnlinkable:
+    case CommandType::AssertUninstantiable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Set while a shard replays a state command it doesn't own, so host functions
+// called during module initialization don't print once per shard.
+static thread_local bool s_quiet_host_print = false;
+
 static interp::Result PrintCallback(const HostFunc* func,
                                     const interp::FuncSignature* sig,
                                     const TypedValues& args,
                                     TypedValues& results) {
+  if (s_quiet_host_print) {
+    return interp::ResultType::Ok;
+  }
   printf("called host ");
   WriteCall(s_stdout_stream.get(), func->module_name, func->field_name, args,
             results, interp::ResultType::Ok);
@@ -902,15 +1060,40 @@ static void InitEnvironment(Environment* env) {
   host_module->AppendGlobalExport("global_f64", false, double(666.6));
 }
 
-CommandRunner::CommandRunner()
-    : env_(s_features), executor_(&env_, s_trace_stream, s_thread_options) {
+CommandRunner::CommandRunner(int shard_index, int num_shards)
+    : env_(s_features),
+      executor_(&env_, s_trace_stream, s_thread_options),
+      shard_index_(shard_index),
+      num_shards_(num_shards) {
   InitEnvironment(&env_);
 }
 
+bool CommandRunner::OwnsNextAssertion() {
+  return assertion_index_++ % num_shards_ == shard_index_;
+}
+
+void CommandRunner::SetQuiet(bool quiet) {
+  quiet_ = quiet;
+  s_quiet_host_print = quiet;
+}
+
 wabt::Result CommandRunner::Run(const Script& script) {
   source_filename_ = script.filename;
+  module_last_uses_ = ComputeModuleLastUses(script);
+
+  for (command_index_ = 0; command_index_ < script.commands.size();
+       ++command_index_) {
+    const CommandPtr& command = script.commands[command_index_];
+    if (IsStateCommand(command->type)) {
+      // State commands run on every shard, but only shard 0 reports them.
+      SetQuiet(shard_index_ != 0);
+    } else {
+      if (!OwnsNextAssertion()) {
+        continue;
+      }
+      SetQuiet(false);
+    }
 
-  for (const CommandPtr& command : script.commands) {
     switch (command->type) {
       case CommandType::Module:
         OnModuleCommand(cast<ModuleCommand>(command.get()));
@@ -980,6 +1163,9 @@ wabt::Result CommandRunner::Run(const Script& script) {
 }
 
 void CommandRunner::PrintError(uint32_t line_number, const char* format, ...) {
+  if (quiet_) {
+    return;
+  }
   WABT_SNPRINTF_ALLOCA(buffer, length, format);
   printf("%s:%u: %s\n", source_filename_.c_str(), line_number, buffer);
 }
@@ -1016,7 +1202,7 @@ ExecResult CommandRunner::RunAction(int line_number,
     case ActionType::Invoke:
       exec_result =
           executor_.RunExportByName(module, action->field_name, action->args);
-      if (verbose == RunVerbosity::Verbose) {
+      if (verbose == RunVerbosity::Verbose && !quiet_) {
         WriteCall(s_stdout_stream.get(), string_view(), action->field_name,
                   action->args, exec_result.values, exec_result.result);
       }
@@ -1056,8 +1242,7 @@ wabt::Result CommandRunner::ReadInvalidTextModule(string_view module_filename,
     }
   }
 
-  auto line_finder = lexer->MakeLineFinder();
-  FormatErrorsToFile(errors, Location::Type::Text, line_finder.get(), stdout,
+  FormatErrorsToFile(errors, Location::Type::Text, lexer->line_finder(), stdout,
                      header, PrintHeader::Once);
   return result;
 }
@@ -1119,12 +1304,60 @@ wabt::Result CommandRunner::ReadInvalidModule(int line_number,
   WABT_UNREACHABLE;
 }
 
+// Returns true if |mark|'s module installed a reference to one of its own
+// functions somewhere that survives it: a table or global that existed before
+// it was instantiated (e.g. an elem segment into an imported table). Such an
+// instance stays callable through the older object even when no later command
+// names it, so it must not be evicted.
+bool CommandRunner::ModuleEscaped(const Environment::MarkPoint& mark) const {
+  Environment* env = const_cast<Environment*>(&env_);
+  for (Index i = 0; i < mark.tables_size; ++i) {
+    for (const Ref& ref : env->GetTable(i)->entries) {
+      if (ref.kind == RefType::Func && ref.index >= mark.funcs_size) {
+        return true;
+      }
+    }
+  }
+  for (Index i = 0; i < mark.globals_size; ++i) {
+    const TypedValue& tv = env->GetGlobal(i)->typed_value;
+    if ((tv.type == Type::Funcref || tv.type == Type::Anyref) &&
+        tv.value.ref.kind == RefType::Func &&
+        tv.value.ref.index >= mark.funcs_size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Drops the longest suffix of loaded instances whose last referencing
+// command has already run. Mark points only truncate, so eviction is
+// strictly LIFO; a pinned instance also keeps everything loaded after it.
+void CommandRunner::EvictDeadModules() {
+  bool evict = false;
+  Environment::MarkPoint mark;
+  while (!loaded_modules_.empty() &&
+         loaded_modules_.back().last_use != kCommandIndexPinned &&
+         loaded_modules_.back().last_use < command_index_) {
+    mark = loaded_modules_.back().mark;
+    loaded_modules_.pop_back();
+    evict = true;
+  }
+  if (evict) {
+    env_.ResetToMarkPoint(mark);
+    last_module_ = nullptr;
+  }
+}
+
 wabt::Result CommandRunner::OnModuleCommand(const ModuleCommand* command) {
+  EvictDeadModules();
+
   Environment::MarkPoint mark = env_.Mark();
   Errors errors;
   wabt::Result result = ReadModule(command->filename, &env_,
                                    &errors, &last_module_);
-  FormatErrorsToFile(errors, Location::Type::Binary);
+  if (!quiet_) {
+    FormatErrorsToFile(errors, Location::Type::Binary);
+  }
 
   if (Failed(result)) {
     env_.ResetToMarkPoint(mark);
@@ -1136,8 +1369,10 @@ wabt::Result CommandRunner::OnModuleCommand(const ModuleCommand* command) {
   ExecResult exec_result = executor_.Initialize(last_module_);
   if (!exec_result.ok()) {
     env_.ResetToMarkPoint(mark);
-    WriteResult(s_stdout_stream.get(), "error initializing module",
-                exec_result.result);
+    if (!quiet_) {
+      WriteResult(s_stdout_stream.get(), "error initializing module",
+                  exec_result.result);
+    }
     return wabt::Result::Error;
   }
 
@@ -1147,6 +1382,13 @@ wabt::Result CommandRunner::OnModuleCommand(const ModuleCommand* command) {
                               Binding(env_.GetModuleCount() - 1));
   }
 
+  auto iter = module_last_uses_.find(command);
+  size_t last_use = iter != module_last_uses_.end() ? iter->second : 0;
+  if (last_use != kCommandIndexPinned && ModuleEscaped(mark)) {
+    last_use = kCommandIndexPinned;
+  }
+  loaded_modules_.push_back({mark, last_use});
+
   return wabt::Result::Ok;
 }
 
@@ -1199,15 +1441,23 @@ wabt::Result CommandRunner::OnRegisterCommand(const RegisterCommand* command) {
 
 wabt::Result CommandRunner::OnAssertUnlinkableCommand(
     const AssertUnlinkableCommand* command) {
+  // Whatever this leaves in the environment (including partial state from a
+  // failed read or link) is outside the module liveness bookkeeping; record
+  // it as pinned so eviction never truncates across it.
+  loaded_modules_.push_back({env_.Mark(), kCommandIndexPinned});
+
   Errors errors;
   wabt::Result result =
       ReadModule(command->filename, &env_, &errors, &last_module_);
 
   if (Failed(result)) {
-    std::string header = StringPrintf("%s:%d: assert_unlinkable passed",
-                                      source_filename_.c_str(), command->line);
-    FormatErrorsToFile(errors, Location::Type::Binary, {}, stdout, header,
-                       PrintHeader::Once);
+    if (!quiet_) {
+      std::string header = StringPrintf("%s:%d: assert_unlinkable passed",
+                                        source_filename_.c_str(),
+                                        command->line);
+      FormatErrorsToFile(errors, Location::Type::Binary, {}, stdout, header,
+                         PrintHeader::Once);
+    }
     return wabt::Result::Ok;
   }
 
@@ -1218,8 +1468,10 @@ wabt::Result CommandRunner::OnAssertUnlinkableCommand(
     return wabt::Result::Error;
   }
 
-  WriteResult(s_stdout_stream.get(), "assert_unlinkable passed",
-              exec_result.result);
+  if (!quiet_) {
+    WriteResult(s_stdout_stream.get(), "assert_unlinkable passed",
+                exec_result.result);
+  }
   return wabt::Result::Ok;
 }
 
@@ -1241,10 +1493,16 @@ wabt::Result CommandRunner::OnAssertInvalidCommand(
 
 wabt::Result CommandRunner::OnAssertUninstantiableCommand(
     const AssertUninstantiableCommand* command) {
+  // As in OnAssertUnlinkableCommand: the module (and any side effects of its
+  // failed start function) stays in the environment untracked, so pin it.
+  loaded_modules_.push_back({env_.Mark(), kCommandIndexPinned});
+
   Errors errors;
   DefinedModule* module;
   wabt::Result result = ReadModule(command->filename, &env_, &errors, &module);
-  FormatErrorsToFile(errors, Location::Type::Binary);
+  if (!quiet_) {
+    FormatErrorsToFile(errors, Location::Type::Binary);
+  }
 
   if (Succeeded(result)) {
     ExecResult exec_result = executor_.Initialize(module);
@@ -1441,13 +1699,16 @@ wabt::Result CommandRunner::OnAssertExhaustionCommand(
 }
 
 void CommandRunner::TallyCommand(wabt::Result result) {
+  if (quiet_) {
+    return;
+  }
   if (Succeeded(result)) {
     passed_++;
   }
   total_++;
 }
 
-static int ReadAndRunSpecJSON(string_view spec_json_filename) {
+static int ReadAndRunSpecJSON(const char* spec_json_filename) {
   JSONParser parser;
   if (parser.ReadFile(spec_json_filename) == wabt::Result::Error) {
     return 1;
@@ -1458,14 +1719,44 @@ static int ReadAndRunSpecJSON(string_view spec_json_filename) {
     return 1;
   }
 
-  CommandRunner runner;
-  if (runner.Run(script) == wabt::Result::Error) {
-    return 1;
+  if (s_num_threads <= 1) {
+    CommandRunner runner;
+    if (runner.Run(script) == wabt::Result::Error) {
+      return 1;
+    }
+
+    printf("%d/%d tests passed.\n", runner.passed(), runner.total());
+    const int failed = runner.total() - runner.passed();
+    return failed;
+  }
+
+  // Run the independent assertions on worker threads, one runner per shard.
+  // Each runner replays the state commands to build its own Environment, so
+  // the shards never share interpreter state; only the order of the failure
+  // messages can differ from a serial run.
+  std::vector<std::unique_ptr<CommandRunner>> runners;
+  for (int i = 0; i < s_num_threads; ++i) {
+    runners.emplace_back(new CommandRunner(i, s_num_threads));
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < s_num_threads; ++i) {
+    CommandRunner* runner = runners[i].get();
+    threads.emplace_back([runner, &script]() { runner->Run(script); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  int passed = 0;
+  int total = 0;
+  for (const std::unique_ptr<CommandRunner>& runner : runners) {
+    passed += runner->passed();
+    total += runner->total();
   }
 
-  printf("%d/%d tests passed.\n", runner.passed(), runner.total());
-  const int failed = runner.total() - runner.passed();
-  return failed;
+  printf("%d/%d tests passed.\n", passed, total);
+  return total - passed;
 }
 
 }  // namespace spectest
@@ -18,6 +18,7 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <thread>
 
 #include "src/apply-names.h"
 #include "src/binary-reader.h"
@@ -42,6 +43,7 @@ int ProgramMain(int argc, char** argv) {
   Features features;
   DecompileOptions decompile_options;
   bool fail_on_custom_section_error = true;
+  int num_threads = 1;
 
   {
     const char s_description[] =
@@ -63,6 +65,15 @@ int ProgramMain(int argc, char** argv) {
     parser.AddOption("ignore-custom-section-errors",
                      "Ignore errors in custom sections",
                      [&]() { fail_on_custom_section_error = false; });
+    parser.AddOption('j', "jobs", "N",
+                     "Decode function bodies on N threads (0 means one thread "
+                     "per processor)",
+                     [&](const char* argument) {
+                       num_threads = atoi(argument);
+                       if (num_threads == 0) {
+                         num_threads = std::thread::hardware_concurrency();
+                       }
+                     });
     parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                        [&](const char* argument) {
                          infile = argument;
@@ -80,6 +91,7 @@ int ProgramMain(int argc, char** argv) {
     ReadBinaryOptions options(features, nullptr,
                               true, kStopOnFirstError,
                               fail_on_custom_section_error);
+    options.num_threads = num_threads;
     result = ReadBinaryIr(infile.c_str(), file_data.data(), file_data.size(),
                           options, &errors, &module);
     if (Succeeded(result)) {
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// In-process fuzz entry point for the binary reader, IR builder and
+// validator. Build with -DBUILD_FUZZ_TOOLS=ON (requires clang) and run
+//
+//   wasm-fuzz fuzz-in/wasm
+//
+// under libFuzzer; AFL++ can drive the same entry point through its
+// LLVMFuzzerTestOneInput shim. Everything here lives on the stack of one
+// iteration, so the persistent loop resets by plain destruction, with no
+// process or Environment teardown between inputs.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "src/binary-reader.h"
+#include "src/binary-reader-ir.h"
+#include "src/binary-reader-nop.h"
+#include "src/error.h"
+#include "src/ir.h"
+#include "src/validator.h"
+
+using namespace wabt;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  ReadBinaryOptions options;
+  options.features.EnableAll();
+  // Nothing reads the error text, so skip formatting it; on the mostly
+  // invalid inputs a fuzzer produces the message rendering would otherwise
+  // dominate an iteration.
+  options.skip_error_messages = true;
+
+  // Raw decode first: the nop delegate never cuts a section short, so this
+  // reaches decoder paths the IR build below stops before.
+  BinaryReaderNop nop;
+  ReadBinary(data, size, &nop, options);
+
+  Errors errors;
+  Module module;
+  if (Succeeded(ReadBinaryIr("fuzz", data, size, options, &errors, &module))) {
+    ValidateOptions validate_options(options.features);
+    validate_options.skip_error_messages = true;
+    ValidateModule(&module, &errors, validate_options);
+  }
+  return 0;
+}
@@ -29,10 +29,13 @@
 #include "src/feature.h"
 #include "src/interp/binary-reader-interp.h"
 #include "src/interp/interp.h"
+#include "src/interp/interp-serialize.h"
 #include "src/literal.h"
 #include "src/option-parser.h"
 #include "src/resolve-names.h"
 #include "src/stream.h"
+#include "src/memory-stats.h"
+#include "src/timing.h"
 #include "src/validator.h"
 #include "src/wast-lexer.h"
 #include "src/wast-parser.h"
@@ -47,6 +50,9 @@ static Stream* s_trace_stream;
 static bool s_run_all_exports;
 static bool s_host_print;
 static bool s_dummy_import_func;
+static bool s_use_guard_pages;
+static interp::MemoryAllocationPolicy s_memory_policy;
+static std::string s_cache_filename;
 static Features s_features;
 
 static std::unique_ptr<FileStream> s_log_stream;
@@ -98,6 +104,32 @@ static void ParseOptions(int argc, char** argv) {
                    });
   parser.AddOption('t', "trace", "Trace execution",
                    []() { s_trace_stream = s_stdout_stream.get(); });
+  parser.AddOption(
+      OptionParser::Option(
+          '\0', "jit-threshold", "N", OptionParser::HasArgument::Yes,
+          "Translate a function to native code after N direct calls "
+          "(x86-64 only; 0, the default, runs everything in the interpreter)",
+          [](const char* argument) {
+            s_thread_options.jit_threshold = atoi(argument);
+          }));
+  parser.AddOption("timing",
+                   "Print the time spent in each phase (read, lower, "
+                   "instantiate, execute) to stdout",
+                   []() {
+                     SetTimingSink(MakeStreamTimingSink(s_stdout_stream.get()));
+                   });
+  parser.AddOption("mem-stats",
+                   "Print allocation counts and peak memory for each phase "
+                   "(read, lower, instantiate, execute) to stdout",
+                   []() {
+                     SetMemoryStatsSink(
+                         MakeStreamMemoryStatsSink(s_stdout_stream.get()));
+                   });
+  parser.AddOption(
+      "profile",
+      "Count executed opcodes and sample hot functions, and dump the "
+      "profile after the run. Much cheaper than --trace",
+      []() { s_thread_options.enable_profiling = true; });
   parser.AddOption(
       "run-all-exports",
       "Run all the exported functions, in order. Useful for testing",
@@ -106,6 +138,30 @@ static void ParseOptions(int argc, char** argv) {
                    "Include an importable function named \"host.print\" for "
                    "printing to stdout",
                    []() { s_host_print = true; });
+  parser.AddOption(
+      "use-guard-pages",
+      "Allocate memories as large mmap reservations with guard pages, "
+      "catching out-of-bounds accesses with a fault handler instead of "
+      "explicit bounds checks (64-bit POSIX hosts only)",
+      []() { s_use_guard_pages = true; });
+  parser.AddOption(
+      "use-huge-pages",
+      "Ask the kernel to back wasm memories with huge pages "
+      "(madvise(MADV_HUGEPAGE); Linux only, best-effort)",
+      []() { s_memory_policy.use_huge_pages = true; });
+  parser.AddOption(OptionParser::Option(
+      '\0', "numa-node", "NODE", OptionParser::HasArgument::Yes,
+      "Bind wasm memory pages to NUMA node NODE instead of first-touch "
+      "placement (Linux only, best-effort)",
+      [](const char* argument) {
+        s_memory_policy.numa_node = atoi(argument);
+      }));
+  parser.AddOption(OptionParser::Option(
+      '\0', "cache", "FILE", OptionParser::HasArgument::Yes,
+      "Cache the lowered module in FILE. The cache is written on the first "
+      "run and loaded instead of re-lowering the wasm binary on later runs; "
+      "it is ignored when stale or written by a different wabt build",
+      [](const char* argument) { s_cache_filename = argument; }));
   parser.AddOption(
       "dummy-import-func",
       "Provide a dummy implementation of all imported functions. The function "
@@ -137,21 +193,33 @@ static void RunAllExports(interp::Module* module,
 static wabt::Result ReadModule(const char* module_filename,
                                Environment* env,
                                Errors* errors,
-                               DefinedModule** out_module) {
+                               DefinedModule** out_module,
+                               std::vector<uint8_t>* file_data) {
   wabt::Result result;
-  std::vector<uint8_t> file_data;
 
   *out_module = nullptr;
 
-  result = ReadFile(module_filename, &file_data);
+  {
+    TimedPhase timer("read");
+    MemoryPhase mem_phase("read");
+    result = ReadFile(module_filename, file_data);
+  }
   if (Succeeded(result)) {
     const bool kReadDebugNames = true;
     const bool kStopOnFirstError = true;
     const bool kFailOnCustomSectionError = true;
     ReadBinaryOptions options(s_features, s_log_stream.get(), kReadDebugNames,
                               kStopOnFirstError, kFailOnCustomSectionError);
-    result = ReadBinaryInterp(env, file_data.data(), file_data.size(), options,
-                              errors, out_module);
+    // |file_data| is owned by the caller and outlives the environment, so
+    // data segments can reference the module image instead of copying it.
+    options.reference_data_segments = true;
+    {
+      // Validation happens inline during lowering, so this phase covers both.
+      TimedPhase timer("lower");
+      MemoryPhase mem_phase("lower");
+      result = ReadBinaryInterp(env, file_data->data(), file_data->size(),
+                                options, errors, out_module);
+    }
 
     if (Succeeded(result)) {
       if (s_verbose) {
@@ -162,6 +230,38 @@ static wabt::Result ReadModule(const char* module_filename,
   return result;
 }
 
+// Tries to load the lowered-module cache written by a previous run. Returns
+// null (leaving |env| untouched) if the cache is missing, stale, or written
+// by a different wabt build; the caller falls back to lowering the binary.
+static DefinedModule* TryReadModuleCache(Environment* env) {
+  FILE* f = fopen(s_cache_filename.c_str(), "rb");
+  if (!f) {
+    return nullptr;
+  }
+  fclose(f);
+
+  std::vector<uint8_t> file_data;
+  if (Failed(ReadFile(s_cache_filename.c_str(), &file_data))) {
+    return nullptr;
+  }
+
+  DefinedModule* module = nullptr;
+  if (Failed(ReadModuleCache(env, file_data.data(), file_data.size(),
+                             &module))) {
+    return nullptr;
+  }
+  return module;
+}
+
+static void TryWriteModuleCache(Environment* env,
+                                const Environment::MarkPoint& mark,
+                                const DefinedModule* module) {
+  MemoryStream stream;
+  if (Succeeded(WriteModuleCache(env, mark, module, &stream))) {
+    stream.output_buffer().WriteToFile(s_cache_filename);
+  }
+}
+
 static interp::Result PrintCallback(const HostFunc* func,
                                     const interp::FuncSignature* sig,
                                     const TypedValues& args,
@@ -203,20 +303,47 @@ static void InitEnvironment(Environment* env) {
 
 static wabt::Result ReadAndRunModule(const char* module_filename) {
   wabt::Result result;
+  // Declared before |env| so it outlives it; the environment's data segments
+  // reference the module image.
+  std::vector<uint8_t> file_data;
   Environment env(s_features);
+  env.set_use_guard_pages(s_use_guard_pages);
+  env.set_memory_policy(s_memory_policy);
   InitEnvironment(&env);
 
   Errors errors;
   DefinedModule* module = nullptr;
-  result = ReadModule(module_filename, &env, &errors, &module);
-  FormatErrorsToFile(errors, Location::Type::Binary);
+  Environment::MarkPoint mark = env.Mark();
+  if (!s_cache_filename.empty()) {
+    module = TryReadModuleCache(&env);
+  }
+  if (module) {
+    result = wabt::Result::Ok;
+  } else {
+    result = ReadModule(module_filename, &env, &errors, &module, &file_data);
+    FormatErrorsToFile(errors, Location::Type::Binary);
+    if (Succeeded(result) && !s_cache_filename.empty()) {
+      TryWriteModuleCache(&env, mark, module);
+    }
+  }
   if (Succeeded(result)) {
     Executor executor(&env, s_trace_stream, s_thread_options);
-    ExecResult exec_result = executor.Initialize(module);
+    ExecResult exec_result;
+    {
+      // Covers data/elem segment initialization and the start function.
+      TimedPhase timer("instantiate");
+      MemoryPhase mem_phase("instantiate");
+      exec_result = executor.Initialize(module);
+    }
     if (exec_result.ok()) {
       if (s_run_all_exports) {
+        TimedPhase timer("execute");
+        MemoryPhase mem_phase("execute");
         RunAllExports(module, &executor, RunVerbosity::Verbose);
       }
+      if (s_thread_options.enable_profiling) {
+        executor.DumpProfile(s_stdout_stream.get());
+      }
     } else {
       WriteResult(s_stdout_stream.get(), "error initialiazing module",
                   exec_result.result);
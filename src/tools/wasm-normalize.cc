@@ -0,0 +1,183 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Re-encodes a binary module in one process: ReadBinaryIr -> in-memory
+// Module -> WriteBinaryModule, replacing the wasm2wat | wat2wasm pipeline
+// that round-trips through text and a temp file. The output is wabt's
+// canonical encoding (minimal LEBs, no relocations, name section only on
+// request), so two modules that decode to the same IR normalize to the same
+// bytes. --wat additionally emits the text form from the already-decoded
+// module, without a second decode.
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "src/apply-names.h"
+#include "src/binary-reader.h"
+#include "src/binary-reader-ir.h"
+#include "src/binary-writer.h"
+#include "src/error-formatter.h"
+#include "src/feature.h"
+#include "src/filenames.h"
+#include "src/generate-names.h"
+#include "src/input-buffer.h"
+#include "src/ir.h"
+#include "src/option-parser.h"
+#include "src/stream.h"
+#include "src/validator.h"
+#include "src/wat-writer.h"
+
+using namespace wabt;
+
+static int s_verbose;
+static std::string s_infile;
+static std::string s_outfile;
+static std::string s_wat_outfile;
+static Features s_features;
+static WriteBinaryOptions s_write_binary_options;
+static WriteWatOptions s_write_wat_options;
+static bool s_generate_names;
+static bool s_read_debug_names = true;
+static bool s_validate = true;
+static std::unique_ptr<FileStream> s_log_stream;
+
+static const char s_description[] =
+R"(  Read a file in the WebAssembly binary format and re-encode it in
+  wabt's canonical binary encoding, without going through the text
+  format.
+
+examples:
+  # normalize test.wasm in place
+  $ wasm-normalize test.wasm -o test.wasm
+
+  # normalize, and also write the canonical text form
+  $ wasm-normalize test.wasm -o test.norm.wasm --wat test.wat
+)";
+
+static void ParseOptions(int argc, char** argv) {
+  OptionParser parser("wasm-normalize", s_description);
+
+  parser.AddOption('v', "verbose", "Use multiple times for more info", []() {
+    s_verbose++;
+    s_log_stream = FileStream::CreateStdout();
+  });
+  parser.AddOption(
+      'o', "output", "FILENAME",
+      "Output file for the normalized binary, by default use <input>.norm.wasm",
+      [](const char* argument) {
+        s_outfile = argument;
+        ConvertBackslashToSlash(&s_outfile);
+      });
+  parser.AddOption(
+      'w', "wat", "FILENAME",
+      "Also write the module in the text format to the given file",
+      [](const char* argument) {
+        s_wat_outfile = argument;
+        ConvertBackslashToSlash(&s_wat_outfile);
+      });
+  s_features.AddOptions(&parser);
+  parser.AddOption('f', "fold-exprs",
+                   "Write folded expressions in the text output",
+                   []() { s_write_wat_options.fold_exprs = true; });
+  parser.AddOption("debug-names",
+                   "Write debug names to the normalized binary",
+                   []() { s_write_binary_options.write_debug_names = true; });
+  parser.AddOption("no-debug-names", "Ignore debug names in the binary file",
+                   []() { s_read_debug_names = false; });
+  parser.AddOption(
+      "generate-names",
+      "Give auto-generated names to non-named functions, types, etc.",
+      []() { s_generate_names = true; });
+  parser.AddOption("no-check", "Don't check for invalid modules",
+                   []() { s_validate = false; });
+  parser.AddArgument("filename", OptionParser::ArgumentCount::One,
+                     [](const char* argument) {
+                       s_infile = argument;
+                       ConvertBackslashToSlash(&s_infile);
+                     });
+  parser.Parse(argc, argv);
+}
+
+static std::string DefaultOutputName(string_view input_name) {
+  std::string result(StripExtension(input_name));
+  result += ".norm.wasm";
+  return result;
+}
+
+int ProgramMain(int argc, char** argv) {
+  Result result;
+
+  InitStdio();
+  ParseOptions(argc, argv);
+
+  InputBuffer file_data;
+  result =
+      file_data.ReadFile(s_infile.c_str(), InputBuffer::LoadPolicy::Sequential);
+  if (Failed(result)) {
+    fprintf(stderr, "unable to read file: %s\n", s_infile.c_str());
+    return 1;
+  }
+
+  Errors errors;
+  Module module;
+  const bool kStopOnFirstError = true;
+  const bool kFailOnCustomSectionError = true;
+  ReadBinaryOptions options(s_features, s_log_stream.get(),
+                            s_read_debug_names, kStopOnFirstError,
+                            kFailOnCustomSectionError);
+  result = ReadBinaryIr(s_infile.c_str(), file_data.data(), file_data.size(),
+                        options, &errors, &module);
+
+  if (Succeeded(result) && s_validate) {
+    ValidateOptions validate_options(s_features);
+    result = ValidateModule(&module, &errors, validate_options);
+  }
+
+  if (Succeeded(result) && s_generate_names) {
+    result = GenerateNames(&module);
+    if (Succeeded(result)) {
+      result = ApplyNames(&module);
+    }
+  }
+
+  if (Succeeded(result)) {
+    // Stage the binary in memory so a failure doesn't clobber the output
+    // file, which may be the input being normalized in place.
+    MemoryStream stream(s_log_stream.get());
+    result = WriteBinaryModule(&stream, &module, s_write_binary_options);
+    if (Succeeded(result)) {
+      std::string outfile =
+          !s_outfile.empty() ? s_outfile : DefaultOutputName(s_infile);
+      result = stream.output_buffer().WriteToFile(outfile);
+    }
+  }
+
+  if (Succeeded(result) && !s_wat_outfile.empty()) {
+    FileStream wat_stream((string_view(s_wat_outfile)));
+    result = WriteWat(&wat_stream, &module, s_write_wat_options);
+  }
+
+  FormatErrorsToFile(errors, Location::Type::Binary);
+  return result != Result::Ok;
+}
+
+int main(int argc, char** argv) {
+  WABT_TRY
+  return ProgramMain(argc, argv);
+  WABT_CATCH_BAD_ALLOC_AND_EXIT
+}
@@ -19,6 +19,7 @@
 #include <cstring>
 
 #include "src/common.h"
+#include "src/input-buffer.h"
 #include "src/option-parser.h"
 #include "src/stream.h"
 #include "src/binary-reader.h"
@@ -60,6 +61,12 @@ static void ParseOptions(int argc, char** argv) {
                    []() { s_objdump_options.details = true; });
   parser.AddOption('r', "reloc", "Show relocations inline with disassembly",
                    []() { s_objdump_options.relocs = true; });
+  parser.AddOption("reloc-summary",
+                   "With --details, print one aggregated count per relocation "
+                   "type for each reloc section instead of every entry",
+                   []() { s_objdump_options.reloc_summary = true; });
+  parser.AddOption('C', "demangle", "Demangle C++ symbol names",
+                   []() { s_objdump_options.demangle = true; });
   parser.AddArgument(
       "filename", OptionParser::ArgumentCount::OneOrMore,
       [](const char* argument) { s_infiles.push_back(argument); });
@@ -68,10 +75,10 @@ static void ParseOptions(int argc, char** argv) {
 }
 
 Result dump_file(const char* filename) {
-  std::vector<uint8_t> file_data;
-  CHECK_RESULT(ReadFile(filename, &file_data));
+  InputBuffer file_data;
+  CHECK_RESULT(file_data.ReadFile(filename, InputBuffer::LoadPolicy::WillNeed));
 
-  uint8_t* data = file_data.data();
+  const uint8_t* data = file_data.data();
   size_t size = file_data.size();
 
   // Perform serveral passed over the binary in order to print out different
@@ -15,16 +15,19 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cerrno>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
+#include <thread>
 #include <vector>
 
 #include "src/binary-reader.h"
 #include "src/binary-reader-opcnt.h"
+#include "src/input-buffer.h"
 #include "src/option-parser.h"
 #include "src/stream.h"
 
@@ -34,22 +37,30 @@
 using namespace wabt;
 
 static int s_verbose;
-static const char* s_infile;
+static std::vector<const char*> s_infiles;
 static const char* s_outfile;
+static int s_num_threads = 1;
 static size_t s_cutoff = 0;
 static const char* s_separator = ": ";
+static bool s_pairs;
+static bool s_hotness;
+static const char* s_binary_outfile;
 
 static ReadBinaryOptions s_read_binary_options;
 static std::unique_ptr<FileStream> s_log_stream;
 static Features s_features;
 
 static const char s_description[] =
-R"(  Read a file in the wasm binary format, and count opcode usage for
-  instructions.
+R"(  Read files in the wasm binary format, and count opcode usage for
+  instructions. When more than one file is given, a single aggregate
+  report is written.
 
 examples:
   # parse binary file test.wasm and write pcode dist file test.dist
   $ wasm-opcodecnt test.wasm -o test.dist
+
+  # count a directory of modules on 8 threads
+  $ wasm-opcodecnt -j 8 corpus/*.wasm -o corpus.dist
 )";
 
 static void ParseOptions(int argc, char** argv) {
@@ -71,8 +82,27 @@ static void ParseOptions(int argc, char** argv) {
       's', "separator", "SEPARATOR",
       "Separator text between element and count when reporting counts",
       [](const char* argument) { s_separator = argument; });
+  parser.AddOption("pairs",
+                   "Also report consecutive opcode pair (digram) counts",
+                   []() { s_pairs = true; });
+  parser.AddOption("hotness", "Also report per-function opcode counts",
+                   []() { s_hotness = true; });
+  parser.AddOption(OptionParser::Option(
+      '\0', "binary-output", "FILENAME", OptionParser::HasArgument::Yes,
+      "Write the counts in a compact binary format for aggregation across "
+      "modules",
+      [](const char* argument) { s_binary_outfile = argument; }));
+  parser.AddOption('j', "jobs", "N",
+                   "Count input files on N threads (0 means one thread per "
+                   "processor)",
+                   [](const char* argument) {
+                     s_num_threads = atoi(argument);
+                     if (s_num_threads == 0) {
+                       s_num_threads = std::thread::hardware_concurrency();
+                     }
+                   });
   parser.AddArgument("filename", OptionParser::ArgumentCount::OneOrMore,
-                     [](const char* argument) { s_infile = argument; });
+                     [](const char* argument) { s_infiles.push_back(argument); });
   parser.Parse(argc, argv);
 }
 
@@ -148,33 +178,140 @@ void WriteCountsWithImmediates(Stream& stream,
   }
 }
 
-int ProgramMain(int argc, char** argv) {
-  InitStdio();
-  ParseOptions(argc, argv);
+void WritePairCounts(Stream& stream, const OpcodeStats& stats) {
+  typedef std::pair<std::pair<Opcode, Opcode>, size_t> PairCountPair;
+
+  std::vector<PairCountPair> sorted;
+  for (size_t first = 0; first < OpcodeStats::kNumSlots; ++first) {
+    for (size_t second = 0; second < OpcodeStats::kNumSlots; ++second) {
+      size_t count = stats.pair_counts[first * OpcodeStats::kNumSlots + second];
+      if (count != 0 && count >= s_cutoff) {
+        sorted.emplace_back(
+            std::make_pair(Opcode(static_cast<Opcode::Enum>(first)),
+                           Opcode(static_cast<Opcode::Enum>(second))),
+            count);
+      }
+    }
+  }
+
+  // Use a stable sort to keep the elements with the same count in opcode
+  // pair order.
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   SortByCountDescending<PairCountPair>());
+
+  for (auto& pair : sorted) {
+    stream.Writef("%s %s%s%" PRIzd "\n", pair.first.first.GetName(),
+                  pair.first.second.GetName(), s_separator, pair.second);
+  }
+}
+
+void WriteFuncCounts(Stream& stream, const OpcodeStats& stats) {
+  std::vector<OpcodeStats::FuncCount> sorted;
+  for (const OpcodeStats::FuncCount& func_count : stats.func_counts) {
+    if (func_count.count >= s_cutoff) {
+      sorted.push_back(func_count);
+    }
+  }
+
+  // Use a stable sort to keep the elements with the same count in function
+  // index order.
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const OpcodeStats::FuncCount& lhs,
+                      const OpcodeStats::FuncCount& rhs) {
+                     return lhs.count > rhs.count;
+                   });
 
-  std::vector<uint8_t> file_data;
-  Result result = ReadFile(s_infile, &file_data);
+  for (const OpcodeStats::FuncCount& func_count : sorted) {
+    stream.Writef("func[%" PRIindex "]%s%" PRIzd "\n", func_count.func_index,
+                  s_separator, func_count.count);
+  }
+}
+
+static Result CountFile(const char* filename,
+                        OpcodeInfoCounts* counts,
+                        OpcodeStats* stats) {
+  InputBuffer file_data;
+  Result result = file_data.ReadFile(filename, InputBuffer::LoadPolicy::Sequential);
   if (Failed(result)) {
-    const char* input_name = s_infile ? s_infile : "stdin";
-    ERROR("Unable to parse: %s", input_name);
-    return 1;
+    ERROR("Unable to parse: %s", filename);
+    return result;
   }
+  return ReadBinaryOpcnt(file_data.data(), file_data.size(),
+                         s_read_binary_options, counts, stats);
+}
+
+int ProgramMain(int argc, char** argv) {
+  InitStdio();
+  ParseOptions(argc, argv);
 
   FileStream stream(s_outfile ? FileStream(s_outfile) : FileStream(stdout));
 
+  OpcodeInfoCounts counts;
+  OpcodeStats stats;
+  bool need_stats = s_pairs || s_hotness || s_binary_outfile;
+  s_read_binary_options.features = s_features;
+  Result result = Result::Ok;
+  size_t num_threads = std::min<size_t>(s_num_threads, s_infiles.size());
+  if (num_threads > 1 && !s_read_binary_options.log_stream) {
+    // Each worker pulls files off a shared index and counts them into its
+    // own tables, so the hot counting path takes no locks; the per-thread
+    // tables are merged below. Files are mmap'd by InputBuffer, so workers
+    // share page cache instead of each allocating a copy of their input.
+    std::atomic<size_t> next_file{0};
+    std::vector<OpcodeInfoCounts> thread_counts(num_threads);
+    std::vector<OpcodeStats> thread_stats(num_threads);
+    std::vector<Result> thread_results(num_threads, Result::Ok);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&, i]() {
+        while (true) {
+          size_t next = next_file.fetch_add(1, std::memory_order_relaxed);
+          if (next >= s_infiles.size()) {
+            break;
+          }
+          thread_results[i] |=
+              CountFile(s_infiles[next], &thread_counts[i],
+                        need_stats ? &thread_stats[i] : nullptr);
+        }
+      });
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads[i].join();
+      result |= thread_results[i];
+      for (auto& info_count_pair : thread_counts[i]) {
+        counts[info_count_pair.first] += info_count_pair.second;
+      }
+      if (need_stats) {
+        stats.Merge(thread_stats[i]);
+      }
+    }
+  } else {
+    for (const char* infile : s_infiles) {
+      result |= CountFile(infile, &counts, need_stats ? &stats : nullptr);
+    }
+  }
   if (Succeeded(result)) {
-    OpcodeInfoCounts counts;
-    s_read_binary_options.features = s_features;
-    result = ReadBinaryOpcnt(file_data.data(), file_data.size(),
-                             s_read_binary_options, &counts);
-    if (Succeeded(result)) {
-      stream.Writef("Total opcodes: %" PRIzd "\n\n", SumCounts(counts));
-
-      stream.Writef("Opcode counts:\n");
-      WriteCounts(stream, counts);
-
-      stream.Writef("\nOpcode counts with immediates:\n");
-      WriteCountsWithImmediates(stream, counts);
+    stream.Writef("Total opcodes: %" PRIzd "\n\n", SumCounts(counts));
+
+    stream.Writef("Opcode counts:\n");
+    WriteCounts(stream, counts);
+
+    stream.Writef("\nOpcode counts with immediates:\n");
+    WriteCountsWithImmediates(stream, counts);
+
+    if (s_pairs) {
+      stream.Writef("\nOpcode pair counts:\n");
+      WritePairCounts(stream, stats);
+    }
+
+    if (s_hotness) {
+      stream.Writef("\nFunction opcode counts:\n");
+      WriteFuncCounts(stream, stats);
+    }
+
+    if (s_binary_outfile) {
+      FileStream binary_stream(s_binary_outfile);
+      stats.WriteBinary(binary_stream);
     }
   }
 
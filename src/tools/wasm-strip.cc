@@ -14,10 +14,12 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <vector>
+
 #include "src/binary.h"
-#include "src/binary-reader.h"
-#include "src/binary-reader-nop.h"
 #include "src/error-formatter.h"
+#include "src/input-buffer.h"
 #include "src/leb128.h"
 #include "src/option-parser.h"
 #include "src/stream.h"
@@ -45,39 +47,71 @@ static void ParseOptions(int argc, char** argv) {
   parser.Parse(argc, argv);
 }
 
-class BinaryReaderStrip : public BinaryReaderNop {
- public:
-  explicit BinaryReaderStrip(Errors* errors)
-      : errors_(errors) {
-    stream_.WriteU32(WABT_BINARY_MAGIC, "WASM_BINARY_MAGIC");
-    stream_.WriteU32(WABT_BINARY_VERSION, "WASM_BINARY_VERSION");
-  }
+// One top-level section of the input. Stripping only needs the section
+// framing, never the contents, so the input isn't decoded beyond this table.
+// |start| is the offset of the section code byte and |end| is one past the
+// payload, i.e. the byte range to copy when the section is kept.
+struct SectionRange {
+  BinarySection type;
+  Offset start;
+  Offset end;
+};
 
-  bool OnError(const Error& error) override {
-    errors_->push_back(error);
-    return true;
-  }
+static void PushError(Errors* errors, Offset offset, std::string message) {
+  errors->emplace_back(ErrorLevel::Error, Location(offset),
+                       std::move(message));
+}
 
-  Result BeginSection(Index section_index,
-                      BinarySection section_type,
-                      Offset size) override {
-    if (section_type == BinarySection::Custom) {
-      return Result::Ok;
-    }
-    stream_.WriteU8Enum(section_type, "section code");
-    WriteU32Leb128(&stream_, size, "section size");
-    stream_.WriteData(state->data + state->offset, size, "section data");
-    return Result::Ok;
+static Result ReadSectionTable(const uint8_t* data,
+                               size_t size,
+                               std::vector<SectionRange>* out_sections,
+                               Errors* errors) {
+  if (size < 8) {
+    PushError(errors, 0, "unable to read header");
+    return Result::Error;
   }
-
-  Result WriteToFile(string_view filename) {
-    return stream_.WriteToFile(filename);
+  uint32_t magic;
+  uint32_t version;
+  memcpy(&magic, data, sizeof(magic));
+  memcpy(&version, data + 4, sizeof(version));
+  if (magic != WABT_BINARY_MAGIC) {
+    PushError(errors, 0, "bad magic value");
+    return Result::Error;
+  }
+  if (version != WABT_BINARY_VERSION) {
+    PushError(errors, 4,
+              StringPrintf("bad wasm file version: %#x (expected %#x)",
+                           version, WABT_BINARY_VERSION));
+    return Result::Error;
   }
 
- private:
-  MemoryStream stream_;
-  Errors* errors_;
-};
+  Offset offset = 8;
+  while (offset < size) {
+    Offset section_start = offset;
+    uint8_t section_code = data[offset++];
+    if (section_code > static_cast<uint8_t>(BinarySection::Last)) {
+      PushError(errors, section_start,
+                StringPrintf("invalid section code: %u", section_code));
+      return Result::Error;
+    }
+    uint32_t section_size;
+    size_t leb_size =
+        ReadU32Leb128(data + offset, data + size, &section_size);
+    if (leb_size == 0) {
+      PushError(errors, offset, "unable to read section size");
+      return Result::Error;
+    }
+    offset += leb_size;
+    if (section_size > size - offset) {
+      PushError(errors, offset, "invalid section size: extends past end");
+      return Result::Error;
+    }
+    offset += section_size;
+    out_sections->push_back(
+        {static_cast<BinarySection>(section_code), section_start, offset});
+  }
+  return Result::Ok;
+}
 
 int ProgramMain(int argc, char** argv) {
   Result result;
@@ -85,25 +119,59 @@ int ProgramMain(int argc, char** argv) {
   InitStdio();
   ParseOptions(argc, argv);
 
-  std::vector<uint8_t> file_data;
-  result = ReadFile(s_filename.c_str(), &file_data);
-  if (Succeeded(result)) {
-    Errors errors;
-    Features features;
-    const bool kReadDebugNames = false;
-    const bool kStopOnFirstError = true;
-    const bool kFailOnCustomSectionError = false;
-    ReadBinaryOptions options(features, nullptr, kReadDebugNames,
-                              kStopOnFirstError, kFailOnCustomSectionError);
-
-    BinaryReaderStrip reader(&errors);
-    result = ReadBinary(file_data.data(), file_data.size(), &reader, options);
-    FormatErrorsToFile(errors, Location::Type::Binary);
-
-    if (Succeeded(result)) {
-      result = reader.WriteToFile(s_filename);
+  InputBuffer file_data;
+  result = file_data.ReadFile(s_filename.c_str(),
+                              InputBuffer::LoadPolicy::Sequential);
+  if (Failed(result)) {
+    fprintf(stderr, "unable to read file: %s\n", s_filename.c_str());
+    return 1;
+  }
+
+  Errors errors;
+  std::vector<SectionRange> sections;
+  result =
+      ReadSectionTable(file_data.data(), file_data.size(), &sections, &errors);
+  FormatErrorsToFile(errors, Location::Type::Binary);
+  if (Failed(result)) {
+    return 1;
+  }
+
+  bool has_custom_section = false;
+  for (const SectionRange& section : sections) {
+    if (section.type == BinarySection::Custom) {
+      has_custom_section = true;
+      break;
     }
   }
+  if (!has_custom_section) {
+    // Nothing to strip; leave the file untouched.
+    return 0;
+  }
+
+  // Compose the output from the header plus the kept sections, coalescing
+  // adjacent sections so each run of kept bytes is copied with one write.
+  // The output has to be staged in memory because the input is mapped from
+  // the very file being rewritten.
+  MemoryStream stream;
+  Offset run_start = 0;
+  Offset run_end = 8;  // The magic and version are always kept.
+  for (const SectionRange& section : sections) {
+    if (section.type == BinarySection::Custom) {
+      continue;
+    }
+    if (section.start == run_end) {
+      run_end = section.end;
+      continue;
+    }
+    stream.WriteData(file_data.data() + run_start, run_end - run_start,
+                     "kept sections");
+    run_start = section.start;
+    run_end = section.end;
+  }
+  stream.WriteData(file_data.data() + run_start, run_end - run_start,
+                   "kept sections");
+
+  result = stream.WriteToFile(s_filename);
   return result != Result::Ok;
 }
 
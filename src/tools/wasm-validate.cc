@@ -18,10 +18,22 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 #include "src/binary-reader.h"
 #include "src/binary-reader-ir.h"
 #include "src/error-formatter.h"
+#include "src/input-buffer.h"
 #include "src/ir.h"
 #include "src/option-parser.h"
 #include "src/stream.h"
@@ -35,6 +47,9 @@ static std::string s_infile;
 static Features s_features;
 static bool s_read_debug_names = true;
 static bool s_fail_on_custom_section_error = true;
+static bool s_streaming = false;
+static bool s_daemon = false;
+static int s_num_threads = 1;
 static std::unique_ptr<FileStream> s_log_stream;
 
 static const char s_description[] =
@@ -43,6 +58,12 @@ R"(  Read a file in the WebAssembly binary format, and validate it.
 examples:
   # validate binary file test.wasm
   $ wasm-validate test.wasm
+
+  # validate holding one function body in memory at a time
+  $ wasm-validate --streaming test.wasm
+
+  # validate modules sent over a unix socket, without a process per module
+  $ wasm-validate --daemon /tmp/wasm-validate.sock
 )";
 
 static void ParseOptions(int argc, char** argv) {
@@ -58,6 +79,25 @@ static void ParseOptions(int argc, char** argv) {
   parser.AddOption("ignore-custom-section-errors",
                    "Ignore errors in custom sections",
                    []() { s_fail_on_custom_section_error = false; });
+  parser.AddOption(
+      "streaming",
+      "Decode and check one function body at a time, so peak memory is "
+      "bounded by the largest function instead of the whole code section",
+      []() { s_streaming = true; });
+  parser.AddOption('j', "jobs", "N",
+                   "Validate function bodies on N threads (0 means one thread "
+                   "per processor)",
+                   [](const char* argument) {
+                     s_num_threads = atoi(argument);
+                     if (s_num_threads == 0) {
+                       s_num_threads = std::thread::hardware_concurrency();
+                     }
+                   });
+  parser.AddOption(
+      "daemon",
+      "Stay resident and validate modules received over a unix socket "
+      "instead of reading a file; FILENAME is the socket path to listen on",
+      []() { s_daemon = true; });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) {
                        s_infile = argument;
@@ -66,27 +106,179 @@ static void ParseOptions(int argc, char** argv) {
   parser.Parse(argc, argv);
 }
 
+static Result ValidateBuffer(const char* name,
+                             const void* data,
+                             size_t size,
+                             Errors* errors) {
+  Result result;
+  Module module;
+  const bool kStopOnFirstError = true;
+  ReadBinaryOptions options(s_features, s_log_stream.get(),
+                            s_read_debug_names, kStopOnFirstError,
+                            s_fail_on_custom_section_error);
+  if (s_streaming) {
+    // Read the module skeleton only, then decode, check, and release each
+    // function body in turn. Body decode errors are reported along with
+    // that function's validation errors instead of before all validation.
+    LazyFuncBodies lazy_bodies;
+    result = ReadBinaryIrLazy(name, data, size, options, errors, &module,
+                              &lazy_bodies);
+    if (Succeeded(result)) {
+      ValidateOptions options(s_features);
+      options.num_threads = s_num_threads;
+      result = ValidateLazyModule(&module, &lazy_bodies, errors, options);
+    }
+  } else {
+    result = ReadBinaryIr(name, data, size, options, errors, &module);
+    if (Succeeded(result)) {
+      ValidateOptions options(s_features);
+      options.num_threads = s_num_threads;
+      result = ValidateModule(&module, errors, options);
+    }
+  }
+  return result;
+}
+
+#ifndef _WIN32
+
+static bool ReadFull(int fd, void* data, size_t size) {
+  char* p = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = read(fd, p, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool WriteFull(int fd, const void* data, size_t size) {
+  const char* p = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = write(fd, p, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Frames are not larger than this; a bigger length means the client is
+// confused (or not speaking the protocol), so the connection is dropped
+// rather than allocating whatever the length field happens to say.
+static const uint32_t kMaxDaemonModuleSize = 1u << 30;
+
+// Serve validation requests over a unix socket until killed. Requests and
+// replies use the same framing: a 32-bit length in host byte order followed
+// by that many bytes. The client sends one frame per module; the reply
+// payload is a one-byte verdict (0 = valid, 1 = invalid) followed by the
+// formatted error text. A connection handles any number of modules, so the
+// process, feature configuration, and the allocator's warmed-up pools are
+// shared across validations instead of paying process startup per module.
+static int RunDaemon(const std::string& socket_path) {
+  // A reply to a client that hung up must not kill the daemon.
+  signal(SIGPIPE, SIG_IGN);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    perror("socket");
+    return 1;
+  }
+
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "socket path too long: %s\n", socket_path.c_str());
+    close(listen_fd);
+    return 1;
+  }
+  memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+
+  // Replace any socket left behind by a previous instance.
+  unlink(socket_path.c_str());
+  if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      listen(listen_fd, 8) < 0) {
+    perror(socket_path.c_str());
+    close(listen_fd);
+    return 1;
+  }
+
+  std::vector<uint8_t> module_data;
+  for (;;) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("accept");
+      break;
+    }
+
+    uint32_t size;
+    while (ReadFull(fd, &size, sizeof(size))) {
+      if (size > kMaxDaemonModuleSize) {
+        break;
+      }
+      module_data.resize(size);
+      if (!ReadFull(fd, module_data.data(), size)) {
+        break;
+      }
+
+      Errors errors;
+      Result result =
+          ValidateBuffer("<socket>", module_data.data(), size, &errors);
+      std::string text = FormatErrorsToString(errors, Location::Type::Binary);
+      uint32_t reply_size = 1 + static_cast<uint32_t>(text.size());
+      uint8_t verdict = result != Result::Ok;
+      if (!WriteFull(fd, &reply_size, sizeof(reply_size)) ||
+          !WriteFull(fd, &verdict, sizeof(verdict)) ||
+          !WriteFull(fd, text.data(), text.size())) {
+        break;
+      }
+    }
+    close(fd);
+  }
+
+  close(listen_fd);
+  unlink(socket_path.c_str());
+  return 1;
+}
+
+#endif /* !_WIN32 */
+
 int ProgramMain(int argc, char** argv) {
   Result result;
 
   InitStdio();
   ParseOptions(argc, argv);
 
-  std::vector<uint8_t> file_data;
-  result = ReadFile(s_infile.c_str(), &file_data);
+  if (s_daemon) {
+#ifndef _WIN32
+    return RunDaemon(s_infile);
+#else
+    fprintf(stderr, "--daemon is not supported on Windows.\n");
+    return 1;
+#endif
+  }
+
+  InputBuffer file_data;
+  result = file_data.ReadFile(s_infile.c_str(),
+                              InputBuffer::LoadPolicy::Sequential);
   if (Succeeded(result)) {
     Errors errors;
-    Module module;
-    const bool kStopOnFirstError = true;
-    ReadBinaryOptions options(s_features, s_log_stream.get(),
-                              s_read_debug_names, kStopOnFirstError,
-                              s_fail_on_custom_section_error);
-    result = ReadBinaryIr(s_infile.c_str(), file_data.data(), file_data.size(),
-                          options, &errors, &module);
-    if (Succeeded(result)) {
-      ValidateOptions options(s_features);
-      result = ValidateModule(&module, &errors, options);
-    }
+    result = ValidateBuffer(s_infile.c_str(), file_data.data(),
+                            file_data.size(), &errors);
     FormatErrorsToFile(errors, Location::Type::Binary);
   }
   return result != Result::Ok;
@@ -39,8 +39,10 @@ static int s_verbose;
 static std::string s_infile;
 static std::string s_outfile;
 static Features s_features;
+static int s_num_outputs = 1;
 static WriteCOptions s_write_c_options;
 static bool s_read_debug_names = true;
+static bool s_incremental = false;
 static std::unique_ptr<FileStream> s_log_stream;
 
 static const char s_description[] =
@@ -70,8 +72,30 @@ static void ParseOptions(int argc, char** argv) {
         ConvertBackslashToSlash(&s_outfile);
       });
   s_features.AddOptions(&parser);
+  parser.AddOption(OptionParser::Option(
+      '\0', "num-outputs", "N", OptionParser::HasArgument::Yes,
+      "Shard the functions across N C files (out.c, out_1.c, ...), written "
+      "in parallel; requires --output",
+      [](const char* argument) { s_num_outputs = atoi(argument); }));
   parser.AddOption("no-debug-names", "Ignore debug names in the binary file",
                    []() { s_read_debug_names = false; });
+  parser.AddOption(
+      "devirtualize",
+      "Resolve call_indirect targets at generation time into a switch of "
+      "direct calls when the function table is never mutated (no table "
+      "imports or exports, constant element offsets)",
+      []() { s_write_c_options.devirtualize_indirect_calls = true; });
+  parser.AddOption(
+      "computed-goto-br-table",
+      "Lower br_table to a computed goto through a static table of label "
+      "addresses instead of a C switch (requires GCC/Clang labels-as-values)",
+      []() { s_write_c_options.computed_goto_br_table = true; });
+  parser.AddOption(
+      "incremental",
+      "Generate into memory and only rewrite output files whose contents "
+      "changed, so unchanged outputs keep their timestamps and the build "
+      "system skips recompiling them (most useful with --num-outputs)",
+      []() { s_incremental = true; });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) {
                        s_infile = argument;
@@ -91,6 +115,15 @@ static void ParseOptions(int argc, char** argv) {
     fprintf(stderr, "wasm2c currently support only default feature flags.\n");
     exit(1);
   }
+
+  if (s_num_outputs < 1) {
+    fprintf(stderr, "--num-outputs must be at least 1.\n");
+    exit(1);
+  }
+  if (s_num_outputs > 1 && s_outfile.empty()) {
+    fprintf(stderr, "--num-outputs requires --output.\n");
+    exit(1);
+  }
 }
 
 // TODO(binji): copied from binary-writer-spec.cc, probably should share.
@@ -103,6 +136,38 @@ static string_view strip_extension(string_view s) {
   return result;
 }
 
+// Returns true iff |filename| already holds exactly |data|.
+static bool FileHasContents(const std::string& filename,
+                            const std::vector<uint8_t>& data) {
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+  bool equal = fseek(file, 0, SEEK_END) == 0 &&
+               ftell(file) == static_cast<long>(data.size());
+  if (equal && !data.empty()) {
+    std::vector<uint8_t> existing(data.size());
+    equal = fseek(file, 0, SEEK_SET) == 0 &&
+            fread(existing.data(), data.size(), 1, file) == 1 &&
+            existing == data;
+  }
+  fclose(file);
+  return equal;
+}
+
+// Writes |buffer| to |filename|, but leaves the file untouched when it
+// already has these contents, so its timestamp is preserved and the build
+// system skips recompiling it.
+static Result WriteFileIfChanged(const std::string& filename,
+                                 const OutputBuffer& buffer) {
+  if (FileHasContents(filename, buffer.data)) {
+    return Result::Ok;
+  }
+  FileStream stream(filename);
+  stream.WriteData(buffer.data.data(), buffer.data.size(), "output");
+  return stream.result();
+}
+
 int ProgramMain(int argc, char** argv) {
   Result result;
 
@@ -137,12 +202,45 @@ int ProgramMain(int argc, char** argv) {
 
       if (Succeeded(result)) {
         if (!s_outfile.empty()) {
-          std::string header_name =
-              strip_extension(s_outfile).to_string() + ".h";
-          FileStream c_stream(s_outfile.c_str());
-          FileStream h_stream(header_name);
-          result = WriteC(&c_stream, &h_stream, header_name.c_str(), &module,
-                          s_write_c_options);
+          std::string basename = strip_extension(s_outfile).to_string();
+          std::string header_name = basename + ".h";
+          std::vector<std::string> c_names;
+          for (int i = 0; i < s_num_outputs; ++i) {
+            c_names.push_back(i == 0 ? s_outfile
+                                     : basename + "_" + std::to_string(i) +
+                                           ".c");
+          }
+          if (s_incremental) {
+            std::vector<std::unique_ptr<MemoryStream>> c_streams;
+            std::vector<Stream*> c_stream_ptrs;
+            for (int i = 0; i < s_num_outputs; ++i) {
+              c_streams.emplace_back(new MemoryStream());
+              c_stream_ptrs.push_back(c_streams.back().get());
+            }
+            MemoryStream h_stream;
+            result = WriteCSharded(c_stream_ptrs, &h_stream,
+                                   header_name.c_str(), &module,
+                                   s_write_c_options);
+            if (Succeeded(result)) {
+              result |=
+                  WriteFileIfChanged(header_name, h_stream.output_buffer());
+              for (int i = 0; i < s_num_outputs; ++i) {
+                result |= WriteFileIfChanged(c_names[i],
+                                             c_streams[i]->output_buffer());
+              }
+            }
+          } else {
+            std::vector<std::unique_ptr<FileStream>> c_streams;
+            std::vector<Stream*> c_stream_ptrs;
+            for (int i = 0; i < s_num_outputs; ++i) {
+              c_streams.emplace_back(new FileStream(c_names[i]));
+              c_stream_ptrs.push_back(c_streams.back().get());
+            }
+            FileStream h_stream(header_name);
+            result = WriteCSharded(c_stream_ptrs, &h_stream,
+                                   header_name.c_str(), &module,
+                                   s_write_c_options);
+          }
         } else {
           FileStream stream(stdout);
           result =
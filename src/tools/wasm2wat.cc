@@ -14,19 +14,27 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "src/apply-names.h"
 #include "src/binary-reader.h"
 #include "src/binary-reader-ir.h"
 #include "src/error-formatter.h"
 #include "src/feature.h"
+#include "src/filenames.h"
 #include "src/generate-names.h"
+#include "src/input-buffer.h"
 #include "src/ir.h"
 #include "src/option-parser.h"
+#include "src/response-file.h"
 #include "src/stream.h"
 #include "src/validator.h"
 #include "src/wast-lexer.h"
@@ -44,6 +52,10 @@ static bool s_read_debug_names = true;
 static bool s_fail_on_custom_section_error = true;
 static std::unique_ptr<FileStream> s_log_stream;
 static bool s_validate = true;
+static int s_num_threads = 1;
+
+// Serializes stderr output when batch workers run concurrently.
+static std::mutex s_output_mutex;
 
 static const char s_description[] =
 R"(  Read a file in the WebAssembly binary format, and convert it to
@@ -55,6 +67,10 @@ examples:
 
   # parse test.wasm, write test.wat, but ignore the debug names, if any
   $ wasm2wat test.wasm --no-debug-names -o test.wat
+
+  # convert every file listed in files.rsp ("input [output]" per line,
+  # '#' comments) in one process
+  $ wasm2wat @files.rsp -j 8
 )";
 
 static void ParseOptions(int argc, char** argv) {
@@ -87,6 +103,16 @@ static void ParseOptions(int argc, char** argv) {
       "generate-names",
       "Give auto-generated names to non-named functions, types, etc.",
       []() { s_generate_names = true; });
+  parser.AddOption('j', "jobs", "N",
+                   "Decode and write function bodies on N threads; in batch "
+                   "mode (@response-file), convert entries on N threads "
+                   "instead (0 means one thread per processor)",
+                   [](const char* argument) {
+                     s_num_threads = atoi(argument);
+                     if (s_num_threads == 0) {
+                       s_num_threads = std::thread::hardware_concurrency();
+                     }
+                   });
   parser.AddOption("no-check", "Don't check for invalid modules",
                    []() { s_validate = false; });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
@@ -97,14 +123,17 @@ static void ParseOptions(int argc, char** argv) {
   parser.Parse(argc, argv);
 }
 
-int ProgramMain(int argc, char** argv) {
+// Converts one file; an empty |outfile| writes to stdout. |num_threads| is
+// the thread count used to decode and write function bodies (1 when batch
+// workers already saturate the processors).
+static Result ConvertFile(const std::string& infile,
+                          const std::string& outfile,
+                          int num_threads) {
   Result result;
 
-  InitStdio();
-  ParseOptions(argc, argv);
-
-  std::vector<uint8_t> file_data;
-  result = ReadFile(s_infile.c_str(), &file_data);
+  InputBuffer file_data;
+  result = file_data.ReadFile(infile.c_str(),
+                              InputBuffer::LoadPolicy::Sequential);
   if (Succeeded(result)) {
     Errors errors;
     Module module;
@@ -112,7 +141,8 @@ int ProgramMain(int argc, char** argv) {
     ReadBinaryOptions options(s_features, s_log_stream.get(),
                               s_read_debug_names, kStopOnFirstError,
                               s_fail_on_custom_section_error);
-    result = ReadBinaryIr(s_infile.c_str(), file_data.data(), file_data.size(),
+    options.num_threads = num_threads;
+    result = ReadBinaryIr(infile.c_str(), file_data.data(), file_data.size(),
                           options, &errors, &module);
     if (Succeeded(result)) {
       if (Succeeded(result) && s_validate) {
@@ -132,14 +162,75 @@ int ProgramMain(int argc, char** argv) {
       }
 
       if (Succeeded(result)) {
-        FileStream stream(!s_outfile.empty() ? FileStream(s_outfile)
-                                             : FileStream(stdout));
-        result = WriteWat(&stream, &module, s_write_wat_options);
+        FileStream stream(!outfile.empty() ? FileStream(outfile)
+                                           : FileStream(stdout));
+        WriteWatOptions wat_options = s_write_wat_options;
+        wat_options.num_threads = num_threads;
+        result = WriteWat(&stream, &module, wat_options);
       }
     }
-    FormatErrorsToFile(errors, Location::Type::Binary);
+    if (!errors.empty()) {
+      std::lock_guard<std::mutex> lock(s_output_mutex);
+      FormatErrorsToFile(errors, Location::Type::Binary);
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    fprintf(stderr, "unable to read file: %s\n", infile.c_str());
   }
-  return result != Result::Ok;
+  return result;
+}
+
+// Unlike the single-file default (stdout), batch entries default to a .wat
+// file named after the input.
+static std::string DefaultBatchOutputName(string_view input_name) {
+  return StripExtension(GetBasename(input_name)).to_string() + kWatExtension;
+}
+
+static int RunBatch(const char* response_filename) {
+  std::vector<BatchEntry> entries =
+      ReadResponseFile(response_filename, DefaultBatchOutputName);
+
+  std::atomic<size_t> next_entry(0);
+  std::atomic<int> num_failed(0);
+  auto worker = [&]() {
+    for (;;) {
+      size_t i = next_entry.fetch_add(1, std::memory_order_relaxed);
+      if (i >= entries.size()) {
+        break;
+      }
+      if (Failed(ConvertFile(entries[i].infile, entries[i].outfile, 1))) {
+        num_failed.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  int num_threads = static_cast<int>(
+      std::min(static_cast<size_t>(s_num_threads), entries.size()));
+  if (num_threads <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+  return num_failed != 0;
+}
+
+int ProgramMain(int argc, char** argv) {
+  InitStdio();
+  ParseOptions(argc, argv);
+
+  // "@file" names a response file whose entries are all converted in this
+  // process, saving per-process startup when converting many modules.
+  if (!s_infile.empty() && s_infile[0] == '@') {
+    return RunBatch(s_infile.c_str() + 1);
+  }
+
+  return ConvertFile(s_infile, s_outfile, s_num_threads) != Result::Ok;
 }
 
 int main(int argc, char** argv) {
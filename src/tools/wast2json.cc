@@ -14,12 +14,14 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
 #include <cstdio>
 #include <string>
+#include <thread>
 
 #include "config.h"
 
@@ -83,6 +85,16 @@ static void ParseOptions(int argc, char* argv[]) {
                    []() { s_write_binary_options.write_debug_names = true; });
   parser.AddOption("no-check", "Don't check for invalid modules",
                    []() { s_validate = false; });
+  parser.AddOption('j', "jobs", "N",
+                   "Serialize modules and write their files on N threads (0 "
+                   "means one thread per processor)",
+                   [](const char* argument) {
+                     s_write_binary_options.num_threads = atoi(argument);
+                     if (s_write_binary_options.num_threads == 0) {
+                       s_write_binary_options.num_threads =
+                           std::thread::hardware_concurrency();
+                     }
+                   });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) { s_infile = argument; });
 
@@ -130,15 +142,38 @@ int ProgramMain(int argc, char** argv) {
         json_stream.WriteToFile(s_outfile);
       }
 
-      for (auto iter = module_streams.begin(); iter != module_streams.end();
-           ++iter) {
-        iter->stream->WriteToFile(iter->filename);
+      size_t num_threads = std::min<size_t>(
+          s_write_binary_options.num_threads, module_streams.size());
+      if (num_threads > 1) {
+        // Each stream writes to its own file, so the writes are independent;
+        // overlap them so the job isn't serialized on file I/O.
+        size_t files_per_thread =
+            (module_streams.size() + num_threads - 1) / num_threads;
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i) {
+          size_t begin = i * files_per_thread;
+          size_t end =
+              std::min(begin + files_per_thread, module_streams.size());
+          threads.emplace_back([&, begin, end]() {
+            for (size_t j = begin; j < end; ++j) {
+              module_streams[j].stream->WriteToFile(
+                  module_streams[j].filename);
+            }
+          });
+        }
+        for (std::thread& thread : threads) {
+          thread.join();
+        }
+      } else {
+        for (auto iter = module_streams.begin(); iter != module_streams.end();
+             ++iter) {
+          iter->stream->WriteToFile(iter->filename);
+        }
       }
     }
   }
 
-  auto line_finder = lexer->MakeLineFinder();
-  FormatErrorsToFile(errors, Location::Type::Text, line_finder.get());
+  FormatErrorsToFile(errors, Location::Type::Text, lexer->line_finder());
 
   return result != Result::Ok;
 }
@@ -97,8 +97,7 @@ int ProgramMain(int argc, char** argv) {
   std::unique_ptr<Script> script;
   WastParseOptions parse_wast_options(s_features);
   result = ParseWastScript(lexer.get(), &script, &errors, &parse_wast_options);
-  auto line_finder = lexer->MakeLineFinder();
-  FormatErrorsToFile(errors, Location::Type::Text);
+  FormatErrorsToFile(errors, Location::Type::Text, lexer->line_finder());
 
   if (Succeeded(result)) {
     Module* module = script->GetFirstModule();
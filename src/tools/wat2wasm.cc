@@ -14,24 +14,33 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
 #include <cstdio>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "config.h"
 
 #include "src/binary-writer.h"
 #include "src/common.h"
+#include "src/dedupe-func-types.h"
 #include "src/error-formatter.h"
 #include "src/feature.h"
 #include "src/filenames.h"
 #include "src/ir.h"
+#include "src/memory-stats.h"
 #include "src/option-parser.h"
 #include "src/resolve-names.h"
+#include "src/response-file.h"
 #include "src/stream.h"
+#include "src/timing.h"
 #include "src/validator.h"
 #include "src/wast-parser.h"
 
@@ -43,10 +52,18 @@ static bool s_dump_module;
 static int s_verbose;
 static WriteBinaryOptions s_write_binary_options;
 static bool s_validate = true;
+static bool s_streaming = false;
+static bool s_pipeline = false;
+static bool s_dedupe_types = false;
 static bool s_debug_parsing;
 static Features s_features;
+static int s_num_threads = 1;
 
 static std::unique_ptr<FileStream> s_log_stream;
+static std::unique_ptr<FileStream> s_timing_stream;
+
+// Serializes stderr/stdout output when batch workers run concurrently.
+static std::mutex s_output_mutex;
 
 static const char s_description[] =
 R"(  read a file in the wasm text format, check it for errors, and
@@ -62,6 +79,10 @@ examples:
   # parse spec-test.wast, and write verbose output to stdout (including
   # the meaning of every byte)
   $ wat2wasm spec-test.wast -v
+
+  # compile every file listed in files.rsp ("input [output]" per line,
+  # '#' comments) in one process
+  $ wat2wasm @files.rsp -j 8
 )";
 
 static void ParseOptions(int argc, char* argv[]) {
@@ -90,8 +111,58 @@ static void ParseOptions(int argc, char* argv[]) {
   parser.AddOption("debug-names",
                    "Write debug names to the generated binary file",
                    []() { s_write_binary_options.write_debug_names = true; });
+  parser.AddOption("streaming",
+                   "Write the output file directly in two passes instead of "
+                   "buffering it in memory",
+                   []() { s_streaming = true; });
+  parser.AddOption("dedupe-types",
+                   "Merge type entries with identical signatures and rewrite "
+                   "their uses, shrinking the output's type section",
+                   []() { s_dedupe_types = true; });
+  parser.AddOption("pipeline",
+                   "Validate on a second thread while the binary is written; "
+                   "the output file is only committed if validation succeeds",
+                   []() { s_pipeline = true; });
   parser.AddOption("no-check", "Don't check for invalid modules",
                    []() { s_validate = false; });
+  parser.AddOption("timing",
+                   "Print the time spent in each phase (read, parse, "
+                   "validate, write) to stdout",
+                   []() {
+                     s_timing_stream = FileStream::CreateStdout();
+                     TimingSink sink =
+                         MakeStreamTimingSink(s_timing_stream.get());
+                     // Batch workers finish phases concurrently.
+                     SetTimingSink([sink](const char* phase, double ms) {
+                       std::lock_guard<std::mutex> lock(s_output_mutex);
+                       sink(phase, ms);
+                     });
+                   });
+  parser.AddOption("mem-stats",
+                   "Print allocation counts and peak memory for each phase "
+                   "(read, parse, validate, write) to stdout",
+                   []() {
+                     if (!s_timing_stream) {
+                       s_timing_stream = FileStream::CreateStdout();
+                     }
+                     MemoryStatsSink sink =
+                         MakeStreamMemoryStatsSink(s_timing_stream.get());
+                     // Batch workers finish phases concurrently.
+                     SetMemoryStatsSink([sink](const char* phase,
+                                               const MemoryPhaseStats& stats) {
+                       std::lock_guard<std::mutex> lock(s_output_mutex);
+                       sink(phase, stats);
+                     });
+                   });
+  parser.AddOption('j', "jobs", "N",
+                   "Compile batch (@response-file) entries on N threads (0 "
+                   "means one thread per processor)",
+                   [](const char* argument) {
+                     s_num_threads = atoi(argument);
+                     if (s_num_threads == 0) {
+                       s_num_threads = std::thread::hardware_concurrency();
+                     }
+                   });
   parser.AddArgument("filename", OptionParser::ArgumentCount::One,
                      [](const char* argument) { s_infile = argument; });
 
@@ -101,6 +172,7 @@ static void ParseOptions(int argc, char* argv[]) {
 static void WriteBufferToFile(string_view filename,
                               const OutputBuffer& buffer) {
   if (s_dump_module) {
+    std::lock_guard<std::mutex> lock(s_output_mutex);
     std::unique_ptr<FileStream> stream = FileStream::CreateStdout();
     if (s_verbose) {
       stream->Writef(";; dump\n");
@@ -121,50 +193,198 @@ static std::string DefaultOuputName(string_view input_name) {
   return result;
 }
 
-int ProgramMain(int argc, char** argv) {
-  InitStdio();
+// Validates on a helper thread while this thread produces the binary
+// encoding; after name resolution both passes only read the module. The
+// buffered output is committed to |outfile| only once validation succeeds.
+// A field-level parse/write pipeline isn't possible: name resolution and the
+// binary writer both need the complete index spaces, which forward
+// references leave unknown until the last field is parsed.
+static Result ValidateAndWriteOverlapped(const Module* module,
+                                         const std::string& outfile,
+                                         Errors* errors) {
+  Errors validate_errors;
+  Result validate_result = Result::Ok;
+  std::thread validate_thread([module, &validate_errors, &validate_result]() {
+    TimedPhase timer("validate");
+    MemoryPhase mem_phase("validate");
+    ValidateOptions options(s_features);
+    validate_result = ValidateModule(module, &validate_errors, options);
+  });
 
-  ParseOptions(argc, argv);
+  MemoryStream stream(s_log_stream.get());
+  Result write_result;
+  {
+    TimedPhase timer("write");
+    MemoryPhase mem_phase("write");
+    write_result = WriteBinaryModule(&stream, module, s_write_binary_options);
+  }
+  validate_thread.join();
+
+  errors->insert(errors->end(), validate_errors.begin(),
+                 validate_errors.end());
+  if (Failed(validate_result)) {
+    return validate_result;
+  }
+  if (Succeeded(write_result)) {
+    WriteBufferToFile(outfile.c_str(), stream.output_buffer());
+  }
+  return write_result;
+}
+
+// Per-worker scratch retained across batch entries: the file and output
+// buffers keep their capacity and the parser is Reset() per file instead of
+// being reconstructed, so later files skip the first one's warmup
+// allocations.
+struct CompileSession {
+  CompileSession() : parse_options(s_features) {}
 
+  WastParseOptions parse_options;
   std::vector<uint8_t> file_data;
-  Result result = ReadFile(s_infile, &file_data);
-  std::unique_ptr<WastLexer> lexer = WastLexer::CreateBufferLexer(
-      s_infile, file_data.data(), file_data.size());
+  std::unique_ptr<WastParser> parser;
+  std::unique_ptr<MemoryStream> stream;
+};
+
+static Result CompileFile(const std::string& infile,
+                          const std::string& outfile,
+                          CompileSession* session) {
+  std::vector<uint8_t>& file_data = session->file_data;
+  Result result;
+  {
+    TimedPhase timer("read");
+    MemoryPhase mem_phase("read");
+    result = ReadFile(infile.c_str(), &file_data);
+  }
   if (Failed(result)) {
-    WABT_FATAL("unable to read file: %s\n", s_infile);
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    fprintf(stderr, "unable to read file: %s\n", infile.c_str());
+    return result;
   }
+  std::unique_ptr<WastLexer> lexer = WastLexer::CreateBufferLexer(
+      infile.c_str(), file_data.data(), file_data.size());
 
   Errors errors;
   std::unique_ptr<Module> module;
-  WastParseOptions parse_wast_options(s_features);
-  result = ParseWatModule(lexer.get(), &module, &errors, &parse_wast_options);
+  {
+    TimedPhase timer("parse");
+    MemoryPhase mem_phase("parse");
+    if (!session->parser) {
+      session->parser.reset(
+          new WastParser(lexer.get(), &errors, &session->parse_options));
+    } else {
+      session->parser->Reset(lexer.get(), &errors);
+    }
+    result = session->parser->ParseModule(&module);
+  }
 
   if (Succeeded(result)) {
-    result = ResolveNamesModule(module.get(), &errors);
+    bool pipeline = s_pipeline && s_validate;
+    {
+      // Covers name resolution too; it's a precondition of validation.
+      TimedPhase timer("validate");
+      MemoryPhase mem_phase("validate");
+      result = ResolveNamesModule(module.get(), &errors);
 
-    if (Succeeded(result) && s_validate) {
-      ValidateOptions options(s_features);
-      result = ValidateModule(module.get(), &errors, options);
+      // After resolution all type uses are index vars, so merged entries can
+      // be renumbered without consulting names.
+      if (Succeeded(result) && s_dedupe_types) {
+        result = DedupeFuncTypes(module.get());
+      }
+
+      if (Succeeded(result) && s_validate && !pipeline) {
+        ValidateOptions options(s_features);
+        result = ValidateModule(module.get(), &errors, options);
+      }
     }
 
-    if (Succeeded(result)) {
-      MemoryStream stream(s_log_stream.get());
+    if (Succeeded(result) && pipeline) {
       s_write_binary_options.features = s_features;
-      result = WriteBinaryModule(&stream, module.get(), s_write_binary_options);
+      result = ValidateAndWriteOverlapped(module.get(), outfile, &errors);
+    } else if (Succeeded(result)) {
+      TimedPhase timer("write");
+      MemoryPhase mem_phase("write");
+      s_write_binary_options.features = s_features;
+      if (s_streaming && !s_dump_module) {
+        FileStream stream(outfile.c_str(), s_log_stream.get());
+        result = WriteBinaryModuleStreaming(&stream, module.get(),
+                                            s_write_binary_options);
+      } else {
+        if (!session->stream) {
+          session->stream.reset(new MemoryStream(s_log_stream.get()));
+        } else {
+          session->stream->Clear();
+          session->stream->ClearOffset();
+        }
+        result = WriteBinaryModule(session->stream.get(), module.get(),
+                                   s_write_binary_options);
 
-      if (Succeeded(result)) {
-        if (s_outfile.empty()) {
-          s_outfile = DefaultOuputName(s_infile);
+        if (Succeeded(result)) {
+          WriteBufferToFile(outfile.c_str(), session->stream->output_buffer());
         }
-        WriteBufferToFile(s_outfile.c_str(), stream.output_buffer());
       }
     }
   }
 
-  auto line_finder = lexer->MakeLineFinder();
-  FormatErrorsToFile(errors, Location::Type::Text, line_finder.get());
+  if (!errors.empty()) {
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    FormatErrorsToFile(errors, Location::Type::Text, lexer->line_finder());
+  }
+
+  return result;
+}
+
+static int RunBatch(const char* response_filename) {
+  std::vector<BatchEntry> entries =
+      ReadResponseFile(response_filename, DefaultOuputName);
+
+  std::atomic<size_t> next_entry(0);
+  std::atomic<int> num_failed(0);
+  auto worker = [&]() {
+    CompileSession session;
+    for (;;) {
+      size_t i = next_entry.fetch_add(1, std::memory_order_relaxed);
+      if (i >= entries.size()) {
+        break;
+      }
+      if (Failed(
+              CompileFile(entries[i].infile, entries[i].outfile, &session))) {
+        num_failed.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  int num_threads = static_cast<int>(
+      std::min(static_cast<size_t>(s_num_threads), entries.size()));
+  if (num_threads <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+  return num_failed != 0;
+}
+
+int ProgramMain(int argc, char** argv) {
+  InitStdio();
 
-  return result != Result::Ok;
+  ParseOptions(argc, argv);
+
+  // "@file" names a response file whose entries are all compiled in this
+  // process, saving per-process startup when building many modules.
+  if (s_infile[0] == '@') {
+    return RunBatch(s_infile + 1);
+  }
+
+  std::string outfile = s_outfile;
+  if (outfile.empty()) {
+    outfile = DefaultOuputName(s_infile);
+  }
+  CompileSession session;
+  return CompileFile(s_infile, outfile, &session) != Result::Ok;
 }
 
 int main(int argc, char** argv) {
@@ -62,14 +62,14 @@ void TypeChecker::PrintError(const char* fmt, ...) {
 }
 
 Result TypeChecker::GetLabel(Index depth, Label** out_label) {
-  if (depth >= label_stack_.size()) {
-    assert(label_stack_.size() > 0);
+  if (depth >= label_stack_size_) {
+    assert(label_stack_size_ > 0);
     PrintError("invalid depth: %" PRIindex " (max %" PRIzd ")", depth,
-               label_stack_.size() - 1);
+               label_stack_size_ - 1);
     *out_label = nullptr;
     return Result::Error;
   }
-  *out_label = &label_stack_[label_stack_.size() - depth - 1];
+  *out_label = &label_stack_[label_stack_size_ - depth - 1];
   return Result::Ok;
 }
 
@@ -100,12 +100,25 @@ Result TypeChecker::SetUnreachable() {
 void TypeChecker::PushLabel(LabelType label_type,
                             const TypeVector& param_types,
                             const TypeVector& result_types) {
-  label_stack_.emplace_back(label_type, param_types, result_types,
-                            type_stack_.size());
+  if (label_stack_size_ < label_stack_.size()) {
+    // Reuse a retired slot; assigning into its vectors reuses their capacity
+    // instead of allocating two fresh vectors per label.
+    Label& label = label_stack_[label_stack_size_];
+    label.label_type = label_type;
+    label.param_types.assign(param_types.begin(), param_types.end());
+    label.result_types.assign(result_types.begin(), result_types.end());
+    label.type_stack_limit = type_stack_.size();
+    label.unreachable = false;
+  } else {
+    label_stack_.emplace_back(label_type, param_types, result_types,
+                              type_stack_.size());
+  }
+  ++label_stack_size_;
 }
 
 Result TypeChecker::PopLabel() {
-  label_stack_.pop_back();
+  // Keep the slot for reuse by the next PushLabel.
+  --label_stack_size_;
   return Result::Ok;
 }
 
@@ -114,7 +127,7 @@ Result TypeChecker::CheckLabelType(Label* label, LabelType label_type) {
 }
 
 Result TypeChecker::GetThisFunctionLabel(Label** label) {
-  return GetLabel(label_stack_.size() - 1, label);
+  return GetLabel(label_stack_size_ - 1, label);
 }
 
 Result TypeChecker::PeekType(Index depth, Type* out_type) {
@@ -270,13 +283,50 @@ Result TypeChecker::PopAndCheck3Types(Type expected1,
   return result;
 }
 
+// Table-driven fast path for opcodes with a fixed signature, shared by
+// CheckOpcode1/2/3. Packs the top |param_count| stack types into a word and
+// compares it against the opcode's packed parameter types from the opcode
+// metadata table; on an exact match the pops and the result push are applied
+// inline, with none of the general per-type machinery. Returns false --
+// without changing any state -- when the stack doesn't literally match: too
+// few types above the current label, or any type byte differing, including
+// mismatches the general path would accept (Type::Any in unreachable code)
+// or reject with a diagnostic.
+bool TypeChecker::ApplySimpleSignature(Opcode opcode, int param_count) {
+  if (label_stack_size_ == 0) {
+    return false;
+  }
+  const Label& label = label_stack_[label_stack_size_ - 1];
+  size_t stack_size = type_stack_.size();
+  if (stack_size < label.type_stack_limit + param_count) {
+    return false;
+  }
+  uint32_t packed = 0;
+  for (int i = 0; i < param_count; ++i) {
+    packed |= (static_cast<uint32_t>(type_stack_[stack_size - 1 - i]) & 0xff)
+              << (8 * i);
+  }
+  if (packed != opcode.GetPackedParamTypes(param_count)) {
+    return false;
+  }
+  type_stack_.resize(stack_size - param_count);
+  PushType(opcode.GetResultType());
+  return true;
+}
+
 Result TypeChecker::CheckOpcode1(Opcode opcode) {
+  if (ApplySimpleSignature(opcode, 1)) {
+    return Result::Ok;
+  }
   Result result = PopAndCheck1Type(opcode.GetParamType1(), opcode.GetName());
   PushType(opcode.GetResultType());
   return result;
 }
 
 Result TypeChecker::CheckOpcode2(Opcode opcode) {
+  if (ApplySimpleSignature(opcode, 2)) {
+    return Result::Ok;
+  }
   Result result = PopAndCheck2Types(opcode.GetParamType1(),
                                     opcode.GetParamType2(), opcode.GetName());
   PushType(opcode.GetResultType());
@@ -284,6 +334,9 @@ Result TypeChecker::CheckOpcode2(Opcode opcode) {
 }
 
 Result TypeChecker::CheckOpcode3(Opcode opcode) {
+  if (ApplySimpleSignature(opcode, 3)) {
+    return Result::Ok;
+  }
   Result result =
       PopAndCheck3Types(opcode.GetParamType1(), opcode.GetParamType2(),
                         opcode.GetParamType3(), opcode.GetName());
@@ -341,7 +394,7 @@ void TypeChecker::PrintStackIfFailed(Result result,
 
 Result TypeChecker::BeginFunction(const TypeVector& sig) {
   type_stack_.clear();
-  label_stack_.clear();
+  label_stack_size_ = 0;
   PushLabel(LabelType::Func, TypeVector(), sig);
   return Result::Ok;
 }
@@ -154,6 +154,7 @@ class TypeChecker {
                            Type expected2,
                            Type expected3,
                            const char* desc);
+  bool ApplySimpleSignature(Opcode opcode, int param_count);
   Result CheckOpcode1(Opcode opcode);
   Result CheckOpcode2(Opcode opcode);
   Result CheckOpcode3(Opcode opcode);
@@ -172,7 +173,12 @@ class TypeChecker {
 
   ErrorCallback error_callback_;
   TypeVector type_stack_;
+  // Entries at index >= label_stack_size_ are retired labels kept for reuse;
+  // PushLabel assigns into them so their type vectors' capacity survives
+  // popping and BeginFunction. A checker validates every function in a
+  // module, so after the first few functions label pushes stop allocating.
   std::vector<Label> label_stack_;
+  size_t label_stack_size_ = 0;
   // Cache the expected br_table signature. It will be initialized to `nullptr`
   // to represent "any".
   TypeVector* br_table_sig_ = nullptr;
@@ -17,6 +17,17 @@
 #include "src/utf8.h"
 
 #include <cstdint>
+#include <cstring>
+
+#include "config.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WABT_UTF8_HAS_SSE2 1
+#else
+#define WABT_UTF8_HAS_SSE2 0
+#endif
 
 namespace wabt {
 
@@ -47,12 +58,51 @@ bool IsCont(uint8_t c) {
   return (c & 0xc0) == 0x80;
 }
 
+// Advances |*p| past any leading run of ASCII bytes, a block at a time.
+// Names and strings are overwhelmingly ASCII, which the byte-at-a-time
+// machine below spends most of its time confirming; ASCII needs no
+// validation beyond the high bit, so whole blocks can be tested at once.
+void SkipAscii(const uint8_t** p, const uint8_t* end) {
+#if WABT_UTF8_HAS_SSE2
+  while (end - *p >= 16) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(*p));
+    int mask = _mm_movemask_epi8(chunk);
+    if (mask != 0) {
+      // Skip the ASCII bytes preceding the first high bit in this block.
+      *p += Ctz(static_cast<unsigned>(mask));
+      return;
+    }
+    *p += 16;
+  }
+#else
+  const uint64_t kHighBits = UINT64_C(0x8080808080808080);
+  while (end - *p >= 8) {
+    uint64_t chunk;
+    memcpy(&chunk, *p, sizeof(chunk));
+    if (chunk & kHighBits) {
+      // The per-byte loop below finds the first non-ASCII byte, which
+      // avoids depending on the host byte order.
+      break;
+    }
+    *p += 8;
+  }
+#endif
+  while (*p < end && !(**p & 0x80)) {
+    ++*p;
+  }
+}
+
 }  // end anonymous namespace
 
 bool IsValidUtf8(const char* s, size_t s_length) {
   const uint8_t* p = reinterpret_cast<const uint8_t*>(s);
   const uint8_t* end = p + s_length;
   while (p < end) {
+    SkipAscii(&p, end);
+    if (p >= end) {
+      break;
+    }
     uint8_t cu0 = *p;
     int length = s_utf8_length[cu0];
     if (p + length > end) {
@@ -16,14 +16,19 @@
 
 #include "src/validator.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cstdarg>
 #include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "config.h"
 
 #include "src/binary-reader.h"
+#include "src/binary-reader-ir.h"
 #include "src/cast.h"
 #include "src/expr-visitor.h"
 #include "src/ir.h"
@@ -33,79 +38,80 @@ namespace wabt {
 
 namespace {
 
-class Validator : public ExprVisitor::Delegate {
+class Validator {
  public:
   WABT_DISALLOW_COPY_AND_ASSIGN(Validator);
   Validator(Errors*, const Script*, const ValidateOptions& options);
 
   Result CheckModule(const Module* module);
+  Result CheckLazyModule(Module* module, LazyFuncBodies* lazy_bodies);
   Result CheckScript(const Script* script);
   Result CheckAllFuncSignatures(const Module* module);
 
-  // Implements ExprVisitor::Delegate.
-  Result OnBinaryExpr(BinaryExpr*) override;
-  Result BeginBlockExpr(BlockExpr*) override;
-  Result EndBlockExpr(BlockExpr*) override;
-  Result OnBrExpr(BrExpr*) override;
-  Result OnBrIfExpr(BrIfExpr*) override;
-  Result OnBrOnExnExpr(BrOnExnExpr*) override;
-  Result OnBrTableExpr(BrTableExpr*) override;
-  Result OnCallExpr(CallExpr*) override;
-  Result OnCallIndirectExpr(CallIndirectExpr*) override;
-  Result OnCompareExpr(CompareExpr*) override;
-  Result OnConstExpr(ConstExpr*) override;
-  Result OnConvertExpr(ConvertExpr*) override;
-  Result OnDropExpr(DropExpr*) override;
-  Result OnGlobalGetExpr(GlobalGetExpr*) override;
-  Result OnGlobalSetExpr(GlobalSetExpr*) override;
-  Result BeginIfExpr(IfExpr*) override;
-  Result AfterIfTrueExpr(IfExpr*) override;
-  Result EndIfExpr(IfExpr*) override;
-  Result OnLoadExpr(LoadExpr*) override;
-  Result OnLocalGetExpr(LocalGetExpr*) override;
-  Result OnLocalSetExpr(LocalSetExpr*) override;
-  Result OnLocalTeeExpr(LocalTeeExpr*) override;
-  Result BeginLoopExpr(LoopExpr*) override;
-  Result EndLoopExpr(LoopExpr*) override;
-  Result OnMemoryCopyExpr(MemoryCopyExpr*) override;
-  Result OnDataDropExpr(DataDropExpr*) override;
-  Result OnMemoryFillExpr(MemoryFillExpr*) override;
-  Result OnMemoryGrowExpr(MemoryGrowExpr*) override;
-  Result OnMemoryInitExpr(MemoryInitExpr*) override;
-  Result OnMemorySizeExpr(MemorySizeExpr*) override;
-  Result OnTableCopyExpr(TableCopyExpr*) override;
-  Result OnElemDropExpr(ElemDropExpr*) override;
-  Result OnTableInitExpr(TableInitExpr*) override;
-  Result OnTableGetExpr(TableGetExpr*) override;
-  Result OnTableSetExpr(TableSetExpr*) override;
-  Result OnTableGrowExpr(TableGrowExpr*) override;
-  Result OnTableSizeExpr(TableSizeExpr*) override;
-  Result OnRefFuncExpr(RefFuncExpr*) override;
-  Result OnRefNullExpr(RefNullExpr*) override;
-  Result OnRefIsNullExpr(RefIsNullExpr*) override;
-  Result OnNopExpr(NopExpr*) override;
-  Result OnReturnExpr(ReturnExpr*) override;
-  Result OnReturnCallExpr(ReturnCallExpr*) override;
-  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr*) override;
-  Result OnSelectExpr(SelectExpr*) override;
-  Result OnStoreExpr(StoreExpr*) override;
-  Result OnUnaryExpr(UnaryExpr*) override;
-  Result OnUnreachableExpr(UnreachableExpr*) override;
-  Result BeginTryExpr(TryExpr*) override;
-  Result OnCatchExpr(TryExpr*) override;
-  Result EndTryExpr(TryExpr*) override;
-  Result OnThrowExpr(ThrowExpr*) override;
-  Result OnRethrowExpr(RethrowExpr*) override;
-  Result OnAtomicWaitExpr(AtomicWaitExpr*) override;
-  Result OnAtomicNotifyExpr(AtomicNotifyExpr*) override;
-  Result OnAtomicLoadExpr(AtomicLoadExpr*) override;
-  Result OnAtomicStoreExpr(AtomicStoreExpr*) override;
-  Result OnAtomicRmwExpr(AtomicRmwExpr*) override;
-  Result OnAtomicRmwCmpxchgExpr(AtomicRmwCmpxchgExpr*) override;
-  Result OnTernaryExpr(TernaryExpr*) override;
-  Result OnSimdLaneOpExpr(SimdLaneOpExpr*) override;
-  Result OnSimdShuffleOpExpr(SimdShuffleOpExpr*) override;
-  Result OnLoadSplatExpr(LoadSplatExpr*) override;
+  // Expression handlers, called by ExprVisitorT<Validator>.
+  Result OnBinaryExpr(BinaryExpr*);
+  Result BeginBlockExpr(BlockExpr*);
+  Result EndBlockExpr(BlockExpr*);
+  Result OnBrExpr(BrExpr*);
+  Result OnBrIfExpr(BrIfExpr*);
+  Result OnBrOnExnExpr(BrOnExnExpr*);
+  Result OnBrTableExpr(BrTableExpr*);
+  Result OnCallExpr(CallExpr*);
+  Result OnCallIndirectExpr(CallIndirectExpr*);
+  Result OnCompareExpr(CompareExpr*);
+  Result OnConstExpr(ConstExpr*);
+  Result OnConvertExpr(ConvertExpr*);
+  Result OnDropExpr(DropExpr*);
+  Result OnGlobalGetExpr(GlobalGetExpr*);
+  Result OnGlobalSetExpr(GlobalSetExpr*);
+  Result BeginIfExpr(IfExpr*);
+  Result AfterIfTrueExpr(IfExpr*);
+  Result EndIfExpr(IfExpr*);
+  Result OnLoadExpr(LoadExpr*);
+  Result OnLocalGetExpr(LocalGetExpr*);
+  Result OnLocalSetExpr(LocalSetExpr*);
+  Result OnLocalTeeExpr(LocalTeeExpr*);
+  Result BeginLoopExpr(LoopExpr*);
+  Result EndLoopExpr(LoopExpr*);
+  Result OnMemoryCopyExpr(MemoryCopyExpr*);
+  Result OnDataDropExpr(DataDropExpr*);
+  Result OnMemoryFillExpr(MemoryFillExpr*);
+  Result OnMemoryGrowExpr(MemoryGrowExpr*);
+  Result OnMemoryInitExpr(MemoryInitExpr*);
+  Result OnMemorySizeExpr(MemorySizeExpr*);
+  Result OnTableCopyExpr(TableCopyExpr*);
+  Result OnElemDropExpr(ElemDropExpr*);
+  Result OnTableInitExpr(TableInitExpr*);
+  Result OnTableGetExpr(TableGetExpr*);
+  Result OnTableSetExpr(TableSetExpr*);
+  Result OnTableGrowExpr(TableGrowExpr*);
+  Result OnTableSizeExpr(TableSizeExpr*);
+  Result OnRefFuncExpr(RefFuncExpr*);
+  Result OnRefNullExpr(RefNullExpr*);
+  Result OnRefIsNullExpr(RefIsNullExpr*);
+  Result OnNopExpr(NopExpr*);
+  Result OnReturnExpr(ReturnExpr*);
+  Result OnReturnCallExpr(ReturnCallExpr*);
+  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr*);
+  Result OnSelectExpr(SelectExpr*);
+  Result OnStoreExpr(StoreExpr*);
+  Result OnUnaryExpr(UnaryExpr*);
+  Result OnUnreachableExpr(UnreachableExpr*);
+  Result BeginTryExpr(TryExpr*);
+  Result OnCatchExpr(TryExpr*);
+  Result EndTryExpr(TryExpr*);
+  Result OnThrowExpr(ThrowExpr*);
+  Result OnRethrowExpr(RethrowExpr*);
+  Result OnAtomicWaitExpr(AtomicWaitExpr*);
+  Result OnAtomicNotifyExpr(AtomicNotifyExpr*);
+  Result OnAtomicLoadExpr(AtomicLoadExpr*);
+  Result OnAtomicStoreExpr(AtomicStoreExpr*);
+  Result OnAtomicRmwExpr(AtomicRmwExpr*);
+  Result OnAtomicRmwCmpxchgExpr(AtomicRmwCmpxchgExpr*);
+  Result OnTernaryExpr(TernaryExpr*);
+  Result OnSimdLaneOpExpr(SimdLaneOpExpr*);
+  Result OnSimdShuffleOpExpr(SimdShuffleOpExpr*);
+  Result OnLoadSplatExpr(LoadSplatExpr*);
 
  private:
   struct ActionResult {
@@ -185,6 +191,8 @@ class Validator : public ExprVisitor::Delegate {
   class CheckFuncSignatureExprVisitorDelegate;
 
   void CheckFunc(const Location* loc, const Func* func);
+  void CheckLazyFunc(const Location* loc, const Func* func, Errors* errors);
+  void CheckDeferredFuncs();
   void PrintConstExprError(const Location* loc, const char* desc);
   void CheckConstInitExpr(const Location* loc,
                           const ExprList& expr,
@@ -226,6 +234,12 @@ class Validator : public ExprVisitor::Delegate {
   // Cached for access by OnTypecheckerError.
   const Location* expr_loc_ = nullptr;
   Result result_ = Result::Ok;
+  // Function bodies whose validation was deferred so it can run on worker
+  // threads; only used when options_.num_threads > 1.
+  std::vector<std::pair<const Location*, const Func*>> deferred_funcs_;
+  // Set by CheckLazyModule; function bodies are decoded through this right
+  // before they're checked, and released right after.
+  LazyFuncBodies* lazy_bodies_ = nullptr;
 };
 
 Validator::Validator(Errors* errors,
@@ -238,6 +252,10 @@ Validator::Validator(Errors* errors,
 
 void Validator::PrintError(const Location* loc, const char* format, ...) {
   result_ = Result::Error;
+  if (options_.skip_error_messages) {
+    errors_->emplace_back(ErrorLevel::Error, *loc, string_view());
+    return;
+  }
   WABT_SNPRINTF_ALLOCA(buffer, length, format);
   errors_->emplace_back(ErrorLevel::Error, *loc, buffer);
 }
@@ -485,7 +503,7 @@ void Validator::CheckAssertReturnNanType(const Location* loc,
 }
 
 void Validator::CheckExprList(const Location* loc, const ExprList& exprs) {
-  ExprVisitor visitor(this);
+  ExprVisitorT<Validator> visitor(this);
   // TODO(binji): Add const-visitors.
   visitor.VisitExprList(const_cast<ExprList&>(exprs));
 }
@@ -1039,6 +1057,80 @@ void Validator::CheckFunc(const Location* loc, const Func* func) {
   current_func_ = nullptr;
 }
 
+// Decodes a lazily-read function body, checks it, then releases it again so
+// only one body is in memory at a time. The const_casts are safe: lazy_bodies_
+// is only set by CheckLazyModule, which takes a non-const Module. Decode
+// errors go to |errors| rather than errors_ so worker threads in
+// CheckDeferredFuncs can keep them with that function's validation errors.
+void Validator::CheckLazyFunc(const Location* loc,
+                              const Func* func,
+                              Errors* errors) {
+  Func* mutable_func = const_cast<Func*>(func);
+  if (Failed(lazy_bodies_->ReadFuncBody(mutable_func, errors))) {
+    result_ = Result::Error;
+    return;
+  }
+  CheckFunc(loc, func);
+  mutable_func->exprs.clear();
+  mutable_func->local_types = LocalTypes();
+}
+
+// Validates the function bodies collected in deferred_funcs_ on
+// options_.num_threads worker threads. Bodies only read module-level state, so
+// each worker gets its own Validator (and with it its own TypeChecker) and its
+// own Errors; the workers validate contiguous slices of the function list, so
+// appending their errors slice by slice reports them in function order.
+void Validator::CheckDeferredFuncs() {
+  if (deferred_funcs_.empty()) {
+    return;
+  }
+
+  size_t num_threads = std::min<size_t>(
+      std::max(options_.num_threads, 1), deferred_funcs_.size());
+  size_t funcs_per_thread = (deferred_funcs_.size() + num_threads - 1) /
+                            num_threads;
+  std::vector<Errors> thread_errors(num_threads);
+  std::vector<Result> thread_results(num_threads, Result::Ok);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    size_t begin = i * funcs_per_thread;
+    size_t end = std::min(begin + funcs_per_thread, deferred_funcs_.size());
+    threads.emplace_back([this, i, begin, end, &thread_errors,
+                          &thread_results]() {
+      Validator validator(&thread_errors[i], script_, options_);
+      validator.current_module_ = current_module_;
+      validator.lazy_bodies_ = lazy_bodies_;
+      for (size_t j = begin; j < end; ++j) {
+        if (lazy_bodies_) {
+          // Decoding distinct code entries is thread-safe; the decode errors
+          // land in this worker's Errors, keeping them in function order.
+          validator.CheckLazyFunc(deferred_funcs_[j].first,
+                                  deferred_funcs_[j].second,
+                                  &thread_errors[i]);
+        } else {
+          validator.CheckFunc(deferred_funcs_[j].first,
+                              deferred_funcs_[j].second);
+        }
+      }
+      thread_results[i] = validator.result_;
+    });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    if (Failed(thread_results[i])) {
+      result_ = Result::Error;
+    }
+    errors_->insert(errors_->end(), thread_errors[i].begin(),
+                    thread_errors[i].end());
+  }
+  deferred_funcs_.clear();
+}
+
 void Validator::PrintConstExprError(const Location* loc, const char* desc) {
   PrintError(loc,
              "invalid %s, must be a constant expression; either *.const or "
@@ -1277,7 +1369,8 @@ void Validator::CheckDuplicateExportBindings(const Module* module) {
         const Location& a_loc = a.second.loc;
         const Location& b_loc = b.second.loc;
         const Location& loc = a_loc.line > b_loc.line ? a_loc : b_loc;
-        PrintError(&loc, "redefinition of export \"%s\"", a.first.c_str());
+        PrintError(&loc, "redefinition of export \"" PRIstringview "\"",
+                   WABT_PRINTF_STRING_VIEW_ARG(a.first));
       });
 }
 
@@ -1299,7 +1392,15 @@ Result Validator::CheckModule(const Module* module) {
         break;
 
       case ModuleFieldType::Func:
-        CheckFunc(&field.loc, &cast<FuncModuleField>(&field)->func);
+        if (options_.num_threads > 1) {
+          deferred_funcs_.emplace_back(&field.loc,
+                                       &cast<FuncModuleField>(&field)->func);
+        } else if (lazy_bodies_) {
+          CheckLazyFunc(&field.loc, &cast<FuncModuleField>(&field)->func,
+                        errors_);
+        } else {
+          CheckFunc(&field.loc, &cast<FuncModuleField>(&field)->func);
+        }
         break;
 
       case ModuleFieldType::Global:
@@ -1358,6 +1459,8 @@ Result Validator::CheckModule(const Module* module) {
     }
   }
 
+  CheckDeferredFuncs();
+
   CheckElemSegments(module);
   CheckDataSegments(module);
   CheckDuplicateExportBindings(module);
@@ -1365,6 +1468,11 @@ Result Validator::CheckModule(const Module* module) {
   return result_;
 }
 
+Result Validator::CheckLazyModule(Module* module, LazyFuncBodies* lazy_bodies) {
+  lazy_bodies_ = lazy_bodies;
+  return CheckModule(module);
+}
+
 // Returns the result type of the invoked function, checked by the caller;
 // returning nullptr means that another error occured first, so the result type
 // should be ignored.
@@ -1569,40 +1677,40 @@ Result Validator::CheckScript(const Script* script) {
 }
 
 class Validator::CheckFuncSignatureExprVisitorDelegate
-    : public ExprVisitor::DelegateNop {
+    : public ExprVisitorNopDelegate {
  public:
   explicit CheckFuncSignatureExprVisitorDelegate(Validator* validator)
       : validator_(validator) {}
 
-  Result BeginBlockExpr(BlockExpr* expr) override {
+  Result BeginBlockExpr(BlockExpr* expr) {
     validator_->CheckBlockDeclaration(&expr->loc, Opcode::Block,
                                       &expr->block.decl);
     return Result::Ok;
   }
 
-  Result OnCallIndirectExpr(CallIndirectExpr* expr) override {
+  Result OnCallIndirectExpr(CallIndirectExpr* expr) {
     validator_->CheckFuncSignature(&expr->loc, expr->decl);
     return Result::Ok;
   }
 
-  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr* expr) override {
+  Result OnReturnCallIndirectExpr(ReturnCallIndirectExpr* expr) {
     validator_->CheckFuncSignature(&expr->loc, expr->decl);
     return Result::Ok;
   }
 
-  Result BeginIfExpr(IfExpr* expr) override {
+  Result BeginIfExpr(IfExpr* expr) {
     validator_->CheckBlockDeclaration(&expr->loc, Opcode::If,
                                       &expr->true_.decl);
     return Result::Ok;
   }
 
-  Result BeginLoopExpr(LoopExpr* expr) override {
+  Result BeginLoopExpr(LoopExpr* expr) {
     validator_->CheckBlockDeclaration(&expr->loc, Opcode::Loop,
                                       &expr->block.decl);
     return Result::Ok;
   }
 
-  Result BeginTryExpr(TryExpr* expr) override {
+  Result BeginTryExpr(TryExpr* expr) {
     validator_->CheckBlockDeclaration(&expr->loc, Opcode::Try,
                                       &expr->block.decl);
     return Result::Ok;
@@ -1620,7 +1728,7 @@ Result Validator::CheckAllFuncSignatures(const Module* module) {
         auto func_field = cast<FuncModuleField>(&field);
         CheckFuncSignature(&field.loc, func_field->func.decl);
         CheckFuncSignatureExprVisitorDelegate delegate(this);
-        ExprVisitor visitor(&delegate);
+        ExprVisitorT<CheckFuncSignatureExprVisitorDelegate> visitor(&delegate);
         // TODO(binji): would rather not do a const_cast here, but the visitor
         // is non-const only.
         visitor.VisitFunc(const_cast<Func*>(&func_field->func));
@@ -1652,6 +1760,15 @@ Result ValidateModule(const Module* module,
   return validator.CheckModule(module);
 }
 
+Result ValidateLazyModule(Module* module,
+                          LazyFuncBodies* lazy_bodies,
+                          Errors* errors,
+                          const ValidateOptions& options) {
+  Validator validator(errors, nullptr, options);
+
+  return validator.CheckLazyModule(module, lazy_bodies);
+}
+
 Result ValidateFuncSignatures(const Module* module,
                               Errors* errors,
                               const ValidateOptions& options) {
@@ -22,6 +22,7 @@
 
 namespace wabt {
 
+class LazyFuncBodies;
 struct Module;
 struct Script;
 
@@ -30,6 +31,14 @@ struct ValidateOptions {
   ValidateOptions(const Features& features) : features(features) {}
 
   Features features;
+  // Number of threads used to validate function bodies; values <= 1 validate
+  // on the calling thread. With multiple threads, errors from function bodies
+  // are reported after all other module-level errors (but still in function
+  // order).
+  int num_threads = 1;
+  // When true, errors carry only a level and location, and no message text
+  // is formatted. See ReadBinaryOptions::skip_error_messages.
+  bool skip_error_messages = false;
 };
 
 // Perform all checks on the script. It is valid if and only if this function
@@ -37,6 +46,16 @@ struct ValidateOptions {
 Result ValidateScript(const Script*, Errors*, const ValidateOptions&);
 Result ValidateModule(const Module*, Errors*, const ValidateOptions&);
 
+// Like ValidateModule, but for a module read with ReadBinaryIrLazy: each
+// function body is decoded, checked, and released again before the next one
+// is decoded, so peak memory is bounded by the largest single body rather
+// than the whole code section. The module's function bodies are empty when
+// this returns, so it is only useful for a valid/invalid verdict.
+Result ValidateLazyModule(Module*,
+                          LazyFuncBodies*,
+                          Errors*,
+                          const ValidateOptions&);
+
 // Validate that all functions that have an explicit function signature and a
 // function type use match.
 //
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/wast-incremental-parser.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "src/wast-lexer.h"
+
+namespace wabt {
+
+namespace {
+
+// Matches the "module" keyword at |pos|, i.e. the text spells a wrapped
+// "(module ...)" form rather than a bare module field.
+bool StartsModuleForm(const std::string& text, size_t pos) {
+  static const char kModule[] = "module";
+  const size_t kModuleLen = sizeof(kModule) - 1;
+  if (text.compare(pos, kModuleLen, kModule) != 0) {
+    return false;
+  }
+  if (pos + kModuleLen == text.size()) {
+    return true;
+  }
+  char c = text[pos + kModuleLen];
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '(' ||
+         c == ')' || c == ';';
+}
+
+}  // end anonymous namespace
+
+WastIncrementalParser::WastIncrementalParser(string_view filename,
+                                             WastParseOptions* options)
+    : filename_(filename.to_string()), options_(options) {}
+
+Result WastIncrementalParser::SetText(string_view text, Errors* errors) {
+  text_.assign(text.data(), text.size());
+  if (!ScanForms(&forms_)) {
+    forms_.clear();
+  }
+  return ReparseAll(errors);
+}
+
+Result WastIncrementalParser::ApplyEdit(size_t offset,
+                                        size_t old_size,
+                                        string_view replacement,
+                                        Errors* errors) {
+  assert(offset + old_size <= text_.size());
+  std::vector<FormRange> old_forms = std::move(forms_);
+  text_.replace(offset, old_size, replacement.size() ? replacement.data() : "",
+                replacement.size());
+  module_dirty_ = true;
+
+  if (!ScanForms(&forms_)) {
+    // Unbalanced text; a full parse reports the error at the right place.
+    forms_.clear();
+    return ReparseAll(errors);
+  }
+
+  // Old forms strictly before the edit are untouched, and old forms
+  // strictly after it reappear shifted by the size delta; everything
+  // between was touched by the edit and gets re-parsed.
+  ptrdiff_t delta = static_cast<ptrdiff_t>(replacement.size()) -
+                    static_cast<ptrdiff_t>(old_size);
+
+  size_t prefix = 0;
+  while (prefix < old_forms.size() && prefix < forms_.size() &&
+         old_forms[prefix].end <= offset &&
+         forms_[prefix].start == old_forms[prefix].start &&
+         forms_[prefix].end == old_forms[prefix].end) {
+    ++prefix;
+  }
+
+  size_t suffix = 0;
+  while (suffix < old_forms.size() - prefix &&
+         suffix < forms_.size() - prefix) {
+    const FormRange& old_form = old_forms[old_forms.size() - 1 - suffix];
+    const FormRange& new_form = forms_[forms_.size() - 1 - suffix];
+    if (old_form.start < offset + old_size ||
+        static_cast<ptrdiff_t>(new_form.start) !=
+            static_cast<ptrdiff_t>(old_form.start) + delta ||
+        static_cast<ptrdiff_t>(new_form.end) !=
+            static_cast<ptrdiff_t>(old_form.end) + delta) {
+      break;
+    }
+    ++suffix;
+  }
+
+  Result result = Result::Ok;
+  for (size_t i = prefix; i < forms_.size() - suffix; ++i) {
+    if (Failed(CheckFormSyntax(forms_[i], errors))) {
+      result = Result::Error;
+    }
+  }
+  return result;
+}
+
+const Module* WastIncrementalParser::module(Errors* errors) {
+  if (module_dirty_) {
+    ReparseAll(errors);
+  }
+  return module_.get();
+}
+
+bool WastIncrementalParser::ScanForms(std::vector<FormRange>* out) const {
+  out->clear();
+
+  const char* data = text_.data();
+  size_t size = text_.size();
+  int depth = 0;
+  int record_depth = -1;  // Decided at the first '('.
+  size_t form_start = 0;
+
+  for (size_t i = 0; i < size; ++i) {
+    char c = data[i];
+    if (c == ';' && i + 1 < size && data[i + 1] == ';') {
+      while (i < size && data[i] != '\n') {
+        ++i;
+      }
+      continue;
+    }
+    if (c == '(' && i + 1 < size && data[i + 1] == ';') {
+      int comment_depth = 1;
+      i += 2;
+      while (i < size && comment_depth > 0) {
+        if (data[i] == '(' && i + 1 < size && data[i + 1] == ';') {
+          ++comment_depth;
+          i += 2;
+        } else if (data[i] == ';' && i + 1 < size && data[i + 1] == ')') {
+          --comment_depth;
+          i += 2;
+        } else {
+          ++i;
+        }
+      }
+      if (comment_depth > 0) {
+        return false;
+      }
+      --i;  // Compensate for the loop increment.
+      continue;
+    }
+    if (c == '"') {
+      ++i;
+      while (i < size && data[i] != '"') {
+        if (data[i] == '\\') {
+          ++i;
+        }
+        ++i;
+      }
+      if (i >= size) {
+        return false;
+      }
+      continue;
+    }
+    if (c == '(') {
+      ++depth;
+      if (record_depth < 0) {
+        // The first form decides whether we track bare module fields or the
+        // children of a wrapped (module ...).
+        record_depth = StartsModuleForm(text_, i + 1) ? 1 : 0;
+      }
+      if (depth == record_depth + 1) {
+        form_start = i;
+      }
+    } else if (c == ')') {
+      if (depth == 0) {
+        return false;
+      }
+      if (depth == record_depth + 1) {
+        out->push_back(FormRange{form_start, i + 1});
+      }
+      --depth;
+    }
+  }
+  return depth == 0;
+}
+
+Result WastIncrementalParser::CheckFormSyntax(const FormRange& form,
+                                              Errors* errors) {
+  size_t line_start = 0;
+  if (form.start > 0) {
+    line_start = text_.rfind('\n', form.start - 1);
+    line_start = line_start == std::string::npos ? 0 : line_start + 1;
+  }
+  size_t lines = std::count(text_.begin(), text_.begin() + form.start, '\n');
+
+  std::string padded;
+  padded.reserve(lines + (form.start - line_start) + (form.end - form.start));
+  padded.append(lines, '\n');
+  padded.append(form.start - line_start, ' ');
+  padded.append(text_, form.start, form.end - form.start);
+
+  auto lexer =
+      WastLexer::CreateBufferLexer(filename_, padded.data(), padded.size());
+  std::unique_ptr<Module> module;
+  return ParseWatModule(lexer.get(), &module, errors, options_);
+}
+
+Result WastIncrementalParser::ReparseAll(Errors* errors) {
+  auto lexer =
+      WastLexer::CreateBufferLexer(filename_, text_.data(), text_.size());
+  std::unique_ptr<Module> module;
+  Result result = ParseWatModule(lexer.get(), &module, errors, options_);
+  module_ = Succeeded(result) ? std::move(module) : nullptr;
+  module_dirty_ = false;
+  return result;
+}
+
+}  // namespace wabt
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_WAST_INCREMENTAL_PARSER_H_
+#define WABT_WAST_INCREMENTAL_PARSER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common.h"
+#include "src/error.h"
+#include "src/ir.h"
+#include "src/wast-parser.h"
+
+namespace wabt {
+
+// Reparses .wat text across small edits, as editor tooling produces on every
+// keystroke. The full text is parsed once; after that, ApplyEdit re-scans
+// only the s-expression structure (a plain byte scan with no token or IR
+// allocation) and re-parses only the top-level forms the edit touched, so
+// the per-keystroke cost is dominated by the size of the edited form rather
+// than the file. The IR module is rebuilt lazily by module(), since
+// diagnostics are the output that matters per keystroke.
+class WastIncrementalParser {
+ public:
+  WABT_DISALLOW_COPY_AND_ASSIGN(WastIncrementalParser);
+
+  WastIncrementalParser(string_view filename, WastParseOptions* options);
+
+  // Replaces the entire text and parses it; the baseline for later edits.
+  Result SetText(string_view text, Errors*);
+
+  // Replaces |old_size| bytes at |offset| with |replacement|, then re-parses
+  // the top-level forms overlapping the edit for syntax errors. Forms before
+  // the edit are untouched and forms after it only have their retained
+  // offsets shifted. Error locations are reported in whole-file coordinates.
+  // Falls back to a full parse when the text is structurally unbalanced.
+  Result ApplyEdit(size_t offset,
+                   size_t old_size,
+                   string_view replacement,
+                   Errors*);
+
+  const std::string& text() const { return text_; }
+
+  // Returns the module for the current text, reparsing in full if any edit
+  // was applied since the last call; null when the text does not parse.
+  const Module* module(Errors*);
+
+ private:
+  // Byte range of one top-level form: a bare module field, or a child of the
+  // (module ...) form when the text uses the wrapped spelling.
+  struct FormRange {
+    size_t start;
+    size_t end;  // One past the last byte.
+  };
+
+  // Collects the form ranges for the current text. Returns false when the
+  // text is unbalanced (also counting unterminated strings and comments), in
+  // which case edits can't be attributed to a single form.
+  bool ScanForms(std::vector<FormRange>* out) const;
+
+  // Parses one form in isolation, padded with the newlines and spaces that
+  // precede it so error locations match the whole file.
+  Result CheckFormSyntax(const FormRange&, Errors*);
+
+  // Parses the entire text, refreshing module_.
+  Result ReparseAll(Errors*);
+
+  std::string filename_;
+  WastParseOptions* options_;
+  std::string text_;
+  std::vector<FormRange> forms_;
+  std::unique_ptr<Module> module_;
+  bool module_dirty_ = true;
+};
+
+}  // namespace wabt
+
+#endif /* WABT_WAST_INCREMENTAL_PARSER_H_ */
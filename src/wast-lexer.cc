@@ -18,9 +18,16 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 #include "config.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "src/lexer-source.h"
 #include "src/wast-parser.h"
 
@@ -28,9 +35,104 @@
 
 namespace wabt {
 
+// At namespace scope (not in the anonymous namespace below) so that
+// TokenInfo here is the same type named by WastLexer::MatchKeyword.
+#include "src/prebuilt/lexer-keywords.cc"
+
 namespace {
 
-#include "src/prebuilt/lexer-keywords.cc"
+#include "src/prebuilt/lexer-keyword-prefilter.cc"
+
+// Vectorized scanning used to skip over runs of uninteresting bytes
+// (whitespace, comment bodies, unescaped string characters) before falling
+// back into the per-byte token loops below.
+
+// Returns a pointer to the first byte in [p, end) equal to c0, c1 or c2, or
+// end if there is none.
+const char* FindAnyOf3(const char* p, const char* end, char c0, char c1,
+                       char c2) {
+#if defined(__SSE2__)
+  const __m128i v0 = _mm_set1_epi8(c0);
+  const __m128i v1 = _mm_set1_epi8(c1);
+  const __m128i v2 = _mm_set1_epi8(c2);
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, v0),
+                                           _mm_cmpeq_epi8(chunk, v1)),
+                              _mm_cmpeq_epi8(chunk, v2));
+    int mask = _mm_movemask_epi8(eq);
+    if (mask != 0) {
+      return p + Ctz(static_cast<unsigned>(mask));
+    }
+    p += 16;
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint8x16_t v0 = vdupq_n_u8(c0);
+  const uint8x16_t v1 = vdupq_n_u8(c1);
+  const uint8x16_t v2 = vdupq_n_u8(c2);
+  while (end - p >= 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t eq = vorrq_u8(
+        vorrq_u8(vceqq_u8(chunk, v0), vceqq_u8(chunk, v1)),
+        vceqq_u8(chunk, v2));
+    // Narrow each 8-bit lane to 4 bits so the result fits in a uint64.
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+    if (mask != 0) {
+      return p + (Ctz(mask) >> 2);
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && *p != c0 && *p != c1 && *p != c2) {
+    p++;
+  }
+  return p;
+}
+
+// Returns a pointer to the first byte in [p, end) that is not wast
+// whitespace (space, tab, carriage return or newline), or end.
+const char* FindNonWhitespace(const char* p, const char* end) {
+#if defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+    int mask = ~_mm_movemask_epi8(ws) & 0xffff;
+    if (mask != 0) {
+      return p + Ctz(static_cast<unsigned>(mask));
+    }
+    p += 16;
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint8x16_t space = vdupq_n_u8(' ');
+  const uint8x16_t tab = vdupq_n_u8('\t');
+  const uint8x16_t cr = vdupq_n_u8('\r');
+  const uint8x16_t lf = vdupq_n_u8('\n');
+  while (end - p >= 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t ws = vorrq_u8(
+        vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab)),
+        vorrq_u8(vceqq_u8(chunk, cr), vceqq_u8(chunk, lf)));
+    uint64_t mask = ~vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(ws), 4)), 0);
+    if (mask != 0) {
+      return p + (Ctz(mask) >> 2);
+    }
+    p += 16;
+  }
+#endif
+  while (p < end &&
+         (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    p++;
+  }
+  return p;
+}
 
 }  // namespace
 
@@ -178,7 +280,8 @@ Location WastLexer::GetLocation() {
   auto column = [=](const char* p) {
     return std::max(1, static_cast<int>(p - line_start_ + 1));
   };
-  return Location(filename_, line_, column(token_start_), column(cursor_));
+  return Location(filename_.c_str(), line_, column(token_start_),
+                  column(cursor_));
 }
 
 string_view WastLexer::GetText(size_t offset) {
@@ -232,6 +335,8 @@ void WastLexer::Newline() {
 bool WastLexer::ReadBlockComment(WastParser* parser) {
   int nesting = 1;
   while (true) {
+    // Only ';', '(' and newline need individual handling.
+    cursor_ = FindAnyOf3(cursor_, buffer_end_, ';', '(', '\n');
     switch (ReadChar()) {
       case kEof:
         ERROR("EOF in block comment");
@@ -257,36 +362,26 @@ bool WastLexer::ReadBlockComment(WastParser* parser) {
 }
 
 bool WastLexer::ReadLineComment() {
-  while (true) {
-    switch (ReadChar()) {
-      case kEof:
-        return false;
-
-      case '\n':
-        Newline();
-        return true;
-    }
+  const char* newline = static_cast<const char*>(
+      memchr(cursor_, '\n', buffer_end_ - cursor_));
+  if (!newline) {
+    cursor_ = buffer_end_;
+    return false;
   }
+  cursor_ = newline + 1;
+  Newline();
+  return true;
 }
 
 void WastLexer::ReadWhitespace() {
-  while (true) {
-    switch (PeekChar()) {
-      case ' ':
-      case '\t':
-      case '\r':
-        ReadChar();
-        break;
-
-      case '\n':
-        ReadChar();
-        Newline();
-        break;
-
-      default:
-        return;
-    }
+  const char* first = FindNonWhitespace(cursor_, buffer_end_);
+  // Count the newlines that were skipped so locations stay correct.
+  const char* p = cursor_;
+  while ((p = static_cast<const char*>(memchr(p, '\n', first - p)))) {
+    cursor_ = ++p;
+    Newline();
   }
+  cursor_ = first;
 }
 
 Token WastLexer::GetStringToken(WastParser* parser) {
@@ -295,6 +390,8 @@ Token WastLexer::GetStringToken(WastParser* parser) {
   bool in_string = true;
   ReadChar();
   while (in_string) {
+    // Only the terminator, escapes and newlines need individual handling.
+    cursor_ = FindAnyOf3(cursor_, buffer_end_, '"', '\\', '\n');
     switch (ReadChar()) {
       case kEof:
         return BareToken(TokenType::Eof);
@@ -531,10 +628,27 @@ Token WastLexer::GetIdToken() {
   return TextToken(TokenType::Var);
 }
 
+// static
+TokenInfo* WastLexer::MatchKeyword(string_view word) {
+  size_t len = word.size();
+  if (len == 0 || len >= 64) {
+    return nullptr;
+  }
+  // Reject most non-keywords on (length, first char, last char) before
+  // running the perfect hash, which touches up to 19 characters.
+  uint64_t len_bit = uint64_t(1) << len;
+  if (!(kKeywordFirstCharLengths[static_cast<uint8_t>(word[0])] & len_bit) ||
+      !(kKeywordLastCharLengths[static_cast<uint8_t>(word[len - 1])] &
+        len_bit)) {
+    return nullptr;
+  }
+  return Perfect_Hash::InWordSet(word.data(), len);
+}
+
 Token WastLexer::GetKeywordToken() {
   ReadReservedChars();
   TokenInfo* info =
-      Perfect_Hash::InWordSet(token_start_, cursor_ - token_start_);
+      MatchKeyword(string_view(token_start_, cursor_ - token_start_));
   if (!info) {
     return TextToken(TokenType::Reserved);
   }
@@ -33,6 +33,7 @@ namespace wabt {
 class ErrorHandler;
 class LexerSource;
 class WastParser;
+struct TokenInfo;
 
 class WastLexer {
  public:
@@ -47,9 +48,20 @@ class WastLexer {
 
   Token GetToken(WastParser* parser);
 
+  // Classifies a word as a keyword: a length/first/last-character prefilter
+  // (generated from src/lexer-keywords.txt) rejects most non-keywords, then
+  // the gperf perfect hash confirms a candidate with a single string compare.
+  // Returns nullptr if the word is not a keyword.
+  static TokenInfo* MatchKeyword(string_view word);
+
   // TODO(binji): Move this out of the lexer.
-  std::unique_ptr<LexerSourceLineFinder> MakeLineFinder() {
-    return MakeUnique<LexerSourceLineFinder>(source_->Clone());
+  // Returns the line finder for this lexer's source, creating it on first
+  // use; repeated callers share one newline index.
+  LexerSourceLineFinder* line_finder() {
+    if (!line_finder_) {
+      line_finder_ = MakeUnique<LexerSourceLineFinder>(source_->Clone());
+    }
+    return line_finder_.get();
   }
 
  private:
@@ -94,6 +106,7 @@ class WastLexer {
   Token GetReservedToken();
 
   std::unique_ptr<LexerSource> source_;
+  std::unique_ptr<LexerSourceLineFinder> line_finder_;
   std::string filename_;
   int line_;
   const char* buffer_;
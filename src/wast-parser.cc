@@ -16,6 +16,8 @@
 
 #include "src/wast-parser.h"
 
+#include <cstring>
+
 #include "src/binary-reader-ir.h"
 #include "src/binary-reader.h"
 #include "src/cast.h"
@@ -39,8 +41,18 @@ bool IsPowerOfTwo(uint32_t x) {
   return x && ((x & (x - 1)) == 0);
 }
 
-template <typename OutputIter>
-void RemoveEscapes(string_view text, OutputIter dest) {
+inline void AppendChars(std::string* dest, const char* src, size_t size) {
+  dest->append(src, size);
+}
+
+inline void AppendChars(std::vector<uint8_t>* dest,
+                        const char* src,
+                        size_t size) {
+  dest->insert(dest->end(), src, src + size);
+}
+
+template <typename OutputBuffer>
+void RemoveEscapes(string_view text, OutputBuffer* dest) {
   // Remove surrounding quotes; if any. This may be empty if the string was
   // invalid (e.g. if it contained a bad escape sequence).
   if (text.size() <= 2) {
@@ -53,55 +65,68 @@ void RemoveEscapes(string_view text, OutputIter dest) {
   const char* end = text.data() + text.size();
 
   while (src < end) {
-    if (*src == '\\') {
-      src++;
-      switch (*src) {
-        case 'n':
-          *dest++ = '\n';
-          break;
-        case 'r':
-          *dest++ = '\r';
-          break;
-        case 't':
-          *dest++ = '\t';
-          break;
-        case '\\':
-          *dest++ = '\\';
-          break;
-        case '\'':
-          *dest++ = '\'';
-          break;
-        case '\"':
-          *dest++ = '\"';
-          break;
-        default: {
-          // The string should be validated already, so we know this is a hex
-          // sequence.
-          uint32_t hi;
-          uint32_t lo;
-          if (Succeeded(ParseHexdigit(src[0], &hi)) &&
-              Succeeded(ParseHexdigit(src[1], &lo))) {
-            *dest++ = (hi << 4) | lo;
-          } else {
-            assert(0);
-          }
-          src++;
-          break;
+    // Copy everything up to the next escape in one append; most strings
+    // (and most of each data segment) contain no escapes at all.
+    const char* escape =
+        static_cast<const char*>(memchr(src, '\\', end - src));
+    if (!escape) {
+      AppendChars(dest, src, end - src);
+      break;
+    }
+    AppendChars(dest, src, escape - src);
+    src = escape + 1;
+    switch (*src) {
+      case 'n':
+        dest->push_back('\n');
+        break;
+      case 'r':
+        dest->push_back('\r');
+        break;
+      case 't':
+        dest->push_back('\t');
+        break;
+      case '\\':
+        dest->push_back('\\');
+        break;
+      case '\'':
+        dest->push_back('\'');
+        break;
+      case '\"':
+        dest->push_back('\"');
+        break;
+      default: {
+        // The string should be validated already, so we know this is a hex
+        // sequence.
+        uint32_t hi;
+        uint32_t lo;
+        if (Succeeded(ParseHexdigit(src[0], &hi)) &&
+            Succeeded(ParseHexdigit(src[1], &lo))) {
+          dest->push_back((hi << 4) | lo);
+        } else {
+          assert(0);
         }
+        src++;
+        break;
       }
-      src++;
-    } else {
-      *dest++ = *src++;
     }
+    src++;
   }
 }
 
 typedef std::vector<string_view> TextVector;
 
-template <typename OutputIter>
-void RemoveEscapes(const TextVector& texts, OutputIter out) {
-  for (string_view text : texts)
+template <typename OutputBuffer>
+void RemoveEscapes(const TextVector& texts, OutputBuffer* out) {
+  // Escapes only ever shrink the text, so the total source size is a tight
+  // upper bound; one reservation covers multi-megabyte data segments.
+  size_t total_size = 0;
+  for (string_view text : texts) {
+    total_size += text.size();
+  }
+  out->reserve(out->size() + total_size);
+  for (string_view text : texts) {
     RemoveEscapes(text, out);
+  }
 }
 
 bool IsPlainInstr(TokenType token_type) {
@@ -377,6 +402,13 @@ WastParser::WastParser(WastLexer* lexer,
                        WastParseOptions* options)
     : lexer_(lexer), errors_(errors), options_(options) {}
 
+void WastParser::Reset(WastLexer* lexer, Errors* errors) {
+  lexer_ = lexer;
+  errors_ = errors;
+  last_module_index_ = kInvalidIndex;
+  tokens_.clear();
+}
+
 void WastParser::Error(Location loc, const char* format, ...) {
   WABT_SNPRINTF_ALLOCA(buffer, length, format);
   errors_->emplace_back(ErrorLevel::Error, loc, buffer);
@@ -586,7 +618,7 @@ bool WastParser::ParseVarOpt(Var* out_var, Var default_var) {
     WABT_USE(result);
     return true;
   } else {
-    *out_var = default_var;
+    *out_var = std::move(default_var);
     return false;
   }
 }
@@ -628,7 +660,7 @@ bool WastParser::ParseTextListOpt(std::vector<uint8_t>* out_data) {
   while (PeekMatch(TokenType::Text))
     texts.push_back(Consume().text());
 
-  RemoveEscapes(texts, std::back_inserter(*out_data));
+  RemoveEscapes(texts, out_data);
   return !texts.empty();
 }
 
@@ -636,7 +668,7 @@ Result WastParser::ParseVarList(VarVector* out_var_list) {
   WABT_TRACE(ParseVarList);
   Var var;
   while (ParseVarOpt(&var)) {
-    out_var_list->emplace_back(var);
+    out_var_list->emplace_back(std::move(var));
   }
   return out_var_list->empty() ? Result::Error : Result::Ok;
 }
@@ -653,7 +685,7 @@ bool WastParser::ParseElemExprVarListOpt(ElemExprVector* out_list) {
   WABT_TRACE(ParseElemExprVarListOpt);
   Var var;
   while (ParseVarOpt(&var)) {
-    out_list->emplace_back(var);
+    out_list->emplace_back(std::move(var));
   }
   return !out_list->empty();
 }
@@ -736,7 +768,8 @@ Result WastParser::ParseQuotedText(std::string* text) {
   }
 
   Token token = Consume();
-  RemoveEscapes(token.text(), std::back_inserter(*text));
+  text->reserve(text->size() + token.text().size());
+  RemoveEscapes(token.text(), text);
   if (!IsValidUtf8(text->data(), text->length())) {
     Error(token.loc, "quoted string has an invalid utf-8 encoding");
   }
@@ -979,7 +1012,7 @@ Result WastParser::ParseElemModuleField(Module* module) {
         EXPECT(Rpar);
       } else if (MatchLpar(TokenType::RefFunc)) {
         CHECK_RESULT(ParseVar(&var));
-        field->elem_segment.elem_exprs.emplace_back(var);
+        field->elem_segment.elem_exprs.emplace_back(std::move(var));
         EXPECT(Rpar);
       } else {
         CHECK_RESULT(ErrorIfLpar({"ref.null", "ref.func"}));
@@ -1265,7 +1298,7 @@ Result WastParser::ParseStartModuleField(Module* module) {
   Var var;
   CHECK_RESULT(ParseVar(&var));
   EXPECT(Rpar);
-  module->AppendField(MakeUnique<StartModuleField>(var, loc));
+  module->AppendField(MakeUnique<StartModuleField>(std::move(var), loc));
   return Result::Ok;
 }
 
@@ -1484,7 +1517,7 @@ Result WastParser::ParsePlainInstrVar(Location loc,
                                       std::unique_ptr<Expr>* out_expr) {
   Var var;
   CHECK_RESULT(ParseVar(&var));
-  out_expr->reset(new T(var, loc));
+  out_expr->reset(new T(std::move(var), loc));
   return Result::Ok;
 }
 
@@ -1694,7 +1727,7 @@ Result WastParser::ParsePlainInstr(std::unique_ptr<Expr>* out_expr) {
         CHECK_RESULT(ParseVar(&dst));
         CHECK_RESULT(ParseVar(&src));
       }
-      out_expr->reset(new TableCopyExpr(dst, src, loc));
+      out_expr->reset(new TableCopyExpr(std::move(dst), std::move(src), loc));
       break;
     }
 
@@ -1708,7 +1741,8 @@ Result WastParser::ParsePlainInstr(std::unique_ptr<Expr>* out_expr) {
       Var segment_index(0);
       CHECK_RESULT(ParseVar(&segment_index));
       Var table_index(0);
-      out_expr->reset(new TableInitExpr(segment_index, table_index, loc));
+      out_expr->reset(new TableInitExpr(std::move(segment_index),
+                                        std::move(table_index), loc));
       break;
     }
 
@@ -2587,7 +2621,7 @@ Result WastParser::ParseRegisterCommand(CommandPtr* out_command) {
   CHECK_RESULT(ParseQuotedText(&text));
   ParseVarOpt(&var, Var(last_module_index_, loc));
   EXPECT(Rpar);
-  out_command->reset(new RegisterCommand(text, var));
+  out_command->reset(new RegisterCommand(text, std::move(var)));
   return Result::Ok;
 }
 
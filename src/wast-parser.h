@@ -41,6 +41,12 @@ class WastParser {
  public:
   WastParser(WastLexer*, Errors*, WastParseOptions*);
 
+  // Re-aims the parser at another file, dropping the buffered lookahead
+  // tokens and per-module state; options are retained. Batch drivers can
+  // parse many files through one parser instead of constructing one per
+  // file.
+  void Reset(WastLexer*, Errors*);
+
   void WABT_PRINTF_FORMAT(3, 4) Error(Location, const char* format, ...);
   Result ParseModule(std::unique_ptr<Module>* out_module);
   Result ParseScript(std::unique_ptr<Script>* out_script);
@@ -18,13 +18,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <cstdarg>
 #include <cstdio>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "src/cast.h"
@@ -104,6 +107,8 @@ class WatWriter : ModuleContext {
   void WriteNextChar();
   void WriteDataWithNextChar(const void* src, size_t size);
   void Writef(const char* format, ...);
+  void WriteU64(uint64_t value, NextChar next_char);
+  void WriteS64(int64_t value, NextChar next_char);
   void WritePutc(char c);
   void WritePuts(const char* s, NextChar next_char);
   void WritePutsSpace(const char* s);
@@ -170,16 +175,36 @@ class WatWriter : ModuleContext {
   void BuildInlineImportMap();
   void WriteInlineImport(ExternalKind, Index);
 
+  void PrerenderFuncs();
+  void SpliceFunc();
+
   const WriteWatOptions& options_;
   Stream* stream_ = nullptr;
   Result result_ = Result::Ok;
   int indent_ = 0;
   NextChar next_char_ = NextChar::None;
   std::vector<ExprTree> expr_tree_stack_;
+  // Scratch vectors recycled by FlushExprTreeStack so folded-expression
+  // output doesn't reallocate a fresh stack copy per flush. A free list is
+  // needed (rather than a single scratch vector) because FlushExprTree
+  // recurses back into FlushExprTreeStack for nested blocks.
+  std::vector<std::vector<ExprTree>> expr_tree_pool_;
   std::multimap<std::pair<ExternalKind, Index>, const Export*>
       inline_export_map_;
   std::vector<const Import*> inline_import_map_[kExternalKindCount];
 
+  // Function bodies rendered ahead of time by worker threads; see
+  // PrerenderFuncs. Each entry is a slice of one worker's output buffer,
+  // stored in module field order.
+  struct PrerenderedFunc {
+    size_t buffer_index;
+    size_t offset;
+    size_t size;
+  };
+  std::vector<std::unique_ptr<OutputBuffer>> prerendered_buffers_;
+  std::vector<PrerenderedFunc> prerendered_funcs_;
+  size_t next_prerendered_func_ = 0;
+
   Index func_index_ = 0;
   Index global_index_ = 0;
   Index table_index_ = 0;
@@ -242,6 +267,39 @@ void WABT_PRINTF_FORMAT(2, 3) WatWriter::Writef(const char* format, ...) {
   next_char_ = NextChar::Space;
 }
 
+// Fast paths for the decimal integers the writer emits constantly (variable
+// indices, integer constants, offset= and align=); going through Writef's
+// vsnprintf for each one is measurable on instruction-dense modules.
+void WatWriter::WriteU64(uint64_t value, NextChar next_char) {
+  char buffer[20];
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+  WriteDataWithNextChar(p, end - p);
+  next_char_ = next_char;
+}
+
+void WatWriter::WriteS64(int64_t value, NextChar next_char) {
+  char buffer[21];
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+  // abs(INT64_MIN) doesn't fit in int64_t, so negate as unsigned.
+  uint64_t abs_value = value < 0 ? ~static_cast<uint64_t>(value) + 1
+                                 : static_cast<uint64_t>(value);
+  do {
+    *--p = '0' + abs_value % 10;
+    abs_value /= 10;
+  } while (abs_value != 0);
+  if (value < 0) {
+    *--p = '-';
+  }
+  WriteDataWithNextChar(p, end - p);
+  next_char_ = next_char;
+}
+
 void WatWriter::WritePutc(char c) {
   stream_->WriteChar(c);
 }
@@ -334,14 +392,21 @@ void WatWriter::WriteQuotedData(const void* data, size_t length) {
   static const char s_hexdigits[] = "0123456789abcdef";
   WriteNextChar();
   WritePutc('\"');
-  for (size_t i = 0; i < length; ++i) {
-    uint8_t c = u8_data[i];
-    if (s_is_char_escaped[c]) {
-      WritePutc('\\');
-      WritePutc(s_hexdigits[c >> 4]);
-      WritePutc(s_hexdigits[c & 0xf]);
-    } else {
-      WritePutc(c);
+  size_t i = 0;
+  while (i < length) {
+    // Copy each run of bytes that needs no escaping with a single write;
+    // data segments are mostly plain bytes, so this is the common path.
+    size_t run_start = i;
+    while (i < length && !s_is_char_escaped[u8_data[i]]) {
+      ++i;
+    }
+    if (i > run_start) {
+      stream_->WriteData(u8_data + run_start, i - run_start);
+    }
+    if (i < length) {
+      uint8_t c = u8_data[i++];
+      char escaped[3] = {'\\', s_hexdigits[c >> 4], s_hexdigits[c & 0xf]};
+      stream_->WriteData(escaped, sizeof(escaped));
     }
   }
   WritePutc('\"');
@@ -355,8 +420,7 @@ void WatWriter::WriteQuotedString(string_view str, NextChar next_char) {
 
 void WatWriter::WriteVar(const Var& var, NextChar next_char) {
   if (var.is_index()) {
-    Writef("%" PRIindex, var.index());
-    next_char_ = next_char;
+    WriteU64(var.index(), next_char);
   } else {
     WriteName(var.name(), next_char);
   }
@@ -429,13 +493,13 @@ void WatWriter::WriteConst(const Const& const_) {
   switch (const_.type) {
     case Type::I32:
       WritePutsSpace(Opcode::I32Const_Opcode.GetName());
-      Writef("%d", static_cast<int32_t>(const_.u32));
+      WriteS64(static_cast<int32_t>(const_.u32), NextChar::Space);
       WriteNewline(NO_FORCE_NEWLINE);
       break;
 
     case Type::I64:
       WritePutsSpace(Opcode::I64Const_Opcode.GetName());
-      Writef("%" PRId64, static_cast<int64_t>(const_.u64));
+      WriteS64(static_cast<int64_t>(const_.u64), NextChar::Space);
       WriteNewline(NO_FORCE_NEWLINE);
       break;
 
@@ -483,10 +547,12 @@ void WatWriter::WriteLoadStoreExpr(const Expr* expr) {
   auto typed_expr = cast<T>(expr);
   WritePutsSpace(typed_expr->opcode.GetName());
   if (typed_expr->offset) {
-    Writef("offset=%u", typed_expr->offset);
+    WritePuts("offset=", NextChar::None);
+    WriteU64(typed_expr->offset, NextChar::Space);
   }
   if (!typed_expr->opcode.IsNaturallyAligned(typed_expr->align)) {
-    Writef("align=%u", typed_expr->align);
+    WritePuts("align=", NextChar::None);
+    WriteU64(typed_expr->align, NextChar::Space);
   }
   WriteNewline(NO_FORCE_NEWLINE);
 }
@@ -918,7 +984,7 @@ Result WatWriter::ExprVisitorDelegate::OnTernaryExpr(TernaryExpr* expr) {
 
 Result WatWriter::ExprVisitorDelegate::OnSimdLaneOpExpr(SimdLaneOpExpr* expr) {
   writer_->WritePutsSpace(expr->opcode.GetName());
-  writer_->Writef("%" PRIu64, (expr->val));
+  writer_->WriteU64(expr->val, NextChar::Space);
   writer_->WritePutsNewline("");
   return Result::Ok;
 }
@@ -1082,15 +1148,21 @@ void WatWriter::FlushExprTree(const ExprTree& expr_tree) {
 
 void WatWriter::FlushExprTreeVector(const std::vector<ExprTree>& expr_trees) {
   WABT_TRACE_ARGS(FlushExprTreeVector, "%zu", expr_trees.size());
-  for (auto expr_tree : expr_trees) {
+  for (const auto& expr_tree : expr_trees) {
     FlushExprTree(expr_tree);
   }
 }
 
 void WatWriter::FlushExprTreeStack() {
-  std::vector<ExprTree> stack_copy(std::move(expr_tree_stack_));
-  expr_tree_stack_.clear();
+  std::vector<ExprTree> stack_copy;
+  if (!expr_tree_pool_.empty()) {
+    stack_copy = std::move(expr_tree_pool_.back());
+    expr_tree_pool_.pop_back();
+  }
+  std::swap(stack_copy, expr_tree_stack_);
   FlushExprTreeVector(stack_copy);
+  stack_copy.clear();
+  expr_tree_pool_.emplace_back(std::move(stack_copy));
 }
 
 void WatWriter::WriteInitExpr(const ExprList& expr) {
@@ -1227,9 +1299,9 @@ void WatWriter::WriteEvent(const Event& event) {
 }
 
 void WatWriter::WriteLimits(const Limits& limits) {
-  Writef("%" PRIu64, limits.initial);
+  WriteU64(limits.initial, NextChar::Space);
   if (limits.has_max) {
-    Writef("%" PRIu64, limits.max);
+    WriteU64(limits.max, NextChar::Space);
   }
   if (limits.is_shared) {
     Writef("shared");
@@ -1367,9 +1439,88 @@ void WatWriter::WriteStartFunction(const Var& start) {
   WriteCloseNewline();
 }
 
+// A function's text depends only on state that is fixed once the inline
+// export/import maps are built, so bodies can be rendered by worker threads
+// into per-worker streams and spliced into the output in field order. Each
+// worker starts its chunk with no character pending and never flushes the
+// trailing newline, so the spliced output is byte-identical to a sequential
+// write.
+void WatWriter::PrerenderFuncs() {
+  if (options_.num_threads <= 1) {
+    return;
+  }
+
+  // Collect the defined functions along with the func_index_ each one will be
+  // written with; imported functions advance the index but are written by
+  // WriteImport.
+  std::vector<std::pair<const Func*, Index>> funcs;
+  Index func_index = 0;
+  for (const ModuleField& field : module.fields) {
+    if (field.type() == ModuleFieldType::Func) {
+      funcs.emplace_back(&cast<FuncModuleField>(&field)->func, func_index++);
+    } else if (field.type() == ModuleFieldType::Import &&
+               cast<ImportModuleField>(&field)->import->kind() ==
+                   ExternalKind::Func) {
+      func_index++;
+    }
+  }
+  if (funcs.size() < 2) {
+    return;
+  }
+
+  size_t num_threads = std::min<size_t>(options_.num_threads, funcs.size());
+  prerendered_funcs_.resize(funcs.size());
+  std::vector<std::unique_ptr<MemoryStream>> streams(num_threads);
+  std::vector<std::thread> threads;
+  std::atomic<size_t> next_func{0};
+  for (size_t i = 0; i < num_threads; ++i) {
+    streams[i] = MakeUnique<MemoryStream>();
+    threads.emplace_back([this, i, &streams, &funcs, &next_func]() {
+      MemoryStream* stream = streams[i].get();
+      WatWriter writer(stream, options_, module);
+      writer.inline_export_map_ = inline_export_map_;
+      for (size_t kind = 0; kind < kExternalKindCount; ++kind) {
+        writer.inline_import_map_[kind] = inline_import_map_[kind];
+      }
+      // Bodies are written at module-field depth; the leading newline and
+      // indent are written by SpliceFunc.
+      writer.indent_ = INDENT_SIZE;
+      while (true) {
+        size_t w = next_func.fetch_add(1, std::memory_order_relaxed);
+        if (w >= funcs.size()) {
+          break;
+        }
+        writer.next_char_ = NextChar::None;
+        writer.func_index_ = funcs[w].second;
+        size_t start = stream->output_buffer().size();
+        writer.WriteFunc(*funcs[w].first);
+        prerendered_funcs_[w] = {i, start,
+                                 stream->output_buffer().size() - start};
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (std::unique_ptr<MemoryStream>& stream : streams) {
+    prerendered_buffers_.push_back(stream->ReleaseOutputBuffer());
+  }
+}
+
+void WatWriter::SpliceFunc() {
+  assert(next_prerendered_func_ < prerendered_funcs_.size());
+  const PrerenderedFunc& func = prerendered_funcs_[next_prerendered_func_++];
+  const OutputBuffer& buffer = *prerendered_buffers_[func.buffer_index];
+  WriteNextChar();
+  stream_->WriteData(buffer.data.data() + func.offset, func.size);
+  next_char_ = NextChar::Newline;
+  func_index_++;
+}
+
 Result WatWriter::WriteModule() {
   BuildInlineExportMap();
   BuildInlineImportMap();
+  PrerenderFuncs();
   WriteOpenSpace("module");
   if (module.name.empty()) {
     WriteNewline(NO_FORCE_NEWLINE);
@@ -1379,7 +1530,11 @@ Result WatWriter::WriteModule() {
   for (const ModuleField& field : module.fields) {
     switch (field.type()) {
       case ModuleFieldType::Func:
-        WriteFunc(cast<FuncModuleField>(&field)->func);
+        if (!prerendered_funcs_.empty()) {
+          SpliceFunc();
+        } else {
+          WriteFunc(cast<FuncModuleField>(&field)->func);
+        }
         break;
       case ModuleFieldType::Global:
         WriteGlobal(cast<GlobalModuleField>(&field)->global);
@@ -1484,7 +1639,7 @@ void WatWriter::WriteInlineExports(ExternalKind kind, Index index) {
 }
 
 bool WatWriter::IsInlineExport(const Export& export_) {
-  Index index;
+  Index index = kInvalidIndex;
   switch (export_.kind) {
     case ExternalKind::Func:
       index = module.GetFuncIndex(export_.var);
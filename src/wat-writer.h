@@ -28,6 +28,9 @@ struct WriteWatOptions {
   bool fold_exprs = false;  // Write folded expressions.
   bool inline_export = false;
   bool inline_import = false;
+  // Number of threads used to render function bodies; values <= 1 render on
+  // the calling thread. The output is identical either way.
+  int num_threads = 1;
 };
 
 Result WriteWat(Stream*, const Module*, const WriteWatOptions&);
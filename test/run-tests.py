@@ -94,6 +94,11 @@ TOOLS = {
         ('RUN', '%(spectest-interp)s %(temp_file)s.json'),
         ('VERBOSE-ARGS', ['--print-cmd', '-v']),
     ],
+    'run-validate-daemon': [
+        ('RUN', 'test/run-validate-daemon.py'),
+        ('ARGS', ['%(in_file)s', '--bindir=%(bindir)s']),
+        ('VERBOSE-ARGS', ['-v']),
+    ],
     'run-gen-wasm': [
         ('RUN', '%(gen_wasm_py)s %(in_file)s -o %(temp_file)s.wasm'),
         ('RUN', '%(wasm-validate)s %(temp_file)s.wasm'),
@@ -0,0 +1,106 @@
+#!/usr/bin/env python
+#
+# Copyright 2020 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Starts `wasm-validate --daemon` on a unix socket, sends it a couple of
+# modules over one connection, and prints the verdicts. Exercises the daemon
+# framing (32-bit length prefix both ways; reply is a verdict byte followed
+# by the formatted error text), which a plain golden test can't reach.
+
+import argparse
+import os
+import shutil
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+import find_exe
+from utils import Error
+
+
+def ReadFull(sock, size):
+    data = b''
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise Error('daemon closed the connection')
+        data += chunk
+    return data
+
+
+def Validate(sock, name, module):
+    sock.sendall(struct.pack('=I', len(module)) + module)
+    reply_size, = struct.unpack('=I', ReadFull(sock, 4))
+    reply = ReadFull(sock, reply_size)
+    verdict = 'invalid' if reply[0:1] != b'\0' else 'valid'
+    sys.stdout.write('%s: %s\n' % (name, verdict))
+    text = reply[1:].decode('utf-8')
+    if text:
+        sys.stdout.write(text)
+
+
+def main(args):
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-v', '--verbose', help='print more diagnotic messages.',
+                        action='store_true')
+    parser.add_argument('--bindir', metavar='PATH',
+                        default=find_exe.GetDefaultPath(),
+                        help='directory to search for all executables.')
+    parser.add_argument('file', help='test file.')
+    options = parser.parse_args(args)
+
+    wasm_validate = find_exe.FindExecutable('wasm-validate', options.bindir)
+
+    out_dir = tempfile.mkdtemp(prefix='wasm-validate-')
+    socket_path = os.path.join(out_dir, 'daemon.sock')
+    daemon = subprocess.Popen([wasm_validate, '--daemon', socket_path])
+    try:
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        # The daemon creates the socket after it starts; retry briefly.
+        for _ in range(100):
+            try:
+                sock.connect(socket_path)
+                break
+            except socket.error:
+                if daemon.poll() is not None:
+                    raise Error('daemon exited with code %d' % daemon.returncode)
+                time.sleep(0.05)
+        else:
+            raise Error('timed out connecting to %s' % socket_path)
+
+        # Both modules go over the same connection; the second validation must
+        # work whether or not the first one failed.
+        empty_module = b'\0asm\x01\0\0\0'
+        bad_version = b'\0asm\x02\0\0\0'
+        Validate(sock, 'empty module', empty_module)
+        Validate(sock, 'bad version', bad_version)
+        sock.close()
+    finally:
+        daemon.terminate()
+        daemon.wait()
+        shutil.rmtree(out_dir)
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main(sys.argv[1:]))
+    except Error as e:
+        sys.stderr.write(str(e) + '\n')
+        sys.exit(1)
@@ -1,6 +1,4 @@
-#include <assert.h>
 #include <math.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include "fac.h"
@@ -9,11 +7,18 @@
 
 #define TRAP(x) (wasm_rt_trap(WASM_RT_TRAP_##x), 0)
 
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+/* Exhaustion is detected by the fault handler when recursion reaches the
+ * native stack's guard region, so calls carry no bookkeeping. */
+#define FUNC_PROLOGUE
+#define FUNC_EPILOGUE
+#else
 #define FUNC_PROLOGUE                                            \
   if (++wasm_rt_call_stack_depth > WASM_RT_MAX_CALL_STACK_DEPTH) \
     TRAP(EXHAUSTION)
 
 #define FUNC_EPILOGUE --wasm_rt_call_stack_depth
+#endif
 
 #define UNREACHABLE TRAP(UNREACHABLE)
 
@@ -23,8 +28,12 @@
        ? ((t)table.data[x].func)(__VA_ARGS__)        \
        : TRAP(CALL_INDIRECT))
 
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER
+#define MEMCHECK(mem, a, t)
+#else
 #define MEMCHECK(mem, a, t)  \
   if (UNLIKELY((a) + sizeof(t) > mem->size)) TRAP(OOB)
+#endif
 
 #define DEFINE_LOAD(name, t1, t2, t3)              \
   static inline t3 name(wasm_rt_memory_t* mem, u64 addr) {   \
@@ -65,6 +74,62 @@ DEFINE_STORE(i64_store8, u8, u64);
 DEFINE_STORE(i64_store16, u16, u64);
 DEFINE_STORE(i64_store32, u32, u64);
 
+/* Accesses whose wasm alignment hint matches the access width are emitted
+ * through these *_aligned helpers, whose typed dereference the compiler can
+ * vectorize (gcc doesn't always see through the memcpy above). The hint is
+ * not semantic — the spec requires a misaligned access to succeed no matter
+ * what the annotation says — so the helpers verify it and fall back to the
+ * memcpy path when the effective address is actually misaligned; the
+ * predicted-true branch costs far less than losing the typed form. The
+ * may_alias types keep the dereferences exempt from strict-aliasing
+ * analysis, since the same bytes are also touched as u8 and via memcpy. */
+typedef u16 __attribute__((__may_alias__)) u16_alias;
+typedef s16 __attribute__((__may_alias__)) s16_alias;
+typedef u32 __attribute__((__may_alias__)) u32_alias;
+typedef s32 __attribute__((__may_alias__)) s32_alias;
+typedef u64 __attribute__((__may_alias__)) u64_alias;
+typedef f32 __attribute__((__may_alias__)) f32_alias;
+typedef f64 __attribute__((__may_alias__)) f64_alias;
+
+#define DEFINE_ALIGNED_LOAD(name, t1, t2, t3)                 \
+  static inline t3 name(wasm_rt_memory_t* mem, u64 addr) {    \
+    MEMCHECK(mem, addr, t1);                                  \
+    if (LIKELY((uintptr_t)&mem->data[addr] % sizeof(t1) == 0)) \
+      return (t3)(t2)*(const t1*)&mem->data[addr];            \
+    t1 result;                                                \
+    memcpy(&result, &mem->data[addr], sizeof(t1));            \
+    return (t3)(t2)result;                                    \
+  }
+
+#define DEFINE_ALIGNED_STORE(name, t1, t2)                              \
+  static inline void name(wasm_rt_memory_t* mem, u64 addr, t2 value) {  \
+    MEMCHECK(mem, addr, t1);                                            \
+    t1 wrapped = (t1)value;                                             \
+    if (LIKELY((uintptr_t)&mem->data[addr] % sizeof(t1) == 0)) {        \
+      *(t1*)&mem->data[addr] = wrapped;                                 \
+      return;                                                           \
+    }                                                                   \
+    memcpy(&mem->data[addr], &wrapped, sizeof(t1));                     \
+  }
+
+DEFINE_ALIGNED_LOAD(i32_load_aligned, u32_alias, u32, u32);
+DEFINE_ALIGNED_LOAD(i64_load_aligned, u64_alias, u64, u64);
+DEFINE_ALIGNED_LOAD(f32_load_aligned, f32_alias, f32, f32);
+DEFINE_ALIGNED_LOAD(f64_load_aligned, f64_alias, f64, f64);
+DEFINE_ALIGNED_LOAD(i32_load16_s_aligned, s16_alias, s32, u32);
+DEFINE_ALIGNED_LOAD(i64_load16_s_aligned, s16_alias, s64, u64);
+DEFINE_ALIGNED_LOAD(i32_load16_u_aligned, u16_alias, u32, u32);
+DEFINE_ALIGNED_LOAD(i64_load16_u_aligned, u16_alias, u64, u64);
+DEFINE_ALIGNED_LOAD(i64_load32_s_aligned, s32_alias, s64, u64);
+DEFINE_ALIGNED_LOAD(i64_load32_u_aligned, u32_alias, u64, u64);
+DEFINE_ALIGNED_STORE(i32_store_aligned, u32_alias, u32);
+DEFINE_ALIGNED_STORE(i64_store_aligned, u64_alias, u64);
+DEFINE_ALIGNED_STORE(f32_store_aligned, f32_alias, f32);
+DEFINE_ALIGNED_STORE(f64_store_aligned, f64_alias, f64);
+DEFINE_ALIGNED_STORE(i32_store16_aligned, u16_alias, u32);
+DEFINE_ALIGNED_STORE(i64_store16_aligned, u16_alias, u64);
+DEFINE_ALIGNED_STORE(i64_store32_aligned, u32_alias, u64);
+
 #define I32_CLZ(x) ((x) ? __builtin_clz(x) : 32)
 #define I64_CLZ(x) ((x) ? __builtin_clzll(x) : 64)
 #define I32_CTZ(x) ((x) ? __builtin_ctz(x) : 32)
@@ -14,15 +14,31 @@
  * limitations under the License.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* For pthread_getattr_np, used by the stack check handler. */
+#define _GNU_SOURCE
+#endif
+
 #include "wasm-rt-impl.h"
 
 #include <assert.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+#include <pthread.h>
+#endif
+
 #define PAGE_SIZE 65536
 
 typedef struct FuncType {
@@ -39,6 +55,102 @@ jmp_buf g_jmp_buf;
 FuncType* g_func_types;
 uint32_t g_func_type_count;
 
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX
+static bool g_signal_handler_installed = false;
+
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+/* Lowest address of the installing thread's stack. A fault near it is a
+ * stack overflow, not an out-of-bounds memory access. */
+static char* g_stack_limit;
+
+/* The handler can't run on a stack that just overflowed, so give it its own.
+ * SIGSTKSZ is no longer a compile-time constant on recent glibc. */
+static char g_alt_stack[64 * 1024];
+
+static void os_get_stack_limit(void) {
+#ifdef __APPLE__
+  char* stack_top = (char*)pthread_get_stackaddr_np(pthread_self());
+  g_stack_limit = stack_top - pthread_get_stacksize_np(pthread_self());
+#else
+  pthread_attr_t attr;
+  void* stack_addr;
+  size_t stack_size;
+  pthread_getattr_np(pthread_self(), &attr);
+  pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+  pthread_attr_destroy(&attr);
+  g_stack_limit = (char*)stack_addr;
+#endif
+}
+
+static bool is_stack_overflow(void* addr) {
+  /* Overflowing accesses land in the guard region just below the stack
+   * limit; allow some slack on either side for large frames. */
+  const size_t slack = 1024 * 1024;
+  return g_stack_limit != NULL && (char*)addr >= g_stack_limit - slack &&
+         (char*)addr < g_stack_limit + slack;
+}
+#endif
+
+static void signal_handler(int sig, siginfo_t* si, void* unused) {
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+  if (is_stack_overflow(si->si_addr)) {
+    wasm_rt_trap(WASM_RT_TRAP_EXHAUSTION);
+  }
+#endif
+  wasm_rt_trap(WASM_RT_TRAP_OOB);
+}
+
+static void os_install_signal_handler(void) {
+  struct sigaction sa;
+  memset(&sa, '\0', sizeof(sa));
+  sa.sa_flags = SA_SIGINFO;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_sigaction = signal_handler;
+
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+  os_get_stack_limit();
+
+  stack_t ss;
+  ss.ss_sp = g_alt_stack;
+  ss.ss_size = sizeof(g_alt_stack);
+  ss.ss_flags = 0;
+  if (sigaltstack(&ss, NULL) != 0) {
+    perror("sigaltstack failed");
+    abort();
+  }
+  /* The handler exits via longjmp, so keep the signal deliverable instead
+   * of leaving it blocked after the first trap. */
+  sa.sa_flags |= SA_ONSTACK | SA_NODEFER;
+#endif
+
+  /* Install SIGSEGV and SIGBUS handlers, since macOS seems to use SIGBUS. */
+  if (sigaction(SIGSEGV, &sa, NULL) != 0 || sigaction(SIGBUS, &sa, NULL) != 0) {
+    perror("sigaction failed");
+    abort();
+  }
+}
+
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+void wasm_rt_init_stackcheck(void) {
+  if (!g_signal_handler_installed) {
+    g_signal_handler_installed = true;
+    os_install_signal_handler();
+  }
+}
+#endif
+
+static void* os_mmap(size_t size) {
+  void* addr = mmap(NULL, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (addr == MAP_FAILED)
+    return NULL;
+  return addr;
+}
+
+static int os_mprotect(void* addr, size_t size) {
+  return mprotect(addr, size, PROT_READ | PROT_WRITE);
+}
+#endif
+
 void wasm_rt_trap(wasm_rt_trap_t code) {
   assert(code != WASM_RT_TRAP_NONE);
   wasm_rt_call_stack_depth = g_saved_call_stack_depth;
@@ -94,10 +206,28 @@ uint32_t wasm_rt_register_func_type(uint32_t param_count,
 void wasm_rt_allocate_memory(wasm_rt_memory_t* memory,
                              uint32_t initial_pages,
                              uint32_t max_pages) {
+  uint32_t byte_length = initial_pages * PAGE_SIZE;
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX
+  if (!g_signal_handler_installed) {
+    g_signal_handler_installed = true;
+    os_install_signal_handler();
+  }
+
+  /* Reserve 8GiB, so any u32 index + offset + access size stays inside the
+   * mapping; only the current memory size is made accessible. */
+  void* addr = os_mmap(0x200000000ul);
+  if (addr == NULL) {
+    perror("os_mmap failed");
+    abort();
+  }
+  os_mprotect(addr, byte_length);
+  memory->data = addr;
+#else
+  memory->data = calloc(byte_length, 1);
+#endif
+  memory->size = byte_length;
   memory->pages = initial_pages;
   memory->max_pages = max_pages;
-  memory->size = initial_pages * PAGE_SIZE;
-  memory->data = calloc(memory->size, 1);
 }
 
 uint32_t wasm_rt_grow_memory(wasm_rt_memory_t* memory, uint32_t delta) {
@@ -109,15 +239,22 @@ uint32_t wasm_rt_grow_memory(wasm_rt_memory_t* memory, uint32_t delta) {
   if (new_pages < old_pages || new_pages > memory->max_pages) {
     return (uint32_t)-1;
   }
+  uint32_t old_size = old_pages * PAGE_SIZE;
   uint32_t new_size = new_pages * PAGE_SIZE;
+  uint32_t delta_size = delta * PAGE_SIZE;
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX
+  uint8_t* new_data = memory->data;
+  os_mprotect(new_data + old_size, delta_size);
+#else
   uint8_t* new_data = realloc(memory->data, new_size);
   if (new_data == NULL) {
     return (uint32_t)-1;
   }
+  memset(new_data + old_size, 0, delta_size);
+#endif
   memory->pages = new_pages;
   memory->size = new_size;
   memory->data = new_data;
-  memset(memory->data + old_pages * PAGE_SIZE, 0, delta * PAGE_SIZE);
   return old_pages;
 }
 
@@ -46,8 +46,17 @@ extern uint32_t g_saved_call_stack_depth;
  *   my_wasm_func();
  * ```
  */
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER
+#define wasm_rt_impl_try() (wasm_rt_init_stackcheck(), setjmp(g_jmp_buf))
+
+/** Installs the fault handler and records the stack limit, so stack
+ * overflows trap before any wasm code runs. Idempotent; called by
+ * `wasm_rt_impl_try`. */
+extern void wasm_rt_init_stackcheck(void);
+#else
 #define wasm_rt_impl_try() \
   (g_saved_call_stack_depth = wasm_rt_call_stack_depth, setjmp(g_jmp_buf))
+#endif
 
 #ifdef __cplusplus
 }
@@ -35,6 +35,63 @@ extern "C" {
 #define WASM_RT_MAX_CALL_STACK_DEPTH 500
 #endif
 
+/** Enable memory checking via a signal handler via the following definition:
+ *
+ * #define WASM_RT_MEMCHECK_SIGNAL_HANDLER 1
+ *
+ * This reserves 8GiB of virtual address space per Memory object, with all
+ * pages past the current memory size left inaccessible, so any out-of-bounds
+ * access faults instead of being checked explicitly. The generated loads and
+ * stores then omit their bounds checks, which is usually 10%-25% faster, but
+ * requires OS-specific support. */
+
+/** Check whether the signal handler is supported at all. */
+#if (defined(__linux__) || defined(__unix__) || defined(__APPLE__)) && \
+    defined(__WORDSIZE) && __WORDSIZE == 64
+
+/* If the signal handler is supported, then use it by default. */
+#ifndef WASM_RT_MEMCHECK_SIGNAL_HANDLER
+#define WASM_RT_MEMCHECK_SIGNAL_HANDLER 1
+#endif
+
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER
+#define WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX 1
+#endif
+
+#else
+
+/* The signal handler is not supported, error out if the user was trying to
+ * enable it. */
+#if WASM_RT_MEMCHECK_SIGNAL_HANDLER
+#error "Signal handler is not supported for this OS/Architecture!"
+#endif
+
+#define WASM_RT_MEMCHECK_SIGNAL_HANDLER 0
+#define WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX 0
+
+#endif
+
+/** Enable stack depth checking via the same signal handler:
+ *
+ * #define WASM_RT_STACKCHECK_SIGNAL_HANDLER 1
+ *
+ * Instead of counting call depth in `wasm_rt_call_stack_depth` on every
+ * function entry and exit, let runaway recursion hit the native stack's
+ * guard region; the fault handler recognizes a fault near the stack limit
+ * and raises WASM_RT_TRAP_EXHAUSTION. This removes all per-call bookkeeping
+ * from the generated code, which is a measurable win for call-dense modules,
+ * but exhaustion is then bounded by the native stack size rather than
+ * WASM_RT_MAX_CALL_STACK_DEPTH, and recursion the C compiler turns into a
+ * loop never exhausts at all. Off by default; requires
+ * WASM_RT_MEMCHECK_SIGNAL_HANDLER, whose handler it extends. */
+#ifndef WASM_RT_STACKCHECK_SIGNAL_HANDLER
+#define WASM_RT_STACKCHECK_SIGNAL_HANDLER 0
+#endif
+
+#if WASM_RT_STACKCHECK_SIGNAL_HANDLER && !WASM_RT_MEMCHECK_SIGNAL_HANDLER_POSIX
+#error "Stack check signal handler is not supported for this OS/Architecture!"
+#endif
+
 /** Reason a trap occurred. Provide this to `wasm_rt_trap`. */
 typedef enum {
   WASM_RT_TRAP_NONE,         /** No error. */